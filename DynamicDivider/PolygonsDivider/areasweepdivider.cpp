@@ -0,0 +1,238 @@
+#include "areasweepdivider.h"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+using namespace ClipperLib;
+
+///
+/// @brief 由事件序列建立累计面积表
+/// @param eventVec [in,out] 截线长度变化事件, 建表时按位置排序
+/// @details 实现步骤:
+///   1. 事件按位置排序
+///   2. 顺序扫描, 相邻事件之间按梯形公式累加面积
+///   3. 同一位置的事件合并后记录累计面积、截线长度及斜率
+///
+void AreaSweepTable::build(std::vector<AreaSweepEvent> &eventVec)
+{
+    _totalArea = 0.0;
+    _posVec.clear();
+    _areaVec.clear();
+    _widthVec.clear();
+    _slopeVec.clear();
+    if (eventVec.empty()) return;
+
+    std::sort(eventVec.begin(), eventVec.end(), [](const AreaSweepEvent &e1, const AreaSweepEvent &e2) {
+        return e1._pos < e2._pos;
+    });
+
+    _posVec.reserve(eventVec.size());
+    _areaVec.reserve(eventVec.size());
+    _widthVec.reserve(eventVec.size());
+    _slopeVec.reserve(eventVec.size());
+
+    double area = 0.0, width = 0.0, slope = 0.0;
+    double lastPos = eventVec.front()._pos;
+    for (size_t i = 0; i < eventVec.size();)
+    {
+        const double pos = eventVec[i]._pos;
+        const double delta = pos - lastPos;
+        area += (width + 0.5 * slope * delta) * delta;
+        width += slope * delta;
+
+        for (; i < eventVec.size() && eventVec[i]._pos == pos; ++ i)
+        {
+            width += eventVec[i]._widthJump;
+            slope += eventVec[i]._slopeDelta;
+        }
+
+        _posVec.push_back(pos);
+        _areaVec.push_back(area);
+        _widthVec.push_back(std::max(0.0, width));
+        _slopeVec.push_back(slope);
+        lastPos = pos;
+    }
+    _totalArea = area;
+}
+
+///
+/// @brief 由目标累计面积反解位置
+/// @param targetArea [in] 目标面积
+/// @return 累计面积等于目标面积的位置
+/// @details 二分查找目标所在区间, 区间内 0.5*k*u^2 + w*u = rem, 取数值稳定形式求根
+///
+double AreaSweepTable::solve(const double &targetArea) const
+{
+    if (_posVec.empty()) return 0.0;
+    if (targetArea <= _areaVec.front()) return _posVec.front();
+    if (targetArea >= _areaVec.back()) return _posVec.back();
+
+    auto index = size_t(std::upper_bound(_areaVec.begin(), _areaVec.end(), targetArea) - _areaVec.begin()) - 1;
+    const double rem = targetArea - _areaVec[index];
+    const double width = _widthVec[index];
+    const double slope = _slopeVec[index];
+
+    double u = 0.0;
+    const double denom = width + sqrt(std::max(0.0, width * width + 2.0 * slope * rem));
+    if (denom > 0.0) u = 2.0 * rem / denom;
+
+    double pos = _posVec[index] + u;
+    if (index + 1 < _posVec.size()) pos = std::min(pos, _posVec[index + 1]);
+    return pos;
+}
+
+///
+/// @brief 在面积误差范围内取最粗的整十位置
+/// @param targetArea [in] 目标面积
+/// @param maxError [in] 允许的面积误差, 不大于0时取最接近精确解的整数位置
+/// @param origin [in] 表中位置对应的坐标原点
+/// @return 分割位置(绝对坐标)
+/// @details 实现步骤:
+///   1. 反解精确位置及面积误差上下限对应的位置区间
+///   2. 网格由 10^6 逐级缩小到 10, 取区间内离精确位置最近的网格点
+///   3. 区间内没有网格点时取精确位置四舍五入
+///   相邻层轮廓略有变化时分割位置保持在同一网格点, 分区边界不随层抖动
+///
+long long AreaSweepTable::solveRounded(const double &targetArea, const double &maxError, const double &origin) const
+{
+    const double pos = origin + solve(targetArea);
+    if (maxError <= 0.0) return llround(pos);
+
+    const double minPos = origin + solve(targetArea - maxError);
+    const double maxPos = origin + solve(targetArea + maxError);
+    for (long long step = 1000000; step > 1; step /= 10)
+    {
+        const long long lowPos = (long long)floor(pos / double(step)) * step;
+        const long long highPos = lowPos + step;
+        const bool bLowFirst = (pos - double(lowPos)) <= (double(highPos) - pos);
+        const long long firstPos = bLowFirst ? lowPos : highPos;
+        const long long secondPos = bLowFirst ? highPos : lowPos;
+        if (double(firstPos) >= minPos && double(firstPos) <= maxPos) return firstPos;
+        if (double(secondPos) >= minPos && double(secondPos) <= maxPos) return secondPos;
+    }
+    return llround(pos);
+}
+
+///
+/// @brief 一次扫描计算多路分割位置
+/// @param paths [in] 待分割区域
+/// @param ratioVec [in] 前 k 份各自所占面积比例, 剩余部分为最后一份
+/// @param splitHorizon [out] 1为水平分割(沿Y), 0为垂直分割(沿X)
+/// @return k 个单调递增的分割位置
+///
+std::vector<long long> AreaSweepDivider::calcSplitPos(const Paths &paths, const std::vector<double> &ratioVec,
+                                                      int &splitHorizon)
+{
+    std::vector<long long> posVec;
+    splitHorizon = 1;
+
+    // 非零规则整理, 保证外轮廓与孔洞方向一致
+    Paths polygons;
+    SimplifyPolygons(paths, polygons, pftNonZero);
+    if (polygons.empty()) return posVec;
+
+    cInt minX = polygons.front().front().X, maxX = minX;
+    cInt minY = polygons.front().front().Y, maxY = minY;
+    for (const auto &path : polygons)
+    {
+        for (const auto &pt : path)
+        {
+            minX = std::min(minX, pt.X);
+            maxX = std::max(maxX, pt.X);
+            minY = std::min(minY, pt.Y);
+            maxY = std::max(maxY, pt.Y);
+        }
+    }
+    splitHorizon = ((maxY - minY) >= (maxX - minX)) ? 1 : 0;
+    createSweepTable(polygons, splitHorizon);
+
+    const double origin = double(splitHorizon ? minY : minX);
+    double ratio = 0.0;
+    posVec.reserve(ratioVec.size());
+    for (const auto &r : ratioVec)
+    {
+        ratio += r;
+        const double targetArea = std::min(1.0, ratio) * _sweepTable._totalArea;
+        posVec.push_back(roundPos(double(_sweepTable.solveRounded(targetArea, _maxError, origin))));
+    }
+    return posVec;
+}
+
+long long AreaSweepDivider::calcWeightPos(const Paths &paths, const double &ratio, int &splitHorizon)
+{
+    auto posVec = calcSplitPos(paths, { ratio }, splitHorizon);
+    return posVec.empty() ? 0 : posVec.front();
+}
+
+///
+/// @brief 直接由多边形边建立累计面积表
+/// @param polygons [in] 方向已规整的多边形
+/// @param splitHorizon [in] 1沿Y轴, 0沿X轴
+/// @details 实现步骤:
+///   1. 截线长度 = 向上(水平分割)或向左(垂直分割)的边在该处的横坐标之和减去反向边之和
+///   2. 每条非平行边在其跨度内贡献一个线性段, 记为起止两个事件
+///   3. 坐标以包围盒最小值为原点, 减小浮点误差
+///   4. 总面积为负时(方向相反)整体取反
+///
+void AreaSweepDivider::createSweepTable(const Paths &polygons, const int &splitHorizon)
+{
+    cInt originT = std::numeric_limits<cInt>::max();
+    cInt originS = std::numeric_limits<cInt>::max();
+    size_t ptCnt = 0;
+    for (const auto &path : polygons)
+    {
+        ptCnt += path.size();
+        for (const auto &pt : path)
+        {
+            originT = std::min(originT, splitHorizon ? pt.Y : pt.X);
+            originS = std::min(originS, splitHorizon ? pt.X : pt.Y);
+        }
+    }
+
+    std::vector<AreaSweepEvent> eventVec;
+    eventVec.reserve(ptCnt * 2);
+    for (const auto &path : polygons)
+    {
+        if (path.size() < 3) continue;
+        size_t prev = path.size() - 1;
+        for (size_t i = 0; i < path.size(); prev = i ++)
+        {
+            const auto &p = path[prev];
+            const auto &q = path[i];
+            const double t1 = double((splitHorizon ? p.Y : p.X) - originT);
+            const double t2 = double((splitHorizon ? q.Y : q.X) - originT);
+            if (t1 == t2) continue;
+
+            const double s1 = double((splitHorizon ? p.X : p.Y) - originS);
+            const double s2 = double((splitHorizon ? q.X : q.Y) - originS);
+            const double sign = splitHorizon ? (t2 > t1 ? 1.0 : -1.0) : (t2 < t1 ? 1.0 : -1.0);
+            const double slope = (s2 - s1) / (t2 - t1);
+
+            const double tMin = std::min(t1, t2);
+            const double tMax = std::max(t1, t2);
+            const double sMin = (t1 < t2) ? s1 : s2;
+            const double sMax = (t1 < t2) ? s2 : s1;
+            eventVec.emplace_back(tMin, sign * sMin, sign * slope);
+            eventVec.emplace_back(tMax, -sign * sMax, -sign * slope);
+        }
+    }
+
+    // 方向相反时取反
+    double fArea = 0.0;
+    for (const auto &path : polygons) fArea += Area(path);
+    if (fArea < 0)
+    {
+        for (auto &event : eventVec)
+        {
+            event._widthJump = -event._widthJump;
+            event._slopeDelta = -event._slopeDelta;
+        }
+    }
+    _sweepTable.build(eventVec);
+}
+
+long long AreaSweepDivider::roundPos(const double &pos) const
+{
+    return llround(pos / double(_precision)) * _precision;
+}
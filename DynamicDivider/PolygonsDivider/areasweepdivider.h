@@ -0,0 +1,56 @@
+#ifndef AREASWEEPDIVIDER_H
+#define AREASWEEPDIVIDER_H
+
+#include <vector>
+
+#include "Clipper/clipper.hpp"
+
+// 截线长度函数的变化事件: 在 _pos 处截线长度跳变 _widthJump, 斜率变化 _slopeDelta
+struct AreaSweepEvent {
+    AreaSweepEvent() = default;
+    AreaSweepEvent(const double &pos, const double &widthJump, const double &slopeDelta)
+        : _pos(pos), _widthJump(widthJump), _slopeDelta(slopeDelta) {}
+    double _pos = 0.0;
+    double _widthJump = 0.0;
+    double _slopeDelta = 0.0;
+};
+
+///
+/// @brief 沿分割轴的累计面积表
+/// @details 截线长度在相邻事件之间为线性函数, 累计面积A(t)为分段二次函数,
+///   建表O(n log n), 由目标面积反解位置O(log n)
+///
+struct AreaSweepTable {
+    double _totalArea = 0.0;
+    std::vector<double> _posVec;      // 事件位置
+    std::vector<double> _areaVec;     // 事件位置处累计面积
+    std::vector<double> _widthVec;    // 事件位置右侧截线长度
+    std::vector<double> _slopeVec;    // 事件位置右侧截线长度斜率
+
+    void build(std::vector<AreaSweepEvent> &);
+    double solve(const double &) const;
+    long long solveRounded(const double &, const double &, const double &) const;
+    inline bool empty() const { return _posVec.empty(); }
+};
+
+class AreaSweepDivider
+{
+public:
+    AreaSweepDivider() = default;
+
+    inline void setPrecision(const long long &precision) { _precision = precision > 0 ? precision : 1; }
+    inline void setMaxError(const double &maxError) { _maxError = maxError; }
+    std::vector<long long> calcSplitPos(const ClipperLib::Paths &, const std::vector<double> &, int &splitHorizon);
+    long long calcWeightPos(const ClipperLib::Paths &, const double &, int &splitHorizon);
+
+private:
+    void createSweepTable(const ClipperLib::Paths &, const int &);
+    long long roundPos(const double &) const;
+
+private:
+    long long _precision = 1;         // 分割位置网格
+    double _maxError = 0.0;           // 允许的面积误差, 误差范围内分割位置取整到尽量粗的网格
+    AreaSweepTable _sweepTable;
+};
+
+#endif // AREASWEEPDIVIDER_H
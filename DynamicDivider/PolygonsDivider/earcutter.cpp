@@ -0,0 +1,563 @@
+#include "earcutter.h"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+using namespace ClipperLib;
+
+// 顶点数超过该值时启用Z序索引
+#define EARCUT_HASH_THRESHOLD   80
+
+///
+/// @brief 对一个外轮廓及其孔洞进行三角剖分
+/// @param outer [in] 外轮廓
+/// @param holes [in] 位于外轮廓内的孔洞
+/// @details 实现步骤:
+///   1. 外轮廓与孔洞依次展开到顶点数组, 构造双向链表
+///   2. 按孔洞最左点由左至右, 逐个通过桥接边并入外轮廓
+///   3. 顶点数较多时建立Z序索引
+///   4. 循环切耳, 失败时依次执行去重、修复局部自交、对角线分裂
+///
+void EarCutter::triangulate(const Path &outer, const Paths &holes)
+{
+    _vertices.clear();
+    _indices.clear();
+    _nodes.clear();
+    if (outer.size() < 3) return;
+
+    size_t len = outer.size();
+    for (const auto &hole : holes) len += hole.size();
+    _vertices.reserve(len);
+    _indices.reserve((len + holes.size() * 2) * 3);
+
+    Node *outerNode = linkedList(outer, true);
+    if (nullptr == outerNode || outerNode->_prev == outerNode->_next) return;
+    if (holes.size()) outerNode = eliminateHoles(holes, outerNode);
+
+    _hashing = len > EARCUT_HASH_THRESHOLD;
+    if (_hashing)
+    {
+        double maxX = outerNode->_x, maxY = outerNode->_y;
+        _minX = outerNode->_x;
+        _minY = outerNode->_y;
+        Node *p = outerNode->_next;
+        do {
+            _minX = std::min(_minX, p->_x);
+            _minY = std::min(_minY, p->_y);
+            maxX = std::max(maxX, p->_x);
+            maxY = std::max(maxY, p->_y);
+            p = p->_next;
+        } while (p != outerNode);
+
+        _invSize = std::max(maxX - _minX, maxY - _minY);
+        _invSize = (0.0 != _invSize) ? (32767.0 / _invSize) : 0.0;
+    }
+
+    earcutLinked(outerNode);
+    _nodes.clear();
+}
+
+EarCutter::Node *EarCutter::linkedList(const Path &path, const bool &clockwise)
+{
+    const auto len = path.size();
+    const auto offset = uint32_t(_vertices.size());
+    _vertices.insert(_vertices.end(), path.begin(), path.end());
+
+    double sum = 0.0;
+    for (size_t i = 0, j = len > 0 ? len - 1 : 0; i < len; j = i ++)
+    {
+        sum += (double(path[j].X) - path[i].X) * (double(path[i].Y) + path[j].Y);
+    }
+
+    Node *last = nullptr;
+    if (clockwise == (sum > 0))
+    {
+        for (size_t i = 0; i < len; ++ i) last = insertNode(offset + uint32_t(i), path[i], last);
+    }
+    else
+    {
+        for (size_t i = len; i -- > 0;) last = insertNode(offset + uint32_t(i), path[i], last);
+    }
+
+    if (last && equals(last, last->_next))
+    {
+        removeNode(last);
+        last = last->_next;
+    }
+    return last;
+}
+
+// 移除重复点与共线点
+EarCutter::Node *EarCutter::filterPoints(Node *start, Node *end)
+{
+    if (nullptr == end) end = start;
+
+    Node *p = start;
+    bool again = false;
+    do {
+        again = false;
+        if (false == p->_steiner && (equals(p, p->_next) || 0.0 == area(p->_prev, p, p->_next)))
+        {
+            removeNode(p);
+            p = end = p->_prev;
+            if (p == p->_next) break;
+            again = true;
+        }
+        else p = p->_next;
+    } while (again || p != end);
+
+    return end;
+}
+
+void EarCutter::earcutLinked(Node *ear, const int &pass)
+{
+    if (nullptr == ear) return;
+    if (0 == pass && _hashing) indexCurve(ear);
+
+    Node *stop = ear;
+    while (ear->_prev != ear->_next)
+    {
+        Node *prev = ear->_prev;
+        Node *next = ear->_next;
+
+        if (_hashing ? isEarHashed(ear) : isEar(ear))
+        {
+            _indices.push_back(prev->_i);
+            _indices.push_back(ear->_i);
+            _indices.push_back(next->_i);
+            removeNode(ear);
+
+            // 跳过下一个顶点可减少细长三角形
+            ear = next->_next;
+            stop = next->_next;
+            continue;
+        }
+
+        ear = next;
+        if (ear == stop)
+        {
+            if (0 == pass) earcutLinked(filterPoints(ear), 1);
+            else if (1 == pass) earcutLinked(cureLocalIntersections(filterPoints(ear)), 2);
+            else if (2 == pass) splitEarcut(ear);
+            break;
+        }
+    }
+}
+
+bool EarCutter::isEar(Node *ear)
+{
+    const Node *a = ear->_prev;
+    const Node *b = ear;
+    const Node *c = ear->_next;
+    if (area(a, b, c) >= 0) return false;
+
+    Node *p = ear->_next->_next;
+    while (p != ear->_prev)
+    {
+        if (pointInTriangle(a->_x, a->_y, b->_x, b->_y, c->_x, c->_y, p->_x, p->_y) &&
+            area(p->_prev, p, p->_next) >= 0) return false;
+        p = p->_next;
+    }
+    return true;
+}
+
+// 只检测Z序落在三角形包围盒范围内的顶点
+bool EarCutter::isEarHashed(Node *ear)
+{
+    const Node *a = ear->_prev;
+    const Node *b = ear;
+    const Node *c = ear->_next;
+    if (area(a, b, c) >= 0) return false;
+
+    const double minTX = std::min(a->_x, std::min(b->_x, c->_x));
+    const double minTY = std::min(a->_y, std::min(b->_y, c->_y));
+    const double maxTX = std::max(a->_x, std::max(b->_x, c->_x));
+    const double maxTY = std::max(a->_y, std::max(b->_y, c->_y));
+
+    const int32_t minZ = zOrder(minTX, minTY);
+    const int32_t maxZ = zOrder(maxTX, maxTY);
+
+    auto funcBlocking = [&](const Node *p) -> bool {
+        return p != ear->_prev && p != ear->_next &&
+               pointInTriangle(a->_x, a->_y, b->_x, b->_y, c->_x, c->_y, p->_x, p->_y) &&
+               area(p->_prev, p, p->_next) >= 0;
+    };
+
+    Node *p = ear->_prevZ;
+    Node *n = ear->_nextZ;
+    while (p && p->_z >= minZ && n && n->_z <= maxZ)
+    {
+        if (funcBlocking(p)) return false;
+        p = p->_prevZ;
+        if (funcBlocking(n)) return false;
+        n = n->_nextZ;
+    }
+    while (p && p->_z >= minZ)
+    {
+        if (funcBlocking(p)) return false;
+        p = p->_prevZ;
+    }
+    while (n && n->_z <= maxZ)
+    {
+        if (funcBlocking(n)) return false;
+        n = n->_nextZ;
+    }
+    return true;
+}
+
+EarCutter::Node *EarCutter::cureLocalIntersections(Node *start)
+{
+    Node *p = start;
+    do {
+        Node *a = p->_prev;
+        Node *b = p->_next->_next;
+
+        if (false == equals(a, b) && intersects(a, p, p->_next, b) && locallyInside(a, b) && locallyInside(b, a))
+        {
+            _indices.push_back(a->_i);
+            _indices.push_back(p->_i);
+            _indices.push_back(b->_i);
+
+            removeNode(p);
+            removeNode(p->_next);
+            p = start = b;
+        }
+        p = p->_next;
+    } while (p != start);
+
+    return filterPoints(p);
+}
+
+// 寻找有效对角线将多边形一分为二分别剖分
+void EarCutter::splitEarcut(Node *start)
+{
+    Node *a = start;
+    do {
+        Node *b = a->_next->_next;
+        while (b != a->_prev)
+        {
+            if (a->_i != b->_i && isValidDiagonal(a, b))
+            {
+                Node *c = splitPolygon(a, b);
+                a = filterPoints(a, a->_next);
+                c = filterPoints(c, c->_next);
+                earcutLinked(a);
+                earcutLinked(c);
+                return;
+            }
+            b = b->_next;
+        }
+        a = a->_next;
+    } while (a != start);
+}
+
+EarCutter::Node *EarCutter::eliminateHoles(const Paths &holes, Node *outerNode)
+{
+    std::vector<Node *> queue;
+    queue.reserve(holes.size());
+    for (const auto &hole : holes)
+    {
+        Node *list = linkedList(hole, false);
+        if (nullptr == list) continue;
+        if (list == list->_next) list->_steiner = true;
+        queue.push_back(getLeftmost(list));
+    }
+    std::sort(queue.begin(), queue.end(), [](const Node *a, const Node *b) { return a->_x < b->_x; });
+
+    for (const auto &hole : queue) outerNode = eliminateHole(hole, outerNode);
+    return outerNode;
+}
+
+EarCutter::Node *EarCutter::eliminateHole(Node *hole, Node *outerNode)
+{
+    Node *bridge = findHoleBridge(hole, outerNode);
+    if (nullptr == bridge) return outerNode;
+
+    Node *bridgeReverse = splitPolygon(bridge, hole);
+    filterPoints(bridgeReverse, bridgeReverse->_next);
+    return filterPoints(bridge, bridge->_next);
+}
+
+// David Eberly 孔洞桥接: 自孔洞最左点向左射线, 取可见的外轮廓顶点
+EarCutter::Node *EarCutter::findHoleBridge(Node *hole, Node *outerNode)
+{
+    Node *p = outerNode;
+    const double hx = hole->_x;
+    const double hy = hole->_y;
+    double qx = -std::numeric_limits<double>::infinity();
+    Node *m = nullptr;
+
+    do {
+        if (hy <= p->_y && hy >= p->_next->_y && p->_next->_y != p->_y)
+        {
+            double x = p->_x + (hy - p->_y) * (p->_next->_x - p->_x) / (p->_next->_y - p->_y);
+            if (x <= hx && x > qx)
+            {
+                qx = x;
+                m = p->_x < p->_next->_x ? p : p->_next;
+                if (x == hx) return m;
+            }
+        }
+        p = p->_next;
+    } while (p != outerNode);
+
+    if (nullptr == m) return nullptr;
+
+    const Node *stop = m;
+    double tanMin = std::numeric_limits<double>::infinity();
+    const double mx = m->_x;
+    const double my = m->_y;
+
+    p = m;
+    do {
+        if (hx >= p->_x && p->_x >= mx && hx != p->_x &&
+            pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->_x, p->_y))
+        {
+            double tanCur = std::abs(hy - p->_y) / (hx - p->_x);
+            if (locallyInside(p, hole) &&
+                (tanCur < tanMin || (tanCur == tanMin && (p->_x > m->_x || sectorContainsSector(m, p)))))
+            {
+                m = p;
+                tanMin = tanCur;
+            }
+        }
+        p = p->_next;
+    } while (p != stop);
+
+    return m;
+}
+
+bool EarCutter::sectorContainsSector(const Node *m, const Node *p)
+{
+    return area(m->_prev, m, p->_prev) < 0 && area(p->_next, m, m->_next) < 0;
+}
+
+void EarCutter::indexCurve(Node *start)
+{
+    Node *p = start;
+    do {
+        p->_z = p->_z ? p->_z : zOrder(p->_x, p->_y);
+        p->_prevZ = p->_prev;
+        p->_nextZ = p->_next;
+        p = p->_next;
+    } while (p != start);
+
+    p->_prevZ->_nextZ = nullptr;
+    p->_prevZ = nullptr;
+    sortLinked(p);
+}
+
+// 按Z序对链表归并排序
+EarCutter::Node *EarCutter::sortLinked(Node *list)
+{
+    int inSize = 1;
+    while (true)
+    {
+        Node *p = list;
+        Node *tail = nullptr;
+        list = nullptr;
+        int numMerges = 0;
+
+        while (p)
+        {
+            ++ numMerges;
+            Node *q = p;
+            int pSize = 0;
+            for (int i = 0; i < inSize; ++ i)
+            {
+                ++ pSize;
+                q = q->_nextZ;
+                if (nullptr == q) break;
+            }
+
+            int qSize = inSize;
+            while (pSize > 0 || (qSize > 0 && q))
+            {
+                Node *e = nullptr;
+                if (0 == pSize) { e = q; q = q->_nextZ; -- qSize; }
+                else if (0 == qSize || nullptr == q) { e = p; p = p->_nextZ; -- pSize; }
+                else if (p->_z <= q->_z) { e = p; p = p->_nextZ; -- pSize; }
+                else { e = q; q = q->_nextZ; -- qSize; }
+
+                if (tail) tail->_nextZ = e;
+                else list = e;
+                e->_prevZ = tail;
+                tail = e;
+            }
+            p = q;
+        }
+
+        tail->_nextZ = nullptr;
+        if (numMerges <= 1) return list;
+        inSize *= 2;
+    }
+}
+
+int32_t EarCutter::zOrder(const double &fx, const double &fy) const
+{
+    int32_t x = static_cast<int32_t>((fx - _minX) * _invSize);
+    int32_t y = static_cast<int32_t>((fy - _minY) * _invSize);
+
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+
+    y = (y | (y << 8)) & 0x00FF00FF;
+    y = (y | (y << 4)) & 0x0F0F0F0F;
+    y = (y | (y << 2)) & 0x33333333;
+    y = (y | (y << 1)) & 0x55555555;
+
+    return x | (y << 1);
+}
+
+EarCutter::Node *EarCutter::getLeftmost(Node *start)
+{
+    Node *p = start;
+    Node *leftmost = start;
+    do {
+        if (p->_x < leftmost->_x || (p->_x == leftmost->_x && p->_y < leftmost->_y)) leftmost = p;
+        p = p->_next;
+    } while (p != start);
+    return leftmost;
+}
+
+bool EarCutter::pointInTriangle(const double &ax, const double &ay, const double &bx, const double &by,
+                                const double &cx, const double &cy, const double &px, const double &py) const
+{
+    return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+           (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+           (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+
+bool EarCutter::isValidDiagonal(Node *a, Node *b)
+{
+    return a->_next->_i != b->_i && a->_prev->_i != b->_i && false == intersectsPolygon(a, b) &&
+           ((locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) &&
+             (0.0 != area(a->_prev, a, b->_prev) || 0.0 != area(a, b->_prev, b))) ||
+            (equals(a, b) && area(a->_prev, a, a->_next) > 0 && area(b->_prev, b, b->_next) > 0));
+}
+
+double EarCutter::area(const Node *p, const Node *q, const Node *r) const
+{
+    return (q->_y - p->_y) * (r->_x - q->_x) - (q->_x - p->_x) * (r->_y - q->_y);
+}
+
+bool EarCutter::equals(const Node *p1, const Node *p2) const
+{
+    return p1->_x == p2->_x && p1->_y == p2->_y;
+}
+
+bool EarCutter::intersects(const Node *p1, const Node *q1, const Node *p2, const Node *q2) const
+{
+    int o1 = sign(area(p1, q1, p2));
+    int o2 = sign(area(p1, q1, q2));
+    int o3 = sign(area(p2, q2, p1));
+    int o4 = sign(area(p2, q2, q1));
+
+    if (o1 != o2 && o3 != o4) return true;
+    if (0 == o1 && onSegment(p1, p2, q1)) return true;
+    if (0 == o2 && onSegment(p1, q2, q1)) return true;
+    if (0 == o3 && onSegment(p2, p1, q2)) return true;
+    if (0 == o4 && onSegment(p2, q1, q2)) return true;
+    return false;
+}
+
+bool EarCutter::onSegment(const Node *p, const Node *q, const Node *r) const
+{
+    return q->_x <= std::max(p->_x, r->_x) && q->_x >= std::min(p->_x, r->_x) &&
+           q->_y <= std::max(p->_y, r->_y) && q->_y >= std::min(p->_y, r->_y);
+}
+
+int EarCutter::sign(const double &val) const
+{
+    return (0.0 < val) - (val < 0.0);
+}
+
+bool EarCutter::intersectsPolygon(const Node *a, const Node *b) const
+{
+    const Node *p = a;
+    do {
+        if (p->_i != a->_i && p->_next->_i != a->_i && p->_i != b->_i && p->_next->_i != b->_i &&
+            intersects(p, p->_next, a, b)) return true;
+        p = p->_next;
+    } while (p != a);
+    return false;
+}
+
+bool EarCutter::locallyInside(const Node *a, const Node *b) const
+{
+    return area(a->_prev, a, a->_next) < 0 ?
+               area(a, b, a->_next) >= 0 && area(a, a->_prev, b) >= 0 :
+               area(a, b, a->_prev) < 0 || area(a, a->_next, b) < 0;
+}
+
+bool EarCutter::middleInside(const Node *a, const Node *b) const
+{
+    const Node *p = a;
+    bool inside = false;
+    const double px = (a->_x + b->_x) * 0.5;
+    const double py = (a->_y + b->_y) * 0.5;
+    do {
+        if (((p->_y > py) != (p->_next->_y > py)) && p->_next->_y != p->_y &&
+            (px < (p->_next->_x - p->_x) * (py - p->_y) / (p->_next->_y - p->_y) + p->_x))
+            inside = !inside;
+        p = p->_next;
+    } while (p != a);
+    return inside;
+}
+
+// 沿对角线a-b拆分多边形, 返回新多边形上的b副本
+EarCutter::Node *EarCutter::splitPolygon(Node *a, Node *b)
+{
+    _nodes.emplace_back(a->_i, a->_x, a->_y);
+    Node *a2 = &_nodes.back();
+    _nodes.emplace_back(b->_i, b->_x, b->_y);
+    Node *b2 = &_nodes.back();
+    Node *an = a->_next;
+    Node *bp = b->_prev;
+
+    a->_next = b;
+    b->_prev = a;
+
+    a2->_next = an;
+    an->_prev = a2;
+
+    b2->_next = a2;
+    a2->_prev = b2;
+
+    bp->_next = b2;
+    b2->_prev = bp;
+
+    return b2;
+}
+
+EarCutter::Node *EarCutter::insertNode(const uint32_t &index, const IntPoint &pt, Node *last)
+{
+    _nodes.emplace_back(index, double(pt.X), double(pt.Y));
+    Node *p = &_nodes.back();
+
+    if (nullptr == last)
+    {
+        p->_prev = p;
+        p->_next = p;
+    }
+    else
+    {
+        p->_next = last->_next;
+        p->_prev = last;
+        last->_next->_prev = p;
+        last->_next = p;
+    }
+    return p;
+}
+
+void EarCutter::removeNode(Node *p)
+{
+    p->_next->_prev = p->_prev;
+    p->_prev->_next = p->_next;
+
+    if (p->_prevZ) p->_prevZ->_nextZ = p->_nextZ;
+    if (p->_nextZ) p->_nextZ->_prevZ = p->_prevZ;
+}
@@ -0,0 +1,80 @@
+#ifndef EARCUTTER_H
+#define EARCUTTER_H
+
+#include <vector>
+#include <deque>
+#include <cstdint>
+
+#include "Clipper/clipper.hpp"
+
+///
+/// ! @coreclass{EarCutter}
+/// 带孔多边形耳切三角剖分, 孔洞通过桥接边并入外轮廓,
+/// 顶点数较多时使用Z序曲线索引加速耳朵检测, 复杂度接近 O(n log n)
+///
+class EarCutter
+{
+public:
+    EarCutter() = default;
+
+    void triangulate(const ClipperLib::Path &, const ClipperLib::Paths &);
+
+    inline const std::vector<ClipperLib::IntPoint> &vertices() const { return _vertices; }
+    inline const std::vector<uint32_t> &indices() const { return _indices; }
+
+private:
+    struct Node {
+        Node(const uint32_t &index, const double &x, const double &y) : _i(index), _x(x), _y(y) {}
+        uint32_t _i = 0;
+        double _x = 0.0;
+        double _y = 0.0;
+        Node *_prev = nullptr;
+        Node *_next = nullptr;
+        int32_t _z = 0;
+        Node *_prevZ = nullptr;
+        Node *_nextZ = nullptr;
+        bool _steiner = false;
+    };
+
+    Node *linkedList(const ClipperLib::Path &, const bool &);
+    Node *filterPoints(Node *, Node *end = nullptr);
+    void earcutLinked(Node *, const int &pass = 0);
+    bool isEar(Node *);
+    bool isEarHashed(Node *);
+    Node *cureLocalIntersections(Node *);
+    void splitEarcut(Node *);
+    Node *eliminateHoles(const ClipperLib::Paths &, Node *);
+    Node *eliminateHole(Node *, Node *);
+    Node *findHoleBridge(Node *, Node *);
+    bool sectorContainsSector(const Node *, const Node *);
+    void indexCurve(Node *);
+    Node *sortLinked(Node *);
+    int32_t zOrder(const double &, const double &) const;
+    Node *getLeftmost(Node *);
+    bool pointInTriangle(const double &, const double &, const double &, const double &,
+                         const double &, const double &, const double &, const double &) const;
+    bool isValidDiagonal(Node *, Node *);
+    double area(const Node *, const Node *, const Node *) const;
+    bool equals(const Node *, const Node *) const;
+    bool intersects(const Node *, const Node *, const Node *, const Node *) const;
+    bool onSegment(const Node *, const Node *, const Node *) const;
+    int sign(const double &) const;
+    bool intersectsPolygon(const Node *, const Node *) const;
+    bool locallyInside(const Node *, const Node *) const;
+    bool middleInside(const Node *, const Node *) const;
+    Node *splitPolygon(Node *, Node *);
+    Node *insertNode(const uint32_t &, const ClipperLib::IntPoint &, Node *);
+    void removeNode(Node *);
+
+private:
+    std::vector<ClipperLib::IntPoint> _vertices;
+    std::vector<uint32_t> _indices;
+    std::deque<Node> _nodes;
+
+    bool _hashing = false;
+    double _minX = 0.0;
+    double _minY = 0.0;
+    double _invSize = 0.0;
+};
+
+#endif // EARCUTTER_H
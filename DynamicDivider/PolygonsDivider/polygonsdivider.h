@@ -24,7 +24,6 @@ struct DivideSolidData {
     }
 };
 
-struct MinErrResult;
 struct EaringTriangle;
 class PolygonsDivider
 {
@@ -34,26 +33,15 @@ public:
 public:
     long long calcWeightPos(const ClipperLib::Paths &, const double &, int &splitHorizon);
     void setMaxError(const double &);
+    void setPrecision(const long long &);
 
 private:
     void createEaring(const ClipperLib::Paths &);
+    void createEaring(const ClipperLib::PolyNode *);
     long long getWeightPos(const double &, int &);
-    void pathsToList(const ClipperLib::Path &, std::list<ClipperLib::IntPoint> &ptList);
-    void createEaring_outter(std::list<ClipperLib::IntPoint> &ptList);
-    void createEaring_inner(std::list<ClipperLib::IntPoint> &ptList);
     void appendEaringTriangle(const ClipperLib::IntPoint &,  const ClipperLib::IntPoint &,
                               const ClipperLib::IntPoint &, const double &);
-    void appendEaringTriangle(const EaringTriangle &);
-
-    void getWeightPos(const double &, const long long &, const long long &, MinErrResult &);
-    void calcInsertPt(const ClipperLib::IntPoint &, const ClipperLib::IntPoint &, const long long &,
-                      ClipperLib::DoublePoint &);
-    void divideTriangle(const ClipperLib::Path &, const double &, const long long &, double &, double &);
-
-    void getWeightPos_ver(const double &, const long long &, const long long &, MinErrResult &);
-    void calcInsertPt_ver(const ClipperLib::IntPoint &, const ClipperLib::IntPoint &, const long long &,
-                          ClipperLib::DoublePoint &);
-    void divideTriangle_ver(const ClipperLib::Path &, const double &, const long long &, double &, double &);
+    void createAreaSweep(const int &);
 
 private:
     struct Priv;
@@ -0,0 +1,135 @@
+#include "slicestore.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+#include <limits>
+
+using namespace ClipperLib;
+
+namespace {
+// 两路独立的64位散列, 联合使用使误判概率可忽略
+struct SliceHasher {
+    quint64 _fnv = 14695981039346656037ULL;
+    quint64 _mix = 0x9E3779B97F4A7C15ULL;
+
+    inline void append(const quint64 &value) {
+        for (int i = 0; i < 8; ++ i)
+        {
+            _fnv ^= (value >> (i * 8)) & 0xFF;
+            _fnv *= 1099511628211ULL;
+        }
+        quint64 z = value + _mix + 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        _mix = (z ^ (z >> 31)) ^ (_mix << 1);
+    }
+};
+}
+
+///
+/// @brief 计算切片键
+/// @param pathsVec [in] 参与派生计算的全部轮廓, 首项为当前层轮廓, 空指针表示该位置无数据
+/// @param layer [in] 层号
+/// @param paraPtr [in] 工艺参数地址, 参数不同的零件不共享
+/// @param origin [out] 当前层轮廓包围盒原点, 各轮廓以此为基准归一化
+/// @return 切片键
+///
+SliceKey SliceStore::createKey(const std::vector<const Paths *> &pathsVec, const int &layer, const void *paraPtr,
+                               IntPoint &origin)
+{
+    origin = IntPoint(0, 0);
+    if (pathsVec.size() && pathsVec.front())
+    {
+        cInt minX = std::numeric_limits<cInt>::max();
+        cInt minY = std::numeric_limits<cInt>::max();
+        for (const auto &path : *pathsVec.front())
+        {
+            for (const auto &pt : path)
+            {
+                minX = std::min(minX, pt.X);
+                minY = std::min(minY, pt.Y);
+            }
+        }
+        if (minX != std::numeric_limits<cInt>::max()) origin = IntPoint(minX, minY);
+    }
+
+    SliceHasher hasher;
+    hasher.append(pathsVec.size());
+    for (const auto &paths : pathsVec)
+    {
+        if (nullptr == paths)
+        {
+            hasher.append(std::numeric_limits<quint64>::max());
+            continue;
+        }
+        hasher.append(paths->size());
+        for (const auto &path : *paths)
+        {
+            hasher.append(path.size());
+            for (const auto &pt : path)
+            {
+                hasher.append(quint64(pt.X - origin.X));
+                hasher.append(quint64(pt.Y - origin.Y));
+            }
+        }
+    }
+
+    SliceKey key;
+    key._hash1 = hasher._fnv;
+    key._hash2 = hasher._mix;
+    key._layer = layer;
+    key._paraPtr = paraPtr;
+    return key;
+}
+
+void SliceStore::translatePaths(const Paths &paths, const IntPoint &offset, Paths &outPaths)
+{
+    outPaths.resize(paths.size());
+    for (size_t i = 0; i < paths.size(); ++ i)
+    {
+        const auto &path = paths[i];
+        auto &outPath = outPaths[i];
+        outPath.resize(path.size());
+        for (size_t j = 0; j < path.size(); ++ j)
+        {
+            outPath[j].X = path[j].X + offset.X;
+            outPath[j].Y = path[j].Y + offset.Y;
+        }
+    }
+}
+
+SliceDataPtr SliceStore::find(const SliceKey &key)
+{
+    QMutexLocker locker(&_locker);
+    return _sliceHash.value(key).toStrongRef();
+}
+
+///
+/// @brief 插入切片数据
+/// @return 已存在有效条目时返回已有数据, 否则返回插入的数据
+///
+SliceDataPtr SliceStore::insert(const SliceKey &key, const SliceDataPtr &sliceData)
+{
+    QMutexLocker locker(&_locker);
+    auto &weakData = _sliceHash[key];
+    if (auto existData = weakData.toStrongRef()) return existData;
+
+    weakData = sliceData;
+    return sliceData;
+}
+
+void SliceStore::removeExpired()
+{
+    QMutexLocker locker(&_locker);
+    for (auto it = _sliceHash.begin(); it != _sliceHash.end();)
+    {
+        if (it.value().isNull()) it = _sliceHash.erase(it);
+        else ++ it;
+    }
+}
+
+void SliceStore::clear()
+{
+    QMutexLocker locker(&_locker);
+    _sliceHash.clear();
+}
@@ -0,0 +1,73 @@
+#ifndef SLICESTORE_H
+#define SLICESTORE_H
+
+#include <QSharedPointer>
+#include <QWeakPointer>
+#include <QMutex>
+#include <QHash>
+#include <vector>
+
+#include "../PolygonsDivider/polygonsdivider.h"
+#include "Clipper/clipper.hpp"
+
+///
+/// @brief 共享切片数据
+/// @details 由零件某层的轮廓派生, 坐标均已平移至当前层轮廓包围盒原点;
+///   创建后只读, 同一几何的多个实例共同引用, 写入时各实例再按自身偏移平移
+///
+struct SliceData {
+    double _fArea = 0.0;
+    ClipperLib::Path _boundPath;                // 简化后轮廓的包围盒对角点
+    ClipperLib::Paths _paths_smallGaps;
+    ClipperLib::Paths _paths_smallHoles;
+    ClipperLib::Paths _paths_exceptHolesAndGaps;
+    ClipperLib::Paths _borderPaths;             // 移除小孔及窄缝后的当前层轮廓, 轮廓权重计算用
+    DivideSolidData _divideData;
+};
+typedef QSharedPointer<const SliceData> SliceDataPtr;
+
+///
+/// @brief 切片键: 平移归一化后的轮廓指纹、层号及参数
+///
+struct SliceKey {
+    quint64 _hash1 = 0;
+    quint64 _hash2 = 0;
+    int _layer = -1;
+    const void *_paraPtr = nullptr;
+
+    inline bool operator==(const SliceKey &key) const {
+        return _hash1 == key._hash1 && _hash2 == key._hash2 &&
+               _layer == key._layer && _paraPtr == key._paraPtr;
+    }
+};
+
+inline uint qHash(const SliceKey &key, uint seed = 0)
+{
+    return uint(key._hash1 ^ (key._hash1 >> 32)) ^ uint(key._layer) ^ seed;
+}
+
+///
+/// ! @coreclass{SliceStore}
+/// 按 (几何指纹, 层) 索引的共享切片数据, 仅保存弱引用,
+/// 所有引用方释放后条目自动失效
+///
+class SliceStore
+{
+public:
+    SliceStore() = default;
+
+    static SliceKey createKey(const std::vector<const ClipperLib::Paths *> &, const int &, const void *,
+                              ClipperLib::IntPoint &origin);
+    static void translatePaths(const ClipperLib::Paths &, const ClipperLib::IntPoint &, ClipperLib::Paths &);
+
+    SliceDataPtr find(const SliceKey &);
+    SliceDataPtr insert(const SliceKey &, const SliceDataPtr &);
+    void removeExpired();
+    void clear();
+
+private:
+    QMutex _locker;
+    QHash<SliceKey, QWeakPointer<const SliceData>> _sliceHash;
+};
+
+#endif // SLICESTORE_H
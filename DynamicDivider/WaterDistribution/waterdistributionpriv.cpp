@@ -12,45 +12,89 @@ std::vector<DistributionResult> WaterDistributionPriv::initDistribution(const st
     std::vector<DistributionResult> res;
     _distributionNum = containerCnt < 1 ? 1 : containerCnt;
     _tolerance = tolerance;
+    _maxTotalWeight = 0.0;
     std::vector<PartInfo> mateVec;
     _averageWeight = createMateVec(inMap, mateVec, _distributionNum);
     sortWeightVec(mateVec);
 
-    startDistribution(res, mateVec, containerCnt, 0);
+    startDistribution(res, mateVec, _distributionNum);
     return res;
 }
 
+///
+/// @brief 注水分配
+/// @param res [out] 各容器分配结果, 下标即容器序号
+/// @param mateVec [in] 已排序的零件: 指定容器的零件(序号为负)在前, 其余按权重降序
+/// @param containerCnt [in] 容器数量
+/// @details 实现步骤:
+///   1. 指定容器的零件直接放入对应容器
+///   2. 以容器负载建立最小堆, 其余零件依次放入负载最小的容器
+///   3. 可分割零件超出平均负载(允许偏差之外)时, 先注满当前容器, 余量继续分配;
+///      分割两侧均不小于最小分割面积
+///   4. 分段记录在预分配的扁平数组中, 最后按容器一次性整理输出
+///
 void WaterDistributionPriv::startDistribution(std::vector<DistributionResult> &res,
                                               std::vector<PartInfo> &mateVec,
-                                              const int &containerCnt,
-                                              const int &startPos)
+                                              const int &containerCnt)
 {
-    if (containerCnt > 1)
-    {
-        int leftContainerCnt_1 = containerCnt >> 1;
-        int leftContainerCnt_2 = leftContainerCnt_1;
-
-        double fRate1 = 0.5, fRate2 = 0.5;
+    const int cnt = std::max(1, containerCnt);
 
-        if (containerCnt & 0x1)
-        {
-            leftContainerCnt_2 = leftContainerCnt_1 + 1;
+    _segementVec.clear();
+    _segementVec.reserve(mateVec.size() + cnt - 1);
+    _loadVec.assign(cnt, 0.0);
 
-            fRate1 = double(leftContainerCnt_1) / (containerCnt);
-            fRate2 = 1 - fRate1;
-        }
-        std::vector<PartInfo> out1, out2;
-        segementParts(mateVec, out1, out2, fRate1, fRate2, startPos + leftContainerCnt_1);
-        startDistribution(res, out1, leftContainerCnt_1, startPos);
-        startDistribution(res, out2, leftContainerCnt_2, startPos + leftContainerCnt_1);
+    double totalWeight = 0.0;
+    int partIndex = 0;
+    for (const auto &partInfo : mateVec) totalWeight += partInfo._realWeight;
+    for (; partIndex < int(mateVec.size()) && mateVec[partIndex]._index < 0; ++ partIndex)
+    {
+        const int container = std::min(std::max(-mateVec[partIndex]._index - 1, 0), cnt - 1);
+        _segementVec.push_back({ container, partIndex, 1.0 });
+        _loadVec[container] += mateVec[partIndex]._realWeight;
     }
-    else
+
+    auto funcLess = [](const ContainerLoad &l1, const ContainerLoad &l2) -> bool {
+        if (l1._load != l2._load) return l1._load > l2._load;
+        return l1._container > l2._container;
+    };
+    _loadHeap.clear();
+    _loadHeap.reserve(cnt);
+    for (int i = 0; i < cnt; ++ i) _loadHeap.push_back({ _loadVec[i], i });
+    std::make_heap(_loadHeap.begin(), _loadHeap.end(), funcLess);
+
+    const double targetWeight = totalWeight / cnt;
+    for (; partIndex < int(mateVec.size()); ++ partIndex)
     {
-        DistributionResult rst;
-        rst._partsList = mateVec;
-        updateResInfo(rst, 0);
-        res.push_back(std::move(rst));
+        const auto &partInfo = mateVec[partIndex];
+        const bool segementable = cnt > 1 && canSegement(partInfo);
+        double leftFactor = 1.0;
+        while (true)
+        {
+            std::pop_heap(_loadHeap.begin(), _loadHeap.end(), funcLess);
+            auto &minLoad = _loadHeap.back();
+
+            const double leftWeight = leftFactor * partInfo._realWeight;
+            const double space = targetWeight - minLoad._load;
+            if (segementable && minLoad._load + leftWeight - targetWeight > _tolerance * targetWeight &&
+                space >= _allowedMinArea && leftWeight - space >= _allowedMinArea)
+            {
+                // 注满当前容器, 余量继续分配
+                const double factor = space / partInfo._realWeight;
+                _segementVec.push_back({ minLoad._container, partIndex, factor });
+                leftFactor -= factor;
+                minLoad._load = targetWeight;
+                std::push_heap(_loadHeap.begin(), _loadHeap.end(), funcLess);
+                continue;
+            }
+
+            _segementVec.push_back({ minLoad._container, partIndex, leftFactor });
+            minLoad._load += leftWeight;
+            std::push_heap(_loadHeap.begin(), _loadHeap.end(), funcLess);
+            break;
+        }
     }
+
+    collectResult(res, mateVec, cnt);
 }
 
 ///private
@@ -58,6 +102,7 @@ double WaterDistributionPriv::createMateVec(const std::map<int, double> &inMap,
                                             std::vector<PartInfo> &mateVec, const int &distributionNum)
 {
     double totalWeight = 0.0;
+    mateVec.reserve(inMap.size());
     for (const auto &inInfo : inMap)
     {
         totalWeight += inInfo.second;
@@ -73,89 +118,30 @@ void WaterDistributionPriv::sortWeightVec(std::vector<PartInfo> &mateVec)
 {
     std::sort(mateVec.begin(), mateVec.end(),
               [](const PartInfo &v1, const PartInfo &v2) -> bool {
+                  if ((v1._index < 0) != (v2._index < 0)) return v1._index < 0;
                   return v1._realWeight > v2._realWeight;
               });
 }
 
-void WaterDistributionPriv::segementParts(std::vector<PartInfo> &inArray, std::vector<PartInfo> &out1,
-                                          std::vector<PartInfo> &out2, const double &rate1, const double &rate2,
-                                          const int &containerCnt)
+///
+/// @brief 按容器整理分段
+/// @details 先统计各容器分段数并预留空间, 再顺序填入, 避免逐个追加时反复扩容
+///
+void WaterDistributionPriv::collectResult(std::vector<DistributionResult> &res,
+                                          const std::vector<PartInfo> &mateVec, const int &containerCnt)
 {
-    if (inArray.size() < 1) return;
-
-    out1.clear();
-    out2.clear();
-
-    std::sort(inArray.begin(), inArray.end(), [](const PartInfo &v1, const PartInfo &v2) -> bool {
-        if (v1._index < 0 && v2._index < 0) return v1._realWeight > v2._realWeight;
-        if (v1._index < 0) return true;
-        if (v2._index < 0) return false;
-        return v1._realWeight > v2._realWeight;
-    });
-
-    double factor = rate2 / rate1;
-    double targetWeight1 = 0.0;
-    for (const auto &partInfo : inArray) targetWeight1 += partInfo._realWeight;
-    targetWeight1 *= rate1;
+    _segementCntVec.assign(containerCnt, 0);
+    for (const auto &segement : _segementVec) ++ _segementCntVec[segement._container];
 
-    DistributionResult res1, res2;
-    int nArraySize = inArray.size();
+    res.clear();
+    res.resize(containerCnt);
+    for (int i = 0; i < containerCnt; ++ i) res[i]._partsList.reserve(_segementCntVec[i]);
 
-    int distributionIndex = 0;
-    while (true)
+    for (const auto &segement : _segementVec)
     {
-        if (distributionIndex >= inArray.size())
-        {
-            distributionIndex = -1;
-            break;
-        }
-        if (inArray[distributionIndex]._index >= 0) break;
-
-        if (abs(inArray[distributionIndex]._index) <= containerCnt) res1 << std::move(inArray[distributionIndex]);
-        else res2 << std::move(inArray[distributionIndex]);
-        ++ distributionIndex;
+        const auto &partInfo = mateVec[segement._partIndex];
+        auto &disRes = res[segement._container];
+        disRes._partsList.push_back(PartInfo(partInfo._index, partInfo._weight, partInfo._factor * segement._factor));
+        disRes._totalWeight += disRes._partsList.back()._realWeight;
     }
-    if (distributionIndex < 0) goto LABEL_END;
-
-    if (inArray[distributionIndex]._realWeight < _allowedSegementArea ||
-        inArray[distributionIndex]._realWeight < _maxTotalWeight)
-    {
-        for (int i = distributionIndex; i < nArraySize; ++ i)
-        {
-            if (res1._totalWeight * factor <= res2._totalWeight) res1 << std::move(inArray[i]);
-            else res2 << std::move(inArray[i]);
-        }
-    }
-    else
-    {
-        // Sample Distribution
-        for (int i = distributionIndex + 1; i < nArraySize; ++ i)
-        {
-            if (i == distributionIndex) continue;
-            if (res1._totalWeight * factor <= res2._totalWeight) res1 << std::move(inArray[i]);
-            else res2 << std::move(inArray[i]);
-        }
-
-        // Calculate Segement
-        auto segementRate1 = (targetWeight1 - res1._totalWeight) / inArray[distributionIndex]._realWeight;
-        if (segementRate1 < 1E-6 || (segementRate1 * inArray[distributionIndex]._realWeight) < _allowedMinArea)
-        {
-            res2 << std::move(inArray[distributionIndex]);
-        }
-        else if (fabs(1 - segementRate1) < 1E-6 || (fabs(1 - segementRate1) * inArray[distributionIndex]._realWeight) < _allowedMinArea)
-        {
-            res1 << std::move(inArray[distributionIndex]);
-        }
-        else
-        {
-            res1 << PartInfo(inArray[distributionIndex]._index, inArray[distributionIndex]._weight,
-                             inArray[distributionIndex]._factor * segementRate1);
-            res2 << PartInfo(inArray[distributionIndex]._index, inArray[distributionIndex]._weight,
-                             inArray[distributionIndex]._factor * (1 - segementRate1));
-        }
-    }
-
-LABEL_END:
-    out1 = std::move(res1._partsList);
-    out2 = std::move(res2._partsList);
 }
@@ -5,20 +5,39 @@
 #include <vector>
 #include "./DynamicDivider/publicheader.h"
 
+///
+/// @brief 注水法分配
+/// @details 容器负载以最小堆维护, 零件按权重降序依次放入当前负载最小的容器;
+///   可分割的大零件在溢出平均负载时先将该容器注满, 余量继续放入下一个容器.
+///   每次分割都使一个容器恰好达到平均负载, 此后该容器不会再参与分割,
+///   因此分割次数不超过 containerCnt - 1, 分段总数不超过 零件数 + containerCnt - 1
+///
 class WaterDistributionPriv
 {
 public:
     WaterDistributionPriv() = default;
     std::vector<DistributionResult> initDistribution(const std::map<int, double> &inMap,
                                                      const int &containerCnt, const double &tolerance);
-    void startDistribution(std::vector<DistributionResult> &, std::vector<PartInfo> &,
-                           const int &, const int &);
+    void startDistribution(std::vector<DistributionResult> &, std::vector<PartInfo> &, const int &);
 
 private:
+    // 聚合初始化, 不设成员默认值
+    struct Segement {
+        int _container;
+        int _partIndex;
+        double _factor;
+    };
+    struct ContainerLoad {
+        double _load;
+        int _container;
+    };
+
     double createMateVec(const std::map<int, double> &inMap, std::vector<PartInfo> &, const int &);
     void sortWeightVec(std::vector<PartInfo> &mateVec);
-    void segementParts(std::vector<PartInfo> &inArray, std::vector<PartInfo> &out1,
-                       std::vector<PartInfo> &out2, const double &, const double &, const int &);
+    inline bool canSegement(const PartInfo &partInfo) const {
+        return partInfo._realWeight >= _allowedSegementArea && partInfo._realWeight >= _maxTotalWeight;
+    }
+    void collectResult(std::vector<DistributionResult> &, const std::vector<PartInfo> &, const int &);
 
     double _distributionNum = 1;
     double _tolerance = 0.0;
@@ -29,6 +48,11 @@ private:
     double _allowedMinArea = 2E6;
     // double _allowedSegementArea = 0;
     // double _allowedMinArea = 0;
+
+    std::vector<Segement> _segementVec;
+    std::vector<ContainerLoad> _loadHeap;
+    std::vector<double> _loadVec;
+    std::vector<int> _segementCntVec;
 };
 
 #endif // WATERDISTRIBUTIONPRIV_H
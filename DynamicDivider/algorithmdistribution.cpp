@@ -3,6 +3,8 @@
 #include "WaterDistribution/waterdistributionpriv.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
+#include <cmath>
 
 void AlgorithmDistribution::distribution(std::vector<DistributionResult> &res,
                                          const std::vector<double> &inVec,
@@ -53,3 +55,164 @@ void AlgorithmDistribution::distribution(std::vector<std::shared_ptr<DistPartInf
     TargetedDLib::TargetedDistribution targetDistribution;
     targetDistribution.distribution(partInfoVec, output_msg);
 }
+
+void IncrementalDistribution::setParas(const double &driftThreshold, const double &smoothFactor)
+{
+    _driftThreshold = std::max(0.0, driftThreshold);
+    _smoothFactor = std::min(std::max(0.0, smoothFactor), 1.0);
+}
+
+void IncrementalDistribution::reset()
+{
+    _solvedRecordMap.clear();
+    _lastRecordMap.clear();
+    _solveCnt = 0;
+    _reuseCnt = 0;
+    _solveNs = 0;
+    _imbalanceSum = 0.0;
+    _imbalanceMax = 0.0;
+}
+
+///
+/// @brief 增量分配
+/// @param partInfoVec [in,out] 本层各区域权重, 输出分配结果
+/// @param output_msg [out] 求解器输出信息
+/// @details 实现步骤:
+///   1. 尝试沿用上一次求解的分配方案
+///   2. 无法沿用时重新求解, 并记录本次权重作为新的漂移基准
+///   3. 重新求解后按平滑系数与上一层方案加权
+///   4. 记录本层方案及振镜负载不均衡度
+///
+void IncrementalDistribution::distribution(std::vector<std::shared_ptr<DistPartInfo>> &partInfoVec, std::string *output_msg)
+{
+    if (warmStart(partInfoVec))
+    {
+        ++ _reuseCnt;
+    }
+    else
+    {
+        QElapsedTimer timer;
+        timer.start();
+        for (auto &partPtr : partInfoVec) partPtr->_distResultVec.clear();
+        AlgorithmDistribution::distribution(partInfoVec, output_msg);
+        _solveNs += timer.nsecsElapsed();
+        ++ _solveCnt;
+
+        _solvedRecordMap.clear();
+        for (const auto &partPtr : partInfoVec)
+        {
+            auto &record = _solvedRecordMap[DistKey(partPtr->_index, partPtr->_distAreaType)];
+            record._weight = partPtr->_weight;
+            record._allowedContainer = partPtr->_allowedContainer;
+            record._distResultVec = partPtr->_distResultVec;
+        }
+        if (_smoothFactor > 0.0) smoothResult(partInfoVec);
+    }
+
+    _lastRecordMap.clear();
+    for (const auto &partPtr : partInfoVec)
+    {
+        auto &record = _lastRecordMap[DistKey(partPtr->_index, partPtr->_distAreaType)];
+        record._weight = partPtr->_weight;
+        record._allowedContainer = partPtr->_allowedContainer;
+        record._distResultVec = partPtr->_distResultVec;
+    }
+
+    auto imbalance = calcImbalance(partInfoVec);
+    _imbalanceSum += imbalance;
+    _imbalanceMax = std::max(_imbalanceMax, imbalance);
+}
+
+///
+/// @brief 振镜负载不均衡度
+/// @return (最大负载 - 平均负载) / 平均负载, 仅统计可分配的振镜
+///
+double IncrementalDistribution::calcImbalance(const std::vector<std::shared_ptr<DistPartInfo>> &partInfoVec)
+{
+    std::map<int, double> loadMap;
+    for (const auto &partPtr : partInfoVec)
+    {
+        for (const auto &container : partPtr->_allowedContainer) loadMap[container] += 0.0;
+        for (const auto &partRes : partPtr->_distResultVec)
+        {
+            loadMap[partRes._containorIndex] += partPtr->_weight * partRes._factor;
+        }
+    }
+    if (loadMap.size() < 2) return 0.0;
+
+    double totalLoad = 0.0, maxLoad = 0.0;
+    for (const auto &load : loadMap)
+    {
+        totalLoad += load.second;
+        maxLoad = std::max(maxLoad, load.second);
+    }
+    auto averageLoad = totalLoad / loadMap.size();
+    return (averageLoad > 0.0) ? (maxLoad - averageLoad) / averageLoad : 0.0;
+}
+
+///
+/// @brief 沿用上一次求解的分配方案
+/// @return 区域集合及可选振镜一致, 且权重相对漂移 sum|w - w0| / sum(w0) 不超过阈值时返回true
+///
+bool IncrementalDistribution::warmStart(std::vector<std::shared_ptr<DistPartInfo>> &partInfoVec) const
+{
+    if (_solvedRecordMap.empty() || _solvedRecordMap.size() != partInfoVec.size()) return false;
+
+    double drift = 0.0, totalWeight = 0.0;
+    for (const auto &partPtr : partInfoVec)
+    {
+        auto it = _solvedRecordMap.find(DistKey(partPtr->_index, partPtr->_distAreaType));
+        if (it == _solvedRecordMap.end()) return false;
+        if (it->second._allowedContainer != partPtr->_allowedContainer) return false;
+
+        drift += fabs(partPtr->_weight - it->second._weight);
+        totalWeight += it->second._weight;
+    }
+    if (drift > _driftThreshold * totalWeight) return false;
+
+    for (auto &partPtr : partInfoVec)
+    {
+        partPtr->_distResultVec = _lastRecordMap.at(DistKey(partPtr->_index, partPtr->_distAreaType))._distResultVec;
+    }
+    return true;
+}
+
+///
+/// @brief 按Z向平滑分配比例
+/// @details 上一层存在且可选振镜一致的区域, 比例取 s * 上一层 + (1 - s) * 本层,
+///   过小的比例并入其余振镜后归一化
+///
+void IncrementalDistribution::smoothResult(std::vector<std::shared_ptr<DistPartInfo>> &partInfoVec) const
+{
+    for (auto &partPtr : partInfoVec)
+    {
+        if (partPtr->_allowedContainer.size() < 2) continue;
+
+        auto it = _lastRecordMap.find(DistKey(partPtr->_index, partPtr->_distAreaType));
+        if (it == _lastRecordMap.end() || it->second._allowedContainer != partPtr->_allowedContainer) continue;
+
+        std::map<int, double> factorMap;
+        for (const auto &partRes : it->second._distResultVec)
+        {
+            factorMap[partRes._containorIndex] += _smoothFactor * partRes._factor;
+        }
+        for (const auto &partRes : partPtr->_distResultVec)
+        {
+            factorMap[partRes._containorIndex] += (1.0 - _smoothFactor) * partRes._factor;
+        }
+
+        double totalFactor = 0.0;
+        for (auto &factor : factorMap)
+        {
+            if (factor.second < 1E-3) factor.second = 0.0;
+            totalFactor += factor.second;
+        }
+        if (totalFactor <= 0.0) continue;
+
+        partPtr->_distResultVec.clear();
+        for (const auto &factor : factorMap)
+        {
+            if (factor.second > 0.0) partPtr->insertResult(factor.first, factor.second / totalFactor);
+        }
+    }
+}
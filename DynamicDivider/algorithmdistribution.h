@@ -117,4 +117,52 @@ public:
     static void distribution(std::vector<std::shared_ptr<DistPartInfo>> &, std::string *output_msg = nullptr);
 };
 
+///
+/// @brief 跨层增量分配
+/// @details 相邻层零件区域基本一致, 以上一次求解的分配方案为初值:
+///   区域集合不变且权重相对漂移不超过阈值时直接沿用, 否则重新求解;
+///   可选按Z向平滑分配比例, 避免区域在振镜间来回切换
+///
+class IncrementalDistribution
+{
+public:
+    IncrementalDistribution() = default;
+
+    void setParas(const double &driftThreshold, const double &smoothFactor);
+    void reset();
+    void distribution(std::vector<std::shared_ptr<DistPartInfo>> &, std::string *output_msg = nullptr);
+
+    static double calcImbalance(const std::vector<std::shared_ptr<DistPartInfo>> &);
+
+    inline int solveCnt() const { return _solveCnt; }
+    inline int reuseCnt() const { return _reuseCnt; }
+    inline long long solveNs() const { return _solveNs; }
+    inline double averageImbalance() const { return (_solveCnt + _reuseCnt) ? _imbalanceSum / (_solveCnt + _reuseCnt) : 0.0; }
+    inline double maxImbalance() const { return _imbalanceMax; }
+
+private:
+    typedef std::pair<int, int> DistKey;
+    struct DistRecord {
+        double _weight = 0.0;
+        std::set<int> _allowedContainer;
+        std::vector<PartResult> _distResultVec;
+    };
+
+    bool warmStart(std::vector<std::shared_ptr<DistPartInfo>> &) const;
+    void smoothResult(std::vector<std::shared_ptr<DistPartInfo>> &) const;
+
+private:
+    double _driftThreshold = 0.05;
+    double _smoothFactor = 0.0;
+
+    std::map<DistKey, DistRecord> _solvedRecordMap;     // 最近一次求解时的权重, 作为漂移比较基准
+    std::map<DistKey, DistRecord> _lastRecordMap;       // 上一层实际采用的分配方案
+
+    int _solveCnt = 0;
+    int _reuseCnt = 0;
+    long long _solveNs = 0;
+    double _imbalanceSum = 0.0;
+    double _imbalanceMax = 0.0;
+};
+
 #endif // ALGORITHMDISTRIBUTION_H
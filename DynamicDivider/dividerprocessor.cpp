@@ -6,6 +6,7 @@
 #include "utslaprocessor.h"
 #include "uspfilewriter.h"
 #include "publicheader.h"
+#include "layerarena.h"
 
 #include <algorithm>
 #include <memory>
@@ -13,11 +14,15 @@
 
 #include "SelfAdaptiveModule/selfadaptivemodule.h"
 #include "./PolygonsDivider/polygonsdivider.h"
+#include "./SliceStore/slicestore.h"
+#include "./layerpipeline.h"
 #include "./DynamicDivider/publicheader.h"
 #include "qlog.h"
 
 #include <QtConcurrent>
+#include <QElapsedTimer>
 #include <QDebug>
+#include <omp.h>
 
 
 #define Calc_Support
@@ -37,10 +42,43 @@ struct BuildPart {
     int _border_scanner_index = 0;
     SOLIDPATH _solidPath;
     USPFileWriterPtr _fileWriterPtr = nullptr;
+    AlgrithmPtr _readAlgoPtr = nullptr;     // 读取阶段专用, 与写入线程互不干扰
     int _nLastLayer = -1;
     double _fLayerThickness = 0.1;
 };
 
+// 单个零件在某一层的读取结果, 由读取阶段生成、写入阶段消费
+struct DividerPartJob {
+    bool _hasSolid = false;
+    bool _hasArea = false;
+    double _fArea = 0.0;
+    double _fLayerThickness = 0.1;
+    BOUNDINGRECT _totalRc;
+    QSharedPointer<DivideSolidData> _divideData = QSharedPointer<DivideSolidData>(new DivideSolidData());
+    Paths _paths_smallGaps;
+    Paths _paths_smallHoles;
+    Paths _paths_exceptHolesAndGaps;
+    Paths _borderPaths;                     // 轮廓权重计算用, 分配完成后释放
+    std::vector<std::pair<DistAreaType, std::vector<PartResult>>> _distInfoVec;
+
+    // 共享切片: 归一化键、当前层轮廓原点及共享数据, 写入前按原点平移
+    SliceKey _sliceKey;
+    IntPoint _sliceOrigin;
+    SliceDataPtr _sliceData;
+};
+
+// 一层的读取与分配结果
+struct DividerLayerJob {
+    int _layer = -1;
+    QVector<QSharedPointer<DividerPartJob>> _partJobVec;
+    QList<int> _solidKeys;
+    QList<int> _supportKeys;
+    QMap<int, Paths> _supportPartMap;
+    QSet<int> _totalKeys;
+
+    inline bool isValid() const { return false == _totalKeys.isEmpty(); }
+};
+
 DividerProcessor::DividerProcessor(UTSLAProcessorPrivate *slaPriv)
 {
     _runningSemaphore.release();
@@ -94,6 +132,18 @@ void DividerProcessor::createPartWriter()
         return allowedList;
     };
 
+    _scanTimeModule.initializeParas(_slaPriv->_writerBufferParas.data());
+
+    // 跨层增量分配: 权重漂移阈值及Z向平滑系数
+    // 实例化零件共享切片派生数据
+    _useSliceStore = 1 == _slaPriv->_writerBufferParas->getExtendedValue<int>("Splicing/nShareSlices", 0);
+    _sliceStore.clear();
+
+    _useIncrementalDist = 1 == _slaPriv->_writerBufferParas->getExtendedValue<int>("Splicing/nIncrementalDist", 0);
+    _incrementalDist.reset();
+    _incrementalDist.setParas(_slaPriv->_writerBufferParas->getExtendedValue<double>("Splicing/fDistDriftThreshold", 0.05),
+                              _slaPriv->_writerBufferParas->getExtendedValue<double>("Splicing/fDistSmoothFactor", 0.0));
+
     _allowedSet_support = funcGetAllowedSet(scannerCnt, allowed_support);
     _allowedSet_hatching = funcGetAllowedSet(scannerCnt, allowed_hatching);
     _allowedSet_upface = funcGetAllowedSet(scannerCnt, allowed_upface);
@@ -116,6 +166,13 @@ void DividerProcessor::createPartWriter()
         auto buildPart = QSharedPointer<BuildPart>(new BuildPart);
         buildPart->_nLastLayer = _minLayer - 1;
         _slaPriv->createFileWriter(partIndex, buildPart->_fileWriterPtr);
+        if (auto bufPara = buildPart->_fileWriterPtr->getBufPara())
+        {
+            buildPart->_readAlgoPtr = AlgrithmPtr(new AlgorithmApplication());
+            buildPart->_readAlgoPtr->setBuffParas(bufPara);
+            buildPart->_readAlgoPtr->setExportFileMode(_slaPriv->nExportFileMode);
+            buildPart->_readAlgoPtr->createEnhanceBorderParas();
+        }
 
         if (-1 != fixedScanner_border)
         {
@@ -126,7 +183,6 @@ void DividerProcessor::createPartWriter()
         }
 
         _buildPartMap.insert(partIndex, buildPart);
-        _divideDataMap.insert(partIndex, QSharedPointer<DivideSolidData>(new DivideSolidData()));
         buildPartList.push_back({buildPart, partIndex});
     }
 
@@ -154,168 +210,405 @@ void DividerProcessor::processingAllParts()
     auto q = _slaPriv->q_ptr;
     if (false == q->isRunning()) return;
 
-    auto curLayer = _minLayer;
-    auto lastLayer = curLayer;
+    auto lastLayer = _minLayer;
 
     // curLayer = 5500;
     // _maxLayer = 6500;
     double fStep = 100.0 / (_maxLayer - _minLayer - 1);
 
-    QList<int> validSolidKeys;
-    QMap<int, Paths> validSupportPartMap;
-    std::vector<std::shared_ptr<DistPartInfo>> partInfoVec;
+    // 预读深度: 0 表示读取与写入串行执行
+    LayerPipeline<DividerLayerJobPtr> pipeline(_slaPriv->_writerBufferParas->getExtendedValue<int>("Splicing/nPipelineDepth", 2));
+    // 流水线模式下读取与写入阶段的并行区同时运行, 各占一半线程, 避免线程数超出核数
+    _ompThreads = omp_get_max_threads();
+    if (pipeline.depth() > 0) _ompThreads = qMax(1, _ompThreads / 2);
+
+    _readNs = 0;
+    _distNs = 0;
+    qint64 writeNs = 0;
+    int layerCnt = 0;
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+
+    auto funcWriteJob = [&, this](const DividerLayerJobPtr &job) {
+        QElapsedTimer timer;
+        timer.start();
+        writeLayerJob(job);
+        writeNs += timer.nsecsElapsed();
+        ++ layerCnt;
+
+        if (job->isValid())
+        {
+            _slaPriv->updateProgress(double(job->_layer - lastLayer) * fStep);
+            lastLayer = job->_layer;
+        }
+    };
+    pipeline.run(_minLayer, _maxLayer, [this](const int &curLayer) { return readLayerJob(curLayer); },
+                 funcWriteJob, [q]() { return q->isRunning(); });
+
+    // 输出各阶段利用率
+    if (0 == _slaPriv->_writerBufferParas->getExtendedValue<int>("Splicing/nPrintMetrics", 0)) return;
+    auto totalNs = qMax<qint64>(1, totalTimer.nsecsElapsed());
+    auto funcRatio = [&totalNs](const qint64 &ns) { return QString::number(100.0 * ns / totalNs, 'f', 1) + "%"; };
+    qDebug() << "divider pipeline depth" << pipeline.depth() << "threads" << _ompThreads << "layers" << layerCnt
+             << "total" << totalNs / 1000000 << "ms"
+             << "read" << _readNs / 1000000 << funcRatio(_readNs)
+             << "distribution" << _distNs / 1000000 << funcRatio(_distNs)
+             << "write" << writeNs / 1000000 << funcRatio(writeNs)
+             << "read stall" << pipeline.readWaitNs() / 1000000 << funcRatio(pipeline.readWaitNs())
+             << "write stall" << pipeline.writeWaitNs() / 1000000 << funcRatio(pipeline.writeWaitNs());
+    if (_useIncrementalDist)
+    {
+        qDebug() << "incremental distribution solved" << _incrementalDist.solveCnt()
+                 << "reused" << _incrementalDist.reuseCnt()
+                 << "solver" << _incrementalDist.solveNs() / 1000000 << "ms"
+                 << "imbalance avg" << _incrementalDist.averageImbalance()
+                 << "max" << _incrementalDist.maxImbalance();
+    }
+}
 
-    QMutex areaLocker;
-    QMutex partLocker;
-    QMutex supportLocker;
+///
+/// @brief 读取一层所有零件数据并计算分配方案
+/// @param curLayer [in] 当前层
+/// @return 本层读取结果
+/// @details 实现步骤:
+///   1. 并行读取各零件实体与支撑数据, 计算分区与权重
+///   2. 按零件序号汇总有效零件与权重信息
+///   3. 计算轮廓权重并执行扫描振镜分配
+///   4. 将分配结果记录到各零件任务中
+///
+DividerLayerJobPtr DividerProcessor::readLayerJob(const int &curLayer)
+{
+    auto q = _slaPriv->q_ptr;
+    auto job = DividerLayerJobPtr(new DividerLayerJob);
+    job->_layer = curLayer;
+    job->_partJobVec.resize(_partCnt);
 
-    QVector<int> partVec;
-    partVec.reserve(_partCnt);
-    for (int i = 0; i < _partCnt; ++ i) partVec << i;
+    QVector<Paths> supportPathsVec(_partCnt);
 
-    auto readDataAndCalculateWeight = [&, this](const int &partIndex){
-        if (q->isEffectiveLayer(curLayer, partIndex))
-        {
-            auto uspWriter = _buildPartMap[partIndex]->_fileWriterPtr;
-            SOLIDPATH &solidPath = _buildPartMap[partIndex]->_solidPath;
-            updatePartLayerInfo(partIndex, curLayer, _buildPartMap[partIndex]);
-            BOUNDINGRECT totalRc;
+    QElapsedTimer timer;
+    timer.start();
 
-            _slaPriv->readLayerDatas(curLayer, partIndex, uspWriter, solidPath);
-            if (solidPath.lpPath_Cur->size())
+#pragma omp parallel for num_threads(_ompThreads)
+    for (int partIndex = 0; partIndex < _partCnt; ++ partIndex)
+    {
+        if (false == q->isEffectiveLayer(curLayer, partIndex)) continue;
+
+        auto buildPart = _buildPartMap.value(partIndex);
+        auto uspWriter = buildPart->_fileWriterPtr;
+        auto algo = buildPart->_readAlgoPtr.data();
+        SOLIDPATH &solidPath = buildPart->_solidPath;
+        updatePartLayerInfo(partIndex, curLayer, buildPart);
+
+        auto partJob = QSharedPointer<DividerPartJob>(new DividerPartJob);
+        partJob->_fLayerThickness = buildPart->_fLayerThickness;
+        algo->setCurLayerHei(curLayer);
+
+        _slaPriv->readLayerDatas(curLayer, partIndex, uspWriter->getBufPara(), algo, solidPath);
+        if (solidPath.lpPath_Cur->size())
+        {
+            // 先简化再取指纹, 共享与非共享模式的派生数据基于同一轮廓
+            partJob->_hasSolid = true;
+            SimplifyPolygons(*solidPath.lpPath_Cur);
+            if (_useSliceStore)
             {
-                SimplifyPolygons(*solidPath.lpPath_Cur);
-                uspWriter->algo()->calcLimitXY(*solidPath.lpPath_Cur, totalRc);
-                partLocker.lock();
-                validSolidKeys.append(partIndex);
-                partLocker.unlock();
+                std::vector<const Paths *> pathsVec = { solidPath.lpPath_Cur };
+                for (int iSur = 0; iSur < 5; ++ iSur) pathsVec.push_back(solidPath.lpPath_Dw[iSur]);
+                for (int iSur = 0; iSur < 5; ++ iSur) pathsVec.push_back(solidPath.lpPath_Up[iSur]);
+                partJob->_sliceKey = SliceStore::createKey(pathsVec, curLayer,
+                                                           uspWriter->getBufPara()->_writerBufferParas->_bppParaPtr.data(),
+                                                           partJob->_sliceOrigin);
             }
+        }
 
-            QList<AREAINFOPTR> areaSupport;
-            q->readLayerDatas(curLayer, areaSupport, partIndex, FTYPE_SUPPORT);
-            if (areaSupport.size())
-            {
-                uspWriter->algo()->calcLimitXY(areaSupport, totalRc);
+        QList<AREAINFOPTR> areaSupport;
+        q->readLayerDatas(curLayer, areaSupport, partIndex, FTYPE_SUPPORT);
+        if (areaSupport.size())
+        {
+            algo->calcLimitXY(areaSupport, partJob->_totalRc);
+            algo->writeSupportAreaToPaths(areaSupport, supportPathsVec[partIndex]);
+        }
+
+        if (partJob->_hasSolid && false == _useSliceStore)
+        {
+            // Paths tempPaths;
+            // uspWriter->algo()->getOffsetPaths(solidPath.lpPath_Cur, &tempPaths, 800, 0, 0);
+            // double fArea = Areas(tempPaths);
+            SliceData sliceData;
+            deriveSliceData(algo, solidPath, sliceData);
+            algo->calcLimitXY(Paths { sliceData._boundPath }, partJob->_totalRc);
+            partJob->_fArea = sliceData._fArea;
+            partJob->_hasArea = true;
+#ifdef Calc_Solid
+            *partJob->_divideData = sliceData._divideData;
+#endif
+            partJob->_paths_smallGaps.swap(sliceData._paths_smallGaps);
+            partJob->_paths_smallHoles.swap(sliceData._paths_smallHoles);
+            partJob->_paths_exceptHolesAndGaps.swap(sliceData._paths_exceptHolesAndGaps);
+            partJob->_borderPaths.swap(sliceData._borderPaths);
+        }
+        job->_partJobVec[partIndex] = partJob;
+    }
+
+    if (_useSliceStore) shareSliceData(job);
 
-                Paths paths;
-                uspWriter->algo()->writeSupportAreaToPaths(areaSupport, paths);
-                supportLocker.lock();
-                validSupportPartMap.insert(partIndex, paths);
-                supportLocker.unlock();
+    // 按零件序号汇总, 保证分配输入与线程调度无关
+    std::vector<std::shared_ptr<DistPartInfo>> partInfoVec;
+    for (int partIndex = 0; partIndex < _partCnt; ++ partIndex)
+    {
+        const auto &partJob = job->_partJobVec[partIndex];
+        if (nullptr == partJob) continue;
+
+        if (partJob->_hasSolid) job->_solidKeys.append(partIndex);
+        if (supportPathsVec[partIndex].size())
+        {
+            job->_supportKeys.append(partIndex);
+            job->_supportPartMap.insert(partIndex, supportPathsVec[partIndex]);
 #ifdef Calc_Support
-                auto partPtr = std::shared_ptr<DistPartInfo>(new DistPartInfo(partIndex, calcSupportWeight(paths),
-                                                                              DistAreaType::Support, _allowedSet_support));
-                areaLocker.lock();
-                partInfoVec.push_back(partPtr);
-                areaLocker.unlock();
+            partInfoVec.push_back(std::shared_ptr<DistPartInfo>(new DistPartInfo(partIndex, calcSupportWeight(supportPathsVec[partIndex]),
+                                                                                 DistAreaType::Support, _allowedSet_support)));
 #endif
+        }
+
+#ifdef Calc_Solid
+        if (partJob->_hasSolid)
+        {
+            const auto divideData = partJob->_divideData.data();
+            if (divideData->_paths_Inner.size())
+            {
+                partInfoVec.push_back(std::shared_ptr<DistPartInfo>(new DistPartInfo(partIndex, calcHatchingWeight(divideData->_paths_Inner),
+                                                                                     DistAreaType::Hatching, _allowedSet_hatching)));
+            }
+            if (divideData->_paths_up.size())
+            {
+                partInfoVec.push_back(std::shared_ptr<DistPartInfo>(new DistPartInfo(partIndex,
+                                                                                     calcUpfaceWeight(divideData->_paths_up, divideData->_nIndex_up),
+                                                                                     DistAreaType::Upface, _allowedSet_upface)));
+            }
+            if (divideData->_paths_down.size())
+            {
+                partInfoVec.push_back(std::shared_ptr<DistPartInfo>(new DistPartInfo(partIndex,
+                                                                                     calcDownfaceWeight(divideData->_paths_down, divideData->_nIndex_down),
+                                                                                     DistAreaType::Downface, _allowedSet_downface)));
             }
+        }
+#endif
+    }
+    _readNs += timer.nsecsElapsed();
 
-            uspWriter->startBuffWriter();
-            uspWriter->algo()->setCurLayerHei(curLayer);
-            uspWriter->writeLayerInfo(curLayer, totalRc, 0);
+    if (job->_solidKeys.empty() && job->_supportKeys.empty()) return job;
+    job->_totalKeys = job->_supportKeys.toSet() + job->_solidKeys.toSet();
 
-            if (solidPath.lpPath_Cur->size())
-            {
-                // Paths tempPaths;
-                // uspWriter->algo()->getOffsetPaths(solidPath.lpPath_Cur, &tempPaths, 800, 0, 0);
-                // double fArea = Areas(tempPaths);
-                double fArea = Areas(*solidPath.lpPath_Cur);
-                uspWriter->algo()->keepHolesAndGaps(solidPath.lpPath_Cur, solidPath.paths_smallHoles, solidPath.paths_smallGaps,
-                                                    solidPath.paths_exceptHolesAndGaps);
-#ifdef Calc_Solid
-                auto divideData = _divideDataMap[partIndex].data();
-                uspWriter->algo()->calcDivideData(solidPath, *divideData);
-
-                if (divideData->_paths_Inner.size())
-                {
-                    auto partPtr = std::shared_ptr<DistPartInfo>(new DistPartInfo(partIndex, Areas(divideData->_paths_Inner),
-                                                                                  DistAreaType::Hatching, _allowedSet_hatching));
-                    areaLocker.lock();
-                    partInfoVec.push_back(partPtr);
-                    areaLocker.unlock();
-                }
-                if (divideData->_paths_up.size())
-                {
-                    auto partPtr = std::shared_ptr<DistPartInfo>(new DistPartInfo(partIndex,
-                                                                                  calcUpfaceWeight(divideData->_paths_up, divideData->_nIndex_up),
-                                                                                  DistAreaType::Upface, _allowedSet_upface));
-                    areaLocker.lock();
-                    partInfoVec.push_back(partPtr);
-                    areaLocker.unlock();
-                }
-                if (divideData->_paths_down.size())
-                {
-                    auto partPtr = std::shared_ptr<DistPartInfo>(new DistPartInfo(partIndex,
-                                                                                  calcDownfaceWeight(divideData->_paths_down, divideData->_nIndex_down),
-                                                                                  DistAreaType::Downface, _allowedSet_downface));
-                    areaLocker.lock();
-                    partInfoVec.push_back(partPtr);
-                    areaLocker.unlock();
-                }
+    timer.restart();
+#ifdef Calc_Border
+    if (job->_solidKeys.size()) calcBorderWeight(job, partInfoVec);
 #endif
-                fArea *= AREAFACTOR;
-                uspWriter->addVolume(fArea * _buildPartMap[partIndex]->_fLayerThickness);
-                uspWriter->writeAreaInfo(int(fArea));
+    for (const auto &partIndex : job->_solidKeys) Paths().swap(job->_partJobVec[partIndex]->_borderPaths);
+
+    if (_useIncrementalDist) _incrementalDist.distribution(partInfoVec);
+    else AlgorithmDistribution::distribution(partInfoVec);
+    for (const auto &partPtr : partInfoVec)
+    {
+        if (DistAreaType::Border == partPtr->_distAreaType) continue;
+        job->_partJobVec[partPtr->_index]->_distInfoVec.push_back({partPtr->_distAreaType, partPtr->_distResultVec});
+    }
+    _distNs += timer.nsecsElapsed();
+    return job;
+}
+
+///
+/// @brief 写入一层所有零件数据
+/// @param job [in] 读取阶段生成的本层数据
+/// @details 实现步骤:
+///   1. 写入层信息与面积信息
+///   2. 设置各区域扫描振镜分配信息
+///   3. 生成并写入扫描数据
+///
+void DividerProcessor::writeLayerJob(const DividerLayerJobPtr &job)
+{
+    QVector<int> partVec;
+    partVec.reserve(_partCnt);
+    for (int i = 0; i < job->_partJobVec.size(); ++ i)
+    {
+        if (job->_partJobVec[i]) partVec << i;
+    }
+
+#pragma omp parallel for num_threads(_ompThreads)
+    for (int i = 0; i < partVec.size(); ++ i)
+    {
+        const auto partIndex = partVec[i];
+        const auto &partJob = job->_partJobVec[partIndex];
+        auto uspWriter = _buildPartMap.value(partIndex)->_fileWriterPtr;
+
+        uspWriter->startBuffWriter();
+        uspWriter->algo()->setCurLayerHei(job->_layer);
+        uspWriter->writeLayerInfo(job->_layer, partJob->_totalRc, 0);
+        if (partJob->_hasArea)
+        {
+            uspWriter->addVolume(partJob->_fArea * partJob->_fLayerThickness);
+            uspWriter->writeAreaInfo(int(partJob->_fArea));
+        }
+
+        for (const auto &distInfo : partJob->_distInfoVec)
+        {
+            switch (distInfo.first) {
+            case DistAreaType::Support:
+                uspWriter->algo()->setSupportDistributionInfo(distInfo.second);
+                break;
+            case DistAreaType::Hatching:
+                uspWriter->algo()->setSolidDistributionInfo(distInfo.second);
+                break;
+            case DistAreaType::Upface:
+                uspWriter->algo()->setUpsurfaceDistributionInfo(distInfo.second);
+                break;
+            case DistAreaType::Downface:
+                uspWriter->algo()->setDownsurfaceDistributionInfo(distInfo.second);
+                break;
+            default:
+                break;
             }
         }
-    };
 
-    while (curLayer <= _maxLayer)
+        if (partJob->_sliceData) applySliceData(partJob.data());
+        if (job->_totalKeys.contains(partIndex)) taskRunner(partIndex, job);
+    }
+}
+
+///
+/// @brief 本层实例化零件共享切片派生数据
+/// @param job [in,out] 本层读取结果
+/// @details 实现步骤:
+///   1. 按切片键查找仍被引用的共享数据
+///   2. 未命中的键由首个零件负责计算, 各键并行计算后写入共享库
+///   3. 同键零件引用同一份数据, 包围盒、面积及轮廓权重路径按各自原点换算
+///   4. 释放各零件当前层轮廓副本
+///
+void DividerProcessor::shareSliceData(const DividerLayerJobPtr &job)
+{
+    QVector<int> ownerVec;
+    QHash<SliceKey, int> ownerHash;
+    for (int partIndex = 0; partIndex < _partCnt; ++ partIndex)
     {
-        if (false == q->isRunning()) break;
+        const auto &partJob = job->_partJobVec[partIndex];
+        if (nullptr == partJob || false == partJob->_hasSolid) continue;
+
+        partJob->_sliceData = _sliceStore.find(partJob->_sliceKey);
+        if (partJob->_sliceData || ownerHash.contains(partJob->_sliceKey)) continue;
+        ownerHash.insert(partJob->_sliceKey, partIndex);
+        ownerVec << partIndex;
+    }
 
-        partInfoVec.clear();
-        validSolidKeys.clear();
-        validSupportPartMap.clear();
+#pragma omp parallel for num_threads(_ompThreads)
+    for (int i = 0; i < ownerVec.size(); ++ i)
+    {
+        const auto &partJob = job->_partJobVec[ownerVec[i]];
+        partJob->_sliceData = _sliceStore.insert(partJob->_sliceKey, createSliceData(ownerVec[i], partJob->_sliceOrigin));
+    }
 
-        // QFutureWatcher<void> futureWatcher;
-        // futureWatcher.setFuture(QtConcurrent::map(partVec, readDataAndCalculateWeight));
-        // futureWatcher.waitForFinished();
+    for (int partIndex = 0; partIndex < _partCnt; ++ partIndex)
+    {
+        const auto &partJob = job->_partJobVec[partIndex];
+        if (nullptr == partJob || false == partJob->_hasSolid) continue;
 
-#pragma omp parallel for
-        for (int i = 0; i < _partCnt; ++ i)
+        if (nullptr == partJob->_sliceData)
         {
-            readDataAndCalculateWeight(i);
+            partJob->_sliceData = job->_partJobVec[ownerHash.value(partJob->_sliceKey)]->_sliceData;
         }
 
-        if (false == validSolidKeys.empty() || false == validSupportPartMap.empty())
-        {
-            const auto supportKeys = validSupportPartMap.keys();
-            const auto totalKeys = supportKeys.toSet() + validSolidKeys.toSet();
+        Paths boundPaths(1);
+        auto buildPart = _buildPartMap.value(partIndex);
+        SliceStore::translatePaths({ partJob->_sliceData->_boundPath }, partJob->_sliceOrigin, boundPaths);
+        SliceStore::translatePaths(partJob->_sliceData->_borderPaths, partJob->_sliceOrigin, partJob->_borderPaths);
+        buildPart->_readAlgoPtr->calcLimitXY(boundPaths, partJob->_totalRc);
+        partJob->_fArea = partJob->_sliceData->_fArea;
+        partJob->_hasArea = true;
 
-#ifdef Calc_Border
-            if (validSolidKeys.size()) calcBorderWeight(validSolidKeys, partInfoVec);
-#endif
+        // 派生数据已共享, 当前层轮廓副本不再需要
+        Paths().swap(buildPart->_solidPath.curPaths);
+    }
+    _sliceStore.removeExpired();
+}
 
-            AlgorithmDistribution::distribution(partInfoVec);
-            for (const auto &partPtr : partInfoVec)
-            {
-                auto p_index = partPtr->_index;
-                switch (partPtr->_distAreaType) {
-                case DistAreaType::Border:
-                    break;
-                case DistAreaType::Support:
-                    _buildPartMap[p_index]->_fileWriterPtr->algo()->setSupportDistributionInfo(partPtr->_distResultVec);
-                    break;
-                case DistAreaType::Hatching:
-                    _buildPartMap[p_index]->_fileWriterPtr->algo()->setSolidDistributionInfo(partPtr->_distResultVec);
-                    break;
-                case DistAreaType::Upface:
-                    _buildPartMap[p_index]->_fileWriterPtr->algo()->setUpsurfaceDistributionInfo(partPtr->_distResultVec);
-                    break;
-                case DistAreaType::Downface:
-                    _buildPartMap[p_index]->_fileWriterPtr->algo()->setDownsurfaceDistributionInfo(partPtr->_distResultVec);
-                    break;
-                }
-            }
-            runTaskInConcurrent(totalKeys, supportKeys, validSolidKeys, validSupportPartMap);
+///
+/// @brief 由零件当前读取的轮廓计算共享切片数据
+/// @param partIndex [in] 负责计算的零件
+/// @param origin [in] 当前层轮廓原点
+/// @return 归一化到原点的派生数据
+///
+SliceDataPtr DividerProcessor::createSliceData(const int &partIndex, const IntPoint &origin)
+{
+    auto buildPart = _buildPartMap.value(partIndex);
+    auto algo = buildPart->_readAlgoPtr.data();
+    const auto &srcPath = buildPart->_solidPath;
+    const IntPoint offset(-origin.X, -origin.Y);
+
+    SOLIDPATH solidPath;
+    solidPath.clearAllPathPointer();
+    SliceStore::translatePaths(*srcPath.lpPath_Cur, offset, solidPath.curPaths);
+    solidPath.lpPath_Cur = &solidPath.curPaths;
+    for (int iSur = 0; iSur < 5; ++ iSur)
+    {
+        SliceStore::translatePaths(*srcPath.lpPath_Dw[iSur], offset, solidPath.sLayerDatas[iSur].allPaths);
+        solidPath.lpPath_Dw[iSur] = &solidPath.sLayerDatas[iSur].allPaths;
+        SliceStore::translatePaths(*srcPath.lpPath_Up[iSur], offset, solidPath.sLayerDatas[iSur + 5].allPaths);
+        solidPath.lpPath_Up[iSur] = &solidPath.sLayerDatas[iSur + 5].allPaths;
+    }
+
+    auto sliceData = QSharedPointer<SliceData>(new SliceData);
+    deriveSliceData(algo, solidPath, *sliceData);
+    return sliceData;
+}
 
-            _slaPriv->updateProgress(double(curLayer - lastLayer) * fStep);
-            lastLayer = curLayer;
+///
+/// @brief 由已简化的当前层轮廓计算派生数据, 共享与非共享模式共用
+/// @param algo [in] 零件读取算法, 提供孔隙及上下表面参数
+/// @param solidPath [in,out] 零件轮廓, 移除小孔及窄缝后的当前层轮廓移入 sliceData._borderPaths, 调用后为空
+/// @param sliceData [out] 包围盒、面积、孔隙、分区及轮廓权重路径
+///
+void DividerProcessor::deriveSliceData(AlgorithmApplication *algo, SOLIDPATH &solidPath, SliceData &sliceData)
+{
+    IntPoint minPt(0, 0), maxPt(0, 0);
+    bool firstPt = true;
+    for (const auto &path : *solidPath.lpPath_Cur)
+    {
+        for (const auto &pt : path)
+        {
+            if (firstPt) { minPt = maxPt = pt; firstPt = false; }
+            minPt.X = qMin(minPt.X, pt.X);
+            minPt.Y = qMin(minPt.Y, pt.Y);
+            maxPt.X = qMax(maxPt.X, pt.X);
+            maxPt.Y = qMax(maxPt.Y, pt.Y);
         }
-        ++ curLayer;
     }
+    if (false == firstPt) sliceData._boundPath << minPt << maxPt;
+
+    sliceData._fArea = Areas(*solidPath.lpPath_Cur) * AREAFACTOR;
+    algo->keepHolesAndGaps(solidPath.lpPath_Cur, sliceData._paths_smallHoles, sliceData._paths_smallGaps,
+                           sliceData._paths_exceptHolesAndGaps);
+#ifdef Calc_Solid
+    algo->calcDivideData(solidPath, sliceData._divideData);
+#endif
+    sliceData._borderPaths.swap(*solidPath.lpPath_Cur);
+}
+
+///
+/// @brief 写入前按零件原点平移共享切片数据, 并释放对共享数据的引用
+///
+void DividerProcessor::applySliceData(DividerPartJob *partJob)
+{
+    const auto &sliceData = partJob->_sliceData;
+    const auto &origin = partJob->_sliceOrigin;
+    auto divideData = partJob->_divideData.data();
+
+    SliceStore::translatePaths(sliceData->_paths_smallGaps, origin, partJob->_paths_smallGaps);
+    SliceStore::translatePaths(sliceData->_paths_smallHoles, origin, partJob->_paths_smallHoles);
+    SliceStore::translatePaths(sliceData->_paths_exceptHolesAndGaps, origin, partJob->_paths_exceptHolesAndGaps);
+    SliceStore::translatePaths(sliceData->_divideData._extendPaths, origin, divideData->_extendPaths);
+    SliceStore::translatePaths(sliceData->_divideData._paths_Inner, origin, divideData->_paths_Inner);
+    SliceStore::translatePaths(sliceData->_divideData._paths_down, origin, divideData->_paths_down);
+    SliceStore::translatePaths(sliceData->_divideData._paths_up, origin, divideData->_paths_up);
+    divideData->_nIndex_down = sliceData->_divideData._nIndex_down;
+    divideData->_nIndex_up = sliceData->_divideData._nIndex_up;
+    partJob->_sliceData.clear();
 }
 
 void DividerProcessor::writeFileEnd()
@@ -336,6 +629,7 @@ void DividerProcessor::writeFileEnd()
                                      q->getLayerThickness(index), q->getBoundingBox(index),
                                      q->getMinLayer(index), q->getMaxLayer(index), jsonPartInfo);
             _slaPriv->objZipDescFile << jsonPartInfo;
+            _slaPriv->archivePartFile(uspWriter);
         }
     }
 }
@@ -424,10 +718,10 @@ void calcSupportPathsWeight(const Paths &paths, double &weight_jump, double &wei
     }
 }
 
-void DividerProcessor::calcBorderWeight(const QList<int> &validList, std::vector<std::shared_ptr<DistPartInfo>> &partInfoVec)
+void DividerProcessor::calcBorderWeight(const DividerLayerJobPtr &job, std::vector<std::shared_ptr<DistPartInfo>> &partInfoVec)
 {
     QMap<int, QList<int>> allowedScanners_borderet;
-    for (const auto &index : validList)
+    for (const auto &index : job->_solidKeys)
     {
         allowedScanners_borderet[_buildPartMap[index]->_border_scanner_index] << index;
     }
@@ -436,17 +730,29 @@ void DividerProcessor::calcBorderWeight(const QList<int> &validList, std::vector
     for (const auto &scanner : scanners)
     {
         auto partPtr = std::shared_ptr<DistPartInfo>(new DistPartInfo(-1 - scanner,
-                                                                      calcBorderWeight(allowedScanners_borderet[scanner]),
+                                                                      calcBorderWeight(job, allowedScanners_borderet[scanner]),
                                                                       DistAreaType::Border, {scanner}));
         partInfoVec.push_back(partPtr);
     }
 }
 
-double DividerProcessor::calcBorderWeight(const QList<int> &validList)
+///
+/// @brief 计算同一扫描振镜上各零件的轮廓权重
+/// @param job [in] 本层读取结果, 使用各零件移除小孔及窄缝后的轮廓, 共享与非共享模式一致
+/// @param validList [in] 零件序号
+///
+double DividerProcessor::calcBorderWeight(const DividerLayerJobPtr &job, const QList<int> &validList)
 {
     auto _writeBuff = _slaPriv->_writerBufferParas.data();
     if (_writeBuff->_bppParaPtr->sBorderPara.nNumber < 1) return 0.0;
 
+    if (_scanTimeModule.isEnabled())
+    {
+        QVector<const Paths *> pathsVec;
+        for (const auto &partIndex : validList) pathsVec << &job->_partJobVec[partIndex]->_borderPaths;
+        return _scanTimeModule.calcBorderTime(pathsVec);
+    }
+
     double weight_jump = 0;
     double weight_mark = 0;
 
@@ -454,7 +760,7 @@ double DividerProcessor::calcBorderWeight(const QList<int> &validList)
     double jumpCnt = 0, markCnt = 0;
     for (const auto &partIndex : validList)
     {
-        calcBorderPathsWeight(*_buildPartMap[partIndex]->_solidPath.lpPath_Cur, weight_jump, weight_mark,
+        calcBorderPathsWeight(job->_partJobVec[partIndex]->_borderPaths, weight_jump, weight_mark,
                               jumpCnt, markCnt, lastPtStatus);
     }
 
@@ -471,6 +777,8 @@ double DividerProcessor::calcBorderWeight(const QList<int> &validList)
 
 double DividerProcessor::calcSupportWeight(const Paths &paths)
 {
+    if (_scanTimeModule.isEnabled()) return _scanTimeModule.calcSupportTime(paths);
+
     auto _writeBuff = _slaPriv->_writerBufferParas.data();
     double weight_jump = 0;
     double weight_mark = 0;
@@ -485,14 +793,22 @@ double DividerProcessor::calcSupportWeight(const Paths &paths)
     return weight_jump * factor_jump + weight_mark * factor/* + jumpCnt * 0.00005 + markCnt * 0.00002*/;
 }
 
+double DividerProcessor::calcHatchingWeight(const Paths &paths)
+{
+    if (_scanTimeModule.isEnabled()) return _scanTimeModule.calcHatchingTime(paths);
+    return Areas(paths);
+}
+
 double DividerProcessor::calcUpfaceWeight(const Paths &paths, const int &up_index)
 {
+    if (_scanTimeModule.isEnabled()) return _scanTimeModule.calcUpfaceTime(paths, up_index);
+
     BoundingBox bBox;
     auto area = Areas(paths, bBox);
     auto maxArea = (bBox.maxY - bBox.minY) * (bBox.maxX - bBox.minX);
 
     auto _writeBuff = _slaPriv->_writerBufferParas.data();
-    double times = (_writeBuff->_bppParaPtr->sSurfacePara_Up.nHatchingType[up_index] == 3) ? 2.0 : 1.0;
+    double times = (SURFACEHATCH_CROSS == _writeBuff->_bppParaPtr->sSurfacePara_Up.nHatchingType[up_index]) ? 2.0 : 1.0;
     double factor1 = _writeBuff->_bppParaPtr->sHatchingPara.fLineSpacing[0] /
                      _writeBuff->_bppParaPtr->sSurfacePara_Up.fLineSpacing[up_index];
     double factor2 = (double)_writeBuff->_bppParaPtr->sHatchingPara.nMarkSpeed[0] /
@@ -502,13 +818,15 @@ double DividerProcessor::calcUpfaceWeight(const Paths &paths, const int &up_inde
 
 double DividerProcessor::calcDownfaceWeight(const Paths &paths, const int &down_index)
 {
+    if (_scanTimeModule.isEnabled()) return _scanTimeModule.calcDownfaceTime(paths, down_index);
+
     BoundingBox bBox;
     auto area = Areas(paths, bBox);
     auto maxArea = (bBox.maxY - bBox.minY) * (bBox.maxX - bBox.minX);
 
 
     auto _writeBuff = _slaPriv->_writerBufferParas.data();
-    double times = (_writeBuff->_bppParaPtr->sSurfacePara_Up.nHatchingType[down_index] == 3) ? 2.0 : 1.0;
+    double times = (SURFACEHATCH_CROSS == _writeBuff->_bppParaPtr->sSurfacePara_Up.nHatchingType[down_index]) ? 2.0 : 1.0;
     double factor1 = _writeBuff->_bppParaPtr->sHatchingPara.fLineSpacing[0] /
                      _writeBuff->_bppParaPtr->sSurfacePara_Dw.fLineSpacing[down_index];
     double factor2 = (double)_writeBuff->_bppParaPtr->sHatchingPara.nMarkSpeed[0] /
@@ -516,62 +834,44 @@ double DividerProcessor::calcDownfaceWeight(const Paths &paths, const int &down_
     return (area * (1 + (maxArea - area) / maxArea) * factor1 * factor2) * 1.25 * times;
 }
 
-void DividerProcessor::runTaskInConcurrent(const QSet<int> &totalKeys,
-                                           const QList<int> &supportKeys,
-                                           const QList<int> &solidKeys,
-                                           const QMap<int, Paths> &validSupportPartMap)
-{
-    auto q = _slaPriv->q_ptr;
-    if (false == q->isRunning()) return;
-    // _slaPriv->futureWatcher.setFuture(QtConcurrent::map(totalKeys,
-    //                                                     std::bind(&DividerProcessor::taskRunner, this, std::placeholders::_1, supportKeys, solidKeys, validSupportPartMap)));
-    // _slaPriv->futureWatcher.waitForFinished();
-
-    const auto keys = totalKeys.toList();
-#pragma omp parallel for
-    for (int i = 0; i < keys.size(); ++ i)
-    {
-        taskRunner(keys.at(i), supportKeys, solidKeys, validSupportPartMap);
-    }
-}
-
-void DividerProcessor::taskRunner(const int &partIndex, const QList<int> &supportKeys,
-                                  const QList<int> &solidKeys, const QMap<int, Paths> &validSupportPartMap)
+void DividerProcessor::taskRunner(const int &partIndex, const DividerLayerJobPtr &job)
 {
-    auto uspWriter = _buildPartMap[partIndex]->_fileWriterPtr;
-    SOLIDPATH &solidPath = _buildPartMap[partIndex]->_solidPath;
-    auto varioLayerAreaFactor = _slaPriv->_selfAdaptiveModule->getMarkSpeedRatio(_buildPartMap[partIndex]->_fLayerThickness);
+    LayerArenaScope arenaScope(_slaPriv->_layerArena);
+    auto uspWriter = _buildPartMap.value(partIndex)->_fileWriterPtr;
+    auto &partJob = job->_partJobVec[partIndex];
+    auto varioLayerAreaFactor = _slaPriv->_selfAdaptiveModule->getMarkSpeedRatio(partJob->_fLayerThickness);
 
 #ifdef Calc_Support
-    if (supportKeys.contains(partIndex))
+    if (job->_supportKeys.contains(partIndex))
     {
-        uspWriter->algo()->writeSupportToSList(validSupportPartMap[partIndex], varioLayerAreaFactor.fSupportFactor);
+        uspWriter->algo()->writeSupportToSList(job->_supportPartMap[partIndex], varioLayerAreaFactor.fSupportFactor);
     }
 #endif
 
-    if (solidKeys.contains(partIndex))
+    if (job->_solidKeys.contains(partIndex))
     {
-        uspWriter->algo()->createDistributionArea(_divideDataMap[partIndex]->_paths_Inner, DistAreaType::Hatching);
-        uspWriter->algo()->createDistributionArea(_divideDataMap[partIndex]->_paths_up, DistAreaType::Upface);
-        uspWriter->algo()->createDistributionArea(_divideDataMap[partIndex]->_paths_down, DistAreaType::Downface);
+        auto &divideData = partJob->_divideData;
+        uspWriter->algo()->createDistributionArea(divideData->_paths_Inner, DistAreaType::Hatching);
+        uspWriter->algo()->createDistributionArea(divideData->_paths_up, DistAreaType::Upface);
+        uspWriter->algo()->createDistributionArea(divideData->_paths_down, DistAreaType::Downface);
 
 #ifdef Calc_Solid
-        uspWriter->algo()->writeDivideData(_divideDataMap[partIndex], varioLayerAreaFactor.fHatchiongFactor,
+        uspWriter->algo()->writeDivideData(divideData, varioLayerAreaFactor.fHatchiongFactor,
                                            varioLayerAreaFactor.fLargeLineSpaceFactor,
                                            varioLayerAreaFactor.fSmallLineSpaceFactor);
 #endif
 
 #ifdef Calc_Border
-        uspWriter->algo()->writeBorderData(solidPath.paths_exceptHolesAndGaps, varioLayerAreaFactor.fBorderFactor);
-        uspWriter->algo()->writeHoleAndGapData(solidPath.paths_smallHoles,
-                                               solidPath.paths_smallGaps, varioLayerAreaFactor.fBorderFactor);
-        uspWriter->algo()->writeExternedBorder(_divideDataMap[partIndex]->_extendPaths, varioLayerAreaFactor.fBorderFactor);
+        uspWriter->algo()->writeBorderData(partJob->_paths_exceptHolesAndGaps, varioLayerAreaFactor.fBorderFactor);
+        uspWriter->algo()->writeHoleAndGapData(partJob->_paths_smallHoles,
+                                               partJob->_paths_smallGaps, varioLayerAreaFactor.fBorderFactor);
+        uspWriter->algo()->writeExternedBorder(divideData->_extendPaths, varioLayerAreaFactor.fBorderFactor);
 #endif
         uspWriter->algo()->resetDistributionInfo();
-        _divideDataMap[partIndex]->resetValues();
+        divideData->resetValues();
     }
 
-    if(solidPath.lpPath_Cur && solidPath.lpPath_Cur->size())
+    if(partJob->_hasSolid)
     {
         uspWriter->algo()->addHatchingAngle();
     }
@@ -6,9 +6,14 @@
 #include <QMap>
 
 #include "utslaprocessorprivate.h"
+#include "ScanTimeModule/scantimemodule.h"
+#include "SliceStore/slicestore.h"
 
 class UTSLAProcessorPrivate;
 struct BuildPart;
+struct DividerPartJob;
+struct DividerLayerJob;
+typedef QSharedPointer<DividerLayerJob> DividerLayerJobPtr;
 
 class DividerProcessor
 {
@@ -17,20 +22,27 @@ public:
 
     void startProcessing();
 
+    static void deriveSliceData(AlgorithmApplication *, SOLIDPATH &, SliceData &);
+
 private:
     void createPartWriter();
     void processingAllParts();
+    DividerLayerJobPtr readLayerJob(const int &);
+    void writeLayerJob(const DividerLayerJobPtr &);
+    void shareSliceData(const DividerLayerJobPtr &);
+    SliceDataPtr createSliceData(const int &, const IntPoint &);
+    void applySliceData(DividerPartJob *);
     void writeFileEnd();
     void updatePartLayerInfo(const int &, const int &, QSharedPointer<BuildPart> &);
 
-    void calcBorderWeight(const QList<int> &, std::vector<std::shared_ptr<DistPartInfo>> &);
-    double calcBorderWeight(const QList<int> &);
+    void calcBorderWeight(const DividerLayerJobPtr &, std::vector<std::shared_ptr<DistPartInfo>> &);
+    double calcBorderWeight(const DividerLayerJobPtr &, const QList<int> &);
     double calcSupportWeight(const Paths &);
+    double calcHatchingWeight(const Paths &);
     double calcUpfaceWeight(const Paths &, const int &);
     double calcDownfaceWeight(const Paths &, const int &);
 
-    void runTaskInConcurrent(const QSet<int> &, const QList<int> &, const QList<int> &, const QMap<int, Paths> &);
-    void taskRunner(const int &, const QList<int> &, const QList<int> &, const QMap<int, Paths> &);
+    void taskRunner(const int &, const DividerLayerJobPtr &);
 
 private:
     UTSLAProcessorPrivate *_slaPriv = nullptr;
@@ -40,8 +52,16 @@ private:
     int _maxLayer = -1;
     QMap<int, QSharedPointer<BuildPart>> _buildPartMap;
     QSemaphore _runningSemaphore;
+    ScanTimeModule _scanTimeModule;
+    IncrementalDistribution _incrementalDist;
+    bool _useIncrementalDist = false;
+    SliceStore _sliceStore;
+    bool _useSliceStore = false;
+
+    qint64 _readNs = 0;                 // 读取阶段累计耗时(纳秒)
+    qint64 _distNs = 0;                 // 分配计算累计耗时(纳秒)
+    int _ompThreads = 1;                // 每层零件并行线程数
 
-    QMap<int, QSharedPointer<DivideSolidData>> _divideDataMap;
     std::set<int> _allowedSet_support;
     std::set<int> _allowedSet_hatching;
     std::set<int> _allowedSet_upface;
@@ -0,0 +1,105 @@
+#ifndef LAYERPIPELINE_H
+#define LAYERPIPELINE_H
+
+#include <QMutex>
+#include <QQueue>
+#include <QSemaphore>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+
+///
+/// ! @coreclass{LayerPipeline}
+/// 按层预读的读取/写入流水线
+/// @details 读取线程按层序调用读取函数, 最多领先写入阶段 depth 层; 写入阶段在调用线程按层序消费.
+///   读取与写入各自保持层序, 深度 0 时两者在调用线程串行执行, 各深度输出一致.
+///   Job 为可置空的共享指针, 空指针作为结束标记
+///
+template<class Job>
+class LayerPipeline
+{
+public:
+    explicit LayerPipeline(const int &depth) : _depth(qMax(0, depth)) {}
+
+    inline int depth() const { return _depth; }
+    inline qint64 readWaitNs() const { return _readWaitNs; }
+    inline qint64 writeWaitNs() const { return _writeWaitNs; }
+
+    ///
+    /// @brief 执行流水线
+    /// @param minLayer [in] 起始层
+    /// @param maxLayer [in] 结束层
+    /// @param readFunc [in] 读取函数, Job(const int &layer)
+    /// @param writeFunc [in] 写入函数, void(const Job &)
+    /// @param runningFunc [in] 运行状态, 返回 false 时停止读取, 已读取的层不再写入
+    ///
+    template<class ReadFunc, class WriteFunc, class RunningFunc>
+    void run(const int &minLayer, const int &maxLayer, ReadFunc readFunc, WriteFunc writeFunc, RunningFunc runningFunc)
+    {
+        _readWaitNs = 0;
+        _writeWaitNs = 0;
+        if (_depth < 1)
+        {
+            for (int curLayer = minLayer; curLayer <= maxLayer; ++ curLayer)
+            {
+                if (false == runningFunc()) break;
+                writeFunc(readFunc(curLayer));
+            }
+            return;
+        }
+
+        QMutex queueLocker;
+        QQueue<Job> jobQueue;
+        QSemaphore freeSlots(_depth);
+        QSemaphore usedSlots(0);
+
+        // 读取线程: 顺序读取各层, 最多领先写入阶段 depth 层
+        auto producer = QtConcurrent::run([&]() {
+            QElapsedTimer timer;
+            for (int curLayer = minLayer; curLayer <= maxLayer; ++ curLayer)
+            {
+                if (false == runningFunc()) break;
+
+                timer.restart();
+                freeSlots.acquire();
+                _readWaitNs += timer.nsecsElapsed();
+
+                auto job = readFunc(curLayer);
+                queueLocker.lock();
+                jobQueue.enqueue(job);
+                queueLocker.unlock();
+                usedSlots.release();
+            }
+
+            // 结束标记
+            queueLocker.lock();
+            jobQueue.enqueue(nullptr);
+            queueLocker.unlock();
+            usedSlots.release();
+        });
+
+        // 写入阶段: 在当前线程按层序消费, 停止后仍需取空队列以释放读取线程
+        QElapsedTimer timer;
+        while (true)
+        {
+            timer.restart();
+            usedSlots.acquire();
+            _writeWaitNs += timer.nsecsElapsed();
+
+            queueLocker.lock();
+            auto job = jobQueue.dequeue();
+            queueLocker.unlock();
+            if (nullptr == job) break;
+
+            if (runningFunc()) writeFunc(job);
+            freeSlots.release();
+        }
+        producer.waitForFinished();
+    }
+
+private:
+    int _depth = 0;
+    qint64 _readWaitNs = 0;     // 读取线程等待空闲槽位耗时(纳秒)
+    qint64 _writeWaitNs = 0;    // 写入阶段等待读取结果耗时(纳秒)
+};
+
+#endif // LAYERPIPELINE_H
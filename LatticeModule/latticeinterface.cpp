@@ -2,6 +2,7 @@
 #include "latticsdiamond.h"
 #include "./ScanLinesSortor/scanlinessortor.h"
 #include "meshinfo.h"
+#include "layerarena.h"
 
 #include <QVector3D>
 #include <QMutex>
@@ -14,9 +15,343 @@ using namespace ClipperLib;
 struct LatticeInterface::Priv {
     QSharedPointer<LatticsAbstract> _latticsInf = nullptr;
     double _shellThickness = 600.0;
+    bool _useTiled = true;      // 是否启用分块晶格
+    int _tileCells = 16;        // 分块边长(晶格单元数)
+
+    // 晶格单元分类
+    enum CellState {
+        CS_Outside = 0,         // 完全位于参考区域外
+        CS_Inside,              // 完全位于参考区域内且不与其它轮廓接触
+        CS_Boundary             // 需要裁剪的边界单元
+    };
+
+    // 栅格标记
+    enum RasterFlag {
+        RF_AreaEdge = 0x01,     // 参考区域边经过
+        RF_SolidEdge = 0x02,    // 输入路径边经过
+        RF_Area = 0x04,         // 中心位于参考区域内
+        RF_Solid = 0x08         // 中心位于输入路径内
+    };
+
+    // 晶格单元摆放信息
+    struct CellInfo {
+        int _type = 0;          // 晶格类型
+        double _area = 0.0;     // 晶格面积
+        float _x = 0.0f;        // X方向平移量
+        float _y = 0.0f;        // Y方向平移量
+        BOUNDINGRECT _rc;       // 平移后边界框
+        int _state = CS_Outside;
+
+        CellInfo() = default;
+        CellInfo(const int &type, const double &area, const float &x, const float &y, const BoundingBoxD &rc) {
+            _type = type;
+            _area = area;
+            _x = x;
+            _y = y;
+            // 与transformPath取整方式一致
+            _rc.minX = qRound(rc._minX + x);
+            _rc.maxX = qRound(rc._maxX + x);
+            _rc.minY = qRound(rc._minY + y);
+            _rc.maxY = qRound(rc._maxY + y);
+        }
+    };
+
+    // 参考区域粗栅格
+    struct CellRaster {
+        double _originX = 0.0;
+        double _originY = 0.0;
+        double _cellSz = 1.0;
+        int _cols = 0;
+        int _rows = 0;
+        ArenaVector<uchar> _flags;
+
+        ///
+        /// @brief 初始化栅格
+        /// @param bBox 栅格覆盖范围
+        /// @param cellSz 栅格边长
+        ///
+        void initialize(const BoundingBox &bBox, const double &cellSz) {
+            _cellSz = qMax(cellSz, 1.0);
+            _originX = bBox.minX - _cellSz;
+            _originY = bBox.minY - _cellSz;
+            _cols = int((bBox.maxX - _originX) / _cellSz) + 2;
+            _rows = int((bBox.maxY - _originY) / _cellSz) + 2;
+            _flags.assign(size_t(_cols * _rows), 0);
+        }
+
+        inline int colOf(const double &x) const { return int(floor((x - _originX) / _cellSz)); }
+        inline int rowOf(const double &y) const { return int(floor((y - _originY) / _cellSz)); }
+
+        ///
+        /// @brief 将路径写入栅格
+        /// @param paths 输入路径
+        /// @param edgeFlag 边经过标记
+        /// @param insideFlag 中心在内标记(奇偶规则)
+        /// @details 实现步骤:
+        ///   1. 逐边按列标记经过的栅格
+        ///   2. 记录各行中心线与边的交点
+        ///   3. 按交点奇偶性标记栅格中心是否在内
+        ///
+        void addPaths(const Paths &paths, const uchar &edgeFlag, const uchar &insideFlag) {
+            std::vector<ArenaVector<double>> rowCrossVec(size_t(_rows));
+            for (const auto &path : paths)
+            {
+                auto ptSz = int(path.size());
+                for (int i = 0; i < ptSz; ++ i)
+                {
+                    const auto &p1 = path[i];
+                    const auto &p2 = path[(i + 1) % ptSz];
+
+                    // 按列标记经过的栅格
+                    double x1 = p1.X, y1 = p1.Y, x2 = p2.X, y2 = p2.Y;
+                    if (x1 > x2) {
+                        std::swap(x1, x2);
+                        std::swap(y1, y2);
+                    }
+                    auto c0 = qMax(colOf(x1), 0);
+                    auto c1 = qMin(colOf(x2), _cols - 1);
+                    for (int c = c0; c <= c1; ++ c)
+                    {
+                        auto xa = qMax(x1, _originX + c * _cellSz);
+                        auto xb = qMin(x2, _originX + (c + 1) * _cellSz);
+                        auto ya = y1, yb = y2;
+                        if (x2 > x1) {
+                            ya = y1 + (xa - x1) * (y2 - y1) / (x2 - x1);
+                            yb = y1 + (xb - x1) * (y2 - y1) / (x2 - x1);
+                        }
+                        auto r0 = qMax(rowOf(qMin(ya, yb)), 0);
+                        auto r1 = qMin(rowOf(qMax(ya, yb)), _rows - 1);
+                        for (int r = r0; r <= r1; ++ r) _flags[r * _cols + c] |= edgeFlag;
+                    }
+
+                    // 记录行中心线交点
+                    if (p1.Y == p2.Y) continue;
+                    auto r0 = qMax(rowOf(qMin(p1.Y, p2.Y)) - 1, 0);
+                    auto r1 = qMin(rowOf(qMax(p1.Y, p2.Y)) + 1, _rows - 1);
+                    for (int r = r0; r <= r1; ++ r)
+                    {
+                        auto yc = _originY + (r + 0.5) * _cellSz;
+                        if ((p1.Y <= yc) == (p2.Y <= yc)) continue;
+                        rowCrossVec[size_t(r)].push_back(p1.X + (yc - p1.Y) * double(p2.X - p1.X) / double(p2.Y - p1.Y));
+                    }
+                }
+            }
+
+            // 按奇偶性标记中心在内的栅格
+            for (int r = 0; r < _rows; ++ r)
+            {
+                auto &crossVec = rowCrossVec[size_t(r)];
+                if (crossVec.size() < 2) continue;
+                std::sort(crossVec.begin(), crossVec.end());
+                int crossIndex = 0;
+                for (int c = 0; c < _cols; ++ c)
+                {
+                    auto xc = _originX + (c + 0.5) * _cellSz;
+                    while (crossIndex < int(crossVec.size()) && crossVec[size_t(crossIndex)] < xc) ++ crossIndex;
+                    if (crossIndex & 0x1) _flags[r * _cols + c] |= insideFlag;
+                }
+            }
+        }
+
+        ///
+        /// @brief 统计边界框覆盖栅格的标记
+        /// @param rc 边界框
+        /// @param orFlags 输出标记并集
+        /// @param andFlags 输出标记交集(超出栅格范围视为空)
+        ///
+        void rangeFlags(const BOUNDINGRECT &rc, uchar &orFlags, uchar &andFlags) const {
+            orFlags = 0;
+            andFlags = 0xFF;
+            auto c0 = colOf(rc.minX), c1 = colOf(rc.maxX);
+            auto r0 = rowOf(rc.minY), r1 = rowOf(rc.maxY);
+            if (c0 < 0 || r0 < 0 || c1 >= _cols || r1 >= _rows) andFlags = 0;
+            c0 = qMax(c0, 0); c1 = qMin(c1, _cols - 1);
+            r0 = qMax(r0, 0); r1 = qMin(r1, _rows - 1);
+            for (int r = r0; r <= r1; ++ r)
+            {
+                for (int c = c0; c <= c1; ++ c)
+                {
+                    orFlags |= _flags[r * _cols + c];
+                    andFlags &= _flags[r * _cols + c];
+                }
+            }
+            if (c0 > c1 || r0 > r1) andFlags = 0;
+        }
+    };
+
     Priv() {
         _latticsInf = QSharedPointer<LatticsAbstract>(new LatticsDiamond);
     }
+
+    ///
+    /// @brief 栅格分类晶格单元
+    /// @param cellVec 晶格单元集合
+    /// @param pathsArea 参考区域
+    /// @param paths 输入路径
+    /// @param bBox 参考区域边界框
+    /// @param spacing 晶格间距(栅格边长)
+    /// @details 实现步骤:
+    ///   1. 未启用分块时全部按边界单元处理
+    ///   2. 参考区域和输入路径写入粗栅格
+    ///   3. 按覆盖栅格标记并行分类
+    ///   4. 与其它单元边界框接触的内部单元降级为边界单元
+    ///
+    void classifyCells(QVector<CellInfo> &cellVec, const Paths &pathsArea, const Paths &paths,
+                       const BoundingBox &bBox, const double &spacing) {
+        // 未启用分块时全部裁剪
+        if (false == _useTiled) {
+            for (auto &cell : cellVec) cell._state = CS_Boundary;
+            return;
+        }
+
+        // 栅格标记、行交点及分桶索引处于层内存池作用域时从内存池分配, 在返回时回收
+        LayerArenaMark arenaMark;
+
+        // 构建粗栅格
+        CellRaster raster;
+        raster.initialize(bBox, spacing);
+        raster.addPaths(pathsArea, RF_AreaEdge, RF_Area);
+        raster.addPaths(paths, RF_SolidEdge, RF_Solid);
+
+        // 按覆盖栅格分类
+        const int cellSz = cellVec.size();
+#pragma omp parallel for
+        for (int i = 0; i < cellSz; ++ i)
+        {
+            auto &cell = cellVec[i];
+            uchar orFlags = 0, andFlags = 0;
+            raster.rangeFlags(cell._rc, orFlags, andFlags);
+            if (0 == (orFlags & (RF_AreaEdge | RF_Area))) cell._state = CS_Outside;
+            else if ((andFlags & RF_Area) && 0 == (orFlags & (RF_AreaEdge | RF_SolidEdge | RF_Solid))) cell._state = CS_Inside;
+            else cell._state = CS_Boundary;
+        }
+
+        // 按栅格分桶登记有效单元
+        std::vector<ArenaVector<int>> bucketVec(size_t(raster._cols * raster._rows));
+        for (int i = 0; i < cellSz; ++ i)
+        {
+            const auto &rc = cellVec[i]._rc;
+            if (CS_Outside == cellVec[i]._state) continue;
+            auto c0 = qMax(raster.colOf(rc.minX), 0), c1 = qMin(raster.colOf(rc.maxX), raster._cols - 1);
+            auto r0 = qMax(raster.rowOf(rc.minY), 0), r1 = qMin(raster.rowOf(rc.maxY), raster._rows - 1);
+            for (int r = r0; r <= r1; ++ r)
+            {
+                for (int c = c0; c <= c1; ++ c) bucketVec[size_t(r * raster._cols + c)].push_back(i);
+            }
+        }
+
+        // 内部单元与其它单元接触时合并结果不可预知,降级为边界单元
+        auto isOverlapped = [](const BOUNDINGRECT &a, const BOUNDINGRECT &b) -> bool {
+            return !(a.maxX < b.minX || b.maxX < a.minX || a.maxY < b.minY || b.maxY < a.minY);
+        };
+        ArenaVector<char> touchedVec(size_t(cellSz), 0);
+#pragma omp parallel for
+        for (int i = 0; i < cellSz; ++ i)
+        {
+            const auto &cell = cellVec[i];
+            if (CS_Inside != cell._state) continue;
+            auto c0 = raster.colOf(cell._rc.minX), c1 = raster.colOf(cell._rc.maxX);
+            auto r0 = raster.rowOf(cell._rc.minY), r1 = raster.rowOf(cell._rc.maxY);
+            for (int r = r0; r <= r1 && 0 == touchedVec[i]; ++ r)
+            {
+                for (int c = c0; c <= c1 && 0 == touchedVec[i]; ++ c)
+                {
+                    for (const auto &other : bucketVec[size_t(r * raster._cols + c)])
+                    {
+                        if (other == i || false == isOverlapped(cell._rc, cellVec[other]._rc)) continue;
+                        touchedVec[i] = 1;
+                        break;
+                    }
+                }
+            }
+        }
+        for (int i = 0; i < cellSz; ++ i)
+        {
+            if (touchedVec[i]) cellVec[i]._state = CS_Boundary;
+        }
+    }
+
+    ///
+    /// @brief 分块并行裁剪边界单元
+    /// @param cellVec 晶格单元集合
+    /// @param layerPaths 基础晶格单元
+    /// @param pathsArea 参考区域
+    /// @param latticePaths 输出裁剪结果
+    /// @param latticeSet 输出边界单元识别信息
+    /// @details 实现步骤:
+    ///   1. 按单元左下角所在分块归类边界单元
+    ///   2. 各分块仅保留与分块范围相交的参考轮廓
+    ///   3. 并行执行分块求交
+    ///   4. 按分块顺序合并结果
+    ///
+    void clipBoundaryCells(const QVector<CellInfo> &cellVec, const DoublePaths &layerPaths, const Paths &pathsArea,
+                           Paths &latticePaths, QSet<LatticeInfo> &latticeSet) {
+        // 按分块归类边界单元
+        QMap<QPair<int, int>, QVector<int>> tileMap;
+        double tileSz = 1.0;
+        for (const auto &cell : cellVec)
+        {
+            if (CS_Boundary != cell._state) continue;
+            tileSz = qMax(tileSz, double(qMax(cell._rc.maxX - cell._rc.minX, cell._rc.maxY - cell._rc.minY)));
+        }
+        tileSz *= _tileCells;
+        for (int i = 0; i < cellVec.size(); ++ i)
+        {
+            const auto &cell = cellVec[i];
+            if (CS_Boundary != cell._state) continue;
+            latticeSet.insert(LatticeInfo(cell._type, cell._area, cell._rc.minX, cell._rc.minY));
+            auto key = _useTiled ? qMakePair(int(floor(cell._rc.minY / tileSz)), int(floor(cell._rc.minX / tileSz)))
+                                 : qMakePair(0, 0);
+            tileMap[key] << i;
+        }
+        if (tileMap.size() < 1) return;
+
+        // 参考轮廓边界框
+        QVector<BOUNDINGRECT> areaRcVec(int(pathsArea.size()));
+        for (int i = 0; i < areaRcVec.size(); ++ i) calcBBox(pathsArea[i], areaRcVec[i]);
+
+        // 并行执行分块求交; 求交在 OpenMP 工作线程上分配(内存池为层线程私有), 结果路径又会写出本函数,
+        // 因此这里保持堆分配
+        const auto tileVec = tileMap.values().toVector();
+        const int tileCnt = tileVec.size();
+        QVector<Paths> resultVec(tileCnt);
+#pragma omp parallel for schedule(dynamic)
+        for (int iTile = 0; iTile < tileCnt; ++ iTile)
+        {
+            // 生成分块内晶格
+            Paths cellPaths;
+            BOUNDINGRECT tileRc;
+            for (const auto &index : tileVec[iTile])
+            {
+                const auto &cell = cellVec[index];
+                cellPaths << transformPath(layerPaths[cell._type], cell._x, cell._y);
+                calcBBox(cellPaths.back(), tileRc);
+            }
+
+            // 收集与分块相交的参考轮廓
+            Paths tileArea;
+            for (int i = 0; i < areaRcVec.size(); ++ i)
+            {
+                const auto &rc = areaRcVec[i];
+                if (rc.maxX < tileRc.minX || rc.minX > tileRc.maxX ||
+                    rc.maxY < tileRc.minY || rc.minY > tileRc.maxY) continue;
+                tileArea << pathsArea[i];
+            }
+            if (tileArea.size() < 1) continue;
+
+            // 与参考路径求交
+            Clipper c;
+            c.AddPaths(tileArea, ptSubject, true);
+            c.AddPaths(cellPaths, ptClip, true);
+            c.Execute(ctIntersection, resultVec[iTile], pftEvenOdd, pftNonZero);
+        }
+
+        // 按分块顺序合并结果
+        for (auto &result : resultVec)
+        {
+            for (auto &path : result) latticePaths << std::move(path);
+        }
+    }
     ///
     /// @brief 计算路径的腔体结构
     /// @param paths 输入路径集合
@@ -226,6 +561,25 @@ void LatticeInterface::initLatticeParas(const QJsonParsing *jsonParsing)
     if (nullptr == d->_latticsInf) return;
     // 调用实现对象初始化参数
     d->_latticsInf->initLatticeParas(jsonParsing);
+
+    // 读取分块参数
+    d->_useTiled = jsonParsing->getValue<int>("Lattice/useTiled", 1);
+    d->_tileCells = qMax(1, jsonParsing->getValue<int>("Lattice/tileCells", 16));
+}
+
+///
+/// @brief 预计算晶格周期截面
+/// @param layerHeis 需要切片的层高度
+/// @param cachePath 截面库文件路径
+/// @param lineSpacing 扫描线间距
+/// @param layerThickness 层厚
+/// @param async 是否后台计算
+///
+void LatticeInterface::precomputeLattics(const QVector<int> &layerHeis, const QString &cachePath,
+                                         const double &lineSpacing, const double &layerThickness, const bool &async)
+{
+    if (nullptr == d->_latticsInf) return;
+    d->_latticsInf->precomputeLattics(layerHeis, cachePath, lineSpacing, layerThickness, async);
 }
 
 ///
@@ -238,10 +592,11 @@ void LatticeInterface::initLatticeParas(const QJsonParsing *jsonParsing)
 /// @return 是否需要生成晶格
 /// @details 实现步骤:
 ///   1. 初始化数据
-///   2. 生成基础晶格单元
-///   3. 在边界框内填充晶格
-///   4. 执行布尔运算
-///   5. 识别和分类晶格
+///   2. 生成基础晶格单元并计算摆放位置
+///   3. 栅格分类晶格单元(内部/外部/边界)
+///   4. 内部单元直接平移输出
+///   5. 边界单元分块并行裁剪后与输入路径求并
+///   6. 识别和分类晶格
 ///
 bool LatticeInterface::calcLayerLattic(Paths &paths, const Paths &refPaths, const int &layer,
                                        ClipperLib::Paths &lattices, LatticeLayerInfo &latticeLayerInfo)
@@ -261,19 +616,19 @@ bool LatticeInterface::calcLayerLattic(Paths &paths, const Paths &refPaths, cons
     if (pathsArea.size() < 1) return false;
 
     // 计算边界框
-    Paths latticePaths;
     BoundingBox boundingBox;
     Areas(pathsArea, boundingBox);
 
     // 创建基础晶格单元
     auto layerPaths = d->_latticsInf->createLattics(layer);
+    latticeLayerInfo._phase = d->_latticsInf->getPhase(layer);
 
     // 获取晶格间距
     auto spacing = d->_latticsInf->getSpacing();
     auto moveSpacing = 4.0 * spacing;
-    QSet<LatticeInfo> latticeSet;
 
-    // 在边界框内填充晶格
+    // 在边界框内计算晶格摆放位置
+    QVector<Priv::CellInfo> cellVec;
     int curType = -1;
     int maxPtSz = 0;
     for (const auto &path : layerPaths)
@@ -298,26 +653,22 @@ bool LatticeInterface::calcLayerLattic(Paths &paths, const Paths &refPaths, cons
         {
             initY -= moveSpacing;
         }
-        // 按间距填充晶格
+        // 按间距摆放晶格
         int oddCnt = 0;
 
         while (true)
         {
-            // Y方向填充
+            // Y方向摆放
             if (rc._maxY + initY >= boundingBox.minY)
             {
-                // X方向填充
+                // X方向摆放
                 auto tempX = initX - (oddCnt ? (2 * spacing) : 0.0);
                 while (true)
                 {
-                    // 添加晶格单元
+                    // 记录晶格单元
                     if (rc._maxX + tempX >= boundingBox.minX)
                     {
-                        auto tempPath = transformPath(path, tempX, initY);
-                        BOUNDINGRECT tempRc;
-                        calcBBox(tempPath, tempRc);
-                        latticeSet.insert(LatticeInfo(curType, area, tempRc.minX, tempRc.minY));
-                        latticePaths << std::move(tempPath);
+                        cellVec << Priv::CellInfo(curType, area, tempX, initY, rc);
                     }
                     tempX += moveSpacing;
                     if (rc._minX + tempX > boundingBox.maxX) break;
@@ -329,23 +680,41 @@ bool LatticeInterface::calcLayerLattic(Paths &paths, const Paths &refPaths, cons
             if (rc._minY + initY > boundingBox.maxY) break;
         }
     }
+    if (cellVec.size() < 1) return false;
 
-    // 执行布尔运算
-    if (latticePaths.size() < 1) return false;
+    // 栅格分类晶格单元
+    d->classifyCells(cellVec, pathsArea, paths, boundingBox, spacing);
+
+    // 内部单元直接平移输出
+    for (const auto &cell : qAsConst(cellVec))
     {
-        // 与参考路径求交
-        Clipper c;
-        c.AddPaths(pathsArea, ptSubject, true);
-        c.AddPaths(latticePaths, ptClip, true);
-        c.Execute(ctIntersection, latticePaths, pftEvenOdd, pftNonZero);
-        if (latticePaths.size() < 1) return false;
+        if (Priv::CS_Inside != cell._state) continue;
+        if (false == latticeLayerInfo._latticePathInfo.contains(cell._type))
+        {
+            LatticePathInfo latticePathInfo;
+            latticePathInfo._type = cell._type;
+            latticePathInfo._path = transformPath(layerPaths[cell._type], cell._x, cell._y);
+            if (false == Orientation(latticePathInfo._path)) ReversePath(latticePathInfo._path);
+            latticePathInfo._centerX = cell._rc.minX;
+            latticePathInfo._centerY = cell._rc.minY;
+            latticeLayerInfo._latticePathInfo.insert(cell._type, latticePathInfo);
+        }
+        latticeLayerInfo._latticeInfo.push_back(LatticeInfo(cell._type, cell._area, cell._rc.minX, cell._rc.minY));
     }
+
+    // 边界单元分块并行裁剪
+    QSet<LatticeInfo> latticeSet;
+    Paths latticePaths;
+    d->clipBoundaryCells(cellVec, layerPaths, pathsArea, latticePaths, latticeSet);
+
+    // 执行布尔运算
+    if (latticePaths.size() < 1 && latticeLayerInfo._latticeInfo.size() < 1) return false;
     {
-        // 与输入路径求并
+        // 与输入路径求并(分块裁剪结果间可能重叠,晶格按非零规则填充)
         Clipper c;
         c.AddPaths(paths, ptSubject, true);
         c.AddPaths(latticePaths, ptClip, true);
-        c.Execute(ctUnion, latticePaths, pftEvenOdd, pftEvenOdd);
+        c.Execute(ctUnion, latticePaths, pftEvenOdd, pftNonZero);
     }
     // {
     //     Clipper c;
@@ -358,12 +727,6 @@ bool LatticeInterface::calcLayerLattic(Paths &paths, const Paths &refPaths, cons
     // 识别和分类晶格
     paths.clear();
     maxPtSz *= 1.5;
-// #pragma omp parallel for num_threads(6)
-// #pragma omp parallel for
-//     for (int i = 0; i < latticePaths.size(); ++ i)
-//     {
-//         auto it = &latticePaths[i];
-
     for (auto it = latticePaths.begin(); it != latticePaths.end(); ++ it)
     {
         if (it->size() < maxPtSz)
@@ -395,11 +758,10 @@ bool LatticeInterface::calcLayerLattic(Paths &paths, const Paths &refPaths, cons
         }
         else paths << std::move(*it);
     }
-    // qDebug() << "find cnt" << laticeVec.size() << "/" << latticePaths.size() << paths.size();
+    // qDebug() << "find cnt" << latticeLayerInfo._latticeInfo.size() << "/" << cellVec.size() << paths.size();
 
     // 排序晶格信息
     if (latticeLayerInfo._latticeInfo.size() > 1) ScanLinesSortor::sortDatas(latticeLayerInfo._latticeInfo);
-    // qDebug() << "~~~~~~~~~~~~~~~~~~calcIndexVec" << laticeVec.size();
 
     return needLattic;
 }
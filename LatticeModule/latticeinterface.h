@@ -15,6 +15,7 @@ public:
     LatticeInterface();
 
     void initLatticeParas(const QJsonParsing *);
+    void precomputeLattics(const QVector<int> &, const QString &, const double &, const double &, const bool &);
     bool calcLayerLattic(ClipperLib::Paths &, const ClipperLib::Paths &,
                          const int &, ClipperLib::Paths &, LatticeLayerInfo &);
 
@@ -46,9 +47,11 @@ struct LatticePathInfo {
 };
 
 struct LatticeLayerInfo {
+    int _phase = -1;                // 层高度在晶格周期内的相位,相位相同的层截面一致
     QVector<LatticeInfo> _latticeInfo;
     QMap<int, LatticePathInfo> _latticePathInfo;
     void initialize() {
+        _phase = -1;
         _latticeInfo.clear();
         _latticePathInfo.clear();
     }
@@ -34,6 +34,8 @@ public:
     virtual DoublePaths createLattics(const int &) = 0;
     virtual void identifyLattices(ClipperLib::Paths &) = 0;
     virtual const float getSpacing() const = 0;
+    virtual int getPhase(const int &) const = 0;
+    virtual void precomputeLattics(const QVector<int> &, const QString &, const double &, const double &, const bool &) {}
 };
 
 struct LatticsInfo {
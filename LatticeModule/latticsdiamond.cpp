@@ -5,6 +5,10 @@
 #include "clipper2/clipper.h"
 
 #include <QVector3D>
+#include <QReadWriteLock>
+#include <QtConcurrent>
+#include <QDataStream>
+#include <QSaveFile>
 
 using namespace ClipperLib;
 using namespace meshdef;
@@ -55,13 +59,26 @@ struct LatticsDiamond::Priv
 
     // 单元体模型
     Part _cellLeg[Leg_Count] = {};  // 支腿模型数组
+
+    // 周期截面库
+    float _legDiameter = 2.0f;      // 支腿直径
+    float _legLength = 5.0f;        // 支腿长度
+    double _lineSpacing = 0.0;      // 扫描线间距, 截面库文件键值
+    double _layerThickness = 0.0;   // 层厚, 截面库文件键值
+    QHash<int, DoublePaths> _sectionTable;  // 相位->晶格截面
+    QReadWriteLock _tableLock;      // 截面库读写锁
+    QFuture<void> _precomputeFuture;    // 后台预计算任务
 };
 
 
 /// LatticsDiamond
 LatticsDiamond::LatticsDiamond() : d(new Priv) { }
 
-LatticsDiamond::~LatticsDiamond() { }
+LatticsDiamond::~LatticsDiamond()
+{
+    // 等待后台预计算结束
+    if (d->_precomputeFuture.isRunning()) d->_precomputeFuture.waitForFinished();
+}
 
 ///
 /// @brief 对二维路径进行平移变换
@@ -131,6 +148,12 @@ void LatticsDiamond::initLatticeParas(const QJsonParsing *jsonParsing)
     auto legDiameter = jsonParsing->getValue<float>("Lattice/legDiameter", 2);
     auto legLength = jsonParsing->getValue<float>("Lattice/legLength", 5);
     d->_toolCompensation = jsonParsing->getValue<float>("Lattice/toolCompensation", 0.07);
+    d->_legDiameter = legDiameter;
+    d->_legLength = legLength;
+    {
+        QWriteLocker locker(&d->_tableLock);
+        d->_sectionTable.clear();
+    }
 
     // 计算几何参数
     float b = float(legDiameter * UNITSPRECISION);
@@ -338,31 +361,101 @@ void LatticsDiamond::initLatticeParas(const QJsonParsing *jsonParsing)
 /// @param layerHei 切片高度
 /// @return 返回切片轮廓路径集合
 /// @details 实现步骤:
-///   1. 计算单元高度
-///   2. 切片所有支腿
-///   3. 移动并合并轮廓
+///   1. 按周期相位查询截面库
+///   2. 未命中时切片计算并写入截面库
 ///
 DoublePaths LatticsDiamond::createLattics(const int &layerHei) 
 {
-    // 创建路径集合
-    DoublePaths paths;
+    // 查询截面库
+    auto phase = getPhase(layerHei);
+    {
+        QReadLocker locker(&d->_tableLock);
+        auto it = d->_sectionTable.constFind(phase);
+        if (it != d->_sectionTable.constEnd()) return it.value();
+    }
 
-    // 计算周期性单元高度
-    float cellHei = layerHei;
-    while (cellHei > 4 * d->_spacing) cellHei -= 4 * d->_spacing;
+    // 计算并写入截面库
+    auto paths = calcSection(calcCellHei(layerHei));
+    QWriteLocker locker(&d->_tableLock);
+    d->_sectionTable.insert(phase, paths);
+    return paths;
+}
 
-    // 切片12个支腿
-    for (int i = 0; i < 12; ++ i)
+///
+/// @brief 预计算一个周期内的晶格截面
+/// @param layerHeis 需要切片的层高度
+/// @param cachePath 截面库文件路径(为空时不读写文件)
+/// @param lineSpacing 扫描线间距, 与晶格参数一起作为截面库文件键值
+/// @param layerThickness 层厚, 与晶格参数一起作为截面库文件键值
+/// @param async 是否在后台线程池计算
+/// @details 实现步骤:
+///   1. 统计层高度对应的周期相位
+///   2. 读取与当前参数一致的截面库文件
+///   3. 支腿按全部缺失相位批量切片
+///   4. 并行合并各相位截面并写入截面库
+///   5. 保存截面库文件
+///
+void LatticsDiamond::precomputeLattics(const QVector<int> &layerHeis, const QString &cachePath,
+                                       const double &lineSpacing, const double &layerThickness, const bool &async)
+{
+    // 等待上一次预计算
+    if (d->_precomputeFuture.isRunning()) d->_precomputeFuture.waitForFinished();
+    d->_lineSpacing = lineSpacing;
+    d->_layerThickness = layerThickness;
+
+    // 读取截面库文件
+    if (false == cachePath.isEmpty()) loadSectionTable(cachePath);
+
+    // 统计缺失相位
+    QMap<int, float> phaseMap;
     {
-        // 获取支腿切片轮廓
-        auto path = d->_cellLeg[i].cutPartOnZ(cellHei);
-        // 添加有效轮廓
-        if (path.size() > 2) paths << std::move(path);
+        QReadLocker locker(&d->_tableLock);
+        for (const auto &layerHei : layerHeis)
+        {
+            auto phase = getPhase(layerHei);
+            if (phaseMap.contains(phase) || d->_sectionTable.contains(phase)) continue;
+            phaseMap.insert(phase, calcCellHei(layerHei));
+        }
     }
+    if (phaseMap.size() < 1) return;
+
+    auto task = [this, phaseMap, cachePath]() {
+        // 支腿批量切片
+        const auto phaseVec = phaseMap.keys().toVector();
+        const auto cellHeiVec = phaseMap.values().toVector();
+        QVector<QVector<DoublePath>> legPathsVec(Leg_Count);
+        for (int i = 0; i < Leg_Count; ++ i)
+        {
+            legPathsVec[i] = d->_cellLeg[i].cutPartOnZ(cellHeiVec);
+        }
 
-    // 移动并合并轮廓
-    moveDoublePath(paths);
-    return paths;
+        // 并行合并截面
+        const int phaseCnt = phaseVec.size();
+        QVector<DoublePaths> sectionVec(phaseCnt);
+#pragma omp parallel for
+        for (int j = 0; j < phaseCnt; ++ j)
+        {
+            DoublePaths paths;
+            for (int i = 0; i < Leg_Count; ++ i)
+            {
+                if (legPathsVec[i][j].size() > 2) paths << legPathsVec[i][j];
+            }
+            moveDoublePath(paths);
+            sectionVec[j] = std::move(paths);
+        }
+
+        // 写入截面库
+        {
+            QWriteLocker locker(&d->_tableLock);
+            for (int j = 0; j < phaseCnt; ++ j) d->_sectionTable.insert(phaseVec[j], sectionVec[j]);
+        }
+
+        // 保存截面库文件
+        if (false == cachePath.isEmpty()) saveSectionTable(cachePath);
+    };
+
+    if (async) d->_precomputeFuture = QtConcurrent::run(task);
+    else task();
 }
 
 
@@ -414,7 +507,154 @@ const float LatticsDiamond::getSpacing() const
 }
 
 
+///
+/// @brief 获取层高度在晶格周期内的相位
+/// @param layerHei 切片高度
+/// @return 返回周期内高度(取整),相位相同的层晶格截面一致
+///
+int LatticsDiamond::getPhase(const int &layerHei) const
+{
+    return qRound(calcCellHei(layerHei));
+}
+
+
 /// Private
+///
+/// @brief 计算指定单元高度的晶格截面
+/// @param cellHei 周期内单元高度
+/// @return 返回截面路径集合
+/// @details 实现步骤:
+///   1. 切片所有支腿
+///   2. 移动并合并轮廓
+///
+DoublePaths LatticsDiamond::calcSection(const float &cellHei)
+{
+    // 创建路径集合
+    DoublePaths paths;
+
+    // 切片12个支腿
+    for (int i = 0; i < Leg_Count; ++ i)
+    {
+        // 获取支腿切片轮廓
+        auto path = d->_cellLeg[i].cutPartOnZ(cellHei);
+        // 添加有效轮廓
+        if (path.size() > 2) paths << std::move(path);
+    }
+
+    // 移动并合并轮廓
+    moveDoublePath(paths);
+    return paths;
+}
+
+// 截面库文件标识及版本
+#define SECTIONTABLE_MAGIC 0x4C415453
+#define SECTIONTABLE_VERSION 2
+
+///
+/// @brief 读取截面库文件
+/// @param cachePath 文件路径
+/// @return 文件存在且参数一致时返回true
+/// @details 实现步骤:
+///   1. 校验文件标识和版本
+///   2. 校验晶格参数(支腿直径/长度/补偿)及扫描线间距、层厚
+///   3. 读取各相位截面并写入截面库, 数量为负或超出剩余文件长度时视为损坏
+///
+bool LatticsDiamond::loadSectionTable(const QString &cachePath)
+{
+    QFile file(cachePath);
+    if (false == file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    // 校验标识和参数
+    quint32 magic = 0, version = 0;
+    double legDiameter = 0.0, legLength = 0.0, toolCompensation = 0.0, lineSpacing = 0.0, layerThickness = 0.0;
+    stream >> magic >> version;
+    if (SECTIONTABLE_MAGIC != magic || SECTIONTABLE_VERSION != version) return false;
+    stream >> legDiameter >> legLength >> toolCompensation >> lineSpacing >> layerThickness;
+    if (fabs(legDiameter - d->_legDiameter) > 1E-6 || fabs(legLength - d->_legLength) > 1E-6 ||
+        fabs(toolCompensation - d->_toolCompensation) > 1E-6 || fabs(lineSpacing - d->_lineSpacing) > 1E-6 ||
+        fabs(layerThickness - d->_layerThickness) > 1E-6) return false;
+
+    // 读取截面, 数量须与剩余文件长度相符, 防止损坏文件导致超大分配
+    auto remainSize = [&file]() -> qint64 { return file.size() - file.pos(); };
+    qint32 phaseCnt = 0;
+    stream >> phaseCnt;
+    if (phaseCnt < 0 || qint64(phaseCnt) * 8 > remainSize()) return false;
+    QHash<int, DoublePaths> sectionTable;
+    for (qint32 i = 0; i < phaseCnt && QDataStream::Ok == stream.status(); ++ i)
+    {
+        qint32 phase = 0, pathCnt = 0;
+        stream >> phase >> pathCnt;
+        if (QDataStream::Ok != stream.status() || pathCnt < 0 || qint64(pathCnt) * 4 > remainSize()) return false;
+        DoublePaths paths(pathCnt);
+        for (auto &path : paths)
+        {
+            qint32 ptCnt = 0;
+            stream >> ptCnt;
+            if (QDataStream::Ok != stream.status() || ptCnt < 0 || qint64(ptCnt) * 16 > remainSize()) return false;
+            path.resize(ptCnt);
+            for (auto &pt : path) stream >> pt.X >> pt.Y;
+        }
+        sectionTable.insert(phase, std::move(paths));
+    }
+    if (QDataStream::Ok != stream.status()) return false;
+
+    QWriteLocker locker(&d->_tableLock);
+    for (auto it = sectionTable.begin(); it != sectionTable.end(); ++ it)
+    {
+        d->_sectionTable.insert(it.key(), it.value());
+    }
+    return true;
+}
+
+///
+/// @brief 保存截面库文件
+/// @param cachePath 文件路径
+/// @details 写入标识、版本、晶格参数、扫描线间距、层厚及全部相位截面,写入完成后整体替换原文件
+///
+void LatticsDiamond::saveSectionTable(const QString &cachePath)
+{
+    QSaveFile file(cachePath);
+    if (false == file.open(QIODevice::WriteOnly)) return;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    stream << quint32(SECTIONTABLE_MAGIC) << quint32(SECTIONTABLE_VERSION)
+           << double(d->_legDiameter) << double(d->_legLength) << double(d->_toolCompensation)
+           << d->_lineSpacing << d->_layerThickness;
+
+    QReadLocker locker(&d->_tableLock);
+    stream << qint32(d->_sectionTable.size());
+    for (auto it = d->_sectionTable.constBegin(); it != d->_sectionTable.constEnd(); ++ it)
+    {
+        stream << qint32(it.key()) << qint32(it.value().size());
+        for (const auto &path : it.value())
+        {
+            stream << qint32(path.size());
+            for (const auto &pt : path) stream << double(pt.X) << double(pt.Y);
+        }
+    }
+    locker.unlock();
+    file.commit();
+}
+
+///
+/// @brief 计算周期内单元高度
+/// @param layerHei 切片高度
+/// @return 返回周期内高度
+/// @details 晶格沿Z方向以4倍间距为周期重复
+///
+float LatticsDiamond::calcCellHei(const int &layerHei) const
+{
+    float cellHei = layerHei;
+    while (cellHei > 4 * d->_spacing) cellHei -= 4 * d->_spacing;
+    return cellHei;
+}
+
 ///
 /// @brief 移动并合并双精度路径
 /// @param paths 输入/输出路径集合
@@ -17,8 +17,14 @@ public:
     DoublePaths createLattics(const int &) override;
     void identifyLattices(Paths &) override;
     inline const float getSpacing() const override;
+    int getPhase(const int &) const override;
+    void precomputeLattics(const QVector<int> &, const QString &, const double &, const double &, const bool &) override;
 
 private:
+    float calcCellHei(const int &) const;
+    DoublePaths calcSection(const float &);
+    bool loadSectionTable(const QString &);
+    void saveSectionTable(const QString &);
     void moveDoublePath(DoublePaths &);
 
 private:
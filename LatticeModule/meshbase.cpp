@@ -1,520 +1,308 @@
 #include "meshbase.h"
 
-#define _LL_ADDRESS(lp) reinterpret_cast<long long>(lp)
 using namespace ClipperLib;
 
 namespace meshdef {
 
+/// MeshSlicer
 ///
-/// @brief 获取边的哈希值
-/// @param edge 边指针
-/// @return 返回由边的两个顶点地址构成的键值对
-/// @details 按顶点顺序生成哈希值
-///
-inline QPair<long long, long long> getEdgeHash(Edge *edge)
-{
-    // 返回边的起点和终点地址构成的键值对
-    return QPair<long long, long long>(_LL_ADDRESS(edge->_vertexs[0]),
-                                     _LL_ADDRESS(edge->_vertexs[1]));
-}
-
-///
-/// @brief 获取半边的哈希值
-/// @param edge 边指针
-/// @return 返回由边的两个顶点地址构成的键值对
-/// @details 按相反顺序生成哈希值
-///
-inline QPair<long long, long long> getHalfEdgeHash(Edge *edge)
-{
-    // 返回边的终点和起点地址构成的键值对
-    return QPair<long long, long long>(_LL_ADDRESS(edge->_vertexs[1]),
-                                     _LL_ADDRESS(edge->_vertexs[0]));
-}
-
-///
-/// @brief 获取边的唯一哈希值
-/// @param edge 边指针
-/// @return 返回由边的两个顶点地址构成的键值对
-/// @details 按顶点地址大小排序生成哈希值
-///
-inline QPair<long long, long long> getUniqueEdgeHash(Edge *edge)
-{
-    // 返回边的两个顶点地址按大小排序后构成的键值对
-    return QPair<long long, long long>(
-        _LL_ADDRESS(std::min(edge->_vertexs[0], edge->_vertexs[1])),
-        _LL_ADDRESS(std::max(edge->_vertexs[0], edge->_vertexs[1])));
-}
-
-///
-/// @brief 对顶点进行变换
-/// @param mat 变换矩阵
-/// @details 使用矩阵对顶点坐标进行映射变换
+/// @brief 由顶点和面片索引构建索引网格
+/// @param vertexs 顶点坐标向量
+/// @param faces 面片顶点索引向量
+/// @details 实现步骤:
+///   1. 顶点坐标拆分为X/Y/Z数组
+///   2. 过滤顶点数不为3或索引越界的面片
+///   3. 按顶点对匹配建立半边对偶关系
+///   4. 构建Z区间索引
 ///
-void Vertex::transform(const QMatrix4x4 &mat)
+void MeshSlicer::build(const QVector<QVector3D> &vertexs, const QVector<QVector<int>> &faces)
 {
-    // 使用变换矩阵映射顶点坐标
-    _coor = mat.map(_coor);
-}
+    clear();
 
+    // 顶点坐标
+    _x.reserve(vertexs.size());
+    _y.reserve(vertexs.size());
+    _z.reserve(vertexs.size());
+    for (const auto &vertex : vertexs)
+    {
+        _x << vertex.x();
+        _y << vertex.y();
+        _z << vertex.z();
+    }
 
-/// Edge
-///
-/// @brief 计算边与切片平面的交点
-/// @param edgeResult 边的计算结果
-/// @param clipResult 切片结果
-/// @return 是否有交点
-/// @details 实现步骤:
-///   1. 计算两端点到切片面的距离
-///   2. 检查端点是否已被使用
-///   3. 检查端点是否在切片面上
-///   4. 计算边与切片面的交点
-///
-bool Edge::calcIntersection(CalcEdgeResult &edgeResult, ClipPathResult &clipResult)
-{
-    // 获取切片高度
-    auto layerHei = clipResult._layerHei;
-    // 计算两端点到切片面的距离
-    auto delV1 = _vertexs[0]->_coor.z() - layerHei;
-    auto delV2 = layerHei - _vertexs[1]->_coor.z();
-
-    // 检查第一个端点是否已被使用
-    if (clipResult._usedVertexSet.contains(_LL_ADDRESS(_vertexs[0])))
+    // 三角形索引
+    const int vertexNum = vertexs.size();
+    _tri.reserve(faces.size() * 3);
+    for (const auto &face : faces)
     {
-        // 如果第二个端点在切片面上且未被使用
-        if (fabs(delV2) < 1E-6 && false == clipResult._usedVertexSet.contains(_LL_ADDRESS(_vertexs[1])))
-        {
-            clipResult._usedVertexSet.insert(_LL_ADDRESS(_vertexs[1]));
-            edgeResult.setVertex(_vertexs[1]);
-            return true;
-        }
-        goto LABEL_NO_INSECTION;
+        if (3 != face.size()) continue;
+        if (face[0] < 0 || face[1] < 0 || face[2] < 0) continue;
+        if (face[0] >= vertexNum || face[1] >= vertexNum || face[2] >= vertexNum) continue;
+        _tri << face[0] << face[1] << face[2];
     }
 
-    // 检查第二个端点是否已被使用
-    if (clipResult._usedVertexSet.contains(_LL_ADDRESS(_vertexs[1])))
+    // 半边对偶关系
+    const long long vertexCnt = _x.size();
+    const int halfEdgeCnt = _tri.size();
+    QHash<long long, int> halfEdgeMap;
+    halfEdgeMap.reserve(halfEdgeCnt);
+    _twin.fill(-1, halfEdgeCnt);
+    for (int i = 0; i < halfEdgeCnt; ++ i)
     {
-        // 如果第一个端点在切片面上且未被使用
-        if (fabs(delV1) < 1E-6 && false == clipResult._usedVertexSet.contains(_LL_ADDRESS(_vertexs[0])))
+        auto a = _tri[i];
+        auto b = _tri[(i % 3 == 2) ? i - 2 : i + 1];
+        auto it = halfEdgeMap.constFind(b * vertexCnt + a);
+        if (it != halfEdgeMap.constEnd())
         {
-            clipResult._usedVertexSet.insert(_LL_ADDRESS(_vertexs[0]));
-            edgeResult.setVertex(_vertexs[0]);
-            return true;
+            _twin[i] = it.value();
+            _twin[it.value()] = i;
         }
-        goto LABEL_NO_INSECTION;
+        else halfEdgeMap.insert(a * vertexCnt + b, i);
     }
 
-    // 检查端点是否在切片面上
-    if (fabs(delV1) < 1E-6)
-    {
-        clipResult._usedVertexSet.insert(_LL_ADDRESS(_vertexs[0]));
-        edgeResult.setVertex(_vertexs[0]);
-        return true;
-    }
-    if (fabs(delV2) < 1E-6)
-    {
-        clipResult._usedVertexSet.insert(_LL_ADDRESS(_vertexs[1]));
-        edgeResult.setVertex(_vertexs[1]);
-        return true;
-    }
+    buildZIndex();
+}
 
-    // 计算边与切片面的交点
-    if (delV1 * delV2 > 0)
+///
+/// @brief 变换顶点坐标
+/// @param mat 变换矩阵
+/// @details 邻接关系不变, 只重建Z区间索引
+///
+void MeshSlicer::transform(const QMatrix4x4 &mat)
+{
+    for (int i = 0; i < _x.size(); ++ i)
     {
-        edgeResult._result = ERT_ONEDGE;
-        edgeResult._vertex = nullptr;
-        auto &coor = edgeResult._coor;
-        // 使用线性插值计算交点坐标
-        coor.setX(_vertexs[1]->_coor.x() +
-                  delV2 / (delV1 + delV2) *
-                      (_vertexs[0]->_coor.x() - _vertexs[1]->_coor.x()));
-        coor.setY(_vertexs[1]->_coor.y() +
-                  delV2 / (delV1 + delV2) *
-                      (_vertexs[0]->_coor.y() - _vertexs[1]->_coor.y()));
-        coor.setZ(layerHei);
-        return true;
+        auto coor = mat.map(QVector3D(_x[i], _y[i], _z[i]));
+        _x[i] = coor.x();
+        _y[i] = coor.y();
+        _z[i] = coor.z();
     }
-
-LABEL_NO_INSECTION:
-    edgeResult._result = ERT_NOINSECITON;
-    edgeResult._vertex = nullptr;
-    return false;
+    buildZIndex();
 }
 
-
-/// face
-
 ///
-/// @brief 三角面构造函数,创建一个由三个顶点构成的三角面
-/// @param v1 第一个顶点指针
-/// @param v2 第二个顶点指针
-/// @param v3 第三个顶点指针
-/// @details 实现步骤:
-///   1. 初始化顶点数组
-///   2. 创建三条边
-///   3. 更新顶点的面列表
-///   4. 计算面法向量
+/// @brief 清空索引网格
 ///
-Face::Face(Vertex *v1, Vertex *v2, Vertex *v3) {
-    // 初始化顶点数组
-    _vertexs.resize(3);
-    _vertexs[0] = v1;
-    _vertexs[1] = v2;
-    _vertexs[2] = v3;
-
-    // 创建三条边,每条边连接两个顶点
-    _edges.resize(3);
-    _edges[0] = new Edge(v1, v2, this);
-    _edges[1] = new Edge(v2, v3, this);
-    _edges[2] = new Edge(v3, v1, this);
-
-    // 将当前面添加到各顶点的面列表中
-    v1->_faceList << this;
-    v2->_faceList << this;
-    v3->_faceList << this;
-
-    // 根据三个顶点坐标计算面法向量
-    _normal = QVector3D::normal(v1->_coor, v2->_coor, v3->_coor);
+void MeshSlicer::clear()
+{
+    _x.clear();
+    _y.clear();
+    _z.clear();
+    _tri.clear();
+    _twin.clear();
+    _faceMinZ.clear();
+    _faceMaxZ.clear();
+    _faceOrder.clear();
+    _buckets.clear();
 }
 
-
 ///
-/// @brief 判断三角面是否与切片平面相交
+/// @brief 计算指定高度的全部切片轮廓
 /// @param layerHei 切片高度
-/// @return 是否有顶点在切片平面上
+/// @return 返回闭合轮廓集合
 /// @details 实现步骤:
-///   1. 遍历三角面的顶点
-///   2. 检查顶点z坐标是否在切片高度上
-///   3. 有任一顶点在切片面上返回true
+///   1. 由Z分桶定位候选面片
+///   2. 过滤出跨越切片面的面片
+///   3. 沿半边邻接追踪轮廓
 ///
-bool Face::isFaceOnLayerHei(const float &layerHei)
+QVector<ClipperLib::DoublePath> MeshSlicer::slice(const float &layerHei) const
 {
-    // 遍历所有顶点
-    for (const auto &vertex : _vertexs)
+    QVector<ClipperLib::DoublePath> loops;
+    if (_buckets.isEmpty()) return loops;
+
+    // 定位分桶
+    auto bucketIndex = int(floor((layerHei - _bucketMinZ) / _bucketSz));
+    if (bucketIndex < 0 || bucketIndex >= _buckets.size()) return loops;
+
+    // 过滤跨越切片面的面片
+    QVector<int> crossFaces;
+    for (const auto &face : _buckets[bucketIndex])
     {
-        // 检查顶点是否在切片平面上
-        if (fabs(vertex->_coor.z() - layerHei) < 1E-6) return true;
+        if (_faceMinZ[face] < layerHei && _faceMaxZ[face] >= layerHei) crossFaces << face;
     }
-    return false;
-}
+    if (crossFaces.size() < 1) return loops;
 
-///
-/// @brief 更新三角面法向量
-/// @details 使用三个顶点坐标重新计算法向量
-///
-void Face::updateNormal()
-{
-    // 根据三个顶点坐标计算面法向量
-    _normal = QVector3D::normal(_vertexs[0]->_coor, _vertexs[1]->_coor, _vertexs[2]->_coor);
+    // 追踪轮廓
+    QVector<char> faceStates(_faceMinZ.size(), 0);
+    traceLoops(layerHei, crossFaces, faceStates, loops);
+    return loops;
 }
 
-
 ///
-/// @brief 计算三角面片与切片平面的交点
-/// @param clipResult 切片结果引用
-/// @return 是否找到有效交点
+/// @brief 批量计算多个高度的切片轮廓
+/// @param layerHeis 切片高度集合
+/// @return 返回与输入顺序一致的轮廓集合
 /// @details 实现步骤:
-///   1. 检查面片是否已处理
-///   2. 遍历面片的边计算交点
-///   3. 更新切片结果
-///   4. 递归处理相邻面片
+///   1. 切片高度升序排列
+///   2. 按最小Z顺序扫描,维护跨越当前高度的活动面片
+///   3. 逐个高度追踪轮廓
 ///
-bool Face::calcIntersection(ClipPathResult &clipResult)
+QVector<QVector<ClipperLib::DoublePath>> MeshSlicer::slice(const QVector<float> &layerHeis) const
 {
-    // 检查面片是否已处理
-    if (clipResult._usedFaceSet.contains(_LL_ADDRESS(this))) return false;
-    clipResult._usedFaceSet << _LL_ADDRESS(this);
-    // if (isFaceOnLayerHei(clipResult._layerHei)) return false;
-
-    // 存储边的计算结果
-    QVector<CalcEdgeResult> resultVec;
-    // 遍历面片的所有边
-    for (auto lpEdge : qAsConst(_edges))
-    {
-        // 获取边的唯一哈希值
-        auto hash = getUniqueEdgeHash(lpEdge);
-        // 跳过已处理的边
-        if (clipResult._usedEdgeSet.contains(hash)) continue;
-        clipResult._usedEdgeSet.insert(hash);
-
-        // 计算边与切片平面的交点
-        CalcEdgeResult edgeResult;
-        if (false == lpEdge->calcIntersection(edgeResult, clipResult)) continue;
-        edgeResult._edge = lpEdge;
-        resultVec << (std::move(edgeResult));
-    }
-    // 无交点则返回
-    if (resultVec.size() < 1) return false;
-
-    // 更新切片结果
-    if (updateClipResult(clipResult, resultVec))
+    QVector<QVector<ClipperLib::DoublePath>> loopsVec(layerHeis.size());
+    if (_faceOrder.isEmpty()) return loopsVec;
+
+    // 高度升序
+    QVector<int> heiOrder(layerHeis.size());
+    for (int i = 0; i < heiOrder.size(); ++ i) heiOrder[i] = i;
+    std::sort(heiOrder.begin(), heiOrder.end(), [&layerHeis](const int &a, const int &b) {
+        return layerHeis[a] < layerHeis[b];
+    });
+
+    // 扫描活动面片
+    QVector<char> faceStates(_faceMinZ.size(), 0);
+    QVector<int> activeFaces;
+    int orderIndex = 0;
+    const int faceCnt = _faceOrder.size();
+    for (const auto &heiIndex : qAsConst(heiOrder))
     {
-        // 如果起点在顶点上,处理共顶点的相邻面片
-        if (ERT_ONVERTEX == clipResult._startCoor._result)
+        const auto &layerHei = layerHeis[heiIndex];
+        while (orderIndex < faceCnt && _faceMinZ[_faceOrder[orderIndex]] < layerHei)
         {
-            auto faceList = clipResult._startCoor._vertex->_faceList;
-            for (auto *face : qAsConst(faceList))
-            {
-                if (clipResult._usedFaceSet.contains(_LL_ADDRESS(face))) continue;
-                if (face->calcIntersection(clipResult)) break;
-            }
+            activeFaces << _faceOrder[orderIndex];
+            ++ orderIndex;
         }
-        // 如果起点在边上,处理共边的相邻面片
-        else if (ERT_ONEDGE == clipResult._startCoor._result)
+
+        // 移除已低于切片面的面片
+        int validCnt = 0;
+        for (const auto &face : qAsConst(activeFaces))
         {
-            clipResult._startCoor._edge->_nextFace->calcIntersection(clipResult);
+            if (_faceMaxZ[face] >= layerHei) activeFaces[validCnt ++] = face;
         }
+        activeFaces.resize(validCnt);
+        if (validCnt < 1) continue;
+
+        traceLoops(layerHei, activeFaces, faceStates, loopsVec[heiIndex]);
     }
-    return true;
+    return loopsVec;
 }
 
-
 ///
-/// @brief 处理三角面片(Face)与切片平面的交点，负责将三维模型转换为二维轮廓
-/// @param clipResult 切片结果
-/// @param edgeRstVec 边计算结果向量
-/// @return 更新是否成功
+/// @brief 构建面片Z区间索引
 /// @details 实现步骤:
-///   1. 检查切片状态和边结果数量
-///   2. 根据切片是否已开始分别处理:
-///      - 未开始: 初始化切片起点
-///      - 已开始: 添加切片路径点
-///   3. 根据边结果数量(1-3个)采用不同处理策略
+///   1. 计算各面片Z范围
+///   2. 按最小Z排序面片(批量扫描使用)
+///   3. 按Z分桶登记面片(单次查询使用)
 ///
-bool Face::updateClipResult(ClipPathResult &clipResult,
-                          const QVector<CalcEdgeResult> &edgeRstVec)
+void MeshSlicer::buildZIndex()
 {
-    // 检查边结果数量是否合法(切片已开始且边结果数量大于1,则非法)
-    if (clipResult._started && edgeRstVec.size() > 1)
+    const int faceCnt = _tri.size() / 3;
+    _faceMinZ.resize(faceCnt);
+    _faceMaxZ.resize(faceCnt);
+    _faceOrder.resize(faceCnt);
+    if (faceCnt < 1) return;
+
+    // 面片Z范围
+    float meshMinZ = FLT_MAX;
+    float meshMaxZ = -FLT_MAX;
+    for (int i = 0; i < faceCnt; ++ i)
     {
-        qDebug() << "[Error]" << "Too Many edgeRstVec" << clipResult._started
-                 << clipResult._edgeResultVec.size() << clipResult._path.size() << edgeRstVec.size();
-        return false;
+        auto z0 = _z[_tri[3 * i]], z1 = _z[_tri[3 * i + 1]], z2 = _z[_tri[3 * i + 2]];
+        _faceMinZ[i] = qMin(z0, qMin(z1, z2));
+        _faceMaxZ[i] = qMax(z0, qMax(z1, z2));
+        meshMinZ = qMin(meshMinZ, _faceMinZ[i]);
+        meshMaxZ = qMax(meshMaxZ, _faceMaxZ[i]);
+        _faceOrder[i] = i;
     }
-
-    // 切片未开始的处理
-    if (false == clipResult._started)
+    std::sort(_faceOrder.begin(), _faceOrder.end(), [this](const int &a, const int &b) {
+        return _faceMinZ[a] < _faceMinZ[b];
+    });
+
+    // Z分桶
+    auto bucketCnt = qBound(1, faceCnt / 8, 4096);
+    _bucketMinZ = meshMinZ;
+    _bucketSz = qMax((meshMaxZ - meshMinZ) / bucketCnt, 1E-3f);
+    _buckets.resize(bucketCnt + 1);
+    for (int i = 0; i < faceCnt; ++ i)
     {
-        // 处理单个边结果
-        if (1 == edgeRstVec.size())
-        {
-            // 初始化第一个边结果
-            if (0 == clipResult._edgeResultVec.size())
-            {
-                auto &edgeRst = edgeRstVec[0];
-                // 验证边结果类型
-                if (ERT_ONVERTEX != edgeRst._result || nullptr == edgeRst._vertex)
-                {
-                    qDebug() << "[Error]" << "edgeRst Result Error" << edgeRst._result << edgeRst._vertex;
-                    return false;
-                }
-                // 保存边结果和起点
-                clipResult._edgeResultVec << edgeRstVec[0];
-                clipResult._startCoor = edgeRstVec[0];
-            }
-            // 处理第二个边结果
-            else if (1 == clipResult._edgeResultVec.size())
-            {
-                updateClipResult(clipResult, edgeRstVec[0], clipResult._edgeResultVec[0]);
-            }
-            else
-            {
-                qDebug() << "[Error]" << "Too Many Clip edgeRstVec" << clipResult._started
-                         << clipResult._edgeResultVec.size() << clipResult._path.size() << edgeRstVec.size();
-                return false;
-            }
-        }
-        // 处理两个边结果
-        else if (2 == edgeRstVec.size())
-        {
-            updateClipResult(clipResult, edgeRstVec[0], edgeRstVec[1]);
-        }
-        // 处理三个边结果
-        else if (3 == edgeRstVec.size())
-        {
-            // 循环处理相邻边结果对
-            for (int i = 0; i < edgeRstVec.size(); ++ i)
-            {
-                int nextIndex = i + 1;
-                if (nextIndex > edgeRstVec.size() - 1) nextIndex = 0;
-                if (updateClipResult(clipResult, edgeRstVec[i], edgeRstVec[nextIndex])) break;
-            }
-        }
+        auto b0 = qBound(0, int(floor((_faceMinZ[i] - _bucketMinZ) / _bucketSz)), bucketCnt);
+        auto b1 = qBound(0, int(floor((_faceMaxZ[i] - _bucketMinZ) / _bucketSz)), bucketCnt);
+        for (int b = b0; b <= b1; ++ b) _buckets[b] << i;
     }
-    // 切片已开始的处理
-    else
-    {
-        // 添加单个切片点
-        if (1 == edgeRstVec.size())
-        {
-            clipResult._path << DoublePoint(edgeRstVec[0]._coor.x(), edgeRstVec[0]._coor.y());
-            clipResult._startCoor = edgeRstVec[0];
-        }
-        else if (2 == edgeRstVec.size())
-        {
-            // 预留两个边结果的处理
-        }
-    }
-
-    return true;
 }
 
+///
+/// @brief 计算半边与切片面交点
+/// @param halfEdge 半边索引
+/// @param layerHei 切片高度
+/// @return 返回交点坐标
+/// @details 按顶点索引固定端点顺序插值,保证对偶半边结果一致
+///
+inline ClipperLib::DoublePoint MeshSlicer::edgePoint(const int &halfEdge, const float &layerHei) const
+{
+    auto a = _tri[halfEdge];
+    auto b = _tri[(halfEdge % 3 == 2) ? halfEdge - 2 : halfEdge + 1];
+    if (a > b) std::swap(a, b);
+    auto t = (double(layerHei) - _z[a]) / (double(_z[b]) - _z[a]);
+    return DoublePoint(_x[a] + t * (double(_x[b]) - _x[a]), _y[a] + t * (double(_y[b]) - _y[a]));
+}
 
 ///
-/// @brief 根据两个交点更新切片结果
-/// @param clipResult 切片结果引用
-/// @param coor1 第一个交点结果
-/// @param coor2 第二个交点结果
-/// @return 是否成功更新切片结果
+/// @brief 沿半边邻接追踪切片轮廓
+/// @param layerHei 切片高度
+/// @param crossFaces 跨越切片面的面片
+/// @param faceStates 面片状态缓存(调用前后均为0)
+/// @param loops 输出轮廓集合
 /// @details 实现步骤:
-///   1. 确定交点所在的唯一面片
-///   2. 分析面片顶点与切片平面的位置关系
-///   3. 根据法向量确定交点连接顺序
-///   4. 更新切片路径
+///   1. 顶点Z不小于切片高度视为在上方,每个跨越面片恰有一条下行边和一条上行边
+///   2. 以下行边交点为起点,经上行边的对偶半边进入相邻面片
+///   3. 回到起始面片或遇到开放边时结束当前轮廓
+///   4. 移除重复点,外轮廓按面片法向为逆时针
 ///
-bool Face::updateClipResult(ClipPathResult &clipResult, 
-                          const CalcEdgeResult &coor1,
-                          const CalcEdgeResult &coor2)
+void MeshSlicer::traceLoops(const float &layerHei, const QVector<int> &crossFaces, QVector<char> &faceStates,
+                            QVector<ClipperLib::DoublePath> &loops) const
 {
-    // 查找包含两个交点的唯一面片
-    Face *uniqueFace = nullptr;
-    Vertex *v3 = nullptr;
+    for (const auto &face : crossFaces) faceStates[face] = 1;
 
-    // 两个交点都在顶点上的情况
-    if (ERT_ONVERTEX == coor1._result && ERT_ONVERTEX == coor2._result)
+    auto isSamePt = [](const DoublePoint &p1, const DoublePoint &p2) -> bool {
+        return fabs(p1.X - p2.X) < 1E-6 && fabs(p1.Y - p2.Y) < 1E-6;
+    };
+    for (const auto &startFace : crossFaces)
     {
-        // 查找共享这两个顶点的面片
-        for (auto *itFace : qAsConst(coor1._vertex->_faceList))
+        if (1 != faceStates[startFace]) continue;
+
+        DoublePath path;
+        auto curFace = startFace;
+        while (true)
         {
-            if (coor2._vertex->_faceList.contains(itFace))
+            faceStates[curFace] = 2;
+
+            // 查找下行边和上行边
+            int downEdge = -1, upEdge = -1;
+            for (int k = 0; k < 3; ++ k)
             {
-                // 找到第三个顶点
-                for (const auto &vertex : qAsConst(itFace->_vertexs))
-                {
-                    if (vertex == coor1._vertex || vertex == coor2._vertex) continue;
-                    v3 = vertex;
-                    break;
-                }
+                auto halfEdge = 3 * curFace + k;
+                auto belowA = _z[_tri[halfEdge]] < layerHei;
+                auto belowB = _z[_tri[3 * curFace + (k + 1) % 3]] < layerHei;
+                if (false == belowA && belowB) downEdge = halfEdge;
+                else if (belowA && false == belowB) upEdge = halfEdge;
+            }
+            if (downEdge < 0 || upEdge < 0) break;
 
-                if (nullptr == v3) qDebug() << "[Error]" << "Can not find the third vertex";
-                if (fabs(v3->_coor.z() - clipResult._layerHei) < 1E-6) continue;
+            // 记录起点
+            auto pt = edgePoint(downEdge, layerHei);
+            if (path.empty() || false == isSamePt(path.back(), pt)) path.push_back(pt);
 
-                uniqueFace = itFace;
+            // 进入相邻面片
+            auto twinEdge = _twin[upEdge];
+            auto nextFace = (twinEdge < 0) ? -1 : twinEdge / 3;
+            if (nextFace < 0 || 1 != faceStates[nextFace])
+            {
+                if (nextFace != startFace)
+                {
+                    pt = edgePoint(upEdge, layerHei);
+                    if (false == isSamePt(path.back(), pt)) path.push_back(pt);
+                }
                 break;
             }
+            curFace = nextFace;
         }
 
-        // 未找到唯一面片则移除顶点标记
-        if (nullptr == uniqueFace)
-        {
-            clipResult._usedVertexSet.remove(_LL_ADDRESS(coor1._vertex));
-            clipResult._usedVertexSet.remove(_LL_ADDRESS(coor2._vertex));
-        }
-    }
-    // 第一个交点在顶点上的情况
-    else if (ERT_ONVERTEX == coor1._result)
-    {
-        if (coor1._vertex->_faceList.contains(coor2._edge->_curFace))
-        {
-            uniqueFace = coor2._edge->_curFace;
-        }
-    }
-    // 第二个交点在顶点上的情况
-    else if (ERT_ONVERTEX == coor2._result)
-    {
-        if (coor2._vertex->_faceList.contains(coor1._edge->_curFace))
-        {
-            uniqueFace = coor1._edge->_curFace;
-        }
-    }
-    // 两个交点都在边上的情况
-    else
-    {
-        if (coor1._edge->_curFace == coor2._edge->_curFace)
-        {
-            uniqueFace = coor1._edge->_curFace;
-        }
-    }
-
-    // 检查是否找到唯一面片
-    if (nullptr == uniqueFace)
-    {
-        qDebug() << "[Error]" << "Can not find unique face";
-        return false;
+        if (path.size() > 1 && isSamePt(path.front(), path.back())) path.pop_back();
+        if (path.size() > 2) loops << std::move(path);
     }
 
-    // 统计切片平面上下的顶点
-    int upNum = 0;
-    QList<Vertex *> upVertexList;
-    QList<Vertex *> downVertexList;
-    for (const auto &vertex : qAsConst(uniqueFace->_vertexs))
-    {
-        if (vertex->_coor.z() > clipResult._layerHei)
-        {
-            upVertexList << vertex;
-            ++ upNum;
-        }
-        else if (coor1._vertex != vertex && coor2._vertex != vertex)
-        {
-            downVertexList << vertex;
-        }
-    }
-
-    // 根据法向量确定交点连接顺序
-    if (upNum && upNum < 2)
-    {
-        // 计算法向量
-        auto normal = QVector3D::normal(coor1._coor, coor2._coor, upVertexList[0]->_coor);
-        auto dir = uniqueFace->_normal[0] * normal[0] +
-                   uniqueFace->_normal[1] * normal[1] +
-                   uniqueFace->_normal[2] * normal[2];
-
-        // 根据法向量方向添加路径点
-        if (dir > 0)
-        {
-            clipResult._path << DoublePoint(coor1._coor.x(), coor1._coor.y())
-                           << DoublePoint(coor2._coor.x(), coor2._coor.y());
-            clipResult._startCoor = coor2;
-        }
-        else
-        {
-            clipResult._path << DoublePoint(coor2._coor.x(), coor2._coor.y())
-                           << DoublePoint(coor1._coor.x(), coor1._coor.y());
-            clipResult._startCoor = coor1;
-        }
-        clipResult._started = true;
-        clipResult._edgeResultVec.clear();
-        return true;
-    }
-    else
-    {
-        // 处理下方只有一个顶点的情况(确保切片轮廓与面片法向量保持一致的方向)
-        if (1 == downVertexList.size())
-        {
-            // 计算法向量
-            auto normal = QVector3D::normal(coor2._coor, coor1._coor, downVertexList[0]->_coor);
-            // 通过点积与面片法向量比较
-            auto dir = uniqueFace->_normal[0] * normal[0] +
-                       uniqueFace->_normal[1] * normal[1] +
-                       uniqueFace->_normal[2] * normal[2];
-            // 根据法向量方向添加路径点
-            if (dir > 0)
-            {
-                clipResult._path << DoublePoint(coor1._coor.x(), coor1._coor.y())
-                               << DoublePoint(coor2._coor.x(), coor2._coor.y());
-                clipResult._startCoor = coor2;
-            }
-            else
-            {
-                clipResult._path << DoublePoint(coor2._coor.x(), coor2._coor.y())
-                               << DoublePoint(coor1._coor.x(), coor1._coor.y());
-                clipResult._startCoor = coor1;
-            }
-            clipResult._started = true;
-            clipResult._edgeResultVec.clear();
-            return true;
-        }
-    }
-    return false;
+    for (const auto &face : crossFaces) faceStates[face] = 0;
 }
 
 
@@ -523,158 +311,79 @@ bool Face::updateClipResult(ClipPathResult &clipResult,
 /// @brief 创建零件信息
 /// @param vertexs 顶点坐标向量
 /// @param faces 面片顶点索引向量
-/// @details 实现步骤:
-///   1. 清空现有数据
-///   2. 创建顶点列表
-///   3. 验证并创建面片
-///   4. 建立面片连接关系
+/// @details 由顶点和面片索引直接构建索引切片器
 ///
 void Part::createPartInfo(const QVector<QVector3D> &vertexs,
                          const QVector<QVector<int>> &faces)
 {
-    // 清空现有数据结构
-    _faceList.clear();
-    _edgeMap.clear();
-    _vertexList.clear();
+    _slicer.build(vertexs, faces);
+}
 
-    // 创建顶点列表
-    for (const auto &vertex : vertexs)
-    {
-        _vertexList << VertexPtr(new Vertex(vertex[0], vertex[1], vertex[2]));
-    }
 
-    // 获取顶点数量上限
-    auto vertexNum = _vertexList.size() - 1;
-    // 处理每个面片
-    for (const auto &face : faces)
+///
+/// @brief 选取面积最大的轮廓
+/// @param loops 轮廓集合
+/// @return 返回面积绝对值最大的轮廓
+///
+inline DoublePath takeMaxLoop(QVector<DoublePath> &loops)
+{
+    if (loops.size() < 1) return DoublePath();
+    int maxIndex = 0;
+    double maxArea = -1.0;
+    for (int i = 0; i < loops.size(); ++ i)
     {
-        // 验证面片顶点数量
-        if (3 != face.size()) continue;
-        // 验证顶点索引有效性
-        if (face[0] < 0 || face[1] < 0 || face[2] < 0) continue;
-        if (face[0] > vertexNum || face[1] > vertexNum || face[2] > vertexNum) continue;
-
-        // 创建面片并更新连接关系
-        updateFaceInfo(_vertexList.at(face[0]).data(),
-                      _vertexList.at(face[1]).data(),
-                      _vertexList.at(face[2]).data());
+        // 鞋带公式计算面积
+        double area = 0.0;
+        const auto &loop = loops[i];
+        for (size_t j = 0, k = loop.size() - 1; j < loop.size(); k = j ++)
+        {
+            area += (loop[k].X + loop[j].X) * (loop[k].Y - loop[j].Y);
+        }
+        if (fabs(area) > maxArea)
+        {
+            maxArea = fabs(area);
+            maxIndex = i;
+        }
     }
+    return std::move(loops[maxIndex]);
 }
 
-
-using namespace ClipperLib;
 ///
 /// @brief 在指定高度对零件进行切片
 /// @param layerHei 切片高度
 /// @return 返回切片轮廓路径
 /// @details 实现步骤:
-///   1. 初始化切片结果
-///   2. 设置切片高度
-///   3. 查找切片交点
-///   4. 构建完整轮廓
+///   1. 通过索引切片器只访问跨越切片面的面片
+///   2. 沿半边邻接构建闭合轮廓
+///   3. 返回面积最大的轮廓
 ///
-DoublePath Part::cutPartOnZ(const float &layerHei)
+DoublePath Part::cutPartOnZ(const float &layerHei) const
 {
-    // 创建切片结果对象
-    ClipPathResult clipResult;
-    // 设置切片高度
-    clipResult._layerHei = layerHei;
-    // 从任意面片开始查找交点
-    findNextIntersection(nullptr, clipResult);
-    // 返回构建的轮廓路径
-    return std::move(clipResult._path);
+    auto loops = _slicer.slice(layerHei);
+    return takeMaxLoop(loops);
 }
 
-
 ///
-/// @brief 对零件进行变换，零件摆放位置调整
-/// @param mat 变换矩阵
-/// @details 实现步骤:
-///   1. 变换所有顶点坐标
-///   2. 更新所有面片法向量
+/// @brief 批量对零件进行切片
+/// @param layerHeis 切片高度集合
+/// @return 返回与输入顺序一致的切片轮廓
+/// @details 单次扫描面片Z区间完成全部高度的切片
 ///
-void Part::tranformPart(const QMatrix4x4 &mat)
+QVector<DoublePath> Part::cutPartOnZ(const QVector<float> &layerHeis) const
 {
-    // 对所有顶点应用变换
-    for (const auto &vertex : qAsConst(_vertexList)) 
-        vertex->transform(mat);
-
-    // 更新所有面片的法向量
-    for (const auto &face : qAsConst(_faceList)) 
-        face->updateNormal();
-}
-
-/// Private
-///
-/// @brief 更新零件的面片信息
-/// @param v1 第一个顶点指针
-/// @param v2 第二个顶点指针
-/// @param v3 第三个顶点指针
-/// @details 实现步骤:
-///   1. 创建新的三角面片
-///   2. 添加到面片列表
-///   3. 处理边的连接关系
-///   4. 更新边映射表
-///
-void Part::updateFaceInfo(Vertex *v1, Vertex *v2, Vertex *v3)
-{
-    // 创建新的三角面片并添加到面片列表
-    auto *curFace = new Face(v1, v2, v3);
-    _faceList << FacePtr(curFace);
-
-    // 处理面片的每条边
-    for (auto edge : qAsConst(curFace->_edges))
-    {
-        // 获取边的哈希值
-        auto pair = getEdgeHash(edge);
-        // 检查是否存在重复边
-        if (_edgeMap.contains(pair))
-        {
-            qDebug() << "[ Error ]" << "Repeat Edge";
-            return;
-        }
-
-        // 获取半边哈希值
-        auto halfPair = getHalfEdgeHash(edge);
-        // 如果存在对应的半边,建立相邻面片关系
-        if (_edgeMap.contains(halfPair))
-        {
-            _edgeMap[halfPair]->_nextFace = edge->_curFace;
-            edge->_nextFace = _edgeMap[halfPair]->_curFace;
-        }
-
-        // 将边添加到映射表
-        _edgeMap.insert(pair, EdgePtr(edge));
-    }
+    auto loopsVec = _slicer.slice(layerHeis);
+    QVector<DoublePath> pathVec(loopsVec.size());
+    for (int i = 0; i < loopsVec.size(); ++ i) pathVec[i] = takeMaxLoop(loopsVec[i]);
+    return pathVec;
 }
 
 
 ///
-/// @brief 查找下一个切片交点
-/// @param face 起始面片指针(可为空)
-/// @param clipResult 切片结果引用
-/// @details 实现步骤:
-///   1. 如果没有指定面片:
-///      - 遍历所有面片
-///      - 找到第一个有交点的面片
-///   2. 如果指定了面片:
-///      - 直接计算该面片的交点
+/// @brief 对零件进行变换，零件摆放位置调整
+/// @param mat 变换矩阵
 ///
-void Part::findNextIntersection(Face *face, ClipPathResult &clipResult)
+void Part::tranformPart(const QMatrix4x4 &mat)
 {
-    // 未指定面片时遍历所有面片
-    if (nullptr == face)
-    {
-        for (auto tempFace : qAsConst(_faceList))
-        {
-            // 找到有交点的面片后退出
-            if (tempFace->calcIntersection(clipResult))
-            {
-                break;
-            }
-        }
-    }
-    // 指定面片时直接计算交点
-    else face->calcIntersection(clipResult);
+    _slicer.transform(mat);
 }
 }
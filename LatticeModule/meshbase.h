@@ -5,8 +5,7 @@
 #include <QMatrix4x4>
 #include <QVector3D>
 #include <QVector>
-#include <QPair>
-#include <QMap>
+#include <QHash>
 
 #include <QDebug>
 
@@ -14,17 +13,6 @@
 
 namespace meshdef {
 
-struct Vertex;
-struct Edge;
-struct Face;
-struct BoundingBox;
-struct CalcFaceResult;
-struct ClipPathResult;
-
-typedef QSharedPointer<Vertex> VertexPtr;
-typedef QSharedPointer<Edge> EdgePtr;
-typedef QSharedPointer<Face> FacePtr;
-
 struct BoundingBox {
     float _minX = FLT_MAX;
     float _minY = FLT_MAX;
@@ -34,110 +22,51 @@ struct BoundingBox {
     float _maxZ = FLT_MIN;
 };
 
-enum EdgeResult {
-    ERT_NOINSECITON = 0,
-    ERT_ONEDGE,
-    ERT_ONVERTEX,
-};
-
-enum FaceResult {
-    FRT_FOUNDNONE = 0,
-    FRT_FOUNDFIRST,
-    FRT_FOUNDALL
-};
-
-struct Vertex {
-    QVector3D _coor = QVector3D();
-    QList<Face *> _faceList;
-
-    Vertex() = default;
-    Vertex(const float &x, const float &y, const float &z) :
-        _coor(x, y, z) {}
-
-    void transform(const QMatrix4x4 &mat);
-};
-
-struct CalcEdgeResult {
-    Edge *_edge = nullptr;
-    EdgeResult _result = ERT_NOINSECITON;
-    Vertex *_vertex = nullptr;
-    QVector3D _coor;
-
-    void setVertex(Vertex *v) {
-        _result = ERT_ONVERTEX;
-        _vertex = v;
-        _coor = v->_coor;
-    }
-};
-
-struct Edge {
-    QVector<Vertex *> _vertexs;
-    Face *_curFace = nullptr;
-    Face *_nextFace = nullptr;
+///
+/// @brief 索引网格切片器
+/// @details 顶点坐标、三角形索引和半边邻接按数组存储,
+///          面片按Z区间分桶索引,切片时只访问跨越切片面的面片
+///
+class MeshSlicer
+{
+public:
+    void build(const QVector<QVector3D> &, const QVector<QVector<int>> &);
+    void transform(const QMatrix4x4 &);
+    void clear();
+    inline bool isEmpty() const { return _tri.isEmpty(); }
+
+    QVector<ClipperLib::DoublePath> slice(const float &) const;
+    QVector<QVector<ClipperLib::DoublePath>> slice(const QVector<float> &) const;
 
-    Edge() = default;
-    Edge(Vertex *v1, Vertex *v2, Face *curFace) {
-        _vertexs.resize(2);
-        _vertexs[0] = v1;
-        _vertexs[1] = v2;
-        _curFace = curFace;
-    }
-    bool calcIntersection(CalcEdgeResult &, ClipPathResult &);
-};
-
-struct Face {
-    QVector3D _normal;
-    QVector<Vertex *> _vertexs;
-    QVector<Edge *> _edges;
-
-    Face() = default;
-    Face(Vertex *v1, Vertex *v2, Vertex *v3);
-
-
-    bool isFaceOnLayerHei(const float &);
-    void updateNormal();
-    bool calcIntersection(ClipPathResult &);
-    bool updateClipResult(ClipPathResult &, const QVector<CalcEdgeResult> &);
-    bool updateClipResult(ClipPathResult &, const CalcEdgeResult &, const CalcEdgeResult &);
-};
-
-struct CalcFaceResult {
-    FaceResult _result = FRT_FOUNDNONE;
-    QVector3D _startPt;
-    QVector3D _endPt;
-
-    void initResult() { _result = FRT_FOUNDNONE; }
-    void setFirstPt(const QVector3D &pt)  {
-        _startPt = std::move(pt);
-        _result = FRT_FOUNDFIRST;
-    }
-};
-
-struct ClipPathResult {
-    float _layerHei = 0;
-    QSet<long long> _usedFaceSet;
-    QSet<long long> _usedVertexSet;
-    QSet<QPair<long long, long long>> _usedEdgeSet;
-    CalcEdgeResult _startCoor;
+private:
+    void buildZIndex();
+    inline ClipperLib::DoublePoint edgePoint(const int &, const float &) const;
+    void traceLoops(const float &, const QVector<int> &, QVector<char> &,
+                    QVector<ClipperLib::DoublePath> &) const;
 
-    bool _started = false;
-    QVector<CalcEdgeResult> _edgeResultVec;
-    ClipperLib::DoublePath _path;
+private:
+    QVector<float> _x;              // 顶点X坐标
+    QVector<float> _y;              // 顶点Y坐标
+    QVector<float> _z;              // 顶点Z坐标
+    QVector<int> _tri;              // 三角形顶点索引(每面3个)
+    QVector<int> _twin;             // 对偶半边索引(-1为开放边)
+    QVector<float> _faceMinZ;       // 面片最小Z
+    QVector<float> _faceMaxZ;       // 面片最大Z
+    QVector<int> _faceOrder;        // 按最小Z排序的面片索引
+    float _bucketMinZ = 0.0f;       // 分桶起始Z
+    float _bucketSz = 1.0f;         // 分桶高度
+    QVector<QVector<int>> _buckets; // Z分桶面片索引
 };
 
 struct Part {
-    QList<VertexPtr> _vertexList;
-    QMap<QPair<long long, long long>, EdgePtr> _edgeMap;
-    QList<FacePtr> _faceList;
-
     void createPartInfo(const QVector<QVector3D> &vertexs,
                         const QVector<QVector<int>> &faces);
     void tranformPart(const QMatrix4x4 &mat);
-    ClipperLib::DoublePath cutPartOnZ(const float &layerHei);
+    ClipperLib::DoublePath cutPartOnZ(const float &layerHei) const;
+    QVector<ClipperLib::DoublePath> cutPartOnZ(const QVector<float> &layerHeis) const;
 
 private:
-    void findNextIntersection(Face *, ClipPathResult &);
-    void updateFaceInfo(Vertex *, Vertex *, Vertex *);
+    MeshSlicer _slicer;
 };
 }
 
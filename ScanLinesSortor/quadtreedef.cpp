@@ -79,22 +79,22 @@ bool Node::insertNode(const MPtInfoPtr &pt, const int &x0, const int &y0,
             if (pt->_x < centerX) // 左上象限
             {
                 // 如果左上子节点不存在则创建
-                if (false == _nodeMap.contains(UL))
+                if (nullptr == child(UL))
                 {
-                    _nodeMap[UL] = QSharedPointer<Node>(new Node(this, _depths + 1, UL));
+                    _children[childIndex(UL)] = arenaMakeUnique<Node>(this, _depths + 1, UL);
                 }
                 // 递归插入左上子树
-                _nodeMap[UL]->insertNode(pt, x0, y0, nHalfWid, nHalfHei);
+                child(UL)->insertNode(pt, x0, y0, nHalfWid, nHalfHei);
             }
             else // 右上象限
             {
                 // 如果右上子节点不存在则创建
-                if (false == _nodeMap.contains(UR))
+                if (nullptr == child(UR))
                 {
-                    _nodeMap[UR] = QSharedPointer<Node>(new Node(this, _depths + 1, UR));
+                    _children[childIndex(UR)] = arenaMakeUnique<Node>(this, _depths + 1, UR);
                 }
                 // 递归插入右上子树
-                _nodeMap[UR]->insertNode(pt, x0 + nHalfWid, y0, nHalfWid, nHalfHei);
+                child(UR)->insertNode(pt, x0 + nHalfWid, y0, nHalfWid, nHalfHei);
             }
         }
         else 
@@ -102,22 +102,22 @@ bool Node::insertNode(const MPtInfoPtr &pt, const int &x0, const int &y0,
             if (pt->_x < centerX) // 左下象限
             {
                 // 如果左下子节点不存在则创建
-                if (false == _nodeMap.contains(DL))
+                if (nullptr == child(DL))
                 {
-                    _nodeMap[DL] = QSharedPointer<Node>(new Node(this, _depths + 1, DL));
+                    _children[childIndex(DL)] = arenaMakeUnique<Node>(this, _depths + 1, DL);
                 }
                 // 递归插入左下子树
-                _nodeMap[DL]->insertNode(pt, x0, y0 + nHalfHei, nHalfWid, nHalfHei);
+                child(DL)->insertNode(pt, x0, y0 + nHalfHei, nHalfWid, nHalfHei);
             }
             else // 右下象限
             {
                 // 如果右下子节点不存在则创建
-                if (false == _nodeMap.contains(DR))
+                if (nullptr == child(DR))
                 {
-                    _nodeMap[DR] = QSharedPointer<Node>(new Node(this, _depths + 1, DR));
+                    _children[childIndex(DR)] = arenaMakeUnique<Node>(this, _depths + 1, DR);
                 }
                 // 递归插入右下子树
-                _nodeMap[DR]->insertNode(pt, x0 + nHalfWid, y0 + nHalfHei, nHalfWid, nHalfHei);
+                child(DR)->insertNode(pt, x0 + nHalfWid, y0 + nHalfHei, nHalfWid, nHalfHei);
             }
         }
     }
@@ -128,38 +128,38 @@ bool Node::insertNode(const MPtInfoPtr &pt, const int &x0, const int &y0,
         {
             if (pt->_x < centerX)
             {
-                if (false == _nodeMap.contains(UL))
+                if (nullptr == child(UL))
                 {
-                    _nodeMap[UL] = QSharedPointer<Node>(new EndNode(this, _depths + 1, UL));
+                    _children[childIndex(UL)] = arenaMakeUnique<EndNode>(this, _depths + 1, UL);
                 }
-                _nodeMap[UL]->insertNode(pt, x0, y0, nHalfWid, nHalfHei);
+                child(UL)->insertNode(pt, x0, y0, nHalfWid, nHalfHei);
             }
             else
             {
-                if (nullptr == _nodeMap[UR])
+                if (nullptr == child(UR))
                 {
-                    _nodeMap[UR] = QSharedPointer<Node>(new EndNode(this, _depths + 1, UR));
+                    _children[childIndex(UR)] = arenaMakeUnique<EndNode>(this, _depths + 1, UR);
                 }
-                _nodeMap[UR]->insertNode(pt, x0 + nHalfWid, y0, nHalfWid, nHalfHei);
+                child(UR)->insertNode(pt, x0 + nHalfWid, y0, nHalfWid, nHalfHei);
             }
         }
         else
         {
             if (pt->_x < centerX)
             {
-                if (nullptr == _nodeMap[DL])
+                if (nullptr == child(DL))
                 {
-                    _nodeMap[DL] = QSharedPointer<Node>(new EndNode(this, _depths + 1, DL));
+                    _children[childIndex(DL)] = arenaMakeUnique<EndNode>(this, _depths + 1, DL);
                 }
-                _nodeMap[DL]->insertNode(pt, x0, y0 + nHalfHei, nHalfWid, nHalfHei);
+                child(DL)->insertNode(pt, x0, y0 + nHalfHei, nHalfWid, nHalfHei);
             }
             else
             {
-                if (nullptr == _nodeMap[DR])
+                if (nullptr == child(DR))
                 {
-                    _nodeMap[DR] = QSharedPointer<Node>(new EndNode(this, _depths + 1, DR));
+                    _children[childIndex(DR)] = arenaMakeUnique<EndNode>(this, _depths + 1, DR);
                 }
-                _nodeMap[DR]->insertNode(pt, x0 + nHalfWid, y0 + nHalfHei, nHalfWid, nHalfHei);
+                child(DR)->insertNode(pt, x0 + nHalfWid, y0 + nHalfHei, nHalfWid, nHalfHei);
             }
         }
     }
@@ -297,8 +297,10 @@ void SearchResult::calcNearestPt(Node *node)
                 auto tempDis = pow(pt->_coor_x - _referPt->_coor_x, 2) +
                               pow(pt->_coor_y - _referPt->_coor_y, 2);
                 
-                // 更新最小距离和最近点
-                if (tempDis < _minDis)
+                // 更新最小距离和最近点; 距离相同时取序号小者, 结果不随集合遍历顺序变化
+                if (tempDis < _minDis || (tempDis == _minDis && _startPt &&
+                                          (pt->_index < _startPt->_index ||
+                                           (pt->_index == _startPt->_index && pt->_startType < _startPt->_startType))))
                 {
                     _minDis = tempDis;
                     _startPt = pt;
@@ -309,9 +311,9 @@ void SearchResult::calcNearestPt(Node *node)
     else // 内部节点
     {
         // 递归搜索所有子节点
-        for (const auto &item : qAsConst(node->_nodeMap))
+        for (const auto &item : node->_children)
         {
-            calcNearestPt(item.data());
+            calcNearestPt(item.get());
         }
     }
 }
@@ -400,7 +402,7 @@ bool NodeSearcher::findNearNode(SearchResult &searchedInfo)
         // 获取下一个要搜索的节点类型
         auto useNodeType = _nodeTypeList.takeLast();
         // 移动到对应的子节点
-        _node = _node->_nodeMap.value(useNodeType, QSharedPointer<Node>()).data();
+        _node = _node->child(useNodeType);
 
         // 搜索列表为空且当前节点有效时,计算最近点
         if ((_nodeTypeList.size() < 1) && _node && _node->_nodeCount)
@@ -579,13 +581,14 @@ bool NodeSearcher::findNearNode_root(Node *node, SearchResult &searchedInfo)
 bool NodeSearcher::findNearNode_root(Node *node, const int &direct, SearchResult &searchedInfo)
 {
     // 检查指定方向是否存在子节点
-    if (false == node->_nodeMap.contains(direct)) return false;
+    Node *childNode = node->child(direct);
+    if (nullptr == childNode) return false;
     
     // 检查子节点的节点计数
-    if (node->_nodeMap[direct]->_nodeCount < 1) return false;
+    if (childNode->_nodeCount < 1) return false;
 
     // 递归搜索子节点
-    findNearNode_root(node->_nodeMap[direct].data(), searchedInfo);
+    findNearNode_root(childNode, searchedInfo);
     
     return true;
 }
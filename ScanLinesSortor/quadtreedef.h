@@ -8,6 +8,7 @@
 #include <QSharedPointer>
 
 #include "bpccommon.h"
+#include "layerarena.h"
 
 #define POPO 0.01
 #define MaxDepths 16
@@ -50,7 +51,8 @@ struct Node {
     int _nodeCount = 0;
     int _nodeType = UL;
     Node *_parent;
-    QMap<int, QSharedPointer<Node>> _nodeMap;
+    // 四个象限子节点, 按 UL、UR、DL、DR 顺序存放; 独占所有权, 不再为每个节点分配引用计数控制块
+    ArenaUniquePtr<Node> _children[4];
 
     int _minX = 0;
     int _maxX = 0;
@@ -64,6 +66,13 @@ struct Node {
     virtual bool insertNode(const MPtInfoPtr &pt, const int &x0, const int &y0,
                             const int &width, const int &height);
     virtual bool removePt(const MPtInfoPtr &pt);
+
+    static inline int childIndex(const int &nodeType) {
+        return ((nodeType & DOWN) ? 2 : 0) + ((nodeType & RIGHT) ? 1 : 0);
+    }
+    inline Node *child(const int &nodeType) const {
+        return _children[childIndex(nodeType)].get();
+    }
 };
 
 struct EndNode : public Node {
@@ -109,12 +118,12 @@ struct NodeSearcher {
 
 struct MQuadTree {
     int _depths = MaxDepths;
-    QSharedPointer<Node> _root;
+    ArenaUniquePtr<Node> _root;
 
     MQuadTree(const int &depth = MaxDepths) {
         _depths = depth;
         if (_depths < 4) _depths = 4;
-        _root = QSharedPointer<Node>(new Node(nullptr, 0, UL));
+        _root = arenaMakeUnique<Node>(nullptr, 0, UL);
     }
     int getNodeCount() { return _root->_nodeCount; }
 
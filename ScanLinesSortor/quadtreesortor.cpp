@@ -44,11 +44,21 @@ struct QuadtreeSortor::Priv {
             startIndex = startIndex + curStep + 1;
         }
         /*/
+        // 端点坐标相对于所有端点的最小值, 平移后的相同路径落在相同的树节点中, 排序结果一致
+        cInt nOriginX = 0, nOriginY = 0;
+        bool bFirst = true;
+        for(const auto &path : paths) {
+            if(path.size() < 2) continue;
+            const cInt nMinX = qMin(path.front().X, path.back().X), nMinY = qMin(path.front().Y, path.back().Y);
+            nOriginX = bFirst ? nMinX : qMin(nOriginX, nMinX);
+            nOriginY = bFirst ? nMinY : qMin(nOriginY, nMinY);
+            bFirst = false;
+        }
         for(uint i = 0; i < paths.size(); ++ i) {
             auto &path = paths[i];
             if(path.size() < 2) continue;
-            auto pt1 = MPtInfoPtr(new MPtInfo(path.front().X, path.front().Y, i, 0));
-            auto pt2 = MPtInfoPtr(new MPtInfo(path.back().X, path.back().Y, i, 1));
+            auto pt1 = arenaCreate<MPtInfo>(int(path.front().X - nOriginX), int(path.front().Y - nOriginY), i, 0);
+            auto pt2 = arenaCreate<MPtInfo>(int(path.back().X - nOriginX), int(path.back().Y - nOriginY), i, 1);
             pt1->_bro = pt2;
             pt2->_bro = pt1;
             quadtree.insertNode(pt1);
@@ -59,8 +69,8 @@ struct QuadtreeSortor::Priv {
     void addTreeNode(MQuadTree &quadtree, const int &index1, const int &index2,
                      const IntPoint &pt1, const IntPoint &pt2, MPtInfoPtr &firstPt)
     {
-        auto ptPtr1 = MPtInfoPtr(new MPtInfo(pt1.X, pt1.Y, index1, 0));
-        auto ptPtr2 = MPtInfoPtr(new MPtInfo(pt2.X, pt2.Y, index2, 1));
+        auto ptPtr1 = arenaCreate<MPtInfo>(pt1.X, pt1.Y, index1, 0);
+        auto ptPtr2 = arenaCreate<MPtInfo>(pt2.X, pt2.Y, index2, 1);
         ptPtr1->_bro = ptPtr2;
         ptPtr2->_bro = ptPtr1;
         quadtree.insertNode(ptPtr1);
@@ -39,8 +39,8 @@ void QTreeSortor::sortDatas(QVector<T> &datas)
 
     for(uint i = 0; i < datas.size(); ++ i) {
         auto &data = datas[i];
-        auto pt1 = MPtInfoPtr(new MPtInfo(data._centerX, data._centerY, i, 0));
-        auto pt2 = MPtInfoPtr(new MPtInfo(data._centerX, data._centerY, i, 1));
+        auto pt1 = arenaCreate<MPtInfo>(data._centerX, data._centerY, i, 0);
+        auto pt2 = arenaCreate<MPtInfo>(data._centerX, data._centerY, i, 1);
         pt1->_bro = pt2;
         pt2->_bro = pt1;
         quadtree.insertNode(pt1);
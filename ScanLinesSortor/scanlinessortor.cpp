@@ -2,6 +2,7 @@
 #include "uspfiledef.h"
 #include "bpccommon.h"
 #include "meshinfo.h"
+#include "layerarena.h"
 
 #include <memory>
 #include <QVector>
@@ -182,9 +183,9 @@ struct ScanLinesSortor::Priv {
         double fStepX = (maxX - minX) * 0.02 / double(maxX - minX + 1);
         double fStepY = (maxY - minY) * 0.02 / double(maxY - minY + 1);
         
-        // 创建网格数组
+        // 创建网格数组, 网格索引列表处于层内存池作用域时从内存池分配
         auto totalMeshCnt = meshWid * meshHei;
-        QVector<int> *mesh = new QVector<int>[2 * totalMeshCnt];
+        std::vector<ArenaVector<int>> mesh(size_t(2 * totalMeshCnt));
 
         // int minX = 0;
         // int minY = 0;
@@ -211,7 +212,7 @@ struct ScanLinesSortor::Priv {
                 if(nX > (meshWid - 1)) nX = meshWid - 1;
                 if(nY < 0) nY = 0;
                 if(nY > (meshHei - 1)) nY = meshHei - 1;
-                mesh[nX + nY * meshWid] << iIndex;
+                mesh[nX + nY * meshWid].push_back(iIndex);
             }
             // 映射终点
             {
@@ -221,7 +222,7 @@ struct ScanLinesSortor::Priv {
                 if(nX > (meshWid - 1)) nX = meshWid - 1;
                 if(nY < 0) nY = 0;
                 if(nY > (meshHei - 1)) nY = meshHei - 1;
-                mesh[nX + nY * meshWid + totalMeshCnt] << iIndex;
+                mesh[nX + nY * meshWid + totalMeshCnt].push_back(iIndex);
             }
         }
 
@@ -229,8 +230,8 @@ struct ScanLinesSortor::Priv {
         auto maxCnt = 0;
         for (int i = 0; i < totalMeshCnt; ++ i) 
         {
-            if (mesh[i].size() > maxCnt) maxCnt = mesh[i].size();
-            if (mesh[i + totalMeshCnt].size() > maxCnt) maxCnt = mesh[i].size();
+            if (int(mesh[i].size()) > maxCnt) maxCnt = int(mesh[i].size());
+            if (int(mesh[i + totalMeshCnt].size()) > maxCnt) maxCnt = int(mesh[i].size());
         }
 
         // 定义网格坐标变量
@@ -402,8 +403,6 @@ struct ScanLinesSortor::Priv {
         funcReset(delta1 > delta2);
         funcUpdateMeshCoor(lpLine);
         funcLoop(true);
-
-        delete []mesh;
     }
 
     /**
@@ -525,12 +524,12 @@ struct ScanLinesSortor::Priv {
      */
     static void calcMinDisPos(const QVector<SortLineInfo> &srcVec, 
                             const QVector<int> &indexVec, 
-                            const QVector<int> &listIndex,
+                            const ArenaVector<int> &listIndex,
                             const bool &reversed, 
                             MatchedLineInfo &matchedInfo) 
     {
         // 网格为空直接返回
-        if(listIndex.size() < 1) return;
+        if(listIndex.empty()) return;
 
         double tempV = 0;
         
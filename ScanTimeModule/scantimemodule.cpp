@@ -0,0 +1,346 @@
+#include "scantimemodule.h"
+
+#include "bppbuildparameters.h"
+#include "publicheader.h"
+
+#include <QTextStream>
+#include <QFile>
+#include <QDebug>
+
+#include <climits>
+#include <cmath>
+
+using namespace ClipperLib;
+
+#define SCANTIME_US     1E-6
+
+ScanTimeModule::ScanTimeModule()
+{
+}
+
+///
+/// @brief 初始化扫描时间模型参数
+/// @param writeBuff [in] 写入缓冲区参数
+/// @details 实现步骤:
+///   1. 读取模型开关、跳转速度与各项延时
+///   2. 根据延时计算默认的矢量与跳转附加时间
+///   3. 读取系数覆盖值
+///   4. 指定了标定文件时, 使用标定结果覆盖系数
+///
+void ScanTimeModule::initializeParas(const WriterBufferParas *writeBuff)
+{
+    _writeBuff = writeBuff;
+    _enabled = 1 == writeBuff->getExtendedValue<int>("ScanTime/nUseScanTime", 0);
+    if (false == _enabled) return;
+
+    // 跳转速度与延时(us)
+    _jumpSpeed = qMax(1.0, writeBuff->getExtendedValue<double>("ScanTime/fJumpSpeed", 5000.0));
+    auto fJumpDelay = writeBuff->getExtendedValue<double>("ScanTime/fJumpDelay", 200.0);
+    auto fMarkDelay = writeBuff->getExtendedValue<double>("ScanTime/fMarkDelay", 100.0);
+    auto fPolygonDelay = writeBuff->getExtendedValue<double>("ScanTime/fPolygonDelay", 10.0);
+
+    _coefficient = ScanTimeCoefficient();
+    _coefficient._markFactor = writeBuff->getExtendedValue<double>("ScanTime/fMarkFactor", 1.0);
+    _coefficient._jumpFactor = writeBuff->getExtendedValue<double>("ScanTime/fJumpFactor", 1.0);
+    _coefficient._markOverhead = fPolygonDelay * SCANTIME_US;
+    _coefficient._jumpOverhead = (fJumpDelay + fMarkDelay) * SCANTIME_US;
+
+    // 标定文件
+    auto strCalibrationFile = writeBuff->getExtendedValue<QString>("ScanTime/strCalibrationFile", "");
+    if (strCalibrationFile.size()) calibrate(strCalibrationFile);
+}
+
+///
+/// @brief 使用实测扫描时间标定模型系数
+/// @param strFile [in] CSV文件路径
+/// @return 标定成功返回true
+/// @details 每行格式: markTime,jumpTime,markCnt,jumpCnt,measuredTime
+///   前四列为本模型输出的特征量, 最后一列为设备记录的实际扫描时间(秒),
+///   无法解析的行(如表头、#注释)直接跳过
+///
+bool ScanTimeModule::calibrate(const QString &strFile)
+{
+    QFile file(strFile);
+    if (false == file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qDebug() << "scan time calibration file open failed:" << strFile;
+        return false;
+    }
+
+    QVector<ScanTimeFeature> featureVec;
+    QVector<double> timeVec;
+    QTextStream stream(&file);
+    while (false == stream.atEnd())
+    {
+        auto strLine = stream.readLine().trimmed();
+        if (strLine.isEmpty() || strLine.startsWith('#')) continue;
+
+        auto strList = strLine.split(',');
+        if (strList.size() < 5) continue;
+
+        bool bOk = true;
+        double values[5];
+        for (int i = 0; i < 5 && bOk; ++ i) values[i] = strList.at(i).trimmed().toDouble(&bOk);
+        if (false == bOk) continue;
+
+        ScanTimeFeature feature;
+        feature._markTime = values[0];
+        feature._jumpTime = values[1];
+        feature._markCnt = values[2];
+        feature._jumpCnt = values[3];
+        featureVec << feature;
+        timeVec << values[4];
+    }
+
+    ScanTimeCoefficient coefficient;
+    if (false == fitCoefficient(featureVec, timeVec, coefficient))
+    {
+        qDebug() << "scan time calibration failed, samples:" << featureVec.size();
+        return false;
+    }
+
+    // 计算标定残差
+    _coefficient = coefficient;
+    double fSumError = 0.0, fSumTime = 0.0;
+    for (int i = 0; i < featureVec.size(); ++ i)
+    {
+        fSumError += std::abs(predict(featureVec[i]) - timeVec[i]);
+        fSumTime += timeVec[i];
+    }
+    qDebug() << "scan time calibration samples:" << featureVec.size()
+             << "markFactor" << _coefficient._markFactor << "jumpFactor" << _coefficient._jumpFactor
+             << "markOverhead" << _coefficient._markOverhead << "jumpOverhead" << _coefficient._jumpOverhead
+             << "mean error" << (fSumTime > 0 ? QString::number(100.0 * fSumError / fSumTime, 'f', 2) + "%" : "-");
+    return true;
+}
+
+///
+/// @brief 最小二乘拟合模型系数
+/// @param featureVec [in] 特征量
+/// @param timeVec [in] 实测时间
+/// @param coefficient [out] 拟合系数
+/// @return 样本不足或方程奇异时返回false
+/// @details 实现步骤:
+///   1. 构建 4x4 正规方程
+///   2. 列主元高斯消元求解
+///   3. 负系数无物理意义, 截断为0
+///
+bool ScanTimeModule::fitCoefficient(const QVector<ScanTimeFeature> &featureVec, const QVector<double> &timeVec,
+                                    ScanTimeCoefficient &coefficient)
+{
+    const int nSize = 4;
+    if (featureVec.size() < nSize || featureVec.size() != timeVec.size()) return false;
+
+    // 正规方程 [A^T A | A^T b]
+    double matrix[nSize][nSize + 1] = {};
+    for (int i = 0; i < featureVec.size(); ++ i)
+    {
+        const auto &feature = featureVec[i];
+        const double row[nSize] = { feature._markTime, feature._jumpTime, feature._markCnt, feature._jumpCnt };
+        for (int r = 0; r < nSize; ++ r)
+        {
+            for (int c = 0; c < nSize; ++ c) matrix[r][c] += row[r] * row[c];
+            matrix[r][nSize] += row[r] * timeVec[i];
+        }
+    }
+
+    // 列主元消元
+    for (int col = 0; col < nSize; ++ col)
+    {
+        int pivot = col;
+        for (int r = col + 1; r < nSize; ++ r)
+        {
+            if (std::abs(matrix[r][col]) > std::abs(matrix[pivot][col])) pivot = r;
+        }
+        if (std::abs(matrix[pivot][col]) < 1E-12) return false;
+        if (pivot != col) std::swap(matrix[pivot], matrix[col]);
+
+        for (int r = 0; r < nSize; ++ r)
+        {
+            if (r == col) continue;
+            double factor = matrix[r][col] / matrix[col][col];
+            for (int c = col; c <= nSize; ++ c) matrix[r][c] -= factor * matrix[col][c];
+        }
+    }
+
+    coefficient._markFactor = qMax(0.0, matrix[0][nSize] / matrix[0][0]);
+    coefficient._jumpFactor = qMax(0.0, matrix[1][nSize] / matrix[1][1]);
+    coefficient._markOverhead = qMax(0.0, matrix[2][nSize] / matrix[2][2]);
+    coefficient._jumpOverhead = qMax(0.0, matrix[3][nSize] / matrix[3][3]);
+    return true;
+}
+
+double ScanTimeModule::predict(const ScanTimeFeature &feature) const
+{
+    return feature._markTime * _coefficient._markFactor + feature._jumpTime * _coefficient._jumpFactor +
+           feature._markCnt * _coefficient._markOverhead + feature._jumpCnt * _coefficient._jumpOverhead;
+}
+
+void ScanTimeModule::addJump(const IntPoint &pt, ScanTimeFeature &feature, ScanTimeCursor &cursor) const
+{
+    if (cursor._begining) cursor._begining = false;
+    else
+    {
+        feature._jumpTime += std::hypot(double(pt.X - cursor._lastX), double(pt.Y - cursor._lastY)) /
+                             FILEDATAUNIT / _jumpSpeed;
+    }
+    feature._jumpCnt += 1;
+}
+
+///
+/// @brief 累加开放路径(支撑线)的扫描特征
+/// @param paths [in] 路径
+/// @param fMarkSpeed [in] 标记速度(mm/s)
+/// @param feature [in,out] 特征量
+/// @param cursor [in,out] 末点状态
+///
+void ScanTimeModule::addPolylines(const Paths &paths, const double &fMarkSpeed,
+                                  ScanTimeFeature &feature, ScanTimeCursor &cursor) const
+{
+    if (fMarkSpeed <= 0) return;
+    for (const auto &path : paths)
+    {
+        if (path.size() < 2) continue;
+        addJump(path.front(), feature, cursor);
+
+        double fLength = 0.0;
+        for (size_t i = 1; i < path.size(); ++ i)
+        {
+            fLength += std::hypot(double(path[i].X - path[i - 1].X), double(path[i].Y - path[i - 1].Y));
+        }
+        feature._markTime += fLength / FILEDATAUNIT / fMarkSpeed;
+        feature._markCnt += path.size() - 1;
+        cursor._lastX = path.back().X;
+        cursor._lastY = path.back().Y;
+    }
+}
+
+///
+/// @brief 累加闭合路径(轮廓)的扫描特征
+/// @param paths [in] 路径
+/// @param fMarkSpeed [in] 标记速度(mm/s)
+/// @param feature [in,out] 特征量
+/// @param cursor [in,out] 末点状态
+///
+void ScanTimeModule::addPolygons(const Paths &paths, const double &fMarkSpeed,
+                                 ScanTimeFeature &feature, ScanTimeCursor &cursor) const
+{
+    if (fMarkSpeed <= 0) return;
+    for (const auto &path : paths)
+    {
+        if (path.size() < 2) continue;
+        addJump(path.front(), feature, cursor);
+
+        double fLength = 0.0;
+        size_t prev = path.size() - 1;
+        for (size_t i = 0; i < path.size(); ++ i)
+        {
+            fLength += std::hypot(double(path[i].X - path[prev].X), double(path[i].Y - path[prev].Y));
+            prev = i;
+        }
+        feature._markTime += fLength / FILEDATAUNIT / fMarkSpeed;
+        feature._markCnt += path.size();
+        cursor._lastX = path.front().X;
+        cursor._lastY = path.front().Y;
+    }
+}
+
+///
+/// @brief 按面积估算填充线的扫描特征
+/// @param paths [in] 填充区域
+/// @param fLineSpacing [in] 线间距(mm)
+/// @param fMarkSpeed [in] 标记速度(mm/s)
+/// @param nPass [in] 扫描遍数(交叉填充为2)
+/// @param feature [in,out] 特征量
+/// @details 填充线总长取 面积/线距, 线数取包围盒平均边长/线距,
+///   相邻填充线之间按一个线距的跳转计算
+///
+void ScanTimeModule::addHatching(const Paths &paths, const double &fLineSpacing, const double &fMarkSpeed,
+                                 const int &nPass, ScanTimeFeature &feature) const
+{
+    if (fLineSpacing <= 0 || fMarkSpeed <= 0 || paths.empty()) return;
+
+    double fArea = 0.0;
+    cInt minX = LLONG_MAX, minY = LLONG_MAX, maxX = LLONG_MIN, maxY = LLONG_MIN;
+    for (const auto &path : paths)
+    {
+        fArea += Area(path);
+        for (const auto &pt : path)
+        {
+            minX = qMin(minX, pt.X);
+            minY = qMin(minY, pt.Y);
+            maxX = qMax(maxX, pt.X);
+            maxY = qMax(maxY, pt.Y);
+        }
+    }
+    if (minX > maxX) return;
+
+    fArea = std::abs(fArea) * AREAFACTOR;
+    double fSpan = (double(maxX - minX) + double(maxY - minY)) * 0.5 / FILEDATAUNIT;
+    double fLineCnt = qMax(1.0, fSpan / fLineSpacing);
+
+    feature._markTime += fArea / fLineSpacing / fMarkSpeed * nPass;
+    feature._markCnt += fLineCnt * nPass;
+    feature._jumpTime += fLineCnt * fLineSpacing / _jumpSpeed * nPass;
+    feature._jumpCnt += fLineCnt * nPass;
+}
+
+///
+/// @brief 计算同一振镜上多个零件轮廓的扫描时间
+/// @param pathsVec [in] 各零件当前层轮廓
+/// @return 预测时间(秒)
+///
+double ScanTimeModule::calcBorderTime(const QVector<const Paths *> &pathsVec) const
+{
+    const auto &borderPara = _writeBuff->_bppParaPtr->sBorderPara;
+    ScanTimeFeature feature;
+    for (int i = 0; i < borderPara.nNumber; ++ i)
+    {
+        ScanTimeCursor cursor;
+        for (const auto &paths : pathsVec) addPolygons(*paths, borderPara.nMarkSpeed[i], feature, cursor);
+    }
+    return predict(feature);
+}
+
+double ScanTimeModule::calcSupportTime(const Paths &paths) const
+{
+    ScanTimeFeature feature;
+    ScanTimeCursor cursor;
+    addPolylines(paths, _writeBuff->_bppParaPtr->sSupportPara.nMarkSpeed, feature, cursor);
+    return predict(feature);
+}
+
+double ScanTimeModule::calcHatchingTime(const Paths &paths) const
+{
+    const auto &hatchingPara = _writeBuff->_bppParaPtr->sHatchingPara;
+    ScanTimeFeature feature;
+    addHatching(paths, hatchingPara.fLineSpacing[0], hatchingPara.nMarkSpeed[0], 1, feature);
+    return predict(feature);
+}
+
+///
+/// @brief 表面填充扫描遍数, 交叉填充扫描两遍
+///
+int ScanTimeModule::surfacePassCount(const int &nHatchType)
+{
+    return SURFACEHATCH_CROSS == nHatchType ? 2 : 1;
+}
+
+double ScanTimeModule::calcUpfaceTime(const Paths &paths, const int &up_index) const
+{
+    const auto &upPara = _writeBuff->_bppParaPtr->sSurfacePara_Up;
+    ScanTimeFeature feature;
+    addHatching(paths, upPara.fLineSpacing[up_index], upPara.nMarkSpeed[up_index],
+                surfacePassCount(upPara.nHatchingType[up_index]), feature);
+    return predict(feature);
+}
+
+double ScanTimeModule::calcDownfaceTime(const Paths &paths, const int &down_index) const
+{
+    // 下表面填充类型沿用上表面参数, 与原权重计算一致
+    const auto &dwPara = _writeBuff->_bppParaPtr->sSurfacePara_Dw;
+    ScanTimeFeature feature;
+    addHatching(paths, dwPara.fLineSpacing[down_index], dwPara.nMarkSpeed[down_index],
+                surfacePassCount(_writeBuff->_bppParaPtr->sSurfacePara_Up.nHatchingType[down_index]), feature);
+    return predict(feature);
+}
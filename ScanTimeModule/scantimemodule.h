@@ -0,0 +1,80 @@
+#ifndef SCANTIMEMODULE_H
+#define SCANTIMEMODULE_H
+
+#include "Clipper/clipper.hpp"
+
+#include <QVector>
+#include <QString>
+
+struct WriterBufferParas;
+
+// 扫描时间特征量, 单位: 秒/条
+struct ScanTimeFeature {
+    double _markTime = 0.0;     // 标记长度 / 标记速度
+    double _jumpTime = 0.0;     // 跳转长度 / 跳转速度
+    double _markCnt = 0.0;      // 标记矢量数
+    double _jumpCnt = 0.0;      // 跳转次数
+
+    inline ScanTimeFeature &operator+=(const ScanTimeFeature &other) {
+        _markTime += other._markTime;
+        _jumpTime += other._jumpTime;
+        _markCnt += other._markCnt;
+        _jumpCnt += other._jumpCnt;
+        return *this;
+    }
+};
+
+// 扫描时间模型系数: time = markTime * k0 + jumpTime * k1 + markCnt * k2 + jumpCnt * k3
+struct ScanTimeCoefficient {
+    double _markFactor = 1.0;
+    double _jumpFactor = 1.0;
+    double _markOverhead = 0.0;     // 每条标记矢量附加时间(秒)
+    double _jumpOverhead = 0.0;     // 每次跳转附加时间(秒)
+};
+
+// 路径连续扫描时的末点状态, 用于计算跨路径跳转
+struct ScanTimeCursor {
+    bool _begining = true;
+    ClipperLib::cInt _lastX = 0;
+    ClipperLib::cInt _lastY = 0;
+};
+
+class ScanTimeModule
+{
+public:
+    ScanTimeModule();
+
+    void initializeParas(const WriterBufferParas *);
+    bool calibrate(const QString &);
+    static bool fitCoefficient(const QVector<ScanTimeFeature> &, const QVector<double> &, ScanTimeCoefficient &);
+
+    inline bool isEnabled() const { return _enabled; }
+    inline const ScanTimeCoefficient &coefficient() const { return _coefficient; }
+    inline void setCoefficient(const ScanTimeCoefficient &coefficient) { _coefficient = coefficient; }
+    inline double jumpSpeed() const { return _jumpSpeed; }
+    inline void setJumpSpeed(const double &jumpSpeed) { _jumpSpeed = qMax(1.0, jumpSpeed); }
+    double predict(const ScanTimeFeature &) const;
+
+    void addPolylines(const ClipperLib::Paths &, const double &, ScanTimeFeature &, ScanTimeCursor &) const;
+    void addPolygons(const ClipperLib::Paths &, const double &, ScanTimeFeature &, ScanTimeCursor &) const;
+    void addHatching(const ClipperLib::Paths &, const double &, const double &, const int &, ScanTimeFeature &) const;
+
+    double calcBorderTime(const QVector<const ClipperLib::Paths *> &) const;
+    double calcSupportTime(const ClipperLib::Paths &) const;
+    double calcHatchingTime(const ClipperLib::Paths &) const;
+    double calcUpfaceTime(const ClipperLib::Paths &, const int &) const;
+    double calcDownfaceTime(const ClipperLib::Paths &, const int &) const;
+
+    static int surfacePassCount(const int &);
+
+private:
+    void addJump(const ClipperLib::IntPoint &, ScanTimeFeature &, ScanTimeCursor &) const;
+
+private:
+    const WriterBufferParas *_writeBuff = nullptr;
+    bool _enabled = false;
+    double _jumpSpeed = 5000.0;     // mm/s
+    ScanTimeCoefficient _coefficient;
+};
+
+#endif // SCANTIMEMODULE_H
@@ -9,6 +9,82 @@
 // #include "clipperinterface.h"
 #include "clipper2/clipper.rectclip.h"
 
+#include <cmath>
+#include <vector>
+
+namespace {
+// 数据包围盒与分区矩形的关系
+enum RectRelation {
+    RR_Outside = 0,     // 不相交, 跳过
+    RR_Inside,          // 完全位于分区内, 不裁剪直接输出
+    RR_Cross            // 跨越分区边界, 需裁剪
+};
+
+inline IntRect calcPathsBounds(const Paths &paths)
+{
+    IntRect bounds;
+    bounds.left = bounds.top = bounds.right = bounds.bottom = 0;
+    bool first = true;
+    for(const auto &path : paths)
+    {
+        for(const auto &pt : path)
+        {
+            if(first)
+            {
+                bounds.left = bounds.right = pt.X;
+                bounds.top = bounds.bottom = pt.Y;
+                first = false;
+                continue;
+            }
+            if(pt.X < bounds.left) bounds.left = pt.X;
+            else if(pt.X > bounds.right) bounds.right = pt.X;
+            if(pt.Y < bounds.top) bounds.top = pt.Y;
+            else if(pt.Y > bounds.bottom) bounds.bottom = pt.Y;
+        }
+    }
+    return bounds;
+}
+
+inline RectRelation calcRectRelation(const IntRect &bounds, const IntRect &rect)
+{
+    if(bounds.right < rect.left || bounds.left > rect.right ||
+        bounds.bottom < rect.top || bounds.top > rect.bottom) return RR_Outside;
+    if(bounds.left >= rect.left && bounds.right <= rect.right &&
+        bounds.top >= rect.top && bounds.bottom <= rect.bottom) return RR_Inside;
+    return RR_Cross;
+}
+
+///
+/// @brief 分区轮廓是否为与坐标轴对齐的矩形, 是则可用 RectClip64 代替通用求交
+///
+inline bool isAxisAlignedRect(const Paths &field, const IntRect &rect)
+{
+    if(1 != field.size() || 4 != field.front().size()) return false;
+    for(const auto &pt : field.front())
+    {
+        if((pt.X != rect.left && pt.X != rect.right) || (pt.Y != rect.top && pt.Y != rect.bottom)) return false;
+    }
+    return std::fabs(Area(field.front())) == double(rect.right - rect.left) * double(rect.bottom - rect.top);
+}
+
+inline Clipper2Lib::Rect64 toRect64(const IntRect &rect)
+{
+    return Clipper2Lib::Rect64(rect.left, rect.top, rect.right, rect.bottom);
+}
+
+///
+/// @brief 闭合多边形按分区矩形裁剪
+/// @details 与 getUnionPaths 的求交结果一致, 裁剪后同样清理微小缺陷
+///
+inline void rectClipPolygons(const IntRect &rect, const Paths &paths, Paths &sol)
+{
+    Clipper2Lib::RectClip64 rectClipper(toRect64(rect));
+    auto tempSol = rectClipper.Execute(*(reinterpret_cast<const Clipper2Lib::Paths64 *>(&paths)));
+    sol = std::move(*(reinterpret_cast<Paths *>(&tempSol)));
+    CleanPolygons(sol, MINDISTANCE);
+}
+}
+
 SLMSplicingModule::SLMSplicingModule() :
     d(new SLMSplicingModulePriv)
 {
@@ -25,6 +101,7 @@ void SLMSplicingModule::initializeParas(const WriterBufferParas *writeBuff)
 
     scanFiledMap.clear();
     coincideFieldVec.clear();
+    d->_rectClipSplit = writeBuff->getExtendedValue<int>("Splicing/nRectClipSplit", 1);
 
     const auto keys = bpcParas->rcScanFieldMap.keys();
     for(const auto &key : keys)
@@ -314,102 +391,55 @@ void SLMSplicingModule::recalcSplicingArea(Paths &solidPaths, QList<AREAINFOPTR>
         splicingPtr->calcNextPos();
     }
 
-    layerSplicing.splicingAreaMap_support.clear();
-
-    const auto keys = d->_scannerSplicing->scanFiledMap.keys();
-    for(const auto &key : keys)
-    {
-        const auto &scanFiled = d->_scannerSplicing->scanFiledMap[key];
-        const auto splicingKeys = scanFiled.splicingMap.keys();
-
-        auto splicingArea =  new SplicingAreaInfo();
-
-        if(splicingKeys.contains(SplicingAbstract::RT_Left))
-        {
-            const auto &splicingLine = scanFiled.splicingMap[SplicingAbstract::RT_Left];
-            splicingArea->rectField.left = splicingLine->getSplicingPos() - splicingLine->getOverlap();
-        }
-        else splicingArea->rectField.left = scanFiled.scanRc.left;
-
-        if(splicingKeys.contains(SplicingAbstract::RT_Right))
-        {
-            const auto &splicingLine = scanFiled.splicingMap[SplicingAbstract::RT_Right];
-            splicingArea->rectField.right = splicingLine->getSplicingPos() + splicingLine->getOverlap();
-        }
-        else splicingArea->rectField.right = scanFiled.scanRc.right;
-
-        if(splicingKeys.contains(SplicingAbstract::RT_Top))
-        {
-            const auto &splicingLine = scanFiled.splicingMap[SplicingAbstract::RT_Top];
-            splicingArea->rectField.top = splicingLine->getSplicingPos() - splicingLine->getOverlap();
-        }
-        else splicingArea->rectField.top = scanFiled.scanRc.top;
+    std::vector<int64_t> posVec;
+    d->currentLinePos(posVec);
+    d->createLayerSplicing(posVec, layerSplicing);
+}
 
-        if(splicingKeys.contains(SplicingAbstract::RT_Bottom))
-        {
-            const auto &splicingLine = scanFiled.splicingMap[SplicingAbstract::RT_Bottom];
-            splicingArea->rectField.bottom = splicingLine->getSplicingPos() + splicingLine->getOverlap();
-        }
-        else splicingArea->rectField.bottom = scanFiled.scanRc.bottom;
+///
+/// @brief 初始化拼接表
+/// @param minLayer [in] 最小层号
+/// @param maxLayer [in] 最大层号
+/// @details 清空已记录的拼接线位置及已生成的分区, 按层范围预留行索引
+///
+void SLMSplicingModule::initSplicingTable(const int &minLayer, const int &maxLayer)
+{
+    d->_minLayer = minLayer;
+    d->_rowIndexVec.assign(size_t(qMax(0, maxLayer - minLayer + 1)), -1);
+    d->_linePosVec.clear();
 
-        splicingArea->scannerIndex = key;
-        splicingArea->layerScanField.clear();
-        splicingArea->layerScanField << splicingArea->rectField.AsPath();
-        layerSplicing.splicingAreaMap_support.insert(key, SplicingAreaPtr(splicingArea));
-    }
+    QMutexLocker locker(&d->_cacheLocker);
+    d->_layerSplicingCache.clear();
 }
 
+///
+/// @brief 记录一层的拼接线位置
+/// @param layerHei [in] 层号, 需按层号递增调用以保证拼接线位置序列与逐层计算一致
+///
 void SLMSplicingModule::addLayerSplicingArea(const int &layerHei)
 {
-    LayerSplicingArea layerSplicing;
-    for(auto &splicingPtr : qAsConst(d->_scannerSplicing->splicingPtrVec))
+    const auto &splicingPtrVec = d->_scannerSplicing->splicingPtrVec;
+    for(auto &splicingPtr : qAsConst(splicingPtrVec))
     {
         splicingPtr->calcNextPos();
     }
 
-    layerSplicing.splicingAreaMap_support.clear();
-    const auto keys = d->_scannerSplicing->scanFiledMap.keys();
-    for(const auto &key : keys)
+    // 层号超出预留范围时扩展行索引
+    if(d->_rowIndexVec.empty()) d->_minLayer = layerHei;
+    if(layerHei < d->_minLayer)
     {
-        const auto &scanFiled = d->_scannerSplicing->scanFiledMap[key];
-        const auto splicingKeys = scanFiled.splicingMap.keys();
-
-        auto splicingArea =  new SplicingAreaInfo();
-
-        if(splicingKeys.contains(SplicingAbstract::RT_Left))
-        {
-            const auto &splicingLine = scanFiled.splicingMap[SplicingAbstract::RT_Left];
-            splicingArea->rectField.left = splicingLine->getSplicingPos() - splicingLine->getOverlap();
-        }
-        else splicingArea->rectField.left = scanFiled.scanRc.left;
-
-        if(splicingKeys.contains(SplicingAbstract::RT_Right))
-        {
-            const auto &splicingLine = scanFiled.splicingMap[SplicingAbstract::RT_Right];
-            splicingArea->rectField.right = splicingLine->getSplicingPos() + splicingLine->getOverlap();
-        }
-        else splicingArea->rectField.right = scanFiled.scanRc.right;
-
-        if(splicingKeys.contains(SplicingAbstract::RT_Top))
-        {
-            const auto &splicingLine = scanFiled.splicingMap[SplicingAbstract::RT_Top];
-            splicingArea->rectField.top = splicingLine->getSplicingPos() - splicingLine->getOverlap();
-        }
-        else splicingArea->rectField.top = scanFiled.scanRc.top;
-
-        if(splicingKeys.contains(SplicingAbstract::RT_Bottom))
-        {
-            const auto &splicingLine = scanFiled.splicingMap[SplicingAbstract::RT_Bottom];
-            splicingArea->rectField.bottom = splicingLine->getSplicingPos() + splicingLine->getOverlap();
-        }
-        else splicingArea->rectField.bottom = scanFiled.scanRc.bottom;
+        d->_rowIndexVec.insert(d->_rowIndexVec.begin(), size_t(d->_minLayer - layerHei), -1);
+        d->_minLayer = layerHei;
+    }
+    const auto offset = size_t(layerHei - d->_minLayer);
+    if(offset >= d->_rowIndexVec.size()) d->_rowIndexVec.resize(offset + 1, -1);
 
-        splicingArea->scannerIndex = key;
-        splicingArea->layerScanField.clear();
-        splicingArea->layerScanField.push_back(splicingArea->rectField.AsPath());
-        layerSplicing.splicingAreaMap_support.insert(key, SplicingAreaPtr(splicingArea));
+    d->_rowIndexVec[offset] = int(d->_linePosVec.size() / qMax(1, splicingPtrVec.size()));
+    for(const auto &splicingPtr : splicingPtrVec)
+    {
+        d->_linePosVec.push_back(splicingPtr->getSplicingPos());
     }
-    d->_layerSplicingMap.insert(layerHei, layerSplicing);
+    if(splicingPtrVec.isEmpty()) d->_linePosVec.push_back(0);
 }
 
 inline QSharedPointer<ScannerSplicingArea> SLMSplicingModule::getSplicingArea() const
@@ -417,76 +447,173 @@ inline QSharedPointer<ScannerSplicingArea> SLMSplicingModule::getSplicingArea()
     return d->_scannerSplicing;
 }
 
-LayerSplicingArea SLMSplicingModule::getLayerSplicing(const int &layerHei) const
+///
+/// @brief 获取一层的振镜分区
+/// @param layerHei [in] 层号
+/// @return 分区信息的常引用, 在下次 initSplicingTable 前始终有效
+/// @details 由拼接表查得各拼接线位置, 相同位置组合的层共用同一份分区
+///
+const LayerSplicingArea &SLMSplicingModule::getLayerSplicing(const int &layerHei) const
 {
-    if(d->_layerSplicingMap.contains(layerHei)) return d->_layerSplicingMap[layerHei];
-    return LayerSplicingArea();
+    const auto offset = layerHei - d->_minLayer;
+    if(offset < 0 || offset >= int(d->_rowIndexVec.size()) || d->_rowIndexVec[offset] < 0) return d->_emptySplicing;
+
+    const auto lineCnt = size_t(qMax(1, d->_scannerSplicing->splicingPtrVec.size()));
+    const auto begin = d->_linePosVec.cbegin() + size_t(d->_rowIndexVec[offset]) * lineCnt;
+    std::vector<int64_t> posVec(begin, begin + lineCnt);
+
+    QMutexLocker locker(&d->_cacheLocker);
+    auto &layerSplicing = d->_layerSplicingCache[posVec];
+    if(nullptr == layerSplicing)
+    {
+        layerSplicing = QSharedPointer<LayerSplicingArea>(new LayerSplicingArea);
+        d->createLayerSplicing(posVec, *layerSplicing);
+    }
+    return *layerSplicing;
 }
 
+///
+/// @brief 支撑数据按振镜分区拆分
+/// @param layerSplicing [in] 当前层分区
+/// @param supportPahts [in] 支撑线段
+/// @param funcSplit [in] 各分区结果的回调, 按振镜序号依次调用
+/// @details 实现步骤:
+///   1. 计算一次数据包围盒, 与各分区矩形比较: 不相交跳过, 完全在内直接输出
+///   2. 其余分区用 RectClipLines64 裁剪, 各振镜并行计算
+///   3. 按振镜序号串行回调, 回调内的写入不需要加锁
+///
 void SLMSplicingModule::splitSupportData(const LayerSplicingArea &layerSplicing, const Paths &supportPahts, FuncSplit &&funcSplit) const
 {
+    if(supportPahts.empty()) return;
+
     const auto keys = layerSplicing.splicingAreaMap_support.keys();
-    for(const auto &key : keys)
+    const auto bounds = calcPathsBounds(supportPahts);
+    const auto &paths = *(reinterpret_cast<const Clipper2Lib::Paths64 *>(&supportPahts));
+
+    std::vector<Paths> solVec(keys.size());
+    std::vector<char> insideVec(keys.size(), 0);
+#pragma omp parallel for if(keys.size() > 1)
+    for(int i = 0; i < keys.size(); ++ i)
+    {
+        const IntRect &rect = layerSplicing.splicingAreaMap_support.value(keys[i])->rectField;
+        switch(calcRectRelation(bounds, rect))
+        {
+        case RR_Outside: break;
+        case RR_Inside: insideVec[i] = 1; break;
+        case RR_Cross:
+        default:
+        {
+            Clipper2Lib::RectClipLines64 rectClipper(toRect64(rect));
+            auto tempSol = rectClipper.Execute(paths);
+            solVec[i] = std::move(*(reinterpret_cast<Paths *>(&tempSol)));
+            break;
+        }
+        }
+    }
+
+    for(int i = 0; i < keys.size(); ++ i)
     {
-        const Clipper2Lib::Paths64 paths = *(reinterpret_cast<const Clipper2Lib::Paths64 *>(&supportPahts));
-        Clipper2Lib::Rect<int64_t> rect(layerSplicing.splicingAreaMap_support[key]->rectField.left,
-                                        layerSplicing.splicingAreaMap_support[key]->rectField.top,
-                                        layerSplicing.splicingAreaMap_support[key]->rectField.right,
-                                        layerSplicing.splicingAreaMap_support[key]->rectField.bottom);
-        Clipper2Lib::RectClipLines64 rectClipper(rect);
-        auto tempSol = rectClipper.Execute(paths);
-        Paths sol_1 = *(reinterpret_cast<Paths *>(&tempSol));
-        if(sol_1.size()) funcSplit(key, sol_1);
+        if(insideVec[i]) funcSplit(keys[i], supportPahts);
+        else if(solVec[i].size()) funcSplit(keys[i], solVec[i]);
     }
 }
 
+///
+/// @brief 轮廓数据按振镜分区拆分
+/// @param closeBorder [in] 为 false 时去除分区边界上的裁剪边, 并补回原轮廓中恰好落在边界上的线段
+/// @param newBegin [in] 裁剪后重新选择起点
+/// @details 各振镜的裁剪并行计算; newBegin 与 funcSplit 回调到调用方, 按振镜序号串行执行.
+///   分区为轴对齐矩形时以 RectClip64 代替通用布尔求交, 完全位于分区内的轮廓不再裁剪;
+///   Splicing/nRectClipSplit 设为 0 时全部退回通用求交
+///
 void SLMSplicingModule::splitBorderData(const LayerSplicingArea &layerSplicing, const Paths &paths,
                                         FuncSplit &&funcSplit, const bool &closeBorder,
                                         const std::function<void(Paths &)> &&newBegin) const
 {
-    AlgorithmBase algorith;
-    auto keys = layerSplicing.splicingAreaMap_support.keys();
-    for(const auto &key : keys)
+    if(paths.empty()) return;
+
+    const auto keys = layerSplicing.splicingAreaMap_support.keys();
+    const auto bounds = calcPathsBounds(paths);
+    const bool rectClipSplit = d->_rectClipSplit;
+
+    std::vector<Paths> solVec(keys.size());
+    std::vector<Paths> onRectLineVec(keys.size());
+#pragma omp parallel for if(keys.size() > 1)
+    for(int i = 0; i < keys.size(); ++ i)
     {
-        auto &splicingArea = layerSplicing.splicingAreaMap_support[key];
+        const auto &splicingArea = layerSplicing.splicingAreaMap_support.value(keys[i]);
+        const IntRect &rect = splicingArea->rectField;
+        if(false == closeBorder) d->calcLinesOnRect(rect, paths, onRectLineVec[i]);
 
-        Paths sol;
-        if (closeBorder)
+        if(rectClipSplit && isAxisAlignedRect(splicingArea->layerScanField, rect))
         {
-            algorith.getUnionPaths(&paths, &splicingArea->layerScanField, sol, 0);
-            // intersectPaths(*(reinterpret_cast<const Clipper2Lib::Paths64 *>(&paths)),
-            //                *(reinterpret_cast<const Clipper2Lib::Paths64 *>(&splicingArea->layerScanField)),
-            //                *(reinterpret_cast<Clipper2Lib::Paths64 *>(&sol)));
-            newBegin(sol);
+            switch(calcRectRelation(bounds, rect))
+            {
+            case RR_Outside: break;
+            case RR_Inside: solVec[i] = paths; break;
+            case RR_Cross:
+            default: rectClipPolygons(rect, paths, solVec[i]); break;
+            }
         }
         else
         {
-            const IntRect &rect = splicingArea->rectField;
-            Paths onRectLineVec;
-            d->calcLinesOnRect(rect, paths, onRectLineVec);
-
-            algorith.getUnionPaths(&paths, &splicingArea->layerScanField, sol, 0);
-            // intersectPaths(*(reinterpret_cast<const Clipper2Lib::Paths64 *>(&paths)),
-            //                *(reinterpret_cast<const Clipper2Lib::Paths64 *>(&splicingArea->layerScanField)),
-            //                *(reinterpret_cast<Clipper2Lib::Paths64 *>(&sol)));
-            newBegin(sol);
-            d->removeLineOnRect(rect, sol);
-            sol << onRectLineVec;
+            AlgorithmBase algorith;
+            algorith.getUnionPaths(&paths, &splicingArea->layerScanField, solVec[i], 0);
         }
+    }
 
-        if(sol.size()) funcSplit(key, sol);
+    for(int i = 0; i < keys.size(); ++ i)
+    {
+        auto &sol = solVec[i];
+        newBegin(sol);
+        if(false == closeBorder)
+        {
+            d->removeLineOnRect(layerSplicing.splicingAreaMap_support.value(keys[i])->rectField, sol);
+            sol << onRectLineVec[i];
+        }
+
+        if(sol.size()) funcSplit(keys[i], sol);
     }
 }
 
+///
+/// @brief 实体数据按振镜分区拆分
+/// @details 同 splitBorderData, 各振镜并行裁剪后按振镜序号串行回调
+///
 void SLMSplicingModule::splitSolidData(const LayerSplicingArea &layerSplicing, const Paths &paths, FuncSplit &&funcSplit) const
 {
-    AlgorithmBase algorith;
-    auto keys = layerSplicing.splicingAreaMap_support.keys();
-    for(const auto &key : keys)
+    if(paths.empty()) return;
+
+    const auto keys = layerSplicing.splicingAreaMap_support.keys();
+    const auto bounds = calcPathsBounds(paths);
+    const bool rectClipSplit = d->_rectClipSplit;
+
+    std::vector<Paths> solVec(keys.size());
+    std::vector<char> insideVec(keys.size(), 0);
+#pragma omp parallel for if(keys.size() > 1)
+    for(int i = 0; i < keys.size(); ++ i)
+    {
+        const auto &splicingArea = layerSplicing.splicingAreaMap_support.value(keys[i]);
+        if(rectClipSplit && isAxisAlignedRect(splicingArea->layerScanField, splicingArea->rectField))
+        {
+            switch(calcRectRelation(bounds, splicingArea->rectField))
+            {
+            case RR_Outside: break;
+            case RR_Inside: insideVec[i] = 1; break;
+            case RR_Cross:
+            default: rectClipPolygons(splicingArea->rectField, paths, solVec[i]); break;
+            }
+        }
+        else
+        {
+            AlgorithmBase algorith;
+            algorith.getUnionPaths(&paths, &splicingArea->layerScanField, solVec[i], 0);
+        }
+    }
+
+    for(int i = 0; i < keys.size(); ++ i)
     {
-        auto &splicingArea = layerSplicing.splicingAreaMap_support[key];
-        Paths sol;
-        algorith.getUnionPaths(&paths, &splicingArea->layerScanField, sol, 0);
-        if(sol.size()) funcSplit(key, sol);
+        if(insideVec[i]) funcSplit(keys[i], paths);
+        else if(solVec[i].size()) funcSplit(keys[i], solVec[i]);
     }
 }
@@ -31,6 +31,7 @@ public:
     void calcScannerArea();
 
     void recalcSplicingArea(Paths &, QList<AREAINFOPTR> &, const QList<AREAINFOPTR> &solidPaths = QList<AREAINFOPTR>());
+    void initSplicingTable(const int &, const int &);
     void addLayerSplicingArea(const int &);
 
     void splitSupportData(const LayerSplicingArea &, const Paths &, FuncSplit &&) const;
@@ -39,7 +40,7 @@ public:
     void splitSolidData(const LayerSplicingArea &, const Paths &, FuncSplit &&) const;
 
     inline QSharedPointer<ScannerSplicingArea> getSplicingArea() const;
-    LayerSplicingArea getLayerSplicing(const int &) const;
+    const LayerSplicingArea &getLayerSplicing(const int &) const;
 
 private:
     QSharedPointer<SLMSplicingModulePriv> d = nullptr;
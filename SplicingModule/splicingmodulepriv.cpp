@@ -10,6 +10,66 @@ SLMSplicingModulePriv::SLMSplicingModulePriv() :
 {
 }
 
+void SLMSplicingModulePriv::currentLinePos(std::vector<int64_t> &posVec) const
+{
+    const auto &splicingPtrVec = _scannerSplicing->splicingPtrVec;
+    posVec.resize(splicingPtrVec.size());
+    for(int i = 0; i < splicingPtrVec.size(); ++ i)
+    {
+        posVec[i] = splicingPtrVec[i]->getSplicingPos();
+    }
+}
+
+///
+/// @brief 由拼接线位置生成各振镜分区
+/// @param posVec [in] 各拼接线位置, 顺序与 splicingPtrVec 一致
+/// @param layerSplicing [out] 分区信息
+/// @details 有拼接线的一侧取 拼接线位置 ± 搭接量, 其余取振镜范围
+///
+void SLMSplicingModulePriv::createLayerSplicing(const std::vector<int64_t> &posVec, LayerSplicingArea &layerSplicing) const
+{
+    const auto &splicingPtrVec = _scannerSplicing->splicingPtrVec;
+    auto funcSplicingPos = [&](const QSharedPointer<SplicingAbstract> &splicingLine) -> int64_t {
+        auto index = splicingPtrVec.indexOf(splicingLine);
+        return (index > -1 && index < int(posVec.size())) ? posVec[index] : splicingLine->getSplicingPos();
+    };
+
+    layerSplicing.splicingAreaMap_support.clear();
+    const auto &scanFiledMap = _scannerSplicing->scanFiledMap;
+    for(auto it = scanFiledMap.cbegin(); it != scanFiledMap.cend(); ++ it)
+    {
+        const auto &scanFiled = it.value();
+        const auto &splicingMap = scanFiled.splicingMap;
+
+        auto splicingArea = new SplicingAreaInfo();
+        splicingArea->rectField = scanFiled.scanRc;
+        if(splicingMap.contains(SplicingAbstract::RT_Left))
+        {
+            const auto &splicingLine = splicingMap[SplicingAbstract::RT_Left];
+            splicingArea->rectField.left = funcSplicingPos(splicingLine) - splicingLine->getOverlap();
+        }
+        if(splicingMap.contains(SplicingAbstract::RT_Right))
+        {
+            const auto &splicingLine = splicingMap[SplicingAbstract::RT_Right];
+            splicingArea->rectField.right = funcSplicingPos(splicingLine) + splicingLine->getOverlap();
+        }
+        if(splicingMap.contains(SplicingAbstract::RT_Top))
+        {
+            const auto &splicingLine = splicingMap[SplicingAbstract::RT_Top];
+            splicingArea->rectField.top = funcSplicingPos(splicingLine) - splicingLine->getOverlap();
+        }
+        if(splicingMap.contains(SplicingAbstract::RT_Bottom))
+        {
+            const auto &splicingLine = splicingMap[SplicingAbstract::RT_Bottom];
+            splicingArea->rectField.bottom = funcSplicingPos(splicingLine) + splicingLine->getOverlap();
+        }
+
+        splicingArea->scannerIndex = it.key();
+        splicingArea->layerScanField.push_back(splicingArea->rectField.AsPath());
+        layerSplicing.splicingAreaMap_support.insert(it.key(), SplicingAreaPtr(splicingArea));
+    }
+}
+
 void SLMSplicingModulePriv::calcLinesOnRect(const IntRect &rect, const Paths &paths, Paths &onRectLineVec)
 {
     onRectLineVec.clear();
@@ -3,6 +3,10 @@
 
 #include "splicingheader.h"
 
+#include <QMutex>
+#include <vector>
+#include <map>
+
 ///
 /// ! @coreclass{SLMSplicingModulePriv}
 /// 拼接模块的私有实现类
@@ -16,6 +20,9 @@ public:
     void calcLinesOnRect(const IntRect &, const Paths &, Paths &);
     void removeLineOnRect(const IntRect &, Paths &);
 
+    void createLayerSplicing(const std::vector<int64_t> &, LayerSplicingArea &) const;
+    void currentLinePos(std::vector<int64_t> &) const;
+
 private:
     void calcLinesOnRect(const IntRect &, const Path &, Paths &);
     bool removeLineOnRect(const IntRect &, const Path &, Paths &);
@@ -25,7 +32,17 @@ private:
 private:
     friend class SLMSplicingModule;
     QSharedPointer<ScannerSplicingArea> _scannerSplicing;
-    QMap<int, LayerSplicingArea> _layerSplicingMap;
+    bool _rectClipSplit = true;                     // 轴对齐分区的轮廓/实体按矩形直接裁剪
+
+    // 拼接表: 每个有效层只记录各拼接线位置, 分区矩形按需生成
+    int _minLayer = 0;
+    std::vector<int> _rowIndexVec;                  // 层号 - _minLayer -> 行号, -1 为无拼接信息
+    std::vector<int64_t> _linePosVec;               // 行号 * 拼接线数 + 拼接线序号 -> 拼接线位置
+
+    // 已生成的分区, 按拼接线位置组合复用; 条目不删除, 保证返回的引用始终有效
+    QMutex _cacheLocker;
+    std::map<std::vector<int64_t>, QSharedPointer<LayerSplicingArea>> _layerSplicingCache;
+    LayerSplicingArea _emptySplicing;
 };
 
 #endif //SPLICING_MODULE_PRIV_HHH_HH_H
@@ -0,0 +1,157 @@
+#include "splicingstitcher.h"
+
+#include <algorithm>
+#include <cmath>
+
+///
+/// @brief 初始化拼接区间
+/// @param rightPosVec [in] 各分区右边界, 按X递增排列, 末项为平台外哨兵
+/// @param overlap [in] 搭接量, 截断后两侧矢量各向对方延伸的长度
+/// @param jitter [in] 拼接线按层抖动的最大幅度, 0为不抖动
+/// @param balance [in] 完全落在搭接区内的矢量是否按搭接区负载分配
+///
+void SplicingStitcher::initialize(const std::vector<int64_t> &rightPosVec, const int64_t &overlap,
+                                  const int64_t &jitter, const bool &balance)
+{
+    _baseRightVec = rightPosVec;
+    _rightPosVec = rightPosVec;
+    _overlapLoadVec.assign(rightPosVec.size(), 0.0);
+    _overlap = std::max<int64_t>(0, overlap);
+    _jitter = std::max<int64_t>(0, jitter);
+    _balance = balance;
+}
+
+///
+/// @brief 按层号计算本层拼接线位置
+/// @details 抖动量由层号与拼接线序号确定, 同一层重复计算结果一致;
+///   抖动后仍保持各拼接线严格递增且位于哨兵之前
+///
+void SplicingStitcher::applyLayer(const int &layer)
+{
+    _rightPosVec = _baseRightVec;
+    if(0 == _jitter || _rightPosVec.size() < 2) return;
+
+    const auto stitchCnt = _rightPosVec.size() - 1;
+    for(size_t i = 0; i < stitchCnt; ++ i)
+    {
+        auto pos = _baseRightVec[i] + calcJitter(layer, i, _jitter);
+        if(i) pos = std::max(pos, _rightPosVec[i - 1] + 1);
+        _rightPosVec[i] = std::min(pos, _baseRightVec.back() - 1);
+    }
+}
+
+///
+/// @brief 定位X坐标所在分区
+/// @return 分区序号, 超出全部分区时返回-1
+///
+int SplicingStitcher::locate(const int64_t &x) const
+{
+    auto it = std::upper_bound(_rightPosVec.cbegin(), _rightPosVec.cend(), x);
+    return (it == _rightPosVec.cend()) ? -1 : int(it - _rightPosVec.cbegin());
+}
+
+///
+/// @brief 分配一条扫描矢量
+/// @param funcStitch [in] 回调(振镜序号, 起点, 终点), 按矢量方向依次调用
+/// @return 端点超出全部分区时返回 false, 不做分配
+/// @details 实现步骤:
+///   1. 二分查找起止点所在分区
+///   2. 开启负载均衡且矢量完全位于某条拼接线的搭接区内时, 整体交给搭接区负载较小的一侧
+///   3. 同一分区直接输出, 否则沿矢量方向依次在拼接线处截断, 两侧各延伸搭接量
+///
+bool SplicingStitcher::stitch(const int64_t &x1, const int64_t &y1, const int64_t &x2, const int64_t &y2,
+                              const FuncStitch &funcStitch)
+{
+    const int pt1Area = locate(x1);
+    const int pt2Area = locate(x2);
+    if(pt1Area < 0 || pt2Area < 0) return false;
+
+    const int64_t minX = std::min(x1, x2);
+    const int64_t maxX = std::max(x1, x2);
+    const double dx = double(maxX - minX);
+    const double lengthScale = (dx > 0) ? std::hypot(dx, double(y2 - y1)) / dx : 0.0;
+
+    const int balanceScanner = calcBalanceScanner(minX, maxX);
+    if(balanceScanner > -1)
+    {
+        _overlapLoadVec[size_t(balanceScanner)] += std::hypot(dx, double(y2 - y1));
+        funcStitch(balanceScanner, x1, y1, x2, y2);
+        return true;
+    }
+    if(pt1Area == pt2Area)
+    {
+        funcStitch(pt1Area, x1, y1, x2, y2);
+        return true;
+    }
+
+    auto calcY = [&](const int64_t &x) -> int64_t { return y1 + (x - x1) * (y2 - y1) / (x2 - x1); };
+    auto addLoad = [&](const int &scanner, const int64_t &xs, const int64_t &xe) {
+        if(_balance && xe > xs) _overlapLoadVec[size_t(scanner)] += double(xe - xs) * lengthScale;
+    };
+
+    int64_t tempX = x1;
+    int64_t tempY = y1;
+    if(pt1Area < pt2Area)
+    {
+        for(int iArea = pt1Area; iArea < pt2Area; ++ iArea)
+        {
+            const int64_t pos = _rightPosVec[size_t(iArea)];
+            const int64_t endX = std::min(pos + _overlap, x2);
+            funcStitch(iArea, tempX, tempY, endX, calcY(endX));
+            addLoad(iArea, std::max(tempX, pos - _overlap), endX);
+
+            tempX = std::max(pos - _overlap, x1);
+            tempY = calcY(tempX);
+            addLoad(iArea + 1, tempX, std::min(pos + _overlap, x2));
+        }
+    }
+    else
+    {
+        for(int iArea = pt1Area; iArea > pt2Area; -- iArea)
+        {
+            const int64_t pos = _rightPosVec[size_t(iArea - 1)];
+            const int64_t endX = std::max(pos - _overlap, x2);
+            funcStitch(iArea, tempX, tempY, endX, calcY(endX));
+            addLoad(iArea, endX, std::min(tempX, pos + _overlap));
+
+            tempX = std::min(pos + _overlap, x1);
+            tempY = calcY(tempX);
+            addLoad(iArea - 1, std::max(pos - _overlap, x2), tempX);
+        }
+    }
+    funcStitch(pt2Area, tempX, tempY, x2, y2);
+    return true;
+}
+
+///
+/// @brief 搭接区内矢量的均衡分配
+/// @return 矢量完全位于某条拼接线 ± 搭接量范围内时返回负载较小一侧的振镜, 否则返回-1
+///
+int SplicingStitcher::calcBalanceScanner(const int64_t &minX, const int64_t &maxX) const
+{
+    if(false == _balance || _overlap <= 0 || _rightPosVec.size() < 2) return -1;
+
+    const int area = locate(minX);
+    const int stitchCnt = int(_rightPosVec.size()) - 1;
+    for(int stitchIndex = area; stitchIndex >= area - 1; -- stitchIndex)
+    {
+        if(stitchIndex < 0 || stitchIndex >= stitchCnt) continue;
+
+        const int64_t pos = _rightPosVec[size_t(stitchIndex)];
+        if(minX >= pos - _overlap && maxX <= pos + _overlap)
+        {
+            return (_overlapLoadVec[size_t(stitchIndex)] <= _overlapLoadVec[size_t(stitchIndex + 1)]) ?
+                       stitchIndex : stitchIndex + 1;
+        }
+    }
+    return -1;
+}
+
+int64_t SplicingStitcher::calcJitter(const int &layer, const size_t &index, const int64_t &jitter)
+{
+    quint64 z = (quint64(quint32(layer)) << 32) ^ quint64(index) ^ 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= (z >> 31);
+    return int64_t(z % quint64(2 * jitter + 1)) - jitter;
+}
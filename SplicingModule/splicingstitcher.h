@@ -0,0 +1,45 @@
+#ifndef SPLICINGSTITCHER_H
+#define SPLICINGSTITCHER_H
+
+#include <QtGlobal>
+#include <functional>
+#include <vector>
+
+typedef std::function<void(const int &, const int64_t &, const int64_t &, const int64_t &, const int64_t &)> FuncStitch;
+
+///
+/// ! @coreclass{SplicingStitcher}
+/// 扫描线级拼接: 对已生成的扫描矢量按竖直拼接线分配振镜
+/// @details 各分区沿X轴依次排列, 分区右边界构成有序的一维区间索引, 端点定位为二分查找;
+///   跨越拼接线的矢量在拼接线处精确截断, 两侧各向对方延伸搭接量;
+///   落在搭接区内的短矢量可整体分配给搭接区负载较小的振镜;
+///   拼接线位置可按层抖动, 只影响矢量分配, 不需要重新裁剪轮廓
+///
+class SplicingStitcher
+{
+public:
+    SplicingStitcher() = default;
+
+    void initialize(const std::vector<int64_t> &, const int64_t &overlap, const int64_t &jitter, const bool &balance);
+    void applyLayer(const int &);
+
+    int locate(const int64_t &) const;
+    bool stitch(const int64_t &, const int64_t &, const int64_t &, const int64_t &, const FuncStitch &);
+
+    inline const std::vector<int64_t> &rightPosVec() const { return _rightPosVec; }
+    inline int64_t overlap() const { return _overlap; }
+
+private:
+    int calcBalanceScanner(const int64_t &, const int64_t &) const;
+    static int64_t calcJitter(const int &, const size_t &, const int64_t &);
+
+private:
+    std::vector<int64_t> _baseRightVec;         // 各分区右边界基准位置, 末项为平台外哨兵
+    std::vector<int64_t> _rightPosVec;          // 当前层各分区右边界, 前 n-1 项即拼接线位置
+    std::vector<double> _overlapLoadVec;        // 各振镜在搭接区内累计分配的矢量长度, 仅负载均衡时统计
+    int64_t _overlap = 0;
+    int64_t _jitter = 0;
+    bool _balance = false;
+};
+
+#endif // SPLICINGSTITCHER_H
@@ -0,0 +1,113 @@
+# 处理器源文件列表, 由 UTSLAProcessor.pro 及 tests 下的静态库工程共用
+
+SOURCES += \
+    $$PWD/../../Common/Clipper/clipper.cpp \
+    $$PWD/DynamicDivider/PolygonsDivider/areasweepdivider.cpp \
+    $$PWD/DynamicDivider/PolygonsDivider/earcutter.cpp \
+    $$PWD/DynamicDivider/PolygonsDivider/polygonsdivider.cpp \
+    $$PWD/DynamicDivider/ScanLinesDivider/scanlinesdivider.cpp \
+    $$PWD/DynamicDivider/SliceStore/slicestore.cpp \
+    $$PWD/DynamicDivider/TargetedDistribution/targeteddistribution.cpp \
+    $$PWD/DynamicDivider/WaterDistribution/waterdistributionpriv.cpp \
+    $$PWD/DynamicDivider/algorithmdistribution.cpp \
+    $$PWD/DynamicDivider/dividerprocessor.cpp \
+    $$PWD/LatticeModule/latticeinterface.cpp \
+    $$PWD/LatticeModule/latticsdiamond.cpp \
+    $$PWD/LatticeModule/meshbase.cpp \
+    $$PWD/ScanLinesSortor/quadtreedef.cpp \
+    $$PWD/ScanLinesSortor/quadtreesortor.cpp \
+    $$PWD/ScanLinesSortor/scanlinessortor.cpp \
+    $$PWD/ScanTimeModule/scantimemodule.cpp \
+    $$PWD/SelfAdaptiveModule/selfadaptivemodule.cpp \
+    $$PWD/SplicingModule/splicingabstract.cpp \
+    $$PWD/SplicingModule/splicingmodulepriv.cpp \
+    $$PWD/SplicingModule/splicingstitcher.cpp \
+    $$PWD/algorithmapplication.cpp \
+    $$PWD/algorithmbase.cpp \
+    $$PWD/algorithmchecker.cpp \
+    $$PWD/algorithmhatching.cpp \
+    $$PWD/algorithmhatchingring.cpp \
+    $$PWD/algorithmstrip.cpp \
+    $$PWD/clipper2/clipper.engine.cpp \
+    $$PWD/clipper2/clipper.offset.cpp \
+    $$PWD/clipper2/clipper.rectclip.cpp \
+    $$PWD/jobarchiver.cpp \
+    $$PWD/layerarena.cpp \
+    $$PWD/meshinfo.cpp \
+    $$PWD/polygonstartchanger.cpp \
+    $$PWD/publicheader.cpp \
+    $$PWD/slaprocessorextend.cpp \
+    $$PWD/sljobfilewriter.cpp \
+    $$PWD/SplicingModule/slmsplicingmodule.cpp \
+    $$PWD/scanvectorbuffer.cpp \
+    $$PWD/uspfilereader.cpp \
+    $$PWD/uspinstancecopier.cpp \
+    $$PWD/uspfilevalidator.cpp \
+    $$PWD/uspfilewriter.cpp \
+    $$PWD/utslaprocessor.cpp \
+    $$PWD/utslaprocessorprivate.cpp \
+    $$PWD/writejfile.cpp \
+    $$PWD/writeuff.cpp
+
+HEADERS += \
+    $$PWD/../../Common/Clipper/clipper.hpp \
+    $$PWD/DynamicDivider/PolygonsDivider/dividerheader.h \
+    $$PWD/DynamicDivider/PolygonsDivider/areasweepdivider.h \
+    $$PWD/DynamicDivider/PolygonsDivider/earcutter.h \
+    $$PWD/DynamicDivider/PolygonsDivider/polygonsdivider.h \
+    $$PWD/DynamicDivider/ScanLinesDivider/scanlinesdivider.h \
+    $$PWD/DynamicDivider/SliceStore/slicestore.h \
+    $$PWD/DynamicDivider/TargetedDistribution/targeteddistribution.h \
+    $$PWD/DynamicDivider/WaterDistribution/waterdistributionpriv.h \
+    $$PWD/DynamicDivider/algorithmdistribution.h \
+    $$PWD/DynamicDivider/dividerprocessor.h \
+    $$PWD/DynamicDivider/layerpipeline.h \
+    $$PWD/LatticeModule/latticeinterface.h \
+    $$PWD/LatticeModule/latticsabstract.h \
+    $$PWD/LatticeModule/latticsdiamond.h \
+    $$PWD/LatticeModule/meshbase.h \
+    $$PWD/ScanLinesSortor/quadtreedef.h \
+    $$PWD/ScanLinesSortor/quadtreesortor.h \
+    $$PWD/ScanLinesSortor/scanlinessortor.h \
+    $$PWD/ScanTimeModule/scantimemodule.h \
+    $$PWD/SelfAdaptiveModule/selfadaptivemodule.h \
+    $$PWD/SplicingModule/splicingabstract.h \
+    $$PWD/SplicingModule/splicingheader.h \
+    $$PWD/SplicingModule/splicingmodulepriv.h \
+    $$PWD/SplicingModule/splicingstitcher.h \
+    $$PWD/UTSLAProcessor_global.h \
+    $$PWD/algorithmapplication.h \
+    $$PWD/algorithmbase.h \
+    $$PWD/algorithmchecker.h \
+    $$PWD/algorithmhatching.h \
+    $$PWD/algorithmhatchingring.h \
+    $$PWD/algorithmstrip.h \
+    $$PWD/clipper2/clipper.core.h \
+    $$PWD/clipper2/clipper.engine.h \
+    $$PWD/clipper2/clipper.h \
+    $$PWD/clipper2/clipper.minkowski.h \
+    $$PWD/clipper2/clipper.offset.h \
+    $$PWD/clipper2/clipper.rectclip.h \
+    $$PWD/clipper2/clipper.version.h \
+    $$PWD/jobarchiver.h \
+    $$PWD/layerarena.h \
+    $$PWD/meshinfo.h \
+    $$PWD/pathparameters.h \
+    $$PWD/polygonstartchanger.h \
+    $$PWD/publicheader.h \
+    $$PWD/slaprocessorextend.h \
+    $$PWD/slascaninfodef.h \
+    $$PWD/sljobfilewriter.h \
+    $$PWD/SplicingModule/slmsplicingmodule.h \
+    $$PWD/SplicingModule/splicingfixedmode.h \
+    $$PWD/uspfiledef.h \
+    $$PWD/scanvectorbuffer.h \
+    $$PWD/uspfilereader.h \
+    $$PWD/uspinstancecopier.h \
+    $$PWD/uspfilevalidator.h \
+    $$PWD/uspfilewriter.h \
+    $$PWD/utslaprocessor.h \
+    $$PWD/utslaprocessorprivate.h \
+    $$PWD/writejfile.h \
+    $$PWD/writequeue.h \
+    $$PWD/writeuff.h
@@ -0,0 +1,57 @@
+# 处理器依赖的宏定义、头文件路径及外部库, 由 UTSLAProcessor.pro 及 tests 共用
+
+CONFIG(release, debug|release): UTSLA_OUTPUT = $$PWD/../../../../OUTPUT/release
+else:CONFIG(debug, debug|release): UTSLA_OUTPUT = $$PWD/../../../../OUTPUT/debug
+
+DEFINES += UTECK_UBUNTU_PROJECT
+DEFINES += USE_CLIPPER_V2
+
+INCLUDEPATH += $$PWD/../../Common
+INCLUDEPATH += $$PWD/../../Common/Clipper
+INCLUDEPATH += $$PWD/../../Common/BPCCommon
+
+win32:CONFIG(release, debug|release): LIBS += -L$$UTSLA_OUTPUT/ -lUTBPProcessBase
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$UTSLA_OUTPUT/ -lUTBPProcessBase
+else:unix: LIBS += -L$$UTSLA_OUTPUT/ -lUTBPProcessBase
+
+INCLUDEPATH += $$PWD/../UTBPProcessBase
+DEPENDPATH += $$PWD/../UTBPProcessBase
+
+win32:CONFIG(release, debug|release): LIBS += -L$$UTSLA_OUTPUT/ -lUTBPParaReader
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$UTSLA_OUTPUT/ -lUTBPParaReader
+else:unix: LIBS += -L$$UTSLA_OUTPUT/ -lUTBPParaReader
+
+INCLUDEPATH += $$PWD/../BPCParameters/UTBPParaReader
+DEPENDPATH += $$PWD/../BPCParameters/UTBPParaReader
+
+win32:CONFIG(release, debug|release): LIBS += -L$$UTSLA_OUTPUT/ -lCommonLib
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$UTSLA_OUTPUT/ -lCommonLib
+else:unix: LIBS += -L$$UTSLA_OUTPUT/ -lCommonLib
+
+INCLUDEPATH += $$PWD/../BPCParameters/CommonLib
+DEPENDPATH += $$PWD/../BPCParameters/CommonLib
+
+win32:CONFIG(release, debug|release): LIBS += -L$$UTSLA_OUTPUT/ -lZipLib
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$UTSLA_OUTPUT/ -lZipLib
+else:unix: LIBS += -L$$UTSLA_OUTPUT/ -lZipLib
+unix: LIBS += -lz
+
+INCLUDEPATH += $$PWD/../../../../Libs/BPC/include
+INCLUDEPATH += $$PWD/../../../../Libs/ZipLib/include
+
+
+INCLUDEPATH += $$PWD/../BPProcessorFactory
+
+LIBS += -L$$UTSLA_OUTPUT/ -lSLJFileParser
+INCLUDEPATH += $$PWD/../../SLJFileModule/SLJFileParser
+INCLUDEPATH += $$PWD/../../SLJFileModule/Common
+
+INCLUDEPATH += $$PWD/SplicingModule
+
+INCLUDEPATH += $$PWD/DynamicDivider
+INCLUDEPATH += $$PWD/DynamicDivider/PolygonsDivider
+INCLUDEPATH += $$PWD/DynamicDivider/WaterDistribution
+
+QMAKE_CXXFLAGS += -openmp
+QMAKE_LFLAGS += -openmp
+LIBS += -fopenmp
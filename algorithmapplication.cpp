@@ -3,6 +3,7 @@
 
 #include "ScanLinesDivider/scanlinesdivider.h"
 #include "PolygonsDivider/polygonsdivider.h"
+#include "PolygonsDivider/areasweepdivider.h"
 #include "ScanLinesSortor/scanlinessortor.h"
 #include "LatticeModule/latticeinterface.h"
 #include "slmsplicingmodule.h"
@@ -12,6 +13,7 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QSettings>
+#include <algorithm>
 
 #define CALC_HATCHING
 #define CALC_SMALLSTRUCT
@@ -70,6 +72,15 @@ void AlgorithmApplication::setBuffParas(PARAWRITEBUFF *paras, const int &curScan
 #endif
 }
 
+///
+/// @brief 填充方式是否以平台坐标划分区域
+/// @details 棋盘格及条带按平台尺寸生成, 零件平移后填充结果不同
+///
+bool AlgorithmApplication::isPlatformAnchoredHatching(const int &nHatchType)
+{
+    return HATCHTYPE_CHECKER == nHatchType || HATCHTYPE_STRIP == nHatchType;
+}
+
 void AlgorithmApplication::setHatchingAngle(double fAngle)
 {
     fHatchingAngle = fAngle;
@@ -167,19 +178,47 @@ void AlgorithmApplication::calcSplicingVec()
                                 : qRound((lpParas->fSplicingPos[iScanner] * FILEDATAUNIT - nHalfSplicingLength));
         splitArea.nSplicingPosLeft = nLeftPos;
         splitArea.nSplicingPosRight = nRightPos;
-        splitArea.pathArea << IntPoint(nLeftPos, 0) << IntPoint(nRightPos, 0)
-                           << IntPoint(nRightPos, nPlatY) << IntPoint(nLeftPos, nPlatY);
         vecSplicingArea << splitArea;
+        nLeftPos = nRightPos;
+    }
+    m_bPlatPlus = !m_bPlatPlus;
+
+    std::vector<int64_t> rightPosVec;
+    rightPosVec.reserve(size_t(vecSplicingArea.size()));
+    for(const auto &splicingArea : qAsConst(vecSplicingArea))
+    {
+        rightPosVec.push_back(splicingArea.nSplicingPosRight);
+    }
+    _splicingStitcher.initialize(rightPosVec,
+                                 qRound64(ExtendedParas<double>("Splicing/fStitchOverlap", 0) * FILEDATAUNIT),
+                                 qRound64(ExtendedParas<double>("Splicing/fStitchJitter", 0) * FILEDATAUNIT),
+                                 ExtendedParas<int>("Splicing/nStitchBalance", 0));
+    _splicingStitcher.applyLayer(_layerHei);
 
-        if(iScanner)
+    // 轮廓及实体按同一条拼接线裁剪: 分区边界取本层抖动后的拼接线位置, 两侧各延伸搭接量
+    const auto &stitchPosVec = _splicingStitcher.rightPosVec();
+    const int64_t nOverlap = _splicingStitcher.overlap();
+    for(int iScanner = 0; iScanner < vecSplicingArea.size(); ++ iScanner)
+    {
+        SplicingArea &splitArea = vecSplicingArea[iScanner];
+        if(iScanner) splitArea.nSplicingPosLeft = stitchPosVec[size_t(iScanner - 1)] - nOverlap;
+        if(iScanner + 1 < vecSplicingArea.size())
         {
+            splitArea.nSplicingPosRight = stitchPosVec[size_t(iScanner)] + nOverlap;
+
             SplicingLine splicingLine;
-            splicingLine.nSplicingPos = nLeftPos;
+            splicingLine.nSplicingPos = stitchPosVec[size_t(iScanner)] - nOverlap;
             vecSplicingLine << splicingLine;
+            if(nOverlap > 0)
+            {
+                splicingLine.nSplicingPos = stitchPosVec[size_t(iScanner)] + nOverlap;
+                vecSplicingLine << splicingLine;
+            }
         }
-        nLeftPos = nRightPos;
+        splitArea.pathArea.clear();
+        splitArea.pathArea << IntPoint(splitArea.nSplicingPosLeft, 0) << IntPoint(splitArea.nSplicingPosRight, 0)
+                           << IntPoint(splitArea.nSplicingPosRight, nPlatY) << IntPoint(splitArea.nSplicingPosLeft, nPlatY);
     }
-    m_bPlatPlus = !m_bPlatPlus;
 }
 
 void AlgorithmApplication::createEnhanceBorderParas()
@@ -398,38 +437,85 @@ void AlgorithmApplication::writeHatchingData(LatticeLayerInfo &layerInfo, const
 {
     if (layerInfo._latticeInfo.size() < 1 || layerInfo._latticePathInfo.size() < 1) return;
 
-    struct WriteDatas {
-        UFFWRITEDATA _writeData;
-        int _scanner;
-        int _beam;
-
-        WriteDatas() = default;
-        WriteDatas(const UFFWRITEDATA &writeData, const int &scanner, const int &beam) {
-            _writeData = std::move(writeData);
-            _scanner = scanner;
-            _beam = beam;
-        }
-    };
-
     auto keys = layerInfo._latticePathInfo.keys();
-    QMap<int, QVector<WriteDatas>> writeDataMap;
+    QMap<int, LatticeHatchTemplate> templateMap;
 
     double fLineSpace = isBigBeam(BppParas->sGeneralPara.nNumber_Beam, BppParas->sGeneralPara.nNumber_Beam - 1) ?
                             fLLineSpace : fSLineSpace;
 
+    // 拼接、分区分配或按平台划分填充区域时结果与位置相关, 模板在代表晶格原位生成且不跨层复用;
+    // 否则模板在晶格基准点为原点的坐标系中生成, 填充线起点只取决于晶格轮廓本身, 与所在层及位置无关
+    auto tempIndex = curScannerIndex;
+    if (1 == _solidDisInfoVec.size()) tempIndex = _solidDisInfoVec.front()._containorIndex;
+    const bool bCellFrame = false == _writeBuff->isSolidSplicing() && _solidDisInfoVec.size() < 2 &&
+                           false == isPlatformAnchoredHatching(BppParas->sHatchingPara.nHatchingType[0]);
+    bool useCache = ExtendedParas<int>("Lattice/useHatchCache", 1) && layerInfo._phase >= 0 && bCellFrame;
+    const int nCacheSize = qMax(ExtendedParas<int>("Lattice/nHatchCacheSize", 256), 1);
+
+    // 模板内容由块头及填充参数决定, 全部纳入缓存键
+    LatticeHatchKey cacheKey;
+    cacheKey._phase = layerInfo._phase;
+    cacheKey._scanner = tempIndex;
+    cacheKey._cLineFactor = BppParas->sHatchingPara.nCLineFactor;
+    cacheKey._angle = qRound64(fHatchingAngle * 1000.0);
+    cacheKey._lineSpace = qRound64(fLLineSpace * 1000.0);
+    cacheKey._sLineSpace = qRound64(fSLineSpace * 1000.0);
+    cacheKey._speedRatio = qRound64(fSpeedRatio * 1000.0);
+    if (useCache) calcLatticeHatchHeaders(fSpeedRatio, cacheKey._headers);
+
     int curType = 0;
+    IntPoint curCenter;
     CB_WRITEDATA cb_writeData;
     cb_writeData._getScanLines = true;
-    cb_writeData._addWriteData = [&curType, &writeDataMap](const UFFWRITEDATA &writeData, const int &scanner, const int &beam) {
-        if (false == writeDataMap.contains(curType)) writeDataMap.insert(curType, QVector<WriteDatas>());
-        writeDataMap[curType] << WriteDatas(writeData, scanner, beam);
+    cb_writeData._addWriteData = [&curType, &curCenter, &templateMap](const UFFWRITEDATA &writeData, const int &scanner, const int &beam) {
+        // 模板坐标转换为相对晶格基准点
+        LatticeHatchData hatchData;
+        hatchData._writeData = writeData;
+        hatchData._writeData.listSLines.clear();
+        hatchData._writeData.vectorBuffer.reset();
+        hatchData._scanner = scanner;
+        hatchData._beam = beam;
+        auto vectors = QSharedPointer<ScanVectorBuffer>::create();
+        vectors->appendTranslated(writeData.lineView(), -qint32(curCenter.X), -qint32(curCenter.Y));
+        hatchData._vectors = vectors;
+        templateMap[curType] << std::move(hatchData);
     };
 
     for (const auto &key : qAsConst(keys))
     {
+        // 代表晶格轮廓平移到基准点坐标系
+        const auto &pathInfo = layerInfo._latticePathInfo[key];
+        Path latticePath = pathInfo._path;
+        curCenter = IntPoint(pathInfo._centerX, pathInfo._centerY);
+        if (bCellFrame)
+        {
+            for (auto &pt : latticePath)
+            {
+                pt.X -= curCenter.X;
+                pt.Y -= curCenter.Y;
+            }
+            curCenter = IntPoint(0, 0);
+        }
+
+        // 优先使用缓存模板, 代表晶格轮廓一致时模板逐点相同
+        cacheKey._type = key;
+        if (useCache)
+        {
+            cacheKey._path = latticePath;
+            auto it = _latticeHatchCache.find(cacheKey);
+            if (it != _latticeHatchCache.end())
+            {
+                it->_lastUse = ++ _latticeHatchUseCnt;
+                templateMap.insert(key, it->_template);
+                continue;
+            }
+        }
+
+        // 生成代表晶格填充线模板
         curType = key;
+        templateMap.insert(key, LatticeHatchTemplate());
         Paths tempPaths;
-        tempPaths << layerInfo._latticePathInfo[key]._path;
+        tempPaths << std::move(latticePath);
         writeAllHatching(tempPaths, HATCHINGBEAM_NORMAL, fSpeedRatio, fSLineSpace,
                          [&tempPaths, fSpeedRatio, fLineSpace, this](Paths &curPaths, Paths &lastPaths, const CB_WRITEDATA &cbWriteData) {
                              HATCHINGPARAMETERS *lpPara = &BppParas->sHatchingPara;
@@ -437,33 +523,68 @@ void AlgorithmApplication::writeHatchingData(LatticeLayerInfo &layerInfo, const
                              recalcBeamStruct(tempPaths, lastPaths, curPaths, fOffset);
                              writeHatching(curPaths, fSpeedRatio, fLineSpace, cbWriteData);
                          }, cb_writeData);
+        if (false == useCache) continue;
+
+        // 缓存已满时淘汰最久未使用的模板
+        if (_latticeHatchCache.size() >= nCacheSize)
+        {
+            auto oldest = _latticeHatchCache.begin();
+            for (auto it = _latticeHatchCache.begin(); it != _latticeHatchCache.end(); ++ it)
+            {
+                if (it->_lastUse < oldest->_lastUse) oldest = it;
+            }
+            _latticeHatchCache.erase(oldest);
+        }
+        LatticeHatchCacheItem cacheItem;
+        cacheItem._template = templateMap[key];
+        cacheItem._lastUse = ++ _latticeHatchUseCnt;
+        _latticeHatchCache.insert(cacheKey, cacheItem);
     }
 
+    // 按扫描器/光束归集输出; 启用合并时相邻同参数且以跳转开始的数据直接拼接, 否则每个实例独立成块
+    const bool bMergeBlocks = ExtendedParas<int>("Lattice/nMergeHatchBlocks", 0);
+    QMap<QPair<int, int>, QVector<UFFWRITEDATA>> outputMap;
+    auto isSameHeader = [](const UFFWRITEDATA &lhs, const UFFWRITEDATA &rhs) -> bool {
+        return lhs.nMode_Section == rhs.nMode_Section && lhs.nMode_Coor == rhs.nMode_Coor &&
+               lhs.nPartIndex == rhs.nPartIndex && lhs.nLaserPower == rhs.nLaserPower &&
+               lhs.nMarkSpeed == rhs.nMarkSpeed;
+    };
     for (const auto &lattice : qAsConst(layerInfo._latticeInfo))
     {
-        auto type = lattice._type;
-        auto writeDataVec = writeDataMap[type];
-        auto vecSz = writeDataVec.size();
-        if (vecSz < 1) continue;
-
-        auto offsetX = lattice._centerX - layerInfo._latticePathInfo[type]._centerX;
-        auto offsetY = lattice._centerY - layerInfo._latticePathInfo[type]._centerY;
+        auto it = templateMap.constFind(lattice._type);
+        if (it == templateMap.constEnd()) continue;
 
-        for (int i = 0; i < vecSz; ++ i)
+        for (const auto &hatchData : it.value())
         {
-            auto writeData = writeDataVec[i];
-            if (offsetX || offsetY)
+            const auto &srcData = hatchData._writeData;
+            if (hatchData._vectors.isNull() || hatchData._vectors->isEmpty()) continue;
+            const auto srcView = hatchData._vectors->view();
+
+            // 新建或续接输出数据
+            auto &dataVec = outputMap[qMakePair(hatchData._scanner, hatchData._beam)];
+            if (false == bMergeBlocks || dataVec.isEmpty() || false == isSameHeader(dataVec.last(), srcData) ||
+                SECTION_SCANTYPE_JUMP != srcView.type(0))
             {
-                for (auto it = writeData._writeData.listSLines.begin();
-                     it != writeData._writeData.listSLines.end(); ++ it)
-                {
-                    it->nX += offsetX;
-                    it->nY += offsetY;
-                }
+                UFFWRITEDATA writeData;
+                writeData.nMode_Section = srcData.nMode_Section;
+                writeData.nMode_Coor = srcData.nMode_Coor;
+                writeData.nPartIndex = srcData.nPartIndex;
+                writeData.nLaserPower = srcData.nLaserPower;
+                writeData.nMarkSpeed = srcData.nMarkSpeed;
+                writeData.vectorBuffer = QSharedPointer<ScanVectorBuffer>::create();
+                dataVec << std::move(writeData);
             }
-            _writeBuff->appendFileData(writeData._writeData, writeData._scanner, writeData._beam);
+
+            // 平移追加扫描线, 按分量连续写入
+            dataVec.last().vectorBuffer->appendTranslated(srcView, lattice._centerX, lattice._centerY);
         }
     }
+
+    // 批量写入缓冲区
+    for (auto it = outputMap.begin(); it != outputMap.end(); ++ it)
+    {
+        _writeBuff->appendFileDatas(it.value(), it.key().first, it.key().second);
+    }
 }
 
 void AlgorithmApplication::getUpDownSurface(Paths &targetPath, Paths &extendPaths, int &nIndex,
@@ -1124,6 +1245,52 @@ void AlgorithmApplication::writeExternedBorder_p(Paths &tempPS, const double &fS
     }
 }
 
+///
+/// @brief 填写填充块头参数
+/// @param writeData [out] 块数据
+/// @param BeamIndex [in] 光束索引, HATCHINGBEAM_NORMAL 为常规填充, 其余为小结构填充
+/// @param fSpeedRatio [in] 速度系数
+///
+void AlgorithmApplication::initHatchHeader(UFFWRITEDATA &writeData, const int &BeamIndex, const double &fSpeedRatio)
+{
+    HATCHINGPARAMETERS *lpParas = &BppParas->sHatchingPara;
+    const bool bNormal = HATCHINGBEAM_NORMAL == BeamIndex;
+    writeData.nMode_Section = bNormal ? SECTION_HATCH : SECTION_HATCH_SMALL;
+    writeData.nLaserPower = BppParas->sGeneralPara.nLaserPower[lpParas->nIndex_Power[BeamIndex]];
+    writeData.nMarkSpeed = qRound(lpParas->nMarkSpeed[BeamIndex] * (bNormal ? BpcParas->fFactor_4 : BpcParas->fFactor_3));
+    writeData.nMarkSpeed = qRound(writeData.nMarkSpeed * fSpeedRatio);
+    writeData.nMode_Coor = bNormal ? SECTION_HATCHCOOR : SECTION_HATCHSMALL_COOR;
+}
+
+///
+/// @brief 计算晶格模板各光束的块头及填充参数, 作为模板缓存键的一部分
+/// @param fSpeedRatio [in] 速度系数
+/// @param headers [out] 各光束参数
+///
+void AlgorithmApplication::calcLatticeHatchHeaders(const double &fSpeedRatio, QVector<LatticeHatchHeader> &headers)
+{
+    HATCHINGPARAMETERS *lpParas = &BppParas->sHatchingPara;
+    const int nBeamCnt = BppParas->sGeneralPara.nNumber_Beam;
+    headers.resize(qMax(nBeamCnt, 1));
+    for (int iBeam = 0; iBeam < headers.size(); ++ iBeam)
+    {
+        UFFWRITEDATA writeData;
+        initHatchHeader(writeData, iBeam, fSpeedRatio);
+
+        auto &header = headers[iBeam];
+        header._section = writeData.nMode_Section;
+        header._coor = writeData.nMode_Coor;
+        header._partIndex = writeData.nPartIndex;
+        header._laserPower = writeData.nLaserPower;
+        header._markSpeed = writeData.nMarkSpeed;
+        header._hatchType = lpParas->nHatchingType[iBeam];
+        header._scanTimes = lpParas->nScanTimes[iBeam];
+        header._lineSpacing = qRound64(double(lpParas->fLineSpacing[iBeam]) * 1000.0);
+        header._offset = qRound64(double(lpParas->fOffset[iBeam]) * 1000.0);
+        header._minWall = iBeam > 0 ? qRound64(double(lpParas->fMinWall[iBeam - 1]) * 1000.0) : 0;
+    }
+}
+
 void AlgorithmApplication::writeHatching_p(const Paths &paths, const double &fSpeedRatio, const double &fSpacingRatio, const int &nScanner, const CB_WRITEDATA &cbFunc)
 {
     if(paths.size() < 1) return;
@@ -1131,11 +1298,7 @@ void AlgorithmApplication::writeHatching_p(const Paths &paths, const double &fSp
 
     HATCHINGPARAMETERS *lpParas = &BppParas->sHatchingPara;
     UFFWRITEDATA mUFileData;
-    mUFileData.nMode_Section = SECTION_HATCH;
-    mUFileData.nLaserPower = BppParas->sGeneralPara.nLaserPower[lpParas->nIndex_Power[HATCHINGBEAM_NORMAL]];
-    mUFileData.nMarkSpeed = qRound(lpParas->nMarkSpeed[HATCHINGBEAM_NORMAL] * BpcParas->fFactor_4);
-    mUFileData.nMarkSpeed = qRound(mUFileData.nMarkSpeed * fSpeedRatio);
-    mUFileData.nMode_Coor = SECTION_HATCHCOOR;
+    initHatchHeader(mUFileData, HATCHINGBEAM_NORMAL, fSpeedRatio);
     int nLineSpacing = qRound(double(lpParas->fLineSpacing[HATCHINGBEAM_NORMAL]) * FILEDATAUNIT * fSpacingRatio *
                               BpcParas->fFactor_10);
 #ifdef USE_PROCESSOR_EXTEND
@@ -1176,11 +1339,7 @@ void AlgorithmApplication::writeHatching_p(const Paths &paths, const double &fSp
         for(const auto &path : qAsConst(getCheckerList()))
         {
             UFFWRITEDATA mUFileDataChecker;
-            mUFileDataChecker.nMode_Section = SECTION_HATCH;
-            mUFileDataChecker.nLaserPower = BppParas->sGeneralPara.nLaserPower[lpParas->nIndex_Power[HATCHINGBEAM_NORMAL]];
-            mUFileDataChecker.nMarkSpeed = qRound(lpParas->nMarkSpeed[HATCHINGBEAM_NORMAL] * BpcParas->fFactor_4);
-            mUFileDataChecker.nMarkSpeed = qRound(mUFileDataChecker.nMarkSpeed * fSpeedRatio);
-            mUFileDataChecker.nMode_Coor = SECTION_HATCHCOOR;
+            initHatchHeader(mUFileDataChecker, HATCHINGBEAM_NORMAL, fSpeedRatio);
 
             Paths targetPath;
             getIntersectionPaths(paths, path, targetPath);
@@ -1299,12 +1458,7 @@ void AlgorithmApplication::writeSmallStruct_p(Paths &pathTarget, const double &f
 
     HATCHINGPARAMETERS *lpParas = &BppParas->sHatchingPara;
     UFFWRITEDATA mUFileData;
-    mUFileData.nMode_Section = SECTION_HATCH_SMALL;
-    mUFileData.nLaserPower = BppParas->sGeneralPara.nLaserPower
-                                 [lpParas->nIndex_Power[BeamIndex]];
-    mUFileData.nMarkSpeed = qRound(lpParas->nMarkSpeed[BeamIndex] * BpcParas->fFactor_3);
-    mUFileData.nMarkSpeed = qRound(mUFileData.nMarkSpeed * fSpeedRatio);
-    mUFileData.nMode_Coor = SECTION_HATCHSMALL_COOR;
+    initHatchHeader(mUFileData, BeamIndex, fSpeedRatio);
     TOTALHATCHINGLINE totalListHLine;
     const int nLineSpacing = qRound(double(lpParas->fLineSpacing[BeamIndex]) * FILEDATAUNIT * fSpacingRatio *
                                     BpcParas->fFactor_9);
@@ -1559,19 +1713,19 @@ void AlgorithmApplication::writeUPDownData(const Paths &pathTarget, const int &n
 
     switch(lpSurfaceParas->nHatchingType[nIndex])
     {
-    case 0:
+    case SURFACEHATCH_X:
         calcInnerPoint(pathTarget, totalListHLine, nTotalLCnt, 0.0, nLineSpacing);
         break;
-    case 1:
+    case SURFACEHATCH_Y:
         calcInnerPoint(pathTarget, totalListHLine, nTotalLCnt, 90.0, nLineSpacing);
         break;
-    case 2:
+    case SURFACEHATCH_ALTERNATE:
     {
         double fHAngle = (nIndex & 1) ? 90.0 : 0.0;
         calcInnerPoint(pathTarget, totalListHLine, nTotalLCnt, fHAngle, nLineSpacing);
     }
     break;
-    case 3:
+    case SURFACEHATCH_CROSS:
     default:
         TOTALHATCHINGLINE tempListHLine;
         calcInnerPoint(pathTarget, totalListHLine, nTotalLCnt, 0.0, nLineSpacing);
@@ -1635,76 +1789,29 @@ void AlgorithmApplication::writeUPDownData(const Paths &pathTarget, const int &n
     }
 }
 
+///
+/// @brief 支撑扫描线按竖直拼接线分配振镜
+/// @details 分区定位、截断及搭接区分配由 SplicingStitcher 完成, 此处只负责写入各振镜的扫描线;
+///   轮廓及实体的分区由 calcSplicingVec 按同一条拼接线生成
+///
 void AlgorithmApplication::splitLineByVerLine(const int64_t &x1, const int64_t &y1, const int64_t &x2,
                                               const int64_t &y2, QVector<UFFWRITEDATA> &vecUFFdata)
 {
-    int nPt1Area = -1;
-    int nPt2Area = -1;
-    for(int iArea = 0; iArea < vecSplicingArea.size(); ++ iArea)
-    {
-        if(x1 < vecSplicingArea.at(iArea).nSplicingPosRight)
-        {
-            nPt1Area = iArea;
-            break;
-        }
-    }
-    for(int iArea = 0; iArea < vecSplicingArea.size(); ++ iArea)
-    {
-        if(x2 < vecSplicingArea.at(iArea).nSplicingPosRight)
-        {
-            nPt2Area = iArea;
-            break;
-        }
-    }
+    bool bSucceed = _splicingStitcher.stitch(x1, y1, x2, y2, [this, &vecUFFdata](const int &iArea,
+                                                            const int64_t &nStartX, const int64_t &nStartY,
+                                                            const int64_t &nEndX, const int64_t &nEndY) {
+        writeDataToList(nStartX, nStartY, nEndX, nEndY, vecSplicingArea[iArea].nLastX,
+                        vecSplicingArea[iArea].nLastY, vecUFFdata[iArea].listSLines);
+    });
 
-    if(-1 == nPt1Area || -1 == nPt2Area)
+    if(false == bSucceed)
     {
         for(int iArea = 0; iArea < vecSplicingArea.size(); ++ iArea)
         {
             qDebug() << "splitLine Error!" << iArea << vecSplicingArea.at(iArea).nSplicingPosRight;
         }
-        qDebug() << "splitLine Error!" << x1 << y1 << x2 << y2 << nPt1Area << nPt2Area;
-        return;
-    }
-    if(nPt1Area == nPt2Area)
-    {
-        writeDataToList(x1, y1, x2, y2, vecSplicingArea[nPt1Area].nLastX,
-                        vecSplicingArea[nPt1Area].nLastY, vecUFFdata[nPt1Area].listSLines);
-    }
-    else
-    {
-        if(nPt1Area < nPt2Area)
-        {
-            int64_t nTempX = x1;
-            int64_t nTempY = y1;
-            for(int iArea = nPt1Area; iArea < nPt2Area; ++ iArea)
-            {
-                int64_t nXPos = vecSplicingArea[iArea].nSplicingPosRight;
-                int64_t nYPos = y1 + (nXPos - x1) * (y2 - y1) / (x2 - x1);
-                writeDataToList(nTempX, nTempY, nXPos, nYPos, vecSplicingArea[iArea].nLastX,
-                                vecSplicingArea[iArea].nLastY, vecUFFdata[iArea].listSLines);
-                nTempX = nXPos;
-                nTempY = nYPos;
-            }
-            writeDataToList(nTempX, nTempY, x2, y2, vecSplicingArea[nPt2Area].nLastX,
-                            vecSplicingArea[nPt2Area].nLastY, vecUFFdata[nPt2Area].listSLines);
-        }
-        else
-        {
-            int64_t nTempX = x1;
-            int64_t nTempY = y1;
-            for(int iArea = nPt1Area; iArea > nPt2Area; -- iArea)
-            {
-                int64_t nXPos = vecSplicingArea[iArea].nSplicingPosLeft;
-                int64_t nYPos = y1 + (nXPos - x1) * (y2 - y1) / (x2 - x1);
-                writeDataToList(nTempX, nTempY, nXPos, nYPos, vecSplicingArea[iArea].nLastX,
-                                vecSplicingArea[iArea].nLastY, vecUFFdata[iArea].listSLines);
-                nTempX = nXPos;
-                nTempY = nYPos;
-            }
-            writeDataToList(nTempX, nTempY, x2, y2, vecSplicingArea[nPt2Area].nLastX,
-                            vecSplicingArea[nPt2Area].nLastY, vecUFFdata[nPt2Area].listSLines);
-        }
+        qDebug() << "splitLine Error!" << x1 << y1 << x2 << y2
+                 << _splicingStitcher.locate(x1) << _splicingStitcher.locate(x2);
     }
 }
 
@@ -1826,6 +1933,8 @@ void AlgorithmApplication::calcLineOnSplicing(Paths &tempPath)
     {
         vecSplicingLine[i].vecLine.clear();
         calcLineOnSplicing(tempPath, vecSplicingLine[i]);
+        // 排序后供 lineOnVecSplicingLine 二分查找
+        std::sort(vecSplicingLine[i].vecLine.begin(), vecSplicingLine[i].vecLine.end());
     }
 }
 
@@ -2127,6 +2236,24 @@ void AlgorithmApplication::writeHoleAndGapData(Paths &tempPS, const int &nSpeed,
     }
 }
 
+///
+/// @brief 分区分割位置网格, 两种分区方式共用
+/// @return Splicing/fSplitPrecision(mm) 换算后的网格间距, 不小于1
+///
+long long AlgorithmApplication::splitPrecision()
+{
+    return qMax(1LL, llround(ExtendedParas<double>("Splicing/fSplitPrecision", 0.001) * UNITSPRECISION));
+}
+
+///
+/// @brief 分区允许的面积误差, 两种分区方式共用
+/// @return Splicing/fSplitMaxError(mm²) 换算后的面积误差, 误差范围内分割位置取整到尽量粗的网格
+///
+double AlgorithmApplication::splitMaxError()
+{
+    return ExtendedParas<double>("Splicing/fSplitMaxError", 0.00001) * UNITSPRECISION * UNITSPRECISION;
+}
+
 bool AlgorithmApplication::createDistributionArea(const Paths &paths, const int &solid_type)
 {
     if (paths.size() < 1) return true;
@@ -2154,6 +2281,11 @@ bool AlgorithmApplication::createDistributionArea(const Paths &paths, const int
                   return res1._factor > res2._factor;
               });
 
+    if (ExtendedParas<int>("Splicing/nAreaSweepSplit", 0))
+    {
+        return createSweepDistributionArea(paths, *distInfoVec, *distributionPathVec);
+    }
+
     long long leftPos = 0;
     long long rightPos = 1E7;
     long long bottomPos = 0;
@@ -2163,10 +2295,14 @@ bool AlgorithmApplication::createDistributionArea(const Paths &paths, const int
 
     Path leftPath;
     Paths tempPaths = paths;
+    const long long nSplitPrecision = splitPrecision();
+    const double fSplitMaxError = splitMaxError();
     auto splitCnt = distInfoVec->size() - 1;
     for (int i = 0; i < splitCnt; ++ i)
     {
         PolygonsDivider divider;
+        divider.setPrecision(nSplitPrecision);
+        divider.setMaxError(fSplitMaxError);
         int splitHorizon = 0;
         auto pos = divider.calcWeightPos(tempPaths, (*distInfoVec)[i]._factor / totalFactor, splitHorizon);
         totalFactor -= (*distInfoVec)[i]._factor;
@@ -2207,6 +2343,62 @@ bool AlgorithmApplication::createDistributionArea(const Paths &paths, const int
     return (distInfoVec->size() == distributionPathVec->size());
 }
 
+///
+/// @brief 一次扫描完成多振镜分区
+/// @param paths 待分区的实体区域
+/// @param distInfoVec 各振镜分配比例, 已按比例降序排列
+/// @param distributionPathVec 输出各振镜的分区矩形
+/// @return 分区数量与振镜数量一致时返回true
+/// @details 实现步骤:
+///   1. 由各振镜比例得到前 k-1 份的面积比例
+///   2. 沿较长方向建立一次累计面积表, 同时反解出全部分割位置, 分割位置按 splitMaxError 及 splitPrecision 取整
+///   3. 相邻分割位置之间生成条带矩形, 最后一份延伸至边界
+///
+bool AlgorithmApplication::createSweepDistributionArea(const Paths &paths, const std::vector<PartResult> &distInfoVec,
+                                                       std::vector<Path> &distributionPathVec)
+{
+    double totalFactor = 0.0;
+    for (const auto &distInfo : distInfoVec) totalFactor += distInfo._factor;
+    if (totalFactor < 1E-6) return false;
+
+    std::vector<double> ratioVec;
+    ratioVec.reserve(distInfoVec.size() - 1);
+    for (size_t i = 0; i + 1 < distInfoVec.size(); ++ i)
+    {
+        ratioVec.push_back(distInfoVec[i]._factor / totalFactor);
+    }
+
+    AreaSweepDivider divider;
+    divider.setPrecision(splitPrecision());
+    divider.setMaxError(splitMaxError());
+
+    int splitHorizon = 0;
+    auto posVec = divider.calcSplitPos(paths, ratioVec, splitHorizon);
+    if (posVec.size() != ratioVec.size()) return false;
+
+    const long long minPos = 0;
+    const long long maxPos = 1E7;
+    long long lastPos = minPos;
+    posVec.push_back(maxPos);
+    for (const auto &pos : posVec)
+    {
+        Path tempPath;
+        if (splitHorizon)
+        {
+            tempPath << IntPoint(minPos, lastPos) << IntPoint(maxPos, lastPos)
+                     << IntPoint(maxPos, pos) << IntPoint(minPos, pos);
+        }
+        else
+        {
+            tempPath << IntPoint(lastPos, minPos) << IntPoint(pos, minPos)
+                     << IntPoint(pos, maxPos) << IntPoint(lastPos, maxPos);
+        }
+        distributionPathVec.push_back(std::move(tempPath));
+        lastPos = pos;
+    }
+    return (distInfoVec.size() == distributionPathVec.size());
+}
+
 void AlgorithmApplication::writeSupportAreaToPaths(QList<AREAINFOPTR> &listArea, Paths &supportPaths)
 {
     writeAreaToPaths(listArea, supportPaths);
@@ -3,6 +3,7 @@
 
 #include "./DynamicDivider/algorithmdistribution.h"
 #include "algorithmhatching.h"
+#include "./SplicingModule/splicingstitcher.h"
 struct SOLIDPATH;
 
 //namespace Utek {struct StartChangerPara;}
@@ -18,6 +19,78 @@ struct CB_WRITEDATA {
     std::function<void(const UFFWRITEDATA &, const int &, const int &)> _addWriteData =
         [](const UFFWRITEDATA &, const int &, const int &){ };
 };
+
+// 晶格填充线模板(扫描线坐标相对晶格基准点, 模板在基准点为原点的坐标系中生成)
+struct LatticeHatchData {
+    UFFWRITEDATA _writeData;                            // 仅保留块头参数
+    QSharedPointer<const ScanVectorBuffer> _vectors;    // 模板扫描线, 缓存与各晶格实例共享
+    int _scanner = 0;
+    int _beam = 0;
+};
+typedef QVector<LatticeHatchData> LatticeHatchTemplate;
+
+// 晶格填充线模板块头参数, 与模板输出的 UFFWRITEDATA 块头一一对应
+struct LatticeHatchHeader {
+    qint8 _section = -1;
+    qint8 _coor = -1;
+    int _partIndex = 0;
+    int _laserPower = 0;
+    int _markSpeed = 0;
+    int _hatchType = 0;
+    int _scanTimes = 0;
+    qint64 _lineSpacing = 0;
+    qint64 _offset = 0;
+    qint64 _minWall = 0;
+};
+
+inline bool operator==(const LatticeHatchHeader &lhs, const LatticeHatchHeader &rhs) {
+    return lhs._section == rhs._section && lhs._coor == rhs._coor && lhs._partIndex == rhs._partIndex &&
+           lhs._laserPower == rhs._laserPower && lhs._markSpeed == rhs._markSpeed &&
+           lhs._hatchType == rhs._hatchType && lhs._scanTimes == rhs._scanTimes &&
+           lhs._lineSpacing == rhs._lineSpacing && lhs._offset == rhs._offset && lhs._minWall == rhs._minWall;
+}
+
+// 晶格填充线模板缓存键
+struct LatticeHatchKey {
+    int _type = 0;
+    int _phase = 0;
+    int _scanner = 0;
+    int _cLineFactor = 0;
+    qint64 _angle = 0;
+    qint64 _lineSpace = 0;
+    qint64 _sLineSpace = 0;
+    qint64 _speedRatio = 0;
+    QVector<LatticeHatchHeader> _headers;   // 各光束块头参数
+    Path _path;                             // 代表晶格轮廓(相对晶格基准点)
+};
+
+inline bool operator==(const LatticeHatchKey &lhs, const LatticeHatchKey &rhs) {
+    return lhs._type == rhs._type && lhs._phase == rhs._phase && lhs._scanner == rhs._scanner &&
+           lhs._cLineFactor == rhs._cLineFactor && lhs._angle == rhs._angle &&
+           lhs._lineSpace == rhs._lineSpace && lhs._sLineSpace == rhs._sLineSpace &&
+           lhs._speedRatio == rhs._speedRatio && lhs._headers == rhs._headers && lhs._path == rhs._path;
+}
+
+inline uint qHash(const LatticeHatchKey &key, uint seed = 0)
+{
+    uint value = qHash(key._type, seed) ^ qHash(key._phase << 8, seed) ^ qHash(key._scanner << 24, seed) ^
+                 qHash(key._angle, seed) ^ qHash(key._lineSpace << 16, seed) ^
+                 qHash(key._sLineSpace << 24, seed) ^ qHash(key._speedRatio << 32, seed);
+    for (const auto &header : key._headers)
+    {
+        value = value * 31 + (qHash(header._laserPower, seed) ^ qHash(qint64(header._markSpeed) << 20, seed));
+    }
+    value = value * 31 + qHash(int(key._path.size()), seed);
+    if (key._path.size()) value ^= qHash(qint64(key._path.front().X) ^ (qint64(key._path.front().Y) << 32), seed);
+    return value;
+}
+
+// 晶格填充线模板缓存项, 按最近使用次序淘汰
+struct LatticeHatchCacheItem {
+    LatticeHatchTemplate _template;
+    quint64 _lastUse = 0;
+};
+
 struct LatticeLayerInfo;
 struct PartResult;
 class ScanLinesSortor;
@@ -37,6 +110,7 @@ public:
     void setBuffParas(PARAWRITEBUFF *, const int &curScanner = 0);
     inline void setCurLayerHei(const int &layerHei) { _layerHei = layerHei; }
     inline void setExportFileMode(const int &mode) { nExportFileMode = mode;}
+    static bool isPlatformAnchoredHatching(const int &);
     void calcSplicingVec();
     void createEnhanceBorderParas();
     void writeHatchingData(SOLIDPATH &, Paths &, const double &, const double &, const double &);
@@ -57,6 +131,9 @@ public:
     void writeHoleAndGapData(Paths &, const int &, const int &, const int &nScanner);
 
     bool createDistributionArea(const Paths &, const int &);
+    bool createSweepDistributionArea(const Paths &, const std::vector<PartResult> &, std::vector<Path> &);
+    long long splitPrecision();
+    double splitMaxError();
     void writeSupportAreaToPaths(QList<AREAINFOPTR> &, Paths &);
     void writeSupportToSList(const Paths &, const double &);
 
@@ -88,6 +165,8 @@ private:
 
 private:
     void writeHatching_p(const Paths &, const double &, const double &, const int &nScanner, const CB_WRITEDATA &);
+    void initHatchHeader(UFFWRITEDATA &, const int &BeamIndex, const double &);
+    void calcLatticeHatchHeaders(const double &, QVector<LatticeHatchHeader> &);
     void writeDownFileData_p(const Paths &, const int &, const double &, const double &, const int &nScanner);
     void writeUpFileData_p(const Paths &, const int &, const double &, const double &, const int &nScanner);
     void writeSmallStruct_p(Paths &, const double &, const double &, const int &nScanner, const int &BeamIndex, const CB_WRITEDATA &);
@@ -127,10 +206,13 @@ private:
     int nExportFileMode = 0;
     PARAWRITEBUFF *_writeBuff = nullptr;
     QSharedPointer<Utek::STARTCHANGERPARA> lpBEnhancedParas = nullptr;
+    QHash<LatticeHatchKey, LatticeHatchCacheItem> _latticeHatchCache;
+    quint64 _latticeHatchUseCnt = 0;
 //    QSharedPointer<SLMSplicingModule> splicingPtr = nullptr;
     QSharedPointer<ScanLinesSortor> scanLinesSortor = nullptr;
     QVector<SplicingArea> vecSplicingArea;
     QVector<SplicingLine> vecSplicingLine;
+    SplicingStitcher _splicingStitcher;
 
     std::vector<PartResult> _borderDisInfoVec;
     std::vector<PartResult> _supportDisInfoVec;
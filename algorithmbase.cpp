@@ -2,6 +2,7 @@
 #include "writeuff.h"
 
 #include <QDebug>
+#include <algorithm>
 
 /**
  * @brief 计算路径集合的面积列表
@@ -123,6 +124,166 @@ void AlgorithmBase::getAllPaths(const QList<AREAINFOPTR> &listArea, Paths &paths
     }
 }
 
+/**
+ * @brief 按容差简化路径集合(Douglas-Peucker)
+ * 
+ * @param paths 输入输出参数,待简化的闭合路径集合
+ * @param tolerance 简化容差(文件数据单位)
+ * @return int 被移除的顶点数量
+ * 
+ * @details 简化流程:
+ * 1. 容差不大于0时直接返回
+ * 2. 逐条路径调用simplifyPath进行简化
+ * 3. 简化失败(点数不足或方向改变)的路径保持原样
+ * 4. 有顶点被移除时按奇偶规则求并校验拓扑:外轮廓为正向、孔洞为反向时,合法多边形求并后
+ *    环数与有向面积之和均不变;孔洞越出外轮廓、环间重叠或岛屿落入其他轮廓都会改变二者之一
+ * 5. 拓扑不变时保留逐环简化结果(环顺序与起点不变),否则恢复原路径并返回0
+ */
+int AlgorithmBase::simplifyPaths(Paths &paths, const double &tolerance)
+{
+    if(tolerance <= 0 || paths.size() < 1) return 0;
+
+    int nRemovedCnt = 0;
+    Paths simplePaths = paths;
+    Path tempPath;
+    for(auto &path : simplePaths)
+    {
+        if(simplifyPath(path, tempPath, tolerance))
+        {
+            nRemovedCnt += int(path.size() - tempPath.size());
+            path.swap(tempPath);
+        }
+    }
+    if(nRemovedCnt <= 0) return 0;
+
+    // 逐环简化不保证环间不相交,求并后环数或有向面积变化即视为拓扑改变
+    Paths unionPaths;
+    SimplifyPolygons(simplePaths, unionPaths, pftEvenOdd);
+    double fSrcArea = 0.0, fUnionArea = 0.0, fAbsArea = 0.0;
+    for(const auto &path : simplePaths)
+    {
+        const double fArea = Area(path);
+        fSrcArea += fArea;
+        fAbsArea += qAbs(fArea);
+    }
+    for(const auto &path : unionPaths) fUnionArea += Area(path);
+    if(unionPaths.size() != simplePaths.size() || qAbs(fSrcArea - fUnionArea) > 1.0 + 1e-9 * fAbsArea)
+    {
+        return 0;
+    }
+
+    paths.swap(simplePaths);
+    return nRemovedCnt;
+}
+
+/**
+ * @brief 简化单条闭合路径
+ * 
+ * @param src 输入路径
+ * @param target 输出参数,简化后的路径
+ * @param tolerance 简化容差(文件数据单位)
+ * @return bool 简化成功且顶点减少返回true
+ * 
+ * @details 简化流程:
+ * 1. 以起点和距起点最远点为锚点,将闭合路径拆为两条折线
+ * 2. 使用显式栈执行Douglas-Peucker,保留偏差大于容差的点
+ * 3. 校验结果点数不少于3且方向与原路径一致
+ */
+bool AlgorithmBase::simplifyPath(const Path &src, Path &target, const double &tolerance)
+{
+    target.clear();
+    const int nPtCnt = int(src.size());
+    if(nPtCnt < 4) return false;
+
+    // 查找距起点最远的点作为第二锚点
+    int nFarIndex = 0;
+    double fMaxDis = -1.0;
+    for(int iPt = 1; iPt < nPtCnt; ++ iPt)
+    {
+        double dx = double(src[iPt].X - src[0].X);
+        double dy = double(src[iPt].Y - src[0].Y);
+        double fDis = dx * dx + dy * dy;
+        if(fDis > fMaxDis)
+        {
+            fMaxDis = fDis;
+            nFarIndex = iPt;
+        }
+    }
+    if(fMaxDis <= 0) return false;
+
+    const double fTolSqr = tolerance * tolerance;
+    std::vector<char> keepFlags(size_t(nPtCnt + 1), 0);
+    keepFlags[0] = 1;
+    keepFlags[size_t(nFarIndex)] = 1;
+    keepFlags[size_t(nPtCnt)] = 1;
+
+    // 闭合路径按索引nPtCnt回到起点
+    auto getPt = [&src, nPtCnt](const int &index) -> const IntPoint & {
+        return src[size_t(index < nPtCnt ? index : 0)];
+    };
+
+    std::vector<std::pair<int, int>> segStack;
+    segStack.emplace_back(0, nFarIndex);
+    segStack.emplace_back(nFarIndex, nPtCnt);
+    while(segStack.size())
+    {
+        auto seg = segStack.back();
+        segStack.pop_back();
+        if(seg.second - seg.first < 2) continue;
+
+        const auto &pt1 = getPt(seg.first);
+        const auto &pt2 = getPt(seg.second);
+        double fDX = double(pt2.X - pt1.X);
+        double fDY = double(pt2.Y - pt1.Y);
+        double fLenSqr = fDX * fDX + fDY * fDY;
+
+        int nMaxIndex = -1;
+        double fMaxDisSqr = fTolSqr;
+        for(int iPt = seg.first + 1; iPt < seg.second; ++ iPt)
+        {
+            const auto &pt = getPt(iPt);
+            double fPX = double(pt.X - pt1.X);
+            double fPY = double(pt.Y - pt1.Y);
+            double fDisSqr = 0.0;
+            if(fLenSqr > 0)
+            {
+                double fCross = fDX * fPY - fDY * fPX;
+                fDisSqr = fCross * fCross / fLenSqr;
+            }
+            else
+            {
+                fDisSqr = fPX * fPX + fPY * fPY;
+            }
+            if(fDisSqr > fMaxDisSqr)
+            {
+                fMaxDisSqr = fDisSqr;
+                nMaxIndex = iPt;
+            }
+        }
+        if(-1 != nMaxIndex)
+        {
+            keepFlags[size_t(nMaxIndex)] = 1;
+            segStack.emplace_back(seg.first, nMaxIndex);
+            segStack.emplace_back(nMaxIndex, seg.second);
+        }
+    }
+
+    target.reserve(size_t(nPtCnt));
+    for(int iPt = 0; iPt < nPtCnt; ++ iPt)
+    {
+        if(keepFlags[size_t(iPt)]) target.push_back(src[size_t(iPt)]);
+    }
+
+    // 点数不足或方向翻转时放弃简化,避免外轮廓/孔洞拓扑改变
+    if(target.size() < 3 || target.size() >= src.size() ||
+       Orientation(target) != Orientation(src))
+    {
+        target.clear();
+        return false;
+    }
+    return true;
+}
+
 /**
  * @brief 判断线段是否与矩形相交
  * 
@@ -277,6 +438,28 @@ void AlgorithmBase::sortPtOnLine(int nSortType, QVector<EXPECTPOINTINFO> &listEx
     }
 }
 
+/**
+ * @brief 对点集合按指定方向排序(内存池版本)
+ * 
+ * @param nSortType 排序类型(SORTTYPE_X:按X排序, SORTTYPE_Y:按Y排序)
+ * @param listExpectPt 待排序的点集合(从层内存池分配)
+ */
+void AlgorithmBase::sortPtOnLine(int nSortType, ArenaVector<EXPECTPOINTINFO> &listExpectPt)
+{
+    switch(nSortType)
+    {
+    case SORTTYPE_X:
+        std::sort(listExpectPt.begin(), listExpectPt.end(), lessExpectX);
+        break;
+    case SORTTYPE_Y:
+        std::sort(listExpectPt.begin(), listExpectPt.end(), lessExpectY);
+        break;
+    default:
+        std::sort(listExpectPt.begin(), listExpectPt.end(), lessExpectY);
+        break;
+    }
+}
+
 /**
  * @brief 路径内部简化处理
  * 
@@ -1067,7 +1250,7 @@ void AlgorithmBase::scanner_plotLine(const int &X1, const int &Y1, const int &X2
  * @details 检查流程:
  * 1. 遍历所有拼接线
  * 2. 检查线段两端点是否在拼接位置附近(误差范围内)
- * 3. 如果在拼接位置,检查是否包含该线段
+ * 3. 如果在拼接位置,二分查找是否包含该线段(vecLine 由 calcLineOnSplicing 排序)
  */
 bool AlgorithmBase::lineOnVecSplicingLine(int64_t x1, int64_t y1, int64_t x2, int64_t y2,
                                          QVector<SplicingLine> &vecSplicingLine)
@@ -1079,8 +1262,8 @@ bool AlgorithmBase::lineOnVecSplicingLine(int64_t x1, int64_t y1, int64_t x2, in
         if((abs(x1 - splicingLine.nSplicingPos) < SPLICING_ERROR_HOR) &&
            (abs(x2 - splicingLine.nSplicingPos) < SPLICING_ERROR_HOR))
         {
-            // 检查是否包含该线段
-            if(splicingLine.vecLine.contains(LINENORMAL(x1, y1, x2, y2)))
+            // 检查是否包含该线段, vecLine 已排序
+            if(std::binary_search(splicingLine.vecLine.cbegin(), splicingLine.vecLine.cend(), LINENORMAL(x1, y1, x2, y2)))
             {
                 return true;
             }
@@ -3,6 +3,7 @@
 
 #include "bpccommon.h"
 #include "publicheader.h"
+#include "layerarena.h"
 
 class WriteUFF;
 
@@ -17,6 +18,7 @@ public:
     void calcLimitXY(const Paths &, BOUNDINGRECT &, QList<BDRECTPTR> *listRc = nullptr);
     void calcLimitXY(const QList<AREAINFOPTR> &, BOUNDINGRECT &, QList<BDRECTPTR> *listRc = nullptr);
     void getAllPaths(const QList<AREAINFOPTR> &, Paths &);
+    int simplifyPaths(Paths &, const double &);
 
 
     bool lineCrossRC(const double &, const double &, const double &, const double &,
@@ -26,6 +28,7 @@ public:
 
     void sortPtOnLine(int, QList<EXPECTPOINTINFO> &);
     void sortPtOnLine(int, QVector<EXPECTPOINTINFO> &);
+    void sortPtOnLine(int, ArenaVector<EXPECTPOINTINFO> &);
 
     void reducePaths_Inner(Paths &);
     void addPaths_Upper(Paths &, Paths *);
@@ -56,6 +59,7 @@ public:
                                 int64_t &, int64_t &, QVector<SCANLINE> &);
 
 private:
+    bool simplifyPath(const Path &, Path &, const double &);
     void calcLimitXY(const Path &, BDRECTPTR &);
     void calcLimitXY(const AREAINFOPTR &, BDRECTPTR &);
 };
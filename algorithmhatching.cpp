@@ -1,5 +1,7 @@
 #include "algorithmhatching.h"
+#include "layerarena.h"
 #include <QThread>
+#include <algorithm>
 
 /// 用于调试输出的运算符重载函数
 // 第一个输出边界矩形的四个坐标值
@@ -45,6 +47,35 @@ void AlgorithmHatching::calcInnerPoint(const Paths &curPaths, TOTALHATCHINGLINE
     QList<BDRECTPTR> listRc;
     calcLimitXY(curPaths, outRC, &listRc);
 
+    // 以边界框左下角为原点计算: 扫描线起点、步进及交点的浮点运算只与轮廓相对位置有关,
+    // 平移后的相同轮廓得到逐点平移的填充线, 零件实例复用依赖这一点
+    const cInt nOriginX = outRC.minX, nOriginY = outRC.minY;
+    const bool bHasPt = std::any_of(curPaths.begin(), curPaths.end(), [](const Path &path) { return path.size() > 0; });
+    if(bHasPt && (0 != nOriginX || 0 != nOriginY))
+    {
+        Paths localPaths = curPaths;
+        for(auto &path : localPaths)
+        {
+            for(auto &pt : path)
+            {
+                pt.X -= nOriginX;
+                pt.Y -= nOriginY;
+            }
+        }
+        calcInnerPoint(localPaths, totalHLine, nTotalLCnt, fAngle_Hatching, nLSpacing, bInner);
+        for(auto &hatchingLine : totalHLine)
+        {
+            for(auto &lineCoor : hatchingLine.listLineCoor)
+            {
+                lineCoor.X1 += int(nOriginX);
+                lineCoor.Y1 += int(nOriginY);
+                lineCoor.X2 += int(nOriginX);
+                lineCoor.Y2 += int(nOriginY);
+            }
+        }
+        return;
+    }
+
 //    qDebug() << "pathInner_Temp" << fAngle_Hatching << nLSpacing << outRC << listRc;
 
     // // 根据填充角度计算填充线的起点、方向、步进等参数
@@ -291,6 +322,10 @@ void AlgorithmHatching::calcInnerPoint(const Paths &curPaths, TOTALHATCHINGLINE
     totalHLine.clear();
     qint64 nSerifIndex = -1;
 
+    // 交点列表各填充线复用, 从层内存池分配
+    LayerArenaMark arenaMark;
+    ArenaVector<EXPECTPOINTINFO> listExpectPt;
+
 ////#pragma omp parallel for
     for(; ;)
     {
@@ -330,7 +365,7 @@ void AlgorithmHatching::calcInnerPoint(const Paths &curPaths, TOTALHATCHINGLINE
         fDelta_Y12 = Y1 - Y2; // Y方向分量
 
         // 计算与轮廓的交点
-        QVector<EXPECTPOINTINFO> listExpectPt;
+        listExpectPt.clear();
 
         for(uint iArea = 0; iArea < nAreaCount; iArea ++) // 遍历所有轮廓
         {
@@ -409,7 +444,7 @@ void AlgorithmHatching::calcInnerPoint(const Paths &curPaths, TOTALHATCHINGLINE
                     expectPt.nPtPos = nNextPos;
                     expectPt.X = fPt_X;
                     expectPt.Y = fPt_Y;
-                    listExpectPt << std::move(expectPt);
+                    listExpectPt.push_back(expectPt);
                     nInterPtCnt ++;
 //                    qDebug() << X1 << Y1 << X2 << Y2 << iPt << nNextPos << fRatio;
 //                    qDebug() << expectPt.nAreaIndex << expectPt.nPtPos << expectPt.X << expectPt.Y;
@@ -1225,6 +1260,8 @@ void AlgorithmHatching::drawSpiralPathToScanLine(const Path &path, QVector<SCANL
 ///
 bool AlgorithmHatching::getFirstLine(const int &nX, const int &nY, int *nLine, int *nIndex, TOTALHATCHINGLINE &lpListHLine, bool &bFirstLine)
 {
+    LayerArenaMark arenaMark;   // 距离数组在返回时回收
+
     // 处理第一条线的情况
     if(bFirstLine)
     {
@@ -1256,7 +1293,7 @@ bool AlgorithmHatching::getFirstLine(const int &nX, const int &nY, int *nLine, i
             if(nPointCnt > 0)
             {
                 // 计算到下一行所有线段的距离
-                int *nTempDis = new int[uint(nPointCnt)];
+                ArenaVector<int> nTempDis(size_t(nPointCnt));
                 int nDX = 0, nDY = 0;
 //#pragma omp parallel for
                 for(int iPIndex = 0; iPIndex < nPointCnt; iPIndex ++)
@@ -1275,7 +1312,6 @@ bool AlgorithmHatching::getFirstLine(const int &nX, const int &nY, int *nLine, i
                         *nIndex = iPIndex;
                     }
                 }
-                delete []nTempDis;
             }
         }
 
@@ -1286,7 +1322,7 @@ bool AlgorithmHatching::getFirstLine(const int &nX, const int &nY, int *nLine, i
             int nPointCnt = lpListHLine.at(nLIndex_2).listLineCoor.count();
             if(nPointCnt > 0)
             {
-                int *nTempDis = new int[uint(nPointCnt)];
+                ArenaVector<int> nTempDis(size_t(nPointCnt));
                 int nDX = 0, nDY = 0;
 //#pragma omp parallel for
                 for(int iPIndex = 0; iPIndex < nPointCnt; iPIndex ++)
@@ -1304,7 +1340,6 @@ bool AlgorithmHatching::getFirstLine(const int &nX, const int &nY, int *nLine, i
                         *nIndex = iPIndex;
                     }
                 }
-                delete []nTempDis;
             }
         }
 
@@ -1314,7 +1349,7 @@ bool AlgorithmHatching::getFirstLine(const int &nX, const int &nY, int *nLine, i
             int nPointCnt = lpListHLine.at(*nLine).listLineCoor.count();
             if(nPointCnt > 0)
             {
-                int *nTempDis = new int[uint(nPointCnt)];
+                ArenaVector<int> nTempDis(size_t(nPointCnt));
                 int nDX = 0, nDY = 0;
 //#pragma omp parallel for
                 for(int iPIndex = 0; iPIndex < nPointCnt; iPIndex ++)
@@ -1332,7 +1367,6 @@ bool AlgorithmHatching::getFirstLine(const int &nX, const int &nY, int *nLine, i
                         *nIndex = iPIndex;
                     }
                 }
-                delete []nTempDis;
             }
         }
         // 如果找到最近的线段,返回其位置
@@ -1376,6 +1410,7 @@ bool AlgorithmHatching::getFirstLine(const int &nX, const int &nY, int *nLine, i
 ///
 bool AlgorithmHatching::getNextLine(const int &nX, const int &nY, int *nLine, int *nIndex, TOTALHATCHINGLINE &lpListHLine, const int &nLConneter)
 {
+    LayerArenaMark arenaMark;   // 距离数组在返回时回收
     *nIndex = -1;
     int nDelta = 0x7FFFFFFF;    // 初始化最小距离
     int nLCnt = lpListHLine.count();
@@ -1390,7 +1425,7 @@ bool AlgorithmHatching::getNextLine(const int &nX, const int &nY, int *nLine, in
         if(nPointCnt > 0)
         {
             // 计算到下一行所有线段的距离
-            int *nTempDis = new int[uint(nPointCnt)];
+            ArenaVector<int> nTempDis(size_t(nPointCnt));
             int nDX = 0, nDY = 0;
 //#pragma omp parallel for
             for(int iPIndex = 0; iPIndex < nPointCnt; iPIndex ++)
@@ -1409,7 +1444,6 @@ bool AlgorithmHatching::getNextLine(const int &nX, const int &nY, int *nLine, in
                     *nIndex = iPIndex;
                 }
             }
-            delete []nTempDis;
         }
     }
     // 搜索上一行(逻辑同上)
@@ -1419,7 +1453,7 @@ bool AlgorithmHatching::getNextLine(const int &nX, const int &nY, int *nLine, in
         int nPointCnt = lpListHLine.at(nLIndex_2).listLineCoor.count();
         if(nPointCnt > 0)
         {
-            int *nTempDis = new int[uint(nPointCnt)];
+            ArenaVector<int> nTempDis(size_t(nPointCnt));
             int nDX = 0, nDY = 0;
 //#pragma omp parallel for
             for(int iPIndex = 0; iPIndex < nPointCnt; iPIndex ++)
@@ -1437,7 +1471,6 @@ bool AlgorithmHatching::getNextLine(const int &nX, const int &nY, int *nLine, in
                     *nIndex = iPIndex;
                 }
             }
-            delete []nTempDis;
         }
     }
     // 如果找到合适的线段,返回其位置
@@ -1,4 +1,5 @@
 #include "algorithmhatchingring.h"
+#include "layerarena.h"
 #include "slaprocessorextend.h"
 #include "UTSLAProcessor_global.h"
 #include "uspfiledef.h"
@@ -1533,6 +1534,7 @@ void PocketBranch::calcNodeWndPos(const double &powDis)
 void PocketBranch::calcNodeWndPos(PocketNode &curNode, PocketNode &biggerNode, 
                                  const double &powDis, const bool &minCircle)
 {
+    LayerArenaMark arenaMark;   // 线段长度数组在返回时回收
     Path &smaller = curNode.circle;
     Path &bigger = biggerNode.circle;
     
@@ -1549,7 +1551,7 @@ void PocketBranch::calcNodeWndPos(PocketNode &curNode, PocketNode &biggerNode,
     if(minCircle)
     {
         // 计算外层轮廓每段线段的长度
-        double *fDisBigger = new double[nBigSz];
+        ArenaVector<double> fDisBigger(nBigSz);
         for(uint iPos = 0, jPos = nBigSz - 1; iPos < nBigSz; ++ iPos)
         {
             fDisBigger[iPos] = sqrt((pow((bigger[jPos].X - bigger[iPos].X), 2) +
@@ -1609,6 +1611,7 @@ void PocketBranch::calcNodeWndPos(PocketNode &curNode, PocketNode &biggerNode,
 /// 4. 更新主轮廓的窗口信息
 void PocketBranch::calcBranchWndPos(PocketNode &curNode, PocketNode &biggerNode, const double &powDis, const int &index)
 {
+    LayerArenaMark arenaMark;   // 线段长度数组在返回时回收
     Path &smaller = curNode.circle;     // 分支轮廓
     Path &bigger = biggerNode.circle;   // 主轮廓
 
@@ -1623,7 +1626,7 @@ void PocketBranch::calcBranchWndPos(PocketNode &curNode, PocketNode &biggerNode,
     uint nSmallSz = smaller.size();
 
     // 1. 计算主轮廓每段线段的长度
-    double *fDisBigger = new double[nBigSz];
+    ArenaVector<double> fDisBigger(nBigSz);
     for(uint iPos = 0, jPos = nBigSz - 1; iPos < nBigSz; ++ iPos)
     {
         fDisBigger[iPos] = sqrt((pow((bigger[jPos].X - bigger[iPos].X), 2) +
@@ -1702,7 +1705,6 @@ void PocketBranch::calcBranchWndPos(PocketNode &curNode, PocketNode &biggerNode,
         jPos = iPos;
     }
     qDebug() << "Branch fMinDis----0-0" << fMinDis;
-    delete []fDisBigger;
     // 3. 更新分支节点的窗口信息
     curNode.ringWndInfo.tempWnd.nWndBegin = nBeginPos;
     uint insertedPos = calcEndingPos(smaller, curNode.ringWndInfo.tempWnd.nWndBegin, curNode.ringWndInfo.tempWnd.nWndEnd1, powDis);
@@ -0,0 +1,407 @@
+#include "jobarchiver.h"
+
+#include <QTemporaryFile>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFuture>
+#include <QtConcurrent>
+#include <QDebug>
+
+#include <random>
+#include <vector>
+
+#ifdef Q_OS_WIN
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+#define ARCHIVE_BUFSIZE     (4 * 1024 * 1024)
+#define ZIP64_LIMIT         0xFFFFFFFFLL
+#define ZIP_ENCRYPTHEADSIZE 12
+
+struct JobArchiver::ArchiveEntry {
+    QString _fileName;
+    QByteArray _entryName;
+    QFuture<void> _future;
+    QSharedPointer<QTemporaryFile> _dataFile;   // 压缩后的原始 deflate 数据, 存储方式时为空
+    quint16 _method = Z_DEFLATED;               // 压缩方式, 0 为存储
+    quint32 _crc = 0;
+    qint64 _size = 0;
+    qint64 _compressedSize = 0;
+    quint16 _dosTime = 0;
+    quint16 _dosDate = 0;
+    bool _succeed = false;
+};
+
+namespace {
+template<typename T>
+inline void appendValue(QByteArray &buf, const T &value)
+{
+    for (size_t i = 0; i < sizeof(T); ++ i)
+    {
+        buf.append(char((quint64(value) >> (i * 8)) & 0xFF));
+    }
+}
+
+///
+/// @brief PKWARE 传统加密
+///
+class ZipCrypto
+{
+public:
+    explicit ZipCrypto(const char *password) {
+        for (const char *p = password; p && *p; ++ p) updateKeys(quint8(*p));
+    }
+
+    inline void encrypt(char *data, const qint64 &size) {
+        for (qint64 i = 0; i < size; ++ i)
+        {
+            const quint8 plain = quint8(data[i]);
+            data[i] = char(plain ^ streamByte());
+            updateKeys(plain);
+        }
+    }
+
+private:
+    inline quint8 streamByte() const {
+        const quint32 temp = (_keys[2] | 2) & 0xFFFF;
+        return quint8((temp * (temp ^ 1)) >> 8);
+    }
+    inline void updateKeys(const quint8 &c) {
+        const auto *crcTable = get_crc_table();
+        _keys[0] = quint32(crcTable[(_keys[0] ^ c) & 0xFF]) ^ (_keys[0] >> 8);
+        _keys[1] = (_keys[1] + (_keys[0] & 0xFF)) * 134775813 + 1;
+        _keys[2] = quint32(crcTable[(_keys[2] ^ (_keys[1] >> 24)) & 0xFF]) ^ (_keys[2] >> 8);
+    }
+
+private:
+    quint32 _keys[3] = { 305419896, 591751049, 878082192 };
+};
+
+inline bool isZip64(const qint64 &size, const qint64 &compressedSize)
+{
+    return size >= ZIP64_LIMIT || compressedSize >= ZIP64_LIMIT;
+}
+}
+
+JobArchiver::~JobArchiver()
+{
+    clear();
+}
+
+///
+/// @brief 提交文件, 立即在线程池中开始压缩
+/// @param fileName [in] 已写完的文件, 提交后直到 createFilesZip 完成前不可修改或删除
+/// @param bStored [in] 按存储方式写入, 用于已压缩的文件, 避免重复 deflate
+///
+void JobArchiver::addFile(const QString &fileName, const bool &bStored)
+{
+    submitEntry(fileName, bStored);
+}
+
+///
+/// @brief 生成压缩包
+/// @param zipName [in] 压缩包路径
+/// @param listFile [in] 条目文件列表, 未提交过的文件在此提交并压缩
+/// @param password [in] 密码, nullptr 为不加密
+/// @param comment [in] 压缩包注释
+/// @return 全部条目压缩成功且写入成功时返回 true
+/// @details 实现步骤:
+///   1. 提交未压缩的文件, 等待全部条目压缩完成
+///   2. 按列表顺序写入本地文件头及压缩数据, 加密在写入时逐块完成
+///   3. 写入中央目录及目录结束记录, 需要时写入 ZIP64 记录
+///   4. 移除已写入条目的临时数据
+///
+bool JobArchiver::createFilesZip(const QString &zipName, const QStringList &listFile, const char *password,
+                                 const QByteArray &comment)
+{
+    std::vector<ArchiveEntryPtr> entryVec;
+    for (const auto &fileName : listFile)
+    {
+        entryVec.push_back(submitEntry(fileName, false));
+    }
+    bool bSucceed = true;
+    for (const auto &entry : entryVec)
+    {
+        entry->_future.waitForFinished();
+        bSucceed = bSucceed && entry->_succeed;
+    }
+
+    QFile file(zipName);
+    if (bSucceed) bSucceed = file.open(QIODevice::WriteOnly);
+    const bool bEncrypt = password && *password;
+
+    QByteArray centralDir;
+    for (size_t i = 0; bSucceed && i < entryVec.size(); ++ i)
+    {
+        auto entry = entryVec[i].data();
+        const qint64 offset = file.pos();
+        const qint64 storedSize = entry->_compressedSize + (bEncrypt ? ZIP_ENCRYPTHEADSIZE : 0);
+        const bool bZip64 = isZip64(entry->_size, storedSize);
+        const bool bOffset64 = offset >= ZIP64_LIMIT;
+        const quint16 flags = bEncrypt ? 0x1 : 0x0;
+        const quint16 version = (bZip64 || bOffset64) ? 45 : 20;
+
+        // 本地文件头
+        QByteArray header;
+        appendValue(header, quint32(0x04034B50));
+        appendValue(header, version);
+        appendValue(header, flags);
+        appendValue(header, entry->_method);
+        appendValue(header, entry->_dosTime);
+        appendValue(header, entry->_dosDate);
+        appendValue(header, entry->_crc);
+        appendValue(header, quint32(bZip64 ? ZIP64_LIMIT : storedSize));
+        appendValue(header, quint32(bZip64 ? ZIP64_LIMIT : entry->_size));
+        appendValue(header, quint16(entry->_entryName.size()));
+        appendValue(header, quint16(bZip64 ? 20 : 0));
+        header.append(entry->_entryName);
+        if (bZip64)
+        {
+            appendValue(header, quint16(0x0001));
+            appendValue(header, quint16(16));
+            appendValue(header, quint64(entry->_size));
+            appendValue(header, quint64(storedSize));
+        }
+        bSucceed = (file.write(header) == header.size()) && writeEntryData(&file, entry, bEncrypt ? password : nullptr);
+
+        // 中央目录项
+        QByteArray extra;
+        if (bZip64 || bOffset64)
+        {
+            QByteArray extraData;
+            if (bZip64)
+            {
+                appendValue(extraData, quint64(entry->_size));
+                appendValue(extraData, quint64(storedSize));
+            }
+            if (bOffset64) appendValue(extraData, quint64(offset));
+            appendValue(extra, quint16(0x0001));
+            appendValue(extra, quint16(extraData.size()));
+            extra.append(extraData);
+        }
+        appendValue(centralDir, quint32(0x02014B50));
+        appendValue(centralDir, version);
+        appendValue(centralDir, version);
+        appendValue(centralDir, flags);
+        appendValue(centralDir, entry->_method);
+        appendValue(centralDir, entry->_dosTime);
+        appendValue(centralDir, entry->_dosDate);
+        appendValue(centralDir, entry->_crc);
+        appendValue(centralDir, quint32(bZip64 ? ZIP64_LIMIT : storedSize));
+        appendValue(centralDir, quint32(bZip64 ? ZIP64_LIMIT : entry->_size));
+        appendValue(centralDir, quint16(entry->_entryName.size()));
+        appendValue(centralDir, quint16(extra.size()));
+        appendValue(centralDir, quint16(0));
+        appendValue(centralDir, quint16(0));
+        appendValue(centralDir, quint16(0));
+        appendValue(centralDir, quint32(0x20));
+        appendValue(centralDir, quint32(bOffset64 ? ZIP64_LIMIT : offset));
+        centralDir.append(entry->_entryName);
+        centralDir.append(extra);
+    }
+
+    if (bSucceed)
+    {
+        const qint64 centralOffset = file.pos();
+        const qint64 entryCnt = qint64(entryVec.size());
+        const bool bZip64End = centralOffset >= ZIP64_LIMIT || entryCnt >= 0xFFFF;
+
+        QByteArray endRecord;
+        if (bZip64End)
+        {
+            const qint64 zip64EndOffset = centralOffset + centralDir.size();
+            appendValue(endRecord, quint32(0x06064B50));
+            appendValue(endRecord, quint64(44));
+            appendValue(endRecord, quint16(45));
+            appendValue(endRecord, quint16(45));
+            appendValue(endRecord, quint32(0));
+            appendValue(endRecord, quint32(0));
+            appendValue(endRecord, quint64(entryCnt));
+            appendValue(endRecord, quint64(entryCnt));
+            appendValue(endRecord, quint64(centralDir.size()));
+            appendValue(endRecord, quint64(centralOffset));
+
+            appendValue(endRecord, quint32(0x07064B50));
+            appendValue(endRecord, quint32(0));
+            appendValue(endRecord, quint64(zip64EndOffset));
+            appendValue(endRecord, quint32(1));
+        }
+
+        const QByteArray zipComment = comment.left(0xFFFF);
+        appendValue(endRecord, quint32(0x06054B50));
+        appendValue(endRecord, quint16(0));
+        appendValue(endRecord, quint16(0));
+        appendValue(endRecord, quint16(bZip64End ? 0xFFFF : entryCnt));
+        appendValue(endRecord, quint16(bZip64End ? 0xFFFF : entryCnt));
+        appendValue(endRecord, quint32(centralDir.size()));
+        appendValue(endRecord, quint32(bZip64End ? ZIP64_LIMIT : centralOffset));
+        appendValue(endRecord, quint16(zipComment.size()));
+        endRecord.append(zipComment);
+
+        bSucceed = (file.write(centralDir) == centralDir.size()) && (file.write(endRecord) == endRecord.size());
+    }
+    if (file.isOpen()) file.close();
+    if (false == bSucceed)
+    {
+        qDebug() << "JobArchiver create zip failed" << zipName;
+        file.remove();
+    }
+
+    QMutexLocker locker(&_locker);
+    for (const auto &fileName : listFile)
+    {
+        _entryHash.remove(fileName);
+    }
+    return bSucceed;
+}
+
+///
+/// @brief 等待全部压缩任务结束并释放临时数据
+///
+void JobArchiver::clear()
+{
+    QMutexLocker locker(&_locker);
+    for (const auto &entry : qAsConst(_entryHash))
+    {
+        entry->_future.waitForFinished();
+    }
+    _entryHash.clear();
+}
+
+///
+/// @brief 提交条目, 已提交的文件直接返回原条目
+/// @param bStored [in] 按存储方式写入
+///
+JobArchiver::ArchiveEntryPtr JobArchiver::submitEntry(const QString &fileName, const bool &bStored)
+{
+    QMutexLocker locker(&_locker);
+    auto &entry = _entryHash[fileName];
+    if (entry) return entry;
+
+    entry = ArchiveEntryPtr(new ArchiveEntry);
+    entry->_fileName = fileName;
+    entry->_method = bStored ? 0 : Z_DEFLATED;
+    entry->_entryName = QFileInfo(fileName).fileName().toLocal8Bit();
+
+    const auto lastModified = QFileInfo(fileName).lastModified();
+    const auto date = lastModified.date();
+    const auto time = lastModified.time();
+    entry->_dosDate = quint16(((qMax(date.year(), 1980) - 1980) << 9) | (date.month() << 5) | date.day());
+    entry->_dosTime = quint16((time.hour() << 11) | (time.minute() << 5) | (time.second() >> 1));
+
+    auto entryPtr = entry.data();
+    entry->_future = QtConcurrent::run([entryPtr]() { compressEntry(entryPtr); });
+    return entry;
+}
+
+///
+/// @brief 压缩单个条目
+/// @details 分块读取源文件, 同时计算 CRC32 并以原始 deflate 格式写入临时文件, 内存占用与文件大小无关;
+///   存储方式只计算 CRC32, 写入时从源文件拷贝
+///
+void JobArchiver::compressEntry(ArchiveEntry *entry)
+{
+    QFile srcFile(entry->_fileName);
+    if (false == srcFile.open(QIODevice::ReadOnly)) return;
+
+    if (0 == entry->_method)
+    {
+        std::vector<char> buf(ARCHIVE_BUFSIZE);
+        uLong crc = crc32(0L, Z_NULL, 0);
+        qint64 readSz = 0;
+        while ((readSz = srcFile.read(buf.data(), qint64(buf.size()))) > 0)
+        {
+            crc = crc32(crc, reinterpret_cast<const Bytef *>(buf.data()), uInt(readSz));
+            entry->_size += readSz;
+        }
+        entry->_crc = quint32(crc);
+        entry->_compressedSize = entry->_size;
+        entry->_succeed = readSz >= 0;
+        return;
+    }
+
+    entry->_dataFile = QSharedPointer<QTemporaryFile>(new QTemporaryFile(entry->_fileName + ".XXXXXX.ztmp"));
+    if (false == entry->_dataFile->open()) return;
+
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    if (Z_OK != deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY)) return;
+
+    std::vector<char> inBuf(ARCHIVE_BUFSIZE);
+    std::vector<char> outBuf(ARCHIVE_BUFSIZE);
+    uLong crc = crc32(0L, Z_NULL, 0);
+    bool bSucceed = true;
+    int flush = Z_NO_FLUSH;
+    while (bSucceed && Z_FINISH != flush)
+    {
+        const qint64 readSz = srcFile.read(inBuf.data(), qint64(inBuf.size()));
+        if (readSz < 0) { bSucceed = false; break; }
+        flush = srcFile.atEnd() ? Z_FINISH : Z_NO_FLUSH;
+
+        crc = crc32(crc, reinterpret_cast<const Bytef *>(inBuf.data()), uInt(readSz));
+        entry->_size += readSz;
+
+        stream.next_in = reinterpret_cast<Bytef *>(inBuf.data());
+        stream.avail_in = uInt(readSz);
+        do {
+            stream.next_out = reinterpret_cast<Bytef *>(outBuf.data());
+            stream.avail_out = uInt(outBuf.size());
+            if (Z_STREAM_ERROR == deflate(&stream, flush)) { bSucceed = false; break; }
+
+            const qint64 outSz = qint64(outBuf.size()) - stream.avail_out;
+            if (entry->_dataFile->write(outBuf.data(), outSz) != outSz) { bSucceed = false; break; }
+            entry->_compressedSize += outSz;
+        } while (0 == stream.avail_out);
+    }
+    deflateEnd(&stream);
+
+    entry->_crc = quint32(crc);
+    entry->_succeed = bSucceed && entry->_dataFile->flush();
+}
+
+///
+/// @brief 写入条目的压缩数据
+/// @param password [in] 非空时先写入12字节加密头, 数据逐块加密
+/// @details 存储方式的条目直接读取源文件
+///
+bool JobArchiver::writeEntryData(QIODevice *device, ArchiveEntry *entry, const char *password)
+{
+    QSharedPointer<ZipCrypto> crypto;
+    if (password)
+    {
+        crypto = QSharedPointer<ZipCrypto>(new ZipCrypto(password));
+
+        std::random_device randomDevice;
+        char encryptHead[ZIP_ENCRYPTHEADSIZE];
+        for (int i = 0; i < ZIP_ENCRYPTHEADSIZE - 1; ++ i) encryptHead[i] = char(randomDevice() & 0xFF);
+        encryptHead[ZIP_ENCRYPTHEADSIZE - 1] = char((entry->_crc >> 24) & 0xFF);
+        crypto->encrypt(encryptHead, ZIP_ENCRYPTHEADSIZE);
+        if (device->write(encryptHead, ZIP_ENCRYPTHEADSIZE) != ZIP_ENCRYPTHEADSIZE) return false;
+    }
+
+    QFile srcFile(entry->_fileName);
+    QIODevice *dataFile = entry->_dataFile.data();
+    if (0 == entry->_method)
+    {
+        if (false == srcFile.open(QIODevice::ReadOnly)) return false;
+        dataFile = &srcFile;
+    }
+    if (nullptr == dataFile || false == dataFile->seek(0)) return false;
+
+    std::vector<char> buf(ARCHIVE_BUFSIZE);
+    qint64 leftSz = entry->_compressedSize;
+    while (leftSz > 0)
+    {
+        const qint64 readSz = dataFile->read(buf.data(), qMin(leftSz, qint64(buf.size())));
+        if (readSz <= 0) return false;
+        if (crypto) crypto->encrypt(buf.data(), readSz);
+        if (device->write(buf.data(), readSz) != readSz) return false;
+        leftSz -= readSz;
+    }
+    entry->_dataFile.clear();
+    return true;
+}
@@ -0,0 +1,40 @@
+#ifndef JOBARCHIVER_H
+#define JOBARCHIVER_H
+
+#include <QSharedPointer>
+#include <QStringList>
+#include <QMutex>
+#include <QHash>
+
+///
+/// ! @coreclass{JobArchiver}
+/// 作业文件打包, 输出标准 ZIP(deflate), 与 ZipLib 生成的压缩包格式一致
+/// @details 各条目在全局线程池中独立压缩到临时文件, 零件文件生成后即可提交, 与后续零件的处理重叠;
+///   生成压缩包时按列表顺序拼接已压缩数据并写入目录, 不再重复压缩;
+///   已压缩的文件(如内层 .job 压缩包)可按存储方式提交, 只计算 CRC, 写入时直接拷贝源文件;
+///   设置密码时使用 PKWARE 传统加密, 超过 4G 的条目自动使用 ZIP64 扩展
+///
+class JobArchiver
+{
+public:
+    JobArchiver() = default;
+    ~JobArchiver();
+
+    void addFile(const QString &, const bool &bStored = false);
+    bool createFilesZip(const QString &, const QStringList &, const char *password, const QByteArray &comment);
+    void clear();
+
+private:
+    struct ArchiveEntry;
+    typedef QSharedPointer<ArchiveEntry> ArchiveEntryPtr;
+
+    ArchiveEntryPtr submitEntry(const QString &, const bool &);
+    static void compressEntry(ArchiveEntry *);
+    static bool writeEntryData(QIODevice *, ArchiveEntry *, const char *);
+
+private:
+    QMutex _locker;
+    QHash<QString, ArchiveEntryPtr> _entryHash;
+};
+
+#endif // JOBARCHIVER_H
@@ -0,0 +1,196 @@
+#include "layerarena.h"
+
+#include <QMutex>
+#include <cstdlib>
+
+namespace {
+struct ThreadArena {
+    LayerArena _arena;
+    int _depth = 0;
+    bool _enabled = false;
+};
+
+ThreadArena &threadArena()
+{
+    static thread_local ThreadArena arena;
+    return arena;
+}
+
+QMutex gTotalLocker;
+LayerArenaStats gTotalStats;
+}
+
+LayerArenaStats &LayerArenaStats::operator+=(const LayerArenaStats &rhs)
+{
+    nAllocCnt += rhs.nAllocCnt;
+    nAllocBytes += rhs.nAllocBytes;
+    nBlockCnt += rhs.nBlockCnt;
+    nResetCnt += rhs.nResetCnt;
+    nPeakBytes = qMax(nPeakBytes, rhs.nPeakBytes);
+    nCapacity += rhs.nCapacity;
+    return *this;
+}
+
+LayerArena::LayerArena(const size_t &blockSize, const size_t &retainSize) :
+    _blockSize(blockSize), _retainSize(retainSize)
+{
+}
+
+LayerArena::~LayerArena()
+{
+    release();
+}
+
+///
+/// @brief 分配内存
+/// @param size [in] 字节数
+/// @param align [in] 对齐, 须为2的幂
+/// @details 实现步骤:
+///   1. 在当前块内按对齐移动偏移, 放得下则直接返回
+///   2. 依次尝试后续已保留的块
+///   3. 均放不下时新申请一块并在其中分配, 超过默认块大小的请求单独成块
+///
+void *LayerArena::allocate(const size_t &size, const size_t &align)
+{
+    ++ _stats.nAllocCnt;
+    _stats.nAllocBytes += qint64(size);
+
+    for (;;)
+    {
+        while (_curBlock < _blocks.size())
+        {
+            const Block &block = _blocks[_curBlock];
+            const size_t base = reinterpret_cast<size_t>(block._data);
+            const size_t begin = ((base + _offset + align - 1) & ~(align - 1)) - base;
+            if (begin + size <= block._size)
+            {
+                _usedBytes += begin + size - _offset;
+                _offset = begin + size;
+                _stats.nPeakBytes = qMax(_stats.nPeakBytes, qint64(_usedBytes));
+                return block._data + begin;
+            }
+            ++ _curBlock;
+            _offset = 0;
+        }
+
+        Block block;
+        block._size = qMax(_blockSize, size + align);
+        block._data = static_cast<char *>(std::malloc(block._size));
+        if (nullptr == block._data) throw std::bad_alloc();
+        _blocks.push_back(block);
+        _curBlock = _blocks.size() - 1;
+        _offset = 0;
+        ++ _stats.nBlockCnt;
+        _stats.nCapacity += qint64(block._size);
+    }
+}
+
+///
+/// @brief 记录当前分配位置
+///
+LayerArena::Marker LayerArena::mark() const
+{
+    Marker marker;
+    marker._curBlock = _curBlock;
+    marker._offset = _offset;
+    marker._usedBytes = _usedBytes;
+    return marker;
+}
+
+///
+/// @brief 回退到 mark 记录的位置, 之后分配的内存供后续分配复用
+/// @details 期间新申请的内存块保留在块列表中, 不释放
+///
+void LayerArena::rewind(const Marker &marker)
+{
+    _curBlock = marker._curBlock;
+    _offset = marker._offset;
+    _usedBytes = marker._usedBytes;
+}
+
+///
+/// @brief 回收全部分配, 保留不超过 retainSize 的内存块供下一层使用
+///
+void LayerArena::reset()
+{
+    size_t capacity = size_t(_stats.nCapacity);
+    while (_blocks.size() > 1 && capacity > _retainSize)
+    {
+        capacity -= _blocks.back()._size;
+        std::free(_blocks.back()._data);
+        _blocks.pop_back();
+    }
+    _stats.nCapacity = qint64(capacity);
+    _curBlock = 0;
+    _offset = 0;
+    _usedBytes = 0;
+    ++ _stats.nResetCnt;
+}
+
+void LayerArena::release()
+{
+    for (const auto &block : _blocks) std::free(block._data);
+    _blocks.clear();
+    _stats.nCapacity = 0;
+    _curBlock = 0;
+    _offset = 0;
+    _usedBytes = 0;
+}
+
+///
+/// @brief 当前线程处于启用的作用域内时返回其内存池, 否则返回空
+///
+LayerArena *LayerArena::current()
+{
+    ThreadArena &arena = threadArena();
+    return (arena._depth > 0 && arena._enabled) ? &arena._arena : nullptr;
+}
+
+LayerArenaStats LayerArena::totalStats()
+{
+    QMutexLocker locker(&gTotalLocker);
+    return gTotalStats;
+}
+
+void LayerArena::clearTotalStats()
+{
+    QMutexLocker locker(&gTotalLocker);
+    gTotalStats = LayerArenaStats();
+}
+
+LayerArenaMark::LayerArenaMark() : _arena(LayerArena::current())
+{
+    if (_arena) _marker = _arena->mark();
+}
+
+LayerArenaMark::~LayerArenaMark()
+{
+    if (_arena) _arena->rewind(_marker);
+}
+
+LayerArenaScope::LayerArenaScope(const bool &enable)
+{
+    ThreadArena &arena = threadArena();
+    if (0 == arena._depth ++) arena._enabled = enable;
+}
+
+///
+/// @brief 最外层作用域结束: 汇总本层统计并重置内存池
+///
+LayerArenaScope::~LayerArenaScope()
+{
+    ThreadArena &arena = threadArena();
+    if (-- arena._depth > 0 || false == arena._enabled) return;
+
+    arena._enabled = false;
+    arena._arena.reset();
+    LayerArenaStats &stats = arena._arena._stats;
+    {
+        QMutexLocker locker(&gTotalLocker);
+        const qint64 nCapacity = stats.nCapacity;
+        stats.nCapacity = 0;
+        gTotalStats += stats;
+        stats = LayerArenaStats();
+        stats.nCapacity = nCapacity;
+    }
+}
@@ -0,0 +1,211 @@
+#ifndef LAYERARENA_H
+#define LAYERARENA_H
+
+#include <QtGlobal>
+#include <QSharedPointer>
+#include <memory>
+#include <new>
+#include <vector>
+#include <utility>
+
+///
+/// @brief 层内存池分配统计
+///
+struct LayerArenaStats {
+    qint64 nAllocCnt = 0;       // 分配次数
+    qint64 nAllocBytes = 0;     // 分配字节数
+    qint64 nBlockCnt = 0;       // 向系统申请内存块次数
+    qint64 nResetCnt = 0;       // 重置次数(处理层数)
+    qint64 nPeakBytes = 0;      // 单层使用峰值
+    qint64 nCapacity = 0;       // 当前持有的内存块总大小, 仅单个内存池有效
+
+    LayerArenaStats &operator+=(const LayerArenaStats &rhs);
+};
+
+///
+/// ! @coreclass{LayerArena}
+/// 单线程单调内存池
+/// @details 按块向系统申请内存, 分配只移动偏移, 释放为空操作, reset 时整体回收.
+///   每个线程持有一个实例, 仅在 LayerArenaScope 有效期内通过 current() 对外提供;
+///   从内存池分配的对象不得超出所在层处理的作用域
+///
+class LayerArena
+{
+public:
+    enum {
+        DefaultBlockSize = 1 << 20,     // 1MB
+        DefaultRetainSize = 32 << 20,   // 重置后最多保留 32MB
+    };
+
+    explicit LayerArena(const size_t &blockSize = DefaultBlockSize, const size_t &retainSize = DefaultRetainSize);
+    ~LayerArena();
+    LayerArena(const LayerArena &) = delete;
+    LayerArena &operator=(const LayerArena &) = delete;
+
+    struct Marker {
+        size_t _curBlock = 0;
+        size_t _offset = 0;
+        size_t _usedBytes = 0;
+    };
+
+    void *allocate(const size_t &, const size_t &);
+    Marker mark() const;
+    void rewind(const Marker &);
+    void reset();
+    void release();
+
+    inline const LayerArenaStats &stats() const { return _stats; }
+    inline size_t usedBytes() const { return _usedBytes; }
+
+    static LayerArena *current();
+    static LayerArenaStats totalStats();
+    static void clearTotalStats();
+
+private:
+    struct Block {
+        char *_data = nullptr;
+        size_t _size = 0;
+    };
+
+    std::vector<Block> _blocks;
+    size_t _curBlock = 0;
+    size_t _offset = 0;
+    size_t _usedBytes = 0;
+    size_t _blockSize = DefaultBlockSize;
+    size_t _retainSize = DefaultRetainSize;
+    LayerArenaStats _stats;
+
+    friend class LayerArenaScope;
+};
+
+///
+/// @brief 层内存池作用域
+/// @details 在层处理入口构造, 当前线程在作用域内经 LayerArena::current() 使用内存池;
+///   可嵌套, 以最外层的启用状态为准, 最外层析构时汇总统计并重置内存池.
+///   未启用时 current() 返回空, 各分配点退回默认堆分配
+///
+class LayerArenaScope
+{
+public:
+    explicit LayerArenaScope(const bool &enable);
+    ~LayerArenaScope();
+    LayerArenaScope(const LayerArenaScope &) = delete;
+    LayerArenaScope &operator=(const LayerArenaScope &) = delete;
+};
+
+///
+/// @brief 临时分配作用域
+/// @details 构造时记录当前线程内存池的分配位置, 析构时回退, 用于单次调用内的临时数组,
+///   避免逐次调用的临时分配在层结束前累积; 作用域内分配的对象不得超出其有效期.
+///   不在 LayerArenaScope 内时不做处理
+///
+class LayerArenaMark
+{
+public:
+    LayerArenaMark();
+    ~LayerArenaMark();
+    LayerArenaMark(const LayerArenaMark &) = delete;
+    LayerArenaMark &operator=(const LayerArenaMark &) = delete;
+
+private:
+    LayerArena *_arena = nullptr;
+    LayerArena::Marker _marker;
+};
+
+///
+/// @brief 内存池分配器, 用于标准容器
+/// @details 构造时绑定当前线程的内存池, 不在作用域内时使用默认堆分配
+///
+template<class T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    ArenaAllocator() : _arena(LayerArena::current()) {}
+    explicit ArenaAllocator(LayerArena *arena) : _arena(arena) {}
+    template<class U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : _arena(other.arena()) {}
+
+    T *allocate(const size_t n) {
+        if (_arena) return static_cast<T *>(_arena->allocate(n * sizeof(T), alignof(T)));
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T *p, const size_t) {
+        if (nullptr == _arena) ::operator delete(p);
+    }
+
+    inline LayerArena *arena() const { return _arena; }
+
+private:
+    LayerArena *_arena = nullptr;
+};
+
+template<class T, class U>
+inline bool operator==(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) {
+    return lhs.arena() == rhs.arena();
+}
+
+template<class T, class U>
+inline bool operator!=(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) {
+    return lhs.arena() != rhs.arena();
+}
+
+template<class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+///
+/// @brief 内存池对象删除器
+/// @details 对象位于内存池时只调用析构函数, 内存随层结束统一回收; 否则 delete
+///
+class ArenaDeleter
+{
+public:
+    explicit ArenaDeleter(const bool &inArena = false) : _inArena(inArena) {}
+
+    template<class T>
+    void operator()(T *ptr) const {
+        if (_inArena) ptr->~T();
+        else delete ptr;
+    }
+
+private:
+    bool _inArena = false;
+};
+
+template<class T>
+using ArenaUniquePtr = std::unique_ptr<T, ArenaDeleter>;
+
+///
+/// @brief 在当前线程内存池中创建独占对象
+/// @details 对象本身是唯一的分配, 没有引用计数控制块; 不在作用域内时等同于 new
+///
+template<class T, class... Args>
+ArenaUniquePtr<T> arenaMakeUnique(Args &&... args)
+{
+    if (LayerArena *arena = LayerArena::current())
+    {
+        void *mem = arena->allocate(sizeof(T), alignof(T));
+        return ArenaUniquePtr<T>(new (mem) T(std::forward<Args>(args)...), ArenaDeleter(true));
+    }
+    return ArenaUniquePtr<T>(new T(std::forward<Args>(args)...), ArenaDeleter(false));
+}
+
+///
+/// @brief 在当前线程内存池中创建共享对象
+/// @details 删除器只调用析构函数, 内存随层结束统一回收; 不在作用域内时等同于 new.
+///   QSharedPointer 的引用计数控制块仍由堆分配, 只用于需要弱引用的对象(如排序端点 MPtInfo),
+///   独占所有权的对象使用 arenaMakeUnique
+///
+template<class T, class... Args>
+QSharedPointer<T> arenaCreate(Args &&... args)
+{
+    if (LayerArena *arena = LayerArena::current())
+    {
+        void *mem = arena->allocate(sizeof(T), alignof(T));
+        return QSharedPointer<T>(new (mem) T(std::forward<Args>(args)...), [](T *ptr) { ptr->~T(); });
+    }
+    return QSharedPointer<T>(new T(std::forward<Args>(args)...));
+}
+
+#endif // LAYERARENA_H
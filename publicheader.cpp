@@ -1,6 +1,10 @@
 #include "publicheader.h"
 
 #include <QThread>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QDir>
+#include <cstring>
 
 void writeData(QFile *, void *, const int &);
 ///
@@ -35,112 +39,477 @@ void writeData32(QFile *lpFile, qint32 nData)
     writeData(lpFile, &nData, 4);
 }
 
+void writeData64(QFile *lpFile, qint64 nData)
+{
+    writeData(lpFile, &nData, 8);
+}
+
+namespace {
+template<typename T>
+inline void appendValue(QByteArray &buf, const T &value)
+{
+    buf.append(reinterpret_cast<const char *>(&value), int(sizeof(T)));
+}
+
+///
+/// @brief 输出已收集的标记线
+/// @details 数量大于4时使用 MARKLOOP 格式, 否则逐条写入
+///
+inline void appendMarkLines(QByteArray &buf, const ScanVectorView &view, QVector<int> &markIndexVec)
+{
+    const int nMarkSLineCnt = markIndexVec.count();
+    if(nMarkSLineCnt < 1) return;
+
+    if(nMarkSLineCnt > 4)
+    {
+        appendValue(buf, qint8(SECTION_SCANTYPE_MARKLOOP));
+        appendValue(buf, qint32(nMarkSLineCnt));
+        for(const auto &index : qAsConst(markIndexVec))
+        {
+            appendValue(buf, view.x(index));
+            appendValue(buf, view.y(index));
+        }
+    }
+    else
+    {
+        for(const auto &index : qAsConst(markIndexVec))
+        {
+            appendValue(buf, view.type(index));
+            appendValue(buf, view.x(index));
+            appendValue(buf, view.y(index));
+        }
+    }
+    markIndexVec.clear();
+}
+}
+
 ///
 /// @brief 将扫描线数据写入文件
 /// @param lpFile 输出文件指针
-/// @param listSLines 扫描线数据列表
-/// @details 实现步骤:
-///   1. 遍历扫描线列表
-///   2. 区分跳转和标记线段
-///   3. 对标记线段进行优化存储
-///   4. 按不同格式写入文件
+/// @param listSLines 扫描线数据列表, 写入后清空
 ///
 void writeScanLines(QFile *lpFile, QVector<SCANLINE> &listSLines)
 {
+    writeScanLines(lpFile, ScanVectorView::fromScanLines(listSLines));
+    listSLines.clear();
+}
+
+///
+/// @brief 将扫描线数据写入文件
+/// @param lpFile 输出文件指针
+/// @param view 扫描线视图
+/// @details 实现步骤:
+///   1. 遍历扫描线
+///   2. 区分跳转和标记线段, 跳过与上一点重合的线段
+///   3. 连续标记线段数量大于4时使用 MARKLOOP 格式
+///   4. 整块编码后一次写入文件
+///
+void writeScanLines(QFile *lpFile, const ScanVectorView &view)
+{
+    const int nLineCnt = view.size();
+    if(nLineCnt < 1) return;
+
     // 记录上一个点的坐标
     int nLastX = -1, nLastY = -1;
-    int nLineCnt = listSLines.count();
+    QByteArray buf;
+    buf.reserve(nLineCnt * 9);
+    QVector<int> markIndexVec;
+
+    for(int iLCnt = 0; iLCnt < nLineCnt; iLCnt ++)
+    {
+        const qint8 nLineType = view.type(iLCnt);
+        const qint32 nX = view.x(iLCnt);
+        const qint32 nY = view.y(iLCnt);
+        if(SECTION_SCANTYPE_JUMP != nLineType && SECTION_SCANTYPE_MARK != nLineType) continue;
+        if(nLastX == nX && nLastY == nY) continue;
+
+        if(SECTION_SCANTYPE_JUMP == nLineType)
+        {
+            // 先处理已存储的标记线段, 再写入跳转线段
+            appendMarkLines(buf, view, markIndexVec);
+            appendValue(buf, nLineType);
+            appendValue(buf, nX);
+            appendValue(buf, nY);
+        }
+        else markIndexVec << iLCnt;
+        nLastX = nX;
+        nLastY = nY;
+    }
+
+    // 处理剩余的标记线段
+    appendMarkLines(buf, view, markIndexVec);
+    lpFile->write(buf);
+}
+
+namespace {
+inline void appendVarint(QByteArray &buf, quint64 value)
+{
+    while(value >= 0x80)
+    {
+        buf.append(char(value | 0x80));
+        value >>= 7;
+    }
+    buf.append(char(value));
+}
+
+inline bool readVarint(const char *&data, const char *end, quint64 &value)
+{
+    value = 0;
+    for(int shift = 0; shift < 64 && data < end; shift += 7)
+    {
+        const quint8 byte = quint8(*data ++);
+        value |= quint64(byte & 0x7F) << shift;
+        if(0 == (byte & 0x80)) return true;
+    }
+    return false;
+}
+
+inline quint64 zigzagEncode(const qint64 &value) { return (quint64(value) << 1) ^ quint64(value >> 63); }
+inline qint64 zigzagDecode(const quint64 &value) { return qint64(value >> 1) ^ -qint64(value & 1); }
+}
+
+///
+/// @brief 以差分编码写入扫描线数据
+/// @param lpFile 输出文件指针
+/// @param listSLines 扫描线数据列表, 写入后清空
+///
+void writeScanLinesDelta(QFile *lpFile, QVector<SCANLINE> &listSLines)
+{
+    writeScanLinesDelta(lpFile, ScanVectorView::fromScanLines(listSLines));
+    listSLines.clear();
+}
+
+///
+/// @brief 以差分编码写入扫描线数据
+/// @param lpFile 输出文件指针
+/// @param view 扫描线视图
+/// @details 实现步骤:
+///   1. 与 writeScanLines 相同, 跳过与上一点重合的跳转线及标记线
+///   2. 各点相对上一点的差值经 zig-zag 变换后以 varint 存入缓冲区, 首点相对原点
+///   3. 整块写入 SECTION_SCANTYPE_DELTA 头及数据, 一次写入文件
+///
+void writeScanLinesDelta(QFile *lpFile, const ScanVectorView &view)
+{
+    const int nSize = view.size();
+    if(nSize < 1) return;
+
+    QByteArray buf;
+    buf.reserve(nSize * 4);
+
+    int nLastX = -1, nLastY = -1;
+    qint64 nPrevX = 0, nPrevY = 0;
+    qint32 nLineCnt = 0;
+    for(int iLCnt = 0; iLCnt < nSize; iLCnt ++)
+    {
+        const qint8 nLineType = view.type(iLCnt);
+        const qint32 nX = view.x(iLCnt);
+        const qint32 nY = view.y(iLCnt);
+        if(SECTION_SCANTYPE_JUMP != nLineType && SECTION_SCANTYPE_MARK != nLineType) continue;
+        if(nLastX == nX && nLastY == nY) continue;
+        nLastX = nX;
+        nLastY = nY;
+
+        const quint64 nMark = (SECTION_SCANTYPE_MARK == nLineType) ? 1 : 0;
+        appendVarint(buf, (zigzagEncode(nX - nPrevX) << 1) | nMark);
+        appendVarint(buf, zigzagEncode(nY - nPrevY));
+        nPrevX = nX;
+        nPrevY = nY;
+        ++ nLineCnt;
+    }
 
     if(nLineCnt)
     {
-        // 存储标记线段
-        QVector<SCANLINE> listMarkSLine;
+        writeData8(lpFile, SECTION_SCANTYPE_DELTA);
+        writeData8(lpFile, SCANENCODING_DELTA_V1);
+        writeData32(lpFile, nLineCnt);
+        writeData32(lpFile, buf.size());
+        lpFile->write(buf);
+    }
+}
 
-        // 遍历所有扫描线
-        for(int iLCnt = 0; iLCnt < nLineCnt; iLCnt ++)
+///
+/// @brief 解码差分编码的扫描线块
+/// @param data 数据指针, 指向 SECTION_SCANTYPE_DELTA 标识之后的字节
+/// @param nSize 可读字节数
+/// @param listSLines [out] 解码后的扫描线, 追加到列表末尾
+/// @return 消耗的字节数, 数据不完整或版本不支持时返回 -1
+///
+qint64 readScanLinesDelta(const char *data, const qint64 &nSize, QVector<SCANLINE> &listSLines)
+{
+    const qint64 nHeadSz = 1 + 4 + 4;
+    if(nSize < nHeadSz || SCANENCODING_DELTA_V1 != qint8(data[0])) return -1;
+
+    qint32 nLineCnt = 0, nByteSz = 0;
+    memcpy(&nLineCnt, data + 1, 4);
+    memcpy(&nByteSz, data + 5, 4);
+    if(nLineCnt < 0 || nByteSz < 0 || nSize - nHeadSz < nByteSz) return -1;
+
+    const char *cur = data + nHeadSz;
+    const char *end = cur + nByteSz;
+    listSLines.reserve(listSLines.size() + nLineCnt);
+
+    qint64 nPrevX = 0, nPrevY = 0;
+    for(qint32 i = 0; i < nLineCnt; ++ i)
+    {
+        quint64 nValueX = 0, nValueY = 0;
+        if(false == readVarint(cur, end, nValueX) || false == readVarint(cur, end, nValueY)) return -1;
+
+        nPrevX += zigzagDecode(nValueX >> 1);
+        nPrevY += zigzagDecode(nValueY);
+
+        SCANLINE line;
+        line.nLineType = (nValueX & 1) ? SECTION_SCANTYPE_MARK : SECTION_SCANTYPE_JUMP;
+        line.nX = int(nPrevX);
+        line.nY = int(nPrevY);
+        listSLines << line;
+    }
+    return (cur == end) ? nHeadSz + nByteSz : -1;
+}
+
+///
+/// @brief 平移差分编码的扫描线块
+/// @param data 数据指针, 指向 SECTION_SCANTYPE_DELTA 标识之后的字节
+/// @param nSize 可读字节数
+/// @param nOffsetX X 平移量
+/// @param nOffsetY Y 平移量
+/// @param buf [out] 追加平移后的块(不含标识)
+/// @return 消耗的字节数, 数据不完整或版本不支持时返回 -1
+/// @details 各点只记录与上一点的差值, 平移只改变首点, 其余数据原样拷贝
+///
+qint64 translateScanLinesDelta(const char *data, const qint64 &nSize, const qint32 &nOffsetX,
+                               const qint32 &nOffsetY, QByteArray &buf)
+{
+    const qint64 nHeadSz = 1 + 4 + 4;
+    if(nSize < nHeadSz || SCANENCODING_DELTA_V1 != qint8(data[0])) return -1;
+
+    qint32 nLineCnt = 0, nByteSz = 0;
+    memcpy(&nLineCnt, data + 1, 4);
+    memcpy(&nByteSz, data + 5, 4);
+    if(nLineCnt < 0 || nByteSz < 0 || nSize - nHeadSz < nByteSz) return -1;
+
+    const char *cur = data + nHeadSz;
+    const char *end = cur + nByteSz;
+    QByteArray firstPt;
+    if(nLineCnt > 0)
+    {
+        quint64 nValueX = 0, nValueY = 0;
+        if(false == readVarint(cur, end, nValueX) || false == readVarint(cur, end, nValueY)) return -1;
+        appendVarint(firstPt, (zigzagEncode(zigzagDecode(nValueX >> 1) + nOffsetX) << 1) | (nValueX & 1));
+        appendVarint(firstPt, zigzagEncode(zigzagDecode(nValueY) + nOffsetY));
+    }
+
+    buf.append(data[0]);
+    appendValue(buf, qint32(nLineCnt));
+    appendValue(buf, qint32(firstPt.size() + (end - cur)));
+    buf.append(firstPt);
+    buf.append(cur, int(end - cur));
+    return nHeadSz + nByteSz;
+}
+
+///
+/// @brief 写入一个扫描数据块
+/// @param lpFile 输出文件指针
+/// @param mUFileData 数据块
+/// @param bDeltaEncoding 是否使用差分编码
+/// @details 依次写入零件索引、模式、激光功率、标记速度及扫描线; 扫描器及光束索引由调用方负责
+///
+void writeBlockData(QFile *lpFile, const UFFWRITEDATA &mUFileData, const bool &bDeltaEncoding)
+{
+    // 写入零件索引
+    writeData8(lpFile, SECTION_PARTINDEX);
+    writeData32(lpFile, mUFileData.nPartIndex);
+
+    // 写入模式信息
+    writeData8(lpFile, mUFileData.nMode_Section);
+    writeData8(lpFile, mUFileData.nMode_Coor);
+
+    // 写入激光功率
+    writeData8(lpFile, SECTION_LASERPOWER);
+    writeData32(lpFile, mUFileData.nLaserPower);
+
+    // 写入标记速度
+    writeData8(lpFile, SECTION_MARKSPEED);
+    writeData32(lpFile, mUFileData.nMarkSpeed);
+
+    // 写入扫描线数据
+    if(bDeltaEncoding) writeScanLinesDelta(lpFile, mUFileData.lineView());
+    else writeScanLines(lpFile, mUFileData.lineView());
+}
+
+///
+/// @brief 设置待写入数据内存预算
+/// @param nBytes 预算字节数, 0 表示不限制
+/// @param spillFormat 提前编码格式, USP 为数据块(WriteUFF 整体拷贝), 作业文件为原始扫描线(WriteJFile 逐块读回)
+/// @details 同时记录扫描线编码方式, 提前编码的数据块与写入线程输出一致
+///
+void PARAWRITEBUFF::setWriteBudget(const qint64 &nBytes, const int &spillFormat)
+{
+    auto *_writeBuff = this;
+    _nBudgetBytes = qMax(nBytes, qint64(0));
+    _nSpillFormat = spillFormat;
+    _bDeltaEncoding = SCANENCODING_DELTA_V1 == ExtendedParas<int>("Global/nScanEncoding", SCANENCODING_RAW);
+    _nPeakPendingBytes = _nPendingBytes.load();
+
+    QMutexLocker locker(&_budgetLocker);
+    _budgetStats = WRITEBUDGETSTATS();
+    _budgetStats.nBudgetBytes = _nBudgetBytes;
+}
+
+///
+/// @brief 超出预算时限制生产者
+/// @param lpFileData 刚写入数据的队列
+/// @details 实现步骤:
+///   1. 未超出预算直接返回
+///   2. 写入线程尚未消费的队列整体编码到临时文件, 释放内存
+///   3. 剩余数据位于写入线程正在消费的队列, 若为本队列则阻塞等待写入线程消费
+///
+///   提前编码由取得 _spillLocker 的一个生产者完成, 其余生产者不重复扫描队列, 直接进入步骤 3.
+///   编码在生产者线程执行: 只在超出预算时发生, 此时该生产者本应阻塞; 逐个队列持锁, 被编码的队列
+///   不是写入线程正在消费的队列, 写入线程和其它生产者(无锁入队)均不因此等待
+///
+void PARAWRITEBUFF::applyBackpressure(UFILEDATA *lpFileData)
+{
+    if(_nBudgetBytes < 1 || _nPendingBytes <= _nBudgetBytes) return;
+
+    // 提前编码
+    if(_spillLocker.tryLock())
+    {
+        for(auto &listFileData : gUFileData)
         {
-            // 处理跳转线段
-            if(SECTION_SCANTYPE_JUMP == listSLines.at(iLCnt).nLineType)
+            for(auto &fileData : listFileData)
             {
-                // 检查是否为新位置
-                if(nLastX != listSLines.at(iLCnt).nX || nLastY != listSLines.at(iLCnt).nY)
-                {
-                    // 先处理已存储的标记线段
-                    int nMarkSLineCnt = listMarkSLine.count();
-                    if(nMarkSLineCnt)
-                    {
-                        // 标记线段数量大于4时使用循环格式
-                        if(nMarkSLineCnt > 4)
-                        {
-                            writeData8(lpFile, SECTION_SCANTYPE_MARKLOOP);
-                            writeData32(lpFile, nMarkSLineCnt);
-                            for(int iMark = 0; iMark < nMarkSLineCnt; iMark ++)
-                            {
-                                writeData32(lpFile, listMarkSLine.at(iMark).nX);
-                                writeData32(lpFile, listMarkSLine.at(iMark).nY);
-                            }
-                        }
-                        // 少量标记线段直接写入
-                        else
-                        {
-                            for(int iMark = 0; iMark < nMarkSLineCnt; iMark ++)
-                            {
-                                writeData8(lpFile, listMarkSLine.at(iMark).nLineType);
-                                writeData32(lpFile, listMarkSLine.at(iMark).nX);
-                                writeData32(lpFile, listMarkSLine.at(iMark).nY);
-                            }
-                        }
-                        listMarkSLine.clear();
-                    }
-
-                    // 写入跳转线段
-                    writeData8(lpFile, listSLines.at(iLCnt).nLineType);
-                    writeData32(lpFile, listSLines.at(iLCnt).nX);
-                    writeData32(lpFile, listSLines.at(iLCnt).nY);
-                    nLastX = listSLines.at(iLCnt).nX;
-                    nLastY = listSLines.at(iLCnt).nY;
-                }
-            }
-            // 处理标记线段
-            else if(SECTION_SCANTYPE_MARK == listSLines.at(iLCnt).nLineType)
-            {
-                // 检查是否为新位置
-                if(nLastX != listSLines.at(iLCnt).nX || nLastY != listSLines.at(iLCnt).nY)
-                {
-                    // 添加到标记线段列表
-                    listMarkSLine << listSLines.at(iLCnt);
-                    nLastX = listSLines.at(iLCnt).nX;
-                    nLastY = listSLines.at(iLCnt).nY;
-                }
+                if(_nPendingBytes <= _nBudgetBytes) break;
+                QMutexLocker locker(fileData->gQueue.locker());
+                spillFileData(fileData.data());
             }
         }
+        _spillLocker.unlock();
+    }
 
-        // 处理剩余的标记线段
-        int nMarkSLineCnt = listMarkSLine.count();
-        if(nMarkSLineCnt)
+    // 阻塞等待
+    QElapsedTimer timer;
+    bool bWaited = false;
+    while(_nPendingBytes > _nBudgetBytes)
+    {
         {
-            // 使用循环格式或直接写入
-            if(nMarkSLineCnt > 4)
-            {
-                writeData8(lpFile, SECTION_SCANTYPE_MARKLOOP);
-                writeData32(lpFile, nMarkSLineCnt);
-                for(int iMark = 0; iMark < nMarkSLineCnt; iMark ++)
-                {
-                    writeData32(lpFile, listMarkSLine.at(iMark).nX);
-                    writeData32(lpFile, listMarkSLine.at(iMark).nY);
-                }
-            }
-            else
-            {
-                for(int iMark = 0; iMark < nMarkSLineCnt; iMark ++)
-                {
-                    writeData8(lpFile, listMarkSLine.at(iMark).nLineType);
-                    writeData32(lpFile, listMarkSLine.at(iMark).nX);
-                    writeData32(lpFile, listMarkSLine.at(iMark).nY);
-                }
-            }
-            listMarkSLine.clear();
+            QMutexLocker locker(lpFileData->gQueue.locker());
+            if(false == lpFileData->bDraining || lpFileData->gQueue.isEmpty()) break;
+        }
+        if(false == bWaited)
+        {
+            bWaited = true;
+            timer.start();
         }
-        listSLines.clear();
+        QMutexLocker locker(&_budgetLocker);
+        _budgetCond.wait(&_budgetLocker, 20);
     }
+
+    if(bWaited)
+    {
+        QMutexLocker locker(&_budgetLocker);
+        ++ _budgetStats.nWaitCnt;
+        _budgetStats.nWaitMs += timer.elapsed();
+    }
+}
+
+///
+/// @brief 将队列中的数据块编码到临时文件
+/// @param lpFileData 数据队列, 调用方持有 gQueue.locker()
+/// @return 是否写入
+/// @details 写入线程正在消费的队列不处理; 临时文件与输出文件位于同一目录
+///
+bool PARAWRITEBUFF::spillFileData(UFILEDATA *lpFileData)
+{
+    if(lpFileData->bDraining || lpFileData->gQueue.isEmpty()) return false;
+
+    if(nullptr == lpFileData->gSpillFile)
+    {
+        QString strDir = QFileInfo(gFile.fileName()).absolutePath();
+        if(gFile.fileName().isEmpty()) strDir = QDir::tempPath();
+        auto spillFile = QSharedPointer<QTemporaryFile>(new QTemporaryFile(strDir + "/XXXXXX.spill"));
+        if(false == spillFile->open())
+        {
+            qDebug() << "spillFileData open failed" << spillFile->fileTemplate();
+            return false;
+        }
+        lpFileData->gSpillFile = spillFile;
+    }
+
+    QFile *lpFile = lpFileData->gSpillFile.data();
+    const qint64 nStartPos = lpFile->pos();
+    UFFWRITEDATA mUFileData;
+    while(lpFileData->gQueue.take(mUFileData))
+    {
+        if(SPILL_SCANLINES == _nSpillFormat) writeSpilledScanLines(lpFile, mUFileData);
+        else writeBlockData(lpFile, mUFileData, _bDeltaEncoding);
+        ++ lpFileData->nSpillBlockCnt;
+        lpFileData->nSpillVectorCnt += mUFileData.lineCount();
+        releasePendingBytes(lpFileData, mUFileData);
+    }
+
+    QMutexLocker locker(&_budgetLocker);
+    _budgetStats.nSpillBytes += lpFile->pos() - nStartPos;
+    ++ _budgetStats.nSpillCnt;
+    return true;
+}
+
+///
+/// @brief 以原始扫描线格式写入一个数据块
+/// @param lpFile 临时文件
+/// @param mUFileData 数据块
+/// @details 依次写入模式、扫描线数量及 SCANLINE 数组, 不过滤任何线段; 仅用于本进程内的临时文件
+///
+void PARAWRITEBUFF::writeSpilledScanLines(QFile *lpFile, const UFFWRITEDATA &mUFileData)
+{
+    QVector<SCANLINE> bufLines;
+    if(mUFileData.vectorBuffer) mUFileData.vectorBuffer->toScanLines(bufLines);
+    const QVector<SCANLINE> &listSLines = mUFileData.vectorBuffer ? bufLines : mUFileData.listSLines;
+
+    writeData8(lpFile, mUFileData.nMode_Section);
+    writeData32(lpFile, listSLines.size());
+    lpFile->write(reinterpret_cast<const char *>(listSLines.constData()), qint64(listSLines.size()) * qint64(sizeof(SCANLINE)));
+}
+
+///
+/// @brief 读回 writeSpilledScanLines 写入的数据块
+/// @param lpFile 临时文件
+/// @param mUFileData [out] 数据块, 扫描线存放于 listSLines
+/// @return 是否读取到完整数据块
+///
+bool PARAWRITEBUFF::readSpilledScanLines(QFile *lpFile, UFFWRITEDATA &mUFileData)
+{
+    qint8 nMode_Section = -1;
+    qint32 nLineCnt = 0;
+    if(1 != lpFile->read(reinterpret_cast<char *>(&nMode_Section), 1)) return false;
+    if(4 != lpFile->read(reinterpret_cast<char *>(&nLineCnt), 4) || nLineCnt < 0) return false;
+
+    mUFileData.nMode_Section = nMode_Section;
+    mUFileData.vectorBuffer.clear();
+    mUFileData.listSLines.resize(nLineCnt);
+    const qint64 nBytes = qint64(nLineCnt) * qint64(sizeof(SCANLINE));
+    return nBytes == lpFile->read(reinterpret_cast<char *>(mUFileData.listSLines.data()), nBytes);
+}
+
+///
+/// @brief 写入线程结束时清除消费标记, 之后写入的数据不再阻塞生产者
+///
+void PARAWRITEBUFF::resetDraining()
+{
+    for(auto &listFileData : gUFileData)
+    {
+        for(auto &fileData : listFileData)
+        {
+            QMutexLocker locker(fileData->gQueue.locker());
+            fileData->bDraining = false;
+        }
+    }
+    _budgetCond.wakeAll();
+}
+
+WRITEBUDGETSTATS PARAWRITEBUFF::budgetStats()
+{
+    QMutexLocker locker(&_budgetLocker);
+    WRITEBUDGETSTATS stats = _budgetStats;
+    stats.nPeakPendingBytes = _nPeakPendingBytes;
+    return stats;
 }
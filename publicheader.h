@@ -19,8 +19,10 @@ enum EXPORT_FILE_MODE {
 
 #include <QJsonObject>
 #include <QMutex>
+#include <QWaitCondition>
 #include <QFile>
 #include <QRect>
+#include <atomic>
 
 #define FILEDATAUNIT UNITSPRECISION
 #define COMMONUNIT FILEDATAUNIT
@@ -62,7 +64,14 @@ enum EXPORT_FILE_MODE {
 
 extern void writeData8(QFile *, qint8);
 extern void writeData32(QFile *, qint32);
+extern void writeData64(QFile *, qint64);
 extern void writeScanLines(QFile *, QVector<SCANLINE> &);
+extern void writeScanLines(QFile *, const ScanVectorView &);
+extern void writeScanLinesDelta(QFile *, QVector<SCANLINE> &);
+extern void writeScanLinesDelta(QFile *, const ScanVectorView &);
+extern qint64 readScanLinesDelta(const char *, const qint64 &, QVector<SCANLINE> &);
+extern qint64 translateScanLinesDelta(const char *, const qint64 &, const qint32 &, const qint32 &, QByteArray &);
+extern void writeBlockData(QFile *, const UFFWRITEDATA &, const bool &);
 
 typedef QSharedPointer<UFILEDATA> UFILEDATAPTR;
 
@@ -76,6 +85,17 @@ enum HATCHINGBEAM {
     HATCHINGBEAM_REMAINING = 2  // 剩余区域填充光束
 };
 
+///
+/// @brief 上/下表面填充方式枚举
+/// @details 对应 UPSURFACEPARAMETERS::nHatchingType
+///
+enum SURFACEHATCHTYPE {
+    SURFACEHATCH_X = 0,         // X向填充
+    SURFACEHATCH_Y = 1,         // Y向填充
+    SURFACEHATCH_ALTERNATE = 2, // 按表面序号X/Y交替
+    SURFACEHATCH_CROSS = 3      // X/Y交叉填充, 扫描两遍
+};
+
 
 struct SplicingInfo {
     int64_t _splicingPos;
@@ -132,11 +152,40 @@ struct WriterBufferParas {
 };
 
 
+///
+/// @brief 待写入数据内存预算统计
+///
+struct WRITEBUDGETSTATS {
+    qint64 nBudgetBytes = 0;        // 预算, 0 表示不限制
+    qint64 nPeakPendingBytes = 0;   // 待写入数据估算内存峰值
+    qint64 nSpillBytes = 0;         // 提前编码到临时文件的字节数
+    qint64 nSpillCnt = 0;           // 提前编码次数
+    qint64 nWaitCnt = 0;            // 生产者阻塞次数
+    qint64 nWaitMs = 0;             // 生产者阻塞总时长
+};
+
 struct PARAWRITEBUFF {
     QFile gFile;
     QSharedPointer<WriterBufferParas> _writerBufferParas;
     QList<QList<UFILEDATAPTR>> gUFileData;
 
+    // 提前编码到临时文件的格式
+    enum SpillFormat {
+        SPILL_USPBLOCK = 0,     // USP 数据块, WriteUFF 整体拷贝
+        SPILL_SCANLINES,        // 模式及原始扫描线, WriteJFile 逐块读回
+    };
+
+    // 待写入数据内存预算
+    qint64 _nBudgetBytes = 0;
+    bool _bDeltaEncoding = false;
+    int _nSpillFormat = SPILL_USPBLOCK;
+    std::atomic<qint64> _nPendingBytes {0};
+    std::atomic<qint64> _nPeakPendingBytes {0};
+    WRITEBUDGETSTATS _budgetStats;                  // 受 _budgetLocker 保护
+    QMutex _budgetLocker;
+    QWaitCondition _budgetCond;
+    QMutex _spillLocker;                            // 同一时刻只有一个生产者提前编码
+
     template<typename T>
     T getExtendedValue(const QString &name, const T &defVal = T()) const {
         return _writerBufferParas->_extendedParaPtr->getValue(name, defVal);
@@ -185,10 +234,11 @@ struct PARAWRITEBUFF {
 
         // 创建数据结构
         auto maxScannerCnt = quint8(qMax(BpcParas->nNumber_SplicingScanner, BpcParas->nScannerNumber));
+        auto queueCapacity = getExtendedValue<int>("Global/nWriteQueueSize", WriteQueue<UFFWRITEDATA>::DefaultCapacity);
         for(quint8 iScanner = 0; iScanner < maxScannerCnt; ++ iScanner) {
             QList<UFILEDATAPTR> listFileData;
             for(quint8 iBeam = 0; iBeam < quint8(BppParas->sGeneralPara.nNumber_Beam); ++ iBeam) {
-                listFileData << UFILEDATAPTR(new UFILEDATA());
+                listFileData << UFILEDATAPTR(new UFILEDATA(queueCapacity));
             }
             gUFileData << listFileData;
         }
@@ -215,11 +265,64 @@ struct PARAWRITEBUFF {
             qDebug() << "appendFileData Beam Error" << beam << gUFileData.at(scanner).size();
             return;
         }
-        if(mUFileData.listSLines.size() < 1) return;
-        QMutexLocker locker(&gUFileData[scanner][beam]->gLocker_UFD);
-        gUFileData[scanner][beam]->gListUFileData << mUFileData;
+        if(mUFileData.lineCount() < 1) return;
+        UFILEDATA *lpFileData = gUFileData[scanner][beam].data();
+        addPendingBytes(lpFileData, pendingBytes(mUFileData));
+        lpFileData->gQueue.push(mUFileData);
+        applyBackpressure(lpFileData);
+    }
+    void appendFileDatas(QVector<UFFWRITEDATA> &listUFileData, const int &scanner = 0, const int &beam = 0) {
+        if (scanner >= gUFileData.size() || beam >= gUFileData.at(scanner).size())
+        {
+            qDebug() << "appendFileDatas Error" << scanner << beam;
+            return;
+        }
+        if(listUFileData.size() < 1) return;
+        UFILEDATA *lpFileData = gUFileData[scanner][beam].data();
+        for (auto &mUFileData : listUFileData)
+        {
+            if(mUFileData.lineCount() < 1) continue;
+            addPendingBytes(lpFileData, pendingBytes(mUFileData));
+            lpFileData->gQueue.push(std::move(mUFileData));
+        }
+        listUFileData.clear();
+        applyBackpressure(lpFileData);
     }
 
+    ///
+    /// @brief 数据块估算内存
+    ///
+    static inline qint64 pendingBytes(const UFFWRITEDATA &mUFileData) {
+        return qint64(sizeof(UFFWRITEDATA)) + qint64(mUFileData.lineCount()) * qint64(sizeof(SCANLINE));
+    }
+    ///
+    /// @brief 入队时累计待写入内存并更新峰值, 未设置预算时不统计, 避免生产者争用计数器
+    ///
+    inline void addPendingBytes(UFILEDATA *lpFileData, const qint64 &nBytes) {
+        if(_nBudgetBytes < 1) return;
+        lpFileData->nPendingBytes += nBytes;
+        const qint64 nPending = (_nPendingBytes += nBytes);
+        qint64 nPeak = _nPeakPendingBytes.load();
+        while(nPending > nPeak && false == _nPeakPendingBytes.compare_exchange_weak(nPeak, nPending)) { }
+    }
+    ///
+    /// @brief 写入线程取出数据块后释放预算
+    ///
+    inline void releasePendingBytes(UFILEDATA *lpFileData, const UFFWRITEDATA &mUFileData) {
+        if(_nBudgetBytes < 1) return;
+        const qint64 nBytes = pendingBytes(mUFileData);
+        lpFileData->nPendingBytes -= nBytes;
+        if((_nPendingBytes -= nBytes) <= _nBudgetBytes && _nBudgetBytes > 0) _budgetCond.wakeAll();
+    }
+
+    void setWriteBudget(const qint64 &, const int &spillFormat = SPILL_USPBLOCK);
+    void applyBackpressure(UFILEDATA *);
+    bool spillFileData(UFILEDATA *);
+    static void writeSpilledScanLines(QFile *, const UFFWRITEDATA &);
+    static bool readSpilledScanLines(QFile *, UFFWRITEDATA &);
+    void resetDraining();
+    WRITEBUDGETSTATS budgetStats();
+
     inline bool isSolidSplicing() {
         auto *_writeBuff = this;
         Q_UNUSED(_writeBuff);
@@ -256,6 +359,12 @@ typedef struct __NORMALLINE {
         return (this->x1 == line.x1 && this->y1 == line.y1
                 && this->x2 == line.x2 && this->y2 == line.y2);
     }
+    bool operator <(const __NORMALLINE &line) const {
+        if(this->y1 != line.y1) return this->y1 < line.y1;
+        if(this->y2 != line.y2) return this->y2 < line.y2;
+        if(this->x1 != line.x1) return this->x1 < line.x1;
+        return this->x2 < line.x2;
+    }
 }LINENORMAL;
 
 struct SplicingArea {
@@ -269,7 +378,7 @@ struct SplicingArea {
 
 struct SplicingLine {
     int64_t nSplicingPos;
-    QVector<LINENORMAL> vecLine;
+    QVector<LINENORMAL> vecLine;        // 落在拼接线上的轮廓边, 计算后按 operator< 排序
 };
 
 struct SOLIDPATH {
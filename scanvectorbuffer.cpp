@@ -0,0 +1,112 @@
+#include "scanvectorbuffer.h"
+#include "uspfiledef.h"
+
+#include <cstddef>
+
+///
+/// @brief 以 SCANLINE 数组构造视图
+/// @details 按结构体成员偏移及结构体大小作为步长, 不复制数据; 视图有效期不超过源数组
+///
+ScanVectorView ScanVectorView::fromScanLines(const QVector<SCANLINE> &listSLines)
+{
+    if(listSLines.isEmpty()) return ScanVectorView();
+
+    const SCANLINE *data = listSLines.constData();
+    return ScanVectorView(&data->nLineType, &data->nX, &data->nY, listSLines.size(),
+                          int(sizeof(SCANLINE)), int(sizeof(SCANLINE)));
+}
+
+ScanVectorBuffer ScanVectorBuffer::clone() const
+{
+    ScanVectorBuffer buffer;
+    buffer._type = _type;
+    buffer._x = _x;
+    buffer._y = _y;
+    return buffer;
+}
+
+void ScanVectorBuffer::reserve(const int &size)
+{
+    _type.reserve(size_t(size));
+    _x.reserve(size_t(size));
+    _y.reserve(size_t(size));
+}
+
+void ScanVectorBuffer::clear()
+{
+    _type.clear();
+    _x.clear();
+    _y.clear();
+}
+
+void ScanVectorBuffer::append(const ScanVectorView &view)
+{
+    appendTranslated(view, 0, 0);
+}
+
+///
+/// @brief 平移后追加
+/// @param view [in] 源扫描线
+/// @param dx [in] X 平移量
+/// @param dy [in] Y 平移量
+/// @details 先整体扩容, 再按分量逐个数组写入; 源为连续数组时内层循环无分支, 可向量化
+///
+void ScanVectorBuffer::appendTranslated(const ScanVectorView &view, const qint32 &dx, const qint32 &dy)
+{
+    const int count = view.size();
+    if(count < 1) return;
+
+    const size_t base = _type.size();
+    _type.resize(base + size_t(count));
+    _x.resize(base + size_t(count));
+    _y.resize(base + size_t(count));
+
+    qint8 *type = _type.data() + base;
+    qint32 *x = _x.data() + base;
+    qint32 *y = _y.data() + base;
+    if(view.isContiguous())
+    {
+        const qint8 *srcType = view.typeData();
+        const qint32 *srcX = view.xData();
+        const qint32 *srcY = view.yData();
+        for(int i = 0; i < count; ++ i) type[i] = srcType[i];
+        for(int i = 0; i < count; ++ i) x[i] = srcX[i] + dx;
+        for(int i = 0; i < count; ++ i) y[i] = srcY[i] + dy;
+    }
+    else
+    {
+        for(int i = 0; i < count; ++ i)
+        {
+            type[i] = view.type(i);
+            x[i] = view.x(i) + dx;
+            y[i] = view.y(i) + dy;
+        }
+    }
+}
+
+void ScanVectorBuffer::translate(const qint32 &dx, const qint32 &dy)
+{
+    qint32 *x = _x.data();
+    qint32 *y = _y.data();
+    const int count = size();
+    for(int i = 0; i < count; ++ i) x[i] += dx;
+    for(int i = 0; i < count; ++ i) y[i] += dy;
+}
+
+///
+/// @brief 转换为 SCANLINE 数组, 追加到列表末尾
+/// @details 供只接受 QVector<SCANLINE> 的外部接口使用
+///
+void ScanVectorBuffer::toScanLines(QVector<SCANLINE> &listSLines) const
+{
+    const int count = size();
+    listSLines.reserve(listSLines.size() + count);
+    for(int i = 0; i < count; ++ i)
+    {
+        SCANLINE line;
+        line.nLineType = _type[size_t(i)];
+        line.nX = _x[size_t(i)];
+        line.nY = _y[size_t(i)];
+        listSLines << line;
+    }
+}
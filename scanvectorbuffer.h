@@ -0,0 +1,93 @@
+#ifndef SCANVECTORBUFFER_H
+#define SCANVECTORBUFFER_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <vector>
+
+struct SCANLINE;
+
+///
+/// ! @coreclass{ScanVectorView}
+/// 扫描线只读视图, 不持有数据
+/// @details 类型及坐标各自按字节步长访问, 同一份消费代码既可遍历 ScanVectorBuffer 的连续数组,
+///   也可直接遍历 QVector<SCANLINE>, 不需要转换
+///
+class ScanVectorView
+{
+public:
+    ScanVectorView() = default;
+    ScanVectorView(const qint8 *type, const qint32 *x, const qint32 *y, const int &size,
+                   const int &typeStride = sizeof(qint8), const int &coorStride = sizeof(qint32))
+        : _type(reinterpret_cast<const char *>(type)), _x(reinterpret_cast<const char *>(x)),
+          _y(reinterpret_cast<const char *>(y)), _size(size), _typeStride(typeStride), _coorStride(coorStride) {}
+
+    static ScanVectorView fromScanLines(const QVector<SCANLINE> &);
+
+    inline int size() const { return _size; }
+    inline bool isEmpty() const { return 0 == _size; }
+    inline bool isContiguous() const { return int(sizeof(qint8)) == _typeStride && int(sizeof(qint32)) == _coorStride; }
+
+    inline qint8 type(const int &i) const { return *reinterpret_cast<const qint8 *>(_type + qint64(i) * _typeStride); }
+    inline qint32 x(const int &i) const { return *reinterpret_cast<const qint32 *>(_x + qint64(i) * _coorStride); }
+    inline qint32 y(const int &i) const { return *reinterpret_cast<const qint32 *>(_y + qint64(i) * _coorStride); }
+
+    // 连续存储时的数组首地址
+    inline const qint8 *typeData() const { return reinterpret_cast<const qint8 *>(_type); }
+    inline const qint32 *xData() const { return reinterpret_cast<const qint32 *>(_x); }
+    inline const qint32 *yData() const { return reinterpret_cast<const qint32 *>(_y); }
+
+private:
+    const char *_type = nullptr;
+    const char *_x = nullptr;
+    const char *_y = nullptr;
+    int _size = 0;
+    int _typeStride = sizeof(qint8);
+    int _coorStride = sizeof(qint32);
+};
+
+///
+/// ! @coreclass{ScanVectorBuffer}
+/// 扫描线存储, 类型、X、Y 分别存放在连续数组中
+/// @details 只允许移动, 需要副本时显式调用 clone; 多处共享同一份数据时以 QSharedPointer 持有.
+///   平移等逐点变换在连续数组上进行, 可由编译器向量化.
+///   目前只有晶格填充使用: 模板扫描线存为共享缓存, 各晶格实例平移写入 UFFWRITEDATA::vectorBuffer;
+///   常规填充、ScanLinesSortor 及支撑仍输出 QVector<SCANLINE>, 写入端经 ScanVectorView 统一读取
+///
+class ScanVectorBuffer
+{
+public:
+    ScanVectorBuffer() = default;
+    ScanVectorBuffer(ScanVectorBuffer &&) = default;
+    ScanVectorBuffer &operator=(ScanVectorBuffer &&) = default;
+    ScanVectorBuffer(const ScanVectorBuffer &) = delete;
+    ScanVectorBuffer &operator=(const ScanVectorBuffer &) = delete;
+
+    ScanVectorBuffer clone() const;
+
+    inline int size() const { return int(_type.size()); }
+    inline bool isEmpty() const { return _type.empty(); }
+    void reserve(const int &);
+    void clear();
+
+    inline void append(const qint8 &type, const qint32 &x, const qint32 &y) {
+        _type.push_back(type);
+        _x.push_back(x);
+        _y.push_back(y);
+    }
+    void append(const ScanVectorView &);
+    void appendTranslated(const ScanVectorView &, const qint32 &, const qint32 &);
+    void translate(const qint32 &, const qint32 &);
+
+    inline ScanVectorView view() const {
+        return ScanVectorView(_type.data(), _x.data(), _y.data(), size());
+    }
+    void toScanLines(QVector<SCANLINE> &) const;
+
+private:
+    std::vector<qint8> _type;
+    std::vector<qint32> _x;
+    std::vector<qint32> _y;
+};
+
+#endif // SCANVECTORBUFFER_H
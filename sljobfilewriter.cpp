@@ -9,25 +9,14 @@
 #include <QSettings>
 #include <QFileInfo>
 #include <QDateTime>
-#include <QJsonArray>
 #include <QJsonObject>
-#include <QJsonDocument>
+#include <QDataStream>
 #include <QXmlStreamWriter>
 #include <QCoreApplication>
 #include <QCryptographicHash>
 
 #define PARAMAPSIZE 9
 
-///
-/// @brief 扫描排序类型结构体
-/// @details 定义扫描和排序的配置参数
-///
-struct ScanSortTypes {
-    int nScanHatchingFirst = 1;  // 优先扫描填充
-    int nScanSortByPart = 1;     // 按零件排序
-    int nWindDirection = 0;       // 风向设置
-};
-
 ///
 /// @brief XML元数据零件信息结构体
 /// @details 存储零件相关的文件信息
@@ -74,34 +63,6 @@ inline QDebug operator<<(QDebug debug, const Parameter &p)
     return debug;
 }
 
-///
-/// @brief 数据块信息结构体
-/// @details 存储数据块的位置、扫描参数和边界信息
-///
-struct BlockInfo {
-    qint64 nPos = 0;               // 数据块位置
-    int ScannerIndexRef = 0;       // 扫描器索引
-    int VectorTypeRef = 0;         // 矢量类型
-
-    // 边界框坐标
-    float fMinX = FLT_MAX;         // X最小值
-    float fMaxX = FLT_MIN;         // X最大值 
-    float fMinY = FLT_MAX;         // Y最小值
-    float fMaxY = FLT_MIN;         // Y最大值
-
-    // 中心点坐标
-    float fCentX = 0.0;           // X中心
-    float fCentY = 0.0;           // Y中心
-
-    BlockInfo() = default;         // 默认构造函数
-
-    /// @brief 拷贝构造函数
-    /// @param block 源数据块
-    BlockInfo(const BlockInfo &block) {
-        *this = block;
-    }
-};
-
 ///
 /// @brief 文件块映射结构体
 /// @details 存储文件ID和对应的数据块信息
@@ -120,30 +81,159 @@ struct FileBlockMap {
 };
 
 
+#define LAYERINDEX_MAGIC 0x49424C55
+#define LAYERINDEX_VERSION 2
+
+inline void initIndexStream(QDataStream &stream)
+{
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+void writeIndexHeader(QDataStream &stream, const LayerIndexHeader &header)
+{
+    stream << quint32(LAYERINDEX_MAGIC) << quint32(LAYERINDEX_VERSION)
+           << header.fXmin << header.fYmin << header.fZmin
+           << header.fXmax << header.fYmax << header.fZmax
+           << header.fLayerThickness << header.nFileSize
+           << header.nMinLayer << header.nMaxLayer << header.nLayerCnt;
+}
+
+bool readIndexHeader(QDataStream &stream, LayerIndexHeader &header)
+{
+    quint32 magic = 0, version = 0;
+    stream >> magic >> version;
+    if(LAYERINDEX_MAGIC != magic || LAYERINDEX_VERSION != version) return false;
+
+    stream >> header.fXmin >> header.fYmin >> header.fZmin
+           >> header.fXmax >> header.fYmax >> header.fZmax
+           >> header.fLayerThickness >> header.nFileSize
+           >> header.nMinLayer >> header.nMaxLayer >> header.nLayerCnt;
+    return QDataStream::Ok == stream.status();
+}
+
+bool loadIndexHeader(const QString &fileName, LayerIndexHeader &header)
+{
+    QFile file(fileName);
+    if(false == file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream stream(&file);
+    initIndexStream(stream);
+    return readIndexHeader(stream, header);
+}
+
 ///
-/// @brief 解析JSON数据为对象
-/// @param data JSON字节数组
-/// @param successful 可选的解析结果标志
-/// @return 解析得到的JSON对象
-/// @details 实现步骤:
-///   1. 解析JSON数据
-///   2. 检查解析结果
-///   3. 返回JSON对象
+/// @brief 创建层索引文件并写入占位文件头
+///
+bool LayerIndexWriter::open()
+{
+    if(false == _file.open(QIODevice::WriteOnly)) return false;
+    _stream.setDevice(&_file);
+    initIndexStream(_stream);
+    writeIndexHeader(_stream, _header);
+    return QDataStream::Ok == _stream.status();
+}
+
+///
+/// @brief 追加一层的层记录及数据块记录
+/// @param layer [in] 层信息, 层号须大于已写入的层
+///
+bool LayerIndexWriter::writeLayer(const Layer &layer)
+{
+    if(0 == _header.nLayerCnt) _header.nMinLayer = layer.Z;
+    _header.nMaxLayer = layer.Z;
+    ++ _header.nLayerCnt;
+
+    _stream << qint32(layer.Z) << layer._totalArea
+            << layer.fMinX << layer.fMaxX << layer.fMinY << layer.fMaxY
+            << layer.fCenterX << layer.fCenterY << qint32(layer.blockList.size());
+    for(const auto &block : layer.blockList)
+    {
+        _stream << block->nPos << block->nLength << qint32(block->ScannerIndexRef) << qint32(block->VectorTypeRef)
+                << block->fMinX << block->fMinY << block->fMaxX << block->fMaxY
+                << block->fCentX << block->fCentY;
+    }
+
+    // 更新文件边界值
+    _fMinX = qMin(_fMinX, layer.fMinX);
+    _fMaxX = qMax(_fMaxX, layer.fMaxX);
+    _fMinY = qMin(_fMinY, layer.fMinY);
+    _fMaxY = qMax(_fMaxY, layer.fMaxY);
+    return QDataStream::Ok == _stream.status();
+}
+
 ///
-QJsonObject getObject(const QByteArray &data, bool *successful = nullptr)
+/// @brief 回写文件整体信息并关闭
+/// @param thickness [in] 层厚
+/// @param minHei [in] 最小层号
+/// @param maxHei [in] 最大层号
+/// @param fileSize [in] 对应扫描数据文件大小
+///
+bool LayerIndexWriter::close(const double &thickness, const int &minHei, const int &maxHei, const qint64 &fileSize)
 {
-    // 解析JSON数据
-    QJsonParseError error;
-    auto documnet = QJsonDocument::fromJson(data, &error);
+    if(false == _file.isOpen()) return false;
+
+    _header.fXmin = _fMinX;
+    _header.fYmin = _fMinY;
+    _header.fZmin = minHei * UNITFACTOR;
+    _header.fXmax = _fMaxX;
+    _header.fYmax = _fMaxY;
+    _header.fZmax = maxHei * UNITFACTOR;
+    _header.fLayerThickness = thickness;
+    _header.nFileSize = fileSize;
+    _file.seek(0);
+    writeIndexHeader(_stream, _header);
+    const bool bResult = QDataStream::Ok == _stream.status() && _file.flush();
+    _file.close();
+    return bResult;
+}
+
+bool LayerIndexReader::open()
+{
+    if(false == _file.open(QIODevice::ReadOnly)) return false;
+    _stream.setDevice(&_file);
+    initIndexStream(_stream);
+    if(false == readIndexHeader(_stream, _header)) return false;
+
+    _layerLeft = _header.nLayerCnt;
+    peekLayer();
+    return true;
+}
 
-    // 设置解析结果标志
-    if(successful) *successful = (QJsonParseError::NoError == error.error);
+///
+/// @brief 读取当前层记录及其数据块记录
+/// @param layer [out] 层信息, 调用前需由 hasLayer 确认当前层
+///
+bool LayerIndexReader::readLayer(Layer &layer)
+{
+    qint32 blockCnt = 0;
+    layer.Z = _nextLayer;
+    _stream >> layer._totalArea >> layer.fMinX >> layer.fMaxX >> layer.fMinY >> layer.fMaxY
+            >> layer.fCenterX >> layer.fCenterY >> blockCnt;
+    for(qint32 i = 0; i < blockCnt && QDataStream::Ok == _stream.status(); ++ i)
+    {
+        BlockInfoPtr block(new BlockInfo);
+        qint32 scannerIndex = 0, vectorType = 0;
+        _stream >> block->nPos >> block->nLength >> scannerIndex >> vectorType
+                >> block->fMinX >> block->fMinY >> block->fMaxX >> block->fMaxY
+                >> block->fCentX >> block->fCentY;
+        block->ScannerIndexRef = scannerIndex;
+        block->VectorTypeRef = vectorType;
+        layer.blockList << block;
+    }
+    peekLayer();
+    return QDataStream::Ok == _stream.status();
+}
 
-    // 返回解析结果
-    if(QJsonParseError::NoError == error.error) return documnet.object();
+void LayerIndexReader::peekLayer()
+{
+    _hasNext = (_layerLeft > 0) && (QDataStream::Ok == _stream.status());
+    if(false == _hasNext) return;
 
-    // 解析失败返回空对象
-    return QJsonObject();
+    _stream >> _nextLayer;
+    -- _layerLeft;
+    _hasNext = (QDataStream::Ok == _stream.status());
 }
 
 QList<FileBlockMap> sortBlock(const ScanSortTypes &, const int &, const QStringList &, const QList<BinFile> &);
@@ -193,13 +283,19 @@ SLJobFileWriter::~SLJobFileWriter()
 /// @brief 初始化文件写入器
 /// @return 初始化结果,true表示成功,false表示失败
 /// @details 实现步骤:
-///   1. 设置算法缓冲区参数
-///   2. 设置文件写入器缓冲区
-///   3. 创建文件数据
-///   4. 写入文件头信息
+///   1. 设置待写入数据内存预算
+///   2. 设置算法缓冲区参数
+///   3. 设置文件写入器缓冲区
+///   4. 创建文件数据
+///   5. 写入文件头信息
+///   6. 创建层索引文件
 ///
 bool SLJobFileWriter::initFileWrite()
 {
+    // 待写入数据内存预算, 单位 MB, 超出时以原始扫描线提前写出到临时文件
+    buffPara->setWriteBudget(qint64(buffPara->getExtendedValue<int>("Global/nWriteBufferMB", 0)) << 20,
+                             PARAWRITEBUFF::SPILL_SCANLINES);
+
     // 设置算法缓冲区参数
     algorithm->setBuffParas(buffPara, fileWriter->m_nScannerIndex);
 
@@ -212,6 +308,11 @@ bool SLJobFileWriter::initFileWrite()
     // 写入文件头信息
     SLJFileWriter::writeFileHeaderInfo(&buffPara->gFile);
 
+    // 层索引与扫描数据同步逐层写入
+    QString strBinFileName = buffPara->gFile.fileName();
+    indexWriter = QSharedPointer<LayerIndexWriter>(new LayerIndexWriter(strBinFileName.left(strBinFileName.size() - 3) + "lbf"));
+    bResult &= indexWriter->open();
+
     return bResult;
 }
 
@@ -231,6 +332,11 @@ void SLJobFileWriter::startBuffWriter()
     fileWriter->start();
 }
 
+///
+/// @brief 等待本层扫描数据写完
+/// @details 回写层大小后将本层信息转为层索引记录追加到 .lbf, 数据块长度取相邻块位置之差,
+///   末块到本层结束位置; 写入后只保留当前层信息
+///
 void SLJobFileWriter::waitBuffWriter()
 {
     fileWriter->setUFFStatus(UFFWRITE_END);
@@ -242,14 +348,33 @@ void SLJobFileWriter::waitBuffWriter()
         SLJFileWriter::writeFileValue(&buffPara->gFile, curLayerInfo->nLayerSz);
         buffPara->gFile.seek(nCurPos);
 
-        //        QString str;
-        //        QDebug debug(&str);
-        //        debug << "[" <<curLayerInfo->blockList.size() << "]";
-        //        for(const auto &block : curLayerInfo->blockList)
-        //        {
-        //            debug << block.paraRefer.nVectorTypeID << block.binFileInfo.nPos;
-        //        }
-        //        qDebug() << "waitBuffWriter" << str;
+        Layer layer;
+        layer.Z = curLayerHei;
+        layer._totalArea = float(curLayerInfo->_totalArea);
+        layer.fMinX = float(curLayerInfo->fMinX);
+        layer.fMaxX = float(curLayerInfo->fMaxX);
+        layer.fMinY = float(curLayerInfo->fMinY);
+        layer.fMaxY = float(curLayerInfo->fMaxY);
+        layer.fCenterX = float((curLayerInfo->fMinX + curLayerInfo->fMaxX) * 0.5);
+        layer.fCenterY = float((curLayerInfo->fMinY + curLayerInfo->fMaxY) * 0.5);
+        const auto &blockList = curLayerInfo->blockList;
+        for(int i = 0; i < blockList.size(); ++ i)
+        {
+            const auto &blockPtr = blockList[i];
+            BlockInfoPtr block(new BlockInfo);
+            block->nPos = qint64(blockPtr->binFileInfo.nPos);
+            block->nLength = ((i + 1 < blockList.size()) ? qint64(blockList[i + 1]->binFileInfo.nPos) : nCurPos) - block->nPos;
+            block->ScannerIndexRef = blockPtr->paraRefer.nScannerIndex;
+            block->VectorTypeRef = blockPtr->paraRefer.nVectorTypeID;
+            block->fMinX = float(blockPtr->fMinX);
+            block->fMinY = float(blockPtr->fMinY);
+            block->fMaxX = float(blockPtr->fMaxX);
+            block->fMaxY = float(blockPtr->fMaxY);
+            block->fCentX = float((blockPtr->fMinX + blockPtr->fMaxX) * 0.5);
+            block->fCentY = float((blockPtr->fMinY + blockPtr->fMaxY) * 0.5);
+            layer.blockList << block;
+        }
+        if(indexWriter) indexWriter->writeLayer(layer);
     }
 }
 
@@ -264,22 +389,20 @@ void SLJobFileWriter::writeLayerInfo(const int &nHei, const BOUNDINGRECT &, cons
     curLayerInfo->nPos = buffPara->gFile.pos() + 4;
     curLayerInfo->_totalArea = totalArea;
     fileWriter->setJFileLayerInfo(curLayerInfo);
-    layerInfoPtrMap.insert(nHei, JFileLayerInfoPtr(curLayerInfo));
+    curLayerInfoPtr = JFileLayerInfoPtr(curLayerInfo);
+    curLayerHei = nHei;
     SLJFileWriter::writeLayerInfo(&buffPara->gFile, curLayerInfo, totalArea);
 }
 
 ///
-/// @brief 创建USP文件及其相关JSON信息文件
+/// @brief 完成扫描数据文件及其层索引文件
 /// @param thickness 层厚
 /// @param boundingBox 边界框
 /// @param minHei 最小高度
 /// @param maxHei 最大高度
 /// @details 实现步骤:
 ///   1. 更新文件头信息
-///   2. 创建临时JSON文件存储层信息
-///   3. 遍历所有层信息,写入每层的扫描块数据
-///   4. 计算文件整体边界信息
-///   5. 合并生成最终的LBF文件
+///   2. 回写层索引文件头, 层记录已由 waitBuffWriter 逐层写入
 ///
 void SLJobFileWriter::createUSPFile(const QString &, const QString &, const float &thickness,
                                    BOUNDINGBOX *boundingBox, const int &minHei, const int &maxHei, QJsonObject &)
@@ -293,95 +416,69 @@ void SLJobFileWriter::createUSPFile(const QString &, const QString &, const floa
         buffPara->gFile.seek(nCurPos);
     }
 
-    // 创建临时JSON文件
-    QString strBinFileName = buffPara->gFile.fileName();
-    QString strJsonFileName = strBinFileName.left(strBinFileName.size() - 3) + "lbftt";
-    QFile file(strJsonFileName);
+    if(indexWriter) indexWriter->close(double(thickness), minHei, maxHei, buffPara->gFile.size());
 
-    if(file.open(QIODevice::ReadWrite))
+    if(buffPara->_nBudgetBytes > 0)
     {
-        file.resize(0);
-        QJsonObject obj;
+        const auto stats = buffPara->budgetStats();
+        qDebug() << "write buffer budget" << stats.nBudgetBytes << "peak" << stats.nPeakPendingBytes
+                 << "spilled" << stats.nSpillBytes << stats.nSpillCnt << "waits" << stats.nWaitCnt << stats.nWaitMs << "ms";
+    }
+}
 
-        // 初始化文件边界值
-        float fFileMinX = FLT_MAX;
-        float fFileMinY = FLT_MAX;
-        float fFileMaxX = FLT_MIN;
-        float fFileMaxY = FLT_MIN;
 
-        // 遍历每层信息写入JSON
-        for(auto i = layerInfoPtrMap.begin(); i != layerInfoPtrMap.end(); ++ i)
-        {
-            // 构建层信息对象
-            QJsonObject layerObj;
-            layerObj.insert("Z", i.key());
-            
-            // 写入层内扫描块信息
-            QJsonArray blockArray;
-            for(const auto &blockPtr : i.value()->blockList)
-            {
-                QJsonObject blockObj;
-                blockObj.insert("Pos", blockPtr->binFileInfo.nPos);
-                blockObj.insert("ScannerIndexRef", blockPtr->paraRefer.nScannerIndex);
-                blockObj.insert("VectorTypeRef", blockPtr->paraRefer.nVectorTypeID);
-                blockObj.insert("fMinX", blockPtr->fMinX);
-                blockObj.insert("fMinY", blockPtr->fMinY);
-                blockObj.insert("fMaxX", blockPtr->fMaxX);
-                blockObj.insert("fMaxY", blockPtr->fMaxY);
-                blockObj.insert("fCentX", (blockPtr->fMinX + blockPtr->fMaxX) * 0.5);
-                blockObj.insert("fCentY", (blockPtr->fMinY + blockPtr->fMaxY) * 0.5);
-                blockArray.append(blockObj);
-            }
+///
+/// @brief 写入层索引文件
+/// @param fileName [in] .lbf 文件名
+/// @param layerMap [in] 按层号排列的层记录
+/// @param thickness [in] 层厚
+/// @param minHei [in] 最小层号
+/// @param maxHei [in] 最大层号
+/// @param fileSize [in] 对应扫描数据文件大小
+/// @return 全部写入时返回 true
+/// @details 与逐层写入使用同一个 LayerIndexWriter, 用于已有全部层记录的场合
+///
+bool SLJobFileWriter::writeLayerIndex(const QString &fileName, const QMap<int, Layer> &layerMap, const double &thickness,
+                                      const int &minHei, const int &maxHei, const qint64 &fileSize)
+{
+    LayerIndexWriter writer(fileName);
+    if(false == writer.open()) return false;
 
-            // 写入层整体信息
-            layerObj.insert("fTotalArea", i.value()->_totalArea);
-            layerObj.insert("fMinX", i.value()->fMinX);
-            layerObj.insert("fMaxX", i.value()->fMaxX);
-            layerObj.insert("fMinY", i.value()->fMinY);
-            layerObj.insert("fMaxY", i.value()->fMaxY);
-            layerObj.insert("fCenterX", (i.value()->fMinX + i.value()->fMaxX) * 0.5);
-            layerObj.insert("fCenterY", (i.value()->fMinY + i.value()->fMaxY) * 0.5);
-            layerObj.insert("Blocks", blockArray);
-
-            // 写入层数据
-            file.write(QJsonDocument(layerObj).toJson(QJsonDocument::Compact) + "\n");
-
-            // 更新文件边界值
-            fFileMinX = qMin(fFileMinX, i.value()->fMinX);
-            fFileMaxX = qMax(fFileMaxX, i.value()->fMaxX);
-            fFileMinY = qMin(fFileMinY, i.value()->fMinY);
-            fFileMaxY = qMax(fFileMaxY, i.value()->fMaxY);
-        }
+    bool bResult = true;
+    for(auto i = layerMap.cbegin(); i != layerMap.cend(); ++ i)
+    {
+        Layer layer = i.value();
+        layer.Z = i.key();
+        bResult &= writer.writeLayer(layer);
+    }
+    return writer.close(thickness, minHei, maxHei, fileSize) && bResult;
+}
 
-        // 构建文件整体信息
-        obj.insert("FileName", QFileInfo(strBinFileName).completeBaseName() + ".bin");
-        obj.insert("Xmin", fFileMinX);
-        obj.insert("Ymin", fFileMinY);
-        obj.insert("Zmin", minHei * UNITFACTOR);
-        obj.insert("Xmax", fFileMaxX);
-        obj.insert("Ymax", fFileMaxY);
-        obj.insert("Zmax", maxHei * UNITFACTOR);
-        obj.insert("FileSize", buffPara->gFile.size());
-        obj.insert("LayerThickness", double(thickness));
-        obj.insert("Zmin", minHei * UNITFACTOR);
-        obj.insert("Zmax", maxHei * UNITFACTOR);
-
-        // 生成最终LBF文件
-        QFile nFile(strBinFileName.left(strBinFileName.size() - 3) + "lbf");
-        if(nFile.open(QIODevice::ReadWrite)) {
-            file.seek(0);
-
-            // 写入文件信息和层数据
-            nFile.write(QJsonDocument(obj).toJson(QJsonDocument::Compact) + "\n");
-            while(!file.atEnd())
-            {
-                nFile.write(file.readLine());
-            }
-            nFile.close();
-        }
-        file.close();
-        file.remove();
+///
+/// @brief 一次读入整份层索引
+/// @param fileName [in] .lbf 文件名
+/// @param binFile [out] 各层记录, 文件名取 .lbf 的基本名
+/// @param thickness [out] 层厚
+/// @return 文件完整时返回 true
+/// @details 生成元数据时按层流式读取, 此接口用于校验
+///
+bool SLJobFileWriter::readLayerIndex(const QString &fileName, BinFile &binFile, double &thickness)
+{
+    binFile.strFileName = QFileInfo(fileName).completeBaseName();
+    binFile.layerMap.clear();
+
+    LayerIndexReader reader(fileName, binFile.strFileName);
+    if(false == reader.open()) return false;
+    thickness = reader.header().fLayerThickness;
+    for(int iLayer = reader.header().nMinLayer; iLayer <= reader.header().nMaxLayer; ++ iLayer)
+    {
+        if(false == reader.hasLayer(iLayer)) continue;
+
+        Layer layer;
+        if(false == reader.readLayer(layer)) return false;
+        binFile.layerMap.insert(iLayer, layer);
     }
+    return binFile.layerMap.size() == reader.header().nLayerCnt;
 }
 
 
@@ -474,7 +571,7 @@ void SLJobFileWriter::createJFileContentXml(const QString &path, const QStringLi
 ///   8. 写入矢量类型定义
 ///   9. 写入工艺参数集
 ///   10. 写入二进制文件信息
-///   11. 写入层信息
+///   11. 按层号逐层读取各零件的层索引, 写入层信息
 ///
 void SLJobFileWriter::createJFileMetaDataXML(const QString &path, const QStringList &listPartName, const QString &saveName,
                                              const QSharedPointer<WriterBufferParas> &writerBuffer)
@@ -573,18 +670,16 @@ void SLJobFileWriter::createJFileMetaDataXML(const QString &path, const QStringL
         double fZmax = FLT_MIN;
         for(const auto &part : listPartName)
         {
-            QFile file(path + part + ".lbf");
-            if(file.open(QIODevice::ReadOnly))
+            LayerIndexHeader header;
+            if(loadIndexHeader(path + part + ".lbf", header))
             {
-                auto obj = getObject(file.readLine());
-                fXmin = qMin(fXmin, obj["Xmin"].toDouble());
-                fYmin = qMin(fYmin, obj["Ymin"].toDouble());
-                fZmin = qMin(fZmin, obj["Zmin"].toDouble());
-
-                fXmax = qMax(fXmax, obj["Xmax"].toDouble());
-                fYmax = qMax(fYmax, obj["Ymax"].toDouble());
-                fZmax = qMax(fZmax, obj["Zmax"].toDouble());
-                file.close();
+                fXmin = qMin(fXmin, header.fXmin);
+                fYmin = qMin(fYmin, header.fYmin);
+                fZmin = qMin(fZmin, header.fZmin);
+
+                fXmax = qMax(fXmax, header.fXmax);
+                fYmax = qMax(fYmax, header.fYmax);
+                fZmax = qMax(fZmax, header.fZmax);
             }
         }
 
@@ -657,13 +752,11 @@ void SLJobFileWriter::createJFileMetaDataXML(const QString &path, const QStringL
 
         for(const auto &part : listPartName)
         {
-            QFile file(path + part + ".lbf");
-            if(file.open(QIODevice::ReadOnly))
+            LayerIndexHeader header;
+            if(loadIndexHeader(path + part + ".lbf", header))
             {
-                auto obj = getObject(file.readLine());
-                addPartToMetaDataXML(&writer, nPartIndex, part, obj["Xmin"].toDouble(), obj["Ymin"].toDouble()
-                                     , obj["Zmin"].toDouble(), obj["Xmax"].toDouble(), obj["Ymax"].toDouble(), obj["Zmax"].toDouble());
-                file.close();
+                addPartToMetaDataXML(&writer, nPartIndex, part, header.fXmin, header.fYmin
+                                     , header.fZmin, header.fXmax, header.fYmax, header.fZmax);
             }
             ++ nPartIndex;
         }
@@ -776,74 +869,28 @@ void SLJobFileWriter::createJFileMetaDataXML(const QString &path, const QStringL
         int nMinLayer = 0x7FFFFFFF;
         int nMaxLayer = 0;
         double thickness = 1;
-        QList<BinFile> binFileList;
-        loadJsonFiles(path, listPartName, binFileList, nMinLayer, nMaxLayer, thickness);
+        QList<QSharedPointer<LayerIndexReader>> readerList;
+        openIndexReaders(path, listPartName, readerList, nMinLayer, nMaxLayer, thickness);
         thickness = qRound(thickness * 1E6 + 0.1) * 1E-6;
-        // 写入层信息
+        // 写入层信息, 各零件的层索引按层号同步向前读取
         writer.writeStartElement("Layers");
         writer.writeTextElement("LayerThickness", Num2String::text(thickness, 4));
         for(int iLayer = nMinLayer; iLayer <= nMaxLayer; iLayer += 1)
         {
-            bool bValidLayer = false;
-            float fMinX = FLT_MAX;
-            float fMaxX = FLT_MIN;
-            float fMinY = FLT_MAX;
-            float fMaxY = FLT_MIN;
-            double fTotalArea = 0.0;
-            for(const auto &binFile : qAsConst(binFileList))
+            QList<BinFile> binFileList;
+            for(const auto &reader : qAsConst(readerList))
             {
-                if(binFile.layerMap.contains(iLayer))
-                {
-                    bValidLayer = true;
-                    const auto &layerInfo = binFile.layerMap[iLayer];
-                    fMinX = qMin(fMinX, layerInfo.fMinX);
-                    fMaxX = qMax(fMaxX, layerInfo.fMaxX);
-                    fMinY = qMin(fMinY, layerInfo.fMinY);
-                    fMaxY = qMax(fMaxY, layerInfo.fMaxY);
-                    fTotalArea += layerInfo._totalArea;
-                }
-            }
-            if(false == bValidLayer) continue;
-
-            writer.writeStartElement("Layer");
-            QString str;
-            str.sprintf("%0.4f", iLayer * UNITFACTOR);
-            writer.writeTextElement("Z", str);
-            writer.writeTextElement("LayerScanTime", "1.000");
-            writer.writeTextElement("LayerArea", Num2String::text(fTotalArea, 2));
-            writer.writeStartElement("Summary");
-            writer.writeTextElement("TotalMarkDistance", "1.000");
-            writer.writeTextElement("TotalJumpDistance", "1.000");
-            writer.writeTextElement("XMin", Num2String::text(fMinX, 3));
-            writer.writeTextElement("XMax", Num2String::text(fMaxX, 3));
-            writer.writeTextElement("YMin", Num2String::text(fMinY, 3));
-            writer.writeTextElement("YMax", Num2String::text(fMaxY, 3));
-            writer.writeEndElement();
-
-            writer.writeStartElement("LayerRegions");
-            writer.writeStartElement("LayerRegion");
-            writer.writeAttribute("Id", "-1");
-            writer.writeTextElement("ScanTime", "1.0000");
-            writer.writeStartElement("RegionSummary");
-            writer.writeTextElement("TotalMarkDistance", "1.000");
-            writer.writeTextElement("TotalJumpDistance", "1.000");
-            writer.writeTextElement("XMin", Num2String::text(fMinX, 3));
-            writer.writeTextElement("XMax", Num2String::text(fMaxX, 3));
-            writer.writeTextElement("YMin", Num2String::text(fMinY, 3));
-            writer.writeTextElement("YMax", Num2String::text(fMaxY, 3));
-            writer.writeEndElement();
-            writer.writeEndElement();
-
-            writer.writeEndElement();
-
-            QList<FileBlockMap> listFileBlockMap = sortBlock(sortParas, iLayer, listPartName, binFileList);
-
-            for(const auto &fileBlock : qAsConst(listFileBlockMap))
-            {
-                addBlockToMetaDataXML(&writer, fileBlock.strFileID, fileBlock.block);
+                if(false == reader->hasLayer(iLayer)) continue;
+
+                BinFile binFile;
+                Layer sLayer;
+                binFile.strFileName = reader->partName();
+                reader->readLayer(sLayer);
+                binFile.layerMap.insert(iLayer, sLayer);
+                binFileList << binFile;
             }
 
-            writer.writeEndElement();
+            addLayerToMetaDataXML(&writer, iLayer, sortParas, listPartName, binFileList);
         }
         writer.writeEndElement();
 
@@ -851,7 +898,86 @@ void SLJobFileWriter::createJFileMetaDataXML(const QString &path, const QStringL
         writer.writeEndElement();
         writer.writeEndDocument();
         file.close();
+
+        // 层索引仅用于生成元数据, 读取完成后删除
+        readerList.clear();
+        for(const auto &name : listPartName)
+        {
+            QFile::remove(path + name + ".lbf");
+        }
+    }
+}
+
+///
+/// @brief 向元数据XML添加一层的层信息及数据块
+/// @param iLayer [in] 层号
+/// @param sortParas [in] 数据块排序参数
+/// @param listPartName [in] 零件名称列表, 序号即数据块引用的零件编号
+/// @param binFileList [in] 各零件本层的层记录, 均不含本层时不写入
+///
+void SLJobFileWriter::addLayerToMetaDataXML(QXmlStreamWriter *writer, const int &iLayer, const ScanSortTypes &sortParas,
+                                            const QStringList &listPartName, const QList<BinFile> &binFileList)
+{
+    bool bValidLayer = false;
+    float fMinX = FLT_MAX;
+    float fMaxX = FLT_MIN;
+    float fMinY = FLT_MAX;
+    float fMaxY = FLT_MIN;
+    double fTotalArea = 0.0;
+    for(const auto &binFile : qAsConst(binFileList))
+    {
+        if(binFile.layerMap.contains(iLayer))
+        {
+            bValidLayer = true;
+            const auto &layerInfo = binFile.layerMap[iLayer];
+            fMinX = qMin(fMinX, layerInfo.fMinX);
+            fMaxX = qMax(fMaxX, layerInfo.fMaxX);
+            fMinY = qMin(fMinY, layerInfo.fMinY);
+            fMaxY = qMax(fMaxY, layerInfo.fMaxY);
+            fTotalArea += layerInfo._totalArea;
+        }
+    }
+    if(false == bValidLayer) return;
+
+    writer->writeStartElement("Layer");
+    QString str;
+    str.sprintf("%0.4f", iLayer * UNITFACTOR);
+    writer->writeTextElement("Z", str);
+    writer->writeTextElement("LayerScanTime", "1.000");
+    writer->writeTextElement("LayerArea", Num2String::text(fTotalArea, 2));
+    writer->writeStartElement("Summary");
+    writer->writeTextElement("TotalMarkDistance", "1.000");
+    writer->writeTextElement("TotalJumpDistance", "1.000");
+    writer->writeTextElement("XMin", Num2String::text(fMinX, 3));
+    writer->writeTextElement("XMax", Num2String::text(fMaxX, 3));
+    writer->writeTextElement("YMin", Num2String::text(fMinY, 3));
+    writer->writeTextElement("YMax", Num2String::text(fMaxY, 3));
+    writer->writeEndElement();
+
+    writer->writeStartElement("LayerRegions");
+    writer->writeStartElement("LayerRegion");
+    writer->writeAttribute("Id", "-1");
+    writer->writeTextElement("ScanTime", "1.0000");
+    writer->writeStartElement("RegionSummary");
+    writer->writeTextElement("TotalMarkDistance", "1.000");
+    writer->writeTextElement("TotalJumpDistance", "1.000");
+    writer->writeTextElement("XMin", Num2String::text(fMinX, 3));
+    writer->writeTextElement("XMax", Num2String::text(fMaxX, 3));
+    writer->writeTextElement("YMin", Num2String::text(fMinY, 3));
+    writer->writeTextElement("YMax", Num2String::text(fMaxY, 3));
+    writer->writeEndElement();
+    writer->writeEndElement();
+
+    writer->writeEndElement();
+
+    QList<FileBlockMap> listFileBlockMap = sortBlock(sortParas, iLayer, listPartName, binFileList);
+
+    for(const auto &fileBlock : qAsConst(listFileBlockMap))
+    {
+        addBlockToMetaDataXML(writer, fileBlock.strFileID, fileBlock.block);
     }
+
+    writer->writeEndElement();
 }
 
 ///
@@ -1038,88 +1164,33 @@ void SLJobFileWriter::addBlockToMetaDataXML(QXmlStreamWriter *writer, const QStr
 
 
 ///
-/// @brief 加载JSON文件并解析层信息
+/// @brief 打开各零件的层索引
 /// @param path 文件路径
 /// @param listPartName 零件名称列表
-/// @param binFileList [out] 二进制文件信息列表
+/// @param readerList [out] 层索引读取器, 与零件名称列表顺序一致, 打开失败的零件不在其中
 /// @param nMinLayer [out] 最小层号
 /// @param nMaxLayer [out] 最大层号
 /// @param thickness [out] 层厚
-/// @details 实现步骤:
-///   1. 清空输出列表
-///   2. 遍历所有零件文件
-///   3. 读取文件头获取层厚信息
-///   4. 逐行解析每层数据
-///   5. 解析层内扫描块信息
-///   6. 更新层号范围
+/// @details 只读取文件头, 层记录在生成层信息时逐层读取
 ///
-void SLJobFileWriter::loadJsonFiles(const QString &path, const QStringList &listPartName, 
-                                  QList<BinFile> &binFileList,
-                                  int &nMinLayer, int &nMaxLayer, double &thickness)
+void SLJobFileWriter::openIndexReaders(const QString &path, const QStringList &listPartName,
+                                       QList<QSharedPointer<LayerIndexReader>> &readerList,
+                                       int &nMinLayer, int &nMaxLayer, double &thickness)
 {
-    // 清空输出列表
-    binFileList.clear();
-
-    // 遍历所有零件文件
+    readerList.clear();
     for(const auto &name : listPartName)
     {
-        QFile file(path + name + ".lbf");
-        if(file.open(QIODevice::ReadOnly))
-        {
-            BinFile binFile;
+        QSharedPointer<LayerIndexReader> reader(new LayerIndexReader(path + name + ".lbf", name));
+        if(false == reader->open()) continue;
 
-            // 读取文件头获取层厚
-            auto obj = getObject(file.readLine());
-            binFile.strFileName = name;
-            thickness = qMin(thickness, qRound(obj["LayerThickness"].toDouble() * 1E6 + 0.1) * 1E-6);
-
-            // 逐行解析层数据
-            while(!file.atEnd())
-            {
-                Layer sLayer;
-                bool bOk = false;
-                auto layerObj = getObject(file.readLine(), &bOk);
-                if(false == bOk) continue;
-
-                // 解析层基本信息
-                sLayer.Z = layerObj["Z"].toInt();
-                sLayer._totalArea = layerObj["fTotalArea"].toDouble();
-                sLayer.fMinX = layerObj["fMinX"].toDouble();
-                sLayer.fMaxX = layerObj["fMaxX"].toDouble();
-                sLayer.fMinY = layerObj["fMinY"].toDouble();
-                sLayer.fMaxY = layerObj["fMaxY"].toDouble();
-                sLayer.fCenterX = layerObj["fCenterX"].toDouble();
-                sLayer.fCenterY = layerObj["fCenterY"].toDouble();
-
-                // 解析层内扫描块信息
-                const auto blockArray = layerObj["Blocks"].toArray();
-                for (const auto &block : qAsConst(blockArray))
-                {
-                    BlockInfo sBlock;
-                    auto blockObj = block.toObject();
-                    sBlock.nPos = blockObj["Pos"].toVariant().toLongLong();
-                    sBlock.ScannerIndexRef = blockObj["ScannerIndexRef"].toInt();
-                    sBlock.VectorTypeRef = blockObj["VectorTypeRef"].toInt();
-                    sBlock.fMinX = blockObj["fMinX"].toVariant().toFloat();
-                    sBlock.fMinY = blockObj["fMinY"].toVariant().toFloat();
-                    sBlock.fMaxX = blockObj["fMaxX"].toVariant().toFloat();
-                    sBlock.fMaxY = blockObj["fMaxY"].toVariant().toFloat();
-                    sBlock.fCentX = blockObj["fCentX"].toVariant().toFloat();
-                    sBlock.fCentY = blockObj["fCentY"].toVariant().toFloat();
-                    sLayer.blockList << BlockInfoPtr(new BlockInfo(sBlock));
-                }
-                binFile.layerMap.insert(sLayer.Z, sLayer);
-
-                // 更新层号范围
-                int nTempMin = binFile.layerMap.firstKey();
-                int nTempMax = binFile.layerMap.lastKey();
-                nMinLayer = nMinLayer < nTempMin ? nMinLayer : nTempMin;
-                nMaxLayer = nMaxLayer > nTempMax ? nMaxLayer : nTempMax;
-            }
-            binFileList << binFile;
-            file.close();
+        const auto &header = reader->header();
+        thickness = qMin(thickness, qRound(header.fLayerThickness * 1E6 + 0.1) * 1E-6);
+        if(header.nLayerCnt > 0)
+        {
+            nMinLayer = qMin(nMinLayer, int(header.nMinLayer));
+            nMaxLayer = qMax(nMaxLayer, int(header.nMaxLayer));
         }
-        file.remove();
+        readerList << reader;
     }
 }
 
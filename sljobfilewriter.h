@@ -5,12 +5,42 @@
 #include "qjsonparsing.h"
 #include "writejfile.h"
 
+#include <QFile>
+#include <QDataStream>
+
 namespace JFileDef {
 struct JFileLayerInfo;
 }
 class QXmlStreamWriter;
 
-struct BlockInfo;
+///
+/// @brief 数据块信息结构体
+/// @details 存储数据块的位置、扫描参数和边界信息
+///
+struct BlockInfo {
+    qint64 nPos = 0;               // 数据块位置
+    qint64 nLength = 0;            // 数据块长度(字节)
+    int ScannerIndexRef = 0;       // 扫描器索引
+    int VectorTypeRef = 0;         // 矢量类型
+
+    // 边界框坐标
+    float fMinX = FLT_MAX;         // X最小值
+    float fMaxX = FLT_MIN;         // X最大值 
+    float fMinY = FLT_MAX;         // Y最小值
+    float fMaxY = FLT_MIN;         // Y最大值
+
+    // 中心点坐标
+    float fCentX = 0.0;           // X中心
+    float fCentY = 0.0;           // Y中心
+
+    BlockInfo() = default;         // 默认构造函数
+
+    /// @brief 拷贝构造函数
+    /// @param block 源数据块
+    BlockInfo(const BlockInfo &block) {
+        *this = block;
+    }
+};
 typedef QSharedPointer<BlockInfo> BlockInfoPtr;
 
 struct Layer {
@@ -30,6 +60,91 @@ struct BinFile {
     QMap<int, Layer> layerMap;
 };
 
+///
+/// @brief 层索引文件头
+/// @details .lbf 为定长二进制层索引, 由 SLJobFileWriter 逐层写出, 生成 JobMetaData.job 后删除.
+///   文件头之后按层号递增排列, 每层为一条层记录及其 nBlockCnt 条数据块记录:
+///   层记录: Z, 面积, MinX, MaxX, MinY, MaxY, CenterX, CenterY, 块数
+///   块记录: 位置, 长度, 扫描器索引, 矢量类型, MinX, MinY, MaxX, MaxY, CentX, CentY
+///   浮点数统一按双精度写入, 读回与原值一致
+///
+struct LayerIndexHeader {
+    double fXmin = FLT_MAX;
+    double fYmin = FLT_MAX;
+    double fZmin = FLT_MAX;
+    double fXmax = FLT_MIN;
+    double fYmax = FLT_MIN;
+    double fZmax = FLT_MIN;
+    double fLayerThickness = 0.0;
+    qint64 nFileSize = 0;
+    qint32 nMinLayer = 0;
+    qint32 nMaxLayer = 0;
+    qint32 nLayerCnt = 0;
+};
+
+///
+/// @brief 层索引的逐层写入
+/// @details 文件头先占位, 每层扫描数据写完即追加该层记录, 不需要保留全部层信息; close 时回写文件头
+///
+class LayerIndexWriter
+{
+public:
+    explicit LayerIndexWriter(const QString &fileName) : _file(fileName) {}
+
+    bool open();
+    bool writeLayer(const Layer &);
+    bool close(const double &, const int &, const int &, const qint64 &);
+
+private:
+    QFile _file;
+    QDataStream _stream;
+    LayerIndexHeader _header;
+    float _fMinX = FLT_MAX;
+    float _fMinY = FLT_MAX;
+    float _fMaxX = FLT_MIN;
+    float _fMaxY = FLT_MIN;
+};
+
+///
+/// @brief 层索引的顺序读取
+/// @details 每次只读取一层, 按层号递增调用 readLayer, 不需要整份索引常驻内存
+///
+class LayerIndexReader
+{
+public:
+    LayerIndexReader(const QString &fileName, const QString &partName) :
+        _file(fileName), _partName(partName) {}
+
+    bool open();
+    bool readLayer(Layer &);
+
+    inline const LayerIndexHeader &header() const { return _header; }
+    inline const QString &partName() const { return _partName; }
+    inline bool hasLayer(const int &layer) const { return _hasNext && _nextLayer == layer; }
+
+private:
+    void peekLayer();
+
+private:
+    QFile _file;
+    QDataStream _stream;
+    QString _partName;
+    LayerIndexHeader _header;
+    qint32 _layerLeft = 0;
+    qint32 _nextLayer = 0;
+    bool _hasNext = false;
+};
+
+///
+/// @brief 扫描排序类型结构体
+/// @details 定义扫描和排序的配置参数
+///
+struct ScanSortTypes {
+    int nScanHatchingFirst = 1;  // 优先扫描填充
+    int nScanSortByPart = 1;     // 按零件排序
+    int nWindDirection = 0;       // 风向设置
+};
+
 ///
 /// ! @coreclass{SLJobFileWriter}
 /// 负责将打印数据写入特定格式的作业文件,继承自FileWriter类
@@ -65,8 +180,15 @@ public:
     static void addPartToMetaDataXML(QXmlStreamWriter *, const int &, const QString &, const float &, const float &,
                                      const float &, const float &, const float &, const float &);
     static void addBlockToMetaDataXML(QXmlStreamWriter *, const QString &, const BlockInfoPtr &);
+    static void addLayerToMetaDataXML(QXmlStreamWriter *, const int &, const ScanSortTypes &, const QStringList &,
+                                      const QList<BinFile> &);
+
+    static bool writeLayerIndex(const QString &, const QMap<int, Layer> &, const double &, const int &, const int &,
+                                const qint64 &);
+    static bool readLayerIndex(const QString &, BinFile &, double &);
 
-    static void loadJsonFiles(const QString &path, const QStringList &, QList<BinFile> &, int &, int &, double &);
+    static void openIndexReaders(const QString &path, const QStringList &, QList<QSharedPointer<LayerIndexReader>> &,
+                                 int &, int &, double &);
     static int getVectorType(const int &);
 
 public:
@@ -75,7 +197,9 @@ public:
     AlgorithmApplication *algorithm = nullptr;
 
     JFileDef::JFileLayerInfo *curLayerInfo = nullptr;
-    QMap<int, QSharedPointer<JFileDef::JFileLayerInfo>> layerInfoPtrMap;
+    QSharedPointer<JFileDef::JFileLayerInfo> curLayerInfoPtr;  // 只保留当前层, 写完后转为层索引记录
+    QSharedPointer<LayerIndexWriter> indexWriter;
+    int curLayerHei = 0;
 };
 
 #endif // SLJOBFILEWRITER_H
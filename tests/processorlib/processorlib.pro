@@ -0,0 +1,10 @@
+# 处理器源文件编译为静态库, 供各测试工程链接
+QT += concurrent gui
+
+TEMPLATE = lib
+CONFIG += staticlib c++11
+TARGET = processorlib
+DESTDIR = $$OUT_PWD/../lib
+
+include($$PWD/../../UTSLAProcessor.pri)
+include($$PWD/../../UTSLAProcessorDeps.pri)
@@ -0,0 +1,16 @@
+# 测试工程公共配置, 链接 processorlib 生成的处理器静态库
+QT += testlib concurrent gui
+QT -= widgets
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/..
+
+LIBS += -L$$OUT_PWD/../lib -lprocessorlib
+win32: PRE_TARGETDEPS += $$OUT_PWD/../lib/processorlib.lib
+else: PRE_TARGETDEPS += $$OUT_PWD/../lib/libprocessorlib.a
+
+include($$PWD/../UTSLAProcessorDeps.pri)
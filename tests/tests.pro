@@ -0,0 +1,52 @@
+# 单元测试及基准测试, 构建后执行 make check 运行全部测试
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    processorlib \
+    tst_incrementaldistribution \
+    tst_instancededup \
+    tst_jobarchiver \
+    tst_jobmetadata \
+    tst_latticehatchcache \
+    tst_latticesectiontable \
+    tst_layerarena \
+    tst_layerpipeline \
+    tst_meshslicer \
+    tst_polygonsdivider \
+    tst_scanlinesdelta \
+    tst_scantimemodule \
+    tst_scanvectorbuffer \
+    tst_simplifypaths \
+    tst_slicestore \
+    tst_splicingsplit \
+    tst_splicingstitcher \
+    tst_uspfilevalidator \
+    tst_uspfilewriter \
+    tst_uspinstancecopier \
+    tst_waterdistribution \
+    tst_writebudget \
+    tst_writequeue
+
+tst_incrementaldistribution.depends = processorlib
+tst_instancededup.depends = processorlib
+tst_jobarchiver.depends = processorlib
+tst_jobmetadata.depends = processorlib
+tst_latticehatchcache.depends = processorlib
+tst_latticesectiontable.depends = processorlib
+tst_layerarena.depends = processorlib
+tst_layerpipeline.depends = processorlib
+tst_meshslicer.depends = processorlib
+tst_polygonsdivider.depends = processorlib
+tst_scanlinesdelta.depends = processorlib
+tst_scantimemodule.depends = processorlib
+tst_scanvectorbuffer.depends = processorlib
+tst_simplifypaths.depends = processorlib
+tst_slicestore.depends = processorlib
+tst_splicingsplit.depends = processorlib
+tst_splicingstitcher.depends = processorlib
+tst_uspfilevalidator.depends = processorlib
+tst_uspfilewriter.depends = processorlib
+tst_uspinstancecopier.depends = processorlib
+tst_waterdistribution.depends = processorlib
+tst_writebudget.depends = processorlib
+tst_writequeue.depends = processorlib
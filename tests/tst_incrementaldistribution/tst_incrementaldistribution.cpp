@@ -0,0 +1,183 @@
+#include <QtTest>
+#include <cmath>
+
+#include "DynamicDivider/algorithmdistribution.h"
+
+namespace {
+typedef std::vector<std::shared_ptr<DistPartInfo>> PartInfoVec;
+
+const int ContainerCnt = 4;
+const int PartCnt = 10;
+
+///
+/// @brief 与 DividerProcessor 读取阶段相同的分配输入: 各零件轮廓固定在一个振镜, 填充区域可分配到全部振镜
+/// @details 权重随层缓慢变化; 每 40 层有一个零件中断 5 层, 区域集合变化
+///
+PartInfoVec makeLayer(const int &nLayer)
+{
+    const std::set<int> allowedSet = { 0, 1, 2, 3 };
+    PartInfoVec partInfoVec;
+    for (int iPart = 0; iPart < PartCnt; ++ iPart)
+    {
+        if (nLayer % 40 < 5 && iPart == (nLayer / 40) % PartCnt) continue;
+
+        const double fBase = 100.0 + 37.0 * iPart;
+        const double fWeight = fBase * (1.0 + 0.03 * sin(0.05 * nLayer + iPart));
+        partInfoVec.push_back(std::shared_ptr<DistPartInfo>(new DistPartInfo(iPart, 0.3 * fWeight, DistAreaType::Border,
+                                                                             iPart % ContainerCnt)));
+        partInfoVec.push_back(std::shared_ptr<DistPartInfo>(new DistPartInfo(iPart, fWeight, DistAreaType::Hatching,
+                                                                             allowedSet)));
+    }
+    return partInfoVec;
+}
+
+bool sameResult(const PartInfoVec &partInfoVec1, const PartInfoVec &partInfoVec2)
+{
+    if (partInfoVec1.size() != partInfoVec2.size()) return false;
+    for (size_t i = 0; i < partInfoVec1.size(); ++ i)
+    {
+        const auto &resVec1 = partInfoVec1[i]->_distResultVec;
+        const auto &resVec2 = partInfoVec2[i]->_distResultVec;
+        if (resVec1.size() != resVec2.size()) return false;
+        for (size_t j = 0; j < resVec1.size(); ++ j)
+        {
+            if (resVec1[j]._containorIndex != resVec2[j]._containorIndex) return false;
+            if (fabs(resVec1[j]._factor - resVec2[j]._factor) > 1E-12) return false;
+        }
+    }
+    return true;
+}
+
+///
+/// @brief 各区域的比例之和为1, 且只分配到可选振镜
+///
+bool validResult(const PartInfoVec &partInfoVec)
+{
+    for (const auto &partPtr : partInfoVec)
+    {
+        double totalFactor = 0.0;
+        for (const auto &partRes : partPtr->_distResultVec)
+        {
+            if (0 == partPtr->_allowedContainer.count(partRes._containorIndex)) return false;
+            totalFactor += partRes._factor;
+        }
+        if (fabs(totalFactor - 1.0) > 1E-6) return false;
+    }
+    return true;
+}
+}
+
+class TestIncrementalDistribution : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void zeroDriftMatchesFull();
+    void imbalanceBounded_data();
+    void imbalanceBounded();
+    void benchmarkLayers_data();
+    void benchmarkLayers();
+};
+
+void TestIncrementalDistribution::zeroDriftMatchesFull()
+{
+    // 漂移阈值为0时仅在权重完全相同时沿用, 结果与逐层重新分配一致
+    IncrementalDistribution incrementalDist;
+    incrementalDist.setParas(0.0, 0.0);
+    for (int nLayer = 0; nLayer < 200; ++ nLayer)
+    {
+        auto fullVec = makeLayer(nLayer);
+        AlgorithmDistribution::distribution(fullVec);
+        for (int iRepeat = 0; iRepeat < 2; ++ iRepeat)
+        {
+            auto partInfoVec = makeLayer(nLayer);
+            incrementalDist.distribution(partInfoVec);
+            QVERIFY2(sameResult(partInfoVec, fullVec), qPrintable(QString("layer %1").arg(nLayer)));
+        }
+    }
+    QCOMPARE(incrementalDist.solveCnt(), 200);
+    QCOMPARE(incrementalDist.reuseCnt(), 200);
+}
+
+void TestIncrementalDistribution::imbalanceBounded_data()
+{
+    QTest::addColumn<double>("driftThreshold");
+    QTest::addColumn<double>("smoothFactor");
+
+    QTest::newRow("drift 2%") << 0.02 << 0.0;
+    QTest::newRow("drift 5%") << 0.05 << 0.0;
+    QTest::newRow("drift 10%") << 0.1 << 0.0;
+    QTest::newRow("drift 5%, smooth 0.5") << 0.05 << 0.5;
+}
+
+void TestIncrementalDistribution::imbalanceBounded()
+{
+    QFETCH(double, driftThreshold);
+    QFETCH(double, smoothFactor);
+
+    // 沿用的方案在权重漂移 d 时, 不均衡度不超过 ((1 + I0) + C * d) / (1 - d) - 1, I0 为求解时的不均衡度
+    IncrementalDistribution incrementalDist;
+    incrementalDist.setParas(driftThreshold, smoothFactor);
+    double solvedImbalance = 0.0;
+    const int nLayerCnt = 400;
+    for (int nLayer = 0; nLayer < nLayerCnt; ++ nLayer)
+    {
+        auto fullVec = makeLayer(nLayer);
+        AlgorithmDistribution::distribution(fullVec);
+
+        auto partInfoVec = makeLayer(nLayer);
+        const int nSolveCnt = incrementalDist.solveCnt();
+        incrementalDist.distribution(partInfoVec);
+        QVERIFY(validResult(partInfoVec));
+        const double imbalance = IncrementalDistribution::calcImbalance(partInfoVec);
+        if (incrementalDist.solveCnt() > nSolveCnt)
+        {
+            solvedImbalance = imbalance;
+            if (0.0 == smoothFactor) QVERIFY(sameResult(partInfoVec, fullVec));
+        }
+        else
+        {
+            const double bound = ((1.0 + solvedImbalance) + ContainerCnt * driftThreshold) / (1.0 - driftThreshold) - 1.0;
+            QVERIFY2(imbalance <= bound + 1E-9, qPrintable(QString("layer %1 imbalance %2 bound %3")
+                                                           .arg(nLayer).arg(imbalance).arg(bound)));
+        }
+    }
+
+    // 缓慢变化的层大多沿用, 区域集合变化的层必须重新求解
+    QCOMPARE(incrementalDist.solveCnt() + incrementalDist.reuseCnt(), nLayerCnt);
+    QVERIFY(incrementalDist.reuseCnt() > nLayerCnt / 2);
+    QVERIFY(incrementalDist.solveCnt() >= 2 * nLayerCnt / 40);
+}
+
+void TestIncrementalDistribution::benchmarkLayers_data()
+{
+    QTest::addColumn<bool>("bIncremental");
+
+    QTest::newRow("full") << false;
+    QTest::newRow("incremental") << true;
+}
+
+void TestIncrementalDistribution::benchmarkLayers()
+{
+    QFETCH(bool, bIncremental);
+
+    QVector<PartInfoVec> layerVec;
+    for (int nLayer = 0; nLayer < 400; ++ nLayer) layerVec << makeLayer(nLayer);
+
+    QBENCHMARK {
+        IncrementalDistribution incrementalDist;
+        for (auto partInfoVec : layerVec)
+        {
+            for (auto &partPtr : partInfoVec)
+            {
+                partPtr = std::shared_ptr<DistPartInfo>(new DistPartInfo(*partPtr));
+            }
+            if (bIncremental) incrementalDist.distribution(partInfoVec);
+            else AlgorithmDistribution::distribution(partInfoVec);
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(TestIncrementalDistribution)
+
+#include "tst_incrementaldistribution.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_incrementaldistribution
+SOURCES += tst_incrementaldistribution.cpp
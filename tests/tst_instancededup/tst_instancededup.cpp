@@ -0,0 +1,400 @@
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include "utslaprocessorprivate.h"
+#include "uspinstancecopier.h"
+
+using namespace ClipperLib;
+
+namespace {
+Path makeRect(const cInt &x, const cInt &y, const cInt &w, const cInt &h, const bool &hole)
+{
+    Path path { IntPoint(x, y), IntPoint(x + w, y), IntPoint(x + w, y + h), IntPoint(x, y + h) };
+    if (hole) ReversePath(path);
+    return path;
+}
+
+///
+/// @brief 零件第 nLayer 层轮廓, 左下角位于 origin
+/// @details 带大孔、小孔、窄缝的方块及一个斜边三角形; 大孔尺寸随层变化
+///
+Paths makeLayerPaths(const int &nLayer, const IntPoint &origin)
+{
+    const cInt unit = cInt(FILEDATAUNIT);
+    const cInt x = origin.X, y = origin.Y;
+    const cInt nHoleSz = 5 * unit + (nLayer % 3) * unit / 2;
+    return Paths { makeRect(x, y, 20 * unit, 20 * unit, false),
+                   makeRect(x + 2 * unit, y + 2 * unit, nHoleSz, nHoleSz, true),
+                   makeRect(x + 12 * unit, y + 12 * unit, unit / 5, unit / 5, true),
+                   makeRect(x + 12 * unit, y + 4 * unit, 6 * unit, unit / 20, true),
+                   Path { IntPoint(x + 25 * unit, y), IntPoint(x + 40 * unit, y + 3 * unit + nLayer * unit / 7),
+                          IntPoint(x + 30 * unit, y + 17 * unit) } };
+}
+
+void initSolidPath(SOLIDPATH &solidPath, Paths &curPaths)
+{
+    solidPath.clearAllPathPointer();
+    solidPath.lpPath_Cur = &curPaths;
+    for (int iSur = 0; iSur < 5; ++ iSur)
+    {
+        solidPath.lpPath_Dw[iSur] = &solidPath.nullPaths;
+        solidPath.lpPath_Up[iSur] = &solidPath.nullPaths;
+    }
+}
+
+///
+/// @brief 单扫描器单光束写入缓冲区, 填充、轮廓、小孔及窄缝参数固定
+///
+bool initWriteBuff(PARAWRITEBUFF &writeBuff, const QString &strFile)
+{
+    writeBuff._writerBufferParas = QSharedPointer<WriterBufferParas>(new WriterBufferParas);
+
+    auto *_writeBuff = &writeBuff;
+    BpcParas->nNumber_SplicingScanner = 1;
+    BpcParas->nScannerNumber = 1;
+    BpcParas->nPlatWidthX = 400;
+    BpcParas->nPlatWidthY = 400;
+    BpcParas->fFactor_3 = 1.0f;
+    BpcParas->fFactor_4 = 1.0f;
+    BpcParas->fFactor_8 = 1.0f;
+    BpcParas->fFactor_10 = 1.0f;
+    BppParas->sGeneralPara.nNumber_Beam = 1;
+    BppParas->sGeneralPara.nUseSplicingMode = 0;
+    BppParas->sGeneralPara.nLaserPower[0] = 200;
+    BppParas->sSurfacePara_Up.nNumber = 0;
+    BppParas->sSurfacePara_Dw.nNumber = 0;
+    BppParas->sSmallHolePara.nNumber_Section = 1;
+    BppParas->sSmallHolePara.fRadius[0] = 0.5f;
+    BppParas->sSmallHolePara.fOffset[0] = 0.05f;
+    BppParas->sSmallGapPara.nNumber_Section = 1;
+    BppParas->sSmallGapPara.fWidth[0] = 0.2f;
+    BppParas->sSmallGapPara.fOffset[0] = 0.01f;
+    BppParas->sBorderPara.nNumber = 2;
+    BppParas->sBorderPara.fOffset[1] = 0.1f;
+
+    HATCHINGPARAMETERS *lpParas = &BppParas->sHatchingPara;
+    lpParas->nHatchingType[0] = HATCHTYPE_LINES;
+    lpParas->fLineSpacing[HATCHINGBEAM_NORMAL] = 0.1f;
+    lpParas->fOffset[HATCHINGBEAM_NORMAL] = 0.0f;
+    lpParas->nScanTimes[HATCHINGBEAM_NORMAL] = 1;
+    lpParas->nIndex_Power[HATCHINGBEAM_NORMAL] = 0;
+    lpParas->nIndex_BeamSize[HATCHINGBEAM_NORMAL] = 0;
+    lpParas->nMarkSpeed[HATCHINGBEAM_NORMAL] = 1000;
+    lpParas->nCLineFactor = 0;
+
+    writeBuff.gFile.setFileName(strFile);
+    return writeBuff.createUFileData();
+}
+
+///
+/// @brief 取出队列中的全部数据块
+///
+QVector<UFFWRITEDATA> takeBlocks(PARAWRITEBUFF &writeBuff)
+{
+    QVector<UFFWRITEDATA> blocks;
+    UFILEDATA *lpFileData = writeBuff.gUFileData[0][0].data();
+    QMutexLocker locker(lpFileData->gQueue.locker());
+    UFFWRITEDATA mUFileData;
+    while(lpFileData->gQueue.take(mUFileData)) blocks << mUFileData;
+    return blocks;
+}
+
+///
+/// @brief 完整处理零件各层, 返回各层写入队列的数据块
+/// @details 与 calcLayerDatas 相同的调用顺序: 小孔及窄缝、拼接向量、填充、轮廓、小孔窄缝、扩展轮廓, 最后旋转填充角度
+///
+QVector<QVector<UFFWRITEDATA>> processPart(const QString &strBuffFile, const IntPoint &origin, const int &nLayerCnt,
+                                           const double &fAngle)
+{
+    QVector<QVector<UFFWRITEDATA>> layerBlocks;
+    PARAWRITEBUFF writeBuff;
+    if(false == initWriteBuff(writeBuff, strBuffFile)) return layerBlocks;
+    AlgorithmApplication algo;
+    algo.setBuffParas(&writeBuff);
+    algo.setHatchingAngle(fAngle);
+    for(int iLayer = 1; iLayer <= nLayerCnt; ++ iLayer)
+    {
+        Paths curPaths = makeLayerPaths(iLayer, origin);
+        SimplifyPolygons(curPaths);
+        SOLIDPATH solidPath;
+        initSolidPath(solidPath, curPaths);
+
+        algo.setCurLayerHei(iLayer);
+        algo.keepHolesAndGaps(solidPath.lpPath_Cur, solidPath.paths_smallHoles, solidPath.paths_smallGaps,
+                              solidPath.paths_exceptHolesAndGaps);
+        Paths extendPaths;
+        algo.calcSplicingVec();
+        algo.writeHatchingData(solidPath, extendPaths, 1.0, 1.0, 1.0);
+        algo.writeBorderData(solidPath.paths_exceptHolesAndGaps, 1.0);
+        algo.writeHoleAndGapData(solidPath.paths_smallHoles, solidPath.paths_smallGaps, 1.0);
+        algo.writeExternedBorder(extendPaths, 1.0);
+        algo.addHatchingAngle();
+        layerBlocks << takeBlocks(writeBuff);
+    }
+    return layerBlocks;
+}
+
+inline void writeProperty(QFile *file, const quint8 &id, const qint32 &value)
+{
+    writeData8(file, qint8(id));
+    writeData32(file, value);
+}
+
+///
+/// @brief 将各层数据块写成 USP 文件
+/// @details 与 USPFileWriter 输出结构一致: XML 信息、起始属性、各层数据及文件结束标记; 层边界取扫描线范围
+///
+bool writePartFile(const QString &fileName, const QVector<QVector<UFFWRITEDATA>> &layerBlocks)
+{
+    QFile file(fileName);
+    if(false == file.open(QIODevice::WriteOnly)) return false;
+    file.write("<FileInfo></FileInfo>\n");
+    writeData8(&file, 0);
+    for(int iLayer = 0; iLayer < layerBlocks.size(); ++ iLayer)
+    {
+        qint32 nMinX = USPEMPTYBOUND_MIN, nMaxX = USPEMPTYBOUND_MAX, nMinY = USPEMPTYBOUND_MIN, nMaxY = USPEMPTYBOUND_MAX;
+        for(const auto &mUFileData : layerBlocks[iLayer])
+        {
+            const auto view = mUFileData.lineView();
+            for(int iLine = 0; iLine < view.size(); ++ iLine)
+            {
+                nMinX = qMin(nMinX, view.x(iLine));
+                nMaxX = qMax(nMaxX, view.x(iLine));
+                nMinY = qMin(nMinY, view.y(iLine));
+                nMaxY = qMax(nMaxY, view.y(iLine));
+            }
+        }
+        writeProperty(&file, SECTION_LAYER, iLayer + 1);
+        writeProperty(&file, SECTION_MINX, nMinX);
+        writeProperty(&file, SECTION_MAXX, nMaxX);
+        writeProperty(&file, SECTION_MINY, nMinY);
+        writeProperty(&file, SECTION_MAXY, nMaxY);
+        writeProperty(&file, SECTION_CURRENTSCANNERINDEX, 0);
+        writeProperty(&file, SECTION_CURRENTBEAMINDEX, 0);
+        for(const auto &mUFileData : layerBlocks[iLayer]) writeBlockData(&file, mUFileData, false);
+        writeData8(&file, SECTION_LAYEREND);
+    }
+    writeData8(&file, SECTION_FILEEND);
+    file.write("FileEnding");
+    return true;
+}
+
+///
+/// @brief 平移拷贝到目标文件并解码各层, 与 instanceProcessing 相同: 写入起始属性后逐层拷贝
+///
+bool copyAndDecode(const QString &srcFile, const QString &dstFile, const qint32 &nOffsetX, const qint32 &nOffsetY,
+                   QVector<USPLayerData> &layers)
+{
+    USPInstanceCopier copier;
+    if(false == copier.open(srcFile)) return false;
+    QVector<USPLayerEntry> layerTable;
+    {
+        QFile file(dstFile);
+        if(false == file.open(QIODevice::WriteOnly)) return false;
+        writeData8(&file, 0);
+        if(false == copier.copyTo(&file, nOffsetX, nOffsetY, layerTable)) return false;
+    }
+    copier.close();
+
+    QFile file(dstFile);
+    if(false == file.open(QIODevice::ReadOnly)) return false;
+    const QByteArray data = file.readAll();
+    layers.clear();
+    for(const auto &entry : layerTable)
+    {
+        USPLayerData layerData;
+        if(false == USPFileReader::decodeLayerData(data.constData() + entry.nOffset, entry.nLength, layerData)) return false;
+        layers << layerData;
+    }
+    return true;
+}
+
+///
+/// @brief 逐层比较 actual 与平移 (dx, dy) 后的 expected, 返回首个不一致处的描述, 一致时返回空串
+///
+QString compareLayers(const QVector<USPLayerData> &actual, const QVector<USPLayerData> &expected,
+                      const qint32 &dx, const qint32 &dy)
+{
+    if(actual.size() != expected.size()) return QString("layer count %1 != %2").arg(actual.size()).arg(expected.size());
+    for(int iLayer = 0; iLayer < actual.size(); ++ iLayer)
+    {
+        const auto &lLayer = actual[iLayer], &rLayer = expected[iLayer];
+        if(lLayer.nLayer != rLayer.nLayer || lLayer.blockVec.size() != rLayer.blockVec.size())
+        {
+            return QString("layer %1: block count %2 != %3").arg(iLayer).arg(lLayer.blockVec.size()).arg(rLayer.blockVec.size());
+        }
+        for(int iBlock = 0; iBlock < lLayer.blockVec.size(); ++ iBlock)
+        {
+            const auto &lBlock = lLayer.blockVec[iBlock], &rBlock = rLayer.blockVec[iBlock];
+            if(lBlock.nModeSection != rBlock.nModeSection || lBlock.nModeCoor != rBlock.nModeCoor ||
+               lBlock.nLaserPower != rBlock.nLaserPower || lBlock.nMarkSpeed != rBlock.nMarkSpeed ||
+               lBlock.listSLines.size() != rBlock.listSLines.size())
+            {
+                return QString("layer %1 block %2: header or line count differs").arg(iLayer).arg(iBlock);
+            }
+            for(int iLine = 0; iLine < lBlock.listSLines.size(); ++ iLine)
+            {
+                const auto &lhs = lBlock.listSLines[iLine], &rhs = rBlock.listSLines[iLine];
+                if(lhs.nLineType != rhs.nLineType || lhs.nX != rhs.nX + dx || lhs.nY != rhs.nY + dy)
+                {
+                    return QString("layer %1 block %2 line %3: (%4, %5) != (%6, %7)").arg(iLayer).arg(iBlock).arg(iLine)
+                            .arg(lhs.nX).arg(lhs.nY).arg(rhs.nX + dx).arg(rhs.nY + dy);
+                }
+            }
+        }
+    }
+    return QString();
+}
+
+///
+/// @brief 按 calcPartSignature 的方式计算零件各层轮廓的特征数据
+/// @param bMirror 是否以 origin 所在竖直线镜像
+///
+QByteArray partSignature(const int &nLayerCnt, const IntPoint &origin, const bool &bMirror, IntPoint &anchor)
+{
+    QByteArray buf;
+    bool bAnchor = false;
+    for(int iLayer = 1; iLayer <= nLayerCnt; ++ iLayer)
+    {
+        Paths paths = makeLayerPaths(iLayer, origin);
+        for(auto &path : paths)
+        {
+            if(false == bMirror) continue;
+            for(auto &pt : path) pt.X = 2 * origin.X - pt.X;
+            ReversePath(path);
+        }
+        for(const auto &path : paths)
+        {
+            UTSLAProcessorPrivate::appendAreaSignature(buf, Orientation(path) ? 1 : 0, path, bAnchor, anchor);
+        }
+    }
+    return buf;
+}
+}
+
+class TestInstanceDedup : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void translatedPartsShareSignature();
+    void dedupMatchesFullProcessing_data();
+    void dedupMatchesFullProcessing();
+    void benchmarkPlate_data();
+    void benchmarkPlate();
+};
+
+void TestInstanceDedup::translatedPartsShareSignature()
+{
+    const IntPoint originA(cInt(-61.3 * FILEDATAUNIT), cInt(17.9 * FILEDATAUNIT));
+    const IntPoint originB(cInt(62.157 * FILEDATAUNIT), cInt(-80.861 * FILEDATAUNIT));
+
+    IntPoint anchorA, anchorB, anchorMirror;
+    const QByteArray signatureA = partSignature(6, originA, false, anchorA);
+    const QByteArray signatureB = partSignature(6, originB, false, anchorB);
+    QVERIFY(signatureA.size() > 0);
+    QVERIFY(signatureA == signatureB);
+    QCOMPARE(anchorB.X - anchorA.X, originB.X - originA.X);
+    QCOMPARE(anchorB.Y - anchorA.Y, originB.Y - originA.Y);
+
+    // 镜像零件相对坐标不同, 不判为相同; 层数不同亦然
+    QVERIFY(partSignature(6, originB, true, anchorMirror) != signatureA);
+    QVERIFY(partSignature(5, originB, false, anchorMirror) != signatureA);
+}
+
+void TestInstanceDedup::dedupMatchesFullProcessing_data()
+{
+    QTest::addColumn<double>("fAngle");
+
+    QTest::newRow("0 deg") << 0.0;
+    QTest::newRow("30 deg") << 30.0;
+    QTest::newRow("67 deg") << 67.0;
+    QTest::newRow("90 deg") << 90.0;
+    QTest::newRow("137 deg") << 137.0;
+    QTest::newRow("211 deg") << 211.0;
+    QTest::newRow("293 deg") << 293.0;
+}
+
+void TestInstanceDedup::dedupMatchesFullProcessing()
+{
+    QFETCH(double, fAngle);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    // 源零件 A 与平移后的零件 B, 平移量不是线间距的整数倍
+    const int nLayerCnt = 6;
+    const IntPoint originA(cInt(-61.3 * FILEDATAUNIT), cInt(17.9 * FILEDATAUNIT));
+    const IntPoint originB(cInt(62.157 * FILEDATAUNIT), cInt(-80.861 * FILEDATAUNIT));
+    const qint32 nOffsetX = qint32(originB.X - originA.X), nOffsetY = qint32(originB.Y - originA.Y);
+
+    const auto blocksA = processPart(dir.filePath("bufA.usp"), originA, nLayerCnt, fAngle);
+    const auto blocksB = processPart(dir.filePath("bufB.usp"), originB, nLayerCnt, fAngle);
+    QCOMPARE(blocksA.size(), nLayerCnt);
+    QVERIFY(blocksA.first().size() > 0);
+    QVERIFY(writePartFile(dir.filePath("A.usp"), blocksA));
+    QVERIFY(writePartFile(dir.filePath("B.usp"), blocksB));
+
+    // 去重关闭: B 完整处理; 去重开启: B 由 A 的文件平移拷贝
+    QVector<USPLayerData> layersA, fullLayersB, dedupLayersB;
+    QVERIFY(copyAndDecode(dir.filePath("A.usp"), dir.filePath("A_copy.usp"), 0, 0, layersA));
+    QVERIFY(copyAndDecode(dir.filePath("B.usp"), dir.filePath("B_copy.usp"), 0, 0, fullLayersB));
+    QVERIFY(copyAndDecode(dir.filePath("A.usp"), dir.filePath("B_dedup.usp"), nOffsetX, nOffsetY, dedupLayersB));
+
+    // 去掉平移量后完整处理的 B 与 A 逐点一致, 两种方式得到的 B 逐点一致
+    const QString strFullDiff = compareLayers(fullLayersB, layersA, nOffsetX, nOffsetY);
+    QVERIFY2(strFullDiff.isEmpty(), qPrintable(strFullDiff));
+    const QString strDedupDiff = compareLayers(dedupLayersB, fullLayersB, 0, 0);
+    QVERIFY2(strDedupDiff.isEmpty(), qPrintable(strDedupDiff));
+}
+
+void TestInstanceDedup::benchmarkPlate_data()
+{
+    QTest::addColumn<bool>("bDedup");
+
+    QTest::newRow("full processing, 50 copies") << false;
+    QTest::newRow("instance dedup, 50 copies") << true;
+}
+
+void TestInstanceDedup::benchmarkPlate()
+{
+    QFETCH(bool, bDedup);
+
+    // 50 个相同零件排布在平台上, 每个零件 20 层; 去重时只完整处理第一个, 其余由其文件平移拷贝
+    const int nCopyCnt = 50;
+    const int nLayerCnt = 20;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    bool bResult = true;
+    QBENCHMARK {
+        const QString strSrcFile = dir.filePath("part0.usp");
+        bResult &= writePartFile(strSrcFile, processPart(dir.filePath("buf0.usp"), IntPoint(0, 0), nLayerCnt, 67.0));
+        for(int iCopy = 1; iCopy < nCopyCnt; ++ iCopy)
+        {
+            const IntPoint origin(cInt((iCopy % 10) * 45 * FILEDATAUNIT), cInt((iCopy / 10) * 25 * FILEDATAUNIT));
+            const QString strPartFile = dir.filePath(QString("part%1.usp").arg(iCopy));
+            if(false == bDedup)
+            {
+                bResult &= writePartFile(strPartFile, processPart(dir.filePath(QString("buf%1.usp").arg(iCopy)),
+                                                                  origin, nLayerCnt, 67.0));
+                continue;
+            }
+            USPInstanceCopier copier;
+            QVector<USPLayerEntry> layerTable;
+            QFile file(strPartFile);
+            if(false == copier.open(strSrcFile) || false == file.open(QIODevice::WriteOnly))
+            {
+                bResult = false;
+                continue;
+            }
+            writeData8(&file, 0);
+            bResult &= copier.copyTo(&file, qint32(origin.X), qint32(origin.Y), layerTable);
+        }
+    }
+    QVERIFY(bResult);
+}
+
+QTEST_APPLESS_MAIN(TestInstanceDedup)
+
+#include "tst_instancededup.moc"
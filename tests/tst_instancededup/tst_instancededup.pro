@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_instancededup
+SOURCES += tst_instancededup.cpp
@@ -0,0 +1,453 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <random>
+#include <vector>
+
+#ifdef Q_OS_WIN
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+#include "jobarchiver.h"
+
+namespace {
+const char *UzpPassword = "UT20200725UT";
+
+struct ZipEntry {
+    QByteArray name;
+    quint16 flags;
+    quint16 method;
+    quint32 crc;
+    qint64 compressedSize;
+    qint64 size;
+    qint64 offset;
+};
+
+template<typename T>
+T readValue(const QByteArray &data, const int &pos)
+{
+    quint64 value = 0;
+    for (size_t i = 0; i < sizeof(T); ++ i) value |= quint64(quint8(data.at(pos + int(i)))) << (i * 8);
+    return T(value);
+}
+
+///
+/// @brief 按 APPNOTE 独立实现的 ZIP 读取, 只依赖 zlib 的 inflate 与 crc32, 作为 JobArchiver 的对照
+///
+class ZipReader
+{
+public:
+    explicit ZipReader(const QString &fileName) : _file(fileName) {}
+
+    ///
+    /// @brief 读取目录结束记录(需要时读取 ZIP64 记录)及中央目录
+    ///
+    bool open() {
+        if (false == _file.open(QIODevice::ReadOnly) || _file.size() < 22) return false;
+
+        const qint64 tailSize = qMin(_file.size(), qint64(0xFFFF + 22));
+        _file.seek(_file.size() - tailSize);
+        const QByteArray tail = _file.read(tailSize);
+        int endPos = -1;
+        for (int pos = tail.size() - 22; pos >= 0 && endPos < 0; -- pos)
+        {
+            if (0x06054B50 == readValue<quint32>(tail, pos) &&
+                pos + 22 + readValue<quint16>(tail, pos + 20) == tail.size()) endPos = pos;
+        }
+        if (endPos < 0) return false;
+
+        qint64 entryCnt = readValue<quint16>(tail, endPos + 10);
+        qint64 centralSize = readValue<quint32>(tail, endPos + 12);
+        qint64 centralOffset = readValue<quint32>(tail, endPos + 16);
+        _comment = tail.mid(endPos + 22);
+        _zip64End = (0xFFFF == entryCnt || 0xFFFFFFFF == centralOffset);
+        if (_zip64End)
+        {
+            const int locatorPos = endPos - 20;
+            if (locatorPos < 0 || 0x07064B50 != readValue<quint32>(tail, locatorPos)) return false;
+            _file.seek(qint64(readValue<quint64>(tail, locatorPos + 8)));
+            const QByteArray record = _file.read(56);
+            if (record.size() != 56 || 0x06064B50 != readValue<quint32>(record, 0)) return false;
+            entryCnt = qint64(readValue<quint64>(record, 32));
+            centralSize = qint64(readValue<quint64>(record, 40));
+            centralOffset = qint64(readValue<quint64>(record, 48));
+        }
+
+        _file.seek(centralOffset);
+        const QByteArray centralDir = _file.read(centralSize);
+        if (centralDir.size() != centralSize) return false;
+        int pos = 0;
+        for (qint64 i = 0; i < entryCnt; ++ i)
+        {
+            if (pos + 46 > centralDir.size() || 0x02014B50 != readValue<quint32>(centralDir, pos)) return false;
+            ZipEntry entry;
+            entry.flags = readValue<quint16>(centralDir, pos + 8);
+            entry.method = readValue<quint16>(centralDir, pos + 10);
+            entry.crc = readValue<quint32>(centralDir, pos + 16);
+            entry.compressedSize = readValue<quint32>(centralDir, pos + 20);
+            entry.size = readValue<quint32>(centralDir, pos + 24);
+            const int nameSize = readValue<quint16>(centralDir, pos + 28);
+            const int extraSize = readValue<quint16>(centralDir, pos + 30);
+            const int commentSize = readValue<quint16>(centralDir, pos + 32);
+            entry.offset = readValue<quint32>(centralDir, pos + 42);
+            entry.name = centralDir.mid(pos + 46, nameSize);
+
+            // ZIP64 扩展字段只包含取值为 0xFFFFFFFF 的项, 顺序为原始大小、压缩大小、偏移
+            const QByteArray extra = centralDir.mid(pos + 46 + nameSize, extraSize);
+            for (int extraPos = 0; extraPos + 4 <= extra.size();)
+            {
+                const quint16 extraId = readValue<quint16>(extra, extraPos);
+                const int dataSize = readValue<quint16>(extra, extraPos + 2);
+                int valuePos = extraPos + 4;
+                if (0x0001 == extraId)
+                {
+                    if (0xFFFFFFFF == entry.size) { entry.size = qint64(readValue<quint64>(extra, valuePos)); valuePos += 8; }
+                    if (0xFFFFFFFF == entry.compressedSize) { entry.compressedSize = qint64(readValue<quint64>(extra, valuePos)); valuePos += 8; }
+                    if (0xFFFFFFFF == entry.offset) { entry.offset = qint64(readValue<quint64>(extra, valuePos)); valuePos += 8; }
+                    _zip64Entry = true;
+                }
+                extraPos += 4 + dataSize;
+            }
+            _entryList << entry;
+            pos += 46 + nameSize + extraSize + commentSize;
+        }
+        return pos == centralDir.size();
+    }
+
+    inline const QList<ZipEntry> &entryList() const { return _entryList; }
+    inline const QByteArray &comment() const { return _comment; }
+    inline bool isZip64End() const { return _zip64End; }
+    inline bool hasZip64Entry() const { return _zip64Entry; }
+
+    ///
+    /// @brief 解密并解压条目, 校验本地文件头、加密头及 CRC
+    /// @param data [out] 解压数据, nullptr 时只计算 CRC 与大小
+    ///
+    bool extract(const ZipEntry &entry, const char *password, QByteArray *data, qint64 &size) {
+        size = 0;
+        _file.seek(entry.offset);
+        const QByteArray header = _file.read(30);
+        if (header.size() != 30 || 0x04034B50 != readValue<quint32>(header, 0)) return false;
+        if (readValue<quint16>(header, 6) != entry.flags || readValue<quint16>(header, 8) != entry.method ||
+            readValue<quint32>(header, 14) != entry.crc) return false;
+        const int nameSize = readValue<quint16>(header, 26);
+        const int extraSize = readValue<quint16>(header, 28);
+        if (_file.read(nameSize) != entry.name) return false;
+        _file.seek(entry.offset + 30 + nameSize + extraSize);
+
+        qint64 leftSz = entry.compressedSize;
+        const bool bEncrypt = entry.flags & 0x1;
+        if (bEncrypt != (nullptr != password)) return false;
+        if (bEncrypt)
+        {
+            initKeys(password);
+            QByteArray encryptHead = _file.read(12);
+            if (encryptHead.size() != 12) return false;
+            decrypt(encryptHead.data(), 12);
+            if (quint8(encryptHead.at(11)) != quint8(entry.crc >> 24)) return false;
+            leftSz -= 12;
+        }
+
+        z_stream stream;
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+        stream.next_in = Z_NULL;
+        stream.avail_in = 0;
+        if (8 == entry.method && Z_OK != inflateInit2(&stream, -MAX_WBITS)) return false;
+
+        std::vector<char> inBuf(1 << 20), outBuf(1 << 20);
+        uLong crc = crc32(0L, Z_NULL, 0);
+        bool bSucceed = (0 == entry.method || 8 == entry.method);
+        int ret = Z_OK;
+        while (bSucceed && leftSz > 0)
+        {
+            const qint64 readSz = _file.read(inBuf.data(), qMin(leftSz, qint64(inBuf.size())));
+            if (readSz <= 0) { bSucceed = false; break; }
+            leftSz -= readSz;
+            if (bEncrypt) decrypt(inBuf.data(), readSz);
+
+            if (0 == entry.method)
+            {
+                crc = crc32(crc, reinterpret_cast<const Bytef *>(inBuf.data()), uInt(readSz));
+                if (data) data->append(inBuf.data(), int(readSz));
+                size += readSz;
+                continue;
+            }
+            stream.next_in = reinterpret_cast<Bytef *>(inBuf.data());
+            stream.avail_in = uInt(readSz);
+            do {
+                stream.next_out = reinterpret_cast<Bytef *>(outBuf.data());
+                stream.avail_out = uInt(outBuf.size());
+                ret = inflate(&stream, Z_NO_FLUSH);
+                if (Z_OK != ret && Z_STREAM_END != ret) { bSucceed = false; break; }
+
+                const qint64 outSz = qint64(outBuf.size()) - stream.avail_out;
+                crc = crc32(crc, reinterpret_cast<const Bytef *>(outBuf.data()), uInt(outSz));
+                if (data) data->append(outBuf.data(), int(outSz));
+                size += outSz;
+            } while (0 == stream.avail_out && Z_STREAM_END != ret);
+        }
+        if (8 == entry.method)
+        {
+            bSucceed = bSucceed && Z_STREAM_END == ret;
+            inflateEnd(&stream);
+        }
+        return bSucceed && quint32(crc) == entry.crc && size == entry.size;
+    }
+
+private:
+    void initKeys(const char *password) {
+        _keys[0] = 305419896;
+        _keys[1] = 591751049;
+        _keys[2] = 878082192;
+        for (const char *p = password; *p; ++ p) updateKeys(quint8(*p));
+    }
+    void updateKeys(const quint8 &c) {
+        const auto *crcTable = get_crc_table();
+        _keys[0] = quint32(crcTable[(_keys[0] ^ c) & 0xFF]) ^ (_keys[0] >> 8);
+        _keys[1] = (_keys[1] + (_keys[0] & 0xFF)) * 134775813 + 1;
+        _keys[2] = quint32(crcTable[(_keys[2] ^ (_keys[1] >> 24)) & 0xFF]) ^ (_keys[2] >> 8);
+    }
+    void decrypt(char *data, const qint64 &size) {
+        for (qint64 i = 0; i < size; ++ i)
+        {
+            const quint32 temp = (_keys[2] | 2) & 0xFFFF;
+            const quint8 plain = quint8(data[i]) ^ quint8((temp * (temp ^ 1)) >> 8);
+            data[i] = char(plain);
+            updateKeys(plain);
+        }
+    }
+
+private:
+    QFile _file;
+    QList<ZipEntry> _entryList;
+    QByteArray _comment;
+    bool _zip64End = false;
+    bool _zip64Entry = false;
+    quint32 _keys[3];
+};
+
+///
+/// @brief 生成测试文件: 可压缩的重复文本与随机字节交替, nSize 为 0 时生成空文件
+///
+QByteArray writeFile(const QString &fileName, const int &nSize, const int &nSeed)
+{
+    std::mt19937 rng(nSeed);
+    QByteArray data;
+    while (data.size() < nSize)
+    {
+        if (rng() & 0x1) data.append(QByteArray("layer scan data ").repeated(int(rng() % 64)));
+        else for (int i = int(rng() % 512); i > 0; -- i) data.append(char(rng() & 0xFF));
+    }
+    data.truncate(nSize);
+
+    QFile file(fileName);
+    if (file.open(QIODevice::WriteOnly)) file.write(data);
+    return data;
+}
+
+bool fileCrc(const QString &fileName, quint32 &crc, qint64 &size)
+{
+    QFile file(fileName);
+    if (false == file.open(QIODevice::ReadOnly)) return false;
+    std::vector<char> buf(4 << 20);
+    uLong value = crc32(0L, Z_NULL, 0);
+    qint64 readSz = 0;
+    size = 0;
+    while ((readSz = file.read(buf.data(), qint64(buf.size()))) > 0)
+    {
+        value = crc32(value, reinterpret_cast<const Bytef *>(buf.data()), uInt(readSz));
+        size += readSz;
+    }
+    crc = quint32(value);
+    return readSz == 0;
+}
+}
+
+class TestJobArchiver : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundTrip_data();
+    void roundTrip();
+    void jobFileRoundTrip();
+    void zip64LargeEntry();
+};
+
+void TestJobArchiver::roundTrip_data()
+{
+    QTest::addColumn<bool>("bStored");
+    QTest::addColumn<bool>("bPassword");
+
+    QTest::newRow("deflated") << false << false;
+    QTest::newRow("stored") << true << false;
+    QTest::newRow("deflated, password") << false << true;
+    QTest::newRow("stored, password") << true << true;
+}
+
+void TestJobArchiver::roundTrip()
+{
+    QFETCH(bool, bStored);
+    QFETCH(bool, bPassword);
+
+    // 与 .uzp 生成流程一致: 零件文件写完即提交, 最后统一生成带密码及注释的压缩包
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const int sizeVec[] = { 0, 1, 1000, 3 << 20, 9 << 20 };
+    QStringList listFile;
+    QList<QByteArray> dataList;
+    JobArchiver archiver;
+    for (int i = 0; i < int(sizeof(sizeVec) / sizeof(int)); ++ i)
+    {
+        listFile << dir.filePath(QString("part_%1_1.usp").arg(i));
+        dataList << writeFile(listFile.last(), sizeVec[i], i + 42);
+        if (i & 0x1) archiver.addFile(listFile.last(), bStored);
+    }
+    // 压缩方式只提前提交部分文件, 其余在生成时提交; 存储方式须在生成前提交
+    if (bStored) for (const auto &fileName : listFile) archiver.addFile(fileName, true);
+
+    const QByteArray comment = "{\"PartInfo\":[]}";
+    const QString zipName = dir.filePath("job.uzp");
+    QVERIFY(archiver.createFilesZip(zipName, listFile, bPassword ? UzpPassword : nullptr, comment));
+
+    ZipReader reader(zipName);
+    QVERIFY(reader.open());
+    QCOMPARE(reader.comment(), comment);
+    QVERIFY(false == reader.isZip64End());
+    QVERIFY(false == reader.hasZip64Entry());
+    QCOMPARE(reader.entryList().size(), listFile.size());
+    for (int i = 0; i < listFile.size(); ++ i)
+    {
+        const auto &entry = reader.entryList()[i];
+        QCOMPARE(QString::fromLocal8Bit(entry.name), QFileInfo(listFile[i]).fileName());
+        QCOMPARE(entry.method, quint16(bStored ? 0 : 8));
+        QCOMPARE(entry.flags, quint16(bPassword ? 1 : 0));
+
+        QByteArray data;
+        qint64 size = 0;
+        QVERIFY(reader.extract(entry, bPassword ? UzpPassword : nullptr, &data, size));
+        QVERIFY(data == dataList[i]);
+    }
+
+    // 密码错误时加密头校验失败
+    if (bPassword)
+    {
+        qint64 size = 0;
+        QVERIFY(false == reader.extract(reader.entryList().last(), "UT20200725", nullptr, size));
+    }
+}
+
+void TestJobArchiver::jobFileRoundTrip()
+{
+    // 与 SLM 作业文件生成流程一致: 内层 .job 压缩 Content.xml 及 JobMetaData.job,
+    // 外层 .zip 中 .job 按存储方式写入, .bin 零件文件压缩写入
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    JobArchiver archiver;
+    const QStringList listPartName { "part_a", "part_b" };
+    QList<QByteArray> binDataList;
+    for (int i = 0; i < listPartName.size(); ++ i)
+    {
+        binDataList << writeFile(dir.filePath(listPartName[i] + ".bin"), (2 + i) << 20, 7 + i);
+        archiver.addFile(dir.filePath(listPartName[i] + ".bin"));
+    }
+
+    QStringList listFile { dir.filePath("Content.xml"), dir.filePath("JobMetaData.job") };
+    const QByteArray contentData = writeFile(listFile[0], 4000, 1);
+    const QByteArray metaData = writeFile(listFile[1], 200000, 2);
+    const QString jobName = dir.filePath("build.job");
+    QVERIFY(archiver.createFilesZip(jobName, listFile, nullptr, "SLM Build File"));
+
+    QFile jobFile(jobName);
+    QVERIFY(jobFile.open(QIODevice::ReadOnly));
+    const QByteArray jobData = jobFile.readAll();
+    jobFile.close();
+
+    listFile = QStringList { jobName };
+    archiver.addFile(jobName, true);
+    for (const auto &name : listPartName) listFile << dir.filePath(name + ".bin");
+    const QString zipName = dir.filePath("build.zip");
+    QVERIFY(archiver.createFilesZip(zipName, listFile, nullptr, "SLM Build File"));
+
+    ZipReader reader(zipName);
+    QVERIFY(reader.open());
+    QCOMPARE(reader.comment(), QByteArray("SLM Build File"));
+    QCOMPARE(reader.entryList().size(), 3);
+    QCOMPARE(reader.entryList()[0].name, QByteArray("build.job"));
+    QCOMPARE(reader.entryList()[0].method, quint16(0));
+    QCOMPARE(reader.entryList()[0].compressedSize, qint64(jobData.size()));
+
+    QByteArray data;
+    qint64 size = 0;
+    QVERIFY(reader.extract(reader.entryList()[0], nullptr, &data, size));
+    QVERIFY(data == jobData);
+    for (int i = 0; i < listPartName.size(); ++ i)
+    {
+        QCOMPARE(reader.entryList()[i + 1].method, quint16(8));
+        data.clear();
+        QVERIFY(reader.extract(reader.entryList()[i + 1], nullptr, &data, size));
+        QVERIFY(data == binDataList[i]);
+    }
+
+    // 内层 .job 本身也是完整的压缩包
+    ZipReader jobReader(jobName);
+    QVERIFY(jobReader.open());
+    QCOMPARE(jobReader.entryList().size(), 2);
+    data.clear();
+    QVERIFY(jobReader.extract(jobReader.entryList()[0], nullptr, &data, size));
+    QVERIFY(data == contentData);
+    data.clear();
+    QVERIFY(jobReader.extract(jobReader.entryList()[1], nullptr, &data, size));
+    QVERIFY(data == metaData);
+}
+
+void TestJobArchiver::zip64LargeEntry()
+{
+    // 超过 4G 的稀疏文件, 主体为零, 尾部为随机数据; 压缩后条目需使用 ZIP64 扩展
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString largeName = dir.filePath("large.bin");
+    const qint64 largeSize = (qint64(1) << 32) + 4096;
+    {
+        QFile file(largeName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        if (false == file.resize(largeSize - 4096)) QSKIP("file system does not support 4 GiB files");
+        QVERIFY(file.seek(largeSize - 4096));
+        std::mt19937 rng(4);
+        QByteArray tail;
+        for (int i = 0; i < 4096; ++ i) tail.append(char(rng() & 0xFF));
+        QCOMPARE(file.write(tail), qint64(tail.size()));
+    }
+    const QString smallName = dir.filePath("small.bin");
+    const QByteArray smallData = writeFile(smallName, 5000, 5);
+
+    quint32 largeCrc = 0;
+    qint64 size = 0;
+    QVERIFY(fileCrc(largeName, largeCrc, size));
+    QCOMPARE(size, largeSize);
+
+    JobArchiver archiver;
+    const QString zipName = dir.filePath("large.uzp");
+    QVERIFY(archiver.createFilesZip(zipName, QStringList { largeName, smallName }, UzpPassword, QByteArray()));
+
+    ZipReader reader(zipName);
+    QVERIFY(reader.open());
+    QVERIFY(reader.hasZip64Entry());
+    QCOMPARE(reader.entryList().size(), 2);
+    const auto &largeEntry = reader.entryList()[0];
+    QCOMPARE(largeEntry.size, largeSize);
+    QCOMPARE(largeEntry.crc, largeCrc);
+    QVERIFY(reader.extract(largeEntry, UzpPassword, nullptr, size));
+    QCOMPARE(size, largeSize);
+
+    QByteArray data;
+    QVERIFY(reader.extract(reader.entryList()[1], UzpPassword, &data, size));
+    QVERIFY(data == smallData);
+}
+
+QTEST_APPLESS_MAIN(TestJobArchiver)
+
+#include "tst_jobarchiver.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_jobarchiver
+SOURCES += tst_jobarchiver.cpp
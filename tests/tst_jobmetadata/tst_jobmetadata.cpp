@@ -0,0 +1,369 @@
+#include <QtTest>
+#include <QBuffer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QXmlStreamWriter>
+#include <random>
+
+#include "sljobfilewriter.h"
+#include "sljfilewriter.h"
+
+namespace {
+///
+/// @brief 随机生成一个零件的层记录, 坐标与面积取任意浮点值
+///
+QMap<int, Layer> makeLayers(std::mt19937 &rng, const int &minLayer, const int &maxLayer)
+{
+    const int vectorTypes[] = { VecBorder, VecHatching, VecUpfacing, VecDownfacing,
+                                VecSupport + VecBorder, VecSupport + VecHatching, VecSupport + VecZeroVolume };
+    std::uniform_real_distribution<float> posDist(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> sizeDist(0.01f, 50.0f);
+    std::uniform_int_distribution<int> blockCntDist(0, 12);
+    std::uniform_int_distribution<int> typeDist(0, int(sizeof(vectorTypes) / sizeof(int)) - 1);
+    std::uniform_int_distribution<int> scannerDist(0, 3);
+    std::uniform_int_distribution<int> skipDist(0, 9);
+
+    QMap<int, Layer> layerMap;
+    qint64 nPos = 61;
+    for (int iLayer = minLayer; iLayer <= maxLayer; ++ iLayer)
+    {
+        if (0 == skipDist(rng)) continue;
+
+        Layer layer;
+        layer.Z = iLayer;
+        layer._totalArea = sizeDist(rng) * sizeDist(rng);
+        layer.fMinX = posDist(rng);
+        layer.fMinY = posDist(rng);
+        layer.fMaxX = layer.fMinX + sizeDist(rng);
+        layer.fMaxY = layer.fMinY + sizeDist(rng);
+        layer.fCenterX = float((layer.fMinX + layer.fMaxX) * 0.5);
+        layer.fCenterY = float((layer.fMinY + layer.fMaxY) * 0.5);
+        const int nBlockCnt = blockCntDist(rng);
+        for (int i = 0; i < nBlockCnt; ++ i)
+        {
+            BlockInfoPtr block(new BlockInfo);
+            block->nPos = nPos;
+            block->nLength = 1 + blockCntDist(rng) * 1000;
+            nPos += block->nLength;
+            block->ScannerIndexRef = scannerDist(rng);
+            block->VectorTypeRef = vectorTypes[typeDist(rng)];
+            block->fMinX = posDist(rng);
+            block->fMinY = posDist(rng);
+            block->fMaxX = block->fMinX + sizeDist(rng);
+            block->fMaxY = block->fMinY + sizeDist(rng);
+            block->fCentX = float((block->fMinX + block->fMaxX) * 0.5);
+            block->fCentY = float((block->fMinY + block->fMaxY) * 0.5);
+            layer.blockList << block;
+        }
+        layerMap.insert(iLayer, layer);
+    }
+    return layerMap;
+}
+
+///
+/// @brief 改为二进制层索引前的 JSON 行格式写入及读取, 作为对照
+///
+void writeLegacyIndex(const QString &fileName, const QMap<int, Layer> &layerMap, const double &thickness)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+
+    QJsonObject obj;
+    obj.insert("LayerThickness", thickness);
+    file.write(QJsonDocument(obj).toJson(QJsonDocument::Compact) + "\n");
+    for (auto i = layerMap.cbegin(); i != layerMap.cend(); ++ i)
+    {
+        QJsonObject layerObj;
+        layerObj.insert("Z", i.key());
+
+        QJsonArray blockArray;
+        for (const auto &blockPtr : i.value().blockList)
+        {
+            QJsonObject blockObj;
+            blockObj.insert("Pos", blockPtr->nPos);
+            blockObj.insert("ScannerIndexRef", blockPtr->ScannerIndexRef);
+            blockObj.insert("VectorTypeRef", blockPtr->VectorTypeRef);
+            blockObj.insert("fMinX", blockPtr->fMinX);
+            blockObj.insert("fMinY", blockPtr->fMinY);
+            blockObj.insert("fMaxX", blockPtr->fMaxX);
+            blockObj.insert("fMaxY", blockPtr->fMaxY);
+            blockObj.insert("fCentX", (blockPtr->fMinX + blockPtr->fMaxX) * 0.5);
+            blockObj.insert("fCentY", (blockPtr->fMinY + blockPtr->fMaxY) * 0.5);
+            blockArray.append(blockObj);
+        }
+
+        layerObj.insert("fTotalArea", i.value()._totalArea);
+        layerObj.insert("fMinX", i.value().fMinX);
+        layerObj.insert("fMaxX", i.value().fMaxX);
+        layerObj.insert("fMinY", i.value().fMinY);
+        layerObj.insert("fMaxY", i.value().fMaxY);
+        layerObj.insert("fCenterX", (i.value().fMinX + i.value().fMaxX) * 0.5);
+        layerObj.insert("fCenterY", (i.value().fMinY + i.value().fMaxY) * 0.5);
+        layerObj.insert("Blocks", blockArray);
+        file.write(QJsonDocument(layerObj).toJson(QJsonDocument::Compact) + "\n");
+    }
+}
+
+void readLegacyIndex(const QString &fileName, const QString &partName, BinFile &binFile, double &thickness)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    binFile.strFileName = partName;
+    thickness = QJsonDocument::fromJson(file.readLine()).object()["LayerThickness"].toDouble();
+    while (false == file.atEnd())
+    {
+        const auto layerObj = QJsonDocument::fromJson(file.readLine()).object();
+        Layer sLayer;
+        sLayer.Z = layerObj["Z"].toInt();
+        sLayer._totalArea = layerObj["fTotalArea"].toDouble();
+        sLayer.fMinX = layerObj["fMinX"].toDouble();
+        sLayer.fMaxX = layerObj["fMaxX"].toDouble();
+        sLayer.fMinY = layerObj["fMinY"].toDouble();
+        sLayer.fMaxY = layerObj["fMaxY"].toDouble();
+        sLayer.fCenterX = layerObj["fCenterX"].toDouble();
+        sLayer.fCenterY = layerObj["fCenterY"].toDouble();
+
+        const auto blockArray = layerObj["Blocks"].toArray();
+        for (const auto &block : blockArray)
+        {
+            BlockInfoPtr sBlock(new BlockInfo);
+            const auto blockObj = block.toObject();
+            sBlock->nPos = blockObj["Pos"].toVariant().toLongLong();
+            sBlock->ScannerIndexRef = blockObj["ScannerIndexRef"].toInt();
+            sBlock->VectorTypeRef = blockObj["VectorTypeRef"].toInt();
+            sBlock->fMinX = blockObj["fMinX"].toVariant().toFloat();
+            sBlock->fMinY = blockObj["fMinY"].toVariant().toFloat();
+            sBlock->fMaxX = blockObj["fMaxX"].toVariant().toFloat();
+            sBlock->fMaxY = blockObj["fMaxY"].toVariant().toFloat();
+            sBlock->fCentX = blockObj["fCentX"].toVariant().toFloat();
+            sBlock->fCentY = blockObj["fCentY"].toVariant().toFloat();
+            sLayer.blockList << sBlock;
+        }
+        binFile.layerMap.insert(sLayer.Z, sLayer);
+    }
+}
+
+QByteArray layersXml(const QStringList &listPartName, const QList<BinFile> &binFileList,
+                     const int &minLayer, const int &maxLayer, const ScanSortTypes &sortParas)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QXmlStreamWriter writer(&buffer);
+    writer.setCodec("UTF-8");
+    writer.writeStartElement("Layers");
+    for (int iLayer = minLayer; iLayer <= maxLayer; ++ iLayer)
+    {
+        SLJobFileWriter::addLayerToMetaDataXML(&writer, iLayer, sortParas, listPartName, binFileList);
+    }
+    writer.writeEndElement();
+    return data;
+}
+}
+
+class TestJobMetaData : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void binaryIndexRoundTrip();
+    void metaDataMatchesLegacy_data();
+    void metaDataMatchesLegacy();
+    void rejectsTruncatedIndex();
+    void streamedIndexMatchesReaders();
+};
+
+void TestJobMetaData::binaryIndexRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    std::mt19937 rng(41);
+    const auto layerMap = makeLayers(rng, 3, 400);
+    const QString strFile = dir.filePath("part_a.lbf");
+    QVERIFY(SLJobFileWriter::writeLayerIndex(strFile, layerMap, 0.03, 3, 400, 123456));
+
+    BinFile binFile;
+    double thickness = 0.0;
+    QVERIFY(SLJobFileWriter::readLayerIndex(strFile, binFile, thickness));
+    QCOMPARE(binFile.strFileName, QString("part_a"));
+    QCOMPARE(thickness, 0.03);
+    QCOMPARE(binFile.layerMap.keys(), layerMap.keys());
+    for (auto i = layerMap.cbegin(); i != layerMap.cend(); ++ i)
+    {
+        const Layer &src = i.value();
+        const Layer &dst = binFile.layerMap[i.key()];
+        QVERIFY(0 == memcmp(&src._totalArea, &dst._totalArea, sizeof(float) * 7));
+        QCOMPARE(dst.blockList.size(), src.blockList.size());
+        for (int iBlock = 0; iBlock < src.blockList.size(); ++ iBlock)
+        {
+            const auto &srcBlock = src.blockList[iBlock];
+            const auto &dstBlock = dst.blockList[iBlock];
+            QCOMPARE(dstBlock->nPos, srcBlock->nPos);
+            QCOMPARE(dstBlock->nLength, srcBlock->nLength);
+            QCOMPARE(dstBlock->ScannerIndexRef, srcBlock->ScannerIndexRef);
+            QCOMPARE(dstBlock->VectorTypeRef, srcBlock->VectorTypeRef);
+            QVERIFY(0 == memcmp(&srcBlock->fMinX, &dstBlock->fMinX, sizeof(float) * 6));
+        }
+    }
+}
+
+void TestJobMetaData::metaDataMatchesLegacy_data()
+{
+    QTest::addColumn<int>("nScanHatchingFirst");
+    QTest::addColumn<int>("nWindDirection");
+
+    QTest::newRow("hatching first, wind 0") << 1 << 0;
+    QTest::newRow("border first, wind 1") << 0 << 1;
+    QTest::newRow("hatching first, wind 2") << 1 << 2;
+    QTest::newRow("border first, wind 3") << 0 << 3;
+}
+
+void TestJobMetaData::metaDataMatchesLegacy()
+{
+    QFETCH(int, nScanHatchingFirst);
+    QFETCH(int, nWindDirection);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    std::mt19937 rng(2026);
+    const QStringList listPartName { "part_a", "part_b", "part_c" };
+    const int layerRange[3][2] = { { 1, 300 }, { 40, 260 }, { 120, 420 } };
+
+    QList<BinFile> binaryList, legacyList;
+    for (int iPart = 0; iPart < listPartName.size(); ++ iPart)
+    {
+        const auto layerMap = makeLayers(rng, layerRange[iPart][0], layerRange[iPart][1]);
+        const QString strBinary = dir.filePath(listPartName[iPart] + ".lbf");
+        const QString strLegacy = dir.filePath(listPartName[iPart] + ".json");
+        QVERIFY(SLJobFileWriter::writeLayerIndex(strBinary, layerMap, 0.02, layerRange[iPart][0],
+                                                 layerRange[iPart][1], 0));
+        writeLegacyIndex(strLegacy, layerMap, 0.02);
+
+        BinFile binaryFile, legacyFile;
+        double binaryThickness = 0.0, legacyThickness = 0.0;
+        QVERIFY(SLJobFileWriter::readLayerIndex(strBinary, binaryFile, binaryThickness));
+        readLegacyIndex(strLegacy, listPartName[iPart], legacyFile, legacyThickness);
+        QCOMPARE(binaryThickness, legacyThickness);
+        binaryList << binaryFile;
+        legacyList << legacyFile;
+    }
+
+    ScanSortTypes sortParas;
+    sortParas.nScanHatchingFirst = nScanHatchingFirst;
+    sortParas.nWindDirection = nWindDirection;
+    const QByteArray binaryXml = layersXml(listPartName, binaryList, 1, 420, sortParas);
+    const QByteArray legacyXml = layersXml(listPartName, legacyList, 1, 420, sortParas);
+    QVERIFY(binaryXml.contains("<DataBlock>"));
+    QCOMPARE(binaryXml, legacyXml);
+}
+
+void TestJobMetaData::rejectsTruncatedIndex()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    std::mt19937 rng(7);
+    const QString strFile = dir.filePath("part_a.lbf");
+    QVERIFY(SLJobFileWriter::writeLayerIndex(strFile, makeLayers(rng, 1, 50), 0.03, 1, 50, 0));
+
+    QFile file(strFile);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.resize(file.size() - 10));
+    file.close();
+
+    BinFile binFile;
+    double thickness = 0.0;
+    QVERIFY(false == SLJobFileWriter::readLayerIndex(strFile, binFile, thickness));
+}
+
+void TestJobMetaData::streamedIndexMatchesReaders()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    std::mt19937 rng(1188);
+    const QString path = dir.path() + "/";
+    const QStringList listPartName { "part_a", "part_b", "part_missing", "part_c" };
+    const int layerRange[3][2] = { { 5, 200 }, { 1, 90 }, { 60, 310 } };
+    const double thicknessVec[3] = { 0.03, 0.02, 0.04 };
+
+    // 与 SLJobFileWriter 相同: 打开后逐层写入, 结束时回写文件头; part_missing 没有层索引
+    QList<BinFile> refList;
+    for (int iPart = 0, iRange = 0; iPart < listPartName.size(); ++ iPart)
+    {
+        if (listPartName[iPart].endsWith("missing")) continue;
+
+        BinFile binFile;
+        binFile.strFileName = listPartName[iPart];
+        binFile.layerMap = makeLayers(rng, layerRange[iRange][0], layerRange[iRange][1]);
+        LayerIndexWriter writer(path + listPartName[iPart] + ".lbf");
+        QVERIFY(writer.open());
+        for (const auto &layer : binFile.layerMap) QVERIFY(writer.writeLayer(layer));
+        QVERIFY(writer.close(thicknessVec[iRange], layerRange[iRange][0], layerRange[iRange][1], 4096));
+        refList << binFile;
+        ++ iRange;
+    }
+
+    int nMinLayer = 0x7FFFFFFF;
+    int nMaxLayer = 0;
+    double thickness = 1;
+    QList<QSharedPointer<LayerIndexReader>> readerList;
+    SLJobFileWriter::openIndexReaders(path, listPartName, readerList, nMinLayer, nMaxLayer, thickness);
+    QCOMPARE(readerList.size(), 3);
+    QCOMPARE(nMinLayer, refList[1].layerMap.firstKey());
+    QCOMPARE(nMaxLayer, refList[2].layerMap.lastKey());
+    QCOMPARE(thickness, 0.02);
+    for (int i = 0; i < readerList.size(); ++ i)
+    {
+        const auto &header = readerList[i]->header();
+        QCOMPARE(readerList[i]->partName(), refList[i].strFileName);
+        QCOMPARE(header.nLayerCnt, qint32(refList[i].layerMap.size()));
+        QCOMPARE(header.nMinLayer, qint32(refList[i].layerMap.firstKey()));
+        QCOMPARE(header.nMaxLayer, qint32(refList[i].layerMap.lastKey()));
+        QCOMPARE(header.nFileSize, qint64(4096));
+    }
+
+    // 与 createJFileMetaDataXML 相同: 各读取器按层号同步向前读取, 逐层生成 XML
+    ScanSortTypes sortParas;
+    QByteArray streamedXml, refXml;
+    for (int iLayer = nMinLayer; iLayer <= nMaxLayer; ++ iLayer)
+    {
+        QList<BinFile> binFileList, refLayerList;
+        for (int i = 0; i < readerList.size(); ++ i)
+        {
+            const auto &reader = readerList[i];
+            QCOMPARE(reader->hasLayer(iLayer), refList[i].layerMap.contains(iLayer));
+            if (false == reader->hasLayer(iLayer)) continue;
+
+            BinFile binFile;
+            Layer sLayer;
+            binFile.strFileName = reader->partName();
+            QVERIFY(reader->readLayer(sLayer));
+            const Layer &refLayer = refList[i].layerMap[iLayer];
+            QCOMPARE(sLayer.Z, iLayer);
+            QCOMPARE(sLayer.blockList.size(), refLayer.blockList.size());
+            for (int iBlock = 0; iBlock < refLayer.blockList.size(); ++ iBlock)
+            {
+                QCOMPARE(sLayer.blockList[iBlock]->nPos, refLayer.blockList[iBlock]->nPos);
+                QCOMPARE(sLayer.blockList[iBlock]->nLength, refLayer.blockList[iBlock]->nLength);
+            }
+            binFile.layerMap.insert(iLayer, sLayer);
+            binFileList << binFile;
+
+            BinFile refFile;
+            refFile.strFileName = refList[i].strFileName;
+            refFile.layerMap.insert(iLayer, refLayer);
+            refLayerList << refFile;
+        }
+        streamedXml += layersXml(listPartName, binFileList, iLayer, iLayer, sortParas);
+        refXml += layersXml(listPartName, refLayerList, iLayer, iLayer, sortParas);
+    }
+    QVERIFY(streamedXml.contains("<DataBlock>"));
+    QCOMPARE(streamedXml, refXml);
+    for (const auto &reader : qAsConst(readerList)) QVERIFY(false == reader->hasLayer(nMaxLayer + 1));
+}
+
+QTEST_APPLESS_MAIN(TestJobMetaData)
+
+#include "tst_jobmetadata.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_jobmetadata
+SOURCES += tst_jobmetadata.cpp
@@ -0,0 +1,218 @@
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include "algorithmapplication.h"
+#include "LatticeModule/latticeinterface.h"
+
+using namespace ClipperLib;
+
+namespace {
+const int CellSpacing = 8000;
+
+///
+/// @brief 晶格截面: 类型 0 为斜置四边形, 类型 1 为六边形, 顶点坐标相对晶格基准点
+///
+Path latticeShape(const int &nType)
+{
+    if(0 == nType)
+    {
+        return Path { IntPoint(0, 1500), IntPoint(2100, 0), IntPoint(3300, 1900), IntPoint(1200, 3400) };
+    }
+    return Path { IntPoint(700, 0), IntPoint(2300, 0), IntPoint(3000, 1300), IntPoint(2300, 2600),
+                  IntPoint(700, 2600), IntPoint(0, 1300) };
+}
+
+///
+/// @brief 生成层晶格信息, 与 calcLayerLattic 输出结构一致: 各类型第一个晶格作为代表晶格
+///
+LatticeLayerInfo makeLayer(const int &nPhase, const qint64 &nOriginX, const qint64 &nOriginY)
+{
+    LatticeLayerInfo layerInfo;
+    layerInfo._phase = nPhase;
+    for(int iCell = 0; iCell < 12; ++ iCell)
+    {
+        const int nType = iCell & 0x1;
+        const int nCenterX = int(nOriginX + (iCell % 4) * CellSpacing);
+        const int nCenterY = int(nOriginY + (iCell / 4) * CellSpacing);
+        Path path = latticeShape(nType);
+        for(auto &pt : path)
+        {
+            pt.X += nCenterX;
+            pt.Y += nCenterY;
+        }
+        if(false == layerInfo._latticePathInfo.contains(nType))
+        {
+            LatticePathInfo pathInfo;
+            pathInfo._type = nType;
+            pathInfo._path = path;
+            pathInfo._centerX = nCenterX;
+            pathInfo._centerY = nCenterY;
+            layerInfo._latticePathInfo.insert(nType, pathInfo);
+        }
+        layerInfo._latticeInfo << LatticeInfo(nType, Area(path), nCenterX, nCenterY);
+    }
+    return layerInfo;
+}
+
+///
+/// @brief 单扫描器单光束写入缓冲区, 填充参数固定
+///
+bool initWriteBuff(PARAWRITEBUFF &writeBuff, const QString &strFile, const int &nUseCache)
+{
+    writeBuff._writerBufferParas = QSharedPointer<WriterBufferParas>(new WriterBufferParas);
+    writeBuff._writerBufferParas->_extendedParaPtr->addVariantMap(QVariantMap { { "Lattice/useHatchCache", nUseCache } });
+
+    auto *_writeBuff = &writeBuff;
+    BpcParas->nNumber_SplicingScanner = 1;
+    BpcParas->nScannerNumber = 1;
+    BpcParas->nPlatWidthX = 400;
+    BpcParas->nPlatWidthY = 400;
+    BpcParas->fFactor_3 = 1.0f;
+    BpcParas->fFactor_4 = 1.0f;
+    BpcParas->fFactor_8 = 1.0f;
+    BpcParas->fFactor_10 = 1.0f;
+    BppParas->sGeneralPara.nNumber_Beam = 1;
+    BppParas->sGeneralPara.nUseSplicingMode = 0;
+    BppParas->sGeneralPara.nLaserPower[0] = 200;
+
+    HATCHINGPARAMETERS *lpParas = &BppParas->sHatchingPara;
+    lpParas->nHatchingType[0] = HATCHTYPE_LINES;
+    lpParas->fLineSpacing[HATCHINGBEAM_NORMAL] = 0.1f;
+    lpParas->fOffset[HATCHINGBEAM_NORMAL] = 0.0f;
+    lpParas->nScanTimes[HATCHINGBEAM_NORMAL] = 1;
+    lpParas->nIndex_Power[HATCHINGBEAM_NORMAL] = 0;
+    lpParas->nIndex_BeamSize[HATCHINGBEAM_NORMAL] = 0;
+    lpParas->nMarkSpeed[HATCHINGBEAM_NORMAL] = 1000;
+    lpParas->nCLineFactor = 0;
+
+    writeBuff.gFile.setFileName(strFile);
+    return writeBuff.createUFileData();
+}
+
+///
+/// @brief 取出队列中的全部数据块
+///
+QVector<UFFWRITEDATA> takeBlocks(PARAWRITEBUFF &writeBuff)
+{
+    QVector<UFFWRITEDATA> blocks;
+    UFILEDATA *lpFileData = writeBuff.gUFileData[0][0].data();
+    QMutexLocker locker(lpFileData->gQueue.locker());
+    UFFWRITEDATA mUFileData;
+    while(lpFileData->gQueue.take(mUFileData)) blocks << mUFileData;
+    return blocks;
+}
+
+///
+/// @brief 逐块比较块头参数及扫描线
+///
+bool sameBlocks(const QVector<UFFWRITEDATA> &lhs, const QVector<UFFWRITEDATA> &rhs, QString &strError)
+{
+    if(lhs.size() != rhs.size())
+    {
+        strError = QString("block count %1 != %2").arg(lhs.size()).arg(rhs.size());
+        return false;
+    }
+    for(int iBlock = 0; iBlock < lhs.size(); ++ iBlock)
+    {
+        const auto &lData = lhs[iBlock], &rData = rhs[iBlock];
+        if(lData.nMode_Section != rData.nMode_Section || lData.nMode_Coor != rData.nMode_Coor ||
+           lData.nPartIndex != rData.nPartIndex || lData.nLaserPower != rData.nLaserPower ||
+           lData.nMarkSpeed != rData.nMarkSpeed)
+        {
+            strError = QString("block %1 header differs").arg(iBlock);
+            return false;
+        }
+        const auto lView = lData.lineView(), rView = rData.lineView();
+        if(lView.size() != rView.size())
+        {
+            strError = QString("block %1 line count %2 != %3").arg(iBlock).arg(lView.size()).arg(rView.size());
+            return false;
+        }
+        for(int iLine = 0; iLine < lView.size(); ++ iLine)
+        {
+            if(lView.type(iLine) != rView.type(iLine) || lView.x(iLine) != rView.x(iLine) || lView.y(iLine) != rView.y(iLine))
+            {
+                strError = QString("block %1 line %2: (%3,%4) != (%5,%6)").arg(iBlock).arg(iLine)
+                               .arg(lView.x(iLine)).arg(lView.y(iLine)).arg(rView.x(iLine)).arg(rView.y(iLine));
+                return false;
+            }
+        }
+    }
+    return true;
+}
+}
+
+class TestLatticeHatchCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cachedMatchesUncached_data();
+    void cachedMatchesUncached();
+};
+
+void TestLatticeHatchCache::cachedMatchesUncached_data()
+{
+    QTest::addColumn<double>("fAngle");
+
+    QTest::newRow("0 deg") << 0.0;
+    QTest::newRow("30 deg") << 30.0;
+    QTest::newRow("67 deg") << 67.0;
+    QTest::newRow("90 deg") << 90.0;
+    QTest::newRow("137 deg") << 137.0;
+}
+
+void TestLatticeHatchCache::cachedMatchesUncached()
+{
+    QFETCH(double, fAngle);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    // 相位相同的两层, 代表晶格位于不同位置; 第二层命中第一层缓存的模板
+    const LatticeLayerInfo layerA = makeLayer(2, 1000, 2000);
+    const LatticeLayerInfo layerB = makeLayer(2, 123457, -98765);
+
+    PARAWRITEBUFF cachedBuff;
+    QVERIFY(initWriteBuff(cachedBuff, dir.filePath("cached.usp"), 1));
+    AlgorithmApplication cachedAlgo;
+    cachedAlgo.setBuffParas(&cachedBuff);
+    cachedAlgo.setHatchingAngle(fAngle);
+    LatticeLayerInfo cachedLayer = layerA;
+    cachedAlgo.writeHatchingData(cachedLayer, 1.0, 1.0, 1.0);
+    const auto blocksA = takeBlocks(cachedBuff);
+    cachedLayer = layerB;
+    cachedAlgo.writeHatchingData(cachedLayer, 1.0, 1.0, 1.0);
+    const auto cachedBlocks = takeBlocks(cachedBuff);
+
+    PARAWRITEBUFF uncachedBuff;
+    QVERIFY(initWriteBuff(uncachedBuff, dir.filePath("uncached.usp"), 0));
+    AlgorithmApplication uncachedAlgo;
+    uncachedAlgo.setBuffParas(&uncachedBuff);
+    uncachedAlgo.setHatchingAngle(fAngle);
+    LatticeLayerInfo uncachedLayer = layerB;
+    uncachedAlgo.writeHatchingData(uncachedLayer, 1.0, 1.0, 1.0);
+    const auto uncachedBlocks = takeBlocks(uncachedBuff);
+
+    QVERIFY(blocksA.size() > 0);
+    QCOMPARE(cachedBlocks.size(), blocksA.size());
+    QString strError;
+    QVERIFY2(sameBlocks(cachedBlocks, uncachedBlocks, strError), qPrintable(strError));
+
+    // 两层晶格相对各自基准点的填充线一致
+    const qint32 nDX = 123457 - 1000, nDY = -98765 - 2000;
+    for(int iBlock = 0; iBlock < blocksA.size(); ++ iBlock)
+    {
+        const auto viewA = blocksA[iBlock].lineView(), viewB = cachedBlocks[iBlock].lineView();
+        QCOMPARE(viewB.size(), viewA.size());
+        for(int iLine = 0; iLine < viewA.size(); ++ iLine)
+        {
+            QCOMPARE(viewB.x(iLine), viewA.x(iLine) + nDX);
+            QCOMPARE(viewB.y(iLine), viewA.y(iLine) + nDY);
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(TestLatticeHatchCache)
+
+#include "tst_latticehatchcache.moc"
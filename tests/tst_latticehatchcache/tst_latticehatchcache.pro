@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_latticehatchcache
+SOURCES += tst_latticehatchcache.cpp
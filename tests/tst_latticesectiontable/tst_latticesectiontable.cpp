@@ -0,0 +1,139 @@
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include "publicheader.h"
+#include "LatticeModule/latticsdiamond.h"
+
+namespace {
+const double LineSpacing = 0.1;
+const double LayerThickness = 0.03;
+
+///
+/// @brief 按默认支腿参数初始化菱形晶格
+///
+void initDiamond(LatticsDiamond &diamond)
+{
+    WriterBufferParas paras;
+    paras._extendedParaPtr->addVariantMap(QVariantMap { { "Lattice/legDiameter", 2.0 },
+                                                        { "Lattice/legLength", 5.0 },
+                                                        { "Lattice/toolCompensation", 0.07 } });
+    diamond.initLatticeParas(paras._extendedParaPtr.data());
+}
+
+///
+/// @brief 层高度, 层间距与层厚一致; 默认支腿参数下晶格周期约 13.4mm, 取 15mm 覆盖整个周期
+///
+QVector<int> periodHeights()
+{
+    QVector<int> layerHeis;
+    const int nStep = qRound(LayerThickness * UNITSPRECISION);
+    for (int nHei = nStep; nHei <= qRound(15.0 * UNITSPRECISION); nHei += nStep) layerHeis << nHei;
+    return layerHeis;
+}
+
+///
+/// @brief 读取截面库文件头中的扫描线间距及层厚
+///
+bool readHeader(const QString &cachePath, double &lineSpacing, double &layerThickness)
+{
+    QFile file(cachePath);
+    if (false == file.open(QIODevice::ReadOnly)) return false;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    quint32 magic = 0, version = 0;
+    double legDiameter = 0.0, legLength = 0.0, toolCompensation = 0.0;
+    stream >> magic >> version >> legDiameter >> legLength >> toolCompensation >> lineSpacing >> layerThickness;
+    return QDataStream::Ok == stream.status();
+}
+}
+
+class TestLatticeSectionTable : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void loadedMatchesComputed();
+    void rejectsChangedKey_data();
+    void rejectsChangedKey();
+};
+
+void TestLatticeSectionTable::loadedMatchesComputed()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString cachePath = dir.filePath("part.lattice");
+
+    // 预计算并保存截面库
+    LatticsDiamond writer;
+    initDiamond(writer);
+    const auto layerHeis = periodHeights();
+    writer.precomputeLattics(layerHeis, cachePath, LineSpacing, LayerThickness, false);
+    QVERIFY(QFileInfo::exists(cachePath));
+    const QDateTime savedTime = QFileInfo(cachePath).lastModified();
+    const qint64 nSavedSize = QFileInfo(cachePath).size();
+
+    // 读取截面库, 全部相位命中时不重新保存
+    LatticsDiamond loader;
+    initDiamond(loader);
+    loader.precomputeLattics(layerHeis, cachePath, LineSpacing, LayerThickness, false);
+    QCOMPARE(QFileInfo(cachePath).size(), nSavedSize);
+    QCOMPARE(QFileInfo(cachePath).lastModified(), savedTime);
+
+    // 不使用截面库, 逐层切片计算
+    LatticsDiamond fresh;
+    initDiamond(fresh);
+    for (const auto &nHei : layerHeis)
+    {
+        QCOMPARE(loader.getPhase(nHei), fresh.getPhase(nHei));
+        const auto loadedPaths = loader.createLattics(nHei);
+        const auto freshPaths = fresh.createLattics(nHei);
+        QCOMPARE(loadedPaths.size(), freshPaths.size());
+        for (int iPath = 0; iPath < freshPaths.size(); ++ iPath)
+        {
+            QCOMPARE(loadedPaths[iPath].size(), freshPaths[iPath].size());
+            for (int iPt = 0; iPt < freshPaths[iPath].size(); ++ iPt)
+            {
+                QCOMPARE(loadedPaths[iPath][iPt].X, freshPaths[iPath][iPt].X);
+                QCOMPARE(loadedPaths[iPath][iPt].Y, freshPaths[iPath][iPt].Y);
+            }
+        }
+    }
+}
+
+void TestLatticeSectionTable::rejectsChangedKey_data()
+{
+    QTest::addColumn<double>("lineSpacing");
+    QTest::addColumn<double>("layerThickness");
+
+    QTest::newRow("line spacing") << LineSpacing * 2 << LayerThickness;
+    QTest::newRow("layer thickness") << LineSpacing << LayerThickness * 2;
+}
+
+void TestLatticeSectionTable::rejectsChangedKey()
+{
+    QFETCH(double, lineSpacing);
+    QFETCH(double, layerThickness);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString cachePath = dir.filePath("part.lattice");
+
+    LatticsDiamond writer;
+    initDiamond(writer);
+    const auto layerHeis = periodHeights();
+    writer.precomputeLattics(layerHeis, cachePath, LineSpacing, LayerThickness, false);
+
+    // 键值不一致时不读取原文件, 重新计算后以新键值覆盖
+    LatticsDiamond loader;
+    initDiamond(loader);
+    loader.precomputeLattics(layerHeis, cachePath, lineSpacing, layerThickness, false);
+    double savedLineSpacing = 0.0, savedLayerThickness = 0.0;
+    QVERIFY(readHeader(cachePath, savedLineSpacing, savedLayerThickness));
+    QCOMPARE(savedLineSpacing, lineSpacing);
+    QCOMPARE(savedLayerThickness, layerThickness);
+}
+
+QTEST_APPLESS_MAIN(TestLatticeSectionTable)
+
+#include "tst_latticesectiontable.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_latticesectiontable
+SOURCES += tst_latticesectiontable.cpp
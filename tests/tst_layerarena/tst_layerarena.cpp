@@ -0,0 +1,309 @@
+#include <QtTest>
+#include <QFile>
+#include <random>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#include <unistd.h>
+#endif
+
+#include "layerarena.h"
+#include "ScanLinesSortor/quadtreesortor.h"
+
+namespace {
+///
+/// @brief 四叉树节点大小的对象, 与排序中的 Node/MPtInfo 相近
+///
+struct BenchNode {
+    int _values[6] = { 0 };
+    ArenaUniquePtr<BenchNode> _children[4];
+};
+
+///
+/// @brief 析构计数对象
+///
+struct CountedNode {
+    static int s_nAliveCnt;
+    qint64 _value = 0;
+
+    explicit CountedNode(const qint64 &value) : _value(value) { ++ s_nAliveCnt; }
+    ~CountedNode() { -- s_nAliveCnt; }
+};
+int CountedNode::s_nAliveCnt = 0;
+
+///
+/// @brief 单层内存占用采样
+///
+struct MemorySample {
+    qint64 nHeapBytes = -1;     // 分配器在用字节数(含内存池向系统申请的块)
+    qint64 nRssBytes = -1;      // 进程常驻内存
+};
+
+MemorySample sampleMemory()
+{
+    MemorySample sample;
+#if defined(__GLIBC__)
+#if __GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33)
+    const auto info = mallinfo2();
+#else
+    const auto info = mallinfo();
+#endif
+    sample.nHeapBytes = qint64(info.uordblks) + qint64(info.hblkhd);
+
+    QFile file("/proc/self/statm");
+    if(file.open(QIODevice::ReadOnly))
+    {
+        const auto fields = file.readAll().split(' ');
+        if(fields.size() > 1) sample.nRssBytes = fields[1].toLongLong() * qint64(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return sample;
+}
+
+///
+/// @brief 单层排序的分配模式: 网格桶随机插入索引, 并创建大量小节点
+/// @param peakSample 非空时在全部对象仍存活时采样内存占用
+///
+qint64 layerWorkload(std::mt19937 &rng, const int &nInsertCnt, const int &nNodeCnt, MemorySample *peakSample = nullptr)
+{
+    std::vector<ArenaVector<int>> mesh(size_t(2 * 51 * 51));
+    for(int i = 0; i < nInsertCnt; ++ i) mesh[rng() % mesh.size()].push_back(i);
+
+    // 节点按四叉挂接, 与排序中的 Node 一致为独占所有权
+    std::vector<ArenaUniquePtr<BenchNode>> roots;
+    roots.reserve(size_t(nNodeCnt / 4 + 1));
+    for(int i = 0; i < nNodeCnt; ++ i)
+    {
+        auto node = arenaMakeUnique<BenchNode>();
+        if(0 == i % 4) roots.push_back(std::move(node));
+        else roots.back()->_children[i % 4] = std::move(node);
+    }
+
+    qint64 nTotal = 0;
+    for(const auto &bucket : mesh) nTotal += qint64(bucket.size());
+    if(peakSample) *peakSample = sampleMemory();
+    return nTotal + qint64(nNodeCnt);
+}
+
+///
+/// @brief 随机扫描线
+///
+Paths makePaths(const int &nPathCnt, const int &nSeed)
+{
+    std::mt19937 rng(nSeed);
+    std::uniform_int_distribution<int> coorDist(0, 6000000);
+    Paths paths;
+    for(int i = 0; i < nPathCnt; ++ i)
+    {
+        Path path;
+        path.push_back(IntPoint(coorDist(rng), coorDist(rng)));
+        path.push_back(IntPoint(coorDist(rng), coorDist(rng)));
+        paths.push_back(path);
+    }
+    return paths;
+}
+}
+
+class TestLayerArena : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void allocateCountsOnce();
+    void alignment();
+    void resetReusesBlocks();
+    void markRewinds();
+    void scopeEnablesArena();
+    void uniquePtrDestructs();
+    void quadtreeArenaMatchesHeap();
+    void benchmarkLayer_data();
+    void benchmarkLayer();
+};
+
+void TestLayerArena::allocateCountsOnce()
+{
+    // 超过块大小的请求单独成块, 统计只计一次
+    LayerArena arena(1024, 4096);
+    QVERIFY(nullptr != arena.allocate(4000, 8));
+    QCOMPARE(arena.stats().nAllocCnt, qint64(1));
+    QCOMPARE(arena.stats().nAllocBytes, qint64(4000));
+    QCOMPARE(arena.stats().nBlockCnt, qint64(1));
+
+    // 当前块放不下时新申请一块
+    QVERIFY(nullptr != arena.allocate(64, 8));
+    QCOMPARE(arena.stats().nAllocCnt, qint64(2));
+    QCOMPARE(arena.stats().nAllocBytes, qint64(4064));
+    QCOMPARE(arena.stats().nBlockCnt, qint64(2));
+    QCOMPARE(arena.usedBytes(), size_t(4064));
+}
+
+void TestLayerArena::alignment()
+{
+    LayerArena arena;
+    QVERIFY(nullptr != arena.allocate(1, 1));
+    for(const size_t align : { size_t(2), size_t(8), size_t(16), size_t(64) })
+    {
+        void *ptr = arena.allocate(3, align);
+        QCOMPARE(reinterpret_cast<size_t>(ptr) % align, size_t(0));
+    }
+}
+
+void TestLayerArena::resetReusesBlocks()
+{
+    LayerArena arena(1024, 1 << 20);
+    for(int i = 0; i < 100; ++ i) arena.allocate(100, 8);
+    const qint64 nBlockCnt = arena.stats().nBlockCnt;
+    QVERIFY(nBlockCnt > 1);
+
+    arena.reset();
+    QCOMPARE(arena.usedBytes(), size_t(0));
+    for(int i = 0; i < 100; ++ i) arena.allocate(100, 8);
+    QCOMPARE(arena.stats().nBlockCnt, nBlockCnt);
+    QCOMPARE(arena.stats().nResetCnt, qint64(1));
+}
+
+void TestLayerArena::markRewinds()
+{
+    LayerArenaScope scope(true);
+    LayerArena *arena = LayerArena::current();
+    QVERIFY(nullptr != arena);
+    arena->allocate(16, 8);
+    const size_t nUsedBytes = arena->usedBytes();
+    {
+        LayerArenaMark arenaMark;
+        ArenaVector<int> values(size_t(1 << 20));
+        QVERIFY(arena->usedBytes() > nUsedBytes);
+    }
+    QCOMPARE(arena->usedBytes(), nUsedBytes);
+
+    // 回退后的内存块被后续分配复用
+    const qint64 nBlockCnt = arena->stats().nBlockCnt;
+    {
+        LayerArenaMark arenaMark;
+        ArenaVector<int> values(size_t(1 << 20));
+    }
+    QCOMPARE(arena->stats().nBlockCnt, nBlockCnt);
+}
+
+void TestLayerArena::scopeEnablesArena()
+{
+    LayerArena::clearTotalStats();
+    QVERIFY(nullptr == LayerArena::current());
+    {
+        LayerArenaScope scope(false);
+        QVERIFY(nullptr == LayerArena::current());
+        auto ptr = arenaCreate<BenchNode>();
+        QVERIFY(false == ptr.isNull());
+    }
+    {
+        LayerArenaScope scope(true);
+        QVERIFY(nullptr != LayerArena::current());
+        {
+            // 嵌套作用域以最外层为准
+            LayerArenaScope innerScope(false);
+            QVERIFY(nullptr != LayerArena::current());
+            ArenaVector<int> values(100);
+        }
+        QVERIFY(nullptr != LayerArena::current());
+    }
+    QVERIFY(nullptr == LayerArena::current());
+
+    const auto stats = LayerArena::totalStats();
+    QCOMPARE(stats.nResetCnt, qint64(1));
+    QCOMPARE(stats.nAllocCnt, qint64(1));
+    QCOMPARE(stats.nAllocBytes, qint64(100 * sizeof(int)));
+}
+
+void TestLayerArena::uniquePtrDestructs()
+{
+    // 不在作用域内时等同于 new/delete
+    {
+        auto ptr = arenaMakeUnique<CountedNode>(1);
+        QCOMPARE(CountedNode::s_nAliveCnt, 1);
+        QCOMPARE(ptr->_value, qint64(1));
+    }
+    QCOMPARE(CountedNode::s_nAliveCnt, 0);
+
+    // 作用域内从内存池分配, 释放时只调用析构函数
+    LayerArenaScope scope(true);
+    LayerArena *arena = LayerArena::current();
+    QVERIFY(nullptr != arena);
+    const size_t nUsedBytes = arena->usedBytes();
+    {
+        auto ptr = arenaMakeUnique<CountedNode>(2);
+        ArenaUniquePtr<CountedNode> moved = std::move(ptr);
+        QCOMPARE(CountedNode::s_nAliveCnt, 1);
+        QCOMPARE(arena->usedBytes(), nUsedBytes + sizeof(CountedNode));
+        QVERIFY(nullptr == ptr);
+        QCOMPARE(moved->_value, qint64(2));
+    }
+    QCOMPARE(CountedNode::s_nAliveCnt, 0);
+    QCOMPARE(arena->usedBytes(), nUsedBytes + sizeof(CountedNode));
+}
+
+void TestLayerArena::quadtreeArenaMatchesHeap()
+{
+    // 四叉树节点改为独占所有权后, 堆与内存池两种分配方式排序结果一致
+    const auto srcPaths = makePaths(5000, 48);
+    Paths heapPaths = srcPaths, arenaPaths = srcPaths;
+    QuadtreeSortor().sortPaths(heapPaths);
+    {
+        LayerArenaScope scope(true);
+        QuadtreeSortor().sortPaths(arenaPaths);
+    }
+    QCOMPARE(heapPaths.size(), srcPaths.size());
+    QVERIFY(heapPaths == arenaPaths);
+
+    // 排序结果为原路径的一个排列
+    auto lessPath = [](const Path &lhs, const Path &rhs) {
+        return std::make_pair(lhs[0].X, lhs[0].Y) < std::make_pair(rhs[0].X, rhs[0].Y);
+    };
+    Paths sortedSrc = srcPaths;
+    std::sort(sortedSrc.begin(), sortedSrc.end(), lessPath);
+    std::sort(heapPaths.begin(), heapPaths.end(), lessPath);
+    QVERIFY(sortedSrc == heapPaths);
+}
+
+void TestLayerArena::benchmarkLayer_data()
+{
+    QTest::addColumn<bool>("bArena");
+    QTest::addColumn<int>("nInsertCnt");
+    QTest::addColumn<int>("nNodeCnt");
+
+    QTest::newRow("heap, 200k inserts + 50k nodes") << false << 200000 << 50000;
+    QTest::newRow("arena, 200k inserts + 50k nodes") << true << 200000 << 50000;
+    QTest::newRow("heap, 20k inserts + 200k nodes") << false << 20000 << 200000;
+    QTest::newRow("arena, 20k inserts + 200k nodes") << true << 20000 << 200000;
+}
+
+void TestLayerArena::benchmarkLayer()
+{
+    QFETCH(bool, bArena);
+    QFETCH(int, nInsertCnt);
+    QFETCH(int, nNodeCnt);
+
+    std::mt19937 rng(47);
+    qint64 nTotal = 0;
+    QBENCHMARK {
+        LayerArenaScope scope(bArena);
+        nTotal = layerWorkload(rng, nInsertCnt, nNodeCnt);
+    }
+    QCOMPARE(nTotal, qint64(nInsertCnt + nNodeCnt));
+
+    // 单层内存占用: 对象全部存活时的分配器在用字节数和常驻内存增量, 内存池另计块容量及使用峰值
+    const MemorySample before = sampleMemory();
+    MemorySample peak;
+    LayerArenaStats arenaStats;
+    {
+        LayerArenaScope scope(bArena);
+        layerWorkload(rng, nInsertCnt, nNodeCnt, &peak);
+        if(LayerArena *arena = LayerArena::current()) arenaStats = arena->stats();
+    }
+    qDebug() << (bArena ? "arena" : "heap")
+             << "heap in use" << (before.nHeapBytes < 0 ? -1 : peak.nHeapBytes - before.nHeapBytes)
+             << "rss delta" << (before.nRssBytes < 0 ? -1 : peak.nRssBytes - before.nRssBytes)
+             << "arena capacity" << arenaStats.nCapacity << "arena peak" << arenaStats.nPeakBytes;
+}
+
+QTEST_APPLESS_MAIN(TestLayerArena)
+
+#include "tst_layerarena.moc"
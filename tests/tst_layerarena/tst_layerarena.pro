@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_layerarena
+SOURCES += tst_layerarena.cpp
@@ -0,0 +1,142 @@
+#include <QtTest>
+#include <atomic>
+
+#include "DynamicDivider/layerpipeline.h"
+
+namespace {
+struct LayerJob {
+    int _layer = 0;
+    quint64 _value = 0;
+};
+typedef QSharedPointer<LayerJob> LayerJobPtr;
+
+///
+/// @brief 模拟一层计算耗时, 返回值参与结果避免被优化
+///
+quint64 busyWork(const int &nLoopCnt, quint64 state)
+{
+    for (int i = 0; i < nLoopCnt; ++ i) state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return state;
+}
+
+///
+/// @brief 与 DividerProcessor 相同: 读取阶段带跨层状态(增量分配), 写入阶段按层追加输出
+/// @param depth [in] 预读深度
+/// @param stopAfter [in] 写入指定层数后停止, -1 表示不停止
+/// @param maxLead [out] 读取领先写入的最大层数
+///
+QByteArray runPipeline(const int &depth, const int &nLayerCnt, const int &nLoopCnt, const int &stopAfter,
+                       int &maxLead)
+{
+    quint64 readState = 50;
+    std::atomic<int> readCnt {0}, writeCnt {0}, lead {0};
+    QByteArray stream;
+
+    auto funcRead = [&](const int &curLayer) {
+        auto job = LayerJobPtr(new LayerJob);
+        job->_layer = curLayer;
+        const int curLead = ++ readCnt - writeCnt.load();
+        if (curLead > lead.load()) lead.store(curLead);
+        readState = busyWork(nLoopCnt + (curLayer * 7919) % nLoopCnt, readState ^ quint64(curLayer));
+        job->_value = readState;
+        return job;
+    };
+    auto funcWrite = [&](const LayerJobPtr &job) {
+        const quint64 value = busyWork(nLoopCnt, job->_value);
+        stream.append(reinterpret_cast<const char *>(&job->_layer), sizeof(job->_layer));
+        stream.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        ++ writeCnt;
+    };
+    auto funcRunning = [&]() { return stopAfter < 0 || writeCnt.load() < stopAfter; };
+
+    LayerPipeline<LayerJobPtr> pipeline(depth);
+    pipeline.run(1, nLayerCnt, funcRead, funcWrite, funcRunning);
+    maxLead = lead.load();
+    return stream;
+}
+}
+
+class TestLayerPipeline : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void matchesSerial_data();
+    void matchesSerial();
+    void stopsInOrder_data();
+    void stopsInOrder();
+    void benchmarkDepth_data();
+    void benchmarkDepth();
+};
+
+void TestLayerPipeline::matchesSerial_data()
+{
+    QTest::addColumn<int>("depth");
+
+    QTest::newRow("depth 1") << 1;
+    QTest::newRow("depth 2") << 2;
+    QTest::newRow("depth 8") << 8;
+}
+
+void TestLayerPipeline::matchesSerial()
+{
+    QFETCH(int, depth);
+
+    int maxLead = 0;
+    const QByteArray refStream = runPipeline(0, 300, 2000, -1, maxLead);
+    QCOMPARE(maxLead, 1);
+    QCOMPARE(refStream.size(), 300 * int(sizeof(int) + sizeof(quint64)));
+
+    // 多轮运行覆盖不同的线程调度
+    for (int iRound = 0; iRound < 5; ++ iRound)
+    {
+        const QByteArray stream = runPipeline(depth, 300, 2000, -1, maxLead);
+        QVERIFY2(stream == refStream, qPrintable(QString("round %1").arg(iRound)));
+        QVERIFY(maxLead <= depth);
+    }
+}
+
+void TestLayerPipeline::stopsInOrder_data()
+{
+    QTest::addColumn<int>("depth");
+
+    QTest::newRow("serial") << 0;
+    QTest::newRow("depth 2") << 2;
+    QTest::newRow("depth 8") << 8;
+}
+
+void TestLayerPipeline::stopsInOrder()
+{
+    QFETCH(int, depth);
+
+    // 停止后已读取的层不再写入, 输出为完整运行结果的前缀
+    int maxLead = 0;
+    const QByteArray refStream = runPipeline(0, 100, 500, -1, maxLead);
+    const QByteArray stream = runPipeline(depth, 100, 500, 40, maxLead);
+    QCOMPARE(stream.size(), 40 * int(sizeof(int) + sizeof(quint64)));
+    QVERIFY(refStream.startsWith(stream));
+}
+
+void TestLayerPipeline::benchmarkDepth_data()
+{
+    QTest::addColumn<int>("depth");
+
+    QTest::newRow("serial") << 0;
+    QTest::newRow("depth 1") << 1;
+    QTest::newRow("depth 2") << 2;
+    QTest::newRow("depth 4") << 4;
+}
+
+void TestLayerPipeline::benchmarkDepth()
+{
+    QFETCH(int, depth);
+
+    int maxLead = 0;
+    QBENCHMARK {
+        runPipeline(depth, 200, 20000, -1, maxLead);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestLayerPipeline)
+
+#include "tst_layerpipeline.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_layerpipeline
+SOURCES += tst_layerpipeline.cpp
@@ -0,0 +1,878 @@
+#include <QtTest>
+#include <QMap>
+#include <QSet>
+#include <cmath>
+
+#include "LatticeModule/meshbase.h"
+#include "publicheader.h"
+
+using namespace ClipperLib;
+
+///
+/// @brief 改为索引半边切片前的实现: 指针拓扑上逐面片递归追踪, 作为对照
+///
+namespace legacy {
+#define _LL_ADDRESS(lp) reinterpret_cast<long long>(lp)
+
+struct Vertex;
+struct Edge;
+struct Face;
+struct ClipPathResult;
+
+typedef QSharedPointer<Vertex> VertexPtr;
+typedef QSharedPointer<Edge> EdgePtr;
+typedef QSharedPointer<Face> FacePtr;
+
+enum EdgeResult {
+    ERT_NOINSECITON = 0,
+    ERT_ONEDGE,
+    ERT_ONVERTEX,
+};
+
+struct Vertex {
+    QVector3D _coor = QVector3D();
+    QList<Face *> _faceList;
+
+    Vertex() = default;
+    Vertex(const float &x, const float &y, const float &z) :
+        _coor(x, y, z) {}
+
+    void transform(const QMatrix4x4 &mat);
+};
+
+struct CalcEdgeResult {
+    Edge *_edge = nullptr;
+    EdgeResult _result = ERT_NOINSECITON;
+    Vertex *_vertex = nullptr;
+    QVector3D _coor;
+
+    void setVertex(Vertex *v) {
+        _result = ERT_ONVERTEX;
+        _vertex = v;
+        _coor = v->_coor;
+    }
+};
+
+struct Edge {
+    QVector<Vertex *> _vertexs;
+    Face *_curFace = nullptr;
+    Face *_nextFace = nullptr;
+
+    Edge() = default;
+    Edge(Vertex *v1, Vertex *v2, Face *curFace) {
+        _vertexs.resize(2);
+        _vertexs[0] = v1;
+        _vertexs[1] = v2;
+        _curFace = curFace;
+    }
+    bool calcIntersection(CalcEdgeResult &, ClipPathResult &);
+};
+
+struct Face {
+    QVector3D _normal;
+    QVector<Vertex *> _vertexs;
+    QVector<Edge *> _edges;
+
+    Face() = default;
+    Face(Vertex *v1, Vertex *v2, Vertex *v3);
+
+    void updateNormal();
+    bool calcIntersection(ClipPathResult &);
+    bool updateClipResult(ClipPathResult &, const QVector<CalcEdgeResult> &);
+    bool updateClipResult(ClipPathResult &, const CalcEdgeResult &, const CalcEdgeResult &);
+};
+
+struct ClipPathResult {
+    float _layerHei = 0;
+    QSet<long long> _usedFaceSet;
+    QSet<long long> _usedVertexSet;
+    QSet<QPair<long long, long long>> _usedEdgeSet;
+    CalcEdgeResult _startCoor;
+
+    bool _started = false;
+    QVector<CalcEdgeResult> _edgeResultVec;
+    ClipperLib::DoublePath _path;
+};
+
+struct Part {
+    QList<VertexPtr> _vertexList;
+    QMap<QPair<long long, long long>, EdgePtr> _edgeMap;
+    QList<FacePtr> _faceList;
+
+    void createPartInfo(const QVector<QVector3D> &vertexs,
+                        const QVector<QVector<int>> &faces);
+    void tranformPart(const QMatrix4x4 &mat);
+    ClipperLib::DoublePath cutPartOnZ(const float &layerHei);
+
+private:
+    void findNextIntersection(Face *, ClipPathResult &);
+    void updateFaceInfo(Vertex *, Vertex *, Vertex *);
+};
+
+inline QPair<long long, long long> getEdgeHash(Edge *edge)
+{
+    // 返回边的起点和终点地址构成的键值对
+    return QPair<long long, long long>(_LL_ADDRESS(edge->_vertexs[0]),
+                                     _LL_ADDRESS(edge->_vertexs[1]));
+}
+
+inline QPair<long long, long long> getHalfEdgeHash(Edge *edge)
+{
+    // 返回边的终点和起点地址构成的键值对
+    return QPair<long long, long long>(_LL_ADDRESS(edge->_vertexs[1]),
+                                     _LL_ADDRESS(edge->_vertexs[0]));
+}
+
+inline QPair<long long, long long> getUniqueEdgeHash(Edge *edge)
+{
+    // 返回边的两个顶点地址按大小排序后构成的键值对
+    return QPair<long long, long long>(
+        _LL_ADDRESS(std::min(edge->_vertexs[0], edge->_vertexs[1])),
+        _LL_ADDRESS(std::max(edge->_vertexs[0], edge->_vertexs[1])));
+}
+
+void Vertex::transform(const QMatrix4x4 &mat)
+{
+    // 使用变换矩阵映射顶点坐标
+    _coor = mat.map(_coor);
+}
+
+bool Edge::calcIntersection(CalcEdgeResult &edgeResult, ClipPathResult &clipResult)
+{
+    // 获取切片高度
+    auto layerHei = clipResult._layerHei;
+    // 计算两端点到切片面的距离
+    auto delV1 = _vertexs[0]->_coor.z() - layerHei;
+    auto delV2 = layerHei - _vertexs[1]->_coor.z();
+
+    // 检查第一个端点是否已被使用
+    if (clipResult._usedVertexSet.contains(_LL_ADDRESS(_vertexs[0])))
+    {
+        // 如果第二个端点在切片面上且未被使用
+        if (fabs(delV2) < 1E-6 && false == clipResult._usedVertexSet.contains(_LL_ADDRESS(_vertexs[1])))
+        {
+            clipResult._usedVertexSet.insert(_LL_ADDRESS(_vertexs[1]));
+            edgeResult.setVertex(_vertexs[1]);
+            return true;
+        }
+        goto LABEL_NO_INSECTION;
+    }
+
+    // 检查第二个端点是否已被使用
+    if (clipResult._usedVertexSet.contains(_LL_ADDRESS(_vertexs[1])))
+    {
+        // 如果第一个端点在切片面上且未被使用
+        if (fabs(delV1) < 1E-6 && false == clipResult._usedVertexSet.contains(_LL_ADDRESS(_vertexs[0])))
+        {
+            clipResult._usedVertexSet.insert(_LL_ADDRESS(_vertexs[0]));
+            edgeResult.setVertex(_vertexs[0]);
+            return true;
+        }
+        goto LABEL_NO_INSECTION;
+    }
+
+    // 检查端点是否在切片面上
+    if (fabs(delV1) < 1E-6)
+    {
+        clipResult._usedVertexSet.insert(_LL_ADDRESS(_vertexs[0]));
+        edgeResult.setVertex(_vertexs[0]);
+        return true;
+    }
+    if (fabs(delV2) < 1E-6)
+    {
+        clipResult._usedVertexSet.insert(_LL_ADDRESS(_vertexs[1]));
+        edgeResult.setVertex(_vertexs[1]);
+        return true;
+    }
+
+    // 计算边与切片面的交点
+    if (delV1 * delV2 > 0)
+    {
+        edgeResult._result = ERT_ONEDGE;
+        edgeResult._vertex = nullptr;
+        auto &coor = edgeResult._coor;
+        // 使用线性插值计算交点坐标
+        coor.setX(_vertexs[1]->_coor.x() +
+                  delV2 / (delV1 + delV2) *
+                      (_vertexs[0]->_coor.x() - _vertexs[1]->_coor.x()));
+        coor.setY(_vertexs[1]->_coor.y() +
+                  delV2 / (delV1 + delV2) *
+                      (_vertexs[0]->_coor.y() - _vertexs[1]->_coor.y()));
+        coor.setZ(layerHei);
+        return true;
+    }
+
+LABEL_NO_INSECTION:
+    edgeResult._result = ERT_NOINSECITON;
+    edgeResult._vertex = nullptr;
+    return false;
+}
+
+Face::Face(Vertex *v1, Vertex *v2, Vertex *v3) {
+    // 初始化顶点数组
+    _vertexs.resize(3);
+    _vertexs[0] = v1;
+    _vertexs[1] = v2;
+    _vertexs[2] = v3;
+
+    // 创建三条边,每条边连接两个顶点
+    _edges.resize(3);
+    _edges[0] = new Edge(v1, v2, this);
+    _edges[1] = new Edge(v2, v3, this);
+    _edges[2] = new Edge(v3, v1, this);
+
+    // 将当前面添加到各顶点的面列表中
+    v1->_faceList << this;
+    v2->_faceList << this;
+    v3->_faceList << this;
+
+    // 根据三个顶点坐标计算面法向量
+    _normal = QVector3D::normal(v1->_coor, v2->_coor, v3->_coor);
+}
+
+void Face::updateNormal()
+{
+    // 根据三个顶点坐标计算面法向量
+    _normal = QVector3D::normal(_vertexs[0]->_coor, _vertexs[1]->_coor, _vertexs[2]->_coor);
+}
+
+bool Face::calcIntersection(ClipPathResult &clipResult)
+{
+    // 检查面片是否已处理
+    if (clipResult._usedFaceSet.contains(_LL_ADDRESS(this))) return false;
+    clipResult._usedFaceSet << _LL_ADDRESS(this);
+    // if (isFaceOnLayerHei(clipResult._layerHei)) return false;
+
+    // 存储边的计算结果
+    QVector<CalcEdgeResult> resultVec;
+    // 遍历面片的所有边
+    for (auto lpEdge : qAsConst(_edges))
+    {
+        // 获取边的唯一哈希值
+        auto hash = getUniqueEdgeHash(lpEdge);
+        // 跳过已处理的边
+        if (clipResult._usedEdgeSet.contains(hash)) continue;
+        clipResult._usedEdgeSet.insert(hash);
+
+        // 计算边与切片平面的交点
+        CalcEdgeResult edgeResult;
+        if (false == lpEdge->calcIntersection(edgeResult, clipResult)) continue;
+        edgeResult._edge = lpEdge;
+        resultVec << (std::move(edgeResult));
+    }
+    // 无交点则返回
+    if (resultVec.size() < 1) return false;
+
+    // 更新切片结果
+    if (updateClipResult(clipResult, resultVec))
+    {
+        // 如果起点在顶点上,处理共顶点的相邻面片
+        if (ERT_ONVERTEX == clipResult._startCoor._result)
+        {
+            auto faceList = clipResult._startCoor._vertex->_faceList;
+            for (auto *face : qAsConst(faceList))
+            {
+                if (clipResult._usedFaceSet.contains(_LL_ADDRESS(face))) continue;
+                if (face->calcIntersection(clipResult)) break;
+            }
+        }
+        // 如果起点在边上,处理共边的相邻面片
+        else if (ERT_ONEDGE == clipResult._startCoor._result)
+        {
+            clipResult._startCoor._edge->_nextFace->calcIntersection(clipResult);
+        }
+    }
+    return true;
+}
+
+bool Face::updateClipResult(ClipPathResult &clipResult,
+                          const QVector<CalcEdgeResult> &edgeRstVec)
+{
+    // 检查边结果数量是否合法(切片已开始且边结果数量大于1,则非法)
+    if (clipResult._started && edgeRstVec.size() > 1)
+    {
+        qDebug() << "[Error]" << "Too Many edgeRstVec" << clipResult._started
+                 << clipResult._edgeResultVec.size() << clipResult._path.size() << edgeRstVec.size();
+        return false;
+    }
+
+    // 切片未开始的处理
+    if (false == clipResult._started)
+    {
+        // 处理单个边结果
+        if (1 == edgeRstVec.size())
+        {
+            // 初始化第一个边结果
+            if (0 == clipResult._edgeResultVec.size())
+            {
+                auto &edgeRst = edgeRstVec[0];
+                // 验证边结果类型
+                if (ERT_ONVERTEX != edgeRst._result || nullptr == edgeRst._vertex)
+                {
+                    qDebug() << "[Error]" << "edgeRst Result Error" << edgeRst._result << edgeRst._vertex;
+                    return false;
+                }
+                // 保存边结果和起点
+                clipResult._edgeResultVec << edgeRstVec[0];
+                clipResult._startCoor = edgeRstVec[0];
+            }
+            // 处理第二个边结果
+            else if (1 == clipResult._edgeResultVec.size())
+            {
+                updateClipResult(clipResult, edgeRstVec[0], clipResult._edgeResultVec[0]);
+            }
+            else
+            {
+                qDebug() << "[Error]" << "Too Many Clip edgeRstVec" << clipResult._started
+                         << clipResult._edgeResultVec.size() << clipResult._path.size() << edgeRstVec.size();
+                return false;
+            }
+        }
+        // 处理两个边结果
+        else if (2 == edgeRstVec.size())
+        {
+            updateClipResult(clipResult, edgeRstVec[0], edgeRstVec[1]);
+        }
+        // 处理三个边结果
+        else if (3 == edgeRstVec.size())
+        {
+            // 循环处理相邻边结果对
+            for (int i = 0; i < edgeRstVec.size(); ++ i)
+            {
+                int nextIndex = i + 1;
+                if (nextIndex > edgeRstVec.size() - 1) nextIndex = 0;
+                if (updateClipResult(clipResult, edgeRstVec[i], edgeRstVec[nextIndex])) break;
+            }
+        }
+    }
+    // 切片已开始的处理
+    else
+    {
+        // 添加单个切片点
+        if (1 == edgeRstVec.size())
+        {
+            clipResult._path << DoublePoint(edgeRstVec[0]._coor.x(), edgeRstVec[0]._coor.y());
+            clipResult._startCoor = edgeRstVec[0];
+        }
+        else if (2 == edgeRstVec.size())
+        {
+            // 预留两个边结果的处理
+        }
+    }
+
+    return true;
+}
+
+bool Face::updateClipResult(ClipPathResult &clipResult, 
+                          const CalcEdgeResult &coor1,
+                          const CalcEdgeResult &coor2)
+{
+    // 查找包含两个交点的唯一面片
+    Face *uniqueFace = nullptr;
+    Vertex *v3 = nullptr;
+
+    // 两个交点都在顶点上的情况
+    if (ERT_ONVERTEX == coor1._result && ERT_ONVERTEX == coor2._result)
+    {
+        // 查找共享这两个顶点的面片
+        for (auto *itFace : qAsConst(coor1._vertex->_faceList))
+        {
+            if (coor2._vertex->_faceList.contains(itFace))
+            {
+                // 找到第三个顶点
+                for (const auto &vertex : qAsConst(itFace->_vertexs))
+                {
+                    if (vertex == coor1._vertex || vertex == coor2._vertex) continue;
+                    v3 = vertex;
+                    break;
+                }
+
+                if (nullptr == v3) qDebug() << "[Error]" << "Can not find the third vertex";
+                if (fabs(v3->_coor.z() - clipResult._layerHei) < 1E-6) continue;
+
+                uniqueFace = itFace;
+                break;
+            }
+        }
+
+        // 未找到唯一面片则移除顶点标记
+        if (nullptr == uniqueFace)
+        {
+            clipResult._usedVertexSet.remove(_LL_ADDRESS(coor1._vertex));
+            clipResult._usedVertexSet.remove(_LL_ADDRESS(coor2._vertex));
+        }
+    }
+    // 第一个交点在顶点上的情况
+    else if (ERT_ONVERTEX == coor1._result)
+    {
+        if (coor1._vertex->_faceList.contains(coor2._edge->_curFace))
+        {
+            uniqueFace = coor2._edge->_curFace;
+        }
+    }
+    // 第二个交点在顶点上的情况
+    else if (ERT_ONVERTEX == coor2._result)
+    {
+        if (coor2._vertex->_faceList.contains(coor1._edge->_curFace))
+        {
+            uniqueFace = coor1._edge->_curFace;
+        }
+    }
+    // 两个交点都在边上的情况
+    else
+    {
+        if (coor1._edge->_curFace == coor2._edge->_curFace)
+        {
+            uniqueFace = coor1._edge->_curFace;
+        }
+    }
+
+    // 检查是否找到唯一面片
+    if (nullptr == uniqueFace)
+    {
+        qDebug() << "[Error]" << "Can not find unique face";
+        return false;
+    }
+
+    // 统计切片平面上下的顶点
+    int upNum = 0;
+    QList<Vertex *> upVertexList;
+    QList<Vertex *> downVertexList;
+    for (const auto &vertex : qAsConst(uniqueFace->_vertexs))
+    {
+        if (vertex->_coor.z() > clipResult._layerHei)
+        {
+            upVertexList << vertex;
+            ++ upNum;
+        }
+        else if (coor1._vertex != vertex && coor2._vertex != vertex)
+        {
+            downVertexList << vertex;
+        }
+    }
+
+    // 根据法向量确定交点连接顺序
+    if (upNum && upNum < 2)
+    {
+        // 计算法向量
+        auto normal = QVector3D::normal(coor1._coor, coor2._coor, upVertexList[0]->_coor);
+        auto dir = uniqueFace->_normal[0] * normal[0] +
+                   uniqueFace->_normal[1] * normal[1] +
+                   uniqueFace->_normal[2] * normal[2];
+
+        // 根据法向量方向添加路径点
+        if (dir > 0)
+        {
+            clipResult._path << DoublePoint(coor1._coor.x(), coor1._coor.y())
+                           << DoublePoint(coor2._coor.x(), coor2._coor.y());
+            clipResult._startCoor = coor2;
+        }
+        else
+        {
+            clipResult._path << DoublePoint(coor2._coor.x(), coor2._coor.y())
+                           << DoublePoint(coor1._coor.x(), coor1._coor.y());
+            clipResult._startCoor = coor1;
+        }
+        clipResult._started = true;
+        clipResult._edgeResultVec.clear();
+        return true;
+    }
+    else
+    {
+        // 处理下方只有一个顶点的情况(确保切片轮廓与面片法向量保持一致的方向)
+        if (1 == downVertexList.size())
+        {
+            // 计算法向量
+            auto normal = QVector3D::normal(coor2._coor, coor1._coor, downVertexList[0]->_coor);
+            // 通过点积与面片法向量比较
+            auto dir = uniqueFace->_normal[0] * normal[0] +
+                       uniqueFace->_normal[1] * normal[1] +
+                       uniqueFace->_normal[2] * normal[2];
+            // 根据法向量方向添加路径点
+            if (dir > 0)
+            {
+                clipResult._path << DoublePoint(coor1._coor.x(), coor1._coor.y())
+                               << DoublePoint(coor2._coor.x(), coor2._coor.y());
+                clipResult._startCoor = coor2;
+            }
+            else
+            {
+                clipResult._path << DoublePoint(coor2._coor.x(), coor2._coor.y())
+                               << DoublePoint(coor1._coor.x(), coor1._coor.y());
+                clipResult._startCoor = coor1;
+            }
+            clipResult._started = true;
+            clipResult._edgeResultVec.clear();
+            return true;
+        }
+    }
+    return false;
+}
+
+void Part::createPartInfo(const QVector<QVector3D> &vertexs,
+                         const QVector<QVector<int>> &faces)
+{
+    // 清空现有数据结构
+    _faceList.clear();
+    _edgeMap.clear();
+    _vertexList.clear();
+
+    // 创建顶点列表
+    for (const auto &vertex : vertexs)
+    {
+        _vertexList << VertexPtr(new Vertex(vertex[0], vertex[1], vertex[2]));
+    }
+
+    // 获取顶点数量上限
+    auto vertexNum = _vertexList.size() - 1;
+    // 处理每个面片
+    for (const auto &face : faces)
+    {
+        // 验证面片顶点数量
+        if (3 != face.size()) continue;
+        // 验证顶点索引有效性
+        if (face[0] < 0 || face[1] < 0 || face[2] < 0) continue;
+        if (face[0] > vertexNum || face[1] > vertexNum || face[2] > vertexNum) continue;
+
+        // 创建面片并更新连接关系
+        updateFaceInfo(_vertexList.at(face[0]).data(),
+                      _vertexList.at(face[1]).data(),
+                      _vertexList.at(face[2]).data());
+    }
+}
+
+using namespace ClipperLib;
+DoublePath Part::cutPartOnZ(const float &layerHei)
+{
+    // 创建切片结果对象
+    ClipPathResult clipResult;
+    // 设置切片高度
+    clipResult._layerHei = layerHei;
+    // 从任意面片开始查找交点
+    findNextIntersection(nullptr, clipResult);
+    // 返回构建的轮廓路径
+    return std::move(clipResult._path);
+}
+
+void Part::tranformPart(const QMatrix4x4 &mat)
+{
+    // 对所有顶点应用变换
+    for (const auto &vertex : qAsConst(_vertexList)) 
+        vertex->transform(mat);
+
+    // 更新所有面片的法向量
+    for (const auto &face : qAsConst(_faceList)) 
+        face->updateNormal();
+}
+
+void Part::updateFaceInfo(Vertex *v1, Vertex *v2, Vertex *v3)
+{
+    // 创建新的三角面片并添加到面片列表
+    auto *curFace = new Face(v1, v2, v3);
+    _faceList << FacePtr(curFace);
+
+    // 处理面片的每条边
+    for (auto edge : qAsConst(curFace->_edges))
+    {
+        // 获取边的哈希值
+        auto pair = getEdgeHash(edge);
+        // 检查是否存在重复边
+        if (_edgeMap.contains(pair))
+        {
+            qDebug() << "[ Error ]" << "Repeat Edge";
+            return;
+        }
+
+        // 获取半边哈希值
+        auto halfPair = getHalfEdgeHash(edge);
+        // 如果存在对应的半边,建立相邻面片关系
+        if (_edgeMap.contains(halfPair))
+        {
+            _edgeMap[halfPair]->_nextFace = edge->_curFace;
+            edge->_nextFace = _edgeMap[halfPair]->_curFace;
+        }
+
+        // 将边添加到映射表
+        _edgeMap.insert(pair, EdgePtr(edge));
+    }
+}
+
+void Part::findNextIntersection(Face *face, ClipPathResult &clipResult)
+{
+    // 未指定面片时遍历所有面片
+    if (nullptr == face)
+    {
+        for (auto tempFace : qAsConst(_faceList))
+        {
+            // 找到有交点的面片后退出
+            if (tempFace->calcIntersection(clipResult))
+            {
+                break;
+            }
+        }
+    }
+    // 指定面片时直接计算交点
+    else face->calcIntersection(clipResult);
+}
+}
+
+namespace {
+struct Mesh {
+    QVector<QVector3D> vertexs;
+    QVector<QVector<int>> faces;
+};
+
+///
+/// @brief 菱形晶格杆件: 与 LatticsDiamond 相同的三棱柱
+///
+Mesh makeLeg(const float &b, const float &l)
+{
+    const float r = b / std::sqrt(3.0f);
+    auto vertex = [r](const float &z, const float &angle) {
+        const float rad = angle * float(DEF_PI) / 180.0f;
+        return QVector3D(r * std::cos(rad), r * std::sin(rad), z);
+    };
+    Mesh mesh;
+    mesh.vertexs = { vertex(0, 0), vertex(0, 120), vertex(0, 240), vertex(l, -60), vertex(l, 60), vertex(l, 180) };
+    mesh.faces = { {0, 4, 3}, {0, 1, 4}, {1, 5, 4}, {1, 2, 5}, {2, 3, 5}, {2, 0, 3}, {3, 4, 5}, {0, 2, 1} };
+    return mesh;
+}
+
+///
+/// @brief 经纬剖分的球面, 面片法向朝外
+///
+Mesh makeSphere(const float &radius, const int &nRing, const int &nSeg)
+{
+    Mesh mesh;
+    mesh.vertexs << QVector3D(0, 0, radius);
+    for(int i = 1; i < nRing; ++ i)
+    {
+        const double theta = DEF_PI * i / nRing;
+        for(int j = 0; j < nSeg; ++ j)
+        {
+            const double phi = 2.0 * DEF_PI * j / nSeg;
+            mesh.vertexs << QVector3D(float(radius * std::sin(theta) * std::cos(phi)),
+                                      float(radius * std::sin(theta) * std::sin(phi)),
+                                      float(radius * std::cos(theta)));
+        }
+    }
+    mesh.vertexs << QVector3D(0, 0, -radius);
+    const int nBottom = mesh.vertexs.size() - 1;
+    auto ringVertex = [nSeg](const int &i, const int &j) { return 1 + (i - 1) * nSeg + j % nSeg; };
+    for(int j = 0; j < nSeg; ++ j)
+    {
+        mesh.faces << QVector<int> { 0, ringVertex(1, j), ringVertex(1, j + 1) };
+        for(int i = 1; i + 1 < nRing; ++ i)
+        {
+            mesh.faces << QVector<int> { ringVertex(i, j), ringVertex(i + 1, j), ringVertex(i + 1, j + 1) };
+            mesh.faces << QVector<int> { ringVertex(i, j), ringVertex(i + 1, j + 1), ringVertex(i, j + 1) };
+        }
+        mesh.faces << QVector<int> { ringVertex(nRing - 1, j), nBottom, ringVertex(nRing - 1, j + 1) };
+    }
+    return mesh;
+}
+
+///
+/// @brief 与 LatticsDiamond 中 LayerLeg_0_0 相同的摆放变换
+///
+QVector<QMatrix4x4> legTransforms(const float &b, const float &l)
+{
+    const float r = b / std::sqrt(3.0f);
+    const float spacing = (l + b / std::sqrt(6.0f)) / std::sqrt(3.0f);
+    QMatrix4x4 mat1, mat2;
+    mat1.rotate(135, QVector3D(0.0f, 0.0f, 1.0f));
+    mat1.rotate(54.73561f, QVector3D(0.0f, 1.0f, 0.0f));
+    mat1.translate(0.5f * r, 0.0f, 0.0f);
+    mat2.translate(spacing, - spacing, - spacing + b * std::sqrt(2.0f) * 0.25f);
+    return QVector<QMatrix4x4> { mat1, mat2 };
+}
+
+double loopArea(const DoublePath &path)
+{
+    double area = 0.0;
+    for(size_t j = 0, k = path.size() - 1; j < path.size(); k = j ++)
+    {
+        area += (path[k].X + path[j].X) * (path[k].Y - path[j].Y);
+    }
+    return -0.5 * area;
+}
+
+///
+/// @brief 两条轮廓点数相同, 顶点逐一对应(容差内), 有向面积一致
+///
+bool sameLoop(const DoublePath &path, const DoublePath &refPath, const double &tol, QString &strError)
+{
+    if(path.size() != refPath.size())
+    {
+        strError = QString("point count %1 != %2").arg(path.size()).arg(refPath.size());
+        return false;
+    }
+    auto contains = [tol](const DoublePath &target, const DoublePoint &pt) {
+        for(const auto &tempPt : target)
+        {
+            if(std::fabs(tempPt.X - pt.X) < tol && std::fabs(tempPt.Y - pt.Y) < tol) return true;
+        }
+        return false;
+    };
+    for(const auto &pt : path)
+    {
+        if(false == contains(refPath, pt))
+        {
+            strError = QString("point (%1,%2) not in reference").arg(pt.X).arg(pt.Y);
+            return false;
+        }
+    }
+    for(const auto &pt : refPath)
+    {
+        if(false == contains(path, pt))
+        {
+            strError = QString("reference point (%1,%2) missing").arg(pt.X).arg(pt.Y);
+            return false;
+        }
+    }
+    const double area = loopArea(path), refArea = loopArea(refPath);
+    if(std::fabs(area - refArea) > 1e-4 * std::fabs(refArea) + tol)
+    {
+        strError = QString("area %1 != %2").arg(area).arg(refArea);
+        return false;
+    }
+    return true;
+}
+
+///
+/// @brief 构建零件, 按顺序应用变换, 并返回变换后的Z范围
+///
+template<class PartT>
+void buildPart(PartT &part, const Mesh &mesh, const QVector<QMatrix4x4> &matVec, float &minZ, float &maxZ)
+{
+    part.createPartInfo(mesh.vertexs, mesh.faces);
+    for(const auto &mat : matVec) part.tranformPart(mat);
+
+    minZ = FLT_MAX;
+    maxZ = -FLT_MAX;
+    for(auto vertex : mesh.vertexs)
+    {
+        for(const auto &mat : matVec) vertex = mat.map(vertex);
+        minZ = qMin(minZ, vertex.z());
+        maxZ = qMax(maxZ, vertex.z());
+    }
+}
+
+///
+/// @brief 在Z范围内取均匀分布的切片高度, 偏移避免落在顶点上
+///
+QVector<float> sliceHeights(const float &minZ, const float &maxZ, const int &nCnt)
+{
+    QVector<float> heights;
+    for(int i = 0; i < nCnt; ++ i) heights << minZ + (maxZ - minZ) * (float(i) + 0.37f) / float(nCnt);
+    return heights;
+}
+}
+
+class TestMeshSlicer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void matchesLegacy_data();
+    void matchesLegacy();
+    void batchMatchesSingle();
+    void benchmarkSlice_data();
+    void benchmarkSlice();
+};
+
+void TestMeshSlicer::matchesLegacy_data()
+{
+    QTest::addColumn<int>("nMesh");
+    QTest::addColumn<bool>("bTransform");
+
+    QTest::newRow("leg") << 0 << false;
+    QTest::newRow("leg, placed") << 0 << true;
+    QTest::newRow("sphere") << 1 << false;
+}
+
+void TestMeshSlicer::matchesLegacy()
+{
+    QFETCH(int, nMesh);
+    QFETCH(bool, bTransform);
+
+    const float b = 300.0f, l = 2000.0f;
+    const Mesh mesh = 0 == nMesh ? makeLeg(b, l) : makeSphere(1000.0f, 24, 36);
+    const QVector<QMatrix4x4> matVec = bTransform ? legTransforms(b, l) : QVector<QMatrix4x4>();
+
+    meshdef::Part part;
+    legacy::Part legacyPart;
+    float minZ = 0, maxZ = 0;
+    buildPart(part, mesh, matVec, minZ, maxZ);
+    buildPart(legacyPart, mesh, matVec, minZ, maxZ);
+
+    for(const auto &layerHei : sliceHeights(minZ, maxZ, 41))
+    {
+        const auto path = part.cutPartOnZ(layerHei);
+        const auto refPath = legacyPart.cutPartOnZ(layerHei);
+        QVERIFY(refPath.size() > 2);
+        QString strError;
+        QVERIFY2(sameLoop(path, refPath, 1e-2, strError),
+                 qPrintable(QString("z %1: %2").arg(double(layerHei)).arg(strError)));
+    }
+}
+
+void TestMeshSlicer::batchMatchesSingle()
+{
+    const Mesh mesh = makeSphere(1000.0f, 24, 36);
+    meshdef::Part part;
+    float minZ = 0, maxZ = 0;
+    buildPart(part, mesh, QVector<QMatrix4x4>(), minZ, maxZ);
+
+    // 乱序高度批量切片, 结果与逐个切片逐点一致
+    auto heights = sliceHeights(minZ, maxZ, 64);
+    std::reverse(heights.begin(), heights.end());
+    std::swap(heights[3], heights[40]);
+    const auto pathVec = part.cutPartOnZ(heights);
+    QCOMPARE(pathVec.size(), heights.size());
+    for(int i = 0; i < heights.size(); ++ i)
+    {
+        const auto path = part.cutPartOnZ(heights[i]);
+        QCOMPARE(pathVec[i].size(), path.size());
+        for(size_t j = 0; j < path.size(); ++ j)
+        {
+            QCOMPARE(pathVec[i][j].X, path[j].X);
+            QCOMPARE(pathVec[i][j].Y, path[j].Y);
+        }
+    }
+}
+
+void TestMeshSlicer::benchmarkSlice_data()
+{
+    QTest::addColumn<bool>("bLegacy");
+
+    QTest::newRow("legacy") << true;
+    QTest::newRow("indexed") << false;
+}
+
+void TestMeshSlicer::benchmarkSlice()
+{
+    QFETCH(bool, bLegacy);
+
+    const Mesh mesh = makeSphere(1000.0f, 96, 128);
+    meshdef::Part part;
+    legacy::Part legacyPart;
+    float minZ = 0, maxZ = 0;
+    buildPart(part, mesh, QVector<QMatrix4x4>(), minZ, maxZ);
+    buildPart(legacyPart, mesh, QVector<QMatrix4x4>(), minZ, maxZ);
+    const auto heights = sliceHeights(minZ, maxZ, 200);
+
+    qint64 nPtCnt = 0;
+    QBENCHMARK {
+        nPtCnt = 0;
+        for(const auto &layerHei : heights)
+        {
+            nPtCnt += qint64(bLegacy ? legacyPart.cutPartOnZ(layerHei).size() : part.cutPartOnZ(layerHei).size());
+        }
+    }
+    QVERIFY(nPtCnt > 0);
+}
+
+QTEST_APPLESS_MAIN(TestMeshSlicer)
+
+#include "tst_meshslicer.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_meshslicer
+SOURCES += tst_meshslicer.cpp
@@ -0,0 +1,536 @@
+#include <QtTest>
+#include <list>
+#include <cmath>
+
+#include "DynamicDivider/PolygonsDivider/polygonsdivider.h"
+#include "DynamicDivider/PolygonsDivider/earcutter.h"
+#include "DynamicDivider/PolygonsDivider/areasweepdivider.h"
+#include "DynamicDivider/PolygonsDivider/dividerheader.h"
+
+using namespace ClipperLib;
+
+///
+/// @brief 改为 earcut 剖分及累计面积表前的实现: 逐点检测耳朵, 孔洞单独剖分为负面积三角形,
+///   二分搜索分割位置(最小间距 1000, 面积误差小于 maxError 时停止); 跨分割线三角形的面积由半平面裁剪计算
+///
+namespace legacy {
+void appendTriangle(std::vector<EaringTriangle> &triVec, const IntPoint &p1, const IntPoint &p2, const IntPoint &p3,
+                    const double &area)
+{
+    triVec.push_back(EaringTriangle(p1, p2, p3, area));
+}
+
+void earingOutter(std::list<IntPoint> &ptList, std::vector<EaringTriangle> &triVec)
+{
+    auto it = ptList.cbegin();
+    while (ptList.size() > 3)
+    {
+        auto it2 = std::next(it);
+        if (ptList.cend() == it2) it2 = ptList.cbegin();
+        auto it3 = std::next(it2);
+        if (ptList.cend() == it3) it3 = ptList.cbegin();
+
+        auto dir = (it2->X - it->X) * (it3->Y - it2->Y) - (it2->Y - it->Y) * (it3->X - it2->X);
+        if (dir > 0)
+        {
+            EaringTriangle tempTriangle(*it, *it2, *it3, dir * 0.5);
+            bool ptInTriangle = false;
+            for (auto tempIt = ptList.cbegin(); tempIt != ptList.cend(); ++ tempIt)
+            {
+                if (tempIt == it || tempIt == it2 || tempIt == it3) continue;
+                if (false == tempTriangle.ptOutTheTriangle(*tempIt))
+                {
+                    ptInTriangle = true;
+                    break;
+                }
+            }
+            if (false == ptInTriangle)
+            {
+                triVec.push_back(tempTriangle);
+                ptList.remove(*it2);
+            }
+            else it = it2;
+        }
+        else if (fabs(dir) < 1E-6) ptList.remove(*it2);
+        else it = it2;
+    }
+    if (3 == ptList.size())
+    {
+        it = ptList.cbegin();
+        auto it2 = std::next(it);
+        auto it3 = std::next(it2);
+        auto dir = (it2->X - it->X) * (it3->Y - it2->Y) - (it2->Y - it->Y) * (it3->X - it2->X);
+        appendTriangle(triVec, *it, *it2, *it3, dir * 0.5);
+    }
+}
+
+void earingInner(std::list<IntPoint> &ptList, std::vector<EaringTriangle> &triVec)
+{
+    auto it = ptList.cbegin();
+    while (ptList.size() > 3)
+    {
+        auto it2 = std::next(it);
+        if (ptList.cend() == it2) it2 = ptList.cbegin();
+        auto it3 = std::next(it2);
+        if (ptList.cend() == it3) it3 = ptList.cbegin();
+
+        auto dir = (it2->X - it->X) * (it3->Y - it2->Y) - (it2->Y - it->Y) * (it3->X - it2->X);
+        if (dir < 0)
+        {
+            EaringTriangle tempTriangle(*it, *it3, *it2, 0.0);
+            bool ptInTriangle = false;
+            for (auto tempIt = ptList.cbegin(); tempIt != ptList.cend(); ++ tempIt)
+            {
+                if (tempIt == it || tempIt == it2 || tempIt == it3) continue;
+                if (false == tempTriangle.ptOutTheTriangle(*tempIt))
+                {
+                    ptInTriangle = true;
+                    break;
+                }
+            }
+            if (false == ptInTriangle)
+            {
+                appendTriangle(triVec, *it, *it2, *it3, dir * 0.5);
+                ptList.remove(*it2);
+            }
+            else it = it2;
+        }
+        else if (fabs(dir) < 1E-6) ptList.remove(*it2);
+        else it = it2;
+    }
+    if (3 == ptList.size())
+    {
+        it = ptList.cbegin();
+        auto it2 = std::next(it);
+        auto it3 = std::next(it2);
+        auto dir = (it2->X - it->X) * (it3->Y - it2->Y) - (it2->Y - it->Y) * (it3->X - it2->X);
+        appendTriangle(triVec, *it, *it2, *it3, dir * 0.5);
+    }
+}
+
+std::vector<EaringTriangle> triangulate(const Paths &polygons)
+{
+    std::vector<EaringTriangle> triVec;
+    for (const auto &polygon : polygons)
+    {
+        if (polygon.size() < 3) continue;
+        std::list<IntPoint> ptList(polygon.begin(), polygon.end());
+        const double fArea = Area(polygon);
+        if (fArea > 0) earingOutter(ptList, triVec);
+        else if (fArea < 0) earingInner(ptList, triVec);
+    }
+    return triVec;
+}
+
+///
+/// @brief 三角形在分割线下方(左侧)部分的有向面积
+///
+double areaBelow(const Path &triangle, const long long &pos, const int &splitHorizon)
+{
+    auto coorT = [&splitHorizon](const DoublePoint &pt) { return splitHorizon ? pt.Y : pt.X; };
+    std::vector<DoublePoint> ptVec;
+    for (size_t i = 0; i < triangle.size(); ++ i)
+    {
+        const DoublePoint p1(double(triangle[i].X), double(triangle[i].Y));
+        const auto &next = triangle[(i + 1) % triangle.size()];
+        const DoublePoint p2(double(next.X), double(next.Y));
+        const bool in1 = coorT(p1) <= pos, in2 = coorT(p2) <= pos;
+        if (in1) ptVec.push_back(p1);
+        if (in1 != in2)
+        {
+            const double t = (double(pos) - coorT(p1)) / (coorT(p2) - coorT(p1));
+            ptVec.push_back(DoublePoint(p1.X + (p2.X - p1.X) * t, p1.Y + (p2.Y - p1.Y) * t));
+        }
+    }
+    double area = 0.0;
+    for (size_t i = 0; i < ptVec.size(); ++ i)
+    {
+        const auto &p1 = ptVec[i];
+        const auto &p2 = ptVec[(i + 1) % ptVec.size()];
+        area += p1.X * p2.Y - p2.X * p1.Y;
+    }
+    return 0.5 * area;
+}
+
+void weightPos(const std::vector<EaringTriangle> &triVec, const double &ratio, const long long &pos1,
+               const long long &pos2, const int &splitHorizon, const double &maxError, MinErrResult &result)
+{
+    if (pos2 - pos1 < 1000) return;
+    auto halfPos = pos1 + ((pos2 - pos1) >> 1);
+
+    double highAreas = 0.0, lowAreas = 0.0;
+    for (const auto &triangle : triVec)
+    {
+        const long long minT = splitHorizon ? triangle._minY : triangle._minX;
+        const long long maxT = splitHorizon ? triangle._maxY : triangle._maxX;
+        if (halfPos <= minT) highAreas += triangle._area;
+        else if (halfPos >= maxT) lowAreas += triangle._area;
+        else
+        {
+            double low = areaBelow(triangle._path, halfPos, splitHorizon);
+            if (triangle._area * low < 0) low = -low;
+            lowAreas += low;
+            highAreas += triangle._area - low;
+        }
+    }
+
+    auto weightAreas_up = highAreas * ratio;
+    auto weightAreas_down = lowAreas * (1 - ratio);
+    result.updateResult(halfPos, weightAreas_up - weightAreas_down);
+    if (maxError > result._error) return;
+
+    if (weightAreas_up > weightAreas_down) weightPos(triVec, ratio, halfPos, pos2, splitHorizon, maxError, result);
+    weightPos(triVec, ratio, pos1, halfPos, splitHorizon, maxError, result);
+}
+
+long long calcWeightPos(const Paths &polygons, const double &ratio, int &splitHorizon)
+{
+    const auto triVec = triangulate(polygons);
+    long long minX = std::numeric_limits<long long>::max(), minY = minX;
+    long long maxX = std::numeric_limits<long long>::min(), maxY = maxX;
+    for (const auto &triangle : triVec)
+    {
+        minX = std::min(minX, triangle._minX);
+        minY = std::min(minY, triangle._minY);
+        maxX = std::max(maxX, triangle._maxX);
+        maxY = std::max(maxY, triangle._maxY);
+    }
+    MinErrResult result;
+    splitHorizon = (maxY - minY) >= (maxX - minX) ? 1 : 0;
+    if (splitHorizon) weightPos(triVec, ratio, minY, maxY, 1, 10, result);
+    else weightPos(triVec, ratio, minX, maxX, 0, 10, result);
+    return (long long)result._pos;
+}
+}
+
+namespace {
+const double Pi = 3.14159265358979323846;
+
+Path makeRect(const cInt &x, const cInt &y, const cInt &w, const cInt &h, const bool &hole)
+{
+    Path path { IntPoint(x, y), IntPoint(x + w, y), IntPoint(x + w, y + h), IntPoint(x, y + h) };
+    if (hole) ReversePath(path);
+    return path;
+}
+
+///
+/// @brief 测试轮廓: 0 带孔方形, 1 带 8 个孔的 500 顶点星形, 2 梳状凹多边形
+///
+Paths makeShape(const int &nShape)
+{
+    if (0 == nShape) return Paths { makeRect(0, 0, 200000, 200000, false), makeRect(50000, 30000, 70000, 90000, true) };
+    if (1 == nShape)
+    {
+        Paths paths(1);
+        for (int i = 0; i < 500; ++ i)
+        {
+            const double angle = 2 * Pi * i / 500;
+            const double r = (i & 0x1) ? 80000 : 100000;
+            paths[0] << IntPoint(cInt(150000 + r * cos(angle)), cInt(150000 + 0.7 * r * sin(angle)));
+        }
+        for (int i = 0; i < 8; ++ i)
+        {
+            const double angle = 2 * Pi * i / 8;
+            paths << makeRect(cInt(145000 + 40000 * cos(angle)), cInt(145000 + 28000 * sin(angle)), 9000, 9000, true);
+        }
+        return paths;
+    }
+
+    Path comb;
+    comb << IntPoint(0, 0) << IntPoint(240000, 0);
+    for (int i = 11; i >= 0; --i)
+    {
+        const cInt x = i * 20000;
+        comb << IntPoint(x + 20000, 150000) << IntPoint(x + 12000, 150000) << IntPoint(x + 12000, 30000)
+             << IntPoint(x + 8000, 30000) << IntPoint(x + 8000, 150000) << IntPoint(x, 150000);
+    }
+    CleanPolygon(comb);
+    return Paths { comb };
+}
+
+double pathsArea(const Paths &paths)
+{
+    double fArea = 0.0;
+    for (const auto &path : paths) fArea += Area(path);
+    return fArea;
+}
+
+///
+/// @brief 轮廓在分割线下方(左侧)的面积
+///
+double areaBelow(const Paths &paths, const long long &pos, const int &splitHorizon)
+{
+    const cInt big = 1000000000;
+    Path halfPlane = splitHorizon ? makeRect(-big, -big, 2 * big, pos + big, false)
+                                  : makeRect(-big, -big, pos + big, 2 * big, false);
+    Clipper clipper;
+    clipper.AddPaths(paths, ptSubject, true);
+    clipper.AddPath(halfPlane, ptClip, true);
+    Paths solution;
+    clipper.Execute(ctIntersection, solution, pftNonZero, pftNonZero);
+    return pathsArea(solution);
+}
+
+///
+/// @brief 分割线方向上的最大截线长度, 分割位置取整引入的面积误差不超过其一半
+///
+double maxCrossWidth(const Paths &paths, const int &splitHorizon)
+{
+    cInt minS = std::numeric_limits<cInt>::max(), maxS = std::numeric_limits<cInt>::min();
+    for (const auto &path : paths)
+    {
+        for (const auto &pt : path)
+        {
+            minS = std::min(minS, splitHorizon ? pt.X : pt.Y);
+            maxS = std::max(maxS, splitHorizon ? pt.X : pt.Y);
+        }
+    }
+    return double(maxS - minS);
+}
+
+///
+/// @brief 与 PolygonsDivider 相同: 按外轮廓分组后由 EarCutter 剖分
+///
+Paths earcutTriangles(const Paths &polygons)
+{
+    Paths triangles;
+    Clipper clipper;
+    clipper.AddPaths(polygons, ptSubject, true);
+    PolyTree polyTree;
+    clipper.Execute(ctUnion, polyTree, pftNonZero, pftNonZero);
+    std::vector<const PolyNode *> outerVec;
+    for (const auto &child : polyTree.Childs) outerVec.push_back(child);
+    while (false == outerVec.empty())
+    {
+        const PolyNode *outerNode = outerVec.back();
+        outerVec.pop_back();
+        Paths holes;
+        for (const auto &hole : outerNode->Childs)
+        {
+            holes.push_back(hole->Contour);
+            for (const auto &island : hole->Childs) outerVec.push_back(island);
+        }
+        EarCutter earCutter;
+        earCutter.triangulate(outerNode->Contour, holes);
+        const auto &vertices = earCutter.vertices();
+        const auto &indices = earCutter.indices();
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            Path triangle { vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]] };
+            if (Area(triangle) < 0) ReversePath(triangle);
+            triangles.push_back(triangle);
+        }
+    }
+    return triangles;
+}
+}
+
+class TestPolygonsDivider : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void triangulationConservesArea_data();
+    void triangulationConservesArea();
+    void splitMatchesLegacy_data();
+    void splitMatchesLegacy();
+    void maxErrorRoundsPos_data();
+    void maxErrorRoundsPos();
+    void sweepWithinTolerance_data();
+    void sweepWithinTolerance();
+    void benchmarkSplit_data();
+    void benchmarkSplit();
+};
+
+void TestPolygonsDivider::triangulationConservesArea_data()
+{
+    QTest::addColumn<int>("nShape");
+
+    QTest::newRow("square with hole") << 0;
+    QTest::newRow("star with holes") << 1;
+    QTest::newRow("comb") << 2;
+}
+
+void TestPolygonsDivider::triangulationConservesArea()
+{
+    QFETCH(int, nShape);
+
+    const Paths polygons = makeShape(nShape);
+    const double fArea = pathsArea(polygons);
+    QVERIFY(fArea > 0);
+
+    // 剖分面积与轮廓面积一致, 与原实现一致
+    const Paths triangles = earcutTriangles(polygons);
+    const double fTriArea = pathsArea(triangles);
+    QVERIFY2(fabs(fTriArea - fArea) <= 1E-9 * fArea, qPrintable(QString("%1 vs %2").arg(fTriArea).arg(fArea)));
+    double fLegacyArea = 0.0;
+    for (const auto &triangle : legacy::triangulate(polygons)) fLegacyArea += triangle._area;
+    QVERIFY2(fabs(fLegacyArea - fArea) <= 1E-9 * fArea, qPrintable(QString("%1 vs %2").arg(fLegacyArea).arg(fArea)));
+
+    // 三角形互不重叠: 合并后面积不变, 且与轮廓的异或为空
+    Paths unionPaths;
+    SimplifyPolygons(triangles, unionPaths, pftNonZero);
+    QVERIFY(fabs(pathsArea(unionPaths) - fTriArea) <= 1E-9 * fArea);
+    Clipper clipper;
+    clipper.AddPaths(unionPaths, ptSubject, true);
+    clipper.AddPaths(polygons, ptClip, true);
+    Paths xorPaths;
+    clipper.Execute(ctXor, xorPaths, pftNonZero, pftNonZero);
+    QVERIFY(fabs(pathsArea(xorPaths)) <= 1E-9 * fArea);
+}
+
+void TestPolygonsDivider::splitMatchesLegacy_data()
+{
+    QTest::addColumn<int>("nShape");
+    QTest::addColumn<double>("ratio");
+
+    const char *names[] = { "square with hole", "star with holes", "comb" };
+    for (int nShape = 0; nShape < 3; ++ nShape)
+    {
+        for (const double ratio : { 0.1, 0.25, 0.5, 0.8 })
+        {
+            QTest::newRow(qPrintable(QString("%1, %2").arg(names[nShape]).arg(ratio))) << nShape << ratio;
+        }
+    }
+}
+
+void TestPolygonsDivider::splitMatchesLegacy()
+{
+    QFETCH(int, nShape);
+    QFETCH(double, ratio);
+
+    const Paths polygons = makeShape(nShape);
+    const double fArea = pathsArea(polygons);
+
+    PolygonsDivider divider;
+    divider.setMaxError(0);
+    int splitHorizon = 0, legacySplitHorizon = 0;
+    const long long pos = divider.calcWeightPos(polygons, ratio, splitHorizon);
+    const long long legacyPos = legacy::calcWeightPos(polygons, ratio, legacySplitHorizon);
+    QCOMPARE(splitHorizon, legacySplitHorizon);
+
+    // 分割位置为精确解取整, 面积误差不超过半个单位位置的截线面积; 不劣于原实现
+    const double fWidth = maxCrossWidth(polygons, splitHorizon);
+    const double fError = fabs(areaBelow(polygons, pos, splitHorizon) - ratio * fArea);
+    const double fLegacyError = fabs(areaBelow(polygons, legacyPos, splitHorizon) - ratio * fArea);
+    QVERIFY2(fError <= 0.5 * fWidth + 1E-9 * fArea, qPrintable(QString("error %1 width %2").arg(fError).arg(fWidth)));
+    QVERIFY2(fError <= fLegacyError + 0.5 * fWidth, qPrintable(QString("error %1 legacy %2").arg(fError).arg(fLegacyError)));
+}
+
+void TestPolygonsDivider::maxErrorRoundsPos_data()
+{
+    QTest::addColumn<int>("nShape");
+    QTest::addColumn<double>("errorRatio");
+
+    QTest::newRow("square, 0.1%") << 0 << 1E-3;
+    QTest::newRow("star, 0.1%") << 1 << 1E-3;
+    QTest::newRow("star, 1%") << 1 << 1E-2;
+    QTest::newRow("comb, 1%") << 2 << 1E-2;
+}
+
+void TestPolygonsDivider::maxErrorRoundsPos()
+{
+    QFETCH(int, nShape);
+    QFETCH(double, errorRatio);
+
+    const Paths polygons = makeShape(nShape);
+    const double fArea = pathsArea(polygons);
+    const double fMaxError = errorRatio * fArea;
+
+    // 面积误差在允许范围内, 分割位置取整到整十网格
+    for (const double ratio : { 0.1, 0.25, 0.5, 0.8 })
+    {
+        PolygonsDivider divider;
+        divider.setMaxError(fMaxError);
+        int splitHorizon = 0;
+        const long long pos = divider.calcWeightPos(polygons, ratio, splitHorizon);
+        const double fError = fabs(areaBelow(polygons, pos, splitHorizon) - ratio * fArea);
+        QVERIFY2(fError <= fMaxError + 1E-9 * fArea, qPrintable(QString("ratio %1 error %2 max %3")
+                                                                 .arg(ratio).arg(fError).arg(fMaxError)));
+        QCOMPARE(pos % 10, 0LL);
+    }
+}
+
+void TestPolygonsDivider::sweepWithinTolerance_data()
+{
+    QTest::addColumn<int>("nShape");
+    QTest::addColumn<qlonglong>("precision");
+    QTest::addColumn<double>("errorRatio");
+
+    const char *names[] = { "square with hole", "star with holes", "comb" };
+    for (int nShape = 0; nShape < 3; ++ nShape)
+    {
+        QTest::newRow(qPrintable(QString("%1, exact").arg(names[nShape]))) << nShape << 1LL << 0.0;
+        QTest::newRow(qPrintable(QString("%1, grid 100").arg(names[nShape]))) << nShape << 100LL << 0.0;
+        QTest::newRow(qPrintable(QString("%1, 0.1%").arg(names[nShape]))) << nShape << 1LL << 1E-3;
+        QTest::newRow(qPrintable(QString("%1, grid 50, 1%").arg(names[nShape]))) << nShape << 50LL << 1E-2;
+    }
+}
+
+void TestPolygonsDivider::sweepWithinTolerance()
+{
+    QFETCH(int, nShape);
+    QFETCH(qlonglong, precision);
+    QFETCH(double, errorRatio);
+
+    const Paths polygons = makeShape(nShape);
+    const double fArea = pathsArea(polygons);
+    const double fMaxError = errorRatio * fArea;
+    const std::vector<double> ratioVec = { 0.2, 0.3, 0.1, 0.25 };
+
+    AreaSweepDivider divider;
+    divider.setPrecision(precision);
+    divider.setMaxError(fMaxError);
+    int splitHorizon = 0;
+    const auto posVec = divider.calcSplitPos(polygons, ratioVec, splitHorizon);
+    QCOMPARE(posVec.size(), ratioVec.size());
+
+    // 各分割位置累计面积误差不超过允许误差与网格取整误差之和, 位置单调且位于网格上
+    const double fWidth = maxCrossWidth(polygons, splitHorizon);
+    double ratio = 0.0;
+    for (size_t i = 0; i < posVec.size(); ++ i)
+    {
+        ratio += ratioVec[i];
+        const double fError = fabs(areaBelow(polygons, posVec[i], splitHorizon) - ratio * fArea);
+        const double fTolerance = fMaxError + 0.5 * precision * fWidth + 1E-9 * fArea;
+        QVERIFY2(fError <= fTolerance, qPrintable(QString("split %1 error %2 tolerance %3").arg(i).arg(fError).arg(fTolerance)));
+        QCOMPARE(posVec[i] % precision, 0LL);
+        if (i > 0) QVERIFY(posVec[i] >= posVec[i - 1]);
+    }
+
+    // 不设面积误差时与默认分区方式的单次分割位置一致
+    if (errorRatio > 0) return;
+    PolygonsDivider polygonsDivider;
+    polygonsDivider.setPrecision(precision);
+    polygonsDivider.setMaxError(fMaxError);
+    int polygonsSplitHorizon = 0;
+    const long long pos = polygonsDivider.calcWeightPos(polygons, ratioVec.front(), polygonsSplitHorizon);
+    QCOMPARE(polygonsSplitHorizon, splitHorizon);
+    QVERIFY2(qAbs(pos - posVec.front()) <= precision, qPrintable(QString("%1 vs %2").arg(pos).arg(posVec.front())));
+}
+
+void TestPolygonsDivider::benchmarkSplit_data()
+{
+    QTest::addColumn<bool>("bLegacy");
+
+    QTest::newRow("earcut, area sweep") << false;
+    QTest::newRow("legacy") << true;
+}
+
+void TestPolygonsDivider::benchmarkSplit()
+{
+    QFETCH(bool, bLegacy);
+
+    const Paths polygons = makeShape(1);
+    long long pos = 0;
+    QBENCHMARK {
+        int splitHorizon = 0;
+        if (bLegacy) pos += legacy::calcWeightPos(polygons, 0.3, splitHorizon);
+        else pos += PolygonsDivider().calcWeightPos(polygons, 0.3, splitHorizon);
+    }
+    QVERIFY(pos > 0);
+}
+
+QTEST_APPLESS_MAIN(TestPolygonsDivider)
+
+#include "tst_polygonsdivider.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_polygonsdivider
+SOURCES += tst_polygonsdivider.cpp
@@ -0,0 +1,275 @@
+#include <QtTest>
+#include <QTemporaryFile>
+#include <limits>
+#include <random>
+
+#include "publicheader.h"
+
+namespace {
+const qint32 Int32Min = std::numeric_limits<qint32>::min();
+const qint32 Int32Max = std::numeric_limits<qint32>::max();
+
+///
+/// @brief 随机扫描线
+/// @param bExtremes 坐标是否取 INT32 极值, 相邻点差值超出 32 位范围
+/// @details 混入与上一点重合的线段及非跳转/标记类型, 二者均不写入
+///
+QVector<SCANLINE> makeLines(const int &nLineCnt, const int &nSeed, const bool &bExtremes)
+{
+    std::mt19937 rng(nSeed);
+    std::uniform_int_distribution<qint32> fullDist(Int32Min, Int32Max);
+    std::uniform_int_distribution<qint32> stepDist(-5000, 5000);
+    std::uniform_int_distribution<int> kindDist(0, 19);
+    const qint32 extremeVec[] = { Int32Min, Int32Max, Int32Min + 1, Int32Max - 1, 0, -1 };
+
+    QVector<SCANLINE> lines;
+    SCANLINE line;
+    line.nX = 0;
+    line.nY = 0;
+    for(int iLine = 0; iLine < nLineCnt; ++ iLine)
+    {
+        const int nKind = kindDist(rng);
+        line.nLineType = (iLine & 0x1) ? SECTION_SCANTYPE_MARK : SECTION_SCANTYPE_JUMP;
+        if(0 == nKind) line.nLineType = SECTION_SCANTYPE_FINISHED;
+
+        // nKind 为 0、1 时坐标不变, 与上一点重合
+        if(bExtremes && nKind >= 2 && nKind < 12)
+        {
+            line.nX = extremeVec[size_t(nKind) % 6];
+            line.nY = extremeVec[size_t(nKind + iLine) % 6];
+        }
+        else if(bExtremes && nKind >= 12)
+        {
+            line.nX = fullDist(rng);
+            line.nY = fullDist(rng);
+        }
+        else if(nKind >= 2)
+        {
+            line.nX += stepDist(rng);
+            line.nY += stepDist(rng);
+        }
+        lines << line;
+    }
+    return lines;
+}
+
+///
+/// @brief 写入端实际保留的扫描线: 跳过非跳转/标记类型及与上一点重合的线段
+///
+QVector<SCANLINE> writtenLines(const QVector<SCANLINE> &lines)
+{
+    QVector<SCANLINE> result;
+    int nLastX = -1, nLastY = -1;
+    for(const auto &line : lines)
+    {
+        if(SECTION_SCANTYPE_JUMP != line.nLineType && SECTION_SCANTYPE_MARK != line.nLineType) continue;
+        if(nLastX == line.nX && nLastY == line.nY) continue;
+        nLastX = line.nX;
+        nLastY = line.nY;
+        result << line;
+    }
+    return result;
+}
+
+///
+/// @brief 以 writeScanLinesDelta 编码, 返回含 SECTION_SCANTYPE_DELTA 标识的整块数据
+///
+QByteArray encodeDelta(const QVector<SCANLINE> &lines)
+{
+    QTemporaryFile file;
+    if(false == file.open()) return QByteArray();
+    writeScanLinesDelta(&file, ScanVectorView::fromScanLines(lines));
+    file.seek(0);
+    return file.readAll();
+}
+
+///
+/// @brief 逐条比较扫描线, 返回首个不一致处的描述, 一致时返回空串
+///
+QString compareLines(const QVector<SCANLINE> &actual, const QVector<SCANLINE> &expected)
+{
+    if(actual.size() != expected.size()) return QString("size %1 != %2").arg(actual.size()).arg(expected.size());
+    for(int iLine = 0; iLine < actual.size(); ++ iLine)
+    {
+        const auto &lhs = actual[iLine], &rhs = expected[iLine];
+        if(lhs.nLineType != rhs.nLineType || lhs.nX != rhs.nX || lhs.nY != rhs.nY)
+        {
+            return QString("line %1: (%2, %3, %4) != (%5, %6, %7)").arg(iLine)
+                    .arg(int(lhs.nLineType)).arg(lhs.nX).arg(lhs.nY)
+                    .arg(int(rhs.nLineType)).arg(rhs.nX).arg(rhs.nY);
+        }
+    }
+    return QString();
+}
+
+///
+/// @brief 与解码端一致的 32 位回绕加法
+///
+inline qint32 wrapAdd(const qint32 &nValue, const qint32 &nOffset)
+{
+    return qint32(quint32(nValue) + quint32(nOffset));
+}
+}
+
+class TestScanLinesDelta : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundTrip_data();
+    void roundTrip();
+    void rejectsInvalid();
+    void benchmarkEncode_data();
+    void benchmarkEncode();
+};
+
+void TestScanLinesDelta::roundTrip_data()
+{
+    QTest::addColumn<int>("nSeed");
+    QTest::addColumn<bool>("bExtremes");
+    QTest::addColumn<int>("nOffsetX");
+    QTest::addColumn<int>("nOffsetY");
+
+    QTest::newRow("random steps") << 43 << false << 123456 << -65432;
+    QTest::newRow("int32 extremes") << 44 << true << 250000 << -250000;
+    QTest::newRow("int32 extremes, zero offset") << 45 << true << 0 << 0;
+}
+
+void TestScanLinesDelta::roundTrip()
+{
+    QFETCH(int, nSeed);
+    QFETCH(bool, bExtremes);
+    QFETCH(int, nOffsetX);
+    QFETCH(int, nOffsetY);
+
+    const auto lines = makeLines(20000, nSeed, bExtremes);
+    const auto expected = writtenLines(lines);
+    QVERIFY(expected.size() > 0);
+
+    const QByteArray data = encodeDelta(lines);
+    QVERIFY(data.size() > 1);
+    QCOMPARE(qint8(data[0]), qint8(SECTION_SCANTYPE_DELTA));
+
+    // 解码结果追加到已有列表之后, 返回值为标识之后的全部字节
+    SCANLINE prefix;
+    prefix.nLineType = SECTION_SCANTYPE_JUMP;
+    prefix.nX = 7;
+    prefix.nY = 8;
+    QVector<SCANLINE> decoded { prefix };
+    QCOMPARE(readScanLinesDelta(data.constData() + 1, data.size() - 1, decoded), qint64(data.size() - 1));
+    QVERIFY(decoded.size() > 0 && 7 == decoded.first().nX && 8 == decoded.first().nY);
+    decoded.removeFirst();
+    const QString strDiff = compareLines(decoded, expected);
+    QVERIFY2(strDiff.isEmpty(), qPrintable(strDiff));
+
+    // 尾部多余字节不计入消耗
+    const QByteArray padded = data + QByteArray(5, '\x7f');
+    QVector<SCANLINE> paddedLines;
+    QCOMPARE(readScanLinesDelta(padded.constData() + 1, padded.size() - 1, paddedLines), qint64(data.size() - 1));
+
+    // 平移后解码与先解码再平移一致
+    QByteArray translated;
+    QCOMPARE(translateScanLinesDelta(data.constData() + 1, data.size() - 1, nOffsetX, nOffsetY, translated),
+             qint64(data.size() - 1));
+    QVector<SCANLINE> translatedLines, expectedTranslated = expected;
+    for(auto &line : expectedTranslated)
+    {
+        line.nX = wrapAdd(line.nX, nOffsetX);
+        line.nY = wrapAdd(line.nY, nOffsetY);
+    }
+    QCOMPARE(readScanLinesDelta(translated.constData(), translated.size(), translatedLines), qint64(translated.size()));
+    const QString strTranslatedDiff = compareLines(translatedLines, expectedTranslated);
+    QVERIFY2(strTranslatedDiff.isEmpty(), qPrintable(strTranslatedDiff));
+
+    // 零偏移时逐字节不变
+    if(0 == nOffsetX && 0 == nOffsetY) QCOMPARE(translated, data.mid(1));
+}
+
+void TestScanLinesDelta::rejectsInvalid()
+{
+    const QByteArray data = encodeDelta(makeLines(64, 46, true));
+    QVERIFY(data.size() > 10);
+    const QByteArray block = data.mid(1);
+
+    // 任意位置截断均返回 -1
+    for(int nSize = 0; nSize < block.size(); ++ nSize)
+    {
+        QVector<SCANLINE> lines;
+        QByteArray buf;
+        QCOMPARE(readScanLinesDelta(block.constData(), nSize, lines), qint64(-1));
+        QCOMPARE(translateScanLinesDelta(block.constData(), nSize, 1, 1, buf), qint64(-1));
+    }
+
+    // 未知版本
+    for(const qint8 nVersion : { qint8(SCANENCODING_RAW), qint8(SCANENCODING_DELTA_V1 + 1), qint8(-1) })
+    {
+        QByteArray unknown = block;
+        unknown[0] = char(nVersion);
+        QVector<SCANLINE> lines;
+        QByteArray buf;
+        QCOMPARE(readScanLinesDelta(unknown.constData(), unknown.size(), lines), qint64(-1));
+        QCOMPARE(translateScanLinesDelta(unknown.constData(), unknown.size(), 1, 1, buf), qint64(-1));
+    }
+
+    // 线段数多于数据, 或数据未用完
+    qint32 nLineCnt = 0;
+    memcpy(&nLineCnt, block.constData() + 1, 4);
+    for(const qint32 nBadCnt : { nLineCnt + 1, nLineCnt - 1, qint32(-1) })
+    {
+        QByteArray bad = block;
+        memcpy(bad.data() + 1, &nBadCnt, 4);
+        QVector<SCANLINE> lines;
+        QCOMPARE(readScanLinesDelta(bad.constData(), bad.size(), lines), qint64(-1));
+    }
+
+    // 字节数为负或超出可读范围
+    for(const qint32 nBadSz : { qint32(-1), qint32(block.size()) })
+    {
+        QByteArray bad = block;
+        memcpy(bad.data() + 5, &nBadSz, 4);
+        QVector<SCANLINE> lines;
+        QByteArray buf;
+        QCOMPARE(readScanLinesDelta(bad.constData(), bad.size(), lines), qint64(-1));
+        QCOMPARE(translateScanLinesDelta(bad.constData(), bad.size(), 1, 1, buf), qint64(-1));
+    }
+
+    // varint 超过 64 位
+    QByteArray overlong = block.left(9);
+    overlong.append(QByteArray(11, '\x80'));
+    const qint32 nOverlongSz = 11;
+    memcpy(overlong.data() + 5, &nOverlongSz, 4);
+    QVector<SCANLINE> lines;
+    QByteArray buf;
+    QCOMPARE(readScanLinesDelta(overlong.constData(), overlong.size(), lines), qint64(-1));
+    QCOMPARE(translateScanLinesDelta(overlong.constData(), overlong.size(), 1, 1, buf), qint64(-1));
+}
+
+void TestScanLinesDelta::benchmarkEncode_data()
+{
+    QTest::addColumn<bool>("bDeltaEncoding");
+
+    QTest::newRow("raw") << false;
+    QTest::newRow("delta") << true;
+}
+
+void TestScanLinesDelta::benchmarkEncode()
+{
+    QFETCH(bool, bDeltaEncoding);
+
+    // 填充线: 相邻点间距在 ±5000 内, 与实际扫描数据相近
+    const auto lines = makeLines(500000, 47, false);
+    const auto view = ScanVectorView::fromScanLines(lines);
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QBENCHMARK {
+        file.resize(0);
+        file.seek(0);
+        if(bDeltaEncoding) writeScanLinesDelta(&file, view);
+        else writeScanLines(&file, view);
+    }
+    qDebug() << (bDeltaEncoding ? "delta" : "raw") << "bytes" << file.size() << "lines" << lines.size();
+}
+
+QTEST_APPLESS_MAIN(TestScanLinesDelta)
+
+#include "tst_scanlinesdelta.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_scanlinesdelta
+SOURCES += tst_scanlinesdelta.cpp
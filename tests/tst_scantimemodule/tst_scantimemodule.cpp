@@ -0,0 +1,209 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include "ScanTimeModule/scantimemodule.h"
+#include "publicheader.h"
+
+using namespace ClipperLib;
+
+namespace {
+inline IntPoint mmPoint(const double &x, const double &y)
+{
+    return IntPoint(cInt(qRound64(x * FILEDATAUNIT)), cInt(qRound64(y * FILEDATAUNIT)));
+}
+
+///
+/// @brief 边长 fSize(mm) 的正方形, 左下角位于 (x, y)
+///
+Path mmSquare(const double &x, const double &y, const double &fSize)
+{
+    return Path { mmPoint(x, y), mmPoint(x + fSize, y), mmPoint(x + fSize, y + fSize), mmPoint(x, y + fSize) };
+}
+
+ScanTimeCoefficient makeCoefficient(const double &k0, const double &k1, const double &k2, const double &k3)
+{
+    ScanTimeCoefficient coefficient;
+    coefficient._markFactor = k0;
+    coefficient._jumpFactor = k1;
+    coefficient._markOverhead = k2;
+    coefficient._jumpOverhead = k3;
+    return coefficient;
+}
+}
+
+class TestScanTimeModule : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void disabledByDefault();
+    void polylineTime();
+    void polygonTime();
+    void jumpBetweenPaths();
+    void hatchingTime();
+    void surfaceCrossHatching();
+    void fitKnownCoefficient();
+    void calibrateFromFile();
+};
+
+void TestScanTimeModule::disabledByDefault()
+{
+    WriterBufferParas paras;
+    ScanTimeModule module;
+    module.initializeParas(&paras);
+    QVERIFY(false == module.isEnabled());
+}
+
+void TestScanTimeModule::polylineTime()
+{
+    // 三段共 30mm, 100mm/s 标记 0.3s; 首条路径无跳转距离
+    ScanTimeModule module;
+    module.setCoefficient(makeCoefficient(1.0, 1.0, 10E-6, 300E-6));
+    Paths paths { Path { mmPoint(0, 0), mmPoint(10, 0), mmPoint(10, 10), mmPoint(20, 10) } };
+
+    ScanTimeFeature feature;
+    ScanTimeCursor cursor;
+    module.addPolylines(paths, 100.0, feature, cursor);
+    QVERIFY(qAbs(feature._markTime - 0.3) < 1E-9);
+    QCOMPARE(feature._jumpTime, 0.0);
+    QCOMPARE(feature._markCnt, 3.0);
+    QCOMPARE(feature._jumpCnt, 1.0);
+    QVERIFY(qAbs(module.predict(feature) - (0.3 + 3 * 10E-6 + 300E-6)) < 1E-9);
+}
+
+void TestScanTimeModule::polygonTime()
+{
+    // 闭合正方形周长 40mm, 200mm/s 标记 0.2s, 4 条矢量
+    ScanTimeModule module;
+    Paths paths { mmSquare(0, 0, 10) };
+
+    ScanTimeFeature feature;
+    ScanTimeCursor cursor;
+    module.addPolygons(paths, 200.0, feature, cursor);
+    QVERIFY(qAbs(feature._markTime - 0.2) < 1E-9);
+    QCOMPARE(feature._markCnt, 4.0);
+    QVERIFY(qAbs(module.predict(feature) - 0.2) < 1E-9);
+}
+
+void TestScanTimeModule::jumpBetweenPaths()
+{
+    // 第一个轮廓结束于起点(0,0), 第二个轮廓起点(30,40), 跳转 50mm, 2500mm/s 用时 0.02s
+    ScanTimeModule module;
+    module.setJumpSpeed(2500.0);
+    Paths paths { mmSquare(0, 0, 10), mmSquare(30, 40, 10) };
+
+    ScanTimeFeature feature;
+    ScanTimeCursor cursor;
+    module.addPolygons(paths, 200.0, feature, cursor);
+    QVERIFY(qAbs(feature._jumpTime - 0.02) < 1E-9);
+    QCOMPARE(feature._jumpCnt, 2.0);
+    QVERIFY(qAbs(feature._markTime - 0.4) < 1E-9);
+}
+
+void TestScanTimeModule::hatchingTime()
+{
+    // 10x10mm 区域, 线距 0.1mm: 100 条线共 1000mm, 1000mm/s 标记 1s;
+    // 线间跳转 100 x 0.1mm, 5000mm/s 用时 0.002s
+    ScanTimeModule module;
+    module.setJumpSpeed(5000.0);
+    Paths paths { mmSquare(0, 0, 10) };
+
+    ScanTimeFeature feature;
+    module.addHatching(paths, 0.1, 1000.0, 1, feature);
+    QVERIFY(qAbs(feature._markTime - 1.0) < 1E-9);
+    QVERIFY(qAbs(feature._markCnt - 100.0) < 1E-6);
+    QVERIFY(qAbs(feature._jumpTime - 0.002) < 1E-9);
+    QVERIFY(qAbs(module.predict(feature) - 1.002) < 1E-9);
+
+    ScanTimeFeature crossFeature;
+    module.addHatching(paths, 0.1, 1000.0, 2, crossFeature);
+    QVERIFY(qAbs(module.predict(crossFeature) - 2.0 * module.predict(feature)) < 1E-9);
+}
+
+void TestScanTimeModule::surfaceCrossHatching()
+{
+    QCOMPARE(ScanTimeModule::surfacePassCount(SURFACEHATCH_X), 1);
+    QCOMPARE(ScanTimeModule::surfacePassCount(SURFACEHATCH_ALTERNATE), 1);
+    QCOMPARE(ScanTimeModule::surfacePassCount(SURFACEHATCH_CROSS), 2);
+
+    WriterBufferParas paras;
+    auto &upPara = paras._bppParaPtr->sSurfacePara_Up;
+    upPara.fLineSpacing[0] = 0.1f;
+    upPara.nMarkSpeed[0] = 1000;
+    ScanTimeModule module;
+    module.initializeParas(&paras);
+
+    Paths paths { mmSquare(0, 0, 10) };
+    upPara.nHatchingType[0] = SURFACEHATCH_X;
+    const double fSingle = module.calcUpfaceTime(paths, 0);
+    upPara.nHatchingType[0] = SURFACEHATCH_CROSS;
+    QVERIFY(fSingle > 0);
+    QVERIFY(qAbs(module.calcUpfaceTime(paths, 0) - 2.0 * fSingle) < 1E-9);
+}
+
+void TestScanTimeModule::fitKnownCoefficient()
+{
+    const auto srcCoefficient = makeCoefficient(1.1, 0.9, 20E-6, 400E-6);
+    ScanTimeModule module;
+    module.setCoefficient(srcCoefficient);
+
+    QVector<ScanTimeFeature> featureVec;
+    QVector<double> timeVec;
+    for (int i = 1; i <= 12; ++ i)
+    {
+        ScanTimeFeature feature;
+        feature._markTime = 0.5 * i;
+        feature._jumpTime = 0.01 * (i % 5 + 1);
+        feature._markCnt = 100.0 * ((i * 7) % 11 + 1);
+        feature._jumpCnt = 10.0 * ((i * 3) % 7 + 1);
+        featureVec << feature;
+        timeVec << module.predict(feature);
+    }
+
+    ScanTimeCoefficient coefficient;
+    QVERIFY(ScanTimeModule::fitCoefficient(featureVec, timeVec, coefficient));
+    QVERIFY(qAbs(coefficient._markFactor - srcCoefficient._markFactor) < 1E-6);
+    QVERIFY(qAbs(coefficient._jumpFactor - srcCoefficient._jumpFactor) < 1E-6);
+    QVERIFY(qAbs(coefficient._markOverhead - srcCoefficient._markOverhead) < 1E-9);
+    QVERIFY(qAbs(coefficient._jumpOverhead - srcCoefficient._jumpOverhead) < 1E-9);
+
+    // 样本不足时拒绝拟合
+    QVERIFY(false == ScanTimeModule::fitCoefficient(featureVec.mid(0, 3), timeVec.mid(0, 3), coefficient));
+}
+
+void TestScanTimeModule::calibrateFromFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString strFile = dir.filePath("calibration.csv");
+    {
+        QFile file(strFile);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Text));
+        QTextStream stream(&file);
+        stream << "markTime,jumpTime,markCnt,jumpCnt,measuredTime\n";
+        stream << "# measured on test bench\n";
+        const double k[4] = { 1.2, 1.0, 15E-6, 250E-6 };
+        for (int i = 1; i <= 10; ++ i)
+        {
+            const double row[4] = { 0.3 * i, 0.02 * (i % 4 + 1), 50.0 * ((i * 5) % 9 + 1), 5.0 * ((i * 2) % 7 + 1) };
+            const double fTime = row[0] * k[0] + row[1] * k[1] + row[2] * k[2] + row[3] * k[3];
+            stream << QString::number(row[0], 'g', 17) << "," << QString::number(row[1], 'g', 17) << ","
+                   << QString::number(row[2], 'g', 17) << "," << QString::number(row[3], 'g', 17) << ","
+                   << QString::number(fTime, 'g', 17) << "\n";
+        }
+    }
+
+    ScanTimeModule module;
+    QVERIFY(module.calibrate(strFile));
+    QVERIFY(qAbs(module.coefficient()._markFactor - 1.2) < 1E-6);
+    QVERIFY(qAbs(module.coefficient()._jumpFactor - 1.0) < 1E-6);
+    QVERIFY(qAbs(module.coefficient()._markOverhead - 15E-6) < 1E-9);
+    QVERIFY(qAbs(module.coefficient()._jumpOverhead - 250E-6) < 1E-9);
+
+    QVERIFY(false == module.calibrate(dir.filePath("missing.csv")));
+}
+
+QTEST_APPLESS_MAIN(TestScanTimeModule)
+
+#include "tst_scantimemodule.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_scantimemodule
+SOURCES += tst_scantimemodule.cpp
@@ -0,0 +1,268 @@
+#include <QtTest>
+#include <QTemporaryFile>
+#include <random>
+
+#include "scanvectorbuffer.h"
+#include "publicheader.h"
+
+namespace {
+QVector<SCANLINE> makeLines(const int &nLineCnt, const int &nSeed)
+{
+    std::mt19937 rng(nSeed);
+    std::uniform_int_distribution<int> coorDist(-2000000, 2000000);
+    std::uniform_int_distribution<int> typeDist(0, 9);
+
+    QVector<SCANLINE> lines;
+    for(int iLine = 0; iLine < nLineCnt; ++ iLine)
+    {
+        SCANLINE line;
+        line.nLineType = (0 == typeDist(rng)) ? SECTION_SCANTYPE_JUMP : SECTION_SCANTYPE_MARK;
+        line.nX = coorDist(rng);
+        line.nY = coorDist(rng);
+        // 偶尔与上一点重合, 写入端会跳过
+        if(lines.size() && 1 == typeDist(rng))
+        {
+            line.nX = lines.last().nX;
+            line.nY = lines.last().nY;
+        }
+        lines << line;
+    }
+    return lines;
+}
+
+///
+/// @brief 逐条比较视图与 SCANLINE 数组, 可指定平移量
+///
+bool viewEquals(const ScanVectorView &view, const QVector<SCANLINE> &lines, const qint32 &dx = 0, const qint32 &dy = 0)
+{
+    if(view.size() != lines.size()) return false;
+    for(int i = 0; i < lines.size(); ++ i)
+    {
+        if(view.type(i) != lines[i].nLineType || view.x(i) != lines[i].nX + dx || view.y(i) != lines[i].nY + dy) return false;
+    }
+    return true;
+}
+
+///
+/// @brief 写入函数输出的字节
+///
+template<class WriteFunc>
+QByteArray writeBytes(WriteFunc writeFunc)
+{
+    QTemporaryFile file;
+    if(false == file.open()) return QByteArray();
+    writeFunc(&file);
+    file.seek(0);
+    return file.readAll();
+}
+}
+
+class TestScanVectorBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void appendAndView();
+    void appendTranslated();
+    void cloneIsIndependent();
+    void scanLinesRoundTrip();
+    void writeMatchesScanLines_data();
+    void writeMatchesScanLines();
+    void benchmarkInstance_data();
+    void benchmarkInstance();
+};
+
+void TestScanVectorBuffer::appendAndView()
+{
+    ScanVectorBuffer buffer;
+    QVERIFY(buffer.isEmpty());
+    QVERIFY(buffer.view().isEmpty());
+
+    buffer.append(SECTION_SCANTYPE_JUMP, 1, 2);
+    buffer.append(SECTION_SCANTYPE_MARK, -3, 4);
+    QCOMPARE(buffer.size(), 2);
+
+    const auto view = buffer.view();
+    QVERIFY(view.isContiguous());
+    QCOMPARE(view.size(), 2);
+    QCOMPARE(view.type(1), qint8(SECTION_SCANTYPE_MARK));
+    QCOMPARE(view.x(1), -3);
+    QCOMPARE(view.y(1), 4);
+
+    // 追加另一视图, 原有数据保持在前
+    const auto lines = makeLines(100, 1);
+    buffer.append(ScanVectorView::fromScanLines(lines));
+    QCOMPARE(buffer.size(), 102);
+    QCOMPARE(buffer.view().x(0), 1);
+    QVERIFY(viewEquals(ScanVectorView(buffer.view().typeData() + 2, buffer.view().xData() + 2,
+                                      buffer.view().yData() + 2, 100), lines));
+
+    buffer.clear();
+    QVERIFY(buffer.isEmpty());
+}
+
+void TestScanVectorBuffer::appendTranslated()
+{
+    const auto lines = makeLines(1000, 2);
+    const qint32 dx = 123456, dy = -654321;
+
+    // 源为 SCANLINE 数组(按结构体步长访问)
+    const auto stridedView = ScanVectorView::fromScanLines(lines);
+    QVERIFY(false == stridedView.isContiguous());
+    ScanVectorBuffer fromStrided;
+    fromStrided.appendTranslated(stridedView, dx, dy);
+    QVERIFY(viewEquals(fromStrided.view(), lines, dx, dy));
+
+    // 源为连续数组
+    ScanVectorBuffer source;
+    source.append(stridedView);
+    ScanVectorBuffer fromContiguous;
+    fromContiguous.reserve(source.size());
+    fromContiguous.appendTranslated(source.view(), dx, dy);
+    QVERIFY(viewEquals(fromContiguous.view(), lines, dx, dy));
+
+    // 原地平移与平移追加一致
+    source.translate(dx, dy);
+    QVERIFY(viewEquals(source.view(), lines, dx, dy));
+
+    // 空视图不改变内容
+    fromContiguous.appendTranslated(ScanVectorView(), dx, dy);
+    QCOMPARE(fromContiguous.size(), lines.size());
+}
+
+void TestScanVectorBuffer::cloneIsIndependent()
+{
+    const auto lines = makeLines(64, 3);
+    ScanVectorBuffer buffer;
+    buffer.append(ScanVectorView::fromScanLines(lines));
+
+    ScanVectorBuffer copy = buffer.clone();
+    QVERIFY(viewEquals(copy.view(), lines));
+    QVERIFY(copy.view().xData() != buffer.view().xData());
+
+    copy.translate(10, 20);
+    copy.append(SECTION_SCANTYPE_JUMP, 0, 0);
+    QVERIFY(viewEquals(buffer.view(), lines));
+    QCOMPARE(copy.size(), lines.size() + 1);
+
+    // 移动后源为空, 数据地址不变
+    const qint32 *xData = buffer.view().xData();
+    ScanVectorBuffer moved(std::move(buffer));
+    QCOMPARE(moved.view().xData(), xData);
+    QVERIFY(viewEquals(moved.view(), lines));
+}
+
+void TestScanVectorBuffer::scanLinesRoundTrip()
+{
+    const auto lines = makeLines(5000, 4);
+    ScanVectorBuffer buffer;
+    buffer.append(ScanVectorView::fromScanLines(lines));
+
+    // toScanLines 追加到列表末尾
+    SCANLINE prefix;
+    prefix.nLineType = SECTION_SCANTYPE_JUMP;
+    prefix.nX = 7;
+    prefix.nY = 8;
+    QVector<SCANLINE> result { prefix };
+    buffer.toScanLines(result);
+    QCOMPARE(result.size(), lines.size() + 1);
+    QCOMPARE(result.first().nX, 7);
+    result.removeFirst();
+    QVERIFY(viewEquals(ScanVectorView::fromScanLines(result), lines));
+
+    QVERIFY(ScanVectorView::fromScanLines(QVector<SCANLINE>()).isEmpty());
+}
+
+void TestScanVectorBuffer::writeMatchesScanLines_data()
+{
+    QTest::addColumn<bool>("bDeltaEncoding");
+
+    QTest::newRow("raw") << false;
+    QTest::newRow("delta") << true;
+}
+
+void TestScanVectorBuffer::writeMatchesScanLines()
+{
+    QFETCH(bool, bDeltaEncoding);
+
+    const auto lines = makeLines(20000, 5);
+    ScanVectorBuffer buffer;
+    buffer.append(ScanVectorView::fromScanLines(lines));
+
+    // 扫描线: 连续数组视图与 SCANLINE 数组视图逐字节一致
+    const QByteArray vectorBytes = writeBytes([&](QFile *file) {
+        if(bDeltaEncoding) writeScanLinesDelta(file, buffer.view());
+        else writeScanLines(file, buffer.view());
+    });
+    const QByteArray listBytes = writeBytes([&](QFile *file) {
+        QVector<SCANLINE> listSLines = lines;
+        if(bDeltaEncoding) writeScanLinesDelta(file, listSLines);
+        else writeScanLines(file, listSLines);
+    });
+    QVERIFY(vectorBytes.size() > 0);
+    QVERIFY(vectorBytes == listBytes);
+
+    // 数据块: vectorBuffer 与 listSLines 两种存放方式输出一致
+    UFFWRITEDATA listData;
+    listData.nMode_Section = SECTION_HATCH;
+    listData.nMode_Coor = SECTION_HATCHCOOR;
+    listData.nPartIndex = 3;
+    listData.nLaserPower = 200;
+    listData.nMarkSpeed = 1000;
+    UFFWRITEDATA vectorData = listData;
+    listData.listSLines = lines;
+    vectorData.vectorBuffer = QSharedPointer<ScanVectorBuffer>::create(buffer.clone());
+    QCOMPARE(vectorData.lineCount(), listData.lineCount());
+
+    const QByteArray listBlock = writeBytes([&](QFile *file) { writeBlockData(file, listData, bDeltaEncoding); });
+    const QByteArray vectorBlock = writeBytes([&](QFile *file) { writeBlockData(file, vectorData, bDeltaEncoding); });
+    QVERIFY(listBlock.size() > listBytes.size());
+    QVERIFY(listBlock == vectorBlock);
+}
+
+void TestScanVectorBuffer::benchmarkInstance_data()
+{
+    QTest::addColumn<bool>("bVectorBuffer");
+
+    QTest::newRow("QVector<SCANLINE> copy") << false;
+    QTest::newRow("ScanVectorBuffer") << true;
+}
+
+void TestScanVectorBuffer::benchmarkInstance()
+{
+    QFETCH(bool, bVectorBuffer);
+
+    // 晶格实例: 模板扫描线平移到 200 个实例位置
+    const int nInstanceCnt = 200;
+    const auto lines = makeLines(5000, 6);
+    ScanVectorBuffer templ;
+    templ.append(ScanVectorView::fromScanLines(lines));
+
+    qint64 nCheckSum = 0;
+    QBENCHMARK {
+        nCheckSum = 0;
+        for(int iInstance = 0; iInstance < nInstanceCnt; ++ iInstance)
+        {
+            const qint32 dx = iInstance * 1000, dy = -iInstance * 1000;
+            if(bVectorBuffer)
+            {
+                ScanVectorBuffer instance;
+                instance.appendTranslated(templ.view(), dx, dy);
+                nCheckSum += instance.view().x(instance.size() - 1);
+                continue;
+            }
+            QVector<SCANLINE> instance = lines;
+            for(auto &line : instance)
+            {
+                line.nX += dx;
+                line.nY += dy;
+            }
+            nCheckSum += instance.last().nX;
+        }
+    }
+    QCOMPARE(nCheckSum, qint64(nInstanceCnt) * lines.last().nX + qint64(nInstanceCnt) * (nInstanceCnt - 1) / 2 * 1000);
+}
+
+QTEST_APPLESS_MAIN(TestScanVectorBuffer)
+
+#include "tst_scanvectorbuffer.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_scanvectorbuffer
+SOURCES += tst_scanvectorbuffer.cpp
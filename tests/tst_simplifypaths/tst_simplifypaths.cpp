@@ -0,0 +1,263 @@
+#include <QtTest>
+#include <cmath>
+#include <random>
+
+#include "algorithmhatching.h"
+
+using namespace ClipperLib;
+
+namespace {
+///
+/// @brief 生成带径向噪声的圆形闭合路径
+///
+Path makeNoisyCircle(const double &cx, const double &cy, const double &radius, const int &nPtCnt,
+                     const double &noise, const bool &clockwise, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<double> dist(-noise, noise);
+    Path path;
+    path.reserve(size_t(nPtCnt));
+    for(int i = 0; i < nPtCnt; ++ i)
+    {
+        double fAngle = 2.0 * DEF_PI * i / nPtCnt * (clockwise ? -1.0 : 1.0);
+        double r = radius + dist(rng);
+        path.push_back(IntPoint(cInt(std::llround(cx + r * std::cos(fAngle))),
+                                cInt(std::llround(cy + r * std::sin(fAngle)))));
+    }
+    return path;
+}
+
+double pointSegDistance(const IntPoint &pt, const IntPoint &pt1, const IntPoint &pt2)
+{
+    double dx = double(pt2.X - pt1.X), dy = double(pt2.Y - pt1.Y);
+    double px = double(pt.X - pt1.X), py = double(pt.Y - pt1.Y);
+    double fLenSqr = dx * dx + dy * dy;
+    double t = fLenSqr > 0 ? qBound(0.0, (px * dx + py * dy) / fLenSqr, 1.0) : 0.0;
+    return std::hypot(px - t * dx, py - t * dy);
+}
+
+double distanceToPaths(const IntPoint &pt, const Paths &paths)
+{
+    double fMin = 1e300;
+    for(const auto &path : paths)
+    {
+        for(size_t i = 0, j = path.size() - 1; i < path.size(); j = i ++)
+        {
+            fMin = std::min(fMin, pointSegDistance(pt, path[j], path[i]));
+        }
+    }
+    return fMin;
+}
+
+double sumArea(const Paths &paths)
+{
+    double fArea = 0.0;
+    for(const auto &path : paths) fArea += Area(path);
+    return fArea;
+}
+
+///
+/// @brief 奇偶规则下的实际面积, 路径无自交且环间不相交时与 sumArea 相等
+///
+double evenOddArea(const Paths &paths)
+{
+    Paths simplePaths;
+    SimplifyPolygons(paths, simplePaths, pftEvenOdd);
+    return sumArea(simplePaths);
+}
+
+qint64 vertexCount(const Paths &paths)
+{
+    qint64 nCnt = 0;
+    for(const auto &path : paths) nCnt += qint64(path.size());
+    return nCnt;
+}
+
+///
+/// @brief 网格排布的带噪声圆环, 模拟 STL 切片得到的高密度轮廓
+///
+Paths makeRingGrid(const int &nRingCnt, const int &nPtCnt, const double &noise, std::mt19937 &rng)
+{
+    Paths paths;
+    const int nCols = int(std::ceil(std::sqrt(double(nRingCnt))));
+    for(int i = 0; i < nRingCnt; ++ i)
+    {
+        paths.push_back(makeNoisyCircle((i % nCols) * 12000.0, (i / nCols) * 12000.0, 5000.0, nPtCnt,
+                                        noise, false, rng));
+    }
+    return paths;
+}
+}
+
+class TestSimplifyPaths : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void zeroToleranceKeepsPaths();
+    void boundedDeviation();
+    void keepsTopologyValid();
+    void keepsSeparateRings();
+    void benchmarkSimplify_data();
+    void benchmarkSimplify();
+    void benchmarkDownstream_data();
+    void benchmarkDownstream();
+};
+
+void TestSimplifyPaths::zeroToleranceKeepsPaths()
+{
+    std::mt19937 rng(1);
+    Paths paths { makeNoisyCircle(0, 0, 10000, 500, 2, false, rng) };
+    const Paths srcPaths = paths;
+
+    AlgorithmBase algo;
+    QCOMPARE(algo.simplifyPaths(paths, 0.0), 0);
+    QVERIFY(paths == srcPaths);
+}
+
+void TestSimplifyPaths::boundedDeviation()
+{
+    std::mt19937 rng(2);
+    const double fTolerance = 10.0;
+    Paths srcPaths { makeNoisyCircle(0, 0, 50000, 4000, 3, false, rng),
+                     makeNoisyCircle(0, 0, 20000, 2000, 3, true, rng) };
+    Paths paths = srcPaths;
+
+    AlgorithmBase algo;
+    QVERIFY(algo.simplifyPaths(paths, fTolerance) > 0);
+    QCOMPARE(int(paths.size()), 2);
+    QVERIFY(vertexCount(paths) < vertexCount(srcPaths) / 2);
+
+    // 保留逐环简化结果, 环顺序、方向及起点不变
+    for(int i = 0; i < 2; ++ i)
+    {
+        QCOMPARE(Orientation(paths[i]), Orientation(srcPaths[i]));
+        QVERIFY(paths[i].front() == srcPaths[i].front());
+    }
+
+    // 原始顶点到简化轮廓的距离不超过容差(含取整误差)
+    for(const auto &path : srcPaths)
+    {
+        for(const auto &pt : path) QVERIFY(distanceToPaths(pt, paths) <= fTolerance + 1.0);
+    }
+    QVERIFY(std::fabs(sumArea(paths) - evenOddArea(paths)) < 1.0);
+}
+
+void TestSimplifyPaths::keepsTopologyValid()
+{
+    // 外轮廓上边有一个低于容差的凸起, 孔洞位于凸起内; 逐环简化后孔洞越出外轮廓
+    Path outer { IntPoint(0, 0), IntPoint(10000, 0), IntPoint(10000, 10000),
+                 IntPoint(7500, 10020), IntPoint(5000, 10040), IntPoint(2500, 10020), IntPoint(0, 10000) };
+    Path hole { IntPoint(4900, 10005), IntPoint(4900, 10020), IntPoint(5100, 10020),
+                IntPoint(5100, 10005), IntPoint(5000, 10004) };
+    if(Orientation(outer) == Orientation(hole)) ReversePath(hole);
+    Paths paths { outer, hole };
+    const Paths srcPaths = paths;
+
+    // 简化会使孔洞与外轮廓相交(奇偶求并后拆分为多个环), 保持原轮廓
+    AlgorithmBase algo;
+    QCOMPARE(algo.simplifyPaths(paths, 50.0), 0);
+    QVERIFY(paths == srcPaths);
+    QVERIFY(std::fabs(sumArea(paths) - evenOddArea(paths)) < 1.0);
+}
+
+void TestSimplifyPaths::keepsSeparateRings()
+{
+    // 矩形右边有一个深度 40 的凹陷, 凹陷内有一个独立的小岛;
+    // 简化去掉凹陷后小岛落入矩形内, 奇偶求并会把小岛变成孔洞
+    Path outer { IntPoint(0, 0), IntPoint(1000, 0), IntPoint(1000, 400), IntPoint(960, 500),
+                 IntPoint(1000, 600), IntPoint(1000, 1000), IntPoint(0, 1000) };
+    Path island { IntPoint(975, 490), IntPoint(995, 490), IntPoint(995, 510), IntPoint(975, 510) };
+    if(Orientation(outer) != Orientation(island)) ReversePath(island);
+    Paths paths { outer, island };
+    const Paths srcPaths = paths;
+
+    AlgorithmBase algo;
+    QCOMPARE(algo.simplifyPaths(paths, 50.0), 0);
+    QVERIFY(paths == srcPaths);
+
+    // 小岛移出矩形后两环独立简化, 环数及顺序不变
+    for(auto &pt : paths[1]) pt.X += 100;
+    const Path movedIsland = paths[1];
+    QCOMPARE(algo.simplifyPaths(paths, 50.0), 3);
+    QCOMPARE(int(paths.size()), 2);
+    QCOMPARE(int(paths[0].size()), 4);
+    QVERIFY(paths[1] == movedIsland);
+    QVERIFY(std::fabs(sumArea(paths) - evenOddArea(paths)) < 1.0);
+}
+
+void TestSimplifyPaths::benchmarkSimplify_data()
+{
+    QTest::addColumn<int>("nRingCnt");
+    QTest::addColumn<int>("nPtCnt");
+
+    QTest::newRow("20 rings x 1000") << 20 << 1000;
+    QTest::newRow("20 rings x 10000") << 20 << 10000;
+    QTest::newRow("200 rings x 2000") << 200 << 2000;
+}
+
+void TestSimplifyPaths::benchmarkSimplify()
+{
+    QFETCH(int, nRingCnt);
+    QFETCH(int, nPtCnt);
+
+    const double fTolerance = 10.0;
+    std::mt19937 rng(3);
+    const Paths srcPaths = makeRingGrid(nRingCnt, nPtCnt, fTolerance * 0.2, rng);
+
+    AlgorithmBase algo;
+    Paths paths;
+    QBENCHMARK {
+        paths = srcPaths;
+        algo.simplifyPaths(paths, fTolerance);
+    }
+    QVERIFY(vertexCount(paths) < vertexCount(srcPaths));
+}
+
+void TestSimplifyPaths::benchmarkDownstream_data()
+{
+    QTest::addColumn<int>("nRingCnt");
+    QTest::addColumn<int>("nPtCnt");
+    QTest::addColumn<bool>("bSimplify");
+
+    QTest::newRow("20 rings x 10000, original") << 20 << 10000 << false;
+    QTest::newRow("20 rings x 10000, simplified") << 20 << 10000 << true;
+    QTest::newRow("200 rings x 2000, original") << 200 << 2000 << false;
+    QTest::newRow("200 rings x 2000, simplified") << 200 << 2000 << true;
+}
+
+void TestSimplifyPaths::benchmarkDownstream()
+{
+    QFETCH(int, nRingCnt);
+    QFETCH(int, nPtCnt);
+    QFETCH(bool, bSimplify);
+
+    // 与层处理相同: 简化(可选) -> 三道轮廓偏移 -> 内部填充求交 -> 扫描线排序, 计时包含简化本身
+    const double fTolerance = 10.0;
+    const int nOffset = 50, nLineSpacing = 100;
+    std::mt19937 rng(3);
+    const Paths srcPaths = makeRingGrid(nRingCnt, nPtCnt, fTolerance * 0.2, rng);
+
+    AlgorithmHatching algo;
+    QVector<SCANLINE> listSLines;
+    QBENCHMARK {
+        Paths paths = srcPaths;
+        if(bSimplify) algo.simplifyPaths(paths, fTolerance);
+
+        Paths borderPaths;
+        for(int iBorder = 1; iBorder <= 3; ++ iBorder)
+        {
+            algo.getOffsetPaths(&paths, &borderPaths, iBorder * nOffset, 2, 0);
+        }
+
+        int nTotalLCnt = 0;
+        TOTALHATCHINGLINE totalListHLine;
+        algo.calcInnerPoint(borderPaths, totalListHLine, nTotalLCnt, 67.0, nLineSpacing, true);
+        listSLines.clear();
+        algo.calcSPLine(LINETYPE_SORTPATH_GREED, totalListHLine, listSLines, nTotalLCnt, 0, 0);
+    }
+    QVERIFY(listSLines.size() > 0);
+}
+
+QTEST_APPLESS_MAIN(TestSimplifyPaths)
+
+#include "tst_simplifypaths.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_simplifypaths
+SOURCES += tst_simplifypaths.cpp
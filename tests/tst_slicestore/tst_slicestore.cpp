@@ -0,0 +1,181 @@
+#include <QtTest>
+
+#include "DynamicDivider/dividerprocessor.h"
+
+using namespace ClipperLib;
+
+namespace {
+Path makeRect(const cInt &x, const cInt &y, const cInt &w, const cInt &h, const bool &hole)
+{
+    Path path { IntPoint(x, y), IntPoint(x + w, y), IntPoint(x + w, y + h), IntPoint(x, y + h) };
+    if (hole) ReversePath(path);
+    return path;
+}
+
+///
+/// @brief 带大孔、小孔及窄缝的零件轮廓, 左下角位于 (x, y)
+///
+Paths makePart(const cInt &x, const cInt &y)
+{
+    const cInt unit = cInt(FILEDATAUNIT);
+    return Paths { makeRect(x, y, 20 * unit, 20 * unit, false),
+                   makeRect(x + 2 * unit, y + 2 * unit, 6 * unit, 6 * unit, true),
+                   makeRect(x + 12 * unit, y + 12 * unit, unit / 5, unit / 5, true),
+                   makeRect(x + 12 * unit, y + 4 * unit, 6 * unit, unit / 20, true) };
+}
+
+SOLIDPATH makeSolidPath(Paths &curPaths)
+{
+    SOLIDPATH solidPath;
+    solidPath.clearAllPathPointer();
+    solidPath.lpPath_Cur = &curPaths;
+    for (int iSur = 0; iSur < 5; ++ iSur)
+    {
+        solidPath.lpPath_Dw[iSur] = &solidPath.nullPaths;
+        solidPath.lpPath_Up[iSur] = &solidPath.nullPaths;
+    }
+    return solidPath;
+}
+
+std::vector<const Paths *> keyPaths(const SOLIDPATH &solidPath)
+{
+    std::vector<const Paths *> pathsVec = { solidPath.lpPath_Cur };
+    for (int iSur = 0; iSur < 5; ++ iSur) pathsVec.push_back(solidPath.lpPath_Dw[iSur]);
+    for (int iSur = 0; iSur < 5; ++ iSur) pathsVec.push_back(solidPath.lpPath_Up[iSur]);
+    return pathsVec;
+}
+
+Paths translated(const Paths &paths, const IntPoint &offset)
+{
+    Paths dstPaths;
+    SliceStore::translatePaths(paths, offset, dstPaths);
+    return dstPaths;
+}
+}
+
+class TestSliceStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void translatedCopiesShareKey();
+    void sharedMatchesDirect();
+    void borderPathsMatchDirect();
+
+private:
+    PARAWRITEBUFF _writeBuff;
+    AlgorithmApplication _algo;
+};
+
+void TestSliceStore::initTestCase()
+{
+    _writeBuff._writerBufferParas = QSharedPointer<WriterBufferParas>(new WriterBufferParas);
+    auto bppParas = _writeBuff._writerBufferParas->_bppParaPtr;
+    bppParas->sSmallHolePara.nNumber_Section = 1;
+    bppParas->sSmallHolePara.fRadius[0] = 0.5f;
+    bppParas->sSmallHolePara.fOffset[0] = 0.05f;
+    bppParas->sSmallGapPara.nNumber_Section = 1;
+    bppParas->sSmallGapPara.fWidth[0] = 0.2f;
+    bppParas->sSmallGapPara.fOffset[0] = 0.01f;
+    bppParas->sSurfacePara_Up.nNumber = 0;
+    bppParas->sSurfacePara_Dw.nNumber = 0;
+    _algo.setBuffParas(&_writeBuff);
+}
+
+void TestSliceStore::translatedCopiesShareKey()
+{
+    Paths paths1 = makePart(0, 0);
+    Paths paths2 = makePart(cInt(35 * FILEDATAUNIT), cInt(-12 * FILEDATAUNIT));
+    SimplifyPolygons(paths1);
+    SimplifyPolygons(paths2);
+    auto solidPath1 = makeSolidPath(paths1);
+    auto solidPath2 = makeSolidPath(paths2);
+
+    IntPoint origin1, origin2;
+    const int nParas = 0;
+    const auto key1 = SliceStore::createKey(keyPaths(solidPath1), 10, &nParas, origin1);
+    const auto key2 = SliceStore::createKey(keyPaths(solidPath2), 10, &nParas, origin2);
+    QVERIFY(key1 == key2);
+    QCOMPARE(origin2.X - origin1.X, cInt(35 * FILEDATAUNIT));
+    QCOMPARE(origin2.Y - origin1.Y, cInt(-12 * FILEDATAUNIT));
+
+    // 层号或参数不同不共享
+    QVERIFY(false == (key1 == SliceStore::createKey(keyPaths(solidPath2), 11, &nParas, origin2)));
+    const int nOtherParas = 0;
+    QVERIFY(false == (key1 == SliceStore::createKey(keyPaths(solidPath2), 10, &nOtherParas, origin2)));
+}
+
+void TestSliceStore::sharedMatchesDirect()
+{
+    // 非共享: 在零件实际位置直接计算
+    Paths directPaths = makePart(cInt(123.456 * FILEDATAUNIT), cInt(-78.9 * FILEDATAUNIT));
+    SimplifyPolygons(directPaths);
+    Paths sharedSrcPaths = directPaths;
+    auto directSolidPath = makeSolidPath(directPaths);
+    SliceData directData;
+    DividerProcessor::deriveSliceData(&_algo, directSolidPath, directData);
+    QVERIFY(directData._paths_smallHoles.size() + directData._paths_smallGaps.size() > 0);
+
+    // 共享: 平移到原点计算后再按零件原点平移回来
+    auto srcSolidPath = makeSolidPath(sharedSrcPaths);
+    IntPoint origin;
+    const int nParas = 0;
+    SliceStore::createKey(keyPaths(srcSolidPath), 0, &nParas, origin);
+    Paths normalizedPaths = translated(sharedSrcPaths, IntPoint(-origin.X, -origin.Y));
+    auto sharedSolidPath = makeSolidPath(normalizedPaths);
+    SliceData sharedData;
+    DividerProcessor::deriveSliceData(&_algo, sharedSolidPath, sharedData);
+
+    QCOMPARE(sharedData._fArea, directData._fArea);
+    QVERIFY(translated({ sharedData._boundPath }, origin) == Paths { directData._boundPath });
+    QVERIFY(translated(sharedData._paths_smallHoles, origin) == directData._paths_smallHoles);
+    QVERIFY(translated(sharedData._paths_smallGaps, origin) == directData._paths_smallGaps);
+    QVERIFY(translated(sharedData._paths_exceptHolesAndGaps, origin) == directData._paths_exceptHolesAndGaps);
+    QVERIFY(translated(sharedData._divideData._paths_Inner, origin) == directData._divideData._paths_Inner);
+    QVERIFY(translated(sharedData._divideData._paths_up, origin) == directData._divideData._paths_up);
+    QVERIFY(translated(sharedData._divideData._paths_down, origin) == directData._divideData._paths_down);
+    QCOMPARE(sharedData._divideData._nIndex_up, directData._divideData._nIndex_up);
+    QCOMPARE(sharedData._divideData._nIndex_down, directData._divideData._nIndex_down);
+    QVERIFY(translated(sharedData._borderPaths, origin) == directData._borderPaths);
+}
+
+void TestSliceStore::borderPathsMatchDirect()
+{
+    // 两个平移实例: 非共享模式各自在实际位置计算, 共享模式由首个实例计算后按各自原点平移
+    const QVector<IntPoint> positions { IntPoint(cInt(-40.5 * FILEDATAUNIT), cInt(7.25 * FILEDATAUNIT)),
+                                        IntPoint(cInt(61.125 * FILEDATAUNIT), cInt(-33 * FILEDATAUNIT)) };
+    const int nParas = 0;
+    SliceData sharedData;
+    QVector<Paths> rawPathsVec;
+    for (int i = 0; i < positions.size(); ++ i)
+    {
+        Paths directPaths = makePart(positions[i].X, positions[i].Y);
+        SimplifyPolygons(directPaths);
+        rawPathsVec << directPaths;
+
+        IntPoint origin;
+        auto solidPath = makeSolidPath(directPaths);
+        SliceStore::createKey(keyPaths(solidPath), 0, &nParas, origin);
+        if (0 == i)
+        {
+            Paths normalizedPaths = translated(directPaths, IntPoint(-origin.X, -origin.Y));
+            auto sharedSolidPath = makeSolidPath(normalizedPaths);
+            DividerProcessor::deriveSliceData(&_algo, sharedSolidPath, sharedData);
+            QVERIFY(normalizedPaths.empty());
+        }
+
+        SliceData directData;
+        DividerProcessor::deriveSliceData(&_algo, solidPath, directData);
+        QVERIFY(directPaths.empty());
+
+        // 轮廓权重基于移除小孔及窄缝后的轮廓, 而非读取的原始轮廓
+        QVERIFY(directData._borderPaths.size() > 0);
+        QVERIFY(directData._borderPaths != rawPathsVec[i]);
+        QVERIFY(translated(sharedData._borderPaths, origin) == directData._borderPaths);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestSliceStore)
+
+#include "tst_slicestore.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_slicestore
+SOURCES += tst_slicestore.cpp
@@ -0,0 +1,139 @@
+#include <QtTest>
+#include <cmath>
+
+#include "SplicingModule/slmsplicingmodule.h"
+#include "SplicingModule/splicingheader.h"
+#include "publicheader.h"
+
+using namespace ClipperLib;
+
+namespace {
+SplicingAreaPtr makeArea(const int &scannerIndex, const cInt &left, const cInt &top, const cInt &right, const cInt &bottom)
+{
+    auto area = SplicingAreaPtr(new SplicingAreaInfo);
+    area->scannerIndex = scannerIndex;
+    area->layerScanField << Path { IntPoint(left, top), IntPoint(right, top), IntPoint(right, bottom), IntPoint(left, bottom) };
+    area->rectField = IntRect::GetBounds(area->layerScanField);
+    return area;
+}
+
+///
+/// @brief 四振镜田字分区, 相邻分区重叠 fOverlap(mm)
+///
+LayerSplicingArea makeLayerSplicing(const double &fSize, const double &fOverlap)
+{
+    const cInt nHalf = cInt(fSize * 0.5 * FILEDATAUNIT);
+    const cInt nOverlap = cInt(fOverlap * 0.5 * FILEDATAUNIT);
+    const cInt nSize = cInt(fSize * FILEDATAUNIT);
+    LayerSplicingArea layerSplicing;
+    layerSplicing.splicingAreaMap_support.insert(0, makeArea(0, 0, 0, nHalf + nOverlap, nHalf + nOverlap));
+    layerSplicing.splicingAreaMap_support.insert(1, makeArea(1, nHalf - nOverlap, 0, nSize, nHalf + nOverlap));
+    layerSplicing.splicingAreaMap_support.insert(2, makeArea(2, 0, nHalf - nOverlap, nHalf + nOverlap, nSize));
+    layerSplicing.splicingAreaMap_support.insert(3, makeArea(3, nHalf - nOverlap, nHalf - nOverlap, nSize, nSize));
+    return layerSplicing;
+}
+
+///
+/// @brief 平台上均匀排布的带孔圆形零件
+///
+Paths makeParts(const double &fSize, const int &nRowCnt, const int &nPtCnt)
+{
+    Paths paths;
+    const double fPitch = fSize / nRowCnt * FILEDATAUNIT;
+    for (int row = 0; row < nRowCnt; ++ row)
+    {
+        for (int col = 0; col < nRowCnt; ++ col)
+        {
+            const double cx = (col + 0.5) * fPitch, cy = (row + 0.5) * fPitch;
+            Path outer, hole;
+            for (int i = 0; i < nPtCnt; ++ i)
+            {
+                const double fAngle = 2.0 * DEF_PI * i / nPtCnt;
+                outer << IntPoint(cInt(std::llround(cx + 0.4 * fPitch * std::cos(fAngle))),
+                                  cInt(std::llround(cy + 0.4 * fPitch * std::sin(fAngle))));
+                hole << IntPoint(cInt(std::llround(cx + 0.2 * fPitch * std::cos(-fAngle))),
+                                 cInt(std::llround(cy + 0.2 * fPitch * std::sin(-fAngle))));
+            }
+            paths << outer << hole;
+        }
+    }
+    return paths;
+}
+
+void initModule(SLMSplicingModule &module, const int &nRectClipSplit)
+{
+    WriterBufferParas paras;
+    paras._extendedParaPtr->addVariantMap(QVariantMap { { "Splicing/nRectClipSplit", nRectClipSplit } });
+    module.initializeParas(&paras);
+}
+
+QMap<int, double> splitAreas(const SLMSplicingModule &module, const LayerSplicingArea &layerSplicing, const Paths &paths)
+{
+    QMap<int, double> areaMap;
+    module.splitSolidData(layerSplicing, paths, [&areaMap](const int &scanner, const Paths &sol) {
+        areaMap[scanner] += Areas(sol);
+    });
+    return areaMap;
+}
+}
+
+class TestSplicingSplit : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void rectClipMatchesIntersection();
+    void benchmarkSplitSolid_data();
+    void benchmarkSplitSolid();
+};
+
+void TestSplicingSplit::rectClipMatchesIntersection()
+{
+    const auto layerSplicing = makeLayerSplicing(500.0, 2.0);
+    const auto paths = makeParts(500.0, 7, 256);
+
+    SLMSplicingModule rectModule, clipperModule;
+    initModule(rectModule, 1);
+    initModule(clipperModule, 0);
+    const auto rectAreas = splitAreas(rectModule, layerSplicing, paths);
+    const auto clipperAreas = splitAreas(clipperModule, layerSplicing, paths);
+
+    QCOMPARE(rectAreas.keys(), clipperAreas.keys());
+    for (const auto &key : rectAreas.keys())
+    {
+        QVERIFY2(std::fabs(rectAreas[key] - clipperAreas[key]) <= 1E-4 * clipperAreas[key],
+                 qPrintable(QString("scanner %1: %2 vs %3").arg(key).arg(rectAreas[key]).arg(clipperAreas[key])));
+    }
+}
+
+void TestSplicingSplit::benchmarkSplitSolid_data()
+{
+    QTest::addColumn<int>("nRectClipSplit");
+    QTest::addColumn<int>("nRowCnt");
+
+    QTest::newRow("intersection 7x7") << 0 << 7;
+    QTest::newRow("rectclip 7x7") << 1 << 7;
+    QTest::newRow("intersection 20x20") << 0 << 20;
+    QTest::newRow("rectclip 20x20") << 1 << 20;
+}
+
+void TestSplicingSplit::benchmarkSplitSolid()
+{
+    QFETCH(int, nRectClipSplit);
+    QFETCH(int, nRowCnt);
+
+    const auto layerSplicing = makeLayerSplicing(500.0, 2.0);
+    const auto paths = makeParts(500.0, nRowCnt, 256);
+    SLMSplicingModule module;
+    initModule(module, nRectClipSplit);
+
+    int nSplitCnt = 0;
+    QBENCHMARK {
+        module.splitSolidData(layerSplicing, paths, [&nSplitCnt](const int &, const Paths &) { ++ nSplitCnt; });
+    }
+    QVERIFY(nSplitCnt > 0);
+}
+
+QTEST_APPLESS_MAIN(TestSplicingSplit)
+
+#include "tst_splicingsplit.moc"
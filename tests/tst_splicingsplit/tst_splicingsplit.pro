@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_splicingsplit
+SOURCES += tst_splicingsplit.cpp
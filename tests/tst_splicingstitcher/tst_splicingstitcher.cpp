@@ -0,0 +1,213 @@
+#include <QtTest>
+#include <random>
+
+#include "SplicingModule/splicingstitcher.h"
+
+namespace {
+struct Segment {
+    int nArea;
+    int64_t nStartX;
+    int64_t nStartY;
+    int64_t nEndX;
+    int64_t nEndY;
+
+    inline bool operator==(const Segment &seg) const {
+        return nArea == seg.nArea && nStartX == seg.nStartX && nStartY == seg.nStartY &&
+               nEndX == seg.nEndX && nEndY == seg.nEndY;
+    }
+};
+
+namespace legacy {
+///
+/// @brief 引入 SplicingStitcher 前的 splitLineByVerLine: 顺序查找分区, 在分区边界处截断
+/// @details 原实现中左边界等于上一分区右边界, 此处直接由右边界数组取得
+///
+bool splitLineByVerLine(const std::vector<int64_t> &rightPosVec, const int64_t &x1, const int64_t &y1,
+                        const int64_t &x2, const int64_t &y2, QVector<Segment> &segVec)
+{
+    int nPt1Area = -1;
+    int nPt2Area = -1;
+    for(int iArea = 0; iArea < int(rightPosVec.size()); ++ iArea)
+    {
+        if(x1 < rightPosVec[size_t(iArea)])
+        {
+            nPt1Area = iArea;
+            break;
+        }
+    }
+    for(int iArea = 0; iArea < int(rightPosVec.size()); ++ iArea)
+    {
+        if(x2 < rightPosVec[size_t(iArea)])
+        {
+            nPt2Area = iArea;
+            break;
+        }
+    }
+    if(-1 == nPt1Area || -1 == nPt2Area) return false;
+
+    if(nPt1Area == nPt2Area)
+    {
+        segVec << Segment { nPt1Area, x1, y1, x2, y2 };
+        return true;
+    }
+
+    int64_t nTempX = x1;
+    int64_t nTempY = y1;
+    if(nPt1Area < nPt2Area)
+    {
+        for(int iArea = nPt1Area; iArea < nPt2Area; ++ iArea)
+        {
+            int64_t nXPos = rightPosVec[size_t(iArea)];
+            int64_t nYPos = y1 + (nXPos - x1) * (y2 - y1) / (x2 - x1);
+            segVec << Segment { iArea, nTempX, nTempY, nXPos, nYPos };
+            nTempX = nXPos;
+            nTempY = nYPos;
+        }
+    }
+    else
+    {
+        for(int iArea = nPt1Area; iArea > nPt2Area; -- iArea)
+        {
+            int64_t nXPos = rightPosVec[size_t(iArea - 1)];
+            int64_t nYPos = y1 + (nXPos - x1) * (y2 - y1) / (x2 - x1);
+            segVec << Segment { iArea, nTempX, nTempY, nXPos, nYPos };
+            nTempX = nXPos;
+            nTempY = nYPos;
+        }
+    }
+    segVec << Segment { nPt2Area, nTempX, nTempY, x2, y2 };
+    return true;
+}
+}
+
+///
+/// @brief 平台宽 nPlat 等分为 nScannerCnt 个分区, 末项为平台外哨兵
+///
+std::vector<int64_t> makeRightPosVec(const int &nScannerCnt, const int64_t &nPlat)
+{
+    std::vector<int64_t> rightPosVec;
+    for(int iScanner = 1; iScanner < nScannerCnt; ++ iScanner) rightPosVec.push_back(nPlat * iScanner / nScannerCnt);
+    rightPosVec.push_back(nPlat);
+    return rightPosVec;
+}
+
+///
+/// @brief 随机扫描线, 部分端点取拼接线位置、竖直线或超出平台
+///
+QVector<QVector<int64_t>> makeLines(const std::vector<int64_t> &rightPosVec, const int &nLineCnt, const int &nSeed)
+{
+    std::mt19937 rng(nSeed);
+    std::uniform_int_distribution<int64_t> coorDist(0, rightPosVec.back() + 1000);
+    std::uniform_int_distribution<int> kindDist(0, 9);
+    std::uniform_int_distribution<size_t> posDist(0, rightPosVec.size() - 1);
+
+    QVector<QVector<int64_t>> lines;
+    for(int iLine = 0; iLine < nLineCnt; ++ iLine)
+    {
+        QVector<int64_t> line { coorDist(rng), coorDist(rng), coorDist(rng), coorDist(rng) };
+        const int nKind = kindDist(rng);
+        if(0 == nKind) line[0] = rightPosVec[posDist(rng)];
+        else if(1 == nKind) line[2] = rightPosVec[posDist(rng)];
+        else if(2 == nKind) line[2] = line[0];
+        else if(3 == nKind) line[0] = line[2] = rightPosVec[posDist(rng)] - 1;
+        lines << line;
+    }
+    return lines;
+}
+}
+
+class TestSplicingStitcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void matchesLegacy_data();
+    void matchesLegacy();
+    void benchmarkStitch_data();
+    void benchmarkStitch();
+};
+
+void TestSplicingStitcher::matchesLegacy_data()
+{
+    QTest::addColumn<int>("nScannerCnt");
+
+    QTest::newRow("1 scanner") << 1;
+    QTest::newRow("2 scanners") << 2;
+    QTest::newRow("4 scanners") << 4;
+    QTest::newRow("8 scanners") << 8;
+}
+
+void TestSplicingStitcher::matchesLegacy()
+{
+    QFETCH(int, nScannerCnt);
+
+    // 默认参数: 无搭接、无抖动、无均衡, 分配结果与原实现逐项一致;
+    // splitLineByVerLine 按回调顺序调用 writeDataToList, 写出的扫描线因此逐位一致
+    const auto rightPosVec = makeRightPosVec(nScannerCnt, 600000);
+    SplicingStitcher stitcher;
+    stitcher.initialize(rightPosVec, 0, 0, false);
+    for(int layer = 0; layer < 3; ++ layer)
+    {
+        stitcher.applyLayer(layer);
+        QVERIFY(stitcher.rightPosVec() == rightPosVec);
+
+        const auto lines = makeLines(rightPosVec, 20000, 40 + layer);
+        for(const auto &line : lines)
+        {
+            QVector<Segment> refSegVec, segVec;
+            const bool bRefResult = legacy::splitLineByVerLine(rightPosVec, line[0], line[1], line[2], line[3], refSegVec);
+            const bool bResult = stitcher.stitch(line[0], line[1], line[2], line[3], [&segVec](const int &iArea,
+                                                 const int64_t &nStartX, const int64_t &nStartY,
+                                                 const int64_t &nEndX, const int64_t &nEndY) {
+                segVec << Segment { iArea, nStartX, nStartY, nEndX, nEndY };
+            });
+            QCOMPARE(bResult, bRefResult);
+            QVERIFY2(segVec == refSegVec, qPrintable(QString("line (%1, %2) - (%3, %4)")
+                                                     .arg(line[0]).arg(line[1]).arg(line[2]).arg(line[3])));
+        }
+    }
+}
+
+void TestSplicingStitcher::benchmarkStitch_data()
+{
+    QTest::addColumn<bool>("bLegacy");
+    QTest::addColumn<int>("nScannerCnt");
+
+    for(int nScannerCnt = 2; nScannerCnt <= 16; nScannerCnt <<= 1)
+    {
+        QTest::newRow(qPrintable(QString("stitcher, %1 scanners").arg(nScannerCnt))) << false << nScannerCnt;
+        QTest::newRow(qPrintable(QString("legacy, %1 scanners").arg(nScannerCnt))) << true << nScannerCnt;
+    }
+}
+
+void TestSplicingStitcher::benchmarkStitch()
+{
+    QFETCH(bool, bLegacy);
+    QFETCH(int, nScannerCnt);
+
+    const auto rightPosVec = makeRightPosVec(nScannerCnt, 600000);
+    const auto lines = makeLines(rightPosVec, 200000, 41);
+    SplicingStitcher stitcher;
+    stitcher.initialize(rightPosVec, 0, 0, false);
+    QVector<Segment> segVec;
+    segVec.reserve(lines.size() * nScannerCnt);
+    QBENCHMARK {
+        segVec.clear();
+        for(const auto &line : lines)
+        {
+            if(bLegacy)
+            {
+                legacy::splitLineByVerLine(rightPosVec, line[0], line[1], line[2], line[3], segVec);
+                continue;
+            }
+            stitcher.stitch(line[0], line[1], line[2], line[3], [&segVec](const int &iArea,
+                            const int64_t &nStartX, const int64_t &nStartY, const int64_t &nEndX, const int64_t &nEndY) {
+                segVec << Segment { iArea, nStartX, nStartY, nEndX, nEndY };
+            });
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(TestSplicingStitcher)
+
+#include "tst_splicingstitcher.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_splicingstitcher
+SOURCES += tst_splicingstitcher.cpp
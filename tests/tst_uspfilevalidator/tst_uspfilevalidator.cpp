@@ -0,0 +1,282 @@
+#include <QtTest>
+#include <QCryptographicHash>
+#include <QTemporaryDir>
+#include <cstring>
+#include <limits>
+#include <random>
+
+#include "uspfilevalidator.h"
+#include "uspfilereader.h"
+
+namespace {
+template<typename T>
+inline void appendValue(QByteArray &buf, const T &value)
+{
+    buf.append(reinterpret_cast<const char *>(&value), int(sizeof(T)));
+}
+
+inline void appendProperty(QByteArray &buf, const quint8 &id, const qint32 &value)
+{
+    buf.append(char(id));
+    appendValue(buf, value);
+}
+
+inline void appendLine(QByteArray &buf, const quint8 &type, const qint32 &x, const qint32 &y)
+{
+    buf.append(char(type));
+    appendValue(buf, x);
+    appendValue(buf, y);
+}
+
+///
+/// @brief 损坏方式
+///
+enum FixtureDefect {
+    DefectNone = 0,
+    DefectTruncatedLayer,       // 截断在层数据中间
+    DefectTruncatedEnding,      // 截断文件结束标记
+    DefectTruncatedTable,       // 截断层索引表文件尾
+    DefectFlippedCoordinate,    // 坐标字节翻转
+    DefectUnknownSection,       // 未知区段标识
+    DefectBadMarkLoopCount,     // MARKLOOP 数量越界
+    DefectBadTableEntry,        // 索引表偏移越界
+    DefectOutOfBounds,          // 扫描线超出层包围盒
+};
+
+///
+/// @brief 生成 USP 测试文件
+/// @details 与 USPFileWriter 输出结构一致: XML 信息(含扫描数据 MD5)、起始属性、各层数据、
+///   文件结束标记, 可选层索引表. 每层一个填充块, 含单条跳转/标记线及 MARKLOOP
+///
+class USPFixture
+{
+public:
+    USPFixture(const int &nLayerCnt, const bool &bLayerTable, const quint32 &seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<qint32> coorDist(-500000, 500000);
+        std::uniform_int_distribution<int> loopDist(0, 40);
+
+        _data.append(char(0));
+        for(int iLayer = 1; iLayer <= nLayerCnt; ++ iLayer)
+        {
+            QVector<QPair<qint32, qint32>> points;
+            const int nLoopCnt = loopDist(rng);
+            for(int i = 0; i < nLoopCnt + 2; ++ i) points << qMakePair(coorDist(rng), coorDist(rng));
+
+            qint32 nMinX = points[0].first, nMaxX = nMinX, nMinY = points[0].second, nMaxY = nMinY;
+            for(const auto &pt : points)
+            {
+                nMinX = qMin(nMinX, pt.first);
+                nMaxX = qMax(nMaxX, pt.first);
+                nMinY = qMin(nMinY, pt.second);
+                nMaxY = qMax(nMaxY, pt.second);
+            }
+
+            USPLayerEntry entry;
+            entry.nLayer = iLayer;
+            entry.nOffset = _data.size();
+            entry.nBlockCnt = 1;
+            entry.nVectorCnt = points.size();
+
+            QByteArray layer;
+            appendProperty(layer, SECTION_LAYER, iLayer);
+            appendProperty(layer, SECTION_MINX, nMinX);
+            appendProperty(layer, SECTION_MAXX, nMaxX);
+            appendProperty(layer, SECTION_MINY, nMinY);
+            appendProperty(layer, SECTION_MAXY, nMaxY);
+            layer.append(char(SECTION_HATCH));
+            layer.append(char(SECTION_HATCHCOOR));
+            appendProperty(layer, SECTION_LASERPOWER, 200);
+            appendProperty(layer, SECTION_MARKSPEED, 1000);
+            appendLine(layer, SECTION_SCANTYPE_JUMP, points[0].first, points[0].second);
+            appendLine(layer, SECTION_SCANTYPE_MARK, points[1].first, points[1].second);
+            _markLoopPos << _data.size() + layer.size();
+            layer.append(char(SECTION_SCANTYPE_MARKLOOP));
+            appendValue(layer, qint32(nLoopCnt));
+            for(int i = 2; i < points.size(); ++ i)
+            {
+                appendValue(layer, points[i].first);
+                appendValue(layer, points[i].second);
+            }
+            layer.append(char(SECTION_LAYEREND));
+
+            entry.nLength = layer.size();
+            entry.nChecksum = USPFileReader::calcChecksum(layer.constData(), layer.size());
+            _layerTable << entry;
+            _data.append(layer);
+        }
+        _endingPos = _data.size();
+        _data.append(char(SECTION_FILEEND));
+        _data.append("FileEnding");
+
+        if(bLayerTable)
+        {
+            const qint64 nTableOffset = _data.size();
+            for(const auto &entry : qAsConst(_layerTable))
+            {
+                appendValue(_data, entry.nLayer);
+                appendValue(_data, entry.nOffset);
+                appendValue(_data, entry.nLength);
+                appendValue(_data, entry.nBlockCnt);
+                appendValue(_data, entry.nVectorCnt);
+                appendValue(_data, entry.nChecksum);
+            }
+            USPLayerFooter footer;
+            footer.nTableOffset = nTableOffset;
+            footer.nLayerCnt = _layerTable.size();
+            appendValue(_data, footer.nTableOffset);
+            appendValue(_data, footer.nLayerCnt);
+            appendValue(_data, footer.nVersion);
+            appendValue(_data, footer.nMagic);
+        }
+    }
+
+    ///
+    /// @brief 按损坏方式写出文件, MD5 按未损坏的数据计算
+    ///
+    bool save(const QString &fileName, const FixtureDefect &defect) const
+    {
+        QByteArray data = _data;
+        const auto &layer = _layerTable[_layerTable.size() / 2];
+        switch(defect)
+        {
+        case DefectTruncatedLayer: data.truncate(int(layer.nOffset + layer.nLength / 2)); break;
+        case DefectTruncatedEnding: data.truncate(int(_endingPos + 4)); break;
+        case DefectTruncatedTable: data.chop(USPLAYERFOOTER_SIZE / 2); break;
+        case DefectFlippedCoordinate: data.data()[layer.nOffset + layer.nLength - 2] ^= 0x5A; break;
+        case DefectUnknownSection: data.data()[_markLoopPos[_layerTable.size() / 2]] = char(0x7F); break;
+        case DefectBadMarkLoopCount:
+        {
+            const qint32 nCnt = 0x10000000;
+            memcpy(data.data() + _markLoopPos[_layerTable.size() / 2] + 1, &nCnt, 4);
+            break;
+        }
+        case DefectBadTableEntry:
+        {
+            const qint64 nOffset = _data.size() * 2;
+            const int tablePos = data.size() - USPLAYERFOOTER_SIZE - _layerTable.size() * USPLAYERENTRY_SIZE;
+            memcpy(data.data() + tablePos + 4, &nOffset, 8);
+            break;
+        }
+        case DefectOutOfBounds:
+        {
+            // 层包围盒 MAXX 缩小, 扫描线越界
+            const qint32 nMaxX = std::numeric_limits<qint32>::min();
+            memcpy(data.data() + layer.nOffset + 11, &nMaxX, 4);
+            break;
+        }
+        default: break;
+        }
+
+        QFile file(fileName);
+        if(false == file.open(QIODevice::WriteOnly)) return false;
+        const QByteArray md5 = QCryptographicHash::hash(_data, QCryptographicHash::Md5).toHex();
+        file.write("<FileInfo><MD5>" + md5 + "</MD5></FileInfo>\n");
+        return file.write(data) == data.size();
+    }
+
+private:
+    QByteArray _data;                   // 扫描数据, 即 XML 信息之后的部分
+    QVector<USPLayerEntry> _layerTable;
+    QVector<qint64> _markLoopPos;
+    qint64 _endingPos = 0;
+};
+}
+
+Q_DECLARE_METATYPE(FixtureDefect)
+
+class TestUSPFileValidator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void validFile_data();
+    void validFile();
+    void rejectsDefect_data();
+    void rejectsDefect();
+    void missingFile();
+};
+
+void TestUSPFileValidator::validFile_data()
+{
+    QTest::addColumn<bool>("bLayerTable");
+
+    QTest::newRow("sequential") << false;
+    QTest::newRow("layer table") << true;
+}
+
+void TestUSPFileValidator::validFile()
+{
+    QFETCH(bool, bLayerTable);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString strFile = dir.filePath("valid.usp");
+    QVERIFY(USPFixture(20, bLayerTable, 45).save(strFile, DefectNone));
+
+    const auto result = USPFileValidator::validate(strFile);
+    QVERIFY2(result.isValid(), qPrintable(result.errorList.join("; ")));
+    QCOMPARE(result.bHasLayerTable, bLayerTable);
+    QVERIFY(result.bHasMD5);
+    QCOMPARE(result.nLayerCnt, qint64(20));
+    QCOMPARE(result.nBlockCnt, qint64(20));
+    QCOMPARE(result.nJumpCnt, qint64(20));
+    QVERIFY(result.nMarkCnt >= 20);
+}
+
+void TestUSPFileValidator::rejectsDefect_data()
+{
+    QTest::addColumn<bool>("bLayerTable");
+    QTest::addColumn<FixtureDefect>("defect");
+    QTest::addColumn<bool>("bStructureValid");
+
+    QTest::newRow("truncated layer") << false << DefectTruncatedLayer << false;
+    QTest::newRow("truncated ending") << false << DefectTruncatedEnding << false;
+    QTest::newRow("truncated table") << true << DefectTruncatedTable << false;
+    QTest::newRow("flipped coordinate") << false << DefectFlippedCoordinate << true;
+    QTest::newRow("flipped coordinate, table") << true << DefectFlippedCoordinate << false;
+    QTest::newRow("unknown section") << false << DefectUnknownSection << false;
+    QTest::newRow("unknown section, table") << true << DefectUnknownSection << false;
+    QTest::newRow("bad markloop count") << false << DefectBadMarkLoopCount << false;
+    QTest::newRow("bad markloop count, table") << true << DefectBadMarkLoopCount << false;
+    QTest::newRow("bad table entry") << true << DefectBadTableEntry << false;
+    QTest::newRow("out of bounds") << false << DefectOutOfBounds << true;
+}
+
+void TestUSPFileValidator::rejectsDefect()
+{
+    QFETCH(bool, bLayerTable);
+    QFETCH(FixtureDefect, defect);
+    QFETCH(bool, bStructureValid);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString strFile = dir.filePath("defect.usp");
+    QVERIFY(USPFixture(20, bLayerTable, 45).save(strFile, defect));
+
+    // 关闭 MD5 校验时仍须由结构或坐标检查发现
+    USPValidateOptions options;
+    options.bCheckMD5 = false;
+    const auto result = USPFileValidator::validate(strFile, options);
+    QCOMPARE(result.bStructureValid, bStructureValid);
+    if(bStructureValid) QVERIFY(result.nOutOfBoundsCnt > 0 || DefectFlippedCoordinate == defect);
+    else QVERIFY(false == result.errorList.isEmpty());
+
+    // 完整校验一律拒绝
+    const auto fullResult = USPFileValidator::validate(strFile);
+    QVERIFY(false == fullResult.isValid());
+}
+
+void TestUSPFileValidator::missingFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const auto result = USPFileValidator::validate(dir.filePath("missing.usp"));
+    QVERIFY(false == result.isValid());
+    QVERIFY(false == result.errorList.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(TestUSPFileValidator)
+
+#include "tst_uspfilevalidator.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_uspfilevalidator
+SOURCES += tst_uspfilevalidator.cpp
@@ -0,0 +1,374 @@
+#include <QtTest>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <limits>
+#include <random>
+
+#ifdef Q_OS_WIN
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+#include "uspfilewriter.h"
+#include "uspfilereader.h"
+#include "publicheader.h"
+
+namespace {
+const int ScannerCnt = 2;
+const int LayerCnt = 12;
+const int EmptyLayer = 3;
+
+struct LayerBlock {
+    int nScanner = 0;
+    UFFWRITEDATA mUFileData;
+};
+typedef QVector<LayerBlock> LayerBlocks;
+
+///
+/// @brief 随机生成各层数据块, EmptyLayer 层无扫描数据
+/// @details 相邻点坐标均不相同, 写入端不会跳过任何扫描线
+///
+QMap<int, LayerBlocks> makeLayers(const int &nSeed)
+{
+    std::mt19937 rng(nSeed);
+    std::uniform_int_distribution<int> blockDist(1, 6);
+    std::uniform_int_distribution<int> lineDist(1, 300);
+    std::uniform_int_distribution<int> coorDist(-2000000, 2000000);
+    std::uniform_int_distribution<int> stepDist(1, 5000);
+
+    QMap<int, LayerBlocks> layers;
+    for(int iLayer = 1; iLayer <= LayerCnt; ++ iLayer)
+    {
+        auto &blocks = layers[iLayer];
+        if(EmptyLayer == iLayer) continue;
+
+        const int nBlockCnt = blockDist(rng);
+        for(int iBlock = 0; iBlock < nBlockCnt; ++ iBlock)
+        {
+            LayerBlock block;
+            block.nScanner = (iLayer + iBlock) % ScannerCnt;
+            auto &mUFileData = block.mUFileData;
+            mUFileData.nMode_Section = qint8(SECTION_POLYGON + 2 * (iBlock % 3));
+            mUFileData.nMode_Coor = qint8(mUFileData.nMode_Section + 1);
+            mUFileData.nPartIndex = iBlock;
+            mUFileData.nLaserPower = 100 + iLayer;
+            mUFileData.nMarkSpeed = 1000 + iBlock;
+
+            SCANLINE line;
+            line.nX = coorDist(rng);
+            line.nY = coorDist(rng);
+            const int nLineCnt = lineDist(rng);
+            for(int iLine = 0; iLine < nLineCnt; ++ iLine)
+            {
+                line.nLineType = (0 == iLine % 4) ? SECTION_SCANTYPE_JUMP : SECTION_SCANTYPE_MARK;
+                line.nX += (iLine & 0x1) ? stepDist(rng) : -stepDist(rng);
+                line.nY += stepDist(rng);
+                mUFileData.listSLines << line;
+            }
+            blocks << block;
+        }
+    }
+    return layers;
+}
+
+///
+/// @brief 写入端输出顺序: 按扫描器依次输出, 同一扫描器内保持入队顺序
+///
+LayerBlocks outputOrder(const LayerBlocks &blocks)
+{
+    LayerBlocks result;
+    for(int iScanner = 0; iScanner < ScannerCnt; ++ iScanner)
+    {
+        for(const auto &block : blocks) if(iScanner == block.nScanner) result << block;
+    }
+    return result;
+}
+
+BOUNDINGRECT layerRect(const LayerBlocks &blocks)
+{
+    BOUNDINGRECT rc;
+    rc.minX = rc.minY = std::numeric_limits<int>::max();
+    rc.maxX = rc.maxY = std::numeric_limits<int>::min();
+    for(const auto &block : blocks)
+    {
+        for(const auto &line : block.mUFileData.listSLines)
+        {
+            rc.minX = qMin<int>(rc.minX, line.nX);
+            rc.maxX = qMax<int>(rc.maxX, line.nX);
+            rc.minY = qMin<int>(rc.minY, line.nY);
+            rc.maxY = qMax<int>(rc.maxY, line.nY);
+        }
+    }
+    return rc;
+}
+
+///
+/// @brief 各写入器共享的参数, 与 createFileWriter 相同: 2 扫描器 x 1 光束, 开启层索引表
+///
+QSharedPointer<WriterBufferParas> makeParas(const int &nScanEncoding)
+{
+    auto paras = QSharedPointer<WriterBufferParas>(new WriterBufferParas);
+    paras->_extendedParaPtr->addVariantMap(QVariantMap { { "Global/nLayerTable", 1 },
+                                                         { "Global/nScanEncoding", nScanEncoding } });
+    paras->_bpcParaPtr->nNumber_SplicingScanner = ScannerCnt;
+    paras->_bpcParaPtr->nScannerNumber = ScannerCnt;
+    paras->_bppParaPtr->sGeneralPara.nNumber_Beam = 1;
+    return paras;
+}
+
+bool initWriter(USPFileWriter &writer, const QSharedPointer<WriterBufferParas> &paras, const QString &strFile)
+{
+    writer.getBufPara()->clearFileDataList();
+    writer.getBufPara()->gFile.setFileName(strFile);
+    writer.getBufPara()->_writerBufferParas = paras;
+    return writer.initFileWrite();
+}
+
+///
+/// @brief 按 layerProcessing 的顺序写入指定层范围
+///
+void writeLayers(USPFileWriter &writer, const QMap<int, LayerBlocks> &layers, const int &minLayer, const int &maxLayer)
+{
+    for(int iLayer = minLayer; iLayer <= maxLayer; ++ iLayer)
+    {
+        const auto &blocks = layers[iLayer];
+        writer.writeLayerInfo(iLayer, layerRect(blocks), 0.0);
+        if(blocks.size()) writer.writeAreaInfo(iLayer * 100);
+
+        writer.startBuffWriter();
+        for(const auto &block : blocks)
+        {
+            UFFWRITEDATA mUFileData = block.mUFileData;
+            writer.getBufPara()->appendFileData(mUFileData, block.nScanner, 0);
+        }
+        writer.waitBuffWriter();
+    }
+}
+
+///
+/// @brief 写入文件结束信息并生成 .usp, 返回 .usp 路径
+///
+QString finishFile(USPFileWriter &writer)
+{
+    writer.writeFileEnd();
+    QJsonObject jsonInfo;
+    writer.createUSPFile("part", "test.bpp", 0.03f, nullptr, 1, LayerCnt, jsonInfo);
+    const QString strTempFile = writer.getBufPara()->gFile.fileName();
+    return strTempFile.left(strTempFile.size() - 3) + "usp";
+}
+
+///
+/// @brief 单个写入器顺序写入所有层
+///
+QString writeDirect(const QString &strDir, const QMap<int, LayerBlocks> &layers, const int &nScanEncoding)
+{
+    USPFileWriter writer;
+    if(false == initWriter(writer, makeParas(nScanEncoding), strDir + "/direct.tmp")) return QString();
+    writer.writeFileBegin_SomePropertys();
+    writeLayers(writer, layers, 1, LayerCnt);
+    return finishFile(writer);
+}
+
+///
+/// @brief 与 partProcessing 的多线程分段相同: 各段写入子文件, 主写入器按段拼接数据并合并层索引
+///
+QString writeMerged(const QString &strDir, const QMap<int, LayerBlocks> &layers, const int &nScanEncoding,
+                    const QVector<int> &splitLayers)
+{
+    const auto paras = makeParas(nScanEncoding);
+    USPFileWriter writer;
+    if(false == initWriter(writer, paras, strDir + "/merged.tmp")) return QString();
+    writer.writeFileBegin_SomePropertys();
+
+    int nBeginLayer = 1;
+    for(int iPart = 0; iPart <= splitLayers.size(); ++ iPart)
+    {
+        const int nEndLayer = iPart < splitLayers.size() ? splitLayers[iPart] : LayerCnt;
+        const QString strSubFile = strDir + QString("/%1.subtemp").arg(iPart);
+        QVector<USPLayerEntry> subLayerTable;
+        {
+            USPFileWriter subWriter;
+            if(false == initWriter(subWriter, paras, strSubFile)) return QString();
+            writeLayers(subWriter, layers, nBeginLayer, nEndLayer);
+            subLayerTable = subWriter.layerTable();
+            subWriter.getBufPara()->gFile.close();
+        }
+
+        QFile file(strSubFile);
+        if(false == file.open(QIODevice::ReadOnly)) return QString();
+        writer.appendLayerTable(subLayerTable, writer.getBufPara()->gFile.pos());
+        writer.getBufPara()->gFile.write(file.readAll());
+        file.close();
+        file.remove();
+        nBeginLayer = nEndLayer + 1;
+    }
+    return finishFile(writer);
+}
+
+inline quint32 zlibCrc32(const char *data, const qint64 &size)
+{
+    return quint32(crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef *>(data), uInt(size)));
+}
+}
+
+class TestUSPFileWriter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundTrip_data();
+    void roundTrip();
+    void checksumDetectsCorruption();
+
+private:
+    void checkFile(const QString &, const QMap<int, LayerBlocks> &, QVector<QByteArray> &);
+};
+
+///
+/// @brief 读取 .usp 并与写入的数据逐层比较, 输出各层原始字节
+///
+void TestUSPFileWriter::checkFile(const QString &strFile, const QMap<int, LayerBlocks> &layers,
+                                  QVector<QByteArray> &layerBytes)
+{
+    USPFileReader reader;
+    QVERIFY(reader.open(strFile));
+    QVERIFY(reader.isMapped());
+    QVERIFY(reader.hasLayerTable());
+
+    // 索引表偏移相对 XML 信息之后的扫描数据起点, 由文件尾反推的起点与 </FileInfo> 位置一致
+    const char *mapData = reader.mapData();
+    QVERIFY(QByteArray::fromRawData(mapData, int(reader.fileSize())).startsWith("<?xml"));
+    QVERIFY(reader.dataOffset() > 0);
+    QCOMPARE(reader.dataOffset(), USPFileReader::findDataOffset(mapData, reader.fileSize()));
+    QCOMPARE(reader.layerTable().size(), layers.size());
+
+    // 各层紧接在起始属性之后依次排列
+    layerBytes.clear();
+    qint64 nExpectedOffset = 1;
+    for(const auto &entry : reader.layerTable())
+    {
+        QCOMPARE(entry.nOffset, nExpectedOffset);
+        nExpectedOffset += entry.nLength;
+        const char *data = mapData + reader.dataOffset() + entry.nOffset;
+        QCOMPARE(quint8(data[0]), quint8(SECTION_LAYER));
+        QCOMPARE(quint8(data[entry.nLength - 1]), quint8(SECTION_LAYEREND));
+        QCOMPARE(entry.nChecksum, zlibCrc32(data, entry.nLength));
+        layerBytes << QByteArray(data, int(entry.nLength));
+
+        QVERIFY(layers.contains(entry.nLayer));
+        const auto blocks = outputOrder(layers[entry.nLayer]);
+        qint64 nVectorCnt = 0;
+        for(const auto &block : blocks) nVectorCnt += block.mUFileData.listSLines.size();
+        QCOMPARE(entry.nBlockCnt, qint32(blocks.size()));
+        QCOMPARE(entry.nVectorCnt, nVectorCnt);
+
+        USPLayerData layerData;
+        QVERIFY(reader.decodeLayer(entry.nLayer, layerData));
+        QCOMPARE(layerData.nLayer, entry.nLayer);
+        if(blocks.isEmpty())
+        {
+            QCOMPARE(layerData.nMinX, USPEMPTYBOUND_MIN);
+            QCOMPARE(layerData.nMaxX, USPEMPTYBOUND_MAX);
+            QVERIFY(layerData.blockVec.isEmpty());
+            continue;
+        }
+
+        const auto rc = layerRect(blocks);
+        QCOMPARE(layerData.nMinX, qint32(rc.minX));
+        QCOMPARE(layerData.nMaxY, qint32(rc.maxY));
+        QCOMPARE(layerData.nArea, entry.nLayer * 100);
+        QCOMPARE(layerData.blockVec.size(), blocks.size());
+        for(int iBlock = 0; iBlock < blocks.size(); ++ iBlock)
+        {
+            const auto &block = layerData.blockVec[iBlock];
+            const auto &mUFileData = blocks[iBlock].mUFileData;
+            QCOMPARE(block.nScannerIndex, qint32(blocks[iBlock].nScanner));
+            QCOMPARE(block.nBeamIndex, qint32(0));
+            QCOMPARE(block.nPartIndex, qint32(mUFileData.nPartIndex));
+            QCOMPARE(block.nModeSection, mUFileData.nMode_Section);
+            QCOMPARE(block.nModeCoor, mUFileData.nMode_Coor);
+            QCOMPARE(block.nLaserPower, qint32(mUFileData.nLaserPower));
+            QCOMPARE(block.nMarkSpeed, qint32(mUFileData.nMarkSpeed));
+            QCOMPARE(block.listSLines.size(), mUFileData.listSLines.size());
+            for(int iLine = 0; iLine < block.listSLines.size(); ++ iLine)
+            {
+                QCOMPARE(block.listSLines[iLine].nLineType, mUFileData.listSLines[iLine].nLineType);
+                QCOMPARE(block.listSLines[iLine].nX, mUFileData.listSLines[iLine].nX);
+                QCOMPARE(block.listSLines[iLine].nY, mUFileData.listSLines[iLine].nY);
+            }
+        }
+    }
+    QCOMPARE(quint8(mapData[reader.dataOffset() + nExpectedOffset]), quint8(SECTION_FILEEND));
+}
+
+void TestUSPFileWriter::roundTrip_data()
+{
+    QTest::addColumn<int>("nScanEncoding");
+
+    QTest::newRow("raw") << int(SCANENCODING_RAW);
+    QTest::newRow("delta") << int(SCANENCODING_DELTA_V1);
+}
+
+void TestUSPFileWriter::roundTrip()
+{
+    QFETCH(int, nScanEncoding);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const auto layers = makeLayers(44);
+
+    const QString strDirectFile = writeDirect(dir.path(), layers, nScanEncoding);
+    QVERIFY(QFileInfo::exists(strDirectFile));
+    QVector<QByteArray> directBytes;
+    checkFile(strDirectFile, layers, directBytes);
+    if(QTest::currentTestFailed()) return;
+
+    // 子文件合并: 各段层偏移加上子文件在主文件中的起点, 层数据与单个写入器逐字节一致
+    const QString strMergedFile = writeMerged(dir.path(), layers, nScanEncoding, QVector<int> { 2, EmptyLayer, 8 });
+    QVERIFY(QFileInfo::exists(strMergedFile));
+    QVector<QByteArray> mergedBytes;
+    checkFile(strMergedFile, layers, mergedBytes);
+    if(QTest::currentTestFailed()) return;
+    QCOMPARE(mergedBytes.size(), directBytes.size());
+    for(int iLayer = 0; iLayer < directBytes.size(); ++ iLayer) QVERIFY(mergedBytes[iLayer] == directBytes[iLayer]);
+}
+
+void TestUSPFileWriter::checksumDetectsCorruption()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString strFile = writeDirect(dir.path(), makeLayers(45), SCANENCODING_RAW);
+
+    // 翻转第 2 层最后一条扫描线 Y 坐标的一个字节, 层结构仍然有效
+    qint64 nPos = 0;
+    {
+        USPFileReader reader;
+        QVERIFY(reader.open(strFile));
+        const auto *entry = reader.findLayer(2);
+        QVERIFY(entry);
+        nPos = reader.dataOffset() + entry->nOffset + entry->nLength - 3;
+    }
+    QFile file(strFile);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.seek(nPos));
+    char byte = 0;
+    QVERIFY(file.getChar(&byte));
+    QVERIFY(file.seek(nPos));
+    QVERIFY(file.putChar(char(byte ^ 0x5A)));
+    file.close();
+
+    USPFileReader reader;
+    QVERIFY(reader.open(strFile));
+    USPLayerData layerData;
+    QVERIFY(false == reader.decodeLayer(2, layerData));
+    QVERIFY(reader.decodeLayer(2, layerData, false));
+    for(int iLayer = 1; iLayer <= LayerCnt; ++ iLayer)
+    {
+        if(2 != iLayer) QVERIFY(reader.decodeLayer(iLayer, layerData));
+    }
+}
+
+QTEST_APPLESS_MAIN(TestUSPFileWriter)
+
+#include "tst_uspfilewriter.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_uspfilewriter
+SOURCES += tst_uspfilewriter.cpp
@@ -0,0 +1,238 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <random>
+
+#include "uspinstancecopier.h"
+#include "publicheader.h"
+
+namespace {
+enum LayerKind {
+    LayerNormal = 0,
+    LayerEmpty,             // 无扫描数据, 边界为空层哨兵值
+    LayerPoint              // 所有扫描线位于同一点, 最小值等于最大值
+};
+
+inline void writeProperty(QFile *file, const quint8 &id, const qint32 &value)
+{
+    writeData8(file, qint8(id));
+    writeData32(file, value);
+}
+
+///
+/// @brief 生成源 USP 文件
+/// @details 与 USPFileWriter 输出结构一致: XML 信息、起始属性、各层数据及文件结束标记;
+///   扫描块由 writeBlockData 写入, 第 3 层为空层, 第 5 层为单点层
+///
+bool writeSourceFile(const QString &fileName, const int &nLayerCnt, const int &nBlockCnt, const int &nLineCnt,
+                     const bool &bDeltaEncoding)
+{
+    QFile file(fileName);
+    if(false == file.open(QIODevice::WriteOnly)) return false;
+    file.write("<FileInfo></FileInfo>\n");
+    writeData8(&file, 0);
+
+    std::mt19937 rng(50);
+    std::uniform_int_distribution<int> coorDist(-100000, 100000);
+    std::uniform_int_distribution<int> stepDist(-2000, 2000);
+    for(int iLayer = 1; iLayer <= nLayerCnt; ++ iLayer)
+    {
+        const LayerKind kind = 3 == iLayer ? LayerEmpty : (5 == iLayer ? LayerPoint : LayerNormal);
+        QVector<UFFWRITEDATA> blocks;
+        qint32 nMinX = USPEMPTYBOUND_MIN, nMaxX = USPEMPTYBOUND_MAX, nMinY = USPEMPTYBOUND_MIN, nMaxY = USPEMPTYBOUND_MAX;
+        for(int iBlock = 0; LayerEmpty != kind && iBlock < nBlockCnt; ++ iBlock)
+        {
+            UFFWRITEDATA mUFileData;
+            mUFileData.nMode_Section = SECTION_HATCH;
+            mUFileData.nMode_Coor = SECTION_HATCHCOOR;
+            mUFileData.nPartIndex = 0;
+            mUFileData.nLaserPower = 200;
+            mUFileData.nMarkSpeed = 1000;
+
+            SCANLINE line;
+            line.nX = coorDist(rng);
+            line.nY = coorDist(rng);
+            for(int iLine = 0; iLine < nLineCnt; ++ iLine)
+            {
+                line.nLineType = (iLine & 0x1) ? SECTION_SCANTYPE_MARK : SECTION_SCANTYPE_JUMP;
+                if(LayerPoint != kind)
+                {
+                    line.nX += stepDist(rng);
+                    line.nY += stepDist(rng);
+                }
+                nMinX = qMin(nMinX, line.nX);
+                nMaxX = qMax(nMaxX, line.nX);
+                nMinY = qMin(nMinY, line.nY);
+                nMaxY = qMax(nMaxY, line.nY);
+                mUFileData.listSLines << line;
+            }
+            blocks << mUFileData;
+        }
+
+        writeProperty(&file, SECTION_LAYER, iLayer);
+        writeProperty(&file, SECTION_MINX, nMinX);
+        writeProperty(&file, SECTION_MAXX, nMaxX);
+        writeProperty(&file, SECTION_MINY, nMinY);
+        writeProperty(&file, SECTION_MAXY, nMaxY);
+        writeProperty(&file, SECTION_CURRENTSCANNERINDEX, 0);
+        writeProperty(&file, SECTION_CURRENTBEAMINDEX, 0);
+        for(const auto &mUFileData : blocks) writeBlockData(&file, mUFileData, bDeltaEncoding);
+        writeData8(&file, SECTION_LAYEREND);
+    }
+    writeData8(&file, SECTION_FILEEND);
+    file.write("FileEnding");
+    return true;
+}
+
+///
+/// @brief 平移拷贝到目标文件, 与 instanceProcessing 相同: 写入起始属性后逐层拷贝
+///
+bool copyInstance(const QString &srcFile, const QString &dstFile, const qint32 &nOffsetX, const qint32 &nOffsetY,
+                  QVector<USPLayerEntry> &layerTable)
+{
+    USPInstanceCopier copier;
+    if(false == copier.open(srcFile)) return false;
+    QFile file(dstFile);
+    if(false == file.open(QIODevice::WriteOnly)) return false;
+    writeData8(&file, 0);
+    return copier.copyTo(&file, nOffsetX, nOffsetY, layerTable);
+}
+
+QByteArray readFile(const QString &fileName)
+{
+    QFile file(fileName);
+    if(false == file.open(QIODevice::ReadOnly)) return QByteArray();
+    return file.readAll();
+}
+
+bool decodeLayers(const QByteArray &data, const QVector<USPLayerEntry> &layerTable, QVector<USPLayerData> &layers)
+{
+    layers.clear();
+    for(const auto &entry : layerTable)
+    {
+        USPLayerData layerData;
+        if(false == USPFileReader::decodeLayerData(data.constData() + entry.nOffset, entry.nLength, layerData)) return false;
+        layers << layerData;
+    }
+    return true;
+}
+}
+
+class TestUSPInstanceCopier : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void translatesLayers_data();
+    void translatesLayers();
+    void benchmarkPlate_data();
+    void benchmarkPlate();
+};
+
+void TestUSPInstanceCopier::translatesLayers_data()
+{
+    QTest::addColumn<bool>("bDeltaEncoding");
+
+    QTest::newRow("raw") << false;
+    QTest::newRow("delta") << true;
+}
+
+void TestUSPInstanceCopier::translatesLayers()
+{
+    QFETCH(bool, bDeltaEncoding);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString strSrcFile = dir.filePath("source.usp");
+    QVERIFY(writeSourceFile(strSrcFile, 8, 4, 64, bDeltaEncoding));
+
+    // 零偏移拷贝与源文件扫描数据逐字节一致
+    QVector<USPLayerEntry> srcTable, dstTable;
+    QVERIFY(copyInstance(strSrcFile, dir.filePath("identity.usp"), 0, 0, srcTable));
+    const QByteArray srcFileData = readFile(strSrcFile);
+    const QByteArray identityData = readFile(dir.filePath("identity.usp"));
+    const int nDataOffset = srcFileData.indexOf('\n') + 1;
+    QCOMPARE(identityData, srcFileData.mid(nDataOffset, identityData.size()));
+    QCOMPARE(srcTable.size(), 8);
+
+    const qint32 nOffsetX = 123456, nOffsetY = -65432;
+    QVERIFY(copyInstance(strSrcFile, dir.filePath("copy.usp"), nOffsetX, nOffsetY, dstTable));
+    QCOMPARE(dstTable.size(), srcTable.size());
+
+    QVector<USPLayerData> srcLayers, dstLayers;
+    QVERIFY(decodeLayers(identityData, srcTable, srcLayers));
+    QVERIFY(decodeLayers(readFile(dir.filePath("copy.usp")), dstTable, dstLayers));
+    for(int iLayer = 0; iLayer < srcLayers.size(); ++ iLayer)
+    {
+        const auto &srcLayer = srcLayers[iLayer], &dstLayer = dstLayers[iLayer];
+        QCOMPARE(dstLayer.nLayer, srcLayer.nLayer);
+        if(3 == srcLayer.nLayer)
+        {
+            // 空层保持哨兵值
+            QVERIFY(srcLayer.blockVec.isEmpty());
+            QCOMPARE(dstLayer.nMinX, USPEMPTYBOUND_MIN);
+            QCOMPARE(dstLayer.nMaxX, USPEMPTYBOUND_MAX);
+            QCOMPARE(dstLayer.nMinY, USPEMPTYBOUND_MIN);
+            QCOMPARE(dstLayer.nMaxY, USPEMPTYBOUND_MAX);
+            continue;
+        }
+        if(5 == srcLayer.nLayer)
+        {
+            QCOMPARE(srcLayer.nMinX, srcLayer.nMaxX);
+            QCOMPARE(srcLayer.nMinY, srcLayer.nMaxY);
+        }
+        QCOMPARE(dstLayer.nMinX, srcLayer.nMinX + nOffsetX);
+        QCOMPARE(dstLayer.nMaxX, srcLayer.nMaxX + nOffsetX);
+        QCOMPARE(dstLayer.nMinY, srcLayer.nMinY + nOffsetY);
+        QCOMPARE(dstLayer.nMaxY, srcLayer.nMaxY + nOffsetY);
+
+        QCOMPARE(dstLayer.blockVec.size(), srcLayer.blockVec.size());
+        for(int iBlock = 0; iBlock < srcLayer.blockVec.size(); ++ iBlock)
+        {
+            const auto &srcLines = srcLayer.blockVec[iBlock].listSLines;
+            const auto &dstLines = dstLayer.blockVec[iBlock].listSLines;
+            QCOMPARE(dstLines.size(), srcLines.size());
+            for(int iLine = 0; iLine < srcLines.size(); ++ iLine)
+            {
+                QCOMPARE(dstLines[iLine].nLineType, srcLines[iLine].nLineType);
+                QCOMPARE(dstLines[iLine].nX, srcLines[iLine].nX + nOffsetX);
+                QCOMPARE(dstLines[iLine].nY, srcLines[iLine].nY + nOffsetY);
+            }
+        }
+    }
+}
+
+void TestUSPInstanceCopier::benchmarkPlate_data()
+{
+    QTest::addColumn<bool>("bDeltaEncoding");
+
+    QTest::newRow("raw, 50 copies") << false;
+    QTest::newRow("delta, 50 copies") << true;
+}
+
+void TestUSPInstanceCopier::benchmarkPlate()
+{
+    QFETCH(bool, bDeltaEncoding);
+
+    // 50 个相同零件排布在平台上, 源零件 100 层 x 10 块 x 500 条扫描线
+    const int nCopyCnt = 50;
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString strSrcFile = dir.filePath("source.usp");
+    QVERIFY(writeSourceFile(strSrcFile, 100, 10, 500, bDeltaEncoding));
+
+    bool bResult = true;
+    QBENCHMARK {
+        for(int iCopy = 0; iCopy < nCopyCnt; ++ iCopy)
+        {
+            QVector<USPLayerEntry> layerTable;
+            const qint32 nOffsetX = (iCopy % 10) * 250000, nOffsetY = (iCopy / 10) * 250000;
+            bResult &= copyInstance(strSrcFile, dir.filePath(QString("copy%1.usp").arg(iCopy)), nOffsetX, nOffsetY,
+                                    layerTable);
+        }
+    }
+    QVERIFY(bResult);
+}
+
+QTEST_APPLESS_MAIN(TestUSPInstanceCopier)
+
+#include "tst_uspinstancecopier.moc"
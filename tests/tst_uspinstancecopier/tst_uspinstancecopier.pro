@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_uspinstancecopier
+SOURCES += tst_uspinstancecopier.cpp
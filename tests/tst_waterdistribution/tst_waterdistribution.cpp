@@ -0,0 +1,289 @@
+#include <QtTest>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "WaterDistribution/waterdistributionpriv.h"
+
+namespace {
+///
+/// @brief 改为最小堆注水前的二分递归分配, 作为对照
+///
+class LegacyWaterDistribution
+{
+public:
+    std::vector<DistributionResult> initDistribution(const std::map<int, double> &inMap, const int &containerCnt)
+    {
+        std::vector<DistributionResult> res;
+        std::vector<PartInfo> mateVec;
+        for (const auto &inInfo : inMap)
+        {
+            mateVec.push_back(PartInfo(inInfo.first, inInfo.second));
+            if (inInfo.first < 0) _maxTotalWeight = std::max(_maxTotalWeight, inInfo.second);
+        }
+        startDistribution(res, mateVec, std::max(1, containerCnt), 0);
+        return res;
+    }
+
+private:
+    void startDistribution(std::vector<DistributionResult> &res, std::vector<PartInfo> &mateVec,
+                           const int &containerCnt, const int &startPos)
+    {
+        if (containerCnt > 1)
+        {
+            int leftContainerCnt_1 = containerCnt >> 1;
+            int leftContainerCnt_2 = leftContainerCnt_1;
+            double fRate1 = 0.5, fRate2 = 0.5;
+            if (containerCnt & 0x1)
+            {
+                leftContainerCnt_2 = leftContainerCnt_1 + 1;
+                fRate1 = double(leftContainerCnt_1) / containerCnt;
+                fRate2 = 1 - fRate1;
+            }
+            std::vector<PartInfo> out1, out2;
+            segementParts(mateVec, out1, out2, fRate1, fRate2, startPos + leftContainerCnt_1);
+            startDistribution(res, out1, leftContainerCnt_1, startPos);
+            startDistribution(res, out2, leftContainerCnt_2, startPos + leftContainerCnt_1);
+        }
+        else
+        {
+            DistributionResult rst;
+            rst._partsList = mateVec;
+            for (const auto &partInfo : rst._partsList) rst._totalWeight += partInfo._realWeight;
+            res.push_back(std::move(rst));
+        }
+    }
+
+    void segementParts(std::vector<PartInfo> &inArray, std::vector<PartInfo> &out1, std::vector<PartInfo> &out2,
+                       const double &rate1, const double &rate2, const int &containerCnt)
+    {
+        if (inArray.size() < 1) return;
+        std::sort(inArray.begin(), inArray.end(), [](const PartInfo &v1, const PartInfo &v2) -> bool {
+            if ((v1._index < 0) != (v2._index < 0)) return v1._index < 0;
+            return v1._realWeight > v2._realWeight;
+        });
+
+        const double factor = rate2 / rate1;
+        double targetWeight1 = 0.0;
+        for (const auto &partInfo : inArray) targetWeight1 += partInfo._realWeight;
+        targetWeight1 *= rate1;
+
+        double weight1 = 0.0, weight2 = 0.0;
+        auto append = [&](std::vector<PartInfo> &out, double &weight, const PartInfo &partInfo) {
+            out.push_back(partInfo);
+            weight += partInfo._realWeight;
+        };
+
+        size_t index = 0;
+        for (; index < inArray.size() && inArray[index]._index < 0; ++ index)
+        {
+            if (std::abs(inArray[index]._index) <= containerCnt) append(out1, weight1, inArray[index]);
+            else append(out2, weight2, inArray[index]);
+        }
+        if (index >= inArray.size()) return;
+
+        const auto &first = inArray[index];
+        if (first._realWeight < _allowedSegementArea || first._realWeight < _maxTotalWeight)
+        {
+            for (size_t i = index; i < inArray.size(); ++ i)
+            {
+                if (weight1 * factor <= weight2) append(out1, weight1, inArray[i]);
+                else append(out2, weight2, inArray[i]);
+            }
+            return;
+        }
+
+        for (size_t i = index + 1; i < inArray.size(); ++ i)
+        {
+            if (weight1 * factor <= weight2) append(out1, weight1, inArray[i]);
+            else append(out2, weight2, inArray[i]);
+        }
+        const double segementRate1 = (targetWeight1 - weight1) / first._realWeight;
+        if (segementRate1 < 1E-6 || segementRate1 * first._realWeight < _allowedMinArea)
+        {
+            append(out2, weight2, first);
+        }
+        else if (std::fabs(1 - segementRate1) < 1E-6 || std::fabs(1 - segementRate1) * first._realWeight < _allowedMinArea)
+        {
+            append(out1, weight1, first);
+        }
+        else
+        {
+            append(out1, weight1, PartInfo(first._index, first._weight, first._factor * segementRate1));
+            append(out2, weight2, PartInfo(first._index, first._weight, first._factor * (1 - segementRate1)));
+        }
+    }
+
+    double _maxTotalWeight = 0.0;
+    const double _allowedSegementArea = 2.5E7;
+    const double _allowedMinArea = 2E6;
+};
+
+///
+/// @brief 随机生成一层的零件权重: 多数为小零件, 少量可分割的大零件, 部分零件指定容器(序号为负)
+///
+std::map<int, double> makeInstance(std::mt19937 &rng, const int &containerCnt)
+{
+    std::uniform_int_distribution<int> partCntDist(1, 300);
+    std::uniform_real_distribution<double> smallDist(1E4, 1E7);
+    std::uniform_real_distribution<double> largeDist(2.5E7, 5E8);
+    std::uniform_int_distribution<int> percentDist(0, 99);
+
+    std::map<int, double> inMap;
+    const int nPartCnt = partCntDist(rng);
+    for (int i = 0; i < nPartCnt; ++ i)
+    {
+        inMap[i] = percentDist(rng) < 10 ? largeDist(rng) : smallDist(rng);
+    }
+    if (percentDist(rng) < 30)
+    {
+        const int nPinnedCnt = 1 + percentDist(rng) % containerCnt;
+        for (int i = 0; i < nPinnedCnt; ++ i) inMap[-1 - percentDist(rng) % containerCnt] = smallDist(rng);
+    }
+    return inMap;
+}
+
+double totalWeight(const std::map<int, double> &inMap)
+{
+    double fTotal = 0.0;
+    for (const auto &inInfo : inMap) fTotal += inInfo.second;
+    return fTotal;
+}
+
+double maxLoad(const std::vector<DistributionResult> &res)
+{
+    double fMax = 0.0;
+    for (const auto &disRes : res) fMax = std::max(fMax, disRes._totalWeight);
+    return fMax;
+}
+
+int segementCount(const std::vector<DistributionResult> &res)
+{
+    int nCnt = 0;
+    for (const auto &disRes : res) nCnt += int(disRes._partsList.size());
+    return nCnt;
+}
+
+///
+/// @brief 校验分配结果: 每个零件的系数之和为1, 各容器负载与零件权重一致, 指定容器的零件不被分割
+///
+bool checkResult(const std::map<int, double> &inMap, const std::vector<DistributionResult> &res,
+                 const int &containerCnt, QString &strError)
+{
+    if (int(res.size()) != containerCnt)
+    {
+        strError = QString("container count %1").arg(res.size());
+        return false;
+    }
+
+    std::map<int, double> factorMap;
+    for (int iContainer = 0; iContainer < containerCnt; ++ iContainer)
+    {
+        double fLoad = 0.0;
+        for (const auto &partInfo : res[iContainer]._partsList)
+        {
+            factorMap[partInfo._index] += partInfo._factor;
+            fLoad += partInfo._realWeight;
+            if (partInfo._index < 0 && -1 - partInfo._index != iContainer)
+            {
+                strError = QString("pinned part %1 in container %2").arg(partInfo._index).arg(iContainer);
+                return false;
+            }
+        }
+        if (std::fabs(fLoad - res[iContainer]._totalWeight) > 1E-6 * std::max(1.0, fLoad))
+        {
+            strError = QString("container %1 load mismatch").arg(iContainer);
+            return false;
+        }
+    }
+
+    if (factorMap.size() != inMap.size())
+    {
+        strError = QString("part count %1 != %2").arg(factorMap.size()).arg(inMap.size());
+        return false;
+    }
+    for (const auto &factor : factorMap)
+    {
+        if (0 == inMap.count(factor.first) || std::fabs(factor.second - 1.0) > 1E-9)
+        {
+            strError = QString("part %1 factor %2").arg(factor.first).arg(factor.second);
+            return false;
+        }
+    }
+    return true;
+}
+}
+
+class TestWaterDistribution : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void singleContainer();
+    void splitsLargePart();
+    void randomAgainstLegacy();
+};
+
+void TestWaterDistribution::singleContainer()
+{
+    std::map<int, double> inMap { { 0, 3E7 }, { 1, 5E6 }, { 2, 1E5 } };
+    WaterDistributionPriv water;
+    auto res = water.initDistribution(inMap, 1, 0.1);
+    QString strError;
+    QVERIFY2(checkResult(inMap, res, 1, strError), qPrintable(strError));
+    QCOMPARE(segementCount(res), 3);
+}
+
+void TestWaterDistribution::splitsLargePart()
+{
+    // 单个大零件平均分到两个容器
+    std::map<int, double> inMap { { 0, 1E8 } };
+    WaterDistributionPriv water;
+    auto res = water.initDistribution(inMap, 2, 0.1);
+    QString strError;
+    QVERIFY2(checkResult(inMap, res, 2, strError), qPrintable(strError));
+    QVERIFY(std::fabs(res[0]._totalWeight - 5E7) < 1.0);
+    QVERIFY(std::fabs(res[1]._totalWeight - 5E7) < 1.0);
+}
+
+void TestWaterDistribution::randomAgainstLegacy()
+{
+    const double fTolerance = 0.1;
+    std::mt19937 rng(20261019);
+    std::uniform_int_distribution<int> containerDist(1, 8);
+
+    int nWorseCnt = 0;
+    for (int iCase = 0; iCase < 2000; ++ iCase)
+    {
+        const int nContainerCnt = containerDist(rng);
+        const auto inMap = makeInstance(rng, nContainerCnt);
+        const double fAverage = totalWeight(inMap) / nContainerCnt;
+
+        WaterDistributionPriv water;
+        const auto res = water.initDistribution(inMap, nContainerCnt, fTolerance);
+        LegacyWaterDistribution legacy;
+        const auto legacyRes = legacy.initDistribution(inMap, nContainerCnt);
+
+        QString strError;
+        QVERIFY2(checkResult(inMap, res, nContainerCnt, strError),
+                 qPrintable(QString("case %1: %2").arg(iCase).arg(strError)));
+        QVERIFY2(checkResult(inMap, legacyRes, nContainerCnt, strError),
+                 qPrintable(QString("legacy case %1: %2").arg(iCase).arg(strError)));
+
+        // 分段数上界
+        QVERIFY2(segementCount(res) <= int(inMap.size()) + nContainerCnt - 1,
+                 qPrintable(QString("case %1: %2 segements").arg(iCase).arg(segementCount(res))));
+
+        // 最大负载不劣于原算法超出允许偏差
+        const double fMaxLoad = maxLoad(res), fLegacyMaxLoad = maxLoad(legacyRes);
+        QVERIFY2(fMaxLoad <= std::max(fLegacyMaxLoad, fAverage * (1.0 + fTolerance)) + 1E-6 * fAverage,
+                 qPrintable(QString("case %1: max load %2 legacy %3 average %4")
+                            .arg(iCase).arg(fMaxLoad).arg(fLegacyMaxLoad).arg(fAverage)));
+        if (fMaxLoad > fLegacyMaxLoad * (1.0 + 1E-9)) ++ nWorseCnt;
+    }
+    qDebug() << "cases with higher max load than legacy (within tolerance):" << nWorseCnt;
+}
+
+QTEST_APPLESS_MAIN(TestWaterDistribution)
+
+#include "tst_waterdistribution.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_waterdistribution
+SOURCES += tst_waterdistribution.cpp
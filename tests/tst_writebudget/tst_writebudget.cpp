@@ -0,0 +1,286 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <random>
+#include <thread>
+
+#include "writeuff.h"
+#include "publicheader.h"
+#include "scanvectorbuffer.h"
+
+namespace {
+enum SpillMode {
+    SPILL_NONE = 0,         // 不设置预算, 全部由写入线程编码
+    SPILL_BUDGET,           // 极小预算, 每次入队都提前编码
+    SPILL_INTERLEAVED,      // 每隔若干块手动提前编码, 临时文件与队列中均有数据
+    SPILL_CONCURRENT        // 写入线程运行时入队, 受预算限制
+};
+
+const int ScannerCnt = 2;
+const int BeamCnt = 2;
+
+struct QueueBlock {
+    int nScanner = 0;
+    int nBeam = 0;
+    UFFWRITEDATA mUFileData;
+};
+
+///
+/// @brief 随机生成数据块, 依次分配到各扫描器、光束的队列
+///
+QVector<QueueBlock> makeBlocks(const int &nBlockCnt, const int &nSeed)
+{
+    std::mt19937 rng(nSeed);
+    std::uniform_int_distribution<int> lineDist(1, 400);
+    std::uniform_int_distribution<int> coorDist(-2000000, 2000000);
+    std::uniform_int_distribution<int> stepDist(-5000, 5000);
+
+    QVector<QueueBlock> blocks;
+    for(int iBlock = 0; iBlock < nBlockCnt; ++ iBlock)
+    {
+        QueueBlock block;
+        block.nScanner = iBlock % ScannerCnt;
+        block.nBeam = (iBlock / ScannerCnt) % BeamCnt;
+        auto &mUFileData = block.mUFileData;
+        mUFileData.nMode_Section = qint8(SECTION_POLYGON + 2 * (iBlock % 3));
+        mUFileData.nMode_Coor = qint8(mUFileData.nMode_Section + 1);
+        mUFileData.nPartIndex = iBlock;
+        mUFileData.nLaserPower = 100 + iBlock % 50;
+        mUFileData.nMarkSpeed = 1000 + iBlock;
+
+        SCANLINE line;
+        line.nX = coorDist(rng);
+        line.nY = coorDist(rng);
+        const int nLineCnt = lineDist(rng);
+        for(int iLine = 0; iLine < nLineCnt; ++ iLine)
+        {
+            line.nLineType = (iLine & 0x1) ? SECTION_SCANTYPE_MARK : SECTION_SCANTYPE_JUMP;
+            line.nX += stepDist(rng);
+            line.nY += stepDist(rng);
+            mUFileData.listSLines << line;
+        }
+        blocks << block;
+    }
+    return blocks;
+}
+
+///
+/// @brief 创建 2 扫描器 x 2 光束的写入缓冲区
+///
+bool initWriteBuff(PARAWRITEBUFF &writeBuff, const QString &strFile, const int &nScanEncoding, const qint64 &nBudgetBytes,
+                   const int &spillFormat = PARAWRITEBUFF::SPILL_USPBLOCK)
+{
+    writeBuff._writerBufferParas = QSharedPointer<WriterBufferParas>(new WriterBufferParas);
+    writeBuff._writerBufferParas->_extendedParaPtr->addVariantMap(QVariantMap { { "Global/nScanEncoding", nScanEncoding } });
+    writeBuff._writerBufferParas->_bpcParaPtr->nNumber_SplicingScanner = ScannerCnt;
+    writeBuff._writerBufferParas->_bpcParaPtr->nScannerNumber = ScannerCnt;
+    writeBuff._writerBufferParas->_bppParaPtr->sGeneralPara.nNumber_Beam = BeamCnt;
+    writeBuff.gFile.setFileName(strFile);
+    writeBuff.setWriteBudget(nBudgetBytes, spillFormat);
+    return writeBuff.createUFileData();
+}
+
+///
+/// @brief 按指定方式入队并由 WriteUFF 写出, 返回输出文件内容
+///
+QByteArray writeBlocks(const QVector<QueueBlock> &blocks, const QString &strFile, const int &nScanEncoding,
+                       const SpillMode &mode, WRITEBUDGETSTATS &stats, qint32 &nBlockCnt)
+{
+    PARAWRITEBUFF writeBuff;
+    qint64 nBudgetBytes = 0;
+    if(SPILL_BUDGET == mode) nBudgetBytes = 1;
+    else if(SPILL_CONCURRENT == mode) nBudgetBytes = 64 << 10;
+    if(false == initWriteBuff(writeBuff, strFile, nScanEncoding, nBudgetBytes)) return QByteArray();
+
+    WriteUFF writer;
+    writer.setParaWriteBuff(&writeBuff);
+    writer.setUFFStatus(UFFWRITE_BEGIN);
+    if(SPILL_CONCURRENT == mode) writer.start();
+
+    for(int iBlock = 0; iBlock < blocks.size(); ++ iBlock)
+    {
+        UFFWRITEDATA mUFileData = blocks[iBlock].mUFileData;
+        writeBuff.appendFileData(mUFileData, blocks[iBlock].nScanner, blocks[iBlock].nBeam);
+        if(SPILL_INTERLEAVED == mode && 0 == iBlock % 7)
+        {
+            UFILEDATA *lpFileData = writeBuff.gUFileData[blocks[iBlock].nScanner][blocks[iBlock].nBeam].data();
+            QMutexLocker locker(lpFileData->gQueue.locker());
+            writeBuff.spillFileData(lpFileData);
+        }
+    }
+
+    writer.setUFFStatus(UFFWRITE_END);
+    if(false == writer.isRunning()) writer.start();
+    writer.wait();
+
+    stats = writeBuff.budgetStats();
+    nBlockCnt = writer.blockCount();
+    writeBuff.gFile.flush();
+    writeBuff.gFile.seek(0);
+    return writeBuff.gFile.readAll();
+}
+
+///
+/// @brief 读回队列中提前写出的原始扫描线及仍在队列中的数据块, 按入队顺序返回
+///
+QVector<UFFWRITEDATA> takeSpilledBlocks(PARAWRITEBUFF &writeBuff, UFILEDATA *lpFileData)
+{
+    QVector<UFFWRITEDATA> result;
+    QMutexLocker locker(lpFileData->gQueue.locker());
+    if(lpFileData->gSpillFile)
+    {
+        lpFileData->gSpillFile->seek(0);
+        UFFWRITEDATA mUFileData;
+        while(PARAWRITEBUFF::readSpilledScanLines(lpFileData->gSpillFile.data(), mUFileData)) result << mUFileData;
+        if(false == lpFileData->gSpillFile->atEnd()) return QVector<UFFWRITEDATA>();
+    }
+    UFFWRITEDATA mUFileData;
+    while(lpFileData->gQueue.take(mUFileData))
+    {
+        writeBuff.releasePendingBytes(lpFileData, mUFileData);
+        if(mUFileData.vectorBuffer) mUFileData.vectorBuffer->toScanLines(mUFileData.listSLines);
+        result << mUFileData;
+    }
+    return result;
+}
+
+///
+/// @brief 比较数据块的模式及扫描线, 返回首个不一致处的描述, 一致时返回空串
+///
+QString compareBlocks(const QVector<UFFWRITEDATA> &actual, const QVector<QueueBlock> &expected)
+{
+    if(actual.size() != expected.size()) return QString("block count %1 != %2").arg(actual.size()).arg(expected.size());
+    for(int iBlock = 0; iBlock < actual.size(); ++ iBlock)
+    {
+        const auto &lhs = actual[iBlock];
+        QVector<SCANLINE> rhsLines = expected[iBlock].mUFileData.listSLines;
+        if(expected[iBlock].mUFileData.vectorBuffer) expected[iBlock].mUFileData.vectorBuffer->toScanLines(rhsLines);
+        if(lhs.nMode_Section != expected[iBlock].mUFileData.nMode_Section) return QString("block %1: section").arg(iBlock);
+        if(lhs.listSLines.size() != rhsLines.size()) return QString("block %1: line count").arg(iBlock);
+        for(int iLine = 0; iLine < rhsLines.size(); ++ iLine)
+        {
+            const auto &lhsLine = lhs.listSLines[iLine], &rhsLine = rhsLines[iLine];
+            if(lhsLine.nLineType != rhsLine.nLineType || lhsLine.nX != rhsLine.nX || lhsLine.nY != rhsLine.nY)
+            {
+                return QString("block %1: line %2").arg(iBlock).arg(iLine);
+            }
+        }
+    }
+    return QString();
+}
+}
+
+class TestWriteBudget : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void spillMatchesUnspilled_data();
+    void spillMatchesUnspilled();
+    void spilledScanLinesRoundTrip();
+};
+
+void TestWriteBudget::spillMatchesUnspilled_data()
+{
+    QTest::addColumn<int>("nScanEncoding");
+    QTest::addColumn<int>("nMode");
+
+    QTest::newRow("raw, budget") << int(SCANENCODING_RAW) << int(SPILL_BUDGET);
+    QTest::newRow("raw, interleaved") << int(SCANENCODING_RAW) << int(SPILL_INTERLEAVED);
+    QTest::newRow("raw, concurrent") << int(SCANENCODING_RAW) << int(SPILL_CONCURRENT);
+    QTest::newRow("delta, budget") << int(SCANENCODING_DELTA_V1) << int(SPILL_BUDGET);
+    QTest::newRow("delta, interleaved") << int(SCANENCODING_DELTA_V1) << int(SPILL_INTERLEAVED);
+    QTest::newRow("delta, concurrent") << int(SCANENCODING_DELTA_V1) << int(SPILL_CONCURRENT);
+}
+
+void TestWriteBudget::spillMatchesUnspilled()
+{
+    QFETCH(int, nScanEncoding);
+    QFETCH(int, nMode);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const auto blocks = makeBlocks(400, 48);
+
+    WRITEBUDGETSTATS refStats, stats;
+    qint32 nRefBlockCnt = 0, nBlockCnt = 0;
+    const QByteArray refData = writeBlocks(blocks, dir.filePath("ref.usp"), nScanEncoding, SPILL_NONE,
+                                           refStats, nRefBlockCnt);
+    const QByteArray data = writeBlocks(blocks, dir.filePath("spill.usp"), nScanEncoding, SpillMode(nMode),
+                                        stats, nBlockCnt);
+
+    QVERIFY(refData.size() > 0);
+    QCOMPARE(refStats.nSpillCnt, qint64(0));
+    QCOMPARE(nRefBlockCnt, qint32(blocks.size()));
+    if(SPILL_CONCURRENT != nMode) QVERIFY(stats.nSpillCnt > 0);
+    QCOMPARE(nBlockCnt, nRefBlockCnt);
+    QCOMPARE(data.size(), refData.size());
+    QVERIFY(data == refData);
+
+    // 临时文件随写入完成释放
+    QCOMPARE(QDir(dir.path()).entryList(QStringList() << "*.spill", QDir::Files).size(), 0);
+}
+
+void TestWriteBudget::spilledScanLinesRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    // 作业文件格式: 原始扫描线不过滤重合点及其它类型线段, 扫描线缓冲区按 SCANLINE 写出
+    auto blocks = makeBlocks(400, 49);
+    for(int iBlock = 0; iBlock < blocks.size(); iBlock += 5)
+    {
+        auto &listSLines = blocks[iBlock].mUFileData.listSLines;
+        SCANLINE line = listSLines.last();
+        listSLines << line;
+        line.nLineType = SECTION_SCANTYPE_FINISHED;
+        listSLines << line;
+    }
+    for(int iBlock = 1; iBlock < blocks.size(); iBlock += 5)
+    {
+        auto &mUFileData = blocks[iBlock].mUFileData;
+        mUFileData.vectorBuffer = QSharedPointer<ScanVectorBuffer>::create();
+        mUFileData.vectorBuffer->append(ScanVectorView::fromScanLines(mUFileData.listSLines));
+        mUFileData.listSLines.clear();
+    }
+
+    // 极小预算, 各队列由独立生产者并发入队; 同一时刻只有一个生产者提前写出, 其余数据留在队列
+    PARAWRITEBUFF writeBuff;
+    QVERIFY(initWriteBuff(writeBuff, dir.filePath("spill.bin"), SCANENCODING_RAW, 1, PARAWRITEBUFF::SPILL_SCANLINES));
+    std::vector<std::thread> producers;
+    for(int iQueue = 0; iQueue < ScannerCnt * BeamCnt; ++ iQueue)
+    {
+        producers.emplace_back([&writeBuff, &blocks, iQueue]() {
+            for(const auto &block : blocks)
+            {
+                if(block.nScanner * BeamCnt + block.nBeam != iQueue) continue;
+                UFFWRITEDATA mUFileData = block.mUFileData;
+                writeBuff.appendFileData(mUFileData, block.nScanner, block.nBeam);
+            }
+        });
+    }
+    for(auto &producer : producers) producer.join();
+
+    const WRITEBUDGETSTATS stats = writeBuff.budgetStats();
+    QVERIFY(stats.nSpillCnt > 0);
+    QCOMPARE(stats.nWaitCnt, qint64(0));
+    for(int iScanner = 0; iScanner < ScannerCnt; ++ iScanner)
+    {
+        for(int iBeam = 0; iBeam < BeamCnt; ++ iBeam)
+        {
+            QVector<QueueBlock> expected;
+            for(const auto &block : blocks)
+            {
+                if(iScanner == block.nScanner && iBeam == block.nBeam) expected << block;
+            }
+            UFILEDATA *lpFileData = writeBuff.gUFileData[iScanner][iBeam].data();
+            const QString strDiff = compareBlocks(takeSpilledBlocks(writeBuff, lpFileData), expected);
+            QVERIFY2(strDiff.isEmpty(), qPrintable(QString("queue %1/%2 %3").arg(iScanner).arg(iBeam).arg(strDiff)));
+            QCOMPARE(lpFileData->nPendingBytes.load(), qint64(0));
+        }
+    }
+    QCOMPARE(writeBuff._nPendingBytes.load(), qint64(0));
+}
+
+QTEST_APPLESS_MAIN(TestWriteBudget)
+
+#include "tst_writebudget.moc"
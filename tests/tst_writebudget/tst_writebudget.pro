@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_writebudget
+SOURCES += tst_writebudget.cpp
@@ -0,0 +1,202 @@
+#include <QtTest>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QQueue>
+#include <atomic>
+
+#include "writequeue.h"
+
+namespace {
+///
+/// @brief 改为无锁环形队列前的加锁队列, 作为对照
+///
+template<class T>
+class MutexQueue
+{
+public:
+    explicit MutexQueue(const int & = 0) {}
+
+    inline QMutex *locker() { return &_locker; }
+
+    void push(T value) {
+        QMutexLocker locker(&_locker);
+        _queue.enqueue(std::move(value));
+    }
+    bool take(T &value) {
+        if (_queue.isEmpty()) return false;
+        value = _queue.dequeue();
+        return true;
+    }
+
+private:
+    QMutex _locker;
+    QQueue<T> _queue;
+};
+
+///
+/// @brief 生产者第 nSeq 项数据: 生产者序号(8) 项序号(32) 及长度随序号变化的填充字节
+///
+QByteArray makeItem(const int &nProducer, const int &nSeq)
+{
+    QByteArray item;
+    item.append(char(nProducer));
+    item.append(reinterpret_cast<const char *>(&nSeq), 4);
+    item.append(QByteArray(nSeq % 13, char('a' + (nProducer + nSeq) % 26)));
+    return item;
+}
+
+///
+/// @brief 多个生产者同时写入, 消费者持有 locker() 边写边取, 返回各生产者取出的字节流
+///
+template<class Queue>
+QVector<QByteArray> runProducers(Queue &queue, const int &nProducerCnt, const int &nItemCnt)
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(nProducerCnt);
+    std::atomic<int> nDoneCnt {0};
+    QVector<QFuture<void>> futures;
+    for (int iProducer = 0; iProducer < nProducerCnt; ++ iProducer)
+    {
+        futures << QtConcurrent::run(&pool, [&queue, &nDoneCnt, iProducer, nItemCnt]() {
+            for (int iSeq = 0; iSeq < nItemCnt; ++ iSeq) queue.push(makeItem(iProducer, iSeq));
+            ++ nDoneCnt;
+        });
+    }
+
+    QVector<QByteArray> streams(nProducerCnt);
+    qint64 nTotalCnt = qint64(nProducerCnt) * nItemCnt;
+    while (nTotalCnt > 0)
+    {
+        const bool bDone = nDoneCnt.load() == nProducerCnt;
+        QByteArray item;
+        bool bTaken = false;
+        {
+            QMutexLocker locker(queue.locker());
+            bTaken = queue.take(item);
+        }
+        if (bTaken)
+        {
+            streams[quint8(item.at(0))].append(item);
+            -- nTotalCnt;
+        }
+        else if (bDone) break;
+    }
+    for (auto &future : futures) future.waitForFinished();
+    return streams;
+}
+}
+
+class TestWriteQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void keepsOrderAfterOverflow();
+    void stressMatchesMutexQueue_data();
+    void stressMatchesMutexQueue();
+    void benchmarkProducers_data();
+    void benchmarkProducers();
+};
+
+void TestWriteQueue::keepsOrderAfterOverflow()
+{
+    // 环形队列容量 4, 第 5 项起进入溢出列表; 取空溢出列表后恢复环形队列写入
+    WriteQueue<int> queue(4);
+    auto takeValue = [&queue](int &value) {
+        QMutexLocker locker(queue.locker());
+        return queue.take(value);
+    };
+
+    for (int i = 0; i < 10; ++ i) queue.push(i);
+    int value = -1;
+    for (int i = 0; i < 6; ++ i)
+    {
+        QVERIFY(takeValue(value));
+        QCOMPARE(value, i);
+    }
+    for (int i = 10; i < 14; ++ i) queue.push(i);
+    for (int i = 6; i < 14; ++ i)
+    {
+        QVERIFY(takeValue(value));
+        QCOMPARE(value, i);
+    }
+    QVERIFY(false == takeValue(value));
+
+    queue.push(14);
+    QVERIFY(takeValue(value));
+    QCOMPARE(value, 14);
+}
+
+void TestWriteQueue::stressMatchesMutexQueue_data()
+{
+    QTest::addColumn<int>("nProducerCnt");
+    QTest::addColumn<int>("nCapacity");
+    QTest::addColumn<int>("nItemCnt");
+
+    QTest::newRow("2 producers, capacity 2") << 2 << 2 << 50000;
+    QTest::newRow("8 producers, capacity 4") << 8 << 4 << 20000;
+    QTest::newRow("16 producers, capacity 64") << 16 << 64 << 10000;
+    QTest::newRow("64 producers, capacity 8") << 64 << 8 << 2000;
+}
+
+void TestWriteQueue::stressMatchesMutexQueue()
+{
+    QFETCH(int, nProducerCnt);
+    QFETCH(int, nCapacity);
+    QFETCH(int, nItemCnt);
+
+    MutexQueue<QByteArray> mutexQueue;
+    const auto refStreams = runProducers(mutexQueue, nProducerCnt, nItemCnt);
+
+    // 小容量使环形队列频繁溢出, 多轮运行覆盖领取未发布时的溢出切换
+    for (int iRound = 0; iRound < 5; ++ iRound)
+    {
+        WriteQueue<QByteArray> queue(nCapacity);
+        const auto streams = runProducers(queue, nProducerCnt, nItemCnt);
+        for (int iProducer = 0; iProducer < nProducerCnt; ++ iProducer)
+        {
+            QVERIFY2(streams[iProducer] == refStreams[iProducer],
+                     qPrintable(QString("round %1 producer %2: %3 bytes, expected %4").arg(iRound).arg(iProducer)
+                                .arg(streams[iProducer].size()).arg(refStreams[iProducer].size())));
+        }
+        QMutexLocker locker(queue.locker());
+        QVERIFY(queue.isEmpty());
+    }
+}
+
+void TestWriteQueue::benchmarkProducers_data()
+{
+    QTest::addColumn<bool>("bMutex");
+    QTest::addColumn<int>("nProducerCnt");
+
+    for (int nProducerCnt = 1; nProducerCnt <= 64; nProducerCnt <<= 1)
+    {
+        QTest::newRow(qPrintable(QString("ring, %1 producers").arg(nProducerCnt))) << false << nProducerCnt;
+        QTest::newRow(qPrintable(QString("mutex, %1 producers").arg(nProducerCnt))) << true << nProducerCnt;
+    }
+}
+
+void TestWriteQueue::benchmarkProducers()
+{
+    QFETCH(bool, bMutex);
+    QFETCH(int, nProducerCnt);
+
+    // 总写入量固定, 比较生产者数增加时的吞吐
+    const int nItemCnt = 256000 / nProducerCnt;
+    QBENCHMARK {
+        if (bMutex)
+        {
+            MutexQueue<QByteArray> queue;
+            runProducers(queue, nProducerCnt, nItemCnt);
+        }
+        else
+        {
+            WriteQueue<QByteArray> queue;
+            runProducers(queue, nProducerCnt, nItemCnt);
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(TestWriteQueue)
+
+#include "tst_writequeue.moc"
@@ -0,0 +1,4 @@
+include(../tests.pri)
+
+TARGET = tst_writequeue
+SOURCES += tst_writequeue.cpp
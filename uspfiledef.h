@@ -5,7 +5,10 @@
 #include <QVector>
 #include <QMutex>
 #include <QFile>
+#include <QTemporaryFile>
 #include <QSharedPointer>
+#include "scanvectorbuffer.h"
+#include "writequeue.h"
 
 enum {
     UFFWRITE_BEGIN = 0,
@@ -49,9 +52,55 @@ typedef enum __FILE_SECTIONID {
     SECTION_SCANTYPE_JUMP   = 0x60,
     SECTION_SCANTYPE_MARK,
     SECTION_SCANTYPE_MARKLOOP,
-    SECTION_SCANTYPE_FINISHED
+    SECTION_SCANTYPE_FINISHED,
+    SECTION_SCANTYPE_DELTA          // 差分编码块: 版本(8) 线段数(32) 字节数(32) 数据
 }FILE_SECTIONID;
 
+///
+/// @brief 扫描线差分编码版本
+/// @details 0 为原始格式, 每条扫描线写入 类型(8) X(32) Y(32);
+///   1 为 SECTION_SCANTYPE_DELTA 块, 坐标相对上一点的差值经 zig-zag 变换后以 varint 存储,
+///   X 差值左移一位, 最低位为标记线标志
+///
+enum {
+    SCANENCODING_RAW = 0,
+    SCANENCODING_DELTA_V1
+};
+
+///
+/// @brief 空层包围盒
+/// @details 层内没有扫描数据时写入的边界值, 最小值大于最大值; 平移拷贝时保持不变
+///
+#define USPEMPTYBOUND_MIN       qint32(0x7FFFFFFF)
+#define USPEMPTYBOUND_MAX       qint32(-0x7FFFFFFF - 1)
+
+///
+/// @brief USP 层索引表
+/// @details 开启后写在 "FileEnding" 之后, 旧版读取在 SECTION_FILEEND 处结束, 不受影响.
+///   布局: USPLayerEntry × nLayerCnt, 之后为定长文件尾 USPLayerFooter;
+///   偏移均相对扫描数据起点(即 XML 信息之后), 数据起点 = 文件大小 - 文件尾 - 索引表 - nTableOffset
+///
+#define USPLAYERTABLE_MAGIC     0x544C5355  // "USLT"
+#define USPLAYERTABLE_VERSION   1
+#define USPLAYERENTRY_SIZE      36
+#define USPLAYERFOOTER_SIZE     20
+
+struct USPLayerEntry {
+    qint32 nLayer = 0;
+    qint64 nOffset = 0;         // 层起始(SECTION_LAYER)偏移
+    qint64 nLength = 0;         // 至 SECTION_LAYEREND(含)的字节数
+    qint32 nBlockCnt = 0;       // 扫描块数
+    qint64 nVectorCnt = 0;      // 写入前的扫描线数
+    quint32 nChecksum = 0;      // 层数据 CRC32
+};
+
+struct USPLayerFooter {
+    qint64 nTableOffset = 0;
+    qint32 nLayerCnt = 0;
+    quint32 nVersion = USPLAYERTABLE_VERSION;
+    quint32 nMagic = USPLAYERTABLE_MAGIC;
+};
+
 struct SCANLINE {
     qint8 nLineType;
     int nX;
@@ -67,18 +116,30 @@ struct UFFWRITEDATA {
     int nLaserPower;
     int nMarkSpeed;
     QVector<SCANLINE> listSLines;
+    QSharedPointer<ScanVectorBuffer> vectorBuffer;  // 非空时扫描线以连续数组存放, listSLines 为空; 仅晶格填充使用
     UFFWRITEDATA() {
         nMode_Section = -1;
     }
+    inline int lineCount() const {
+        return vectorBuffer ? vectorBuffer->size() : listSLines.size();
+    }
+    inline ScanVectorView lineView() const {
+        return vectorBuffer ? vectorBuffer->view() : ScanVectorView::fromScanLines(listSLines);
+    }
 };
 
 typedef QSharedPointer<UFFWRITEDATA> UFFWDATAPTR;
 //typedef QVector<UFFWDATAPTR> LISTUFFWDATAPTR;
 
 struct UFILEDATA {
-    QMutex gLocker_UFD;
-    QVector<UFFWRITEDATA> gListUFileData;
-    UFILEDATA() {/*gListUFileData.clear();*/}
+    WriteQueue<UFFWRITEDATA> gQueue;            // 生产者无锁写入, 消费端持有 gQueue.locker()
+    std::atomic<qint64> nPendingBytes {0};      // 队列中数据估算内存
+    // 以下受 gQueue.locker() 保护
+    QSharedPointer<QTemporaryFile> gSpillFile;  // 超出写入预算时已编码的数据块, 写入线程到达本队列时整体拷贝
+    qint32 nSpillBlockCnt = 0;
+    qint64 nSpillVectorCnt = 0;
+    bool bDraining = false;                     // 写入线程正在消费本队列
+    explicit UFILEDATA(const int &capacity = WriteQueue<UFFWRITEDATA>::DefaultCapacity) : gQueue(capacity) {}
 };
 
 #include <QDebug>
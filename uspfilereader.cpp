@@ -0,0 +1,343 @@
+#include "uspfilereader.h"
+#include "publicheader.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+#define USPHEADER_SEARCHSIZE    (1024 * 1024)
+
+namespace {
+template<typename T>
+inline T readValue(const char *data)
+{
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+///
+/// @brief 解码为 USPLayerData
+///
+class LayerDecoder : public USPSectionVisitor
+{
+public:
+    explicit LayerDecoder(USPLayerData &layerData) : _layerData(layerData) {}
+
+    void property(const quint8 &id, const qint32 &value) override {
+        switch(id)
+        {
+        case SECTION_LAYER: _layerData.nLayer = value; break;
+        case SECTION_MINX: _layerData.nMinX = value; break;
+        case SECTION_MAXX: _layerData.nMaxX = value; break;
+        case SECTION_MINY: _layerData.nMinY = value; break;
+        case SECTION_MAXY: _layerData.nMaxY = value; break;
+        case SECTION_LAYERAREAS: _layerData.nArea = value; break;
+        case SECTION_PARTINDEX: _nPartIndex = value; break;
+        case SECTION_CURRENTBEAMINDEX: _nBeamIndex = value; break;
+        case SECTION_CURRENTSCANNERINDEX: _nScannerIndex = value; break;
+        case SECTION_LASERPOWER: if(_layerData.blockVec.size()) _layerData.blockVec.last().nLaserPower = value; break;
+        case SECTION_MARKSPEED: if(_layerData.blockVec.size()) _layerData.blockVec.last().nMarkSpeed = value; break;
+        default: break;
+        }
+    }
+    void block(const quint8 &section, const quint8 &coor) override {
+        USPScanBlock block;
+        block.nScannerIndex = _nScannerIndex;
+        block.nBeamIndex = _nBeamIndex;
+        block.nPartIndex = _nPartIndex;
+        block.nModeSection = qint8(section);
+        block.nModeCoor = qint8(coor);
+        _layerData.blockVec << block;
+    }
+    void lines(const qint8 &type, const char *data, const qint32 &cnt) override {
+        auto &listSLines = _layerData.blockVec.last().listSLines;
+        listSLines.reserve(listSLines.size() + cnt);
+        for(qint32 i = 0; i < cnt; ++ i)
+        {
+            SCANLINE line;
+            line.nLineType = type;
+            line.nX = readValue<qint32>(data + i * 8);
+            line.nY = readValue<qint32>(data + i * 8 + 4);
+            listSLines << line;
+        }
+    }
+
+private:
+    USPLayerData &_layerData;
+    qint32 _nScannerIndex = 0;
+    qint32 _nBeamIndex = 0;
+    qint32 _nPartIndex = 0;
+};
+}
+
+USPFileReader::~USPFileReader()
+{
+    close();
+}
+
+///
+/// @brief 打开 USP 文件
+/// @param fileName [in] 文件路径
+/// @return 文件可读时返回 true
+/// @details 实现步骤:
+///   1. 映射整个文件, 失败时保持 QFile 读取方式
+///   2. 加载文件末尾的层索引表, 由索引表位置反推扫描数据起点
+///   3. 无索引表时按 XML 信息结束位置确定扫描数据起点(仅映射时)
+///
+bool USPFileReader::open(const QString &fileName)
+{
+    close();
+    _file.setFileName(fileName);
+    if(false == _file.open(QIODevice::ReadOnly)) return false;
+
+    _fileSize = _file.size();
+    if(_fileSize > 0) _mapData = _file.map(0, _fileSize);
+
+    _hasLayerTable = loadLayerTable();
+    if(false == _hasLayerTable && _mapData)
+    {
+        _dataOffset = findDataOffset(mapData(), _fileSize);
+    }
+    return true;
+}
+
+void USPFileReader::close()
+{
+    if(_mapData) _file.unmap(_mapData);
+    if(_file.isOpen()) _file.close();
+    _mapData = nullptr;
+    _fileSize = 0;
+    _dataOffset = 0;
+    _hasLayerTable = false;
+    _layerTable.clear();
+}
+
+///
+/// @brief 二分查找层索引
+/// @return 不存在时返回 nullptr
+///
+const USPLayerEntry *USPFileReader::findLayer(const int &layer) const
+{
+    auto it = std::lower_bound(_layerTable.cbegin(), _layerTable.cend(), layer,
+                               [](const USPLayerEntry &entry, const int &value) { return entry.nLayer < value; });
+    if(it == _layerTable.cend() || it->nLayer != layer) return nullptr;
+    return &(*it);
+}
+
+///
+/// @brief 获取单层数据在映射内存中的位置
+/// @param layer [in] 层号
+/// @param size [out] 字节数
+/// @return 未映射或层不存在时返回 nullptr
+///
+const char *USPFileReader::layerData(const int &layer, qint64 &size) const
+{
+    auto entry = findLayer(layer);
+    if(nullptr == _mapData || nullptr == entry) return nullptr;
+    if(_dataOffset + entry->nOffset + entry->nLength > _fileSize) return nullptr;
+
+    size = entry->nLength;
+    return mapData() + _dataOffset + entry->nOffset;
+}
+
+///
+/// @brief 读取单层原始数据
+/// @param layer [in] 层号
+/// @param data [out] 自 SECTION_LAYER 至 SECTION_LAYEREND 的字节
+/// @param verify [in] 是否校验 CRC32
+///
+bool USPFileReader::readLayer(const int &layer, QByteArray &data, const bool &verify)
+{
+    auto entry = findLayer(layer);
+    if(nullptr == entry) return false;
+
+    qint64 size = 0;
+    if(auto mapped = layerData(layer, size))
+    {
+        data = QByteArray::fromRawData(mapped, int(size));
+    }
+    else
+    {
+        if(false == _file.seek(_dataOffset + entry->nOffset)) return false;
+        data = _file.read(entry->nLength);
+    }
+    if(data.size() != entry->nLength) return false;
+    return (false == verify) || (calcChecksum(data.constData(), data.size()) == entry->nChecksum);
+}
+
+bool USPFileReader::decodeLayer(const int &layer, USPLayerData &layerData, const bool &verify)
+{
+    QByteArray data;
+    if(false == readLayer(layer, data, verify)) return false;
+    return decodeLayerData(data.constData(), data.size(), layerData);
+}
+
+///
+/// @brief 遍历单层数据
+/// @param data [in] 层数据, 以 SECTION_LAYER 开始
+/// @param size [in] 可读字节数
+/// @param visitor [in] 回调, 为 nullptr 时只做结构检查
+/// @return 至 SECTION_LAYEREND(含)消耗的字节数, 结构错误时返回 -1
+/// @details 按写入顺序解析: 属性段为 标识(8)+值(32); 扫描块以 区段类型(8)+坐标类型(8) 开始,
+///   其后的功率、速度属性及扫描线归入该块
+///
+qint64 USPFileReader::walkLayerData(const char *data, const qint64 &size, USPSectionVisitor *visitor)
+{
+    if(size < 1 || SECTION_LAYER != quint8(data[0])) return -1;
+
+    const char *cur = data;
+    const char *end = data + size;
+    bool bHasBlock = false;
+    QVector<SCANLINE> deltaLines;
+
+    while(cur < end)
+    {
+        const quint8 id = quint8(*cur ++);
+        if(SECTION_LAYEREND == id) return cur - data;
+
+        if(isPropertySection(id))
+        {
+            if(end - cur < 4) return -1;
+            if(visitor) visitor->property(id, readValue<qint32>(cur));
+            cur += 4;
+        }
+        else if(isBlockSection(id))
+        {
+            if(end - cur < 1) return -1;
+            if(visitor) visitor->block(id, quint8(*cur));
+            bHasBlock = true;
+            ++ cur;
+        }
+        else if(false == bHasBlock)
+        {
+            return -1;
+        }
+        else if(SECTION_SCANTYPE_JUMP == id || SECTION_SCANTYPE_MARK == id)
+        {
+            if(end - cur < 8) return -1;
+            if(visitor) visitor->lines(qint8(id), cur, 1);
+            cur += 8;
+        }
+        else if(SECTION_SCANTYPE_MARKLOOP == id)
+        {
+            if(end - cur < 4) return -1;
+            const qint32 nMarkCnt = readValue<qint32>(cur);
+            cur += 4;
+            if(nMarkCnt < 0 || end - cur < qint64(nMarkCnt) * 8) return -1;
+            if(visitor) visitor->lines(SECTION_SCANTYPE_MARK, cur, nMarkCnt);
+            cur += qint64(nMarkCnt) * 8;
+        }
+        else if(SECTION_SCANTYPE_DELTA == id)
+        {
+            deltaLines.clear();
+            const qint64 nReadSz = readScanLinesDelta(cur, end - cur, deltaLines);
+            if(nReadSz < 0) return -1;
+            if(visitor)
+            {
+                for(const auto &line : qAsConst(deltaLines))
+                {
+                    qint32 coor[2] = { line.nX, line.nY };
+                    visitor->lines(line.nLineType, reinterpret_cast<const char *>(coor), 1);
+                }
+            }
+            cur += nReadSz;
+        }
+        else return -1;
+    }
+    return -1;
+}
+
+///
+/// @brief 解码单层数据
+/// @return 数据恰好为完整的一层时返回 true
+///
+bool USPFileReader::decodeLayerData(const char *data, const qint64 &size, USPLayerData &layerData)
+{
+    layerData = USPLayerData();
+    LayerDecoder decoder(layerData);
+    return walkLayerData(data, size, &decoder) == size;
+}
+
+///
+/// @brief 查找扫描数据起点
+/// @details .usp 在扫描数据前写有 XML 信息, 以 </FileInfo> 结束, 其后可能有一个换行;
+///   未找到时视为无信息头的临时文件, 返回0
+///
+qint64 USPFileReader::findDataOffset(const char *data, const qint64 &size)
+{
+    static const QByteArray endTag("</FileInfo>");
+    const QByteArray header = QByteArray::fromRawData(data, int(qMin<qint64>(size, USPHEADER_SEARCHSIZE)));
+    const int pos = header.indexOf(endTag);
+    if(pos < 0) return 0;
+
+    qint64 offset = pos + endTag.size();
+    if(offset < size && '\n' == data[offset]) ++ offset;
+    return offset;
+}
+
+quint32 USPFileReader::calcChecksum(const char *data, const qint64 &size)
+{
+    uLong crc = crc32(0L, Z_NULL, 0);
+    qint64 offset = 0;
+    while(offset < size)
+    {
+        const uInt len = uInt(qMin<qint64>(size - offset, 0x40000000));
+        crc = crc32(crc, reinterpret_cast<const Bytef *>(data + offset), len);
+        offset += len;
+    }
+    return quint32(crc);
+}
+
+///
+/// @brief 加载层索引表
+/// @details 实现步骤:
+///   1. 读取定长文件尾, 校验标识及版本
+///   2. 一次读取整个索引表
+///   3. 由索引表位置反推扫描数据起点, 兼容 .usp 的 XML 头及无头的临时文件
+///
+bool USPFileReader::loadLayerTable()
+{
+    if(_fileSize < USPLAYERFOOTER_SIZE || false == _file.seek(_fileSize - USPLAYERFOOTER_SIZE)) return false;
+
+    const QByteArray footerData = _file.read(USPLAYERFOOTER_SIZE);
+    if(footerData.size() != USPLAYERFOOTER_SIZE) return false;
+
+    USPLayerFooter footer;
+    footer.nTableOffset = readValue<qint64>(footerData.constData());
+    footer.nLayerCnt = readValue<qint32>(footerData.constData() + 8);
+    footer.nVersion = readValue<quint32>(footerData.constData() + 12);
+    footer.nMagic = readValue<quint32>(footerData.constData() + 16);
+
+    const qint64 tableSz = qint64(footer.nLayerCnt) * USPLAYERENTRY_SIZE;
+    const qint64 tablePos = _fileSize - USPLAYERFOOTER_SIZE - tableSz;
+    if(USPLAYERTABLE_MAGIC != footer.nMagic || USPLAYERTABLE_VERSION != footer.nVersion ||
+       footer.nLayerCnt < 0 || footer.nTableOffset < 0 || tablePos < footer.nTableOffset)
+    {
+        return false;
+    }
+
+    _file.seek(tablePos);
+    const QByteArray tableData = _file.read(tableSz);
+    if(tableData.size() != tableSz) return false;
+
+    _dataOffset = tablePos - footer.nTableOffset;
+    _layerTable.resize(footer.nLayerCnt);
+    const char *data = tableData.constData();
+    for(auto &entry : _layerTable)
+    {
+        entry.nLayer = readValue<qint32>(data);
+        entry.nOffset = readValue<qint64>(data + 4);
+        entry.nLength = readValue<qint64>(data + 12);
+        entry.nBlockCnt = readValue<qint32>(data + 20);
+        entry.nVectorCnt = readValue<qint64>(data + 24);
+        entry.nChecksum = readValue<quint32>(data + 32);
+        data += USPLAYERENTRY_SIZE;
+    }
+    return true;
+}
@@ -0,0 +1,98 @@
+#ifndef USPFILEREADER_H
+#define USPFILEREADER_H
+
+#include <QFile>
+#include <QVector>
+#include "uspfiledef.h"
+
+///
+/// @brief 扫描块, 对应写入端的一个 UFFWRITEDATA
+///
+struct USPScanBlock {
+    qint32 nScannerIndex = 0;
+    qint32 nBeamIndex = 0;
+    qint32 nPartIndex = 0;
+    qint8 nModeSection = -1;
+    qint8 nModeCoor = -1;
+    qint32 nLaserPower = 0;
+    qint32 nMarkSpeed = 0;
+    QVector<SCANLINE> listSLines;
+};
+
+struct USPLayerData {
+    qint32 nLayer = 0;
+    qint32 nMinX = 0;
+    qint32 nMaxX = 0;
+    qint32 nMinY = 0;
+    qint32 nMaxY = 0;
+    qint32 nArea = 0;
+    QVector<USPScanBlock> blockVec;
+};
+
+///
+/// @brief 层数据遍历回调
+/// @details lines 的 data 指向 cnt 组连续的 X(32) Y(32), 原始记录直接引用文件数据(映射内存), 不做复制;
+///   单条 JUMP/MARK 记录 cnt 为1, MARKLOOP 为整组标记线, 差分编码块解码后逐条回调
+///
+class USPSectionVisitor
+{
+public:
+    virtual ~USPSectionVisitor() = default;
+    virtual void property(const quint8 &, const qint32 &) {}
+    virtual void block(const quint8 &, const quint8 &) {}
+    virtual void lines(const qint8 &, const char *, const qint32 &) {}
+};
+
+///
+/// ! @coreclass{USPFileReader}
+/// USP 文件读取
+/// @details 优先以 QFileDevice::map 映射整个文件, 层数据直接引用映射内存; 映射失败时按层定位读取.
+///   带层索引表的文件可按层号随机访问, 打开时只读取文件尾及索引表
+///
+class USPFileReader
+{
+public:
+    USPFileReader() = default;
+    ~USPFileReader();
+
+    bool open(const QString &);
+    void close();
+
+    inline bool isMapped() const { return nullptr != _mapData; }
+    inline bool hasLayerTable() const { return _hasLayerTable; }
+    inline const QVector<USPLayerEntry> &layerTable() const { return _layerTable; }
+    inline qint64 dataOffset() const { return _dataOffset; }
+    inline qint64 fileSize() const { return _fileSize; }
+    inline const char *mapData() const { return reinterpret_cast<const char *>(_mapData); }
+
+    const USPLayerEntry *findLayer(const int &) const;
+    const char *layerData(const int &, qint64 &) const;
+    bool readLayer(const int &, QByteArray &, const bool &verify = true);
+    bool decodeLayer(const int &, USPLayerData &, const bool &verify = true);
+
+    static qint64 walkLayerData(const char *, const qint64 &, USPSectionVisitor *);
+    static bool decodeLayerData(const char *, const qint64 &, USPLayerData &);
+    static qint64 findDataOffset(const char *, const qint64 &);
+    static quint32 calcChecksum(const char *, const qint64 &);
+
+    // 属性段为 标识(8)+值(32), 扫描块以 区段类型(8)+坐标类型(8) 开始
+    static inline bool isPropertySection(const quint8 &id) {
+        return id >= SECTION_LAYER && id <= SECTION_CURRENTSCANNERINDEX;
+    }
+    static inline bool isBlockSection(const quint8 &id) {
+        return (id >= SECTION_POLYGON && id < SECTION_LAYEREND) || (id >= SECTION_SSHATCH && id <= SECTION_SSPOLYGONCOOR);
+    }
+
+private:
+    bool loadLayerTable();
+
+private:
+    QFile _file;
+    uchar *_mapData = nullptr;
+    qint64 _fileSize = 0;
+    qint64 _dataOffset = 0;                 // 扫描数据在文件中的起始位置
+    bool _hasLayerTable = false;
+    QVector<USPLayerEntry> _layerTable;     // 按层号递增排列
+};
+
+#endif // USPFILEREADER_H
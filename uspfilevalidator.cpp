@@ -0,0 +1,334 @@
+#include "uspfilevalidator.h"
+#include "uspfilereader.h"
+
+#include <QCryptographicHash>
+#include <QXmlStreamReader>
+#include <QtConcurrent>
+#include <QMutex>
+#include <cstring>
+#include <limits>
+#include <cmath>
+
+#define MD5_CHUNKSIZE   (64 * 1024 * 1024)
+
+namespace {
+///
+/// @brief 单层统计, 坐标直接从映射内存读取
+///
+class LayerStatistics : public USPSectionVisitor
+{
+public:
+    explicit LayerStatistics(const USPValidateOptions &options) : _options(options) {}
+
+    void property(const quint8 &id, const qint32 &value) override {
+        switch(id)
+        {
+        case SECTION_LAYER: _nLayer = value; break;
+        case SECTION_MINX: _nLayerMinX = value; break;
+        case SECTION_MAXX: _nLayerMaxX = value; break;
+        case SECTION_MINY: _nLayerMinY = value; break;
+        case SECTION_MAXY: _nLayerMaxY = value; break;
+        default: break;
+        }
+    }
+    void block(const quint8 &, const quint8 &) override {
+        ++ _nBlockCnt;
+    }
+    void lines(const qint8 &type, const char *data, const qint32 &cnt) override {
+        const bool bMark = SECTION_SCANTYPE_MARK == type;
+        for(qint32 i = 0; i < cnt; ++ i)
+        {
+            qint32 coor[2];
+            memcpy(coor, data + i * 8, 8);
+            const qint32 &x = coor[0];
+            const qint32 &y = coor[1];
+
+            const double length = _bHasLast ? std::hypot(double(x) - _nLastX, double(y) - _nLastY) : 0.0;
+            if(bMark)
+            {
+                ++ _nMarkCnt;
+                _fMarkLength += length;
+            }
+            else
+            {
+                ++ _nJumpCnt;
+                _fJumpLength += length;
+            }
+            _nLastX = x;
+            _nLastY = y;
+            _bHasLast = true;
+
+            _nMinX = qMin(_nMinX, x);
+            _nMinY = qMin(_nMinY, y);
+            _nMaxX = qMax(_nMaxX, x);
+            _nMaxY = qMax(_nMaxY, y);
+            if(isOutOfBounds(x, y)) ++ _nOutOfBoundsCnt;
+        }
+    }
+
+    void mergeTo(USPValidateResult &result) const {
+        result.nBlockCnt += _nBlockCnt;
+        result.nJumpCnt += _nJumpCnt;
+        result.nMarkCnt += _nMarkCnt;
+        result.nOutOfBoundsCnt += _nOutOfBoundsCnt;
+        result.fJumpLength += _fJumpLength;
+        result.fMarkLength += _fMarkLength;
+        if(_nJumpCnt + _nMarkCnt)
+        {
+            result.nMinX = qMin(result.nMinX, _nMinX);
+            result.nMinY = qMin(result.nMinY, _nMinY);
+            result.nMaxX = qMax(result.nMaxX, _nMaxX);
+            result.nMaxY = qMax(result.nMaxY, _nMaxY);
+        }
+    }
+
+    inline qint32 layer() const { return _nLayer; }
+    inline qint64 blockCnt() const { return _nBlockCnt; }
+    inline qint64 outOfBoundsCnt() const { return _nOutOfBoundsCnt; }
+
+private:
+    inline bool isOutOfBounds(const qint32 &x, const qint32 &y) const {
+        const qint64 tol = _options.nBoundsTolerance;
+        if(_options.bCheckLayerBounds &&
+           (x < _nLayerMinX - tol || x > _nLayerMaxX + tol || y < _nLayerMinY - tol || y > _nLayerMaxY + tol))
+        {
+            return true;
+        }
+        return _options.bCheckPlatform &&
+               (x < _options.nPlatMinX || x > _options.nPlatMaxX || y < _options.nPlatMinY || y > _options.nPlatMaxY);
+    }
+
+private:
+    const USPValidateOptions &_options;
+    qint32 _nLayer = 0;
+    qint64 _nLayerMinX = std::numeric_limits<qint32>::min();
+    qint64 _nLayerMaxX = std::numeric_limits<qint32>::max();
+    qint64 _nLayerMinY = std::numeric_limits<qint32>::min();
+    qint64 _nLayerMaxY = std::numeric_limits<qint32>::max();
+
+    qint64 _nBlockCnt = 0;
+    qint64 _nJumpCnt = 0;
+    qint64 _nMarkCnt = 0;
+    qint64 _nOutOfBoundsCnt = 0;
+    double _fJumpLength = 0.0;
+    double _fMarkLength = 0.0;
+    qint32 _nMinX = std::numeric_limits<qint32>::max();
+    qint32 _nMinY = std::numeric_limits<qint32>::max();
+    qint32 _nMaxX = std::numeric_limits<qint32>::min();
+    qint32 _nMaxY = std::numeric_limits<qint32>::min();
+    qint32 _nLastX = 0;
+    qint32 _nLastY = 0;
+    bool _bHasLast = false;
+};
+
+QByteArray readHeaderMD5(const char *data, const qint64 &size)
+{
+    QXmlStreamReader reader(QByteArray::fromRawData(data, int(size)));
+    while(false == reader.atEnd())
+    {
+        if(reader.readNext() == QXmlStreamReader::StartElement && reader.name() == QLatin1String("MD5"))
+        {
+            return reader.readElementText().trimmed().toLatin1();
+        }
+    }
+    return QByteArray();
+}
+
+QByteArray calcMD5(const char *data, const qint64 &size)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    for(qint64 offset = 0; offset < size; offset += MD5_CHUNKSIZE)
+    {
+        hash.addData(data + offset, int(qMin<qint64>(MD5_CHUNKSIZE, size - offset)));
+    }
+    return hash.result().toHex();
+}
+
+///
+/// @brief 无层索引表时顺序跳读建立层边界
+/// @details 只解析区段长度, 不回调; 同时检查文件起始属性及结束标记
+///
+bool indexLayers(const char *data, const qint64 &size, QVector<USPLayerEntry> &layerVec, QStringList &errorList)
+{
+    static const QByteArray fileEnding("FileEnding");
+    qint64 pos = 0;
+    if(size > 0 && quint8(data[0]) <= 1) ++ pos;       // writeFileBegin_SomePropertys
+
+    while(pos < size)
+    {
+        const quint8 id = quint8(data[pos]);
+        if(SECTION_LAYER == id)
+        {
+            const qint64 nLength = USPFileReader::walkLayerData(data + pos, size - pos, nullptr);
+            if(nLength < 0)
+            {
+                errorList << QString("bad layer section at offset %1").arg(pos);
+                return false;
+            }
+            USPLayerEntry entry;
+            entry.nOffset = pos;
+            entry.nLength = nLength;
+            if(pos + 5 <= size) memcpy(&entry.nLayer, data + pos + 1, 4);
+            layerVec << entry;
+            pos += nLength;
+        }
+        else if(SECTION_FILEEND == id)
+        {
+            if(size - pos - 1 < fileEnding.size() || memcmp(data + pos + 1, fileEnding.constData(), size_t(fileEnding.size())))
+            {
+                errorList << "bad file ending";
+                return false;
+            }
+            if(pos + 1 + fileEnding.size() != size) errorList << "unexpected data after file ending";
+            return pos + 1 + fileEnding.size() == size;
+        }
+        else
+        {
+            errorList << QString("unexpected section 0x%1 at offset %2").arg(id, 0, 16).arg(pos);
+            return false;
+        }
+    }
+    errorList << "missing file ending";
+    return false;
+}
+}
+
+///
+/// @brief 校验 USP 文件
+/// @param fileName [in] 文件路径
+/// @param options [in] 校验选项
+/// @return 校验结果及统计
+/// @details 实现步骤:
+///   1. 映射文件, 读取 XML 信息中的 MD5 并在线程池中计算扫描数据的 MD5
+///   2. 确定各层边界: 有层索引表时直接使用, 否则顺序跳读
+///   3. 按层并行遍历, 检查区段结构、层号、CRC32 及坐标范围, 统计跳转/标记线
+///   4. 合并各层统计并等待 MD5 结果
+///
+USPValidateResult USPFileValidator::validate(const QString &fileName, const USPValidateOptions &options)
+{
+    USPValidateResult result;
+    USPFileReader reader;
+    if(false == reader.open(fileName) || false == reader.isMapped())
+    {
+        result.errorList << "open or map file failed";
+        return result;
+    }
+    result.bHasLayerTable = reader.hasLayerTable();
+
+    const char *fileData = reader.mapData();
+    const qint64 dataOffset = reader.dataOffset();
+    const qint64 fileSize = reader.fileSize();
+    if(dataOffset > fileSize)
+    {
+        result.errorList << "bad data offset";
+        return result;
+    }
+
+    // MD5 与层校验同时进行
+    QFuture<QByteArray> md5Future;
+    QByteArray headerMD5;
+    if(options.bCheckMD5 && dataOffset > 0)
+    {
+        headerMD5 = readHeaderMD5(fileData, dataOffset);
+        result.bHasMD5 = headerMD5.size() > 0;
+        if(result.bHasMD5) md5Future = QtConcurrent::run(calcMD5, fileData + dataOffset, fileSize - dataOffset);
+    }
+
+    // 确定层边界
+    const char *data = fileData + dataOffset;
+    bool bStructureValid = true;
+    QVector<USPLayerEntry> layerVec;
+    if(reader.hasLayerTable())
+    {
+        static const QByteArray fileEnding("FileEnding");
+        layerVec = reader.layerTable();
+        const qint64 tableOffset = fileSize - USPLAYERFOOTER_SIZE - qint64(layerVec.size()) * USPLAYERENTRY_SIZE - dataOffset;
+        const qint64 endingPos = tableOffset - fileEnding.size() - 1;
+        if(endingPos < 0 || SECTION_FILEEND != quint8(data[endingPos]) ||
+           memcmp(data + endingPos + 1, fileEnding.constData(), size_t(fileEnding.size())))
+        {
+            bStructureValid = false;
+            result.errorList << "bad file ending";
+        }
+        for(const auto &entry : qAsConst(layerVec))
+        {
+            if(entry.nOffset < 0 || entry.nLength <= 0 || entry.nOffset + entry.nLength > qMax<qint64>(endingPos, 0))
+            {
+                bStructureValid = false;
+                result.errorList << QString("layer %1: table entry out of range").arg(entry.nLayer);
+                layerVec.clear();
+                break;
+            }
+        }
+    }
+    else
+    {
+        bStructureValid = indexLayers(data, fileSize - dataOffset, layerVec, result.errorList);
+    }
+    result.nLayerCnt = layerVec.size();
+
+    // 按层并行校验
+    QMutex locker;
+    result.nMinX = std::numeric_limits<qint32>::max();
+    result.nMinY = std::numeric_limits<qint32>::max();
+    result.nMaxX = std::numeric_limits<qint32>::min();
+    result.nMaxY = std::numeric_limits<qint32>::min();
+    const bool bHasLayerTable = reader.hasLayerTable();
+#pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < layerVec.size(); ++ i)
+    {
+        const auto &entry = layerVec.at(i);
+        const char *layerData = data + entry.nOffset;
+        QStringList errorList;
+
+        LayerStatistics statistics(options);
+        const qint64 nLength = USPFileReader::walkLayerData(layerData, entry.nLength, &statistics);
+        bool bLayerValid = (nLength == entry.nLength);
+        if(false == bLayerValid) errorList << QString("layer %1: bad section structure").arg(entry.nLayer);
+        if(statistics.layer() != entry.nLayer)
+        {
+            bLayerValid = false;
+            errorList << QString("layer %1: layer number mismatch").arg(entry.nLayer);
+        }
+        if(bHasLayerTable)
+        {
+            if(USPFileReader::calcChecksum(layerData, entry.nLength) != entry.nChecksum)
+            {
+                bLayerValid = false;
+                errorList << QString("layer %1: checksum mismatch").arg(entry.nLayer);
+            }
+            if(statistics.blockCnt() != entry.nBlockCnt)
+            {
+                bLayerValid = false;
+                errorList << QString("layer %1: block count mismatch").arg(entry.nLayer);
+            }
+        }
+        else if(i > 0 && layerVec.at(i - 1).nLayer >= entry.nLayer)
+        {
+            bLayerValid = false;
+            errorList << QString("layer %1: layer order").arg(entry.nLayer);
+        }
+        if(statistics.outOfBoundsCnt())
+        {
+            errorList << QString("layer %1: %2 points out of bounds").arg(entry.nLayer).arg(statistics.outOfBoundsCnt());
+        }
+
+        QMutexLocker lock(&locker);
+        statistics.mergeTo(result);
+        bStructureValid = bStructureValid && bLayerValid;
+        for(const auto &error : qAsConst(errorList))
+        {
+            if(result.errorList.size() < options.nMaxErrorCnt) result.errorList << error;
+        }
+    }
+    result.bStructureValid = bStructureValid;
+    if(0 == result.nJumpCnt + result.nMarkCnt) result.nMinX = result.nMinY = result.nMaxX = result.nMaxY = 0;
+
+    // MD5 结果
+    if(result.bHasMD5)
+    {
+        result.bMD5Valid = (md5Future.result() == headerMD5);
+        if(false == result.bMD5Valid) result.errorList << "md5 mismatch";
+    }
+    return result;
+}
@@ -0,0 +1,61 @@
+#ifndef USPFILEVALIDATOR_H
+#define USPFILEVALIDATOR_H
+
+#include <QStringList>
+
+///
+/// @brief 校验选项
+///
+struct USPValidateOptions {
+    bool bCheckMD5 = true;              // 校验 XML 信息中的 MD5
+    bool bCheckLayerBounds = true;      // 扫描线是否位于层包围盒内
+    qint32 nBoundsTolerance = 0;        // 包围盒容差, 文件坐标单位
+    bool bCheckPlatform = false;        // 扫描线是否位于平台范围内
+    qint32 nPlatMinX = 0;
+    qint32 nPlatMinY = 0;
+    qint32 nPlatMaxX = 0;
+    qint32 nPlatMaxY = 0;
+    int nMaxErrorCnt = 100;             // 记录的错误信息上限
+};
+
+///
+/// @brief 校验结果及统计
+///
+struct USPValidateResult {
+    bool bStructureValid = false;
+    bool bHasMD5 = false;
+    bool bMD5Valid = false;
+    bool bHasLayerTable = false;
+
+    qint64 nLayerCnt = 0;
+    qint64 nBlockCnt = 0;
+    qint64 nJumpCnt = 0;
+    qint64 nMarkCnt = 0;
+    qint64 nOutOfBoundsCnt = 0;
+    double fJumpLength = 0.0;           // 文件坐标单位
+    double fMarkLength = 0.0;
+    qint32 nMinX = 0;
+    qint32 nMinY = 0;
+    qint32 nMaxX = 0;
+    qint32 nMaxY = 0;
+
+    QStringList errorList;
+
+    inline bool isValid() const {
+        return bStructureValid && (false == bHasMD5 || bMD5Valid) && 0 == nOutOfBoundsCnt;
+    }
+};
+
+///
+/// ! @coreclass{USPFileValidator}
+/// USP 文件校验
+/// @details 映射整个文件后按层并行校验区段结构、坐标范围并统计跳转/标记线, MD5 与层校验同时计算;
+///   带层索引表时直接按表分层并校验各层 CRC32, 否则先顺序跳读一遍建立层边界
+///
+class USPFileValidator
+{
+public:
+    static USPValidateResult validate(const QString &, const USPValidateOptions &options = USPValidateOptions());
+};
+
+#endif // USPFILEVALIDATOR_H
@@ -8,6 +8,13 @@
 #include <QJsonObject>
 #include <QXmlStreamWriter>
 #include <QCryptographicHash>
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
 
 ///
 /// @brief USP文件写入器构造函数
@@ -71,6 +78,14 @@ USPFileWriter::~USPFileWriter()
 ///
 bool USPFileWriter::initFileWrite()
 {
+    // 层索引表开关
+    m_bLayerTable = _writeBuff->getExtendedValue<int>("Global/nLayerTable", 0);
+    m_layerTable.clear();
+    m_curLayerEntry.nOffset = -1;
+
+    // 待写入数据内存预算, 单位 MB, 超出时提前编码到临时文件
+    _writeBuff->setWriteBudget(qint64(_writeBuff->getExtendedValue<int>("Global/nWriteBufferMB", 0)) << 20);
+
     // 设置算法缓冲区
     algorithm->setBuffParas(_writeBuff);
     // 设置写入器缓冲区
@@ -99,6 +114,7 @@ void USPFileWriter::startBuffWriter()
 ///   1. 设置结束状态
 ///   2. 等待写入完成
 ///   3. 写入层结束标记
+///   4. 开启层索引表时记录本层偏移、长度、矢量数及校验值
 ///
 void USPFileWriter::waitBuffWriter()
 {
@@ -108,6 +124,17 @@ void USPFileWriter::waitBuffWriter()
     fileWriter->wait();
     // 写入层结束标记
     writeProperty(SECTION_LAYEREND);
+
+    // 记录层索引
+    if(m_bLayerTable && m_curLayerEntry.nOffset >= 0)
+    {
+        m_curLayerEntry.nLength = _writeBuff->gFile.pos() - m_curLayerEntry.nOffset;
+        m_curLayerEntry.nBlockCnt = fileWriter->blockCount();
+        m_curLayerEntry.nVectorCnt = fileWriter->vectorCount();
+        m_curLayerEntry.nChecksum = calcChecksum(&_writeBuff->gFile, m_curLayerEntry.nOffset, m_curLayerEntry.nLength);
+        m_layerTable << m_curLayerEntry;
+        m_curLayerEntry.nOffset = -1;
+    }
 }
 
 
@@ -122,11 +149,30 @@ void USPFileWriter::waitBuffWriter()
 ///   3. 写入X最大值
 ///   4. 写入Y最小值
 ///   5. 写入Y最大值
+///   空层的边界矩形为初始值, 写入 USPEMPTYBOUND_MIN/USPEMPTYBOUND_MAX
 ///
 void USPFileWriter::writeLayerInfo(const int &nHei, const BOUNDINGRECT &totalRc, const double &)
 {
+    // 记录层起始位置
+    if(m_bLayerTable)
+    {
+        m_curLayerEntry.nLayer = nHei;
+        m_curLayerEntry.nOffset = _writeBuff->gFile.pos();
+    }
+
     // 写入层号
     writeProperty(SECTION_LAYER, nHei);
+
+    // 空层
+    if(totalRc.minX > totalRc.maxX || totalRc.minY > totalRc.maxY)
+    {
+        writeProperty(SECTION_MINX, USPEMPTYBOUND_MIN);
+        writeProperty(SECTION_MAXX, USPEMPTYBOUND_MAX);
+        writeProperty(SECTION_MINY, USPEMPTYBOUND_MIN);
+        writeProperty(SECTION_MAXY, USPEMPTYBOUND_MAX);
+        return;
+    }
+
     // 写入X边界
     writeProperty(SECTION_MINX, totalRc.minX);
     writeProperty(SECTION_MAXX, totalRc.maxX);
@@ -150,13 +196,22 @@ void USPFileWriter::writeAreaInfo(const int &area)
 /// @details 实现步骤:
 ///   1. 写入结束段标识
 ///   2. 写入结束字符串
-///   3. 刷新缓冲区
+///   3. 开启时写入层索引表
+///   4. 刷新缓冲区
 ///
 void USPFileWriter::writeFileEnd()
 {
     writeProperty(SECTION_FILEEND);
     _writeBuff->gFile.write(QString("FileEnding").toLocal8Bit());
+    if(m_bLayerTable) writeLayerTable();
     writeFlush();
+
+    if(_writeBuff->_nBudgetBytes > 0)
+    {
+        const auto stats = _writeBuff->budgetStats();
+        qDebug() << "write buffer budget" << stats.nBudgetBytes << "peak" << stats.nPeakPendingBytes
+                 << "spilled" << stats.nSpillBytes << stats.nSpillCnt << "waits" << stats.nWaitCnt << stats.nWaitMs << "ms";
+    }
 }
 
 ///
@@ -270,6 +325,73 @@ void USPFileWriter::writeFlush()
     _writeBuff->gFile.close();
 }
 
+///
+/// @brief 写入层索引表及文件尾
+/// @details 表项按层号排序, 读取端可二分查找; 各字段按 USPLayerEntry 顺序定长写入
+///
+void USPFileWriter::writeLayerTable()
+{
+    std::stable_sort(m_layerTable.begin(), m_layerTable.end(), [](const USPLayerEntry &a, const USPLayerEntry &b) {
+        return a.nLayer < b.nLayer;
+    });
+
+    auto *file = &_writeBuff->gFile;
+    USPLayerFooter footer;
+    footer.nTableOffset = file->pos();
+    footer.nLayerCnt = m_layerTable.size();
+    for(const auto &entry : qAsConst(m_layerTable))
+    {
+        writeData32(file, entry.nLayer);
+        writeData64(file, entry.nOffset);
+        writeData64(file, entry.nLength);
+        writeData32(file, entry.nBlockCnt);
+        writeData64(file, entry.nVectorCnt);
+        writeData32(file, qint32(entry.nChecksum));
+    }
+    writeData64(file, footer.nTableOffset);
+    writeData32(file, footer.nLayerCnt);
+    writeData32(file, qint32(footer.nVersion));
+    writeData32(file, qint32(footer.nMagic));
+}
+
+///
+/// @brief 合并子文件的层索引
+/// @param layerTable [in] 子文件层索引
+/// @param baseOffset [in] 子文件数据在本文件中的起始偏移
+///
+void USPFileWriter::appendLayerTable(const QVector<USPLayerEntry> &layerTable, const qint64 &baseOffset)
+{
+    if(false == m_bLayerTable) return;
+    for(auto entry : layerTable)
+    {
+        entry.nOffset += baseOffset;
+        m_layerTable << entry;
+    }
+}
+
+///
+/// @brief 计算文件指定区间的 CRC32
+/// @details 读取后恢复文件位置, 刚写入的层数据仍在系统缓存中, 回读开销较小
+///
+quint32 USPFileWriter::calcChecksum(QFile *file, const qint64 &offset, const qint64 &length)
+{
+    const qint64 nCurPos = file->pos();
+    uLong crc = crc32(0L, Z_NULL, 0);
+    if(file->seek(offset))
+    {
+        qint64 leftSz = length;
+        while(leftSz > 0)
+        {
+            auto data = file->read(qMin<qint64>(leftSz, READMAXSIZE));
+            if(data.isEmpty()) break;
+            crc = crc32(crc, reinterpret_cast<const Bytef *>(data.constData()), uInt(data.size()));
+            leftSz -= data.size();
+        }
+    }
+    file->seek(nCurPos);
+    return quint32(crc);
+}
+
 ///
 /// @brief 写入XML格式的文件信息
 /// @param mFile 目标文件指针
@@ -402,6 +524,15 @@ void USPFileWriter::writeXMLInfo(QFile *mFile, const QByteArray &fileHash,
     writer.writeCharacters(QString("%1").arg(nSplicingType));
     writer.writeEndElement();
 
+    // 写入扫描线编码版本, 原始格式不写入以保持与旧文件一致
+    int nScanEncoding = _writeBuff->getExtendedValue<int>("Global/nScanEncoding", SCANENCODING_RAW);
+    if(SCANENCODING_RAW != nScanEncoding)
+    {
+        writer.writeStartElement("ScanEncoding");
+        writer.writeCharacters(QString("%1").arg(nScanEncoding));
+        writer.writeEndElement();
+    }
+
     // 写入多层速度因子
     writer.writeStartElement("MultiLayerSpeedFactor");
     for(int iIndex = 0; iIndex < 5; iIndex ++)
@@ -472,6 +603,9 @@ void USPFileWriter::writeJsonInfo(const QString &fileName, const QString &bppNam
         nSplicingType = (1 << BpcParas->nNumber_SplicingScanner) - 1;
     }
     jsonInfo["SplicingType"] = nSplicingType;
+
+    int nScanEncoding = _writeBuff->getExtendedValue<int>("Global/nScanEncoding", SCANENCODING_RAW);
+    if(SCANENCODING_RAW != nScanEncoding) jsonInfo["ScanEncoding"] = nScanEncoding;
 }
 
 
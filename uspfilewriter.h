@@ -10,6 +10,8 @@ struct PARAWRITEBUFF;
 
 #include <QSharedPointer>
 #include <QString>
+#include <QVector>
+#include "uspfiledef.h"
 class QJsonObject;
 
 class FileWriter {
@@ -65,10 +67,15 @@ public:
     void addVolume(const double &volume) { m_fTotalVolume += volume; }
     QSharedPointer<FileWriter> cloneWriter();
 
+    inline const QVector<USPLayerEntry> &layerTable() const { return m_layerTable; }
+    void appendLayerTable(const QVector<USPLayerEntry> &, const qint64 &);
+
 private:
     void writeProperty(const int &);
     void writeProperty(const int &, const int &);
     void writeFlush();
+    void writeLayerTable();
+    static quint32 calcChecksum(QFile *, const qint64 &, const qint64 &);
     void writeXMLInfo(QFile *, const QByteArray &, const QString &, const QString &,
                       const float &, BOUNDINGBOX *, const int &, const int &);
     void writeJsonInfo(const QString &, const QString &,
@@ -81,6 +88,11 @@ public:
 
     QString m_strSystemTime;
     double m_fTotalVolume = 0.0;
+
+private:
+    bool m_bLayerTable = false;
+    USPLayerEntry m_curLayerEntry;
+    QVector<USPLayerEntry> m_layerTable;
 };
 
 #endif // USPFILEWRITER_H
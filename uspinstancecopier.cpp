@@ -0,0 +1,182 @@
+#include "uspinstancecopier.h"
+#include "publicheader.h"
+
+#include <cstring>
+
+namespace {
+template<typename T>
+inline void appendValue(QByteArray &buf, const T &value)
+{
+    buf.append(reinterpret_cast<const char *>(&value), int(sizeof(T)));
+}
+
+inline qint32 readValue32(const char *data)
+{
+    qint32 value = 0;
+    memcpy(&value, data, 4);
+    return value;
+}
+
+inline void appendTranslated(QByteArray &buf, const char *data, const qint32 &nOffsetX, const qint32 &nOffsetY)
+{
+    appendValue(buf, qint32(readValue32(data) + nOffsetX));
+    appendValue(buf, qint32(readValue32(data + 4) + nOffsetY));
+}
+}
+
+///
+/// @brief 打开源 USP 文件
+/// @return 文件可映射且找到扫描数据起点时返回 true
+///
+bool USPInstanceCopier::open(const QString &fileName)
+{
+    if(false == _reader.open(fileName)) return false;
+    if(false == _reader.isMapped() || _reader.dataOffset() >= _reader.fileSize())
+    {
+        _reader.close();
+        return false;
+    }
+    return true;
+}
+
+void USPInstanceCopier::close()
+{
+    _reader.close();
+}
+
+///
+/// @brief 平移拷贝全部层数据
+/// @param file [in] 目标文件, 调用方已写入文件起始属性
+/// @param nOffsetX [in] X 平移量
+/// @param nOffsetY [in] Y 平移量
+/// @param layerTable [out] 目标文件的层索引, 偏移为目标文件中的位置
+/// @return 源数据结构完整且全部写入时返回 true
+/// @details 实现步骤:
+///   1. 跳过源文件的起始属性(1字节), 逐层平移后写入
+///   2. 层索引的偏移、长度及校验值按平移后的数据计算, 块数与矢量数取自源文件索引表
+///   3. 读到 SECTION_FILEEND 时结束, 文件结束标记及索引表由写入器写入
+///
+bool USPInstanceCopier::copyTo(QFile *file, const qint32 &nOffsetX, const qint32 &nOffsetY,
+                               QVector<USPLayerEntry> &layerTable)
+{
+    layerTable.clear();
+    const char *data = _reader.mapData() + _reader.dataOffset();
+    const qint64 size = _reader.fileSize() - _reader.dataOffset();
+
+    QByteArray layerBuf;
+    layerBuf.reserve(1 << 20);      // reserve 后 resize(0) 保留容量, 各层复用
+    qint64 pos = 1;
+    while(pos < size)
+    {
+        const quint8 id = quint8(data[pos]);
+        if(SECTION_FILEEND == id) return true;
+        if(SECTION_LAYER != id || size - pos < 5) return false;
+
+        layerBuf.resize(0);
+        const qint64 nReadSz = translateLayerData(data + pos, size - pos, nOffsetX, nOffsetY, layerBuf);
+        if(nReadSz < 0) return false;
+
+        USPLayerEntry entry;
+        entry.nLayer = readValue32(data + pos + 1);
+        if(auto srcEntry = _reader.findLayer(entry.nLayer))
+        {
+            entry.nBlockCnt = srcEntry->nBlockCnt;
+            entry.nVectorCnt = srcEntry->nVectorCnt;
+        }
+        entry.nOffset = file->pos();
+        entry.nLength = layerBuf.size();
+        entry.nChecksum = USPFileReader::calcChecksum(layerBuf.constData(), layerBuf.size());
+        if(file->write(layerBuf) != layerBuf.size()) return false;
+
+        layerTable << entry;
+        pos += nReadSz;
+    }
+    return false;
+}
+
+///
+/// @brief 平移单层数据
+/// @param data [in] 层数据, 以 SECTION_LAYER 开始
+/// @param size [in] 可读字节数
+/// @param nOffsetX [in] X 平移量
+/// @param nOffsetY [in] Y 平移量
+/// @param buf [out] 追加平移后的层数据
+/// @return 至 SECTION_LAYEREND(含)消耗的字节数, 结构错误时返回 -1
+/// @details 与 USPFileReader::walkLayerData 相同的解析顺序; 层边界在层结束时平移.
+///   空层的边界为 USPEMPTYBOUND_MIN/USPEMPTYBOUND_MAX 或其他最小值大于最大值的初始值, 保持不变;
+///   只有一个点或一条轴向线段的层最小值等于最大值, 同样平移
+///
+qint64 USPInstanceCopier::translateLayerData(const char *data, const qint64 &size, const qint32 &nOffsetX,
+                                             const qint32 &nOffsetY, QByteArray &buf)
+{
+    if(size < 1 || SECTION_LAYER != quint8(data[0])) return -1;
+
+    const char *cur = data;
+    const char *end = data + size;
+    bool bHasBlock = false;
+    int boundPos[4] = { -1, -1, -1, -1 };   // MINX, MAXX, MINY, MAXY 在 buf 中的位置
+
+    while(cur < end)
+    {
+        const quint8 id = quint8(*cur ++);
+        buf.append(char(id));
+        if(SECTION_LAYEREND == id)
+        {
+            if(boundPos[0] >= 0 && boundPos[1] >= 0 && boundPos[2] >= 0 && boundPos[3] >= 0)
+            {
+                char *bounds = buf.data();
+                const qint32 nMinX = readValue32(bounds + boundPos[0]), nMaxX = readValue32(bounds + boundPos[1]);
+                const qint32 nMinY = readValue32(bounds + boundPos[2]), nMaxY = readValue32(bounds + boundPos[3]);
+                const bool bEmpty = (USPEMPTYBOUND_MIN == nMinX && USPEMPTYBOUND_MAX == nMaxX) ||
+                                    (USPEMPTYBOUND_MIN == nMinY && USPEMPTYBOUND_MAX == nMaxY);
+                if(false == bEmpty && nMinX <= nMaxX && nMinY <= nMaxY)
+                {
+                    const qint32 values[4] = { nMinX + nOffsetX, nMaxX + nOffsetX, nMinY + nOffsetY, nMaxY + nOffsetY };
+                    for(int i = 0; i < 4; ++ i) memcpy(bounds + boundPos[i], &values[i], 4);
+                }
+            }
+            return cur - data;
+        }
+
+        if(USPFileReader::isPropertySection(id))
+        {
+            if(end - cur < 4) return -1;
+            if(id >= SECTION_MINX && id <= SECTION_MAXY) boundPos[id - SECTION_MINX] = buf.size();
+            buf.append(cur, 4);
+            cur += 4;
+        }
+        else if(USPFileReader::isBlockSection(id))
+        {
+            if(end - cur < 1) return -1;
+            buf.append(*cur ++);
+            bHasBlock = true;
+        }
+        else if(false == bHasBlock)
+        {
+            return -1;
+        }
+        else if(SECTION_SCANTYPE_JUMP == id || SECTION_SCANTYPE_MARK == id)
+        {
+            if(end - cur < 8) return -1;
+            appendTranslated(buf, cur, nOffsetX, nOffsetY);
+            cur += 8;
+        }
+        else if(SECTION_SCANTYPE_MARKLOOP == id)
+        {
+            if(end - cur < 4) return -1;
+            const qint32 nMarkCnt = readValue32(cur);
+            cur += 4;
+            if(nMarkCnt < 0 || end - cur < qint64(nMarkCnt) * 8) return -1;
+            appendValue(buf, nMarkCnt);
+            for(qint32 i = 0; i < nMarkCnt; ++ i, cur += 8) appendTranslated(buf, cur, nOffsetX, nOffsetY);
+        }
+        else if(SECTION_SCANTYPE_DELTA == id)
+        {
+            const qint64 nReadSz = translateScanLinesDelta(cur, end - cur, nOffsetX, nOffsetY, buf);
+            if(nReadSz < 0) return -1;
+            cur += nReadSz;
+        }
+        else return -1;
+    }
+    return -1;
+}
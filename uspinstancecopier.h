@@ -0,0 +1,29 @@
+#ifndef USPINSTANCECOPIER_H
+#define USPINSTANCECOPIER_H
+
+#include <QFile>
+#include <QVector>
+#include "uspfilereader.h"
+
+///
+/// ! @coreclass{USPInstanceCopier}
+/// 相同零件的扫描数据平移拷贝
+/// @details 读取已生成的 USP 文件, 将各层扫描数据按给定偏移平移后写入新文件:
+///   层边界及原始格式坐标就地平移, 差分编码块只改写首点, 层长度、块数与矢量数随之得到,
+///   不需要重新解码排序. 源文件须能映射
+///
+class USPInstanceCopier
+{
+public:
+    bool open(const QString &);
+    void close();
+
+    bool copyTo(QFile *, const qint32 &, const qint32 &, QVector<USPLayerEntry> &);
+
+    static qint64 translateLayerData(const char *, const qint64 &, const qint32 &, const qint32 &, QByteArray &);
+
+private:
+    USPFileReader _reader;
+};
+
+#endif // USPINSTANCECOPIER_H
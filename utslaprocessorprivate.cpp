@@ -6,20 +6,39 @@
 #include "qjsonparsing.h"
 #include "bpccommon.h"
 #include "ziplib.h"
+#include "jobarchiver.h"
+#include "layerarena.h"
+#include "uspinstancecopier.h"
 
 #include "SelfAdaptiveModule/selfadaptivemodule.h"
 #include "LatticeModule/latticeinterface.h"
 
+#include <QCryptographicHash>
 #include <QElapsedTimer>
 #include <QtConcurrent>
 #include <QThread>
 #include <atomic>
+#include <climits>
 
 #include "sljobfilewriter.h"
 #include "DynamicDivider/dividerprocessor.h"
 
 #define MaxReadSz 10240000L
 
+namespace {
+template<typename T>
+inline void appendHashValue(QByteArray &buf, const T &value)
+{
+    buf.append(reinterpret_cast<const char *>(&value), int(sizeof(T)));
+}
+
+template<typename T>
+inline void addHashValue(QCryptographicHash &hash, const T &value)
+{
+    hash.addData(reinterpret_cast<const char *>(&value), int(sizeof(T)));
+}
+}
+
 ///
 /// @brief UTSLAProcessor私有实现类的构造函数
 /// @param q UTSLAProcessor对象指针
@@ -57,6 +76,7 @@ UTSLAProcessorPrivate::UTSLAProcessorPrivate(UTSLAProcessor *q)
 ///      - 普通构建处理
 ///   5. 生成处理结果
 ///   6. 根据导出模式创建结果文件
+/// @details 开启 Global/nStreamCompress 时, 各零件文件生成后立即在线程池中压缩, 与后续零件的处理重叠
 ///
 void UTSLAProcessorPrivate::processing(const int &nSLayer, const int &nELayer, const QJsonObject &jsonObj)
 {
@@ -80,10 +100,26 @@ void UTSLAProcessorPrivate::processing(const int &nSLayer, const int &nELayer, c
     // 创建层厚列表
     _selfAdaptiveModule->createThicknessList();
 
+    // 预计算点阵周期截面
+    precomputeLattice();
+
     // 获取扫描器配置
     auto scannerCnt = _writerBufferParas->getExtendedValue<int>("Splicing/nNumber_SplicingScanner", 1);
     auto scanRangeMode = _writerBufferParas->getExtendedValue<int>("Splicing/nScanRangeMode", 0);
 
+    // 流式压缩
+    Q_Q(UTSLAProcessor);
+    _jobArchiver.clear();
+    if(_writerBufferParas->getExtendedValue<int>("Global/nStreamCompress", 0) &&
+       (EXPORT_SLM_BUILDFILE == nExportFileMode || q->needCompression()))
+    {
+        _jobArchiver = QSharedPointer<JobArchiver>(new JobArchiver);
+    }
+
+    // 层内存池
+    _layerArena = (0 != _writerBufferParas->getExtendedValue<int>("Global/nLayerArena", 0));
+    LayerArena::clearTotalStats();
+
     // 选择处理方式
     _progressPos = -1;
     if (1 == scanRangeMode && scannerCnt > 1)
@@ -93,9 +129,11 @@ void UTSLAProcessorPrivate::processing(const int &nSLayer, const int &nELayer, c
     }
     else buildProcessing();
 
-
-    Q_Q(UTSLAProcessor);
-    if(false == q->isRunning()) return;
+    if(false == q->isRunning())
+    {
+        _jobArchiver.clear();
+        return;
+    }
 
     // 生成处理结果
     QJsonObject jsonResult;
@@ -111,6 +149,7 @@ void UTSLAProcessorPrivate::processing(const int &nSLayer, const int &nELayer, c
         if(q->needCompression()) createJsonResultWithCompress(jsonResult);
         else createJsonResult(jsonResult);
     }
+    _jobArchiver.clear();
     qDebug() << "processing elapsed" << elapsed.elapsed();
 }
 
@@ -139,6 +178,7 @@ bool UTSLAProcessorPrivate::loadParameters(const QString &strBppPath, const QStr
 
     // 获取BPP文件名
     strBPPName = QFileInfo(strBppPath).completeBaseName();
+    strBPPPath = strBppPath;
 
     // 加载BPP参数
     if(false == UTBPParaReader::loadParameters(strBppPath, *(_writerBufferParas->_bppParaPtr.data()),
@@ -289,6 +329,7 @@ void UTSLAProcessorPrivate::partProcessing(const int &index)
             int _beginLayer = 0;
             int _endLayer = 0;
             QString _subFileName = "";
+            QVector<USPLayerEntry> _layerTable;
         };
         typedef QSharedPointer<SubFileInfo> SubFileInfoPtr;
         QVector<SubFileInfoPtr> subFileVec;
@@ -328,6 +369,7 @@ void UTSLAProcessorPrivate::partProcessing(const int &index)
                 funcRunner(subFilePtr->_beginLayer, subFilePtr->_endLayer, writer);
                 if (auto tempWriter = dynamic_cast<USPFileWriter *>(writer.data())) {
                     totalVolume = totalVolume + tempWriter->m_fTotalVolume;
+                    subFilePtr->_layerTable = tempWriter->layerTable();
                 }
                 writer->getBufPara()->gFile.close();
             }
@@ -343,6 +385,9 @@ void UTSLAProcessorPrivate::partProcessing(const int &index)
             QFile file(subFileInfo->_subFileName);
             if (file.open(QIODevice::ReadOnly))
             {
+                if (auto mainWriter = dynamic_cast<USPFileWriter *>(uspWriter.data())) {
+                    mainWriter->appendLayerTable(subFileInfo->_layerTable, uspWriter->getBufPara()->gFile.pos());
+                }
                 auto leftSz = file.size();
                 while (false == file.atEnd())
                 {
@@ -357,6 +402,68 @@ void UTSLAProcessorPrivate::partProcessing(const int &index)
         dir.rmpath(saveFolder);
         uspWriter->addVolume(totalVolume);
     }
+    // 写入文件结束信息并创建USP文件
+    finishPartFile(index, uspWriter);
+}
+
+///
+/// @brief 由相同零件的文件平移生成零件文件
+/// @param index [in] 零件索引
+/// @details 实现步骤:
+///   1. 源零件未生成文件或文件无法映射时完整处理
+///   2. 写入文件头, 逐层平移拷贝源文件扫描数据
+///   3. 合并层索引及体积, 写入文件结束信息并创建USP文件
+///   4. 拷贝失败时删除临时文件并完整处理
+///
+void UTSLAProcessorPrivate::instanceProcessing(const int &index)
+{
+    Q_Q(UTSLAProcessor);
+    if (false == q->isRunning()) return;
+
+    const PartInstance &instance = _partInstances[size_t(index)];
+    const PartInstance &source = _partInstances[size_t(instance.nSource)];
+
+    USPInstanceCopier copier;
+    if (source.strUspFile.isEmpty() || false == copier.open(source.strUspFile))
+    {
+        partProcessing(index);
+        return;
+    }
+
+    USPFileWriterPtr uspWriter = nullptr;
+    if (false == createFileWriter(index, uspWriter)) return;
+    auto *writer = dynamic_cast<USPFileWriter *>(uspWriter.data());
+
+    uspWriter->writeFileBegin_SomePropertys();
+    QVector<USPLayerEntry> layerTable;
+    if (nullptr == writer ||
+        false == copier.copyTo(&uspWriter->getBufPara()->gFile, instance.nOffsetX, instance.nOffsetY, layerTable))
+    {
+        qDebug() << "instance copy failed" << index << source.strUspFile;
+        copier.close();
+        uspWriter->getBufPara()->gFile.close();
+        uspWriter->getBufPara()->gFile.remove();
+        partProcessing(index);
+        return;
+    }
+    copier.close();
+
+    writer->appendLayerTable(layerTable, 0);
+    uspWriter->addVolume(source.fVolume);
+    updateProgress(fSinglePartRatio);
+    finishPartFile(index, uspWriter);
+}
+
+///
+/// @brief 写入文件结束信息并创建USP文件
+/// @param index [in] 零件索引
+/// @param uspWriter [in] 文件写入器
+/// @details 开启相同零件去重时记录生成的文件及体积, 供平移拷贝使用
+///
+void UTSLAProcessorPrivate::finishPartFile(const int &index, const USPFileWriterPtr &uspWriter)
+{
+    Q_Q(UTSLAProcessor);
+
     // 写入文件结束信息
     uspWriter->writeFileEnd();
 
@@ -367,6 +474,15 @@ void UTSLAProcessorPrivate::partProcessing(const int &index)
         uspWriter->createUSPFile(q->getBuildPartName(index), strBPPName, q->getLayerThickness(index),
                                  q->getBoundingBox(index), q->getMinLayer(index), q->getMaxLayer(index), jsonPartInfo);
         objZipDescFile << jsonPartInfo;
+        archivePartFile(uspWriter);
+
+        if (size_t(index) < _partInstances.size())
+        {
+            auto *writer = dynamic_cast<USPFileWriter *>(uspWriter.data());
+            const QString strTempFile = uspWriter->getBufPara()->gFile.fileName();
+            _partInstances[size_t(index)].strUspFile = strTempFile.left(strTempFile.size() - 3) + "usp";
+            _partInstances[size_t(index)].fVolume = writer ? writer->m_fTotalVolume : 0.0;
+        }
     }
 }
 
@@ -376,8 +492,10 @@ void UTSLAProcessorPrivate::partProcessing(const int &index)
 ///   1. 更新层拼接信息
 ///   2. 获取所有零件的层范围
 ///   3. 计算单个零件的进度比例
-///   4. 并行处理所有零件
-///   5. 更新最终进度
+///   4. 开启 Global/nInstanceDedup 时查找平移后相同的零件
+///   5. 并行处理所有需要完整处理的零件
+///   6. 相同零件由已生成的文件平移得到
+///   7. 更新最终进度
 ///
 void UTSLAProcessorPrivate::buildProcessing()
 {
@@ -400,21 +518,186 @@ void UTSLAProcessorPrivate::buildProcessing()
     // 计算单个零件进度比例
     fSinglePartRatio = 100.0 / q->getBuildPartCount();
 
+    // 查找相同零件
+    findPartInstances();
+
     // 并行处理所有零件
     QVector<int> listInt;
+    QVector<int> listInstance;
     int nCnt = q->getBuildPartCount();
     for(int iCnt = 0; iCnt < nCnt; ++ iCnt) 
-        listInt << iCnt;
+    {
+        if(_partInstances.size() && iCnt != _partInstances[size_t(iCnt)].nSource) listInstance << iCnt;
+        else listInt << iCnt;
+    }
 
     futureWatcher.setFuture(QtConcurrent::map(listInt, std::bind(&UTSLAProcessorPrivate::partProcessing,
                                                                 this, std::placeholders::_1)));
     futureWatcher.waitForFinished();
 
+    // 平移生成相同零件
+    if(listInstance.size() && q->isRunning())
+    {
+        futureWatcher.setFuture(QtConcurrent::map(listInstance, std::bind(&UTSLAProcessorPrivate::instanceProcessing,
+                                                                         this, std::placeholders::_1)));
+        futureWatcher.waitForFinished();
+    }
+    _partInstances.clear();
+
     // 更新最终进度
     if(fabs(100.0 - fProcessing) > 1E-6) 
         updateProgress(100.0 - fProcessing);
 }
 
+///
+/// @brief 是否可以按平移拷贝相同零件
+/// @details 以下情况零件平移后扫描数据不只是平移, 需要完整处理:
+///   SLM 作业文件(按零件位置选择扫描器并缩放坐标)、点阵、拼接或多扫描器分区、
+///   棋盘格及条带填充(按平台坐标划分)
+///
+bool UTSLAProcessorPrivate::isInstanceDedupAvailable()
+{
+    if(EXPORT_SLM_BUILDFILE == nExportFileMode) return false;
+    if(_latticeInfPtr) return false;
+
+    const auto &bppParas = _writerBufferParas->_bppParaPtr;
+    const auto &bpcParas = _writerBufferParas->_bpcParaPtr;
+    const int nSplicingScanner = _writerBufferParas->getExtendedValue<int>("Splicing/nNumber_SplicingScanner",
+        qMax(bpcParas->nNumber_SplicingScanner, bppParas->sGeneralPara.nNumber_SplicingScanner));
+    if(nSplicingScanner > 1) return false;
+
+    for(int iBeam = 0; iBeam < bppParas->sGeneralPara.nNumber_Beam; ++ iBeam)
+    {
+        if(AlgorithmApplication::isPlatformAnchoredHatching(bppParas->sHatchingPara.nHatchingType[iBeam])) return false;
+    }
+    return false == AlgorithmApplication::isPlatformAnchoredHatching(
+        _writerBufferParas->getExtendedValue<int>("SolidSupportHatching/nHatchingType", 0));
+}
+
+///
+/// @brief 查找平移后相同的零件
+/// @details 实现步骤:
+///   1. 未开启或当前参数下零件平移会改变扫描数据时不查找
+///   2. 并行计算各零件切片数据的特征值及基准点
+///   3. 特征值相同的零件以第一个为源零件, 平移量为基准点之差
+///
+void UTSLAProcessorPrivate::findPartInstances()
+{
+    Q_Q(UTSLAProcessor);
+    _partInstances.clear();
+    if(0 == _writerBufferParas->getExtendedValue<int>("Global/nInstanceDedup", 0)) return;
+    if(false == isInstanceDedupAvailable())
+    {
+        qDebug() << "part instance dedup disabled by current parameters";
+        return;
+    }
+
+    const int partCnt = q->getBuildPartCount();
+    std::vector<QByteArray> signatureVec(size_t(partCnt));
+    std::vector<IntPoint> anchorVec(size_t(partCnt));
+#pragma omp parallel for num_threads(_threadCount)
+    for(int i = 0; i < partCnt; ++ i) calcPartSignature(i, signatureVec[size_t(i)], anchorVec[size_t(i)]);
+    if(false == q->isRunning()) return;
+
+    _partInstances.resize(size_t(partCnt));
+    QHash<QByteArray, int> sourceHash;
+    int nInstanceCnt = 0;
+    for(int i = 0; i < partCnt; ++ i)
+    {
+        auto &instance = _partInstances[size_t(i)];
+        instance.nSource = i;
+        if(signatureVec[size_t(i)].isEmpty()) continue;
+
+        auto it = sourceHash.constFind(signatureVec[size_t(i)]);
+        if(it == sourceHash.constEnd())
+        {
+            sourceHash.insert(signatureVec[size_t(i)], i);
+            continue;
+        }
+
+        const qint64 nOffsetX = anchorVec[size_t(i)].X - anchorVec[size_t(it.value())].X;
+        const qint64 nOffsetY = anchorVec[size_t(i)].Y - anchorVec[size_t(it.value())].Y;
+        if(qAbs(nOffsetX) > qint64(INT_MAX) || qAbs(nOffsetY) > qint64(INT_MAX)) continue;
+
+        instance.nSource = it.value();
+        instance.nOffsetX = qint32(nOffsetX);
+        instance.nOffsetY = qint32(nOffsetY);
+        ++ nInstanceCnt;
+    }
+    qDebug() << "part instances" << partCnt << "unique" << partCnt - nInstanceCnt;
+}
+
+///
+/// @brief 计算零件切片数据的特征值
+/// @param index [in] 零件索引
+/// @param signature [out] 特征值, 停止处理时为空
+/// @param anchor [out] 基准点, 第一个非空区域的起点
+/// @details 依次计入层范围、层厚、各层有效标志及实体、支撑、实体支撑区域的方向与相对基准点的坐标;
+///   旋转或镜像的零件相对坐标不同, 不会判为相同
+///
+void UTSLAProcessorPrivate::calcPartSignature(const int &index, QByteArray &signature, IntPoint &anchor)
+{
+    Q_Q(UTSLAProcessor);
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const int nMinLayer = q->getMinLayer(index);
+    const int nMaxLayer = q->getMaxLayer(index);
+    const float fThickness = q->getLayerThickness(index);
+    addHashValue(hash, qint32(nMinLayer));
+    addHashValue(hash, qint32(nMaxLayer));
+    addHashValue(hash, fThickness);
+
+    bool bAnchor = false;
+    QByteArray buf;
+    buf.reserve(1 << 16);   // reserve 后 resize(0) 保留容量
+    for(int nHei = nMinLayer; nHei <= nMaxLayer; ++ nHei)
+    {
+        if(false == q->isRunning()) return;
+
+        const qint8 nEffective = (q->isEffectiveLayer(nHei, index) ? 1 : 0) |
+                                 (q->isEffectiveLayer(nHei, index, FTYPE_SOLID) ? 2 : 0);
+        addHashValue(hash, nEffective);
+        if(0 == nEffective) continue;
+
+        for(const auto &type : { FTYPE_SOLID, FTYPE_SUPPORT, FTYPE_SOLIDSUPPORT })
+        {
+            QList<AREAINFOPTR> listArea;
+            q->readLayerDatas(nHei, listArea, index, type);
+
+            buf.resize(0);
+            appendHashValue(buf, qint32(listArea.size()));
+            for(const auto &area : qAsConst(listArea)) appendAreaSignature(buf, area->nDir, area->ptPath, bAnchor, anchor);
+            hash.addData(buf);
+        }
+    }
+    signature = hash.result();
+}
+
+///
+/// @brief 计入单个区域的特征数据
+/// @param buf [in,out] 特征数据
+/// @param nDir [in] 区域方向
+/// @param path [in] 区域轮廓
+/// @param bAnchor [in,out] 是否已确定基准点
+/// @param anchor [in,out] 基准点, 未确定时取第一个非空区域的起点
+/// @details 坐标以相对基准点的偏移计入, 平移后的相同零件得到相同的特征数据
+///
+void UTSLAProcessorPrivate::appendAreaSignature(QByteArray &buf, const int &nDir, const Path &path,
+                                                bool &bAnchor, IntPoint &anchor)
+{
+    appendHashValue(buf, qint32(nDir));
+    appendHashValue(buf, qint32(path.size()));
+    if(false == bAnchor && path.size())
+    {
+        anchor = path.front();
+        bAnchor = true;
+    }
+    for(const auto &pt : path)
+    {
+        appendHashValue(buf, qint64(pt.X - anchor.X));
+        appendHashValue(buf, qint64(pt.Y - anchor.Y));
+    }
+}
 
 ///
 /// @brief 读取并解析指定层的所有数据
@@ -460,6 +743,7 @@ void UTSLAProcessorPrivate::calcLayerDatas(const int &nHei, const int &index, co
                                           const USPFileWriterPtr &uspWriter, SOLIDPATH &solidPath)
 {
     Q_Q(UTSLAProcessor);
+    LayerArenaScope arenaScope(_layerArena);
 
     // 计算实际层厚
     double fLayerThickness = 0.1;
@@ -596,9 +880,23 @@ void UTSLAProcessorPrivate::calcLayerDatas(const int &nHei, const int &index, co
 ///
 void UTSLAProcessorPrivate::readLayerDatas(const int &nHei, const int &index,
                                           const USPFileWriterPtr &uspWriter, SOLIDPATH &solidPath)
+{
+    readLayerDatas(nHei, index, uspWriter->getBufPara(), uspWriter->algo(), solidPath);
+}
+
+///
+/// @brief 使用指定算法对象读取层数据
+/// @param nHei [in] 当前层高度
+/// @param index [in] 零件索引
+/// @param _writeBuff [in] 写入缓冲区参数
+/// @param algo [in] 轮廓计算使用的算法对象
+/// @param solidPath [out] 实体路径数据
+/// @details 流水线读取阶段使用独立的算法对象, 避免与写入阶段共享状态
+///
+void UTSLAProcessorPrivate::readLayerDatas(const int &nHei, const int &index, PARAWRITEBUFF *_writeBuff,
+                                          AlgorithmApplication *algo, SOLIDPATH &solidPath)
 {
     Q_Q(UTSLAProcessor);
-    auto *_writeBuff = uspWriter->getBufPara();
 
     // 获取下表面层索引
     QList<int> listIndex_Dw;
@@ -664,7 +962,8 @@ void UTSLAProcessorPrivate::readLayerDatas(const int &nHei, const int &index,
 
                 solidPath.nLayerUsed[iLayer] = 1;
                 solidPath.sLayerDatas[iLayer].nLayerHei = nHei;
-                uspWriter->algo()->getAllPaths(listAreaPtr, solidPath.sLayerDatas[iLayer].allPaths);
+                algo->getAllPaths(listAreaPtr, solidPath.sLayerDatas[iLayer].allPaths);
+                simplifyLayerPaths(nHei, index, algo, solidPath.sLayerDatas[iLayer].allPaths);
                 solidPath.curPaths = solidPath.sLayerDatas[iLayer].allPaths;
                 solidPath.lpPath_Cur = &solidPath.curPaths;
                 break;
@@ -687,7 +986,8 @@ void UTSLAProcessorPrivate::readLayerDatas(const int &nHei, const int &index,
 
                     solidPath.nLayerUsed[iLayer] = 1;
                     solidPath.sLayerDatas[iLayer].nLayerHei = listIndex_Dw.at(iSur);
-                    uspWriter->algo()->getAllPaths(listAreaPtr, solidPath.sLayerDatas[iLayer].allPaths);
+                    algo->getAllPaths(listAreaPtr, solidPath.sLayerDatas[iLayer].allPaths);
+                    simplifyLayerPaths(listIndex_Dw.at(iSur), index, algo, solidPath.sLayerDatas[iLayer].allPaths);
                     solidPath.lpPath_Dw[iSur] = &solidPath.sLayerDatas[iLayer].allPaths;
                     break;
                 }
@@ -710,7 +1010,8 @@ void UTSLAProcessorPrivate::readLayerDatas(const int &nHei, const int &index,
 
                     solidPath.nLayerUsed[iLayer] = 1;
                     solidPath.sLayerDatas[iLayer].nLayerHei = listIndex_Up.at(iSur);
-                    uspWriter->algo()->getAllPaths(listAreaPtr, solidPath.sLayerDatas[iLayer].allPaths);
+                    algo->getAllPaths(listAreaPtr, solidPath.sLayerDatas[iLayer].allPaths);
+                    simplifyLayerPaths(listIndex_Up.at(iSur), index, algo, solidPath.sLayerDatas[iLayer].allPaths);
                     solidPath.lpPath_Up[iSur] = &solidPath.sLayerDatas[iLayer].allPaths;
                     break;
                 }
@@ -730,6 +1031,42 @@ void UTSLAProcessorPrivate::readLayerDatas(const int &nHei, const int &index,
             solidPath.lpPath_Up[iSur] = &solidPath.nullPaths;
         }
     }
+
+    // 释放本层未使用的缓存层, 层序递增读取时不会再次命中
+    for(int iLayer = 0; iLayer < 11; iLayer ++)
+    {
+        if(0 == solidPath.nLayerUsed[iLayer] && solidPath.sLayerDatas[iLayer].allPaths.size())
+        {
+            Paths().swap(solidPath.sLayerDatas[iLayer].allPaths);
+            solidPath.sLayerDatas[iLayer].nLayerHei = -1;
+        }
+    }
+}
+
+
+///
+/// @brief 按光斑容差简化层轮廓
+/// @param nHei [in] 层高度
+/// @param index [in] 零件索引
+/// @param algo [in] 算法对象
+/// @param paths [in,out] 层轮廓路径
+/// @details 实现步骤:
+///   1. 未启用简化时直接返回
+///   2. 按容差移除冗余顶点, 拓扑改变时保持原轮廓
+///   3. 输出该层简化前后的顶点数
+///
+void UTSLAProcessorPrivate::simplifyLayerPaths(const int &nHei, const int &index, AlgorithmApplication *algo, Paths &paths)
+{
+    if(_simplifyTolerance <= 0 || paths.size() < 1) return;
+
+    qint64 nSrcCnt = 0;
+    for(const auto &path : paths) nSrcCnt += qint64(path.size());
+    const int nRemovedCnt = algo->simplifyPaths(paths, _simplifyTolerance);
+    if(nSrcCnt > 0)
+    {
+        qDebug() << "simplify layer" << nHei << "part" << index << nSrcCnt << "->" << nSrcCnt - nRemovedCnt
+                 << QString("%1%").arg(100.0 * nRemovedCnt / nSrcCnt, 0, 'f', 1);
+    }
 }
 
 
@@ -801,7 +1138,7 @@ int UTSLAProcessorPrivate::getNextLayerHei(const int &nStartLayer, const int &in
 ///   1. 初始化拼接参数
 ///   2. 获取所有零件的层范围
 ///   3. 遍历所有有效层
-///   4. 添加层拼接区域
+///   4. 记录各层拼接线位置
 ///
 void UTSLAProcessorPrivate::updateLayerSplicingInfo()
 {
@@ -822,7 +1159,8 @@ void UTSLAProcessorPrivate::updateLayerSplicingInfo()
         endLayer = qMax(endLayer, q->getMaxLayer(i));
     }
 
-    // 遍历所有层添加拼接区域
+    // 遍历所有层记录拼接线位置, 分区矩形在取用时生成
+    _writerBufferParas->_splicingPtr->initSplicingTable(curLayer, endLayer);
     endLayer += 1;
     while(curLayer < endLayer)
     {
@@ -993,15 +1331,14 @@ void UTSLAProcessorPrivate::createJsonResultWithCompress(QJsonObject &jsonResult
 
     // 构建压缩文件路径
     QString strSaveName = q->getSaveFolder() + q->getSaveName() + ".uzp";
-    ZipLib zip;
 
     // 创建压缩描述信息
     QJsonObject objZipDesc;
     objZipDesc["PartInfo"] = objZipDescFile;
 
     // 执行压缩操作
-    if(zip.CreateFilesZip(strSaveName, listFile, "UT20200725UT",
-                         QString(QJsonDocument(objZipDesc).toJson()).toLocal8Bit()))
+    if(createFilesZip(strSaveName, listFile, "UT20200725UT",
+                      QString(QJsonDocument(objZipDesc).toJson()).toLocal8Bit()))
     {
         // 删除原始文件
         for(const auto &fileName : qAsConst(listFile))
@@ -1035,7 +1372,7 @@ void UTSLAProcessorPrivate::createJsonResultWithCompress(QJsonObject &jsonResult
 ///   2. 创建作业内容XML文件
 ///   3. 创建第一层压缩包(.job)
 ///   4. 删除原始XML文件
-///   5. 创建最终压缩包(.zip)
+///   5. 创建最终压缩包(.zip), 流式压缩时 .job 按存储方式写入
 ///   6. 生成结果信息
 ///   7. 清理临时文件
 ///
@@ -1058,11 +1395,7 @@ void UTSLAProcessorPrivate::createJobFileResult(QJsonObject &jsonResult)
     listFile << (q->getSaveFolder() + "Content.xml") << (q->getSaveFolder() + "JobMetaData.job");
     {
         // 创建.job压缩包
-        {
-            ZipLib zip;
-            zip.CreateFilesZip(q->getSaveFolder() + q->getSaveName() + ".job",
-                             listFile, nullptr, "SLM Build File");
-        }
+        createFilesZip(q->getSaveFolder() + q->getSaveName() + ".job", listFile, nullptr, "SLM Build File");
 
         // 删除原始XML文件
         for(const QString &fileName : qAsConst(listFile))
@@ -1073,15 +1406,15 @@ void UTSLAProcessorPrivate::createJobFileResult(QJsonObject &jsonResult)
         // 准备最终压缩文件列表
         listFile.clear();
         listFile << q->getSaveFolder() + q->getSaveName() + ".job";
+        // .job 已是压缩包, 流式压缩时按存储方式写入外层压缩包
+        if(_jobArchiver) _jobArchiver->addFile(listFile.first(), true);
         for(const auto &name : qAsConst(listPartName))
         {
             listFile << (q->getSaveFolder() + name + ".bin");
         }
 
         // 创建最终.zip压缩包
-        ZipLib zip;
-        if(zip.CreateFilesZip(q->getSaveFolder() + q->getSaveName() + ".zip",
-                             listFile, nullptr, "SLM Build File"))
+        if(createFilesZip(q->getSaveFolder() + q->getSaveName() + ".zip", listFile, nullptr, "SLM Build File"))
         {
             // 构建结果信息
             QJsonObject jsonTarget;
@@ -1108,6 +1441,39 @@ void UTSLAProcessorPrivate::createJobFileResult(QJsonObject &jsonResult)
     }
 }
 
+///
+/// @brief 提交零件文件进行流式压缩
+/// @param uspWriter [in] 已完成 createUSPFile 的文件写入器
+/// @details SLM 模式提交 .bin 文件, 先关闭写入句柄; 其他模式提交生成的 .usp 文件.
+///   未开启流式压缩时不做处理
+///
+void UTSLAProcessorPrivate::archivePartFile(const USPFileWriterPtr &uspWriter)
+{
+    if(_jobArchiver.isNull() || nullptr == uspWriter->getBufPara()) return;
+
+    auto &gFile = uspWriter->getBufPara()->gFile;
+    QString strFileName = gFile.fileName();
+    if(EXPORT_SLM_BUILDFILE == nExportFileMode)
+    {
+        if(gFile.isOpen()) gFile.close();
+    }
+    else strFileName = strFileName.left(strFileName.size() - 3) + "usp";
+    _jobArchiver->addFile(strFileName);
+}
+
+///
+/// @brief 创建压缩包
+/// @details 开启流式压缩时由 JobArchiver 拼接已压缩的条目, 否则使用 ZipLib
+///
+bool UTSLAProcessorPrivate::createFilesZip(const QString &zipName, const QStringList &listFile,
+                                           const char *password, const QByteArray &comment)
+{
+    if(_jobArchiver) return _jobArchiver->createFilesZip(zipName, listFile, password, comment);
+
+    ZipLib zip;
+    return zip.CreateFilesZip(zipName, listFile, password, comment);
+}
+
 ///
 /// @brief 加载导出参数配置
 /// @details 实现步骤:
@@ -1143,6 +1509,17 @@ void UTSLAProcessorPrivate::loadExportParameters()
         jsonObj["nMarkSpeed"] = ExtendedParas<int>("SolidSupportBorder/nMarkSpeed", 1000);
         _writeBuff->_extendObj.insert("SolidSupportBorder", jsonObj);
     }
+
+    // 加载轮廓简化参数,容差按光斑直径折算;光斑直径取首道轮廓的光斑补偿(半径)的两倍
+    _simplifyTolerance = 0.0;
+    if(ExtendedParas<int>("Simplify/nUseSimplify", 0))
+    {
+        double fBeamSize = 0.0;
+        if(BppParas->sBorderPara.nNumber > 0) fBeamSize = 2.0 * double(BppParas->sBorderPara.fOffset[0]);
+        auto fTolerance = ExtendedParas<double>("Simplify/fBeamFactor", 0.1) * fBeamSize;
+        if(fTolerance > 0) _simplifyTolerance = fTolerance * FILEDATAUNIT;
+        else qDebug() << "simplify disabled: no beam compensation in border parameters";
+    }
 }
 
 
@@ -1334,6 +1711,51 @@ void UTSLAProcessorPrivate::initializeLattice()
 }
 
 
+///
+/// @brief 预计算点阵周期截面
+/// @details 实现步骤:
+///   1. 检查是否启用点阵及截面预计算
+///   2. 收集所有零件的实体层高度
+///   3. 截面库文件保存在BPP同目录,参数、扫描线间距及层厚一致时直接读取
+///
+void UTSLAProcessorPrivate::precomputeLattice()
+{
+    Q_Q(UTSLAProcessor);
+
+    // 检查是否启用预计算
+    if (nullptr == _latticeInfPtr) return;
+    if (0 == _writerBufferParas->getExtendedValue<int>("Lattice/usePrecompute", 1)) return;
+
+    // 收集实体层高度及最小层厚
+    QVector<int> layerHeis;
+    double fLayerThickness = 0.0;
+    int partCnt = q->getBuildPartCount();
+    for (int index = 0; index < partCnt; ++ index)
+    {
+        const double fThickness = double(q->getLayerThickness(index));
+        if (0 == index || fThickness < fLayerThickness) fLayerThickness = fThickness;
+        const int nMaxLayer = q->getMaxLayer(index);
+        for (int nHei = q->getMinLayer(index); nHei <= nMaxLayer; ++ nHei)
+        {
+            if (q->isEffectiveLayer(nHei, index, FTYPE_SOLID)) layerHeis << nHei;
+        }
+    }
+    if (layerHeis.size() < 1) return;
+
+    // 截面库文件路径, 默认不在输入文件目录写入截面库
+    QString cachePath;
+    if (_writerBufferParas->getExtendedValue<int>("Lattice/saveSectionTable", 0) && false == strBPPPath.isEmpty())
+    {
+        cachePath = QFileInfo(strBPPPath).absolutePath() + "/" + strBPPName + ".lattice";
+    }
+
+    // 扫描线间距及层厚与晶格参数共同作为截面库键值, 任一变化时重新计算
+    const double fLineSpacing = double(_writerBufferParas->_bppParaPtr->sHatchingPara.fLineSpacing[HATCHINGBEAM_NORMAL]);
+    _latticeInfPtr->precomputeLattics(layerHeis, cachePath, fLineSpacing, fLayerThickness,
+                                      _writerBufferParas->getExtendedValue<int>("Lattice/precomputeAsync", 0));
+}
+
+
 ///
 /// @brief 创建点阵结构
 /// @param paths [in] 输入路径
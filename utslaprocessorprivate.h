@@ -7,6 +7,7 @@
 #include <QJsonObject>
 #include <QSemaphore>
 #include <QJsonArray>
+#include <vector>
 
 #include "algorithmapplication.h"
 
@@ -16,10 +17,23 @@ class SelfAdaptiveModule;
 class LatticeInterface;
 class QJsonParsing;
 class FileWriter;
+class JobArchiver;
 
 typedef QSharedPointer<FileWriter> USPFileWriterPtr;
 typedef QSharedPointer<AlgorithmApplication> AlgrithmPtr;
 
+///
+/// @brief 零件实例信息
+/// @details 切片数据平移后相同的零件只处理 nSource, 其余由 nSource 的文件平移得到
+///
+struct PartInstance {
+    int nSource = -1;           // 提供扫描数据的零件, 等于自身时完整处理
+    qint32 nOffsetX = 0;        // 相对 nSource 的平移量
+    qint32 nOffsetY = 0;
+    QString strUspFile = "";    // 完整处理后生成的文件
+    double fVolume = 0.0;
+};
+
 class UTSLAProcessorPrivate
 {
 public:
@@ -30,13 +44,23 @@ public:
     void stopBuildProcessing();
     bool loadParameters(const QString &, const QString &);
 
+    static void appendAreaSignature(QByteArray &, const int &, const Path &, bool &, IntPoint &);
+
 private:
     void building(const int &, const int &);
     void buildProcessing();
     void partProcessing(const int &);
+    void instanceProcessing(const int &);
+    void finishPartFile(const int &, const USPFileWriterPtr &);
     void readDatas(const int &);
     void calcLayerDatas(const int &, const int &, const int &, const USPFileWriterPtr &, SOLIDPATH &);
     void readLayerDatas(const int &, const int &, const USPFileWriterPtr &, SOLIDPATH &);
+    void readLayerDatas(const int &, const int &, PARAWRITEBUFF *, AlgorithmApplication *, SOLIDPATH &);
+    void simplifyLayerPaths(const int &, const int &, AlgorithmApplication *, Paths &);
+
+    bool isInstanceDedupAvailable();
+    void findPartInstances();
+    void calcPartSignature(const int &, QByteArray &, IntPoint &);
 
     int getPreLayerHei(const int &, const int &);
     int getNextLayerHei(const int &, const int &);
@@ -49,6 +73,8 @@ private:
     void createJsonResult(QJsonObject &);
     void createJsonResultWithCompress(QJsonObject &);
     void createJobFileResult(QJsonObject &);
+    void archivePartFile(const USPFileWriterPtr &);
+    bool createFilesZip(const QString &, const QStringList &, const char *, const QByteArray &);
 
     void loadExportParameters();
     void calcSLMScale(QList<AREAINFOPTR> &);
@@ -57,6 +83,7 @@ private:
     bool createFileWriter(const int &, const QString &, USPFileWriterPtr &);
 
     void initializeLattice();
+    void precomputeLattice();
     void createLattice(Paths &, const Paths &, const int &, Paths &, LatticeLayerInfo &);
 
 private:
@@ -65,11 +92,13 @@ private:
     UTSLAProcessor * const q_ptr = nullptr;
 
     QString strBPPName = "";
+    QString strBPPPath = "";
     QFutureWatcher<void> futureWatcher;
 
     QSharedPointer<SelfAdaptiveModule> _selfAdaptiveModule = nullptr;
     QSharedPointer<WriterBufferParas> _writerBufferParas = nullptr;
     QSharedPointer<LatticeInterface> _latticeInfPtr = nullptr;
+    QSharedPointer<JobArchiver> _jobArchiver = nullptr;
 
     int _progressPos = -1;
     double fProcessing = 0.0;
@@ -80,6 +109,10 @@ private:
     double fScaleX = 1.0;
     double fScaleY = 1.0;
     int _threadCount = 1;
+    bool _layerArena = false;
+
+    double _simplifyTolerance = 0.0;
+    std::vector<PartInstance> _partInstances;   // 为空时各零件独立处理
 };
 
 #endif // UTSLAPROCESSORPRIVATE_H
@@ -3,6 +3,7 @@
 #include "sljfilewriter.h"
 
 #include <QDebug>
+#include <QTemporaryFile>
 
 WriteJFile::WriteJFile(QObject *parent) :
     QThread(parent)
@@ -41,6 +42,13 @@ void WriteJFile::setParaWriteBuff(PARAWRITEBUFF *lpParaWriteBuff)
 }
 
 
+///
+/// @brief 作业文件写入线程执行函数
+/// @details 实现步骤:
+///   1. 按扫描器、光束顺序取出数据块
+///   2. 队列有超出内存预算(Global/nWriteBufferMB)时提前写出的数据, 先逐块读回写入
+///   3. 写入作业文件数据块
+///
 void WriteJFile::run()
 {
     m_bRunning = true;
@@ -52,17 +60,27 @@ void WriteJFile::run()
         while(m_bRunning)
         {
             UFFWRITEDATA mUFileData;
+            QSharedPointer<QTemporaryFile> spillFile;
 
-            QMutex *mutex = &_writeBuff->gUFileData[iScanner][nCurBeamIndex]->gLocker_UFD;
+            UFILEDATA *lpFileData = _writeBuff->gUFileData[iScanner][nCurBeamIndex].data();
+            QMutex *mutex = lpFileData->gQueue.locker();
             mutex->lock();
-            if(_writeBuff->gUFileData[iScanner][nCurBeamIndex]->gListUFileData.size())
+            lpFileData->bDraining = true;
+            if(lpFileData->gSpillFile)
             {
-                mUFileData = _writeBuff->gUFileData[iScanner][nCurBeamIndex]->gListUFileData.takeFirst();
+                spillFile.swap(lpFileData->gSpillFile);
+                lpFileData->nSpillBlockCnt = 0;
+                lpFileData->nSpillVectorCnt = 0;
+            }
+            else if(lpFileData->gQueue.take(mUFileData))
+            {
+                _writeBuff->releasePendingBytes(lpFileData, mUFileData);
             }
             else
             {
                 if(UFFWRITE_END == m_nUFDataStatus)
                 {
+                    lpFileData->bDraining = false;
                     if(-- nCurBeamIndex < 0)
                     {
                         mutex->unlock();
@@ -73,14 +91,29 @@ void WriteJFile::run()
             }
             mutex->unlock();
 
-            if(-1 != mUFileData.nMode_Section)
+            if(spillFile)
+            {
+                // 读回提前写出的数据块
+                if(false == bCurScannerIndexWrited) bCurScannerIndexWrited = true;
+                if(false == bCurBeamWrited) bCurBeamWrited = true;
+                spillFile->seek(0);
+                UFFWRITEDATA spilledData;
+                while(PARAWRITEBUFF::readSpilledScanLines(spillFile.data(), spilledData))
+                {
+                    SLJFileWriter::writeDataBlock(iScanner, spilledData.nMode_Section - SECTION_POLYGON, &_writeBuff->gFile,
+                                                  spilledData.listSLines, jFLayerInfo);
+                }
+            }
+            else if(-1 != mUFileData.nMode_Section)
             {
                 if(false == bCurScannerIndexWrited) bCurScannerIndexWrited = true;
                 if(false == bCurBeamWrited) bCurBeamWrited = true;
+                // SLJFileWriter 只接受 SCANLINE 数组
+                if(mUFileData.vectorBuffer) mUFileData.vectorBuffer->toScanLines(mUFileData.listSLines);
                 SLJFileWriter::writeDataBlock(iScanner, mUFileData.nMode_Section - SECTION_POLYGON, &_writeBuff->gFile,
                                               mUFileData.listSLines, jFLayerInfo);
             }
         }
     }
+    _writeBuff->resetDraining();
 }
-
@@ -0,0 +1,173 @@
+#ifndef WRITEQUEUE_H
+#define WRITEQUEUE_H
+
+#include <QMutex>
+#include <QVector>
+#include <atomic>
+#include <memory>
+
+///
+/// ! @coreclass{MPSCRing}
+/// 有界无锁环形队列, 多生产者单消费者
+/// @details 每个槽位带序号: 生产者以 CAS 领取写入位置, 写入后发布序号; 消费者按位置顺序读取,
+///   同一生产者先后写入的数据按写入顺序取出. 容量取不小于指定值的2的幂.
+///   seal() 在写入位置上置封闭位, 之后生产者无法领取位置, 封闭前领取的位置均小于返回值
+///
+template<class T>
+class MPSCRing
+{
+public:
+    explicit MPSCRing(const int &capacity) {
+        size_t size = 2;
+        while (size < size_t(capacity)) size <<= 1;
+        _mask = size - 1;
+        _cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++ i) _cells[i]._seq.store(i, std::memory_order_relaxed);
+    }
+    MPSCRing(const MPSCRing &) = delete;
+    MPSCRing &operator=(const MPSCRing &) = delete;
+
+    inline int capacity() const { return int(_mask + 1); }
+    inline size_t dequeuePos() const { return _dequeuePos; }
+
+    ///
+    /// @brief 写入, 队列满或已封闭时返回 false 且不移动 value
+    ///
+    bool push(T &value) {
+        Cell *cell = nullptr;
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (pos & SealedBit) return false;
+            cell = &_cells[pos & _mask];
+            const size_t seq = cell->_seq.load(std::memory_order_acquire);
+            const qint64 dif = qint64(seq) - qint64(pos);
+            if (0 == dif)
+            {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (dif < 0) return false;
+            else pos = _enqueuePos.load(std::memory_order_relaxed);
+        }
+        cell->_data = std::move(value);
+        cell->_seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    ///
+    /// @brief 读取, 仅由单个消费者调用; 下一个槽位尚未写完时返回 false
+    ///
+    bool pop(T &value) {
+        Cell *cell = &_cells[_dequeuePos & _mask];
+        const size_t seq = cell->_seq.load(std::memory_order_acquire);
+        if (seq != _dequeuePos + 1) return false;
+        value = std::move(cell->_data);
+        cell->_data = T();
+        cell->_seq.store(_dequeuePos + _mask + 1, std::memory_order_release);
+        ++ _dequeuePos;
+        return true;
+    }
+
+    inline bool isEmpty() const {
+        return _cells[_dequeuePos & _mask]._seq.load(std::memory_order_acquire) != _dequeuePos + 1;
+    }
+
+    ///
+    /// @brief 封闭写入, 返回封闭时的写入位置
+    ///
+    inline size_t seal() {
+        return _enqueuePos.fetch_or(SealedBit, std::memory_order_acq_rel) & ~size_t(SealedBit);
+    }
+    inline void unseal() {
+        _enqueuePos.fetch_and(~size_t(SealedBit), std::memory_order_acq_rel);
+    }
+
+private:
+    static const size_t SealedBit = size_t(1) << (sizeof(size_t) * 8 - 1);
+
+    struct Cell {
+        std::atomic<size_t> _seq;
+        T _data;
+    };
+
+    std::unique_ptr<Cell[]> _cells;
+    size_t _mask = 0;
+    char _pad0[64];                             // 生产者与消费者位置分处不同缓存行
+    std::atomic<size_t> _enqueuePos {0};
+    char _pad1[64];
+    size_t _dequeuePos = 0;
+};
+
+///
+/// ! @coreclass{WriteQueue}
+/// 写入数据队列
+/// @details 生产者写入 MPSCRing 不加锁; 环形队列满时加锁转入溢出列表并封闭环形队列, 直到消费者取空
+///   溢出列表前所有生产者都写入溢出列表. 消费者先取完封闭前已领取的位置(含已领取尚未发布的槽位),
+///   再取溢出列表, 保证同一生产者的数据顺序. 消费端(写入线程或提前编码)持有 locker() 互斥
+///
+template<class T>
+class WriteQueue
+{
+public:
+    enum { DefaultCapacity = 1024 };
+
+    explicit WriteQueue(const int &capacity = DefaultCapacity) : _ring(capacity) {}
+    WriteQueue(const WriteQueue &) = delete;
+    WriteQueue &operator=(const WriteQueue &) = delete;
+
+    inline QMutex *locker() { return &_locker; }
+
+    void push(T value) {
+        if (false == _bOverflow.load(std::memory_order_acquire) && _ring.push(value)) return;
+
+        QMutexLocker locker(&_locker);
+        if (false == _bOverflow.load(std::memory_order_relaxed))
+        {
+            // 溢出列表已取空时环形队列可能已有空位
+            if (_ring.push(value)) return;
+            _overflowStartPos = _ring.seal();
+            _bOverflow.store(true, std::memory_order_release);
+        }
+        _overflow << std::move(value);
+    }
+
+    ///
+    /// @brief 按顺序取出一项, 调用方持有 locker()
+    /// @details 溢出期间读取位置未到达封闭位置时只取环形队列, 槽位尚未发布则返回 false 等待;
+    ///   到达后再取溢出列表, 溢出列表取空后解除封闭, 恢复无锁写入
+    ///
+    bool take(T &value) {
+        if (false == _bOverflow.load(std::memory_order_acquire) || _ring.dequeuePos() < _overflowStartPos)
+        {
+            return _ring.pop(value);
+        }
+
+        const bool bTaken = _overflowHead < _overflow.size();
+        if (bTaken) value = std::move(_overflow[_overflowHead ++]);
+        if (_overflowHead >= _overflow.size())
+        {
+            _overflow.clear();
+            _overflowHead = 0;
+            _bOverflow.store(false, std::memory_order_release);
+            _ring.unseal();
+        }
+        return bTaken;
+    }
+
+    ///
+    /// @brief 是否为空, 调用方持有 locker()
+    ///
+    inline bool isEmpty() const {
+        return _ring.isEmpty() && _overflowHead >= _overflow.size();
+    }
+
+private:
+    MPSCRing<T> _ring;
+    QMutex _locker;
+    QVector<T> _overflow;
+    int _overflowHead = 0;
+    size_t _overflowStartPos = 0;               // 封闭时的写入位置, 受 _locker 保护
+    std::atomic<bool> _bOverflow {false};
+};
+
+#endif // WRITEQUEUE_H
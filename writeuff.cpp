@@ -36,15 +36,18 @@ void WriteUFF::setParaWriteBuff(PARAWRITEBUFF *lpParaWriteBuff)
 /// @brief UFF文件写入线程执行函数
 /// @details 实现步骤:
 ///   1. 遍历扫描器
-///   2. 处理每个光束的数据
+///   2. 处理每个光束的数据, 标记当前消费的队列
 ///   3. 写入扫描器和光束索引
-///   4. 写入零件和扫描参数
-///   5. 写入扫描线数据
+///   4. 队列有超出内存预算时提前编码的数据, 先整体拷贝
+///   5. 写入零件、扫描参数及扫描线数据, 开启 Global/nScanEncoding 时使用差分编码
 ///
 void WriteUFF::run()
 {
     // 设置运行标志
     m_bRunning = true;
+    m_nBlockCnt = 0;
+    m_nVectorCnt = 0;
+    const bool bDeltaEncoding = SCANENCODING_DELTA_V1 == _writeBuff->getExtendedValue<int>("Global/nScanEncoding", SCANENCODING_RAW);
 
     // 遍历所有扫描器
     for(int iScanner = 0; iScanner < BpcParas->nNumber_SplicingScanner; ++ iScanner)
@@ -58,19 +61,33 @@ void WriteUFF::run()
         while(m_bRunning)
         {
             UFFWRITEDATA mUFileData;
+            QSharedPointer<QTemporaryFile> spillFile;
+            qint32 nSpillBlockCnt = 0;
+            qint64 nSpillVectorCnt = 0;
 
             // 获取写入数据
-            QMutex *mutex = &_writeBuff->gUFileData[iScanner][nCurBeamIndex]->gLocker_UFD;
+            UFILEDATA *lpFileData = _writeBuff->gUFileData[iScanner][nCurBeamIndex].data();
+            QMutex *mutex = lpFileData->gQueue.locker();
             mutex->lock();
-            if(_writeBuff->gUFileData[iScanner][nCurBeamIndex]->gListUFileData.size())
+            lpFileData->bDraining = true;
+            if(lpFileData->gSpillFile)
             {
-                mUFileData = _writeBuff->gUFileData[iScanner][nCurBeamIndex]->gListUFileData.takeFirst();
+                spillFile.swap(lpFileData->gSpillFile);
+                nSpillBlockCnt = lpFileData->nSpillBlockCnt;
+                nSpillVectorCnt = lpFileData->nSpillVectorCnt;
+                lpFileData->nSpillBlockCnt = 0;
+                lpFileData->nSpillVectorCnt = 0;
+            }
+            else if(lpFileData->gQueue.take(mUFileData))
+            {
+                _writeBuff->releasePendingBytes(lpFileData, mUFileData);
             }
             else
             {
                 // 检查是否结束当前光束处理
                 if(UFFWRITE_END == m_nUFDataStatus)
                 {
+                    lpFileData->bDraining = false;
                     if(-- nCurBeamIndex < 0)
                     {
                         mutex->unlock();
@@ -82,7 +99,7 @@ void WriteUFF::run()
             mutex->unlock();
 
             // 写入数据段
-            if(-1 != mUFileData.nMode_Section)
+            if(spillFile || -1 != mUFileData.nMode_Section)
             {
                 // 写入扫描器索引
                 if(false == bCurScannerIndexWrited)
@@ -99,26 +116,23 @@ void WriteUFF::run()
                     writeData8(&_writeBuff->gFile, SECTION_CURRENTBEAMINDEX);
                     writeData32(&_writeBuff->gFile, nCurBeamIndex);
                 }
+            }
 
-                // 写入零件索引
-                writeData8(&_writeBuff->gFile, SECTION_PARTINDEX);
-                writeData32(&_writeBuff->gFile, mUFileData.nPartIndex);
-
-                // 写入模式信息
-                writeData8(&_writeBuff->gFile, mUFileData.nMode_Section);
-                writeData8(&_writeBuff->gFile, mUFileData.nMode_Coor);
-
-                // 写入激光功率
-                writeData8(&_writeBuff->gFile, SECTION_LASERPOWER);
-                writeData32(&_writeBuff->gFile, mUFileData.nLaserPower);
-
-                // 写入标记速度
-                writeData8(&_writeBuff->gFile, SECTION_MARKSPEED);
-                writeData32(&_writeBuff->gFile, mUFileData.nMarkSpeed);
-
-                // 写入扫描线数据
-                writeScanLines(&_writeBuff->gFile, mUFileData.listSLines);
+            if(spillFile)
+            {
+                // 拷贝提前编码的数据块
+                m_nBlockCnt += nSpillBlockCnt;
+                m_nVectorCnt += nSpillVectorCnt;
+                spillFile->seek(0);
+                while(false == spillFile->atEnd()) _writeBuff->gFile.write(spillFile->read(SpillCopySize));
+            }
+            else if(-1 != mUFileData.nMode_Section)
+            {
+                ++ m_nBlockCnt;
+                m_nVectorCnt += mUFileData.lineCount();
+                writeBlockData(&_writeBuff->gFile, mUFileData, bDeltaEncoding);
             }
         }
     }
+    _writeBuff->resetDraining();
 }
@@ -8,6 +8,8 @@ class WriteUFF : public QThread
 {
     Q_OBJECT
 
+    enum { SpillCopySize = 4 << 20 };
+
 public:
     explicit WriteUFF(QObject *parent = nullptr);
 
@@ -17,6 +19,8 @@ public:
     void stopThread() {
         m_bRunning = false;
     }
+    inline qint32 blockCount() const { return m_nBlockCnt; }
+    inline qint64 vectorCount() const { return m_nVectorCnt; }
 
 private:
     void run();
@@ -24,6 +28,8 @@ private:
 private:
     int m_nUFDataStatus;
     bool m_bRunning = true;
+    qint32 m_nBlockCnt = 0;
+    qint64 m_nVectorCnt = 0;
     PARAWRITEBUFF *_writeBuff = nullptr;
 };
 